@@ -0,0 +1,84 @@
+# Helpers for the monolithic build (CMAKE_BUILD_MONOLITHIC).
+#
+# Each module registers its sources, include directories and external
+# libraries with artik_monolithic_add(), then artik_monolithic_build()
+# links all of them into libartik-sdk-all together with a compile-time
+# table of the module operation structures, so that
+# artik_request_api_module() returns direct addresses without dlopen.
+
+INCLUDE ( CMakeParseArguments )
+
+SET ( ARTIK_MONOLITHIC_DIR ${CMAKE_CURRENT_LIST_DIR} )
+
+SET ( LIB_ALL artik-sdk-all CACHE INTERNAL "" FORCE )
+SET ( ARTIK_ALL_LIBRARIES ${LIB_ALL} CACHE INTERNAL "" FORCE )
+
+FUNCTION ( artik_monolithic_add )
+	CMAKE_PARSE_ARGUMENTS ( ARG "" "TARGET" "SOURCES;MODULES" ${ARGN} )
+
+	FOREACH ( src ${ARG_SOURCES} )
+		IF ( NOT IS_ABSOLUTE ${src} )
+			SET ( src ${CMAKE_CURRENT_SOURCE_DIR}/${src} )
+		ENDIF ( )
+		SET_PROPERTY ( GLOBAL APPEND PROPERTY ARTIK_ALL_SOURCES ${src} )
+	ENDFOREACH ( )
+
+	GET_TARGET_PROPERTY ( incs ${ARG_TARGET} INCLUDE_DIRECTORIES )
+	IF ( incs )
+		SET_PROPERTY ( GLOBAL APPEND PROPERTY ARTIK_ALL_INCLUDES ${incs} )
+	ENDIF ( )
+
+	# Other SDK libraries are part of the monolithic library itself
+	GET_TARGET_PROPERTY ( libs ${ARG_TARGET} LINK_LIBRARIES )
+	FOREACH ( lib ${libs} )
+		IF ( NOT lib MATCHES "^artik-sdk-" )
+			SET_PROPERTY ( GLOBAL APPEND PROPERTY ARTIK_ALL_LINK ${lib} )
+		ENDIF ( )
+	ENDFOREACH ( )
+
+	SET_PROPERTY ( GLOBAL APPEND PROPERTY ARTIK_ALL_MODULES ${ARG_MODULES} )
+ENDFUNCTION ( artik_monolithic_add )
+
+FUNCTION ( artik_monolithic_build )
+	GET_PROPERTY ( sources GLOBAL PROPERTY ARTIK_ALL_SOURCES )
+	GET_PROPERTY ( includes GLOBAL PROPERTY ARTIK_ALL_INCLUDES )
+	GET_PROPERTY ( libs GLOBAL PROPERTY ARTIK_ALL_LINK )
+	GET_PROPERTY ( modules GLOBAL PROPERTY ARTIK_ALL_MODULES )
+	LIST ( REMOVE_DUPLICATES includes )
+	LIST ( REMOVE_DUPLICATES libs )
+
+	SET ( ARTIK_STATIC_INCLUDES "" )
+	SET ( ARTIK_STATIC_ENTRIES "" )
+	FOREACH ( module ${modules} )
+		SET ( ARTIK_STATIC_INCLUDES "${ARTIK_STATIC_INCLUDES}#include <artik_${module}.h>\n" )
+		SET ( ARTIK_STATIC_ENTRIES "${ARTIK_STATIC_ENTRIES}\t{ \"${module}\", (artik_module_ops)&${module}_module },\n" )
+	ENDFOREACH ( )
+
+	SET ( table ${CMAKE_CURRENT_BINARY_DIR}/artik_static_modules.c )
+	CONFIGURE_FILE ( ${ARTIK_MONOLITHIC_DIR}/artik_static_modules.c.in ${table} )
+
+	SET ( defs CONFIG_ARTIK_MONOLITHIC
+		"EXPORT_API=__attribute__((visibility(\"default\")))" )
+
+	ADD_LIBRARY ( ${LIB_ALL} SHARED ${sources} ${table} )
+	ADD_LIBRARY ( ${LIB_ALL}-static STATIC ${sources} ${table} )
+
+	FOREACH ( target ${LIB_ALL} ${LIB_ALL}-static )
+		TARGET_COMPILE_DEFINITIONS ( ${target} PRIVATE ${defs} )
+		TARGET_INCLUDE_DIRECTORIES ( ${target} PUBLIC ${includes}
+			PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/base/module )
+		TARGET_LINK_LIBRARIES ( ${target} ${libs} )
+		IF ( MONOLITHIC_LTO )
+			TARGET_COMPILE_OPTIONS ( ${target} PRIVATE "-flto" )
+			SET_PROPERTY ( TARGET ${target} APPEND_STRING PROPERTY
+				LINK_FLAGS " -flto" )
+		ENDIF ( )
+	ENDFOREACH ( )
+
+	SET_TARGET_PROPERTIES ( ${LIB_ALL} PROPERTIES VERSION ${LIB_VERSION_MAJOR}.${LIB_VERSION_MINOR}.${LIB_VERSION_PATCH} SOVERSION ${LIB_VERSION_MAJOR} OUTPUT_NAME ${LIB_ALL} )
+	SET_TARGET_PROPERTIES ( ${LIB_ALL}-static PROPERTIES OUTPUT_NAME ${LIB_ALL} ARCHIVE_OUTPUT_DIRECTORY ${LIB_DIR} )
+
+	INSTALL ( TARGETS ${LIB_ALL} LIBRARY DESTINATION "${CMAKE_INSTALL_LIBDIR}"
+		PERMISSIONS OWNER_WRITE OWNER_READ OWNER_EXECUTE GROUP_READ GROUP_EXECUTE WORLD_READ WORLD_EXECUTE )
+	INSTALL ( TARGETS ${LIB_ALL}-static ARCHIVE DESTINATION "${CMAKE_INSTALL_LIBDIR}" )
+ENDFUNCTION ( artik_monolithic_build )
@@ -0,0 +1,469 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__ARTIK_INDEXED_LIST_H__
+#define	__ARTIK_INDEXED_LIST_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "artik_error.h"
+#include "artik_list.h"
+
+	/*! \file artik_indexed_list.h
+	 *
+	 * \brief Indexed list implementation
+	 *
+	 * Companion of the generic linked list (artik_list.h) for
+	 * containers looked up by handle on hot paths. Nodes are the same
+	 * artik_list based structures and keep the same handle semantics,
+	 * but they are allocated from a per-list arena and indexed by handle
+	 * in an open addressing hash table, so that add, get and delete by
+	 * handle are O(1). Node addresses are stable until the node is
+	 * deleted. Nodes are chained through their \ref next field in
+	 * insertion order, starting from artik_indexed_list_first().
+	 *
+	 * As for artik_list, callers are responsible for locking.
+	 *
+	 */
+
+	/*!
+	 * \brief Alignment of the nodes allocated from the arena
+	 */
+#define ARTIK_INDEXED_LIST_ALIGN	16
+
+	/*!
+	 * \brief Size of the first arena chunk, in nodes
+	 */
+#define ARTIK_INDEXED_LIST_MIN_CHUNK	8
+
+	/*!
+	 * \brief Maximum size of an arena chunk, in nodes
+	 */
+#define ARTIK_INDEXED_LIST_MAX_CHUNK	4096
+
+	/*!
+	 * \brief Initial size of the hash index, must be a power of 2
+	 */
+#define ARTIK_INDEXED_LIST_MIN_INDEX	16
+
+	/*!
+	 * \brief Indexed list structure
+	 *
+	 * Must be zero initialized before the first use. The node size is
+	 * set by the first call to artik_indexed_list_add and all the nodes
+	 * of a list have the same size.
+	 */
+	typedef struct {
+		unsigned int node_size;
+		unsigned int count;
+		unsigned int index_size;
+		unsigned int chunk_nodes;
+		artik_list **index;
+		artik_list *head;
+		artik_list *tail;
+		void *free_slots;
+		void *chunks;
+	} artik_indexed_list;
+
+#define ARTIK_INDEXED_LIST_ROUND(size) \
+	(((size) + ARTIK_INDEXED_LIST_ALIGN - 1) & \
+					~(ARTIK_INDEXED_LIST_ALIGN - 1))
+
+	/*
+	 * Every node is preceded in the arena by a slot header holding the
+	 * previous node in insertion order, or the next free slot.
+	 */
+#define ARTIK_INDEXED_LIST_HEADER \
+	ARTIK_INDEXED_LIST_ROUND(sizeof(void *))
+
+	static inline void **artik_indexed_list_link(artik_list *node)
+	{
+		return (void **)((char *)node - ARTIK_INDEXED_LIST_HEADER);
+	}
+
+	static inline unsigned int artik_indexed_list_hash(
+						ARTIK_LIST_HANDLE handle)
+	{
+		uint64_t h = (uint64_t)(uintptr_t)handle;
+
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+
+		return (unsigned int)h;
+	}
+
+	static inline unsigned int artik_indexed_list_find_slot(
+			artik_indexed_list *list, ARTIK_LIST_HANDLE handle)
+	{
+		unsigned int mask = list->index_size - 1;
+		unsigned int i = artik_indexed_list_hash(handle) & mask;
+
+		while (list->index[i] && (list->index[i]->handle != handle))
+			i = (i + 1) & mask;
+
+		return i;
+	}
+
+	static inline artik_error artik_indexed_list_grow(
+						artik_indexed_list *list)
+	{
+		unsigned int size = list->index_size ?
+			list->index_size * 2 : ARTIK_INDEXED_LIST_MIN_INDEX;
+		artik_list **index = (artik_list **)calloc(size,
+							sizeof(artik_list *));
+		artik_list *elem;
+
+		if (!index)
+			return E_NO_MEM;
+
+		free(list->index);
+		list->index = index;
+		list->index_size = size;
+
+		for (elem = list->head; elem; elem = elem->next)
+			list->index[artik_indexed_list_find_slot(list,
+							elem->handle)] = elem;
+
+		return S_OK;
+	}
+
+	static inline artik_list *artik_indexed_list_alloc(
+						artik_indexed_list *list)
+	{
+		unsigned int stride = ARTIK_INDEXED_LIST_HEADER +
+				ARTIK_INDEXED_LIST_ROUND(list->node_size);
+		void *slot;
+
+		if (!list->free_slots) {
+			unsigned int nodes = list->chunk_nodes ?
+				list->chunk_nodes * 2 :
+				ARTIK_INDEXED_LIST_MIN_CHUNK;
+			char *chunk;
+			unsigned int i;
+
+			if (nodes > ARTIK_INDEXED_LIST_MAX_CHUNK)
+				nodes = ARTIK_INDEXED_LIST_MAX_CHUNK;
+
+			chunk = (char *)malloc(ARTIK_INDEXED_LIST_HEADER +
+							nodes * stride);
+			if (!chunk)
+				return NULL;
+
+			/* Chain the chunks to release them all at once */
+			*(void **)chunk = list->chunks;
+			list->chunks = chunk;
+			list->chunk_nodes = nodes;
+
+			for (i = nodes; i > 0; i--) {
+				slot = chunk + ARTIK_INDEXED_LIST_HEADER +
+							(i - 1) * stride;
+				*(void **)slot = list->free_slots;
+				list->free_slots = slot;
+			}
+		}
+
+		slot = list->free_slots;
+		list->free_slots = *(void **)slot;
+
+		return (artik_list *)((char *)slot + ARTIK_INDEXED_LIST_HEADER);
+	}
+
+	static inline void artik_indexed_list_release(
+						artik_indexed_list *list)
+	{
+		while (list->chunks) {
+			void *next = *(void **)list->chunks;
+
+			free(list->chunks);
+			list->chunks = next;
+		}
+
+		free(list->index);
+		memset(list, 0, sizeof(*list));
+	}
+
+	/*!
+	 * \brief artik_indexed_list_add adds a new node to an indexed list
+	 *
+	 * \param[in,out] list list correspond to the container to fill.
+	 * \param[in] handle Handle value that is needed when you get or
+	 * delete this node. If not defined as a specific value, it is defined
+	 * as the address of the node by default. Handles must be unique.
+	 * \param[in] size_of_node size_of_node specify the size in bytes of the
+	 * element to add to the list. It must be the same for all the nodes.
+	 *
+	 * \return Node added on success, NULL otherwise
+	 */
+	static inline artik_list *artik_indexed_list_add(
+			artik_indexed_list *list, ARTIK_LIST_HANDLE handle,
+			int size_of_node)
+	{
+		artik_list *elem;
+
+		if (!list || (size_of_node < (int)sizeof(artik_list)))
+			return NULL;
+
+		if (!list->node_size)
+			list->node_size = size_of_node;
+		else if (list->node_size != (unsigned int)size_of_node)
+			return NULL;
+
+		if (((list->count + 1) * 2 > list->index_size) &&
+				(artik_indexed_list_grow(list) != S_OK))
+			return NULL;
+
+		if (handle && list->index[artik_indexed_list_find_slot(list,
+								handle)])
+			return NULL;
+
+		elem = artik_indexed_list_alloc(list);
+		if (!elem)
+			return NULL;
+
+		memset(elem, 0, size_of_node);
+		elem->handle = handle ? handle : (ARTIK_LIST_HANDLE)elem;
+		elem->size_data = size_of_node - sizeof(*elem);
+
+		list->index[artik_indexed_list_find_slot(list, elem->handle)] =
+									elem;
+
+		*artik_indexed_list_link(elem) = list->tail;
+		if (list->tail)
+			list->tail->next = elem;
+		else
+			list->head = elem;
+		list->tail = elem;
+		list->count++;
+
+		return elem;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_get_by_handle returns the node matching
+	 * a handle
+	 *
+	 * \param[in] list list correspond to the generic container.
+	 * \param[in] handle handle specify the key of the node to return.
+	 *
+	 * \return Node found on success, NULL otherwise
+	 */
+	static inline artik_list *artik_indexed_list_get_by_handle(
+			artik_indexed_list *list, ARTIK_LIST_HANDLE handle)
+	{
+		if (!list || !list->count ||
+				(handle == ARTIK_LIST_INVALID_HANDLE))
+			return NULL;
+
+		return list->index[artik_indexed_list_find_slot(list, handle)];
+	}
+
+	/*!
+	 * \brief artik_indexed_list_delete_handle deletes a specific node
+	 *
+	 * \param[in,out] list list correspond to the container to modify.
+	 * \param[in] handle handle specify the key of the node to delete.
+	 *
+	 * \return S_OK on success, error code otherwise
+	 */
+	static inline artik_error artik_indexed_list_delete_handle(
+			artik_indexed_list *list, ARTIK_LIST_HANDLE handle)
+	{
+		unsigned int mask, i, j, k;
+		artik_list *elem, *prev;
+
+		if (!list || !list->count ||
+				(handle == ARTIK_LIST_INVALID_HANDLE))
+			return E_BAD_ARGS;
+
+		i = artik_indexed_list_find_slot(list, handle);
+		elem = list->index[i];
+		if (!elem)
+			return E_BAD_ARGS;
+
+		/* Backward shift deletion, keeps probe sequences unbroken */
+		mask = list->index_size - 1;
+		list->index[i] = NULL;
+		for (j = (i + 1) & mask; list->index[j]; j = (j + 1) & mask) {
+			k = artik_indexed_list_hash(list->index[j]->handle) &
+									mask;
+			if (((j > i) && ((k <= i) || (k > j))) ||
+					((j < i) && (k <= i) && (k > j))) {
+				list->index[i] = list->index[j];
+				list->index[j] = NULL;
+				i = j;
+			}
+		}
+
+		prev = (artik_list *)*artik_indexed_list_link(elem);
+		if (prev)
+			prev->next = elem->next;
+		else
+			list->head = elem->next;
+		if (elem->next)
+			*artik_indexed_list_link(elem->next) = prev;
+		else
+			list->tail = prev;
+
+		if (elem->clear)
+			(*elem->clear) (elem);
+		if (elem->data)
+			free(elem->data);
+
+		*artik_indexed_list_link(elem) = list->free_slots;
+		list->free_slots = artik_indexed_list_link(elem);
+
+		if (--list->count == 0)
+			artik_indexed_list_release(list);
+
+		return S_OK;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_delete_node deletes a specific node
+	 *
+	 * \param[in,out] list list correspond to the container to modify.
+	 * \param[in] node node to delete.
+	 *
+	 * \return S_OK on success, error code otherwise
+	 */
+	static inline artik_error artik_indexed_list_delete_node(
+			artik_indexed_list *list, artik_list *node)
+	{
+		if (!list || !node ||
+		    (artik_indexed_list_get_by_handle(list, node->handle) !=
+									node))
+			return E_BAD_ARGS;
+
+		return artik_indexed_list_delete_handle(list, node->handle);
+	}
+
+	/*!
+	 * \brief artik_indexed_list_delete_all deletes all the nodes and
+	 * releases the memory of the list
+	 *
+	 * \param[in,out] list list correspond to the container to modify.
+	 *
+	 * \return S_OK on success, error code otherwise
+	 */
+	static inline artik_error artik_indexed_list_delete_all(
+						artik_indexed_list *list)
+	{
+		artik_list *elem;
+
+		if (!list || !list->count)
+			return E_BAD_ARGS;
+
+		for (elem = list->head; elem; elem = elem->next) {
+			if (elem->clear)
+				(*elem->clear) (elem);
+			if (elem->data)
+				free(elem->data);
+		}
+
+		artik_indexed_list_release(list);
+
+		return S_OK;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_size returns the number of nodes
+	 *
+	 * \param[in] list list correspond to the generic container.
+	 *
+	 * \return The number of nodes in the list
+	 */
+	static inline unsigned int artik_indexed_list_size(
+						artik_indexed_list *list)
+	{
+		return list ? list->count : 0;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_first returns the oldest node, the
+	 * others follow through the \ref next field
+	 *
+	 * \param[in] list list correspond to the generic container.
+	 *
+	 * \return First node, NULL if the list is empty
+	 */
+	static inline artik_list *artik_indexed_list_first(
+						artik_indexed_list *list)
+	{
+		return list ? list->head : NULL;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_get_by_pos returns the node at a given
+	 * position in insertion order
+	 *
+	 * \param[in] list list correspond to the generic container.
+	 * \param[in] pos pos is the position of a specific node.
+	 *
+	 * \return Node found on success, NULL otherwise
+	 */
+	static inline artik_list *artik_indexed_list_get_by_pos(
+			artik_indexed_list *list, unsigned int pos)
+	{
+		artik_list *elem = artik_indexed_list_first(list);
+
+		while (elem && pos--)
+			elem = elem->next;
+
+		return elem;
+	}
+
+	/*!
+	 * \brief artik_indexed_list_get_by_check returns the first node
+	 * matching an external function of comparison
+	 *
+	 * This is a linear search, use artik_indexed_list_get_by_handle
+	 * whenever possible.
+	 *
+	 * \param[in] list list correspond to the generic container.
+	 * \param[in] check_func check_func is a custom function for
+	 * comparing.
+	 * \param[in] param_of_check param_of_check is the dynamic argument
+	 * for the function 'check_func' .
+	 *
+	 * \return Node found on success, NULL otherwise
+	 */
+	static inline artik_list *artik_indexed_list_get_by_check(
+			artik_indexed_list *list, ARTIK_LIST_FUNCB check_func,
+			void *param_of_check)
+	{
+		artik_list *elem = artik_indexed_list_first(list);
+
+		if (!check_func)
+			return NULL;
+
+		while (elem && ((*check_func) (elem, param_of_check) == 0))
+			elem = elem->next;
+
+		return elem;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+#endif				/* __ARTIK_INDEXED_LIST_H__ */
@@ -24,6 +24,8 @@ extern "C" {
 #endif
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "artik_error.h"
 #include "artik_types.h"
@@ -62,7 +64,9 @@ extern "C" {
 		/**< no log */
 		LOG_SYSTEM_NONE,
 		/**< use custom log handler */
-		LOG_SYSTEM_CUSTOM
+		LOG_SYSTEM_CUSTOM,
+		/**< binary records formatted later, see set_binary_handler */
+		LOG_SYSTEM_BINARY
 	};
 
 	/*!
@@ -122,6 +126,43 @@ extern "C" {
 					   const char *prefix, const char *msg,
 					   void *user_data);
 
+	/*!
+	 * \brief     Binary log stream handler
+	 *
+	 * Receives chunks of the binary log stream, in order. A chunk only
+	 * contains complete records. The stream can be turned back into
+	 * messages with decode_binary().
+	 *
+	 * \param[in] data Chunk of the binary stream
+	 * \param[in] len Length of the chunk in bytes
+	 * \param[in] user_data The user data passed from the callback function
+	 */
+	typedef void (*artik_log_binary_handler) (const void *data, size_t len,
+						  void *user_data);
+
+	/*!
+	 * \brief     Counters of the logging module
+	 *
+	 * Returned by get_stats(). Counters are cumulated since the process
+	 * started and are never reset.
+	 */
+	typedef struct {
+		/*!
+		 * \brief Messages that passed the level filters
+		 */
+		uint64_t logged;
+		/*!
+		 * \brief Messages dropped because the asynchronous ring
+		 *        was full, in total and per level
+		 */
+		uint64_t dropped;
+		uint64_t dropped_level[LOG_LEVEL_DEBUG + 1];
+		/*!
+		 * \brief Messages cut to fit in an asynchronous ring record
+		 */
+		uint64_t truncated;
+	} artik_log_stats;
+
 	/*! \struct artik_log_module
 	 *
 	 *  \brief Logging module operations
@@ -181,10 +222,137 @@ extern "C" {
 			       const char *funcname, int line,
 			       const char *format, ...);
 
+		/*!
+		 * \brief     Set the runtime logging level
+		 *
+		 * Messages less severe than \ref level are discarded, unless
+		 * a module level allows them. Messages removed at compile time
+		 * by CONFIG_ARTIK_LOG_MIN_LEVEL cannot be enabled back.
+		 *
+		 * \param[in] level Least severe level to log
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*set_level) (enum artik_log_level level);
+
+		/*!
+		 * \brief     Set the runtime logging level of a module
+		 *
+		 * A message belongs to \ref module when one of the directory
+		 * names of its source file path, or the source file name
+		 * without extension, matches \ref module (e.g. "websocket",
+		 * "systemio" or "linux_gpio"). When several module levels
+		 * match, the one of the deepest path component is used.
+		 *
+		 * \param[in] module Module name, at most MAX_LOG_MODULE_NAME
+		 *            characters long
+		 * \param[in] level Least severe level to log for the module,
+		 *            or -1 to remove the module level
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*set_module_level) (const char *module, int level);
+
+		/*!
+		 * \brief     Enable or disable asynchronous logging
+		 *
+		 * When enabled, messages are formatted by the caller into a
+		 * lock-free ring buffer and written to the log system by a
+		 * dedicated thread. Callers never block: messages are dropped
+		 * and counted when the ring is full. Disabling flushes the
+		 * pending messages and stops the writer thread.
+		 *
+		 * \param[in] enable true to enable, false to disable
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*set_async) (bool enable);
+
+		/*!
+		 * \brief     Wait until all the queued messages are written
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*flush) (void);
+
+		/*!
+		 * \brief     Get the counters of the logging module
+		 *
+		 * \param[out] stats Structure filled up by the function
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*get_stats) (artik_log_stats *stats);
+
+		/*!
+		 * \brief     Set the binary log stream handler
+		 *
+		 * Switches the log system to LOG_SYSTEM_BINARY. In this mode
+		 * the caller only stores the format string pointer, the
+		 * arguments and a monotonic timestamp, and the writer thread
+		 * encodes them into a compact binary stream passed to
+		 * \ref handler. Formatting is deferred to decode_binary(),
+		 * possibly on another machine. Asynchronous logging is enabled
+		 * as a side effect.
+		 *
+		 * When LOG_SYSTEM_BINARY is selected with set_system() or the
+		 * ARTIK_LOG=binary environment variable and no handler is
+		 * set, the stream is written to stderr.
+		 *
+		 * \param[in] handler Callback, NULL to write to stderr
+		 * \param[in] user_data The user data to be passed to
+		 *            the callback function
+		 *
+		 * \return S_OK on success, error code otherwise
+		 */
+		artik_error(*set_binary_handler) (
+				artik_log_binary_handler handler,
+				void *user_data);
+
+		/*!
+		 * \brief     Format the messages of a binary log stream
+		 *
+		 * \param[in] data Binary stream, starting at the beginning of
+		 *            a chunk received by the binary handler
+		 * \param[in] len Length of the stream in bytes
+		 * \param[in] handler Callback called for each message with the
+		 *            prefix built from the current prefix fields
+		 * \param[in] user_data The user data to be passed to
+		 *            the callback function
+		 *
+		 * \return S_OK on success, E_INVALID_VALUE if the stream is
+		 *         malformed, error code otherwise
+		 */
+		artik_error(*decode_binary) (const void *data, size_t len,
+					     artik_log_handler handler,
+					     void *user_data);
+
 	} artik_log_module;
 
 	extern const artik_log_module log_module;
 
+	/*!
+	 * \brief     Least severe level compiled in the log_* macros
+	 *
+	 * 3 keeps all the levels down to log_dbg(), 2 stops at log_info(),
+	 * 1 at log_warn(), 0 only keeps log_err() and -1 removes all of
+	 * them. Disabled macros expand to nothing so their arguments are
+	 * not evaluated. Defaults to 0 in release builds, 3 otherwise.
+	 */
+#ifndef CONFIG_ARTIK_LOG_MIN_LEVEL
+#ifdef CONFIG_RELEASE
+#define CONFIG_ARTIK_LOG_MIN_LEVEL	0
+#else
+#define CONFIG_ARTIK_LOG_MIN_LEVEL	3
+#endif
+#endif
+
+	/*!
+	 * \brief     Maximum length of a module name passed to
+	 *            set_module_level()
+	 */
+#define MAX_LOG_MODULE_NAME	32
+
 	/*!
 	 * \brief     Convenient macro to fill file, function
 	 *            and line informations
@@ -197,17 +365,29 @@ extern "C" {
 #define artik_log(level, ...) (log_module.print(level, __FILE__, \
 				__func__, __LINE__, __VA_ARGS__))
 
-#ifdef CONFIG_RELEASE
-#define log_dbg(...)
-#define log_info(...)
-#define log_warn(...)
-#else
+#if CONFIG_ARTIK_LOG_MIN_LEVEL >= 3
 #define log_dbg(...) artik_log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define log_dbg(...)
+#endif
+
+#if CONFIG_ARTIK_LOG_MIN_LEVEL >= 2
 #define log_info(...) artik_log(LOG_LEVEL_INFO,  __VA_ARGS__)
+#else
+#define log_info(...)
+#endif
+
+#if CONFIG_ARTIK_LOG_MIN_LEVEL >= 1
 #define log_warn(...) artik_log(LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define log_warn(...)
 #endif
 
+#if CONFIG_ARTIK_LOG_MIN_LEVEL >= 0
 #define log_err(...) artik_log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define log_err(...)
+#endif
 
 #pragma GCC diagnostic pop
 #ifdef __cplusplus
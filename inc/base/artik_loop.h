@@ -23,6 +23,8 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "artik_error.h"
 #include "artik_types.h"
 
@@ -77,6 +79,115 @@ typedef int(*idle_callback)(void *user_data);
 
 typedef int(*watch_callback)(int fd, enum watch_io io, void *user_data);
 typedef int(*signal_callback)(void *user_data);
+/*!
+ * \brief     Generic callback type used to identify any registered callback
+ *            in the loop statistics
+ */
+typedef void(*loop_callback)(void);
+
+/*!
+ * \brief Number of buckets in the callback dispatch time histogram
+ *
+ * Bucket 0 counts dispatches shorter than 1us, bucket i (i > 0) counts
+ * dispatches lasting between 2^(i-1) and 2^i - 1 microseconds. The last
+ * bucket also counts all the longer dispatches.
+ */
+#define ARTIK_LOOP_HISTOGRAM_BUCKETS	20
+
+/*!
+ * \brief Type of a callback registered on the loop
+ */
+enum loop_source_type {
+	LOOP_SOURCE_TIMEOUT,
+	LOOP_SOURCE_PERIODIC,
+	LOOP_SOURCE_WATCH,
+	LOOP_SOURCE_SIGNAL,
+	LOOP_SOURCE_IDLE
+};
+
+/*! \struct artik_loop_callback_stats
+ *
+ *  \brief Dispatch statistics of a single callback
+ *
+ *  Callbacks are identified by their function address, so all the
+ *  sources registered with the same function are accounted together.
+ */
+typedef struct {
+	/*!
+	 * \brief Type of the source the callback was registered with
+	 */
+	enum loop_source_type type;
+	/*!
+	 * \brief Address of the callback function
+	 */
+	loop_callback func;
+	/*!
+	 * \brief Number of times the callback was dispatched
+	 */
+	uint64_t dispatch_count;
+	/*!
+	 * \brief Cumulative time spent in the callback in microseconds
+	 */
+	uint64_t total_usec;
+	/*!
+	 * \brief Longest single dispatch in microseconds
+	 */
+	uint64_t max_usec;
+	/*!
+	 * \brief Longest delay between timer expiration and dispatch
+	 *        in microseconds (timeouts and periodics only)
+	 */
+	uint64_t max_lag_usec;
+	/*!
+	 * \brief Number of dispatches exceeding the configured budget
+	 */
+	uint64_t over_budget_count;
+} artik_loop_callback_stats;
+
+/*! \struct artik_loop_stats
+ *
+ *  \brief Global dispatch statistics of the loop
+ */
+typedef struct {
+	/*!
+	 * \brief Total number of dispatched callbacks
+	 */
+	uint64_t dispatch_count;
+	/*!
+	 * \brief Cumulative time spent in callbacks in microseconds
+	 */
+	uint64_t total_usec;
+	/*!
+	 * \brief Longest single dispatch in microseconds
+	 */
+	uint64_t max_usec;
+	/*!
+	 * \brief Number of timer dispatches used for computing the lag
+	 */
+	uint64_t lag_count;
+	/*!
+	 * \brief Cumulative delay between timer expiration and dispatch
+	 *        in microseconds
+	 */
+	uint64_t total_lag_usec;
+	/*!
+	 * \brief Longest delay between timer expiration and dispatch
+	 *        in microseconds
+	 */
+	uint64_t max_lag_usec;
+	/*!
+	 * \brief Number of dispatches exceeding the configured budget
+	 */
+	uint64_t over_budget_count;
+	/*!
+	 * \brief Number of distinct callbacks accounted
+	 */
+	unsigned int num_callbacks;
+	/*!
+	 * \brief Histogram of the dispatch durations
+	 */
+	uint64_t histogram[ARTIK_LOOP_HISTOGRAM_BUCKETS];
+} artik_loop_stats;
 
 /*! \struct artik_loop_module
  *
@@ -170,6 +281,12 @@ typedef struct {
 	/*!
 	 * \brief	  Add signal to watch
 	 *
+	 * The signal may be blocked in the calling thread so that only the
+	 * loop receives it. Add the watch from the main thread before any
+	 * other thread is started, threads inherit the mask of their
+	 * creator. Removing the last watch of a signal from the same thread
+	 * restores its previous mask.
+	 *
 	 * \param[in] signum Signal to watch (Only SIGHUP, SIGINT, SIGTERM are supported)
 	 * \param[in] func The callback function to register
 	 * \param[in] user_data The user data to be passed to the callback
@@ -208,6 +325,50 @@ typedef struct {
 	 * \return    S_OK on success, error code otherwise
 	 */
 	artik_error(*remove_idle_callback)(int idle_id);
+	/*!
+	 * \brief     Enable or disable dispatch instrumentation
+	 *
+	 * When enabled, the loop measures the time spent in each callback
+	 * and the delay between timers expiration and their dispatch.
+	 * A warning is logged each time a callback runs longer than the
+	 * budget. Instrumentation can also be enabled by setting the
+	 * ARTIK_LOOP_STATS environment variable to the budget value.
+	 *
+	 * \param[in] enable true to enable instrumentation, false to
+	 *            disable it
+	 * \param[in] budget_usec Maximum time in microseconds a callback
+	 *            is expected to run, 0 to disable the warning
+	 *
+	 * \return    S_OK on success, error code otherwise
+	 */
+	artik_error(*enable_stats)(bool enable, unsigned int budget_usec);
+	/*!
+	 * \brief     Get the global dispatch statistics
+	 *
+	 * \param[out] stats Statistics filled up by the function
+	 *
+	 * \return    S_OK on success, error code otherwise
+	 */
+	artik_error(*get_stats)(artik_loop_stats *stats);
+	/*!
+	 * \brief     Get the per callback dispatch statistics
+	 *
+	 * \param[out] stats Preallocated array filled up by the function
+	 * \param[in,out] num Size of the array as input, number of entries
+	 *                filled up as output
+	 *
+	 * \return    S_OK on success, error code otherwise
+	 */
+	artik_error(*get_callback_stats)(artik_loop_callback_stats *stats,
+			int *num);
+	/*!
+	 * \brief     Print the dispatch statistics through the log module
+	 */
+	void (*dump_stats)(void);
+	/*!
+	 * \brief     Reset all the dispatch statistics
+	 */
+	void (*reset_stats)(void);
 } artik_loop_module;
 
 extern const artik_loop_module loop_module;
@@ -23,6 +23,8 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "artik_types.h"
 #include "artik_error.h"
 
@@ -179,6 +181,52 @@ extern "C" {
 	 */
 	artik_error artik_release_api_module(const artik_module_ops module);
 
+	/*!
+	 *  \brief Structure reporting how a module was preloaded
+	 */
+	typedef struct {
+		/*!
+		 *  \brief Name of the module
+		 */
+		char name[MAX_MODULE_NAME];
+		/*!
+		 *  \brief S_OK if the module is loaded, error code otherwise
+		 */
+		artik_error result;
+		/*!
+		 *  \brief Time spent loading the module, in microseconds
+		 */
+		uint64_t load_usec;
+	} artik_module_load_info;
+
+	/*!
+	 *  \brief Load API modules ahead of their first request
+	 *
+	 *  Loads and binds the libraries of the requested modules so that the
+	 *  first call to artik_request_api_module for them does not pay for
+	 *  it. Preloaded modules stay loaded until the process exits.
+	 *
+	 *  Modules can also be preloaded at startup, in a background thread,
+	 *  by setting the ARTIK_PRELOAD_MODULES environment variable to a
+	 *  comma separated list of module names or to "all".
+	 *  ARTIK_PRELOAD_THREADS sets the number of loading threads. Forking
+	 *  and exiting the process wait for the background thread to finish.
+	 *
+	 *  \param[in] names Array of module names to load, NULL to load all
+	 *             the modules available for the platform.
+	 *  \param[in] num Number of entries in \ref names, ignored if
+	 *             \ref names is NULL.
+	 *  \param[in] num_threads Number of threads loading the modules in
+	 *             parallel, 0 or 1 to load them from the calling thread.
+	 *  \param[out] info Optional array receiving the result and load time
+	 *              of each module, in the same order as \ref names or as
+	 *              returned by artik_get_available_modules. Can be NULL.
+	 *
+	 *  \return S_OK if all the modules were loaded, error code otherwise
+	 */
+	artik_error artik_preload_modules(const char * const *names, int num,
+			int num_threads, artik_module_load_info *info);
+
 	/*!
 	 *  \brief Get platform ID
 	 *
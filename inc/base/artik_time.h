@@ -139,6 +139,141 @@ extern "C" {
 		ARTIK_TIME_GMT12
 	} artik_time_zone;
 
+	/*!
+	 *  \brief Latency histogram handle type
+	 *
+	 *  Handle type used to reference a histogram of durations
+	 *  created with the Time API.
+	 */
+	typedef void *artik_time_histogram;
+
+	/*!
+	 *  \brief Running timer type
+	 *
+	 *  Filled up by start_timer, the time elapsed until stop_timer
+	 *  is called is recorded into the histogram.
+	 */
+	typedef struct {
+		/*!
+		 *  \brief Histogram receiving the measured duration
+		 */
+		artik_time_histogram hist;
+		/*!
+		 *  \brief Monotonic time at which the timer was started
+		 */
+		uint64_t start_ns;
+	} artik_time_timer;
+
+	/*!
+	 *  \brief Histogram statistics type
+	 *
+	 *  Summary of the durations recorded into a histogram, in
+	 *  nanoseconds. Percentiles are approximated by the bucket
+	 *  holding them and are accurate to within 1/8 of their value.
+	 */
+	typedef struct {
+		/*!
+		 *  \brief Number of recorded durations
+		 */
+		uint64_t count;
+		/*!
+		 *  \brief Shortest recorded duration
+		 */
+		uint64_t min_ns;
+		/*!
+		 *  \brief Longest recorded duration
+		 */
+		uint64_t max_ns;
+		/*!
+		 *  \brief Average of the recorded durations
+		 */
+		uint64_t mean_ns;
+		/*!
+		 *  \brief Median duration
+		 */
+		uint64_t p50_ns;
+		/*!
+		 *  \brief 90th percentile
+		 */
+		uint64_t p90_ns;
+		/*!
+		 *  \brief 99th percentile
+		 */
+		uint64_t p99_ns;
+	} artik_time_histogram_stats;
+
+	/*!
+	 *  \brief NTP synchronization configuration type
+	 */
+	typedef struct {
+		/*!
+		 *  \brief NTP servers to query in parallel, as "host" or
+		 *         "host:port"
+		 */
+		const char *const *servers;
+		/*!
+		 *  \brief Number of entries of 'servers'
+		 */
+		unsigned int num_servers;
+		/*!
+		 *  \brief Number of samples taken from each server,
+		 *         0 for the default (4)
+		 */
+		unsigned int samples;
+		/*!
+		 *  \brief Time allowed for the whole synchronization in
+		 *         milliseconds, 0 for the default (10 seconds)
+		 */
+		unsigned int timeout_ms;
+		/*!
+		 *  \brief Only measure the offset, leave the system clock
+		 *         untouched
+		 */
+		bool dry_run;
+	} artik_time_ntp_config;
+
+	/*!
+	 *  \brief NTP synchronization result type
+	 */
+	typedef struct {
+		/*!
+		 *  \brief Offset of the system clock from the servers:
+		 *         positive when the system clock is late
+		 */
+		int64_t offset_ns;
+		/*!
+		 *  \brief Round trip delay to the best server
+		 */
+		uint64_t delay_ns;
+		/*!
+		 *  \brief Dispersion of the offsets between samples and
+		 *         between the selected servers
+		 */
+		uint64_t jitter_ns;
+		/*!
+		 *  \brief Number of servers that answered
+		 */
+		unsigned int servers;
+		/*!
+		 *  \brief Number of valid samples received
+		 */
+		unsigned int samples;
+		/*!
+		 *  \brief Number of servers agreeing on the time, the
+		 *         others were rejected as falsetickers
+		 */
+		unsigned int survivors;
+		/*!
+		 *  \brief True if the offset was too large to be slewed
+		 *         and the clock was stepped
+		 */
+		bool stepped;
+		/*!
+		 *  \brief True if the system clock was corrected
+		 */
+		bool adjusted;
+	} artik_time_ntp_stats;
+
 	/*!
 	 * \brief     This callback function gets triggered after timeout
 	 * \param[in] user_data The user data passed from the register
@@ -146,6 +281,19 @@ extern "C" {
 	 */
 	typedef void(*alarm_callback)(void *user_data);
 
+	/*!
+	 * \brief     This callback function gets triggered once an
+	 *            asynchronous NTP synchronization completed
+	 * \param[in] result S_OK on success, error code otherwise
+	 * \param[in] stats Result of the synchronization, only valid
+	 *            during the call
+	 * \param[in] user_data The user data passed from the register
+	 *            callback function
+	 */
+	typedef void(*ntp_callback)(artik_error result,
+				const artik_time_ntp_stats *stats,
+				void *user_data);
+
 	/*! \struct artik_time_module
 	 *
 	 *  \brief Time module operations
@@ -194,6 +342,9 @@ extern "C" {
 		/*!
 		 *  \brief Get system tick
 		 *
+		 *  The tick is monotonic and is not affected by changes
+		 *  of the system time.
+		 *
 		 *  \return Number of milliseconds corresponding to the
 		 *          system tick
 		 */
@@ -263,6 +414,9 @@ extern "C" {
 		/*!
 		 *  \brief Synchronize system date with remote NTP server
 		 *
+		 *  Blocks until the server answered, see sync_ntp_async
+		 *  for the way the clock is corrected.
+		 *
 		 *  \param[in] hostname Hostname of NTP server.
 		 *
 		 *  \return S_OK on success, error code otherwise
@@ -304,6 +458,193 @@ extern "C" {
 		 */
 		artik_error(*convert_time_to_timestamp) (const artik_time *date,
 							 int64_t *timestamp);
+		/*!
+		 *  \brief Get the monotonic time in nanoseconds
+		 *
+		 *  The monotonic clock starts at an unspecified point and
+		 *  is not affected by changes of the system time. It is
+		 *  meant for measuring durations and costs a few tens of
+		 *  nanoseconds per call.
+		 *
+		 *  \return Nanoseconds elapsed on the monotonic clock
+		 */
+		uint64_t(*get_monotonic_ns) (void);
+		/*!
+		 *  \brief Get the monotonic time in microseconds
+		 *
+		 *  \return Microseconds elapsed on the monotonic clock
+		 */
+		uint64_t(*get_monotonic_us) (void);
+		/*!
+		 *  \brief Get the monotonic time in milliseconds
+		 *
+		 *  \return Milliseconds elapsed on the monotonic clock
+		 */
+		uint64_t(*get_monotonic_ms) (void);
+		/*!
+		 *  \brief Get the time elapsed since a monotonic time
+		 *
+		 *  \param[in] start_ns Time returned by get_monotonic_ns
+		 *
+		 *  \return Nanoseconds elapsed since 'start_ns'
+		 */
+		uint64_t(*get_elapsed_ns) (uint64_t start_ns);
+		/*!
+		 *  \brief Create a histogram of durations
+		 *
+		 *  Recording into a histogram is lock-free and can be
+		 *  done from any thread.
+		 *
+		 *  \param[out] hist Handle referencing the histogram for
+		 *              later use.
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*create_histogram) (artik_time_histogram *hist);
+		/*!
+		 *  \brief Destroy a histogram
+		 *
+		 *  \param[in] hist Handle of the histogram to destroy.
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*destroy_histogram) (artik_time_histogram hist);
+		/*!
+		 *  \brief Record a duration into a histogram
+		 *
+		 *  \param[in] hist Handle of the histogram.
+		 *  \param[in] duration_ns Duration to record in nanoseconds
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*record_histogram) (artik_time_histogram hist,
+						uint64_t duration_ns);
+		/*!
+		 *  \brief Get the statistics of a histogram
+		 *
+		 *  \param[in] hist Handle of the histogram.
+		 *  \param[out] stats Summary of the recorded durations
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*get_histogram_stats) (artik_time_histogram hist,
+					artik_time_histogram_stats *stats);
+		/*!
+		 *  \brief Forget the durations recorded into a histogram
+		 *
+		 *  \param[in] hist Handle of the histogram.
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*reset_histogram) (artik_time_histogram hist);
+		/*!
+		 *  \brief Start measuring a duration
+		 *
+		 *  \param[in] hist Handle of the histogram receiving the
+		 *             duration when the timer is stopped.
+		 *  \param[out] timer Timer to pass to stop_timer
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*start_timer) (artik_time_histogram hist,
+					   artik_time_timer *timer);
+		/*!
+		 *  \brief Stop a timer and record the elapsed time into
+		 *         its histogram
+		 *
+		 *  \param[in] timer Timer filled up by start_timer
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*stop_timer) (artik_time_timer *timer);
+		/*!
+		 *  \brief Create an alarm to set off after an amount of
+		 *         milliseconds, then periodically.
+		 *
+		 *  The delay is measured on the monotonic clock and is not
+		 *  affected by changes of the system time. Periodic alarms
+		 *  do not drift: each period starts when the previous one
+		 *  was due, periods missed are skipped.
+		 *
+		 *  \param[in] msecond Number of milliseconds to elapse
+		 *             before the alarm is triggered
+		 *  \param[in] period Number of milliseconds between the
+		 *             following triggers, 0 for a one-shot alarm
+		 *  \param[out] handle Handle referencing the alarm for
+		 *              later use.
+		 *  \param[in] func The callback function which will be called
+		 *             when the alarm is triggered (mandatory).
+		 *  \param[in] user_data The user data passed from the register
+		 *             callback function.
+		 *
+		 *  \return S_OK on success, error code otherwise
+		 */
+		artik_error(*create_alarm_msecond) (artik_msecond msecond,
+						    artik_msecond period,
+						    artik_alarm_handle *handle,
+						    alarm_callback func,
+						    void *user_data);
+		/*!
+		 *  \brief Create an alarm set off according to a cron
+		 *         schedule
+		 *
+		 *  The schedule follows crontab(5): "minute hour day month
+		 *  weekday" where each field is '*', a value, a range "a-b"
+		 *  or a comma separated list of them, optionally followed by
+		 *  a step "/n". The "@yearly", "@monthly", "@weekly",
+		 *  "@daily" and "@hourly" shortcuts are also accepted.
+		 *
+		 *  \param[in] gmt Time zone the schedule is expressed in.
+		 *  \param[in] schedule Cron schedule of the alarm
+		 *  \param[out] handle Handle referencing the alarm for
+		 *              later use.
+		 *  \param[in] func The callback function which will be called
+		 *             when the alarm is triggered (mandatory).
+		 *  \param[in] user_data The user data passed from the register
+		 *             callback function.
+		 *
+		 *  \return S_OK on success,
+		 *          E_BAD_ARGS if 'schedule' is malformed or never
+		 *          matches, error code otherwise
+		 */
+		artik_error(*create_alarm_cron) (artik_time_zone gmt,
+						 const char *schedule,
+						 artik_alarm_handle *handle,
+						 alarm_callback func,
+						 void *user_data);
+		/*!
+		 *  \brief Synchronize system date with NTP servers
+		 *         without blocking
+		 *
+		 *  The servers are queried in parallel from the loop. The
+		 *  best sample of each server is kept, servers disagreeing
+		 *  with the majority are discarded (RFC 5905 selection) and
+		 *  the offsets of the others are combined. Offsets below
+		 *  128ms are slewed, larger ones step the clock.
+		 *
+		 *  \param[in] config Servers and sampling parameters
+		 *  \param[in] func The callback function called from the
+		 *             loop once done (mandatory).
+		 *  \param[in] user_data The user data passed to the callback
+		 *             function.
+		 *
+		 *  \return S_OK if the synchronization started,
+		 *          E_BUSY if one is already in progress,
+		 *          error code otherwise
+		 */
+		artik_error(*sync_ntp_async) (const artik_time_ntp_config *config,
+					      ntp_callback func,
+					      void *user_data);
+		/*!
+		 *  \brief Get the result of the last NTP synchronization
+		 *
+		 *  \param[out] stats Result of the synchronization
+		 *
+		 *  \return S_OK on success,
+		 *          E_NOT_INITIALIZED if no synchronization succeeded,
+		 *          error code otherwise
+		 */
+		artik_error(*get_ntp_stats) (artik_time_ntp_stats *stats);
 
 
 
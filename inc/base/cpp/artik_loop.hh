@@ -61,6 +61,11 @@ class Loop {
   artik_error add_idle_callback(int *idle_id, idle_callback func,
       void *user_data);
   artik_error remove_idle_callback(int idle_id);
+  artik_error enable_stats(bool enable, unsigned int budget_usec);
+  artik_error get_stats(artik_loop_stats *stats);
+  artik_error get_callback_stats(artik_loop_callback_stats *stats, int *num);
+  void dump_stats(void);
+  void reset_stats(void);
 };
 
 }  // namespace artik
@@ -45,6 +45,8 @@ class Module {
           int *num_modules);
   bool is_module_available(artik_module_id_t id);
   char *get_device_info(void);
+  artik_error preload_modules(const char * const *names, int num,
+          int num_threads, artik_module_load_info *info);
 
   artik_error get_bt_mac_address(char *addr);
   artik_error get_wifi_mac_address(char *addr);
@@ -48,6 +48,10 @@ class Alarm {
       artik_time_module *);
   Alarm(artik_time_zone, artik_msecond, alarm_callback, void *,
       artik_time_module *);
+  Alarm(artik_msecond, artik_msecond, alarm_callback, void *,
+      artik_time_module *);
+  Alarm(artik_time_zone, const char *, alarm_callback, void *,
+      artik_time_module *);
 
   Alarm();
   ~Alarm();
@@ -77,12 +81,65 @@ class Time {
   artik_error get_time_str(char *, int, char *const, artik_time_zone) const;
   artik_msecond get_tick(void) const;
   artik_error sync_ntp(const char*);
+  artik_error sync_ntp_async(const artik_time_ntp_config*, ntp_callback,
+      void *);
+  artik_error get_ntp_stats(artik_time_ntp_stats*) const;
   Alarm *create_alarm_second(artik_time_zone, artik_msecond, alarm_callback,
       void *);
   Alarm *create_alarm_date(artik_time_zone, artik_time, alarm_callback, void *);
+  Alarm *create_alarm_msecond(artik_msecond, artik_msecond, alarm_callback,
+      void *);
+  Alarm *create_alarm_cron(artik_time_zone, const char *, alarm_callback,
+      void *);
   int compare_dates(const artik_time *date1, const artik_time *date2);
   artik_error convert_timestamp_to_time(const int64_t, artik_time*);
   artik_error convert_time_to_timestamp(const artik_time*, int64_t*);
+  uint64_t get_monotonic_ns(void) const;
+  uint64_t get_monotonic_us(void) const;
+  uint64_t get_monotonic_ms(void) const;
+  uint64_t get_elapsed_ns(uint64_t) const;
+};
+
+/*!
+ *  \brief Histogram C++ Class
+ *
+ *  Histogram of durations, see \ref artik_time_histogram
+ */
+class Histogram {
+ private:
+  artik_time_module* m_module;
+  artik_time_histogram m_handle;
+
+  Histogram(Histogram const &);
+  Histogram &operator=(Histogram const &);
+
+ public:
+  Histogram();
+  ~Histogram();
+
+  artik_time_histogram get_handle(void) const;
+  artik_time_module *get_module(void) const;
+  artik_error record(uint64_t);
+  artik_error get_stats(artik_time_histogram_stats*) const;
+  artik_error reset(void);
+};
+
+/*!
+ *  \brief ScopedTimer C++ Class
+ *
+ *  Records the lifetime of the object into a histogram
+ */
+class ScopedTimer {
+ private:
+  artik_time_module* m_module;
+  artik_time_timer m_timer;
+
+  ScopedTimer(ScopedTimer const &);
+  ScopedTimer &operator=(ScopedTimer const &);
+
+ public:
+  explicit ScopedTimer(Histogram const &);
+  ~ScopedTimer();
 };
 
 }  // namespace artik
@@ -107,6 +107,32 @@ typedef struct {
 
 } artik_sensor_config;
 
+/*! \struct artik_sensor_vector
+ *  \brief Sample of a multi-axis sensor
+ *
+ *  The three axes are read in one bus transaction, so that they
+ *  belong to the same measurement.
+ */
+typedef struct {
+	/*!
+	 *  \brief Time the sample was taken in nanoseconds
+	 *  (CLOCK_MONOTONIC)
+	 */
+	unsigned long long timestamp_ns;
+	/*!
+	 *  \brief Raw value on the X axis
+	 */
+	int x;
+	/*!
+	 *  \brief Raw value on the Y axis
+	 */
+	int y;
+	/*!
+	 *  \brief Raw value on the Z axis
+	 */
+	int z;
+} artik_sensor_vector;
+
 /*! \struct artik_sensor_accelerometer
  *  \brief SENSOR ACCELEROMETER devices data structure
  *
@@ -182,6 +208,35 @@ typedef struct {
 	 */
 	artik_error(*get_speed_z) (artik_sensor_handle handle,
 				   int *store);
+	/*!
+	 *  \brief Read the speed on the three axes at once
+	 *
+	 *  \param[in] handle handle tied to the requested ACCELEROMETER
+	 *             instance.
+	 *             This handle is returned by the 'request' function.
+	 *  \param[out] vector sample read
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_vector) (artik_sensor_handle handle,
+				   artik_sensor_vector *vector);
+	/*!
+	 *  \brief Read consecutive samples at the output data rate of
+	 *         the device
+	 *
+	 *  The call blocks until all the samples are read, which takes
+	 *  'count' periods of the device.
+	 *
+	 *  \param[in] handle handle tied to the requested ACCELEROMETER
+	 *             instance.
+	 *             This handle is returned by the 'request' function.
+	 *  \param[out] vectors array receiving the samples, oldest first
+	 *  \param[in] count number of samples to read
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_block) (artik_sensor_handle handle,
+				  artik_sensor_vector *vectors, int count);
 
 } artik_sensor_accelerometer;
 
@@ -256,6 +311,38 @@ typedef struct {
 	 */
 	artik_error(*get_pitch) (artik_sensor_handle handle,
 				   int *store);
+	/*!
+	 *  \brief Read the angular rate on the three axes at once
+	 *
+	 *  x, y and z of the sample are the pitch, roll and yaw
+	 *  values returned by the getters.
+	 *
+	 *  \param[in] handle handle tied to the requested GYROMETER
+	 *             instance.
+	 *             This handle is returned by the 'request' function.
+	 *  \param[out] vector sample read
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_vector) (artik_sensor_handle handle,
+				   artik_sensor_vector *vector);
+	/*!
+	 *  \brief Read consecutive samples at the output data rate of
+	 *         the device
+	 *
+	 *  The call blocks until all the samples are read, which takes
+	 *  'count' periods of the device.
+	 *
+	 *  \param[in] handle handle tied to the requested GYROMETER
+	 *             instance.
+	 *             This handle is returned by the 'request' function.
+	 *  \param[out] vectors array receiving the samples, oldest first
+	 *  \param[in] count number of samples to read
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_block) (artik_sensor_handle handle,
+				  artik_sensor_vector *vectors, int count);
 
 } artik_sensor_gyro;
 
@@ -608,6 +695,151 @@ typedef struct {
 
 } artik_sensor_hall;
 
+/*!
+ *  \brief Maximum number of values in a sensor sample
+ */
+#define ARTIK_SENSOR_MAX_VALUES	3
+
+/*!
+ *  \brief Maximum sampling rate in Hz
+ *
+ *  Each sampling period wakes the loop up, faster rates would keep
+ *  it busy. Devices with a hardware FIFO are read once per batch.
+ */
+#define ARTIK_SENSOR_MAX_RATE_HZ	20000
+
+/*!
+ *  \brief Sampling handle type
+ *
+ *  Handle of a sensor registered to the sampling scheduler
+ */
+typedef void *artik_sensor_sampling_handle;
+
+/*!
+ *  \brief Sample of a sensor taken by the sampling scheduler
+ */
+typedef struct {
+	/*!
+	 *  \brief Time the sample was taken in nanoseconds
+	 *  (CLOCK_MONOTONIC). Samples read from a hardware FIFO are
+	 *  dated back from the time of the read.
+	 */
+	unsigned long long timestamp_ns;
+	/*!
+	 *  \brief Values of the sample, in the order of the getters of
+	 *  the sensor: x, y, z for an accelerometer, yaw, roll, pitch
+	 *  for a gyro, celsius and fahrenheit for a temperature sensor,
+	 *  and the only value for the other sensors.
+	 */
+	int values[ARTIK_SENSOR_MAX_VALUES];
+} artik_sensor_sample;
+
+/*!
+ *  \brief Sampling parameters of a sensor
+ */
+typedef struct {
+	/*!
+	 *  \brief Sampling rate in Hz, at most
+	 *  \ref ARTIK_SENSOR_MAX_RATE_HZ
+	 */
+	unsigned int rate_hz;
+	/*!
+	 *  \brief Number of samples passed to each callback, 0 is
+	 *  the same as 1
+	 */
+	unsigned int batch;
+	/*!
+	 *  \brief Let the device queue the samples in its hardware
+	 *  FIFO, and read them once per batch. The rate is then
+	 *  rounded up to one the device supports. Ignored by
+	 *  devices without a FIFO.
+	 */
+	bool use_fifo;
+	/*!
+	 *  \brief Number of the last samples kept for the readers
+	 *  opened with \ref open_reader, rounded up to a power of
+	 *  two. Samples are added by batches, when they are passed
+	 *  to the callback. 0 disables the readers.
+	 */
+	unsigned int ring_size;
+} artik_sensor_sampling_config;
+
+/*!
+ *  \brief Sampling counters of a sensor
+ */
+typedef struct {
+	/*!
+	 *  \brief Number of samples delivered to the callback and
+	 *  the readers
+	 */
+	unsigned long long samples;
+	/*!
+	 *  \brief Number of reads from the device, one per getter
+	 *  called for sensors whose driver cannot read a whole
+	 *  sample at once
+	 */
+	unsigned long long reads;
+	/*!
+	 *  \brief Number of reads that failed
+	 */
+	unsigned long long errors;
+	/*!
+	 *  \brief Number of sampling periods skipped because the
+	 *  loop was late, or hardware FIFO overruns
+	 */
+	unsigned long long missed;
+	/*!
+	 *  \brief Actual sampling rate in Hz
+	 */
+	unsigned int rate_hz;
+} artik_sensor_sampling_stats;
+
+/*!
+ *  \brief Reader handle type
+ *
+ *  Handle of a consumer of the samples of a sensor
+ */
+typedef void *artik_sensor_reader_handle;
+
+/*!
+ *  \brief View of the samples of a sensor given to a reader
+ */
+typedef struct {
+	/*!
+	 *  \brief Number of samples of the sensor making one sample
+	 *  of the reader, 0 is the same as 1
+	 */
+	unsigned int decimation;
+	/*!
+	 *  \brief Return the average of these samples instead of the
+	 *  last one. The timestamp is the one of the last sample.
+	 */
+	bool average;
+} artik_sensor_view;
+
+/*!
+ *  \brief Counters of a reader
+ */
+typedef struct {
+	/*!
+	 *  \brief Number of samples returned to the reader
+	 */
+	unsigned long long samples;
+	/*!
+	 *  \brief Number of samples of the sensor overwritten before
+	 *  the reader could take them
+	 */
+	unsigned long long lost;
+} artik_sensor_reader_stats;
+
+/*!
+ *  \brief Sensor samples callback type
+ *
+ *  Callback prototype for receiving batches of samples
+ */
+typedef void (*artik_sensor_samples_callback)(void *user_data,
+				const artik_sensor_sample *samples, int count);
+
 /*! \struct artik_sensor_module
  *
  *  \brief SENSOR module operations
@@ -747,6 +979,117 @@ typedef struct {
 	 */
 	artik_sensor_config * (*get_hall_sensor)(unsigned int index);
 
+	/*!
+	 *  \brief Sample a sensor periodically from the loop
+	 *
+	 *  All the sensors being sampled share a single timer. Each
+	 *  sample is read in one bus transaction when the device
+	 *  driver supports it, instead of one per value through the
+	 *  getters. Samples are timestamped and passed to the callback
+	 *  by batches, from the loop.
+	 *
+	 *  \param[out] sampling Handle filled by the function
+	 *  \param[in] config Configuration the sensor was requested with
+	 *  \param[in] handle Handle returned by \ref request
+	 *  \param[in] params Sampling rate and batch size
+	 *  \param[in] callback Function receiving the samples, can be
+	 *             NULL if they are only taken by readers
+	 *  \param[in] user_data Pointer passed to the callback
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*start_sampling)(artik_sensor_sampling_handle *sampling,
+			artik_sensor_config *config, artik_sensor_handle handle,
+			const artik_sensor_sampling_config *params,
+			artik_sensor_samples_callback callback,
+			void *user_data);
+
+	/*!
+	 *  \brief Stop sampling a sensor
+	 *
+	 *  Samples of an incomplete batch are dropped. Can be called
+	 *  from the samples callback.
+	 *
+	 *  \param[in] sampling Handle returned by \ref start_sampling
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*stop_sampling)(artik_sensor_sampling_handle sampling);
+
+	/*!
+	 *  \brief Get the sampling counters of a sensor
+	 *
+	 *  \param[in] sampling Handle returned by \ref start_sampling
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*get_sampling_stats)(artik_sensor_sampling_handle sampling,
+			artik_sensor_sampling_stats *stats);
+
+	/*!
+	 *  \brief Open a reader on the samples of a sensor
+	 *
+	 *  Each reader has its own position in the last samples of the
+	 *  sensor, so that several consumers share one acquisition.
+	 *  The sampling must have been started with a ring size. The
+	 *  reader starts with the next sample, and keeps the samples
+	 *  taken before the sampling stops.
+	 *
+	 *  Must be called from the thread running the loop, like
+	 *  \ref start_sampling.
+	 *
+	 *  \param[out] reader Handle filled by the function
+	 *  \param[in] sampling Handle returned by \ref start_sampling
+	 *  \param[in] view Decimation of the samples, NULL to read
+	 *             all of them
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*open_reader)(artik_sensor_reader_handle *reader,
+			artik_sensor_sampling_handle sampling,
+			const artik_sensor_view *view);
+
+	/*!
+	 *  \brief Take the samples available to a reader
+	 *
+	 *  Does not block and does not take any lock, so that it can
+	 *  be called from any thread while the loop writes samples.
+	 *  A reader must not be used from several threads at once.
+	 *  Samples overwritten before being read are counted as lost.
+	 *
+	 *  \param[in] reader Handle returned by \ref open_reader
+	 *  \param[out] samples Array receiving the samples, oldest first
+	 *  \param[in] max Size of the array
+	 *  \param[out] count Number of samples returned
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_samples)(artik_sensor_reader_handle reader,
+			artik_sensor_sample *samples, int max, int *count);
+
+	/*!
+	 *  \brief Close a reader
+	 *
+	 *  Can be called before or after the sampling is stopped.
+	 *
+	 *  \param[in] reader Handle returned by \ref open_reader
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*close_reader)(artik_sensor_reader_handle reader);
+
+	/*!
+	 *  \brief Get the counters of a reader
+	 *
+	 *  \param[in] reader Handle returned by \ref open_reader
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*get_reader_stats)(artik_sensor_reader_handle reader,
+			artik_sensor_reader_stats *stats);
+
 } artik_sensor_module;
 
 extern artik_sensor_module sensor_module;
@@ -78,6 +78,8 @@ class AccelerometerSensor : public virtual SensorDevice {
   int get_speed_x(void) const;
   int get_speed_y(void) const;
   int get_speed_z(void) const;
+  artik_sensor_vector read_vector(void) const;
+  std::vector<artik_sensor_vector> read_block(int count) const;
 
   friend class Sensor;
 };
@@ -298,6 +300,8 @@ class GyroSensor : public virtual SensorDevice {
   int get_yaw(void) const;
   int get_roll(void) const;
   int get_pitch(void) const;
+  artik_sensor_vector read_vector(void) const;
+  std::vector<artik_sensor_vector> read_block(int count) const;
 
   friend class Sensor;
 };
@@ -53,6 +53,34 @@ extern "C" {
  */
 typedef void *artik_adc_handle;
 
+/*!
+ *  \brief Build a pin number from an IIO device and a channel
+ *
+ *  Pin numbers built with this macro address the in_voltage\a channel
+ *  input of /sys/bus/iio/devices/iio:device\a device instead of the
+ *  ADC of the board. Only supported on Linux.
+ */
+#define ADC_DEVICE_PIN(device, channel) \
+	(0x40000000 | (((device) & 0x3fff) << 16) | ((channel) & 0xffff))
+
+/*!
+ *  \brief ADC stream handle type
+ *
+ *  Handle type used to carry information for a capture
+ *  started with \ref start_stream
+ */
+typedef void *artik_adc_stream_handle;
+
+/*!
+ *  \brief ADC stream callback type
+ *
+ *  Callback prototype for receiving blocks of samples. Samples
+ *  are interleaved, one scan holds one sample of each pin in the
+ *  order of \ref artik_adc_stream_config.pins.
+ */
+typedef void (*artik_adc_stream_callback)(void *user_data,
+				const int *samples, int num_scans);
+
 /*! \struct artik_adc_config
  *  \brief ADC configuration structure
  *
@@ -75,6 +103,53 @@ typedef struct {
 
 } artik_adc_config;
 
+/*! \struct artik_adc_stream_config
+ *  \brief ADC stream configuration structure
+ *
+ *  Structure containing the configuration of a buffered
+ *  capture of several ADC pins
+ */
+typedef struct {
+	/*!
+	 *  \brief Pins to capture, all on the same ADC
+	 */
+	const int *pins;
+	/*!
+	 *  \brief Number of elements of \ref pins
+	 */
+	int num_pins;
+	/*!
+	 *  \brief Sampling frequency in Hz, 0 to keep the current
+	 *  frequency of the ADC
+	 */
+	unsigned int sample_rate;
+	/*!
+	 *  \brief Number of scans the ADC buffers before waking
+	 *  the reader up, and maximum number of scans passed to the
+	 *  callback at once
+	 */
+	unsigned int block_scans;
+	/*!
+	 *  \brief Number of scans kept until \ref read_stream is
+	 *  called, when no callback is given
+	 */
+	unsigned int ring_scans;
+} artik_adc_stream_config;
+
+/*! \struct artik_adc_stream_stats
+ *  \brief ADC stream counters
+ */
+typedef struct {
+	/*!
+	 *  \brief Number of scans read from the ADC
+	 */
+	unsigned long long scans;
+	/*!
+	 *  \brief Number of scans dropped because the ring was full
+	 */
+	unsigned long long overruns;
+} artik_adc_stream_stats;
+
 /*! \struct artik_adc_module
  *
  *  \brief ADC module operations
@@ -120,6 +195,81 @@ typedef struct {
 	 */
 	artik_error(*get_value) (artik_adc_handle handle,
 				int *value);
+	/*!
+	 *  \brief Get values of several ADC instances
+	 *
+	 *  \param[in] handles Handles tied to the requested ADC
+	 *             instances to read.
+	 *  \param[in] count Number of elements of \a handles
+	 *  \param[out] values Filled up with the value of each
+	 *              instance, in the order of \a handles
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*get_values) (artik_adc_handle *handles, int count,
+				int *values);
+	/*!
+	 *  \brief Start a buffered capture of several pins
+	 *
+	 *  The ADC converts the pins at the requested rate and
+	 *  stores the samples in a kernel buffer, they are read
+	 *  in binary blocks instead of one value at a time.
+	 *
+	 *  If a callback is given, blocks are passed to it from the
+	 *  loop. Otherwise a capture thread stores them in a ring
+	 *  emptied by \ref read_stream.
+	 *
+	 *  \ref get_value may fail with E_BUSY on the captured
+	 *  pins while the stream is running. Only one stream can run
+	 *  per ADC device, starting another one fails with E_BUSY.
+	 *
+	 *  \param[out] handle Handle tied to the capture returned by
+	 *              the function.
+	 *  \param[in] config Configuration of the capture
+	 *  \param[in] callback Function to call with the blocks of
+	 *             samples, NULL to use \ref read_stream
+	 *  \param[in] user_data Pointer to user data that will be
+	 *             passed as a parameter to the callback
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*start_stream) (artik_adc_stream_handle *handle,
+				const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data);
+	/*!
+	 *  \brief Read samples of a capture started without callback
+	 *
+	 *  Does not wait for samples.
+	 *
+	 *  \param[in] handle Handle returned by \ref start_stream
+	 *  \param[out] samples Filled up with interleaved samples,
+	 *              \a max_scans times the number of pins
+	 *  \param[in] max_scans Maximum number of scans to read
+	 *
+	 *  \return Number of scans read, negative error code on
+	 *          failure
+	 */
+	int (*read_stream) (artik_adc_stream_handle handle, int *samples,
+				int max_scans);
+	/*!
+	 *  \brief Get the counters of a capture
+	 *
+	 *  \param[in] handle Handle returned by \ref start_stream
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*get_stream_stats) (artik_adc_stream_handle handle,
+				artik_adc_stream_stats *stats);
+	/*!
+	 *  \brief Stop a capture
+	 *
+	 *  \param[in] handle Handle returned by \ref start_stream
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*stop_stream) (artik_adc_stream_handle handle);
 } artik_adc_module;
 
 extern artik_adc_module adc_module;
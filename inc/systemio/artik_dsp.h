@@ -0,0 +1,241 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__ARTIK_DSP_H__
+#define	__ARTIK_DSP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "artik_error.h"
+#include "artik_types.h"
+
+/*! \file artik_dsp.h
+ *
+ *  \brief DSP helpers for blocks of samples
+ *
+ *  Functions converting and filtering the blocks of samples
+ *  returned by the ADC streams and the sensor devices. The
+ *  kernels use NEON or SSE2 when the library is built for a
+ *  target supporting them, and plain C otherwise.
+ *
+ *  \example dsp_test/artik_dsp_bench.c
+ */
+
+/*!
+ *  \brief FIR filter handle type
+ *
+ *  Handle type used to carry the taps and the history
+ *  of a FIR filter.
+ */
+typedef struct artik_dsp_fir artik_dsp_fir;
+
+/*!
+ *  \brief IIR filter handle type
+ *
+ *  Handle type used to carry the coefficients and the
+ *  state of a cascade of biquad sections.
+ */
+typedef struct artik_dsp_iir artik_dsp_iir;
+
+/*! \struct artik_dsp_calibration
+ *  \brief Calibration of raw samples
+ *
+ *  Raw samples are converted with
+ *  value = (raw - offset) * scale + bias
+ */
+typedef struct {
+	/*!
+	 *  \brief Raw value measured for the reference input
+	 */
+	int offset;
+	/*!
+	 *  \brief Physical units per raw count
+	 */
+	float scale;
+	/*!
+	 *  \brief Physical value of the reference input
+	 */
+	float bias;
+} artik_dsp_calibration;
+
+/*! \struct artik_dsp_biquad
+ *  \brief Coefficients of a biquad section
+ *
+ *  Coefficients normalized so that a0 is 1:
+ *  y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ */
+typedef struct {
+	float b0;
+	float b1;
+	float b2;
+	float a1;
+	float a2;
+} artik_dsp_biquad;
+
+/*! \struct artik_dsp_stats
+ *  \brief Statistics of a block of samples
+ */
+typedef struct {
+	float min;
+	float max;
+	float mean;
+	/*!
+	 *  \brief Root mean square of the samples
+	 */
+	float rms;
+} artik_dsp_stats;
+
+/*!
+ *  \brief Convert raw samples to physical values
+ *
+ *  \param[in] in Raw samples
+ *  \param[out] out Converted values, \a count elements
+ *  \param[in] count Number of samples
+ *  \param[in] cal Calibration to apply
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_scale(const int *in, float *out, int count,
+				const artik_dsp_calibration *cal);
+
+/*!
+ *  \brief Extract one channel of interleaved scans
+ *
+ *  Gives the layout expected by the other functions to
+ *  samples returned by an ADC stream capturing several pins.
+ *
+ *  \param[in] in Interleaved scans
+ *  \param[in] num_channels Number of samples per scan
+ *  \param[in] channel Index of the channel to extract
+ *  \param[out] out Samples of \a channel, \a num_scans elements
+ *  \param[in] num_scans Number of scans in \a in
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_deinterleave(const int *in, int num_channels,
+				int channel, int *out, int num_scans);
+
+/*!
+ *  \brief Create a FIR filter
+ *
+ *  y[n] = taps[0] x[n] + taps[1] x[n-1] + ...
+ *
+ *  Only one sample out of \a decimation is computed, which
+ *  makes the filter a decimator. Averaging taps (1 / N each)
+ *  give a moving average.
+ *
+ *  \param[out] fir Handle of the filter
+ *  \param[in] taps Coefficients, copied by the function
+ *  \param[in] num_taps Number of coefficients
+ *  \param[in] decimation Decimation factor, 1 to filter only
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_fir_create(artik_dsp_fir **fir, const float *taps,
+				int num_taps, int decimation);
+
+/*!
+ *  \brief Filter a block of samples
+ *
+ *  The filter keeps the history needed to process the next
+ *  block as if all blocks were contiguous.
+ *
+ *  \param[in] fir Handle of the filter
+ *  \param[in] in Input samples
+ *  \param[in] count Number of input samples
+ *  \param[out] out Output samples, room for
+ *		    count / decimation + 1 elements
+ *
+ *  \return Number of samples written to \a out, or a
+ *	    negative error code
+ */
+int artik_dsp_fir_process(artik_dsp_fir *fir, const float *in, int count,
+				float *out);
+
+/*!
+ *  \brief Clear the history of a FIR filter
+ *
+ *  \param[in] fir Handle of the filter
+ */
+void artik_dsp_fir_reset(artik_dsp_fir *fir);
+
+/*!
+ *  \brief Destroy a FIR filter
+ *
+ *  \param[in] fir Handle of the filter
+ */
+void artik_dsp_fir_destroy(artik_dsp_fir *fir);
+
+/*!
+ *  \brief Create an IIR filter
+ *
+ *  \param[out] iir Handle of the filter
+ *  \param[in] sections Biquad sections applied in order,
+ *		        copied by the function
+ *  \param[in] num_sections Number of elements of \a sections
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_iir_create(artik_dsp_iir **iir,
+		const artik_dsp_biquad *sections, int num_sections);
+
+/*!
+ *  \brief Filter a block of samples
+ *
+ *  \param[in] iir Handle of the filter
+ *  \param[in] in Input samples
+ *  \param[out] out Output samples, may be the same as \a in
+ *  \param[in] count Number of samples
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_iir_process(artik_dsp_iir *iir, const float *in,
+				float *out, int count);
+
+/*!
+ *  \brief Clear the state of an IIR filter
+ *
+ *  \param[in] iir Handle of the filter
+ */
+void artik_dsp_iir_reset(artik_dsp_iir *iir);
+
+/*!
+ *  \brief Destroy an IIR filter
+ *
+ *  \param[in] iir Handle of the filter
+ */
+void artik_dsp_iir_destroy(artik_dsp_iir *iir);
+
+/*!
+ *  \brief Compute the statistics of a block of samples
+ *
+ *  \param[in] in Samples
+ *  \param[in] count Number of samples, at least 1
+ *  \param[out] stats Statistics of the block
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_dsp_get_stats(const float *in, int count,
+				artik_dsp_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif				/* __ARTIK_DSP_H__ */
@@ -60,6 +60,25 @@ typedef void *artik_gpio_handle;
  */
 typedef unsigned int artik_gpio_id;
 
+/*!
+ *  \brief Build a GPIO ID from a GPIO chip and a line offset
+ *
+ *  IDs built with this macro address line \a line of
+ *  /dev/gpiochip\a chip instead of using the global
+ *  GPIO numbering. Only supported on Linux.
+ */
+#define GPIO_CHIP_LINE(chip, line) \
+	((artik_gpio_id)(0x40000000 | (((chip) & 0x3fff) << 16) | \
+	((line) & 0xffff)))
+
+/*!
+ *  \brief GPIO bulk handle type
+ *
+ *  Handle type used to carry information for a set of GPIOs
+ *  read or written together
+ */
+typedef void *artik_gpio_bulk_handle;
+
 /*!
  *  \brief GPIO callback type
  *
@@ -92,6 +111,58 @@ typedef enum {
 	GPIO_EDGE_INVALID
 } artik_gpio_edge_t;
 
+/*!
+ *  \brief GPIO edge event
+ *
+ *  Edge detected on a GPIO, as queued by the kernel
+ */
+typedef struct {
+	/*!
+	 *  \brief Time of the edge in nanoseconds, taken by the
+	 *  kernel when the interrupt occurred (CLOCK_MONOTONIC on
+	 *  recent kernels)
+	 */
+	unsigned long long timestamp_ns;
+	/*!
+	 *  \brief GPIO_EDGE_RISING or GPIO_EDGE_FALLING
+	 */
+	artik_gpio_edge_t edge;
+	/*!
+	 *  \brief Sequence number of the edge on the GPIO, starting
+	 *  at 1. Gaps show edges that were lost or filtered out.
+	 */
+	unsigned int sequence;
+} artik_gpio_event;
+
+/*!
+ *  \brief GPIO edge event counters
+ */
+typedef struct {
+	/*!
+	 *  \brief Number of events delivered to the callback
+	 */
+	unsigned long long events;
+	/*!
+	 *  \brief Number of edges lost because the event queue
+	 *  overflowed. When the kernel does not number the
+	 *  events, this is a lower bound deduced from consecutive
+	 *  edges of the same type.
+	 */
+	unsigned long long overflows;
+	/*!
+	 *  \brief Number of edges removed by the debounce filter
+	 */
+	unsigned long long filtered;
+} artik_gpio_event_stats;
+
+/*!
+ *  \brief GPIO edge events callback type
+ *
+ *  Callback prototype for receiving batches of edge events
+ */
+typedef void (*artik_gpio_events_callback)(void *user_data,
+				const artik_gpio_event *events, int count);
+
 /*!
  *  \brief GPIO configuration structure
  *
@@ -241,6 +312,101 @@ typedef struct {
 	 *
 	 */
 	void (*unset_change_callback)(artik_gpio_handle handle);
+	/*!
+	 *  \brief Request a set of GPIOs to read or write together
+	 *
+	 *  All the GPIOs must have the same direction, edges are
+	 *  ignored. Lines of the same GPIO chip are read or written
+	 *  in a single system call.
+	 *
+	 *  \param[out] handle Handle tied to the requested set of GPIOs
+	 *              returned by the function.
+	 *  \param[in] configs Configurations of the GPIOs to request
+	 *  \param[in] count Number of elements of \a configs
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*request_bulk)(artik_gpio_bulk_handle *handle,
+				artik_gpio_config *configs, int count);
+	/*!
+	 *  \brief Release a set of GPIOs
+	 *
+	 *  \param[in] handle Handle returned by the \ref request_bulk
+	 *             function.
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*release_bulk)(artik_gpio_bulk_handle handle);
+	/*!
+	 *  \brief Read the values of a set of GPIOs
+	 *
+	 *  \param[in] handle Handle returned by the \ref request_bulk
+	 *             function.
+	 *  \param[out] values Array filled with the values of the GPIOs,
+	 *              in the order of the configurations passed to
+	 *              \ref request_bulk
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*read_bulk)(artik_gpio_bulk_handle handle, int *values);
+	/*!
+	 *  \brief Write the values of a set of GPIOs
+	 *
+	 *  \param[in] handle Handle returned by the \ref request_bulk
+	 *             function.
+	 *  \param[in] values Values to set, in the order of the
+	 *             configurations passed to \ref request_bulk
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*write_bulk)(artik_gpio_bulk_handle handle,
+				const int *values);
+	/*!
+	 *  \brief Set a callback to receive timestamped edge events
+	 *
+	 *  Edges are read from the kernel event queue of the GPIO
+	 *  and delivered in batches, in the order they occurred.
+	 *  Unlike \ref set_change_callback no edge is coalesced.
+	 *  The edges to detect are taken from the configuration of
+	 *  the GPIO, both edges are detected if it has none.
+	 *
+	 *  With a debounce period, an edge is only delivered once
+	 *  the GPIO has been stable for that long after it. An edge
+	 *  followed by an opposite edge within the period is
+	 *  dropped along with it, and only the last of consecutive
+	 *  edges of the same type is kept.
+	 *
+	 *  Use \ref unset_change_callback to stop receiving events.
+	 *
+	 *  \param[in] handle Handle tied to the requested GPIO instance
+	 *             to monitor. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] callback Pointer to the callback function which
+	 *             will be called with the events.
+	 *  \param[in] debounce_us Debounce period in microseconds, 0
+	 *             to deliver all the edges.
+	 *  \param[in] user_data Pointer to user data that will be passed
+	 *             as a parameter to the callback
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*set_events_callback)(artik_gpio_handle handle,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data);
+	/*!
+	 *  \brief Get the edge event counters of a GPIO instance
+	 *
+	 *  Counters are reset by \ref set_events_callback.
+	 *
+	 *  \param[in] handle Handle tied to the requested GPIO instance.
+	 *             This handle is returned by the \ref request
+	 *             function.
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*get_event_stats)(artik_gpio_handle handle,
+				artik_gpio_event_stats *stats);
 } artik_gpio_module;
 
 extern const artik_gpio_module gpio_module;
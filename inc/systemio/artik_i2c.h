@@ -87,8 +87,58 @@ typedef struct {
 	 *  \brief Address of the I2C chip to address
 	 */
 	unsigned char address;
+	/*!
+	 *  \brief pointer to data for internal use by the API.
+	 */
+	void *user_data;
 } artik_i2c_config;
 
+/*!
+ *  \brief I2C transfer type
+ *
+ *  Type of an operation of a batched transaction
+ */
+typedef enum {
+	I2C_MSG_READ = 0,
+	I2C_MSG_WRITE,
+	I2C_MSG_READ_REGISTER,
+	I2C_MSG_WRITE_REGISTER
+} artik_i2c_msg_type;
+
+/*!
+ *  \brief I2C transfer structure
+ *
+ *  Structure describing a single operation of a batched
+ *  transaction, see \ref transfer
+ */
+typedef struct {
+	/*!
+	 *  \brief Type of the operation
+	 */
+	artik_i2c_msg_type type;
+	/*!
+	 *  \brief Address of the I2C chip to address, chips other
+	 *         than the one of the handle can be addressed on the
+	 *         same bus
+	 */
+	unsigned char address;
+	/*!
+	 *  \brief Internal register address of the chip, ignored for
+	 *         plain reads and writes. Its size is the word size
+	 *         of the handle.
+	 */
+	unsigned int reg;
+	/*!
+	 *  \brief Data to write, or array to be filled with the data
+	 *         read
+	 */
+	char *buffer;
+	/*!
+	 *  \brief Number of bytes to read or write
+	 */
+	int len;
+} artik_i2c_msg;
+
 /*! \struct artik_i2c_module
  *
  *  \brief I2C module operations
@@ -190,6 +240,25 @@ typedef struct {
 	artik_error(*write_register) (artik_i2c_handle handle,
 				      unsigned int reg, char *buffer,
 				      int len);
+	/*!
+	 *  \brief Run several operations in a single bus transaction
+	 *
+	 *  The operations are chained with repeated starts and a
+	 *  single stop, in as few system calls as the bus driver
+	 *  allows. On buses only supporting SMBus, register accesses
+	 *  with an 8-bit word size are done one after the other with
+	 *  SMBus block transfers.
+	 *
+	 *  \param[in] handle Handle tied to the requested I2C instance.
+	 *             This handle is returned by the \ref request function.
+	 *  \param[in,out] msgs Array of the operations to run in
+	 *                 order
+	 *  \param[in] count Number of elements of the array
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*transfer) (artik_i2c_handle handle,
+				artik_i2c_msg *msgs, int count);
 } artik_i2c_module;
 
 extern const artik_i2c_module i2c_module;
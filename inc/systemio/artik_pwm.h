@@ -102,6 +102,62 @@ typedef struct {
 
 } artik_pwm_config;
 
+/*! \struct artik_pwm_state
+ *  \brief PWM output state
+ *
+ *  Settings applied together by \ref apply_states
+ */
+typedef struct {
+	/*!
+	 *  \brief Period in nanoseconds
+	 */
+	unsigned int period;
+	/*!
+	 *  \brief Active time in nanoseconds, at most \ref period
+	 */
+	unsigned int duty_cycle;
+	/*!
+	 *  \brief Polarity of the active time
+	 */
+	artik_pwm_polarity_t polarity;
+} artik_pwm_state;
+
+/*! \struct artik_pwm_waveform
+ *  \brief PWM waveform
+ *
+ *  Table of duty cycles written one after the other
+ *  at a fixed interval by \ref start_waveform
+ */
+typedef struct {
+	/*!
+	 *  \brief Duty cycles in nanoseconds
+	 */
+	const unsigned int *duty_cycles;
+	/*!
+	 *  \brief Number of elements of \ref duty_cycles
+	 */
+	int num_steps;
+	/*!
+	 *  \brief Time between two steps in microseconds
+	 */
+	unsigned int step_us;
+	/*!
+	 *  \brief Number of times the table is played, 0 to
+	 *  play it until \ref stop_waveform is called
+	 */
+	unsigned int repeat;
+} artik_pwm_waveform;
+
+/*!
+ *  \brief PWM waveform callback type
+ *
+ *  Callback prototype called when a waveform ends, with
+ *  S_OK once the last step is written or the error that
+ *  interrupted it.
+ */
+typedef void (*artik_pwm_waveform_callback)(void *user_data,
+				artik_error result);
+
 /*! \struct artik_pwm_module
  *
  *  \brief PWM module operations
@@ -198,6 +254,61 @@ typedef struct {
 	 */
 	artik_error(*set_duty_cycle) (artik_pwm_handle handle,
 				      unsigned int duty_cycle);
+	/*!
+	 *  \brief Apply period, duty cycle and polarity together
+	 *
+	 *  Values are written in an order that keeps the output
+	 *  valid at each step, and values already in place are
+	 *  not written again. The PWM instances are updated one
+	 *  after the other; on failure the ones before the
+	 *  failing instance keep their new state.
+	 *
+	 *  \param[in] handles Handles of the PWM instances to update.
+	 *             These handles are returned by the \ref request
+	 *             function.
+	 *  \param[in] states State to apply to each instance
+	 *  \param[in] count Number of elements of \a handles and
+	 *             \a states
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*apply_states) (artik_pwm_handle *handles,
+				const artik_pwm_state *states, int count);
+	/*!
+	 *  \brief Play a table of duty cycles on a PWM instance
+	 *
+	 *  The first step is written before the function returns,
+	 *  the next ones from the loop. Steps that could not be
+	 *  written on time are skipped to stay on schedule.
+	 *
+	 *  \param[in] handle Handle tied to the requested PWM
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] waveform Waveform to play, the table is
+	 *             copied by the function
+	 *  \param[in] callback Function called when the waveform
+	 *             ends, may be NULL
+	 *  \param[in] user_data Pointer passed to \a callback
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*start_waveform) (artik_pwm_handle handle,
+				const artik_pwm_waveform *waveform,
+				artik_pwm_waveform_callback callback,
+				void *user_data);
+	/*!
+	 *  \brief Stop the waveform played on a PWM instance
+	 *
+	 *  The output keeps the last duty cycle written, and the
+	 *  callback of the waveform is not called.
+	 *
+	 *  \param[in] handle Handle tied to the requested PWM
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *
+	 *  \return S_OK on success, error code otherwise
+	 */
+	artik_error(*stop_waveform) (artik_pwm_handle handle);
 
 } artik_pwm_module;
 
@@ -53,6 +53,27 @@ extern "C" {
  */
 typedef void *artik_serial_handle;
 
+/*!
+ *  \brief SERIAL multiplexer handle type
+ *
+ *  Handle type used to carry a multiplexer receiving
+ *  from several SERIAL instances.
+ */
+typedef void *artik_serial_mux_handle;
+
+/*!
+ *  \brief Build a port number for a pseudo-terminal
+ *
+ *  Port numbers built with this macro address /dev/pts/\a n
+ *  instead of a UART of the board, for emulated devices and
+ *  tests. Only supported on Linux.
+ */
+#define SERIAL_PTS_PORT(n)	(0x40000000 | ((n) & 0xffff))
+
+/*!
+ *  \brief Maximum length of a frame delimiter
+ */
+#define ARTIK_SERIAL_MAX_DELIMITER	4
 
 /*!
  *  \brief SERIAL callback type
@@ -138,6 +159,251 @@ typedef enum {
 	ARTIK_SERIAL_FLOWCTRL_SOFT
 } artik_serial_flowcontrol_t;
 
+/*!
+ *  \brief SERIAL framing type
+ *
+ *  Type for specifying how received bytes are cut into
+ *  frames by \ref set_frame_callback.
+ */
+typedef enum {
+	/*!
+	 *  \brief Bytes are passed as they are read
+	 */
+	ARTIK_SERIAL_FRAME_NONE,
+	/*!
+	 *  \brief Frames end with a delimiter, not passed
+	 */
+	ARTIK_SERIAL_FRAME_DELIMITER,
+	/*!
+	 *  \brief Frames start with their length, not passed
+	 */
+	ARTIK_SERIAL_FRAME_LENGTH,
+	/*!
+	 *  \brief SLIP (RFC 1055) encoded frames, passed decoded
+	 */
+	ARTIK_SERIAL_FRAME_SLIP,
+	/*!
+	 *  \brief COBS encoded frames ending with a zero byte,
+	 *  passed decoded
+	 */
+	ARTIK_SERIAL_FRAME_COBS,
+	/*!
+	 *  \brief Frames end when the line stays idle
+	 */
+	ARTIK_SERIAL_FRAME_IDLE,
+	/*!
+	 *  \brief Frames are found by a framer function
+	 */
+	ARTIK_SERIAL_FRAME_CUSTOM
+} artik_serial_framing_t;
+
+/*!
+ *  \brief SERIAL framer function type
+ *
+ *  Function finding the first frame in the received bytes.
+ *
+ *  \param[in] user_data The user data passed to
+ *             \ref set_frame_callback
+ *  \param[in] data Bytes received and not consumed yet
+ *  \param[in] len Number of bytes in \a data
+ *
+ *  \return Length of the frame starting at \a data, which
+ *          is passed whole to the callback, 0 if more bytes
+ *          are needed, or minus the number of bytes to drop.
+ */
+typedef int (*artik_serial_framer)(void *user_data,
+			const unsigned char *data, int len);
+
+/*!
+ *  \brief SERIAL frame callback type
+ *
+ *  Callback prototype for SERIAL received frames
+ *
+ *  \param[in] user_data The user data passed from
+ *             the \ref set_frame_callback function
+ *  \param[in] frame Content of the frame, valid until the
+ *             callback returns
+ *  \param[in] len Length of the frame
+ */
+typedef void (*artik_serial_frame_callback)(void *user_data,
+			const unsigned char *frame, int len);
+
+/*! \struct artik_serial_framing
+ *  \brief SERIAL framing configuration
+ *
+ *  Fields that do not apply to the framing type are
+ *  ignored.
+ */
+typedef struct {
+	/*!
+	 *  \brief Framing type
+	 */
+	artik_serial_framing_t type;
+	/*!
+	 *  \brief Bytes ending a frame, for
+	 *  ARTIK_SERIAL_FRAME_DELIMITER
+	 */
+	const unsigned char *delimiter;
+	/*!
+	 *  \brief Length of \ref delimiter, up to
+	 *  ARTIK_SERIAL_MAX_DELIMITER
+	 */
+	int delimiter_len;
+	/*!
+	 *  \brief Size of the length field (1, 2 or 4 bytes),
+	 *  for ARTIK_SERIAL_FRAME_LENGTH
+	 */
+	int length_size;
+	/*!
+	 *  \brief Whether the length field is big endian
+	 */
+	bool length_big_endian;
+	/*!
+	 *  \brief Idle time ending a frame in microseconds, for
+	 *  ARTIK_SERIAL_FRAME_IDLE
+	 */
+	unsigned int idle_us;
+	/*!
+	 *  \brief Framer function, for ARTIK_SERIAL_FRAME_CUSTOM
+	 */
+	artik_serial_framer framer;
+	/*!
+	 *  \brief Longest frame accepted, 0 for \ref buffer_size.
+	 *  Longer frames are dropped.
+	 */
+	int max_frame;
+	/*!
+	 *  \brief Bytes buffered until a frame is complete, 0 for
+	 *  a default of 4096.
+	 */
+	int buffer_size;
+} artik_serial_framing;
+
+/*! \struct artik_serial_rx_stats
+ *  \brief SERIAL receive counters
+ */
+typedef struct {
+	/*!
+	 *  \brief Bytes read from the port
+	 */
+	unsigned long long bytes;
+	/*!
+	 *  \brief Frames passed to the callback
+	 */
+	unsigned long long frames;
+	/*!
+	 *  \brief Frames dropped because they were too long or
+	 *  could not be decoded
+	 */
+	unsigned long long bad_frames;
+	/*!
+	 *  \brief Bytes dropped because the buffer was full
+	 */
+	unsigned long long overruns;
+} artik_serial_rx_stats;
+
+/*!
+ *  \brief SERIAL transmit event type
+ */
+typedef enum {
+	/*!
+	 *  \brief The queue has room again after a buffer was
+	 *  refused by \ref queue_write
+	 */
+	ARTIK_SERIAL_TX_READY,
+	/*!
+	 *  \brief All the queued bytes have left the port
+	 */
+	ARTIK_SERIAL_TX_COMPLETE
+} artik_serial_tx_event_t;
+
+/*!
+ *  \brief SERIAL transmit event callback type
+ *
+ *  \param[in] user_data The user data passed from
+ *             the \ref set_tx_callback function
+ *  \param[in] event Event that occurred
+ */
+typedef void (*artik_serial_tx_callback)(void *user_data,
+			artik_serial_tx_event_t event);
+
+/*!
+ *  \brief SERIAL buffer release callback type
+ *
+ *  Called when a buffer passed to \ref queue_write is no
+ *  longer used by the module.
+ *
+ *  \param[in] user_data The user data passed to
+ *             \ref queue_write
+ *  \param[in] buf The buffer passed to \ref queue_write
+ *  \param[in] len Number of bytes of \a buf
+ *  \param[in] result S_OK if all the bytes were written,
+ *             error code if the buffer was dropped
+ */
+typedef void (*artik_serial_release_callback)(void *user_data,
+			unsigned char *buf, int len, artik_error result);
+
+/*! \struct artik_serial_tx_limits
+ *  \brief SERIAL transmit queue limits
+ */
+typedef struct {
+	/*!
+	 *  \brief Maximum number of buffers queued, 0 for a
+	 *  default of 64
+	 */
+	int max_buffers;
+	/*!
+	 *  \brief Maximum number of bytes queued, 0 for a
+	 *  default of 65536
+	 */
+	int max_bytes;
+} artik_serial_tx_limits;
+
+/*! \struct artik_serial_mux_config
+ *  \brief SERIAL multiplexer configuration
+ */
+typedef struct {
+	/*!
+	 *  \brief Maximum number of ports, 0 for a default of 64
+	 */
+	int max_ports;
+	/*!
+	 *  \brief Bytes buffered per port between the I/O thread
+	 *  and the loop, rounded up to a power of 2. 0 for a
+	 *  default of 16384.
+	 */
+	int ring_size;
+	/*!
+	 *  \brief Time in microseconds the I/O thread waits for
+	 *  more data before waking up the loop, 0 to wake it up
+	 *  right away
+	 */
+	unsigned int batch_us;
+} artik_serial_mux_config;
+
+/*! \struct artik_serial_mux_stats
+ *  \brief SERIAL multiplexer counters
+ */
+typedef struct {
+	/*!
+	 *  \brief Times the loop was woken up
+	 */
+	unsigned long long wakeups;
+	/*!
+	 *  \brief Reads done by the I/O thread
+	 */
+	unsigned long long reads;
+	/*!
+	 *  \brief Bytes read from all the ports
+	 */
+	unsigned long long bytes;
+	/*!
+	 *  \brief Times a port stopped being read because its
+	 *  buffer was full
+	 */
+	unsigned long long pauses;
+} artik_serial_mux_stats;
+
 /*! \struct artik_serial_config
  *  \brief SERIAL configuration structure
  *
@@ -278,6 +544,174 @@ typedef struct {
 	 *  \return S_OK on success, error code otherwise.
 	 */
 	artik_error(*unset_received_callback) (artik_serial_handle handle);
+	/*!
+	 *  \brief Receive frames on a SERIAL instance
+	 *
+	 *  Received bytes are read without blocking into a buffer
+	 *  of the instance and passed to \a callback from the loop
+	 *  once they make a complete frame. This replaces the
+	 *  callback set by \ref set_received_callback, and is
+	 *  stopped by \ref unset_received_callback.
+	 *
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] framing How to cut the received bytes into
+	 *             frames, copied by the function
+	 *  \param[in] callback Function called for each frame
+	 *  \param[in] user_data Pointer passed to \a callback and
+	 *             to the framer function
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*set_frame_callback) (artik_serial_handle handle,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback,
+			void *user_data);
+	/*!
+	 *  \brief Get the receive counters of a SERIAL instance
+	 *
+	 *  Counters are reset by \ref set_frame_callback and
+	 *  \ref set_received_callback.
+	 *
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*get_rx_stats) (artik_serial_handle handle,
+			artik_serial_rx_stats *stats);
+	/*!
+	 *  \brief Queue a buffer for transmission
+	 *
+	 *  Buffers are written in order from the loop when the
+	 *  port can take more bytes. The buffer is not copied: it
+	 *  must stay valid until \a release is called.
+	 *  \ref write returns E_BUSY while buffers are queued.
+	 *
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] buf Bytes to write
+	 *  \param[in] len Number of bytes of \a buf
+	 *  \param[in] release Function called from the loop once
+	 *             \a buf is written, or dropped by
+	 *             \ref release. May be NULL.
+	 *  \param[in] user_data Pointer passed to \a release
+	 *
+	 *  \return S_OK on success, E_TRY_AGAIN if the queue is
+	 *          full, error code otherwise. ARTIK_SERIAL_TX_READY
+	 *          is reported when the queue has room again.
+	 */
+	artik_error(*queue_write) (artik_serial_handle handle,
+			unsigned char *buf, int len,
+			artik_serial_release_callback release,
+			void *user_data);
+	/*!
+	 *  \brief Set the callback reporting transmit events
+	 *
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] callback Function called from the loop on
+	 *             transmit events, NULL to remove it
+	 *  \param[in] user_data Pointer passed to \a callback
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*set_tx_callback) (artik_serial_handle handle,
+			artik_serial_tx_callback callback, void *user_data);
+	/*!
+	 *  \brief Change the limits of the transmit queue
+	 *
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] limits New limits, copied by the function
+	 *
+	 *  \return S_OK on success, E_BUSY if buffers are queued,
+	 *          error code otherwise.
+	 */
+	artik_error(*set_tx_limits) (artik_serial_handle handle,
+			const artik_serial_tx_limits *limits);
+	/*!
+	 *  \brief Create a multiplexer
+	 *
+	 *  A multiplexer receives from many SERIAL instances on a
+	 *  thread of its own, and passes the frames to the loop in
+	 *  batches. One wakeup of the loop serves all the ports
+	 *  which received data.
+	 *
+	 *  \param[out] mux Handle of the multiplexer
+	 *  \param[in] config Configuration of the multiplexer, NULL
+	 *             for the defaults
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*mux_create) (artik_serial_mux_handle *mux,
+			const artik_serial_mux_config *config);
+	/*!
+	 *  \brief Destroy a multiplexer
+	 *
+	 *  The ports still added are removed from it.
+	 *
+	 *  \param[in] mux Handle of the multiplexer
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*mux_destroy) (artik_serial_mux_handle mux);
+	/*!
+	 *  \brief Receive frames of a SERIAL instance through a
+	 *  multiplexer
+	 *
+	 *  Works like \ref set_frame_callback. The instance must
+	 *  not have a receive callback set.
+	 *
+	 *  \param[in] mux Handle of the multiplexer
+	 *  \param[in] handle Handle tied to the requested Serial
+	 *             instance. This handle is returned by the
+	 *             \ref request function.
+	 *  \param[in] framing How to cut the received bytes into
+	 *             frames, copied by the function
+	 *  \param[in] callback Function called for each frame
+	 *  \param[in] user_data Pointer passed to \a callback and
+	 *             to the framer function
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*mux_add_port) (artik_serial_mux_handle mux,
+			artik_serial_handle handle,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback,
+			void *user_data);
+	/*!
+	 *  \brief Stop receiving a SERIAL instance through a
+	 *  multiplexer
+	 *
+	 *  Also done when the instance is released.
+	 *
+	 *  \param[in] mux Handle of the multiplexer
+	 *  \param[in] handle Handle of the Serial instance
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*mux_remove_port) (artik_serial_mux_handle mux,
+			artik_serial_handle handle);
+	/*!
+	 *  \brief Get the counters of a multiplexer
+	 *
+	 *  Counters of each port are returned by
+	 *  \ref get_rx_stats.
+	 *
+	 *  \param[in] mux Handle of the multiplexer
+	 *  \param[out] stats Counters filled by the function
+	 *
+	 *  \return S_OK on success, error code otherwise.
+	 */
+	artik_error(*mux_get_stats) (artik_serial_mux_handle mux,
+			artik_serial_mux_stats *stats);
 
 } artik_serial_module;
 
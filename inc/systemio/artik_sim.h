@@ -0,0 +1,380 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__ARTIK_SIM_H__
+#define	__ARTIK_SIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "artik_error.h"
+#include "artik_types.h"
+#include "artik_gpio.h"
+
+/*! \file artik_sim.h
+ *
+ *  \brief Simulated I2C, SPI, GPIO and ADC devices
+ *
+ *  Devices declared with these functions replace the hardware
+ *  for the I2C, SPI, GPIO and ADC modules: requesting a bus and
+ *  address, a GPIO or an ADC pin that is simulated gives a handle
+ *  on the simulation instead of the kernel device. Drivers, such
+ *  as the ones of the sensor module, run unchanged on top of them.
+ *  Simulated devices have to be declared before they are requested.
+ *  GPIO edge events with timestamps and ADC streams are not
+ *  simulated, their functions return E_NOT_SUPPORTED. Only
+ *  supported on Linux.
+ *
+ *  \example sim_test/artik_sim_bench.c
+ */
+
+/*!
+ *  \brief Simulated device handle type
+ *
+ *  Handle type used to carry the registers and the settings
+ *  of a simulated I2C or SPI device.
+ */
+typedef struct artik_sim_device artik_sim_device;
+
+/*!
+ *  \brief Bus of a simulated device
+ */
+typedef enum {
+	ARTIK_SIM_I2C = 0,
+	ARTIK_SIM_SPI
+} artik_sim_bus_t;
+
+/*!
+ *  \brief Model of a simulated device
+ *
+ *  All models have 256 8-bit registers. On SPI, the first byte
+ *  of a transfer is the register address with bit 7 set for reads.
+ *  The sensor models start with the identification and calibration
+ *  registers of the chip, and their output registers follow the
+ *  values set with \ref artik_sim_set_values.
+ */
+typedef enum {
+	/*!
+	 *  \brief Registers only, the address is auto incremented
+	 */
+	ARTIK_SIM_REGISTERS = 0,
+	/*!
+	 *  \brief HTS221 humidity and temperature sensor, values
+	 *         are { %rH, degrees C }
+	 */
+	ARTIK_SIM_HTS221,
+	/*!
+	 *  \brief K6DS3 accelerometer and gyroscope, values are the
+	 *         raw { X, Y, Z } of the accelerometer then of the
+	 *         gyroscope. The accelerometer samples are queued in
+	 *         the FIFO at the rate set by the driver.
+	 */
+	ARTIK_SIM_K6DS3,
+	/*!
+	 *  \brief LPS25HBTR pressure sensor, values are
+	 *         { hPa, degrees C }
+	 */
+	ARTIK_SIM_LPS25HBTR
+} artik_sim_model_t;
+
+/*! \struct artik_sim_latency
+ *  \brief Time taken by the transactions of a device
+ *
+ *  The calls accessing the device only return once this time is
+ *  elapsed, as they would with a real bus.
+ */
+typedef struct {
+	/*!
+	 *  \brief Time taken by each transaction, in microseconds
+	 */
+	unsigned int transaction_us;
+	/*!
+	 *  \brief Time taken by each byte transferred, in nanoseconds
+	 */
+	unsigned int byte_ns;
+} artik_sim_latency;
+
+/*! \struct artik_sim_faults
+ *  \brief Faults injected in the transactions of a device
+ *
+ *  After \a skip transactions, one transaction out of \a period
+ *  fails, returning \a error, or has the data it reads corrupted
+ *  if \a corrupt_mask is not 0.
+ */
+typedef struct {
+	/*!
+	 *  \brief One faulty transaction out of \a period, 0 to
+	 *         disable fault injection
+	 */
+	unsigned int period;
+	/*!
+	 *  \brief Transactions going through before the first fault
+	 */
+	unsigned int skip;
+	/*!
+	 *  \brief Number of faults to inject, 0 for no limit
+	 */
+	unsigned int count;
+	/*!
+	 *  \brief Error returned by the faulty transactions
+	 */
+	artik_error error;
+	/*!
+	 *  \brief Bits flipped in the bytes read instead of failing,
+	 *         if not 0
+	 */
+	unsigned char corrupt_mask;
+} artik_sim_faults;
+
+/*! \struct artik_sim_stats
+ *  \brief Statistics of a simulated device
+ */
+typedef struct {
+	/*!
+	 *  \brief I2C messages and SPI chip select cycles
+	 */
+	unsigned long long transactions;
+	unsigned long long bytes_read;
+	unsigned long long bytes_written;
+	/*!
+	 *  \brief Faults injected
+	 */
+	unsigned long long faults;
+} artik_sim_stats;
+
+/*!
+ *  \brief Register access hook
+ *
+ *  Called before registers are read, so that they can be updated,
+ *  and after they are written. \a reg is the first register accessed,
+ *  without any auto increment flag.
+ */
+typedef void (*artik_sim_hook)(void *user_data, artik_sim_device *device,
+				unsigned int reg, int len, bool write);
+
+/*!
+ *  \brief Declare a simulated I2C or SPI device
+ *
+ *  \param[out] device Handle of the device
+ *  \param[in] bus_type Bus the device is on
+ *  \param[in] bus Number of the I2C adapter or of the SPI bus
+ *  \param[in] address I2C slave address or SPI chip select
+ *  \param[in] model Model of the device
+ *
+ *  \return S_OK on success, E_BUSY if the address is already
+ *          simulated, error code otherwise
+ */
+artik_error artik_sim_add_device(artik_sim_device **device,
+		artik_sim_bus_t bus_type, unsigned int bus,
+		unsigned int address, artik_sim_model_t model);
+
+/*!
+ *  \brief Remove a simulated device
+ *
+ *  Transactions still addressing the device fail.
+ *
+ *  \param[in] device Handle of the device
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_remove_device(artik_sim_device *device);
+
+/*!
+ *  \brief Write registers of a simulated device
+ *
+ *  The registers are written as they are, without going through
+ *  the model or the hook.
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] reg First register to write
+ *  \param[in] data Values of the registers
+ *  \param[in] len Number of registers to write
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_write_registers(artik_sim_device *device,
+		unsigned int reg, const unsigned char *data, int len);
+
+/*!
+ *  \brief Read registers of a simulated device
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] reg First register to read
+ *  \param[out] data Values of the registers
+ *  \param[in] len Number of registers to read
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_read_registers(artik_sim_device *device,
+		unsigned int reg, unsigned char *data, int len);
+
+/*!
+ *  \brief Script the values read from registers
+ *
+ *  Each read starting at \a reg first loads the next \a len bytes
+ *  of \a values in the registers, going back to the first ones after
+ *  \a count reads. A sequence replaces the previous one starting at
+ *  the same register, and is removed if \a count is 0.
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] reg First register of the sequence
+ *  \param[in] values \a count sets of \a len register values,
+ *		      copied by the function
+ *  \param[in] len Number of registers of each set
+ *  \param[in] count Number of sets
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_set_sequence(artik_sim_device *device,
+		unsigned int reg, const unsigned char *values, int len,
+		int count);
+
+/*!
+ *  \brief Set a hook called on each register access
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] hook Function to call, NULL to remove the hook
+ *  \param[in] user_data Pointer passed to \a hook
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_set_hook(artik_sim_device *device, artik_sim_hook hook,
+		void *user_data);
+
+/*!
+ *  \brief Set the values measured by a sensor model
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] values Values in the order given by the model
+ *  \param[in] count Number of values, at most the number of
+ *		     values of the model
+ *
+ *  \return S_OK on success, E_NOT_SUPPORTED for devices
+ *          without values, error code otherwise
+ */
+artik_error artik_sim_set_values(artik_sim_device *device,
+		const double *values, int count);
+
+/*!
+ *  \brief Set the latency of a simulated device
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] latency Time taken by the transactions, NULL for none
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_set_latency(artik_sim_device *device,
+		const artik_sim_latency *latency);
+
+/*!
+ *  \brief Inject faults in the transactions of a device
+ *
+ *  The transactions are counted from this call.
+ *
+ *  \param[in] device Handle of the device
+ *  \param[in] faults Faults to inject, NULL for none
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_set_faults(artik_sim_device *device,
+		const artik_sim_faults *faults);
+
+/*!
+ *  \brief Get the statistics of a simulated device
+ *
+ *  \param[in] device Handle of the device
+ *  \param[out] stats Statistics since the device was added
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_get_stats(artik_sim_device *device,
+		artik_sim_stats *stats);
+
+/*!
+ *  \brief Declare a simulated GPIO
+ *
+ *  \param[in] id ID of the GPIO
+ *  \param[in] value Initial level of the line
+ *
+ *  \return S_OK on success, E_BUSY if the GPIO is already
+ *          simulated, error code otherwise
+ */
+artik_error artik_sim_add_gpio(artik_gpio_id id, int value);
+
+/*!
+ *  \brief Remove a simulated GPIO
+ *
+ *  \param[in] id ID of the GPIO
+ *
+ *  \return S_OK on success, E_BUSY while a change callback is set on the
+ *          GPIO, error code otherwise
+ */
+artik_error artik_sim_remove_gpio(artik_gpio_id id);
+
+/*!
+ *  \brief Drive a simulated GPIO
+ *
+ *  Sets the level read from an input. The change callback of the
+ *  GPIO is called from the loop if the edge matches its configuration.
+ *
+ *  \param[in] id ID of the GPIO
+ *  \param[in] value Level of the line
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_set_gpio(artik_gpio_id id, int value);
+
+/*!
+ *  \brief Get the level of a simulated GPIO
+ *
+ *  \param[in] id ID of the GPIO
+ *  \param[out] value Level of the line, last written for an output
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_get_gpio(artik_gpio_id id, int *value);
+
+/*!
+ *  \brief Declare a simulated ADC pin
+ *
+ *  Successive reads of the pin return the values in order, going
+ *  back to the first one after the last.
+ *
+ *  \param[in] pin_num Pin number of the ADC input
+ *  \param[in] values Raw values, copied by the function
+ *  \param[in] count Number of values, at least 1
+ *
+ *  \return S_OK on success, E_BUSY if the pin is already
+ *          simulated, error code otherwise
+ */
+artik_error artik_sim_add_adc(int pin_num, const int *values, int count);
+
+/*!
+ *  \brief Remove a simulated ADC pin
+ *
+ *  \param[in] pin_num Pin number of the ADC input
+ *
+ *  \return S_OK on success, error code otherwise
+ */
+artik_error artik_sim_remove_adc(int pin_num);
+
+#ifdef __cplusplus
+}
+#endif
+#endif				/* __ARTIK_SIM_H__ */
@@ -85,9 +85,55 @@ typedef struct {
 	 *  \brief bits max speed of the SPI controller to request
 	 */
 	unsigned int max_speed;
-
+	/*!
+	 *  \brief pointer to data for internal use by the API.
+	 */
+	void *user_data;
 } artik_spi_config;
 
+/*!
+ *  \brief SPI transfer segment
+ *
+ *  Structure describing one segment of a transfer list,
+ *  see \ref transfer. The buffers are used in place, without
+ *  any intermediate copy in the library, so they should be
+ *  allocated once and reused for streaming.
+ */
+typedef struct {
+	/*!
+	 *  \brief Data to send, or NULL to send zeros
+	 */
+	const char *tx_buf;
+	/*!
+	 *  \brief Buffer filled with the data received, or NULL
+	 *         to discard it
+	 */
+	char *rx_buf;
+	/*!
+	 *  \brief Length of the segment in bytes
+	 */
+	unsigned int len;
+	/*!
+	 *  \brief Clock speed of the segment, 0 for the max speed
+	 *         of the configuration
+	 */
+	unsigned int speed_hz;
+	/*!
+	 *  \brief Delay after the segment, in microseconds
+	 */
+	unsigned short delay_usecs;
+	/*!
+	 *  \brief Bits per word of the segment, 0 for the bits per
+	 *         word of the configuration
+	 */
+	unsigned char bits_per_word;
+	/*!
+	 *  \brief Deselect the chip after the segment. On the last
+	 *         segment, keep it selected until the next transfer.
+	 */
+	bool cs_change;
+} artik_spi_segment;
+
 /*! \struct artik_spi_module
  *
  *  \brief SPI module operations
@@ -170,6 +216,26 @@ typedef struct {
 	 */
 	artik_error(*read_write) (artik_spi_handle handle, char *tx_buf,
 				  char *rx_buf, int len);
+	/*!
+	 *  \brief Perform a list of full duplex transfers over the SPI bus
+	 *
+	 *  All the segments are submitted to the driver at once, the
+	 *  chip stays selected between them unless cs_change is set
+	 *  on a segment.
+	 *
+	 *  \param[in] handle Handle tied to the requested SPI
+	 *             instance.
+	 *             This handle is returned by the \ref request
+	 *             function.
+	 *  \param[in] segments Array of the segments to transfer in order
+	 *  \param[in] count Number of segments in the array
+	 *
+	 *  \return S_OK on success, E_BAD_ARGS if the list is larger than
+	 *          what the driver accepts in one message, error code
+	 *          otherwise
+	 */
+	artik_error(*transfer) (artik_spi_handle handle,
+				const artik_spi_segment *segments, int count);
 } artik_spi_module;
 
 extern const artik_spi_module spi_module;
@@ -56,6 +56,9 @@ class Gpio {
   artik_gpio_id get_id(void);
   artik_error set_change_callback(artik_gpio_callback, void*);
   void unset_change_callback();
+  artik_error set_events_callback(artik_gpio_events_callback,
+      unsigned int debounce_us, void*);
+  artik_error get_event_stats(artik_gpio_event_stats*);
 };
 
 }  // namespace artik
@@ -53,6 +53,7 @@ class I2c {
   artik_error write(char*, int);
   artik_error read_register(unsigned int, char*, int);
   artik_error write_register(unsigned int, char*, int);
+  artik_error transfer(artik_i2c_msg*, int);
 };
 
 }  // namespace artik
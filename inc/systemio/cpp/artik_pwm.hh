@@ -60,6 +60,10 @@ class Pwm {
   artik_error set_period(unsigned int);
   artik_error set_polarity(artik_pwm_polarity_t);
   artik_error set_duty_cycle(unsigned int);
+  artik_error apply_state(const artik_pwm_state&);
+  artik_error start_waveform(const artik_pwm_waveform&,
+      artik_pwm_waveform_callback, void*);
+  artik_error stop_waveform(void);
 
   unsigned int get_pin_num(void) const;
   char* get_name(void) const;
@@ -57,6 +57,13 @@ class Serial {
   artik_error write(unsigned char*, int*);
   artik_error set_received_callback(artik_serial_callback, void *);
   artik_error unset_received_callback(void);
+  artik_error set_frame_callback(const artik_serial_framing&,
+      artik_serial_frame_callback, void *);
+  artik_error get_rx_stats(artik_serial_rx_stats*);
+  artik_error queue_write(unsigned char*, int, artik_serial_release_callback,
+      void *);
+  artik_error set_tx_callback(artik_serial_tx_callback, void *);
+  artik_error set_tx_limits(const artik_serial_tx_limits&);
 
   unsigned int get_port_num(void) const;
   char* get_name(void) const;
@@ -53,6 +53,7 @@ class Spi {
   artik_error read(char*, int);
   artik_error write(char*, int);
   artik_error read_write(char*, char*, int);
+  artik_error transfer(const artik_spi_segment*, int);
 };
 
 }  // namespace artik
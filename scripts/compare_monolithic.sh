@@ -0,0 +1,33 @@
+#!/bin/bash
+#
+# Compare the plugin build (one libartik-sdk-<group>.so per module group,
+# loaded with dlopen) against libartik-sdk-all from a build configured
+# with -DCMAKE_BUILD_MONOLITHIC=ON.
+#
+# Usage: compare_monolithic.sh <build directory> [preload threads]
+#
+
+BUILD_DIR=${1:-.}
+THREADS=${2:-4}
+LIB_DIR=$(find "$BUILD_DIR" -type d -path "*/Release/*/lib" | head -n 1)
+BIN_DIR=$(find "$BUILD_DIR" -type d -path "*/Release/*/bin" | head -n 1)
+
+if [ -z "$LIB_DIR" ] || [ ! -e "$LIB_DIR/libartik-sdk-all.so" ]; then
+	echo "libartik-sdk-all.so not found, configure with -DCMAKE_BUILD_MONOLITHIC=ON"
+	exit 1
+fi
+
+SIZE_CMD=${CROSS_COMPILE}size
+
+echo "== Binary size (text data bss)"
+PLUGINS=$(ls "$LIB_DIR"/libartik-sdk-*.so | grep -v "libartik-sdk-all")
+$SIZE_CMD -t $PLUGINS | tail -n 1 | awk '{print "plugins:   " $1 " " $2 " " $3}'
+$SIZE_CMD "$LIB_DIR/libartik-sdk-all.so" | tail -n 1 | awk '{print "monolithic: " $1 " " $2 " " $3}'
+du -cb $PLUGINS | tail -n 1 | awk '{print "plugins file size:    " $1}'
+du -b "$LIB_DIR/libartik-sdk-all.so" | awk '{print "monolithic file size: " $1}'
+
+echo "== Time to first request"
+echo "-- plugins"
+LD_LIBRARY_PATH="$LIB_DIR" "$BIN_DIR/module-startup" "$THREADS"
+echo "-- monolithic"
+LD_LIBRARY_PATH="$LIB_DIR" "$BIN_DIR/module-startup-all" "$THREADS"
@@ -26,6 +26,15 @@ static void artik_log_set_prefix_fields(enum artik_log_prefix field_set);
 static enum artik_log_prefix artik_log_get_prefix_fields(void);
 static void artik_log_print(enum artik_log_level level, const char *filename,
 		const char *funcname, int line, const char *format, ...);
+static artik_error artik_log_set_level(enum artik_log_level level);
+static artik_error artik_log_set_module_level(const char *module, int level);
+static artik_error artik_log_set_async(bool enable);
+static artik_error artik_log_flush(void);
+static artik_error artik_log_get_stats(artik_log_stats *stats);
+static artik_error artik_log_set_binary_handler(
+		artik_log_binary_handler handler, void *user_data);
+static artik_error artik_log_decode_binary(const void *data, size_t len,
+		artik_log_handler handler, void *user_data);
 
 EXPORT_API const artik_log_module log_module = {
 		artik_log_set_system,
@@ -33,6 +42,13 @@ EXPORT_API const artik_log_module log_module = {
 		artik_log_set_prefix_fields,
 		artik_log_get_prefix_fields,
 		artik_log_print,
+		artik_log_set_level,
+		artik_log_set_module_level,
+		artik_log_set_async,
+		artik_log_flush,
+		artik_log_get_stats,
+		artik_log_set_binary_handler,
+		artik_log_decode_binary
 };
 
 artik_error artik_log_set_system(enum artik_log_system system)
@@ -67,3 +83,40 @@ void artik_log_print(enum artik_log_level level, const char *filename,
 	os_log_print(level, filename, funcname, line, format, arg);
 	va_end(arg);
 }
+
+artik_error artik_log_set_level(enum artik_log_level level)
+{
+	return os_log_set_level(level);
+}
+
+artik_error artik_log_set_module_level(const char *module, int level)
+{
+	return os_log_set_module_level(module, level);
+}
+
+artik_error artik_log_set_async(bool enable)
+{
+	return os_log_set_async(enable);
+}
+
+artik_error artik_log_flush(void)
+{
+	return os_log_flush();
+}
+
+artik_error artik_log_get_stats(artik_log_stats *stats)
+{
+	return os_log_get_stats(stats);
+}
+
+artik_error artik_log_set_binary_handler(artik_log_binary_handler handler,
+		void *user_data)
+{
+	return os_log_set_binary_handler(handler, user_data);
+}
+
+artik_error artik_log_decode_binary(const void *data, size_t len,
+		artik_log_handler handler, void *user_data)
+{
+	return os_log_decode_binary(data, len, handler, user_data);
+}
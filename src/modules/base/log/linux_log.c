@@ -19,6 +19,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <sys/syscall.h>
 #include <glib.h>
 
@@ -29,10 +32,21 @@
 #include <syslog.h>
 
 #include <artik_log.h>
+#include "os_log.h"
+#include "log_binary.h"
 
 #define MAX_FIELDSIZE_FILENAME 30
 #define MAX_FIELDSIZE_FUNCNAME 30
 
+#define MAX_LOG_MODULES		32
+#define LOG_SITE_CACHE_SIZE	256	/* Must be a power of 2 */
+
+#define LOG_RECORD_SIZE		512
+#define LOG_DEFAULT_RECORDS	1024	/* Must be a power of 2 */
+#define LOG_WRITER_BATCH	64
+#define LOG_WRITER_IDLE_MS	10
+#define LOG_BINARY_CHUNK	16384
+
 static enum artik_log_system _log_system = LOG_SYSTEM_STDERR;
 static enum artik_log_prefix _log_prefix_fields = LOG_PREFIX_DEFAULT;
 static artik_log_handler _log_handler;
@@ -40,6 +54,113 @@ static void *_log_handler_user_data;
 static int _log_override_enabled;
 static int _log_override_checked;
 
+/*
+ * Runtime level filtering. _log_max_level is the most verbose level allowed
+ * by the global level or any module level, so that messages nobody wants
+ * are rejected without looking at their source file.
+ */
+struct _log_module_level {
+	char	name[MAX_LOG_MODULE_NAME + 1];
+	size_t	len;
+	int	level;
+};
+
+struct _log_site {
+	const char	*file;
+	/* Configuration generation << 8 | resolved level */
+	uint32_t	state;
+};
+
+static pthread_mutex_t _log_config_lock = PTHREAD_MUTEX_INITIALIZER;
+static int _log_level = LOG_LEVEL_DEBUG;
+static int _log_max_level = LOG_LEVEL_DEBUG;
+static struct _log_module_level _log_modules[MAX_LOG_MODULES];
+static int _log_num_modules;
+static uint32_t _log_generation;
+static struct _log_site _log_sites[LOG_SITE_CACHE_SIZE];
+
+/*
+ * Asynchronous backend: a bounded multi-producer single-consumer ring of
+ * preformatted records. Each record carries a sequence number telling
+ * whether it is free for the producer claiming position 'pos' (seq == pos)
+ * or ready for the writer thread (seq == pos + 1).
+ */
+enum _log_record_type {
+	/* "prefix\0message\0" formatted by the caller */
+	LOG_RECORD_TEXT,
+	/* Call site and raw arguments, see log_binary_capture */
+	LOG_RECORD_BINARY
+};
+
+struct _log_capture {
+	uint64_t	timestamp_ns;
+	const char	*format;
+	const char	*file;
+	const char	*func;
+	int32_t		line;
+	uint32_t	tid;
+};
+
+#define LOG_RECORD_DATA		(LOG_RECORD_SIZE - 16)
+
+struct _log_record {
+	size_t		seq;
+	uint8_t		level;
+	uint8_t		type;
+	uint16_t	prefix_len;
+	uint16_t	msg_len;
+	uint16_t	args_len;
+	union {
+		char	data[LOG_RECORD_DATA];
+		struct {
+			struct _log_capture	hdr;
+			uint8_t	args[LOG_RECORD_DATA -
+					sizeof(struct _log_capture)];
+		} capture;
+	} u;
+};
+
+/* Time and thread a message was logged from */
+struct _log_origin {
+	struct timespec	time;
+	pid_t		pid;
+	pid_t		tid;
+};
+
+struct _log_ring {
+	struct _log_record	*records;
+	size_t			mask;
+	size_t			head;
+	size_t			tail;
+};
+
+static struct _log_ring _log_ring;
+static int _log_async;
+static int _log_writer_running;
+static int _log_writer_sleeping;
+static int _log_atexit_registered;
+static pthread_t _log_writer;
+static pthread_mutex_t _log_writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _log_writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _log_drained_cond = PTHREAD_COND_INITIALIZER;
+
+/*
+ * Binary stream state. The handler and generation are set by the API, the
+ * encoder is only used by the writer thread, which starts a new stream
+ * when the generation changes.
+ */
+static artik_log_binary_handler _log_binary_handler;
+static void *_log_binary_user_data;
+static uint32_t _log_binary_generation;
+static struct log_binary_writer _log_binary_writer;
+static uint32_t _log_binary_writer_generation;
+
+static __thread pid_t _log_tid;
+
+static uint64_t _log_stat_logged;
+static uint64_t _log_stat_truncated;
+static uint64_t _log_stat_dropped[LOG_LEVEL_DEBUG + 1];
+
 /* Initialization must follow artik_log_level order form artik_log.h */
 static struct _log_level_info {
 	char	mark;
@@ -51,6 +172,68 @@ static struct _log_level_info {
 	{ 'D', LOG_DEBUG }
 };
 
+static int _log_parse_level(const char *str, size_t len)
+{
+	static const char * const names[] = {
+		"error", "warning", "info", "debug"
+	};
+	unsigned int i;
+
+	if (len == 1 && isdigit((unsigned char)str[0]) &&
+			(str[0] - '0') <= LOG_LEVEL_DEBUG)
+		return str[0] - '0';
+
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (len && !strncasecmp(str, names[i], len) &&
+				len <= strlen(names[i]))
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * ARTIK_LOG_LEVEL=<level> sets the global level,
+ * ARTIK_LOG_MODULES=<module>=<level>[,<module>=<level>...] the module levels
+ * and ARTIK_LOG_ASYNC=1 enables the asynchronous backend.
+ */
+static void _log_check_level_override(void)
+{
+	const char *env;
+	int level;
+
+	env = getenv("ARTIK_LOG_LEVEL");
+	if (env) {
+		level = _log_parse_level(env, strlen(env));
+		if (level >= 0)
+			os_log_set_level(level);
+	}
+
+	env = getenv("ARTIK_LOG_MODULES");
+	while (env && *env) {
+		const char *end = strchr(env, ',');
+		const char *eq = strchr(env, '=');
+		size_t len = end ? (size_t)(end - env) : strlen(env);
+
+		if (eq && eq < env + len &&
+				(size_t)(eq - env) <= MAX_LOG_MODULE_NAME) {
+			char name[MAX_LOG_MODULE_NAME + 1];
+
+			memcpy(name, env, eq - env);
+			name[eq - env] = '\0';
+			level = _log_parse_level(eq + 1, env + len - eq - 1);
+			if (level >= 0)
+				os_log_set_module_level(name, level);
+		}
+
+		env = end ? end + 1 : NULL;
+	}
+
+	env = getenv("ARTIK_LOG_ASYNC");
+	if (env && atoi(env) > 0)
+		os_log_set_async(true);
+}
+
 static void _log_check_override(void)
 {
 	const char *env;
@@ -60,6 +243,8 @@ static void _log_check_override(void)
 
 	_log_override_checked = TRUE;
 
+	_log_check_level_override();
+
 	env = getenv("ARTIK_LOG");
 	if (!env)
 		return;
@@ -73,21 +258,49 @@ static void _log_check_override(void)
 	} else if (!strncasecmp(env, "none", 5)) {
 		_log_override_enabled = TRUE;
 		_log_system = LOG_SYSTEM_NONE;
+	} else if (!strncasecmp(env, "binary", 7)) {
+		_log_override_enabled = TRUE;
+		_log_system = LOG_SYSTEM_BINARY;
+		os_log_set_async(true);
 	}
 }
 
+static pid_t _log_gettid(void)
+{
+	if (!_log_tid)
+		_log_tid = (pid_t) syscall(SYS_gettid);
+
+	return _log_tid;
+}
+
+static uint64_t _log_clock_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* origin is NULL for messages formatted by the thread logging them */
 static int _log_make_prefix(char *prefix, int prefix_len,
 			enum artik_log_level level, const char *filename,
-			const char *funcname, int line)
+			const char *funcname, int line,
+			const struct _log_origin *origin)
 {
 	const char *pretty_filename = NULL;
+	pid_t pid = origin ? origin->pid : getpid();
+	pid_t tid = origin ? origin->tid : _log_gettid();
 	int len = 0;
 
 	if (_log_prefix_fields & LOG_PREFIX_TIMESTAMP) {
 		struct timespec tp;
 		struct tm ti;
 
-		clock_gettime(CLOCK_REALTIME, &tp);
+		if (origin)
+			tp = origin->time;
+		else
+			clock_gettime(CLOCK_REALTIME, &tp);
 		localtime_r(&(tp.tv_sec), &ti);
 
 		len += (int) strftime(prefix, 15, "%m-%d %H:%M:%S", &ti);
@@ -97,18 +310,16 @@ static int _log_make_prefix(char *prefix, int prefix_len,
 
 	if (_log_prefix_fields & LOG_PREFIX_PID) {
 		if (len > 0)
-			len += snprintf(prefix + len, 7, "%5d ", getpid());
+			len += snprintf(prefix + len, 7, "%5d ", pid);
 		else
-			len += snprintf(prefix, 7, "%d ", getpid());
+			len += snprintf(prefix, 7, "%d ", pid);
 	}
 
 	if (_log_prefix_fields & LOG_PREFIX_TID) {
 		if (len > 0)
-			len += snprintf(prefix + len, 7, "%5d ",
-						(pid_t) syscall(SYS_gettid));
+			len += snprintf(prefix + len, 7, "%5d ", tid);
 		else
-			len += snprintf(prefix + len, 7, "%d ",
-						(pid_t) syscall(SYS_gettid));
+			len += snprintf(prefix + len, 7, "%d ", tid);
 	}
 
 	if (_log_prefix_fields & LOG_PREFIX_LEVEL) {
@@ -187,7 +398,7 @@ static void _log_formatted(enum artik_log_level level, const char *filename,
 
 	if (_log_prefix_fields > LOG_PREFIX_NONE)
 		len = _log_make_prefix(prefix, 4096, level, filename, funcname,
-			line);
+			line, NULL);
 
 	if (_log_system == LOG_SYSTEM_STDERR) {
 		if (len > 0)
@@ -203,15 +414,484 @@ static void _log_formatted(enum artik_log_level level, const char *filename,
 	}
 }
 
+/*
+ * Find the level of the module a source file belongs to. Path components
+ * are matched from the root of the path, so the deepest match wins.
+ */
+static int _log_lookup_file_level(const char *file)
+{
+	const char *comp = file;
+	int level = _log_level;
+
+	while (comp && *comp) {
+		const char *end = strchr(comp, '/');
+		size_t len;
+		int i;
+
+		if (!end) {
+			/* File name, ignore its extension */
+			end = strrchr(comp, '.');
+			if (!end)
+				end = comp + strlen(comp);
+		}
+
+		len = end - comp;
+		for (i = 0; i < _log_num_modules; i++) {
+			if (_log_modules[i].len == len &&
+				!strncmp(_log_modules[i].name, comp, len)) {
+				level = _log_modules[i].level;
+				break;
+			}
+		}
+
+		comp = (*end == '/') ? end + 1 : NULL;
+	}
+
+	return level;
+}
+
+/*
+ * __FILE__ strings have a constant address for a given call site, use it
+ * to cache the result of the lookup. The file pointer of a slot is cleared
+ * while the slot is being updated so that readers never mix the state of
+ * two different files.
+ */
+static int _log_file_level(const char *file)
+{
+	struct _log_site *site;
+	uint32_t generation;
+	uint32_t state;
+	int level;
+
+	if (!file)
+		return _log_level;
+
+	site = &_log_sites[((uintptr_t)file >> 3) & (LOG_SITE_CACHE_SIZE - 1)];
+	generation = __atomic_load_n(&_log_generation, __ATOMIC_ACQUIRE);
+
+	if (__atomic_load_n(&site->file, __ATOMIC_ACQUIRE) == file) {
+		state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+		if ((__atomic_load_n(&site->file, __ATOMIC_ACQUIRE) == file) &&
+				((state >> 8) == (generation & 0xffffff)))
+			return (int)(state & 0xff) - 1;
+	}
+
+	pthread_mutex_lock(&_log_config_lock);
+	generation = _log_generation;
+	level = _log_lookup_file_level(file);
+	__atomic_store_n(&site->file, NULL, __ATOMIC_RELEASE);
+	__atomic_store_n(&site->state,
+		((generation & 0xffffff) << 8) | (uint32_t)(level + 1),
+		__ATOMIC_RELEASE);
+	__atomic_store_n(&site->file, file, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&_log_config_lock);
+
+	return level;
+}
+
+static bool _log_level_enabled(enum artik_log_level level, const char *file)
+{
+	if ((int)level > __atomic_load_n(&_log_max_level, __ATOMIC_RELAXED))
+		return false;
+
+	if (!__atomic_load_n(&_log_num_modules, __ATOMIC_RELAXED))
+		return (int)level <= __atomic_load_n(&_log_level,
+							__ATOMIC_RELAXED);
+
+	return (int)level <= _log_file_level(file);
+}
+
+static void _log_update_max_level(void)
+{
+	int max = _log_level;
+	int i;
+
+	for (i = 0; i < _log_num_modules; i++)
+		if (_log_modules[i].level > max)
+			max = _log_modules[i].level;
+
+	__atomic_store_n(&_log_max_level, max, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&_log_generation, 1, __ATOMIC_RELEASE);
+}
+
+static void _log_binary_output(const void *data, size_t len, void *user_data)
+{
+	artik_log_binary_handler handler = _log_binary_handler;
+
+	if (handler) {
+		handler(data, len, _log_binary_user_data);
+	} else {
+		fwrite(data, 1, len, stderr);
+		fflush(stderr);
+	}
+}
+
+/* Start a new binary stream if the handler changed since the last one */
+static bool _log_binary_prepare(void)
+{
+	uint32_t generation = __atomic_load_n(&_log_binary_generation,
+						__ATOMIC_ACQUIRE);
+
+	if (!_log_binary_writer.buf) {
+		if (log_binary_writer_init(&_log_binary_writer,
+				LOG_BINARY_CHUNK, _log_binary_output,
+				NULL) < 0)
+			return false;
+	} else if (_log_binary_writer_generation == generation) {
+		return true;
+	}
+
+	log_binary_writer_flush(&_log_binary_writer);
+	log_binary_writer_start(&_log_binary_writer, getpid(),
+				_log_clock_ns(CLOCK_MONOTONIC),
+				_log_clock_ns(CLOCK_REALTIME));
+	_log_binary_writer_generation = generation;
+
+	return true;
+}
+
+/* Format a binary record for the text based log systems */
+static void _log_format_capture(struct _log_record *rec, char *prefix,
+				size_t prefix_size, char *msg, size_t msg_size,
+				int64_t realtime_offset)
+{
+	struct _log_capture *cap = &rec->u.capture.hdr;
+	struct _log_origin origin;
+	uint64_t realtime = cap->timestamp_ns + realtime_offset;
+
+	origin.time.tv_sec = realtime / 1000000000ULL;
+	origin.time.tv_nsec = realtime % 1000000000ULL;
+	origin.pid = getpid();
+	origin.tid = cap->tid;
+
+	prefix[0] = '\0';
+	rec->prefix_len = 0;
+	if (_log_system != LOG_SYSTEM_SYSLOG &&
+			_log_prefix_fields > LOG_PREFIX_NONE)
+		rec->prefix_len = _log_make_prefix(prefix, prefix_size,
+				rec->level, cap->file, cap->func, cap->line,
+				&origin);
+
+	rec->msg_len = log_binary_format(msg, msg_size, cap->format,
+				rec->u.capture.args, rec->args_len);
+}
+
+static void _log_write_record(struct _log_record *rec, char *buf,
+				size_t *buf_len, size_t buf_size,
+				int64_t realtime_offset)
+{
+	const char *prefix = rec->u.data;
+	const char *msg = rec->u.data + rec->prefix_len + 1;
+	char prefix_buf[256];
+	char msg_buf[1024];
+
+	if (_log_system == LOG_SYSTEM_BINARY) {
+		struct _log_capture *cap = &rec->u.capture.hdr;
+
+		if (!_log_binary_prepare())
+			return;
+
+		if (rec->type == LOG_RECORD_BINARY)
+			log_binary_writer_event(&_log_binary_writer,
+				rec->level, cap->format, cap->file, cap->func,
+				cap->line, cap->tid, cap->timestamp_ns,
+				rec->u.capture.args, rec->args_len);
+		else
+			log_binary_writer_text(&_log_binary_writer,
+				rec->level, 0, _log_clock_ns(CLOCK_MONOTONIC),
+				prefix, rec->prefix_len, msg, rec->msg_len);
+		return;
+	}
+
+	if (rec->type == LOG_RECORD_BINARY) {
+		/* Queued before leaving the binary system, format it now */
+		_log_format_capture(rec, prefix_buf, sizeof(prefix_buf),
+				msg_buf, sizeof(msg_buf), realtime_offset);
+		prefix = prefix_buf;
+		msg = msg_buf;
+	}
+
+	switch (_log_system) {
+	case LOG_SYSTEM_SYSLOG:
+		syslog(_log_level_map[rec->level].syslog_level, "%s", msg);
+		break;
+	case LOG_SYSTEM_STDERR:
+		if (*buf_len + rec->prefix_len + rec->msg_len + 2 > buf_size) {
+			fwrite(buf, 1, *buf_len, stderr);
+			*buf_len = 0;
+		}
+		if (rec->prefix_len) {
+			memcpy(buf + *buf_len, prefix, rec->prefix_len);
+			*buf_len += rec->prefix_len;
+			buf[(*buf_len)++] = ' ';
+		}
+		memcpy(buf + *buf_len, msg, rec->msg_len);
+		*buf_len += rec->msg_len;
+		buf[(*buf_len)++] = '\n';
+		break;
+	case LOG_SYSTEM_CUSTOM:
+		if (_log_handler)
+			_log_handler(rec->level, prefix, msg,
+					_log_handler_user_data);
+		break;
+	case LOG_SYSTEM_NONE:
+	default:
+		break;
+	}
+}
+
+/* Write the ready records, returns the number of records consumed */
+static int _log_drain(void)
+{
+	struct _log_ring *ring = &_log_ring;
+	char buf[LOG_WRITER_BATCH * LOG_RECORD_SIZE / 4];
+	int64_t realtime_offset = _log_clock_ns(CLOCK_REALTIME) -
+					_log_clock_ns(CLOCK_MONOTONIC);
+	size_t buf_len = 0;
+	int count = 0;
+
+	while (count < LOG_WRITER_BATCH) {
+		size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+		struct _log_record *rec = &ring->records[tail & ring->mask];
+
+		if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != tail + 1)
+			break;
+
+		_log_write_record(rec, buf, &buf_len, sizeof(buf),
+					realtime_offset);
+		__atomic_store_n(&rec->seq, tail + ring->mask + 1,
+					__ATOMIC_RELEASE);
+		__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+		count++;
+	}
+
+	if (buf_len) {
+		fwrite(buf, 1, buf_len, stderr);
+		fflush(stderr);
+	}
+
+	if (_log_binary_writer.len)
+		log_binary_writer_flush(&_log_binary_writer);
+
+	return count;
+}
+
+static bool _log_ring_ready(void)
+{
+	size_t tail = __atomic_load_n(&_log_ring.tail, __ATOMIC_RELAXED);
+
+	return __atomic_load_n(&_log_ring.records[tail & _log_ring.mask].seq,
+				__ATOMIC_SEQ_CST) == tail + 1;
+}
+
+static void *_log_writer_thread(void *user_data)
+{
+	while (1) {
+		struct timespec deadline;
+
+		while (_log_drain() > 0)
+			;
+
+		pthread_mutex_lock(&_log_writer_lock);
+		pthread_cond_broadcast(&_log_drained_cond);
+		if (!__atomic_load_n(&_log_writer_running, __ATOMIC_ACQUIRE)) {
+			pthread_mutex_unlock(&_log_writer_lock);
+			break;
+		}
+
+		__atomic_store_n(&_log_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+		if (!_log_ring_ready()) {
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			deadline.tv_nsec += LOG_WRITER_IDLE_MS * 1000000L;
+			if (deadline.tv_nsec >= 1000000000L) {
+				deadline.tv_sec++;
+				deadline.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait(&_log_writer_cond,
+					&_log_writer_lock, &deadline);
+		}
+		__atomic_store_n(&_log_writer_sleeping, 0, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&_log_writer_lock);
+	}
+
+	/* Records published after the last pass */
+	while (_log_drain() > 0)
+		;
+
+	return NULL;
+}
+
+static void _log_wake_writer(void)
+{
+	if (!__atomic_load_n(&_log_writer_sleeping, __ATOMIC_SEQ_CST))
+		return;
+
+	pthread_mutex_lock(&_log_writer_lock);
+	pthread_cond_signal(&_log_writer_cond);
+	pthread_mutex_unlock(&_log_writer_lock);
+}
+
+/*
+ * Claim a free record. Never blocks, the message is dropped if the writer
+ * thread is late by more than the ring size.
+ */
+static struct _log_record *_log_claim(enum artik_log_level level,
+					size_t *pos)
+{
+	struct _log_ring *ring = &_log_ring;
+
+	*pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	while (1) {
+		struct _log_record *rec = &ring->records[*pos & ring->mask];
+		size_t seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+
+		if (seq == *pos) {
+			if (__atomic_compare_exchange_n(&ring->head, pos,
+					*pos + 1, true, __ATOMIC_SEQ_CST,
+					__ATOMIC_RELAXED))
+				return rec;
+		} else if ((intptr_t)(seq - *pos) < 0) {
+			__atomic_add_fetch(&_log_stat_dropped[level], 1,
+						__ATOMIC_RELAXED);
+			_log_wake_writer();
+			return NULL;
+		} else {
+			*pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*
+ * The writer thread polls the ring every LOG_WRITER_IDLE_MS. Only wake it
+ * up early for errors or when the ring fills up, waking it up for every
+ * message would cost a context switch per message on an idle system.
+ */
+static void _log_publish(struct _log_record *rec, size_t pos, int level)
+{
+	size_t tail;
+
+	__atomic_store_n(&rec->seq, pos + 1, __ATOMIC_SEQ_CST);
+
+	tail = __atomic_load_n(&_log_ring.tail, __ATOMIC_RELAXED);
+	if (level == LOG_LEVEL_ERROR || (pos - tail) >= _log_ring.mask / 4)
+		_log_wake_writer();
+}
+
+/* Format the message into a record */
+static void _log_enqueue(enum artik_log_level level, const char *filename,
+			 const char *funcname, int line, const char *format,
+			 va_list arg)
+{
+	struct _log_record *rec;
+	size_t pos;
+	size_t avail;
+	int prefix_len = 0;
+	int len;
+
+	rec = _log_claim(level, &pos);
+	if (!rec)
+		return;
+
+	if (_log_system != LOG_SYSTEM_SYSLOG &&
+			_log_prefix_fields > LOG_PREFIX_NONE)
+		prefix_len = _log_make_prefix(rec->u.data,
+					sizeof(rec->u.data), level, filename,
+					funcname, line, NULL);
+	rec->u.data[prefix_len] = '\0';
+
+	avail = sizeof(rec->u.data) - prefix_len - 1;
+	len = vsnprintf(rec->u.data + prefix_len + 1, avail, format, arg);
+	if (len < 0)
+		len = 0;
+	if ((size_t)len >= avail) {
+		len = avail - 1;
+		__atomic_add_fetch(&_log_stat_truncated, 1, __ATOMIC_RELAXED);
+	}
+
+	rec->level = level;
+	rec->type = LOG_RECORD_TEXT;
+	rec->prefix_len = prefix_len;
+	rec->msg_len = len;
+	_log_publish(rec, pos, level);
+}
+
+/* Only store the call site, the arguments and the time into a record */
+static void _log_enqueue_binary(enum artik_log_level level,
+				const char *filename, const char *funcname,
+				int line, const char *format, va_list arg)
+{
+	struct _log_record *rec;
+	struct _log_capture *cap;
+	bool truncated = false;
+	size_t pos;
+
+	rec = _log_claim(level, &pos);
+	if (!rec)
+		return;
+
+	cap = &rec->u.capture.hdr;
+	cap->timestamp_ns = _log_clock_ns(CLOCK_MONOTONIC);
+	cap->format = format;
+	cap->file = filename;
+	cap->func = funcname;
+	cap->line = line;
+	cap->tid = _log_gettid();
+
+	rec->args_len = log_binary_capture(rec->u.capture.args,
+				sizeof(rec->u.capture.args), format, arg,
+				&truncated);
+	if (truncated)
+		__atomic_add_fetch(&_log_stat_truncated, 1, __ATOMIC_RELAXED);
+
+	rec->level = level;
+	rec->type = LOG_RECORD_BINARY;
+	_log_publish(rec, pos, level);
+}
+
+static void _log_atexit(void)
+{
+	os_log_set_async(false);
+}
+
+static void _log_atfork_child(void)
+{
+	/* The writer thread does not exist in the child, log synchronously */
+	_log_async = 0;
+	_log_writer_running = 0;
+	_log_writer_sleeping = 0;
+	pthread_mutex_init(&_log_writer_lock, NULL);
+	pthread_cond_init(&_log_writer_cond, NULL);
+	pthread_cond_init(&_log_drained_cond, NULL);
+	pthread_mutex_init(&_log_config_lock, NULL);
+}
+
 void os_log_print(enum artik_log_level level, const char *filename,
 		const char *funcname, int line, const char *format, va_list arg)
 {
 	if (!_log_override_checked)
 		_log_check_override();
 
-	if (level > LOG_LEVEL_DEBUG)
+	if ((unsigned int)level > LOG_LEVEL_DEBUG)
+		return;
+
+	if (!_log_level_enabled(level, filename))
 		return;
 
+	if (_log_system == LOG_SYSTEM_NONE)
+		return;
+
+	__atomic_add_fetch(&_log_stat_logged, 1, __ATOMIC_RELAXED);
+
+	if (__atomic_load_n(&_log_async, __ATOMIC_ACQUIRE)) {
+		if (_log_system == LOG_SYSTEM_BINARY)
+			_log_enqueue_binary(level, filename, funcname, line,
+						format, arg);
+		else
+			_log_enqueue(level, filename, funcname, line, format,
+					arg);
+		return;
+	}
+
 	switch (_log_system) {
 	case LOG_SYSTEM_SYSLOG:
 		vsyslog(_log_level_map[level].syslog_level, format, arg);
@@ -220,6 +900,8 @@ void os_log_print(enum artik_log_level level, const char *filename,
 	case LOG_SYSTEM_CUSTOM:
 		_log_formatted(level, filename, funcname, line, format, arg);
 		break;
+	case LOG_SYSTEM_BINARY:
+		/* Without the writer thread (e.g. in a forked child) */
 	case LOG_SYSTEM_NONE:
 	default:
 		break;
@@ -228,13 +910,22 @@ void os_log_print(enum artik_log_level level, const char *filename,
 
 artik_error os_log_set_system(enum artik_log_system system)
 {
-	if (system > LOG_SYSTEM_CUSTOM) {
+	artik_error ret;
+
+	if (system > LOG_SYSTEM_BINARY) {
 		log_err("invalid system(%d)", system);
 		return E_BAD_ARGS;
 	}
 
 	if (_log_override_enabled)
 		return 0;
+
+	if (system == LOG_SYSTEM_BINARY) {
+		ret = os_log_set_async(true);
+		if (ret != S_OK)
+			return ret;
+	}
+
 	_log_system = system;
 
 	return S_OK;
@@ -266,3 +957,254 @@ enum artik_log_prefix os_log_get_prefix_fields(void)
 {
 	return _log_prefix_fields;
 }
+
+artik_error os_log_set_level(enum artik_log_level level)
+{
+	if ((unsigned int)level > LOG_LEVEL_DEBUG)
+		return E_BAD_ARGS;
+
+	pthread_mutex_lock(&_log_config_lock);
+	__atomic_store_n(&_log_level, level, __ATOMIC_RELAXED);
+	_log_update_max_level();
+	pthread_mutex_unlock(&_log_config_lock);
+
+	return S_OK;
+}
+
+artik_error os_log_set_module_level(const char *module, int level)
+{
+	size_t len;
+	int i;
+
+	if (!module || level < -1 || level > LOG_LEVEL_DEBUG)
+		return E_BAD_ARGS;
+
+	len = strlen(module);
+	if (!len || len > MAX_LOG_MODULE_NAME || strchr(module, '/'))
+		return E_BAD_ARGS;
+
+	pthread_mutex_lock(&_log_config_lock);
+
+	for (i = 0; i < _log_num_modules; i++)
+		if (!strcmp(_log_modules[i].name, module))
+			break;
+
+	if (level < 0) {
+		if (i < _log_num_modules) {
+			_log_modules[i] = _log_modules[_log_num_modules - 1];
+			__atomic_store_n(&_log_num_modules,
+				_log_num_modules - 1, __ATOMIC_RELAXED);
+		}
+	} else if (i < _log_num_modules) {
+		_log_modules[i].level = level;
+	} else if (_log_num_modules < MAX_LOG_MODULES) {
+		strncpy(_log_modules[i].name, module, MAX_LOG_MODULE_NAME);
+		_log_modules[i].len = len;
+		_log_modules[i].level = level;
+		__atomic_store_n(&_log_num_modules, _log_num_modules + 1,
+					__ATOMIC_RELAXED);
+	} else {
+		pthread_mutex_unlock(&_log_config_lock);
+		return E_NO_MEM;
+	}
+
+	_log_update_max_level();
+	pthread_mutex_unlock(&_log_config_lock);
+
+	return S_OK;
+}
+
+static artik_error _log_ring_alloc(void)
+{
+	struct _log_ring *ring = &_log_ring;
+	const char *env = getenv("ARTIK_LOG_ASYNC_RECORDS");
+	size_t count = LOG_DEFAULT_RECORDS;
+	size_t i;
+
+	if (ring->records)
+		return S_OK;
+
+	if (env && atoi(env) > 1) {
+		count = 2;
+		while (count < (size_t)atoi(env) && count < (1 << 20))
+			count <<= 1;
+	}
+
+	ring->records = calloc(count, sizeof(struct _log_record));
+	if (!ring->records)
+		return E_NO_MEM;
+
+	for (i = 0; i < count; i++)
+		ring->records[i].seq = i;
+	ring->mask = count - 1;
+	ring->head = 0;
+	ring->tail = 0;
+
+	return S_OK;
+}
+
+artik_error os_log_set_async(bool enable)
+{
+	static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+	artik_error ret = S_OK;
+
+	pthread_mutex_lock(&async_lock);
+
+	if (enable == !!_log_async)
+		goto exit;
+
+	if (enable) {
+		/* The ring is kept when disabling, late producers may use it */
+		ret = _log_ring_alloc();
+		if (ret != S_OK)
+			goto exit;
+
+		__atomic_store_n(&_log_writer_running, 1, __ATOMIC_RELEASE);
+		if (pthread_create(&_log_writer, NULL, _log_writer_thread,
+					NULL)) {
+			_log_writer_running = 0;
+			ret = E_NO_MEM;
+			goto exit;
+		}
+
+		if (!_log_atexit_registered) {
+			_log_atexit_registered = 1;
+			pthread_atfork(NULL, NULL, _log_atfork_child);
+			atexit(_log_atexit);
+		}
+
+		__atomic_store_n(&_log_async, 1, __ATOMIC_RELEASE);
+	} else {
+		__atomic_store_n(&_log_async, 0, __ATOMIC_RELEASE);
+
+		pthread_mutex_lock(&_log_writer_lock);
+		__atomic_store_n(&_log_writer_running, 0, __ATOMIC_RELEASE);
+		pthread_cond_signal(&_log_writer_cond);
+		pthread_mutex_unlock(&_log_writer_lock);
+
+		pthread_join(_log_writer, NULL);
+	}
+
+exit:
+	pthread_mutex_unlock(&async_lock);
+
+	return ret;
+}
+
+artik_error os_log_flush(void)
+{
+	size_t target;
+
+	if (!__atomic_load_n(&_log_async, __ATOMIC_ACQUIRE)) {
+		fflush(stderr);
+		return S_OK;
+	}
+
+	target = __atomic_load_n(&_log_ring.head, __ATOMIC_ACQUIRE);
+
+	pthread_mutex_lock(&_log_writer_lock);
+	while (__atomic_load_n(&_log_writer_running, __ATOMIC_ACQUIRE) &&
+		(intptr_t)(__atomic_load_n(&_log_ring.tail,
+				__ATOMIC_ACQUIRE) - target) < 0) {
+		pthread_cond_signal(&_log_writer_cond);
+		pthread_cond_wait(&_log_drained_cond, &_log_writer_lock);
+	}
+	pthread_mutex_unlock(&_log_writer_lock);
+
+	return S_OK;
+}
+
+artik_error os_log_get_stats(artik_log_stats *stats)
+{
+	int i;
+
+	if (!stats)
+		return E_BAD_ARGS;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->logged = __atomic_load_n(&_log_stat_logged, __ATOMIC_RELAXED);
+	stats->truncated = __atomic_load_n(&_log_stat_truncated,
+						__ATOMIC_RELAXED);
+	for (i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+		stats->dropped_level[i] = __atomic_load_n(
+				&_log_stat_dropped[i], __ATOMIC_RELAXED);
+		stats->dropped += stats->dropped_level[i];
+	}
+
+	return S_OK;
+}
+
+artik_error os_log_set_binary_handler(artik_log_binary_handler handler,
+		void *user_data)
+{
+	artik_error ret;
+
+	if (_log_override_enabled)
+		return S_OK;
+
+	ret = os_log_set_async(true);
+	if (ret != S_OK)
+		return ret;
+
+	/* Let the writer finish the records of the previous stream */
+	os_log_flush();
+
+	_log_binary_handler = handler;
+	_log_binary_user_data = user_data;
+	__atomic_add_fetch(&_log_binary_generation, 1, __ATOMIC_RELEASE);
+	_log_system = LOG_SYSTEM_BINARY;
+
+	return S_OK;
+}
+
+struct _log_decode_context {
+	artik_log_handler handler;
+	void *user_data;
+};
+
+static void _log_decode_message(const struct log_binary_message *message,
+				void *user_data)
+{
+	struct _log_decode_context *ctx = user_data;
+	struct _log_origin origin;
+	char prefix[256];
+
+	if ((unsigned int)message->level > LOG_LEVEL_DEBUG)
+		return;
+
+	if (message->prefix) {
+		ctx->handler(message->level, message->prefix, message->msg,
+				ctx->user_data);
+		return;
+	}
+
+	origin.time.tv_sec = message->realtime_ns / 1000000000ULL;
+	origin.time.tv_nsec = message->realtime_ns % 1000000000ULL;
+	origin.pid = message->pid;
+	origin.tid = message->tid;
+
+	prefix[0] = '\0';
+	if (_log_prefix_fields > LOG_PREFIX_NONE)
+		_log_make_prefix(prefix, sizeof(prefix), message->level,
+				message->file, message->func, message->line,
+				&origin);
+
+	ctx->handler(message->level, prefix, message->msg, ctx->user_data);
+}
+
+artik_error os_log_decode_binary(const void *data, size_t len,
+		artik_log_handler handler, void *user_data)
+{
+	struct _log_decode_context ctx;
+
+	if (!data || !handler)
+		return E_BAD_ARGS;
+
+	ctx.handler = handler;
+	ctx.user_data = user_data;
+
+	if (log_binary_decode(data, len, _log_decode_message, &ctx) < 0)
+		return E_INVALID_VALUE;
+
+	return S_OK;
+}
@@ -0,0 +1,1074 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "log_binary.h"
+
+#define MAX_SPEC_LEN	32
+#define LOG_MAX_STRING	512
+#define LOG_MAX_FIELD	1024
+
+enum log_arg_class {
+	LOG_ARG_SIGNED,
+	LOG_ARG_UNSIGNED,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER,
+	LOG_ARG_ERRNO,
+	LOG_ARG_INVALID
+};
+
+enum log_arg_length {
+	LOG_LEN_INT,
+	LOG_LEN_CHAR,
+	LOG_LEN_SHORT,
+	LOG_LEN_LONG,
+	LOG_LEN_LLONG,
+	LOG_LEN_INTMAX,
+	LOG_LEN_SIZE,
+	LOG_LEN_PTRDIFF,
+	LOG_LEN_LDOUBLE
+};
+
+/* One conversion specification of a format string */
+struct log_spec {
+	char			flags[8];
+	int			width_star;
+	int			width;
+	int			precision_star;
+	int			precision;
+	enum log_arg_length	length;
+	char			conversion;
+	enum log_arg_class	class;
+};
+
+/*
+ * Parse the conversion starting at 'p', which points after the '%'. Returns
+ * a pointer after the conversion character.
+ */
+static const char *_parse_spec(const char *p, struct log_spec *spec)
+{
+	size_t nflags = 0;
+
+	memset(spec, 0, sizeof(*spec));
+	spec->width = -1;
+	spec->precision = -1;
+
+	while (*p && strchr("-+ #0'", *p)) {
+		if (nflags < sizeof(spec->flags) - 1)
+			spec->flags[nflags++] = *p;
+		p++;
+	}
+
+	if (*p == '*') {
+		spec->width_star = 1;
+		p++;
+	} else if (*p >= '0' && *p <= '9') {
+		spec->width = strtol(p, (char **)&p, 10);
+	}
+
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->precision_star = 1;
+			p++;
+		} else {
+			spec->precision = strtol(p, (char **)&p, 10);
+		}
+	}
+
+	switch (*p) {
+	case 'h':
+		spec->length = (p[1] == 'h') ? LOG_LEN_CHAR : LOG_LEN_SHORT;
+		p += (p[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		spec->length = (p[1] == 'l') ? LOG_LEN_LLONG : LOG_LEN_LONG;
+		p += (p[1] == 'l') ? 2 : 1;
+		break;
+	case 'q':
+		spec->length = LOG_LEN_LLONG;
+		p++;
+		break;
+	case 'j':
+		spec->length = LOG_LEN_INTMAX;
+		p++;
+		break;
+	case 'z':
+	case 'Z':
+		spec->length = LOG_LEN_SIZE;
+		p++;
+		break;
+	case 't':
+		spec->length = LOG_LEN_PTRDIFF;
+		p++;
+		break;
+	case 'L':
+		spec->length = LOG_LEN_LDOUBLE;
+		p++;
+		break;
+	default:
+		break;
+	}
+
+	spec->conversion = *p;
+	switch (*p) {
+	case 'd':
+	case 'i':
+	case 'c':
+		spec->class = LOG_ARG_SIGNED;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		spec->class = LOG_ARG_UNSIGNED;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec->class = LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		spec->class = LOG_ARG_STRING;
+		break;
+	case 'p':
+	case 'n':
+		spec->class = LOG_ARG_POINTER;
+		break;
+	case 'm':
+		spec->class = LOG_ARG_ERRNO;
+		break;
+	default:
+		spec->class = LOG_ARG_INVALID;
+		return p;
+	}
+
+	return p + 1;
+}
+
+static bool _put_u64(uint8_t *buf, size_t size, size_t *pos, uint64_t value)
+{
+	if (*pos + sizeof(value) > size)
+		return false;
+
+	memcpy(buf + *pos, &value, sizeof(value));
+	*pos += sizeof(value);
+
+	return true;
+}
+
+static bool _get_u64(const uint8_t *buf, size_t size, size_t *pos,
+			uint64_t *value)
+{
+	if (*pos + sizeof(*value) > size)
+		return false;
+
+	memcpy(value, buf + *pos, sizeof(*value));
+	*pos += sizeof(*value);
+
+	return true;
+}
+
+/*
+ * Argument types of a format string. Parsing the format takes most of the
+ * time of a capture, so the signatures of the formats last used by each
+ * thread are cached, packed 4 bits per argument. Signatures with codes
+ * above LOG_SIG_PACKED_MAX or more than LOG_SIG_PACKED_ARGS arguments are
+ * parsed at each call.
+ */
+enum log_sig_code {
+	LOG_SIG_END,
+	LOG_SIG_INT,
+	LOG_SIG_UINT,
+	LOG_SIG_LONG,
+	LOG_SIG_ULONG,
+	LOG_SIG_LLONG,
+	LOG_SIG_ULLONG,
+	LOG_SIG_SCHAR,
+	LOG_SIG_UCHAR,
+	LOG_SIG_SHORT,
+	LOG_SIG_USHORT,
+	LOG_SIG_DOUBLE,
+	LOG_SIG_LDOUBLE,
+	LOG_SIG_STRING,
+	LOG_SIG_POINTER,
+	LOG_SIG_ERRNO,
+	/* Not packed */
+	LOG_SIG_STRING_PRECISION,
+	LOG_SIG_STRING_STAR,
+	LOG_SIG_SKIP_POINTER
+};
+
+#define LOG_SIG_PACKED_MAX	LOG_SIG_ERRNO
+#define LOG_SIG_PACKED_ARGS	15
+#define LOG_SIG_MAX_ARGS	64
+#define LOG_SIG_CACHE_SIZE	64	/* Must be a power of 2 */
+
+struct log_signature {
+	uint8_t		codes[LOG_SIG_MAX_ARGS + 1];
+	int		precision[LOG_SIG_MAX_ARGS];
+	bool		incomplete;
+};
+
+struct log_sig_slot {
+	const char	*format;
+	uint64_t	packed;
+};
+
+static __thread struct log_sig_slot _sig_cache[LOG_SIG_CACHE_SIZE];
+
+static uint8_t _sig_code(struct log_spec *spec)
+{
+	bool is_long = (spec->length == LOG_LEN_LONG) ||
+		(spec->length == LOG_LEN_INTMAX &&
+			sizeof(intmax_t) == sizeof(long)) ||
+		(spec->length == LOG_LEN_SIZE &&
+			sizeof(size_t) == sizeof(long)) ||
+		(spec->length == LOG_LEN_PTRDIFF &&
+			sizeof(ptrdiff_t) == sizeof(long));
+	bool is_llong = !is_long && (spec->length == LOG_LEN_LLONG ||
+		spec->length == LOG_LEN_INTMAX ||
+		spec->length == LOG_LEN_SIZE ||
+		spec->length == LOG_LEN_PTRDIFF);
+
+	switch (spec->class) {
+	case LOG_ARG_SIGNED:
+		if (spec->conversion == 'c')
+			return LOG_SIG_INT;
+		if (is_long)
+			return LOG_SIG_LONG;
+		if (is_llong)
+			return LOG_SIG_LLONG;
+		if (spec->length == LOG_LEN_CHAR)
+			return LOG_SIG_SCHAR;
+		if (spec->length == LOG_LEN_SHORT)
+			return LOG_SIG_SHORT;
+		return LOG_SIG_INT;
+	case LOG_ARG_UNSIGNED:
+		if (is_long)
+			return LOG_SIG_ULONG;
+		if (is_llong)
+			return LOG_SIG_ULLONG;
+		if (spec->length == LOG_LEN_CHAR)
+			return LOG_SIG_UCHAR;
+		if (spec->length == LOG_LEN_SHORT)
+			return LOG_SIG_USHORT;
+		return LOG_SIG_UINT;
+	case LOG_ARG_DOUBLE:
+		return (spec->length == LOG_LEN_LDOUBLE) ? LOG_SIG_LDOUBLE :
+			LOG_SIG_DOUBLE;
+	case LOG_ARG_STRING:
+		/* The string may not be NUL terminated within its precision */
+		if (spec->precision_star)
+			return LOG_SIG_STRING_STAR;
+		if (spec->precision >= 0)
+			return LOG_SIG_STRING_PRECISION;
+		return LOG_SIG_STRING;
+	case LOG_ARG_POINTER:
+		return (spec->conversion == 'n') ? LOG_SIG_SKIP_POINTER :
+			LOG_SIG_POINTER;
+	case LOG_ARG_ERRNO:
+		return LOG_SIG_ERRNO;
+	default:
+		return LOG_SIG_END;
+	}
+}
+
+static void _sig_parse(const char *format, struct log_signature *sig)
+{
+	const char *p = format;
+	int count = 0;
+
+	sig->incomplete = false;
+
+	while ((p = strchr(p, '%')) != NULL) {
+		struct log_spec spec;
+
+		if (p[1] == '%') {
+			p += 2;
+			continue;
+		}
+
+		p = _parse_spec(p + 1, &spec);
+		if (spec.class == LOG_ARG_INVALID ||
+				count + 3 > LOG_SIG_MAX_ARGS) {
+			/* Unknown argument types, stop capturing there */
+			sig->incomplete = true;
+			break;
+		}
+
+		if (spec.width_star)
+			sig->codes[count++] = LOG_SIG_INT;
+		if (spec.precision_star)
+			sig->codes[count++] = LOG_SIG_INT;
+		sig->precision[count] = spec.precision;
+		sig->codes[count++] = _sig_code(&spec);
+	}
+
+	sig->codes[count] = LOG_SIG_END;
+}
+
+static void _sig_get(const char *format, struct log_signature *sig)
+{
+	struct log_sig_slot *slot = &_sig_cache[((uintptr_t)format >> 3) &
+						(LOG_SIG_CACHE_SIZE - 1)];
+	uint64_t packed = 0;
+	int i;
+
+	if (slot->format == format) {
+		for (i = 0; i <= LOG_SIG_PACKED_ARGS; i++) {
+			sig->codes[i] = (slot->packed >> (4 * i)) & 0xf;
+			if (sig->codes[i] == LOG_SIG_END)
+				break;
+		}
+		sig->incomplete = false;
+		return;
+	}
+
+	_sig_parse(format, sig);
+	if (sig->incomplete)
+		return;
+
+	for (i = 0; sig->codes[i] != LOG_SIG_END; i++) {
+		if (i >= LOG_SIG_PACKED_ARGS ||
+				sig->codes[i] > LOG_SIG_PACKED_MAX)
+			return;
+		packed |= (uint64_t)sig->codes[i] << (4 * i);
+	}
+
+	slot->format = format;
+	slot->packed = packed;
+}
+
+static bool _put_arg_string(uint8_t *buf, size_t size, size_t *pos,
+			const char *str, size_t max, bool *truncated)
+{
+	size_t limit;
+	uint16_t len;
+
+	if (!str)
+		str = "(null)";
+	if (*pos + sizeof(len) > size)
+		return false;
+
+	limit = size - *pos - sizeof(len);
+	if (limit > UINT16_MAX)
+		limit = UINT16_MAX;
+	if (max < limit)
+		limit = max;
+	else
+		max = SIZE_MAX;
+
+	len = strnlen(str, limit);
+	if (len == limit && max == SIZE_MAX && str[len])
+		*truncated = true;
+
+	memcpy(buf + *pos, &len, sizeof(len));
+	memcpy(buf + *pos + sizeof(len), str, len);
+	*pos += sizeof(len) + len;
+
+	return true;
+}
+
+size_t log_binary_capture(uint8_t *buf, size_t size, const char *format,
+			va_list arg, bool *truncated)
+{
+	struct log_signature sig;
+	int64_t last_int = -1;
+	size_t pos = 0;
+	va_list ap;
+	int i;
+
+	_sig_get(format, &sig);
+	if (sig.incomplete)
+		*truncated = true;
+
+	va_copy(ap, arg);
+
+	for (i = 0; sig.codes[i] != LOG_SIG_END; i++) {
+		uint64_t value;
+		double d;
+
+		switch (sig.codes[i]) {
+		case LOG_SIG_INT:
+			last_int = va_arg(ap, int);
+			value = (uint64_t)last_int;
+			break;
+		case LOG_SIG_UINT:
+			value = va_arg(ap, unsigned int);
+			break;
+		case LOG_SIG_LONG:
+			value = (uint64_t)(int64_t)va_arg(ap, long);
+			break;
+		case LOG_SIG_ULONG:
+			value = va_arg(ap, unsigned long);
+			break;
+		case LOG_SIG_LLONG:
+			value = (uint64_t)va_arg(ap, long long);
+			break;
+		case LOG_SIG_ULLONG:
+			value = va_arg(ap, unsigned long long);
+			break;
+		case LOG_SIG_SCHAR:
+			value = (uint64_t)(int64_t)(signed char)va_arg(ap, int);
+			break;
+		case LOG_SIG_UCHAR:
+			value = (unsigned char)va_arg(ap, unsigned int);
+			break;
+		case LOG_SIG_SHORT:
+			value = (uint64_t)(int64_t)(short)va_arg(ap, int);
+			break;
+		case LOG_SIG_USHORT:
+			value = (unsigned short)va_arg(ap, unsigned int);
+			break;
+		case LOG_SIG_DOUBLE:
+			d = va_arg(ap, double);
+			memcpy(&value, &d, sizeof(value));
+			break;
+		case LOG_SIG_LDOUBLE:
+			d = (double)va_arg(ap, long double);
+			memcpy(&value, &d, sizeof(value));
+			break;
+		case LOG_SIG_POINTER:
+			value = (uintptr_t)va_arg(ap, void *);
+			break;
+		case LOG_SIG_ERRNO:
+			value = errno;
+			break;
+		case LOG_SIG_SKIP_POINTER:
+			(void)va_arg(ap, void *);
+			continue;
+		case LOG_SIG_STRING:
+		case LOG_SIG_STRING_PRECISION:
+		case LOG_SIG_STRING_STAR: {
+			const char *str = va_arg(ap, const char *);
+			size_t max = SIZE_MAX;
+
+			if (sig.codes[i] == LOG_SIG_STRING_PRECISION)
+				max = sig.precision[i];
+			else if (sig.codes[i] == LOG_SIG_STRING_STAR &&
+					last_int >= 0)
+				max = last_int;
+
+			if (!_put_arg_string(buf, size, &pos, str, max,
+						truncated))
+				goto full;
+			continue;
+		}
+		default:
+			goto full;
+		}
+
+		if (!_put_u64(buf, size, &pos, value))
+			goto full;
+	}
+
+	va_end(ap);
+
+	return pos;
+
+full:
+	*truncated = true;
+	va_end(ap);
+
+	return pos;
+}
+
+/* Rebuild a conversion taking a single argument of the stored type */
+static void _build_spec(char *out, struct log_spec *spec, const char *length,
+			char conversion)
+{
+	int len;
+
+	len = snprintf(out, MAX_SPEC_LEN, "%%%s", spec->flags);
+	if (spec->width >= 0)
+		len += snprintf(out + len, MAX_SPEC_LEN - len, "%d",
+				spec->width);
+	if (spec->precision >= 0)
+		len += snprintf(out + len, MAX_SPEC_LEN - len, ".%d",
+				spec->precision);
+	snprintf(out + len, MAX_SPEC_LEN - len, "%s%c", length, conversion);
+}
+
+static void _append(char *out, size_t size, size_t *pos, const char *str,
+			size_t len)
+{
+	if (*pos + 1 >= size)
+		return;
+
+	if (len > size - *pos - 1)
+		len = size - *pos - 1;
+	memcpy(out + *pos, str, len);
+	*pos += len;
+	out[*pos] = '\0';
+}
+
+int log_binary_format(char *out, size_t size, const char *format,
+			const uint8_t *args, size_t args_len)
+{
+	const char *p = format;
+	size_t pos = 0;
+	size_t arg_pos = 0;
+
+	if (!size)
+		return 0;
+	out[0] = '\0';
+
+	while (*p) {
+		const char *next = strchr(p, '%');
+		struct log_spec spec;
+		char fmt[MAX_SPEC_LEN];
+		char field[LOG_MAX_FIELD];
+		uint64_t value = 0;
+		int len = 0;
+
+		if (!next) {
+			_append(out, size, &pos, p, strlen(p));
+			break;
+		}
+
+		_append(out, size, &pos, p, next - p);
+		if (next[1] == '%') {
+			_append(out, size, &pos, "%", 1);
+			p = next + 2;
+			continue;
+		}
+
+		p = _parse_spec(next + 1, &spec);
+		if (spec.class == LOG_ARG_INVALID)
+			break;
+
+		if (spec.width_star) {
+			if (!_get_u64(args, args_len, &arg_pos, &value))
+				break;
+			spec.width = (int)(int64_t)value;
+			if (spec.width < 0) {
+				/* Negative '*' width means left adjustment */
+				spec.width = -spec.width;
+				strncat(spec.flags, "-",
+					sizeof(spec.flags) -
+					strlen(spec.flags) - 1);
+			}
+		}
+		if (spec.precision_star) {
+			if (!_get_u64(args, args_len, &arg_pos, &value))
+				break;
+			spec.precision = (int)(int64_t)value;
+		}
+
+		if (spec.class == LOG_ARG_STRING) {
+			char str[LOG_MAX_STRING];
+			uint16_t str_len;
+			size_t copy;
+
+			if (arg_pos + sizeof(str_len) > args_len)
+				break;
+			memcpy(&str_len, args + arg_pos, sizeof(str_len));
+			arg_pos += sizeof(str_len);
+			if (arg_pos + str_len > args_len)
+				break;
+
+			copy = (str_len < sizeof(str)) ? str_len :
+				sizeof(str) - 1;
+			memcpy(str, args + arg_pos, copy);
+			str[copy] = '\0';
+			arg_pos += str_len;
+
+			_build_spec(fmt, &spec, "", 's');
+			len = snprintf(field, sizeof(field), fmt, str);
+			if (len > 0)
+				_append(out, size, &pos, field,
+					len < (int)sizeof(field) ? len :
+					(int)sizeof(field) - 1);
+			continue;
+		}
+
+		if (spec.conversion == 'n')
+			continue;
+
+		if (!_get_u64(args, args_len, &arg_pos, &value))
+			break;
+
+		switch (spec.class) {
+		case LOG_ARG_SIGNED:
+			if (spec.conversion == 'c') {
+				_build_spec(fmt, &spec, "", 'c');
+				len = snprintf(field, sizeof(field), fmt,
+						(int)(int64_t)value);
+			} else {
+				_build_spec(fmt, &spec, "ll", 'd');
+				len = snprintf(field, sizeof(field), fmt,
+						(long long)value);
+			}
+			break;
+		case LOG_ARG_UNSIGNED:
+			_build_spec(fmt, &spec, "ll", spec.conversion);
+			len = snprintf(field, sizeof(field), fmt,
+					(unsigned long long)value);
+			break;
+		case LOG_ARG_DOUBLE: {
+			double d;
+
+			memcpy(&d, &value, sizeof(d));
+			_build_spec(fmt, &spec, "", spec.conversion);
+			len = snprintf(field, sizeof(field), fmt, d);
+			break;
+		}
+		case LOG_ARG_POINTER:
+			_build_spec(fmt, &spec, "", 'p');
+			len = snprintf(field, sizeof(field), fmt,
+					(void *)(uintptr_t)value);
+			break;
+		case LOG_ARG_ERRNO:
+			_build_spec(fmt, &spec, "", 's');
+			len = snprintf(field, sizeof(field), fmt,
+					strerror((int)value));
+			break;
+		default:
+			break;
+		}
+
+		if (len > 0)
+			_append(out, size, &pos, field,
+				len < (int)sizeof(field) ? len :
+				(int)sizeof(field) - 1);
+	}
+
+	return (int)pos;
+}
+
+/* Strings of a call site description are cut to this length */
+#define LOG_MAX_SITE_STRING	1024
+
+struct log_binary_site {
+	const char	*format;
+	const char	*file;
+	int		line;
+	uint32_t	id;
+};
+
+static size_t _site_hash(const char *format, const char *file, int line)
+{
+	uint64_t h = (uintptr_t)format ^ ((uint64_t)(uintptr_t)file << 7) ^
+			(uint64_t)line;
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+
+	return (size_t)h;
+}
+
+static struct log_binary_site *_site_slot(struct log_binary_site *sites,
+			size_t max, const char *format, const char *file,
+			int line)
+{
+	size_t i = _site_hash(format, file, line) & (max - 1);
+
+	while (sites[i].format && (sites[i].format != format ||
+			sites[i].file != file || sites[i].line != line))
+		i = (i + 1) & (max - 1);
+
+	return &sites[i];
+}
+
+static int _sites_grow(struct log_binary_writer *writer)
+{
+	size_t max = writer->max_sites ? writer->max_sites * 2 : 64;
+	struct log_binary_site *sites;
+	size_t i;
+
+	sites = calloc(max, sizeof(*sites));
+	if (!sites)
+		return -1;
+
+	for (i = 0; i < writer->max_sites; i++) {
+		struct log_binary_site *site = &writer->sites[i];
+
+		if (site->format)
+			*_site_slot(sites, max, site->format, site->file,
+					site->line) = *site;
+	}
+
+	free(writer->sites);
+	writer->sites = sites;
+	writer->max_sites = max;
+
+	return 0;
+}
+
+int log_binary_writer_init(struct log_binary_writer *writer, size_t size,
+			log_binary_output output, void *user_data)
+{
+	memset(writer, 0, sizeof(*writer));
+
+	writer->buf = malloc(size);
+	if (!writer->buf)
+		return -1;
+
+	writer->size = size;
+	writer->output = output;
+	writer->user_data = user_data;
+
+	return 0;
+}
+
+void log_binary_writer_cleanup(struct log_binary_writer *writer)
+{
+	free(writer->buf);
+	free(writer->sites);
+	memset(writer, 0, sizeof(*writer));
+}
+
+void log_binary_writer_flush(struct log_binary_writer *writer)
+{
+	if (writer->len && writer->output)
+		writer->output(writer->buf, writer->len, writer->user_data);
+	writer->len = 0;
+}
+
+/* Returns where to write a record of 'size' bytes, NULL if too big */
+static uint8_t *_reserve(struct log_binary_writer *writer, size_t size,
+			uint8_t type, int level)
+{
+	struct log_binary_header hdr;
+	uint8_t *rec;
+
+	if (size > UINT16_MAX || size > writer->size)
+		return NULL;
+
+	if (writer->len + size > writer->size)
+		log_binary_writer_flush(writer);
+
+	hdr.size = size;
+	hdr.type = type;
+	hdr.level = level;
+
+	rec = writer->buf + writer->len;
+	memcpy(rec, &hdr, sizeof(hdr));
+	writer->len += size;
+
+	return rec;
+}
+
+void log_binary_writer_start(struct log_binary_writer *writer, uint32_t pid,
+			uint64_t monotonic_ns, uint64_t realtime_ns)
+{
+	struct log_binary_stream stream;
+	uint8_t *rec;
+
+	if (writer->sites)
+		memset(writer->sites, 0,
+			writer->max_sites * sizeof(*writer->sites));
+	writer->num_sites = 0;
+
+	rec = _reserve(writer, sizeof(stream), LOG_BINARY_STREAM, 0);
+	if (!rec)
+		return;
+
+	memcpy(&stream.hdr, rec, sizeof(stream.hdr));
+	stream.magic = LOG_BINARY_MAGIC;
+	stream.version = LOG_BINARY_VERSION;
+	stream.reserved = 0;
+	stream.pid = pid;
+	stream.monotonic_ns = monotonic_ns;
+	stream.realtime_ns = realtime_ns;
+	memcpy(rec, &stream, sizeof(stream));
+}
+
+static size_t _site_strlen(const char *str)
+{
+	return str ? strnlen(str, LOG_MAX_SITE_STRING) : 0;
+}
+
+static void _put_string(uint8_t *rec, size_t *pos, const char *str,
+			size_t len)
+{
+	if (len)
+		memcpy(rec + *pos, str, len);
+	rec[*pos + len] = '\0';
+	*pos += len + 1;
+}
+
+static struct log_binary_site *_describe_site(
+			struct log_binary_writer *writer, int level,
+			const char *format, const char *file,
+			const char *func, int line)
+{
+	struct log_binary_format def;
+	struct log_binary_site *site;
+	size_t pos = sizeof(def);
+	uint8_t *rec;
+
+	if ((writer->num_sites + 1) * 2 > writer->max_sites &&
+			_sites_grow(writer) < 0)
+		return NULL;
+
+	def.format_len = _site_strlen(format);
+	def.file_len = _site_strlen(file);
+	def.func_len = _site_strlen(func);
+	rec = _reserve(writer, sizeof(def) + def.format_len + def.file_len +
+			def.func_len + 3, LOG_BINARY_FORMAT, level);
+	if (!rec)
+		return NULL;
+
+	site = _site_slot(writer->sites, writer->max_sites, format, file,
+				line);
+	site->format = format;
+	site->file = file;
+	site->line = line;
+	site->id = writer->num_sites++;
+
+	memcpy(&def.hdr, rec, sizeof(def.hdr));
+	def.id = site->id;
+	def.line = line;
+	def.reserved = 0;
+	memcpy(rec, &def, sizeof(def));
+	_put_string(rec, &pos, format, def.format_len);
+	_put_string(rec, &pos, file, def.file_len);
+	_put_string(rec, &pos, func, def.func_len);
+
+	return site;
+}
+
+void log_binary_writer_event(struct log_binary_writer *writer, int level,
+			const char *format, const char *file,
+			const char *func, int line, uint32_t tid,
+			uint64_t timestamp_ns, const uint8_t *args,
+			size_t args_len)
+{
+	struct log_binary_event event;
+	struct log_binary_site *site = NULL;
+	uint8_t *rec;
+
+	if (writer->max_sites)
+		site = _site_slot(writer->sites, writer->max_sites, format,
+					file, line);
+	if (!site || !site->format)
+		site = _describe_site(writer, level, format, file, func, line);
+	if (!site)
+		return;
+
+	rec = _reserve(writer, sizeof(event) + args_len, LOG_BINARY_EVENT,
+			level);
+	if (!rec)
+		return;
+
+	memcpy(&event.hdr, rec, sizeof(event.hdr));
+	event.id = site->id;
+	event.tid = tid;
+	event.timestamp_ns = timestamp_ns;
+	memcpy(rec, &event, sizeof(event));
+	memcpy(rec + sizeof(event), args, args_len);
+}
+
+void log_binary_writer_text(struct log_binary_writer *writer, int level,
+			uint32_t tid, uint64_t timestamp_ns,
+			const char *prefix, size_t prefix_len,
+			const char *msg, size_t msg_len)
+{
+	struct log_binary_text text;
+	size_t pos = sizeof(text);
+	uint8_t *rec;
+
+	rec = _reserve(writer, sizeof(text) + prefix_len + msg_len + 2,
+			LOG_BINARY_TEXT, level);
+	if (!rec)
+		return;
+
+	memcpy(&text.hdr, rec, sizeof(text.hdr));
+	text.tid = tid;
+	text.prefix_len = prefix_len;
+	text.msg_len = msg_len;
+	text.timestamp_ns = timestamp_ns;
+	memcpy(rec, &text, sizeof(text));
+	_put_string(rec, &pos, prefix, prefix_len);
+	_put_string(rec, &pos, msg, msg_len);
+}
+
+struct log_binary_decoded_site {
+	const char	*format;
+	const char	*file;
+	const char	*func;
+	int		line;
+};
+
+/* Check that 'len' bytes followed by a NUL are within the record */
+static const char *_get_string(const uint8_t *rec, size_t size, size_t *pos,
+			size_t len)
+{
+	const char *str = (const char *)rec + *pos;
+
+	if (*pos + len + 1 > size || str[len] != '\0')
+		return NULL;
+
+	*pos += len + 1;
+
+	return str;
+}
+
+int log_binary_decode(const uint8_t *data, size_t len,
+			log_binary_callback callback, void *user_data)
+{
+	struct log_binary_decoded_site *sites = NULL;
+	struct log_binary_message message;
+	size_t num_sites = 0;
+	size_t max_sites = 0;
+	uint64_t offset_ns = 0;
+	uint32_t pid = 0;
+	size_t pos = 0;
+	int ret = 0;
+
+	while (pos + sizeof(struct log_binary_header) <= len) {
+		const uint8_t *rec = data + pos;
+		struct log_binary_header hdr;
+
+		memcpy(&hdr, rec, sizeof(hdr));
+		if (hdr.size < sizeof(hdr) || pos + hdr.size > len) {
+			ret = -1;
+			break;
+		}
+		pos += hdr.size;
+
+		memset(&message, 0, sizeof(message));
+		message.level = hdr.level;
+		message.pid = pid;
+
+		switch (hdr.type) {
+		case LOG_BINARY_STREAM: {
+			struct log_binary_stream stream;
+
+			if (hdr.size < sizeof(stream))
+				goto malformed;
+			memcpy(&stream, rec, sizeof(stream));
+			if (stream.magic != LOG_BINARY_MAGIC ||
+					stream.version != LOG_BINARY_VERSION)
+				goto malformed;
+
+			pid = stream.pid;
+			offset_ns = stream.realtime_ns - stream.monotonic_ns;
+			num_sites = 0;
+			break;
+		}
+		case LOG_BINARY_FORMAT: {
+			struct log_binary_decoded_site *site;
+			struct log_binary_format def;
+			size_t str_pos = sizeof(def);
+
+			if (hdr.size < sizeof(def))
+				goto malformed;
+			memcpy(&def, rec, sizeof(def));
+			if (def.id != num_sites)
+				goto malformed;
+
+			if (num_sites == max_sites) {
+				size_t max = max_sites ? max_sites * 2 : 64;
+				void *tmp;
+
+				tmp = realloc(sites, max * sizeof(*sites));
+				if (!tmp) {
+					ret = -1;
+					goto exit;
+				}
+				sites = tmp;
+				max_sites = max;
+			}
+
+			site = &sites[num_sites];
+			site->line = def.line;
+			site->format = _get_string(rec, hdr.size, &str_pos,
+							def.format_len);
+			site->file = _get_string(rec, hdr.size, &str_pos,
+							def.file_len);
+			site->func = _get_string(rec, hdr.size, &str_pos,
+							def.func_len);
+			if (!site->format || !site->file || !site->func)
+				goto malformed;
+			num_sites++;
+			break;
+		}
+		case LOG_BINARY_EVENT: {
+			struct log_binary_decoded_site *site;
+			struct log_binary_event event;
+			char msg[4096];
+
+			if (hdr.size < sizeof(event))
+				goto malformed;
+			memcpy(&event, rec, sizeof(event));
+			if (event.id >= num_sites)
+				goto malformed;
+
+			site = &sites[event.id];
+			log_binary_format(msg, sizeof(msg), site->format,
+					rec + sizeof(event),
+					hdr.size - sizeof(event));
+			message.tid = event.tid;
+			message.realtime_ns = event.timestamp_ns + offset_ns;
+			message.file = site->file;
+			message.func = site->func;
+			message.line = site->line;
+			message.msg = msg;
+			callback(&message, user_data);
+			break;
+		}
+		case LOG_BINARY_TEXT: {
+			struct log_binary_text text;
+			size_t str_pos = sizeof(text);
+
+			if (hdr.size < sizeof(text))
+				goto malformed;
+			memcpy(&text, rec, sizeof(text));
+
+			message.tid = text.tid;
+			message.realtime_ns = text.timestamp_ns + offset_ns;
+			message.prefix = _get_string(rec, hdr.size, &str_pos,
+							text.prefix_len);
+			message.msg = _get_string(rec, hdr.size, &str_pos,
+							text.msg_len);
+			if (!message.prefix || !message.msg)
+				goto malformed;
+			callback(&message, user_data);
+			break;
+		}
+		default:
+			/* Unknown records are skipped */
+			break;
+		}
+	}
+
+	goto exit;
+
+malformed:
+	ret = -1;
+exit:
+	free(sites);
+
+	return ret;
+}
@@ -0,0 +1,171 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__LOG_BINARY_H
+#define	__LOG_BINARY_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary log stream produced by LOG_SYSTEM_BINARY.
+ *
+ * The stream is a sequence of records in host byte order, each one starting
+ * with a log_binary_header. A STREAM record opens the stream and gives the
+ * time reference, a FORMAT record describes a call site the first time it
+ * is used, then EVENT records only carry the call site id, the timestamp
+ * and the raw arguments. TEXT records carry messages that were already
+ * formatted when the stream was selected.
+ *
+ * Event arguments are stored in the order of the format conversions: 8
+ * bytes for integers, pointers and floating point values ('*' widths and
+ * precisions included), and a 16-bit length followed by the bytes for
+ * strings.
+ */
+
+#define LOG_BINARY_MAGIC	0x474f4c41	/* "ALOG" */
+#define LOG_BINARY_VERSION	1
+
+enum log_binary_type {
+	LOG_BINARY_STREAM = 1,
+	LOG_BINARY_FORMAT,
+	LOG_BINARY_EVENT,
+	LOG_BINARY_TEXT
+};
+
+struct log_binary_header {
+	uint16_t	size;	/* Size of the record, header included */
+	uint8_t		type;
+	uint8_t		level;
+};
+
+struct log_binary_stream {
+	struct log_binary_header	hdr;
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	reserved;
+	uint32_t	pid;
+	/* Same instant on CLOCK_MONOTONIC and CLOCK_REALTIME */
+	uint64_t	monotonic_ns;
+	uint64_t	realtime_ns;
+};
+
+/* Followed by the format, file and function strings, NUL terminated */
+struct log_binary_format {
+	struct log_binary_header	hdr;
+	uint32_t	id;
+	uint32_t	line;
+	uint16_t	format_len;
+	uint16_t	file_len;
+	uint16_t	func_len;
+	uint16_t	reserved;
+};
+
+/* Followed by the arguments */
+struct log_binary_event {
+	struct log_binary_header	hdr;
+	uint32_t	id;
+	uint32_t	tid;
+	uint64_t	timestamp_ns;
+};
+
+/* Followed by the prefix and message strings, NUL terminated */
+struct log_binary_text {
+	struct log_binary_header	hdr;
+	uint32_t	tid;
+	uint16_t	prefix_len;
+	uint16_t	msg_len;
+	uint64_t	timestamp_ns;
+};
+
+/*
+ * Store the arguments of 'format' into 'buf'. Strings are cut to fit, in
+ * which case 'truncated' is set. Returns the number of bytes used.
+ */
+size_t log_binary_capture(uint8_t *buf, size_t size, const char *format,
+			va_list arg, bool *truncated);
+
+/*
+ * Format 'format' with arguments stored by log_binary_capture, like
+ * snprintf. Returns the length of the message written to 'out'.
+ */
+int log_binary_format(char *out, size_t size, const char *format,
+			const uint8_t *args, size_t args_len);
+
+/* Encoder of the binary stream, only used from the log writer thread */
+typedef void (*log_binary_output)(const void *data, size_t len,
+					void *user_data);
+
+struct log_binary_site;
+
+struct log_binary_writer {
+	uint8_t			*buf;
+	size_t			len;
+	size_t			size;
+	log_binary_output	output;
+	void			*user_data;
+	/* Call sites already described in the stream */
+	struct log_binary_site	*sites;
+	size_t			num_sites;
+	size_t			max_sites;
+};
+
+int log_binary_writer_init(struct log_binary_writer *writer, size_t size,
+			log_binary_output output, void *user_data);
+void log_binary_writer_cleanup(struct log_binary_writer *writer);
+/* Forget the described call sites and start a new stream */
+void log_binary_writer_start(struct log_binary_writer *writer, uint32_t pid,
+			uint64_t monotonic_ns, uint64_t realtime_ns);
+void log_binary_writer_event(struct log_binary_writer *writer, int level,
+			const char *format, const char *file,
+			const char *func, int line, uint32_t tid,
+			uint64_t timestamp_ns, const uint8_t *args,
+			size_t args_len);
+void log_binary_writer_text(struct log_binary_writer *writer, int level,
+			uint32_t tid, uint64_t timestamp_ns,
+			const char *prefix, size_t prefix_len,
+			const char *msg, size_t msg_len);
+void log_binary_writer_flush(struct log_binary_writer *writer);
+
+/* Decoded message, times are CLOCK_REALTIME nanoseconds */
+struct log_binary_message {
+	int		level;
+	uint32_t	pid;
+	uint32_t	tid;
+	uint64_t	realtime_ns;
+	const char	*file;
+	const char	*func;
+	int		line;
+	/* Only set for messages formatted before being logged */
+	const char	*prefix;
+	const char	*msg;
+};
+
+typedef void (*log_binary_callback)(const struct log_binary_message *message,
+					void *user_data);
+
+/*
+ * Decode a complete stream, calling 'callback' for each message. Returns 0
+ * on success, -1 if the stream is malformed or memory is exhausted.
+ */
+int log_binary_decode(const uint8_t *data, size_t len,
+			log_binary_callback callback, void *user_data);
+
+#endif	/* __LOG_BINARY_H */
@@ -29,5 +29,14 @@ enum artik_log_prefix os_log_get_prefix_fields(void);
 void os_log_print(enum artik_log_level level, const char *filename,
 		const char *funcname, int line, const char *format,
 		va_list arg);
+artik_error os_log_set_level(enum artik_log_level level);
+artik_error os_log_set_module_level(const char *module, int level);
+artik_error os_log_set_async(bool enable);
+artik_error os_log_flush(void);
+artik_error os_log_get_stats(artik_log_stats *stats);
+artik_error os_log_set_binary_handler(artik_log_binary_handler handler,
+		void *user_data);
+artik_error os_log_decode_binary(const void *data, size_t len,
+		artik_log_handler handler, void *user_data);
 
 #endif	/* __OS_LOG_H */
@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include <artik_log.h>
+#include "os_log.h"
 
 #define MAX_FIELDSIZE_FILENAME 30
 #define MAX_FIELDSIZE_FUNCNAME 30
@@ -32,6 +33,8 @@ static artik_log_handler _log_handler;
 static void *_log_handler_user_data;
 static int _log_override_enabled;
 static int _log_override_checked;
+static int _log_level = LOG_LEVEL_DEBUG;
+static uint64_t _log_stat_logged;
 
 /* Initialization must follow artik_log_level order form artik_log.h */
 static char _log_level_map[] = { 'E', 'W', 'I', 'D' };
@@ -151,9 +154,11 @@ void os_log_print(enum artik_log_level level, const char *filename,
 	if (!_log_override_checked)
 		_log_check_override();
 
-	if (level > LOG_LEVEL_DEBUG)
+	if ((int)level > _log_level)
 		return;
 
+	_log_stat_logged++;
+
 	switch (_log_system) {
 	case LOG_SYSTEM_STDERR:
 	case LOG_SYSTEM_CUSTOM:
@@ -167,6 +172,9 @@ void os_log_print(enum artik_log_level level, const char *filename,
 
 artik_error os_log_set_system(enum artik_log_system system)
 {
+	if (system == LOG_SYSTEM_BINARY)
+		return E_NOT_SUPPORTED;
+
 	if (system > LOG_SYSTEM_CUSTOM) {
 		log_err("invalid system(%d)", system);
 		return E_BAD_ARGS;
@@ -205,3 +213,53 @@ enum artik_log_prefix os_log_get_prefix_fields(void)
 {
 	return _log_prefix_fields;
 }
+
+artik_error os_log_set_level(enum artik_log_level level)
+{
+	if ((unsigned int)level > LOG_LEVEL_DEBUG)
+		return E_BAD_ARGS;
+
+	_log_level = level;
+
+	return S_OK;
+}
+
+artik_error os_log_set_module_level(const char *module, int level)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_log_set_async(bool enable)
+{
+	return enable ? E_NOT_SUPPORTED : S_OK;
+}
+
+artik_error os_log_flush(void)
+{
+	fflush(stderr);
+
+	return S_OK;
+}
+
+artik_error os_log_get_stats(artik_log_stats *stats)
+{
+	if (!stats)
+		return E_BAD_ARGS;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->logged = _log_stat_logged;
+
+	return S_OK;
+}
+
+artik_error os_log_set_binary_handler(artik_log_binary_handler handler,
+		void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_log_decode_binary(const void *data, size_t len,
+		artik_log_handler handler, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
@@ -40,6 +40,12 @@ static artik_error	remove_signal_watch(int signal_id);
 static artik_error	add_idle_callback(int *idle_id, idle_callback func,
 							void *user_data);
 static artik_error	remove_idle_callback(int idle_id);
+static artik_error	enable_stats(bool enable, unsigned int budget_usec);
+static artik_error	get_stats(artik_loop_stats *stats);
+static artik_error	get_callback_stats(artik_loop_callback_stats *stats,
+						int *num);
+static void		dump_stats(void);
+static void		reset_stats(void);
 
 EXPORT_API const artik_loop_module loop_module = {
 	loop_run,
@@ -53,7 +59,12 @@ EXPORT_API const artik_loop_module loop_module = {
 	add_signal_watch,
 	remove_signal_watch,
 	add_idle_callback,
-	remove_idle_callback
+	remove_idle_callback,
+	enable_stats,
+	get_stats,
+	get_callback_stats,
+	dump_stats,
+	reset_stats
 };
 
 void loop_run(void)
@@ -117,3 +128,28 @@ artik_error remove_idle_callback(int idle_id)
 {
 	return os_remove_idle_callback(idle_id);
 }
+
+artik_error enable_stats(bool enable, unsigned int budget_usec)
+{
+	return os_loop_enable_stats(enable, budget_usec);
+}
+
+artik_error get_stats(artik_loop_stats *stats)
+{
+	return os_loop_get_stats(stats);
+}
+
+artik_error get_callback_stats(artik_loop_callback_stats *stats, int *num)
+{
+	return os_loop_get_callback_stats(stats, num);
+}
+
+void dump_stats(void)
+{
+	os_loop_dump_stats();
+}
+
+void reset_stats(void)
+{
+	os_loop_reset_stats();
+}
@@ -94,3 +94,24 @@ artik_error artik::Loop::add_idle_callback(int *idle_id, idle_callback func,
 artik_error artik::Loop::remove_idle_callback(int idle_id) {
   return this->m_module->remove_idle_callback(idle_id);
 }
+
+artik_error artik::Loop::enable_stats(bool enable, unsigned int budget_usec) {
+  return this->m_module->enable_stats(enable, budget_usec);
+}
+
+artik_error artik::Loop::get_stats(artik_loop_stats *stats) {
+  return this->m_module->get_stats(stats);
+}
+
+artik_error artik::Loop::get_callback_stats(artik_loop_callback_stats *stats,
+    int *num) {
+  return this->m_module->get_callback_stats(stats, num);
+}
+
+void artik::Loop::dump_stats(void) {
+  this->m_module->dump_stats();
+}
+
+void artik::Loop::reset_stats(void) {
+  this->m_module->reset_stats();
+}
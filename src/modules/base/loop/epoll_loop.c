@@ -0,0 +1,753 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
+
+#include <artik_log.h>
+#include <artik_loop.h>
+
+#include "os_loop.h"
+#include "loop_stats.h"
+
+/*
+ * Loop backend built directly on epoll. Timers are backed by one timerfd
+ * each, signals by a signalfd and cross-thread wake ups by an eventfd.
+ * Sources are stored in a slot table so that IDs are resolved in constant
+ * time, the ID encoding the slot index and a generation counter to avoid
+ * removing a newer source through a stale ID.
+ */
+
+#define MAX_EVENTS		64
+#define SLOT_BITS		20
+#define SLOT_MASK		((1 << SLOT_BITS) - 1)
+#define GENERATION_MASK		0x3FF
+#define INITIAL_SLOTS		64
+
+struct _source {
+	enum loop_source_type type;
+	int id;
+	int fd;
+	/* fd registered in epoll, may be a duplicate of fd */
+	int poll_fd;
+	union {
+		timeout_callback timeout;
+		periodic_callback periodic;
+		watch_callback watch;
+		signal_callback signal;
+		idle_callback idle;
+	} func;
+	void *user_data;
+	unsigned int msec;
+	int signum;
+	uint64_t deadline;
+	struct _source *next_idle;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static int epoll_fd = -1;
+static int wakeup_fd = -1;
+static bool quit_requested;
+
+static struct _source **slots;
+static unsigned int num_slots;
+static unsigned int next_free_slot;
+static unsigned int generation;
+static struct _source *idle_sources;
+
+/* Signal watches per signal and whether it was blocked before the first */
+static unsigned int signal_watches[NSIG];
+static bool signal_was_blocked[NSIG];
+
+static void _loop_create(void)
+{
+	struct epoll_event ev;
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		log_err("failed to create epoll instance (%d)", errno);
+		return;
+	}
+
+	wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wakeup_fd < 0) {
+		log_err("failed to create wakeup eventfd (%d)", errno);
+		close(epoll_fd);
+		epoll_fd = -1;
+		return;
+	}
+
+	/* ID 0 is never given to a source and identifies the wakeup fd */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev) < 0) {
+		log_err("failed to watch wakeup eventfd (%d)", errno);
+		close(wakeup_fd);
+		close(epoll_fd);
+		wakeup_fd = epoll_fd = -1;
+	}
+}
+
+static artik_error _loop_init(void)
+{
+	pthread_once(&init_once, _loop_create);
+
+	return (epoll_fd >= 0) ? S_OK : E_NOT_INITIALIZED;
+}
+
+static void _loop_wakeup(void)
+{
+	uint64_t one = 1;
+
+	if (wakeup_fd >= 0)
+		if (write(wakeup_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+			log_err("failed to wake up the loop (%d)", errno);
+}
+
+static struct _source *_source_lookup(int id)
+{
+	unsigned int slot;
+
+	if (id <= 0)
+		return NULL;
+
+	slot = ((unsigned int)id & SLOT_MASK) - 1;
+	if ((slot >= num_slots) || !slots[slot] || (slots[slot]->id != id))
+		return NULL;
+
+	return slots[slot];
+}
+
+/* Must be called with the lock held */
+static struct _source *_source_new(enum loop_source_type type)
+{
+	struct _source *source;
+	unsigned int slot;
+
+	for (slot = next_free_slot; slot < num_slots; slot++)
+		if (!slots[slot])
+			break;
+
+	if (slot == num_slots) {
+		unsigned int new_num = num_slots ? num_slots * 2 :
+								INITIAL_SLOTS;
+		struct _source **new_slots;
+
+		if (new_num > SLOT_MASK)
+			return NULL;
+
+		new_slots = realloc(slots, new_num * sizeof(*slots));
+		if (!new_slots)
+			return NULL;
+
+		memset(new_slots + num_slots, 0,
+			(new_num - num_slots) * sizeof(*slots));
+		slots = new_slots;
+		num_slots = new_num;
+	}
+
+	source = calloc(1, sizeof(*source));
+	if (!source)
+		return NULL;
+
+	generation = (generation + 1) & GENERATION_MASK;
+	source->type = type;
+	source->id = (int)((generation << SLOT_BITS) | (slot + 1));
+	source->fd = -1;
+	source->poll_fd = -1;
+	slots[slot] = source;
+	next_free_slot = slot + 1;
+
+	return source;
+}
+
+/*
+ * signalfd only receives blocked signals. Must be called with the lock
+ * held, the mask is the one of the calling thread.
+ */
+static void _signal_block(int signum)
+{
+	sigset_t mask, old;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, signum);
+	pthread_sigmask(SIG_BLOCK, &mask, &old);
+
+	if (!signal_watches[signum]++)
+		signal_was_blocked[signum] = sigismember(&old, signum);
+}
+
+/* Restore the mask once the last watch of the signal is gone */
+static void _signal_unblock(int signum)
+{
+	sigset_t mask;
+
+	if (!signal_watches[signum] || --signal_watches[signum] ||
+			signal_was_blocked[signum])
+		return;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, signum);
+	pthread_sigmask(SIG_UNBLOCK, &mask, NULL);
+}
+
+/* Must be called with the lock held */
+static void _source_free(struct _source *source)
+{
+	unsigned int slot = ((unsigned int)source->id & SLOT_MASK) - 1;
+
+	if (source->poll_fd >= 0) {
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, source->poll_fd, NULL);
+		if (source->poll_fd != source->fd)
+			close(source->poll_fd);
+	}
+
+	switch (source->type) {
+	case LOOP_SOURCE_SIGNAL:
+		_signal_unblock(source->signum);
+		/* Fall through */
+	case LOOP_SOURCE_TIMEOUT:
+	case LOOP_SOURCE_PERIODIC:
+		/* The backend owns timerfd and signalfd descriptors */
+		if (source->fd >= 0)
+			close(source->fd);
+		break;
+	case LOOP_SOURCE_IDLE: {
+		struct _source **iter = &idle_sources;
+
+		while (*iter && (*iter != source))
+			iter = &(*iter)->next_idle;
+		if (*iter)
+			*iter = source->next_idle;
+		break;
+	}
+	default:
+		break;
+	}
+
+	slots[slot] = NULL;
+	if (slot < next_free_slot)
+		next_free_slot = slot;
+
+	memset(source, 0, sizeof(*source));
+	free(source);
+}
+
+static artik_error _source_remove(int id, enum loop_source_type type)
+{
+	struct _source *source;
+
+	pthread_mutex_lock(&lock);
+	source = _source_lookup(id);
+	if (!source || (source->type != type)) {
+		pthread_mutex_unlock(&lock);
+		return E_BAD_ARGS;
+	}
+	_source_free(source);
+	pthread_mutex_unlock(&lock);
+
+	return S_OK;
+}
+
+/* Must be called with the lock held */
+static artik_error _source_poll(struct _source *source, int fd,
+				uint32_t events)
+{
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.u64 = (uint64_t)(unsigned int)source->id;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+		source->poll_fd = fd;
+		return S_OK;
+	}
+
+	if (errno != EEXIST)
+		return E_BAD_ARGS;
+
+	/*
+	 * epoll accepts a file description only once per fd number, use a
+	 * duplicate to support several watches on the same descriptor.
+	 */
+	fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (fd < 0)
+		return E_BAD_ARGS;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		close(fd);
+		return E_BAD_ARGS;
+	}
+
+	source->poll_fd = fd;
+
+	return S_OK;
+}
+
+static artik_error _timer_add(enum loop_source_type type, int *id,
+				unsigned int msec, timeout_callback timeout,
+				periodic_callback periodic, void *user_data)
+{
+	struct _source *source;
+	struct itimerspec spec;
+	artik_error ret;
+	int fd;
+
+	ret = _loop_init();
+	if (ret != S_OK)
+		return ret;
+
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd < 0)
+		return E_NO_MEM;
+
+	memset(&spec, 0, sizeof(spec));
+	/* A zero it_value would disarm the timer */
+	spec.it_value.tv_sec = msec / 1000;
+	spec.it_value.tv_nsec = msec ? (msec % 1000) * 1000000L : 1;
+	if (type == LOOP_SOURCE_PERIODIC)
+		spec.it_interval = spec.it_value;
+
+	pthread_mutex_lock(&lock);
+	source = _source_new(type);
+	if (!source) {
+		pthread_mutex_unlock(&lock);
+		close(fd);
+		return E_NO_MEM;
+	}
+
+	source->fd = fd;
+	source->msec = msec;
+	if (type == LOOP_SOURCE_TIMEOUT)
+		source->func.timeout = timeout;
+	else
+		source->func.periodic = periodic;
+	source->user_data = user_data;
+	source->deadline = loop_stats_now() + (uint64_t)msec * 1000;
+
+	if ((timerfd_settime(fd, 0, &spec, NULL) < 0) ||
+			(_source_poll(source, fd, EPOLLIN) != S_OK)) {
+		_source_free(source);
+		pthread_mutex_unlock(&lock);
+		return E_BAD_ARGS;
+	}
+
+	*id = source->id;
+	pthread_mutex_unlock(&lock);
+
+	return S_OK;
+}
+
+artik_error os_add_timeout_callback(int *timeout_id, unsigned int msec,
+				    timeout_callback func, void *user_data)
+{
+	if (!func || !timeout_id)
+		return E_BAD_ARGS;
+
+	return _timer_add(LOOP_SOURCE_TIMEOUT, timeout_id, msec, func, NULL,
+			  user_data);
+}
+
+artik_error os_remove_timeout_callback(int timeout_id)
+{
+	return _source_remove(timeout_id, LOOP_SOURCE_TIMEOUT);
+}
+
+artik_error os_add_periodic_callback(int *periodic_id, unsigned int msec,
+		periodic_callback func, void *user_data)
+{
+	if (!func || !periodic_id)
+		return E_BAD_ARGS;
+
+	return _timer_add(LOOP_SOURCE_PERIODIC, periodic_id, msec, NULL, func,
+			  user_data);
+}
+
+artik_error os_remove_periodic_callback(int periodic_id)
+{
+	return _source_remove(periodic_id, LOOP_SOURCE_PERIODIC);
+}
+
+artik_error os_add_fd_watch(int fd, enum watch_io io, watch_callback func,
+						void *user_data, int *watch_id)
+{
+	struct _source *source;
+	uint32_t events = 0;
+	artik_error ret;
+	int flags;
+
+	if (fd < 0) {
+		log_err("invalid fd(%d)", fd);
+		return E_BAD_ARGS;
+	}
+
+	if (!func) {
+		log_err("func is NULL");
+		return E_BAD_ARGS;
+	}
+
+	if (io == 0) {
+		log_err("invalid io(%d) type", io);
+		return E_BAD_ARGS;
+	}
+
+	ret = _loop_init();
+	if (ret != S_OK)
+		return ret;
+
+	if (io & WATCH_IO_IN)
+		events |= EPOLLIN;
+	if (io & WATCH_IO_OUT)
+		events |= EPOLLOUT;
+	if (io & WATCH_IO_PRI)
+		events |= EPOLLPRI;
+	/* EPOLLERR and EPOLLHUP are always reported */
+
+	/* Same behavior as the GLib backend */
+	flags = fcntl(fd, F_GETFL);
+	if ((flags >= 0) && !(flags & O_NONBLOCK))
+		fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+	pthread_mutex_lock(&lock);
+	source = _source_new(LOOP_SOURCE_WATCH);
+	if (!source) {
+		pthread_mutex_unlock(&lock);
+		return E_NO_MEM;
+	}
+
+	source->fd = fd;
+	source->func.watch = func;
+	source->user_data = user_data;
+
+	ret = _source_poll(source, fd, events);
+	if (ret != S_OK) {
+		log_err("failed to watch fd(%d)", fd);
+		_source_free(source);
+		pthread_mutex_unlock(&lock);
+		return ret;
+	}
+
+	if (watch_id)
+		*watch_id = source->id;
+	pthread_mutex_unlock(&lock);
+
+	return S_OK;
+}
+
+artik_error os_remove_fd_watch(int watch_id)
+{
+	if (_source_remove(watch_id, LOOP_SOURCE_WATCH) != S_OK) {
+		log_err("invalid watch_id(%d)", watch_id);
+		return -EINVAL;
+	}
+
+	return S_OK;
+}
+
+artik_error os_add_signal_watch(int signum, signal_callback func,
+		void *user_data, int *signal_id)
+{
+	struct _source *source;
+	artik_error ret;
+	sigset_t mask;
+	int fd;
+
+	if ((signum != SIGHUP) && (signum != SIGINT) && (signum != SIGTERM))
+		return E_BAD_ARGS;
+
+	if (!func)
+		return E_BAD_ARGS;
+
+	ret = _loop_init();
+	if (ret != S_OK)
+		return ret;
+
+	/*
+	 * Only the calling thread gets the signal blocked, threads created
+	 * before this call keep their own mask and may take the signal
+	 * instead of the loop.
+	 */
+	sigemptyset(&mask);
+	sigaddset(&mask, signum);
+
+	pthread_mutex_lock(&lock);
+	_signal_block(signum);
+
+	fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (fd < 0) {
+		_signal_unblock(signum);
+		pthread_mutex_unlock(&lock);
+		return E_NO_MEM;
+	}
+
+	source = _source_new(LOOP_SOURCE_SIGNAL);
+	if (!source) {
+		_signal_unblock(signum);
+		pthread_mutex_unlock(&lock);
+		close(fd);
+		return E_NO_MEM;
+	}
+
+	source->fd = fd;
+	source->signum = signum;
+	source->func.signal = func;
+	source->user_data = user_data;
+
+	if (_source_poll(source, fd, EPOLLIN) != S_OK) {
+		_source_free(source);
+		pthread_mutex_unlock(&lock);
+		return E_BAD_ARGS;
+	}
+
+	if (signal_id)
+		*signal_id = source->id;
+	pthread_mutex_unlock(&lock);
+
+	return S_OK;
+}
+
+artik_error os_remove_signal_watch(int signal_id)
+{
+	if (_source_remove(signal_id, LOOP_SOURCE_SIGNAL) != S_OK) {
+		log_err("invalid signal_id(%d)", signal_id);
+		return -EINVAL;
+	}
+
+	return S_OK;
+}
+
+artik_error os_add_idle_callback(int *idle_id, idle_callback func,
+				void *user_data)
+{
+	struct _source *source;
+	struct _source **tail;
+	artik_error ret;
+
+	if (!func)
+		return E_BAD_ARGS;
+
+	ret = _loop_init();
+	if (ret != S_OK)
+		return ret;
+
+	pthread_mutex_lock(&lock);
+	source = _source_new(LOOP_SOURCE_IDLE);
+	if (!source) {
+		pthread_mutex_unlock(&lock);
+		return E_NO_MEM;
+	}
+
+	source->func.idle = func;
+	source->user_data = user_data;
+
+	/* Idle callbacks run in registration order */
+	tail = &idle_sources;
+	while (*tail)
+		tail = &(*tail)->next_idle;
+	*tail = source;
+
+	if (idle_id)
+		*idle_id = source->id;
+	pthread_mutex_unlock(&lock);
+
+	/* Let a loop blocked in epoll_wait() pick up the idle source */
+	_loop_wakeup();
+
+	return S_OK;
+}
+
+artik_error os_remove_idle_callback(int idle_id)
+{
+	return _source_remove(idle_id, LOOP_SOURCE_IDLE);
+}
+
+static enum watch_io _events_to_io(uint32_t events)
+{
+	enum watch_io io = 0;
+
+	if (events & EPOLLIN)
+		io |= WATCH_IO_IN;
+	if (events & EPOLLOUT)
+		io |= WATCH_IO_OUT;
+	if (events & EPOLLPRI)
+		io |= WATCH_IO_PRI;
+	if (events & EPOLLERR)
+		io |= WATCH_IO_ERR;
+	if (events & EPOLLHUP)
+		io |= WATCH_IO_HUP;
+
+	return io;
+}
+
+/* Called with the lock held, returns with the lock held */
+static void _dispatch(int id, uint32_t events)
+{
+	struct _source *source = _source_lookup(id);
+	struct _source copy;
+	struct signalfd_siginfo siginfo;
+	uint64_t expirations;
+	uint64_t start = 0;
+	int ret = 0;
+
+	if (!source)
+		return;
+
+	/*
+	 * The callback may remove any source including this one, only use
+	 * a copy of the source while the lock is released.
+	 */
+	memcpy(&copy, source, sizeof(copy));
+
+	switch (copy.type) {
+	case LOOP_SOURCE_TIMEOUT:
+	case LOOP_SOURCE_PERIODIC:
+		if (read(copy.fd, &expirations, sizeof(expirations)) < 0)
+			return;
+		if (copy.type == LOOP_SOURCE_PERIODIC)
+			source->deadline += (uint64_t)copy.msec * 1000 *
+								expirations;
+		break;
+	case LOOP_SOURCE_SIGNAL:
+		if (read(copy.fd, &siginfo, sizeof(siginfo)) < 0)
+			return;
+		break;
+	default:
+		break;
+	}
+
+	pthread_mutex_unlock(&lock);
+
+	if (loop_stats_enabled())
+		start = loop_stats_now();
+
+	switch (copy.type) {
+	case LOOP_SOURCE_TIMEOUT:
+		copy.func.timeout(copy.user_data);
+		break;
+	case LOOP_SOURCE_PERIODIC:
+		ret = copy.func.periodic(copy.user_data);
+		break;
+	case LOOP_SOURCE_WATCH:
+		ret = copy.func.watch(copy.fd, _events_to_io(events),
+					copy.user_data);
+		break;
+	case LOOP_SOURCE_SIGNAL:
+		ret = copy.func.signal(copy.user_data);
+		break;
+	case LOOP_SOURCE_IDLE:
+		ret = copy.func.idle(copy.user_data);
+		break;
+	}
+
+	if (start)
+		loop_stats_record(copy.type, (loop_callback)copy.func.timeout,
+				  start, (copy.type == LOOP_SOURCE_TIMEOUT ||
+				  copy.type == LOOP_SOURCE_PERIODIC) ?
+				  copy.deadline : 0);
+
+	pthread_mutex_lock(&lock);
+
+	/* Remove one-shot sources and sources whose callback returned 0 */
+	if (ret != 1) {
+		source = _source_lookup(id);
+		if (source)
+			_source_free(source);
+	}
+}
+
+static void _dispatch_idle(void)
+{
+	struct _source *source;
+	int ids[MAX_EVENTS];
+	int num = 0, i;
+
+	/* Only dispatch the idle sources present before this iteration */
+	for (source = idle_sources; source && (num < MAX_EVENTS);
+					source = source->next_idle)
+		ids[num++] = source->id;
+
+	for (i = 0; i < num; i++)
+		_dispatch(ids[i], 0);
+}
+
+void os_loop_run(void)
+{
+	struct epoll_event events[MAX_EVENTS];
+	uint64_t value;
+	int num, i;
+
+	if (_loop_init() != S_OK)
+		return;
+
+	pthread_mutex_lock(&lock);
+	quit_requested = false;
+
+	while (!quit_requested) {
+		int timeout = idle_sources ? 0 : -1;
+
+		pthread_mutex_unlock(&lock);
+		num = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+		pthread_mutex_lock(&lock);
+
+		if (num < 0) {
+			if (errno == EINTR)
+				continue;
+			log_err("epoll_wait failed (%d)", errno);
+			break;
+		}
+
+		for (i = 0; (i < num) && !quit_requested; i++) {
+			if (events[i].data.u64 == 0) {
+				if (read(wakeup_fd, &value, sizeof(value)) < 0)
+					value = 0;
+				continue;
+			}
+
+			_dispatch((int)events[i].data.u64, events[i].events);
+		}
+
+		/* Idle callbacks only run when nothing else is pending */
+		if ((num == 0) && !quit_requested)
+			_dispatch_idle();
+	}
+
+	pthread_mutex_unlock(&lock);
+}
+
+void os_loop_quit(void)
+{
+	pthread_mutex_lock(&lock);
+	quit_requested = true;
+	pthread_mutex_unlock(&lock);
+
+	_loop_wakeup();
+}
@@ -26,17 +26,21 @@
 #include <artik_loop.h>
 
 #include "os_loop.h"
+#include "loop_stats.h"
 
 struct _timeout {
 	timeout_callback func;
 	void *user_data;
 	guint id;
+	uint64_t deadline;
 };
 
 struct _periodic {
 	periodic_callback func;
 	void *user_data;
 	guint id;
+	unsigned int msec;
+	uint64_t deadline;
 };
 
 struct _idle {
@@ -62,8 +66,18 @@ static GMainLoop *mainloop;
 static gboolean _timeout_callback(gpointer user_data)
 {
 	struct _timeout *timeout = user_data;
+	uint64_t start;
 
+	if (!loop_stats_enabled()) {
+		timeout->func(timeout->user_data);
+		return FALSE;
+	}
+
+	start = loop_stats_now();
 	timeout->func(timeout->user_data);
+	loop_stats_record(LOOP_SOURCE_TIMEOUT,
+			  (loop_callback)timeout->func, start,
+			  timeout->deadline);
 
 	return FALSE;
 }
@@ -91,6 +105,7 @@ artik_error os_add_timeout_callback(int *timeout_id, unsigned int msec,
 
 	timeout->func = func;
 	timeout->user_data = user_data;
+	timeout->deadline = loop_stats_now() + (uint64_t)msec * 1000;
 
 	source = g_timeout_source_new(msec);
 	g_source_set_priority(source, G_PRIORITY_HIGH);
@@ -122,9 +137,29 @@ artik_error os_remove_timeout_callback(int timeout_id)
 static gboolean _periodic_callback(gpointer user_data)
 {
 	struct _periodic *periodic = user_data;
+	periodic_callback func = periodic->func;
+	uint64_t start;
 	int ret;
 
-	ret = periodic->func(periodic->user_data);
+	if (!loop_stats_enabled()) {
+		/*
+		 * Keep the deadline current in case statistics get enabled
+		 * later. The source time is the monotonic time cached by the
+		 * loop for this iteration, reading it costs no system call.
+		 */
+		periodic->deadline = g_source_get_time(
+				g_main_current_source()) +
+				(uint64_t)periodic->msec * 1000;
+		ret = func(periodic->user_data);
+		return (ret == 1) ? TRUE : FALSE;
+	}
+
+	start = loop_stats_now();
+	ret = func(periodic->user_data);
+	loop_stats_record(LOOP_SOURCE_PERIODIC, (loop_callback)func, start,
+			  periodic->deadline);
+	periodic->deadline = start + (uint64_t)periodic->msec * 1000;
+
 	if (ret == 1)
 		return TRUE;
 
@@ -154,6 +189,8 @@ artik_error os_add_periodic_callback(int *periodic_id, unsigned int msec,
 
 	periodic->func = func;
 	periodic->user_data = user_data;
+	periodic->msec = msec;
+	periodic->deadline = loop_stats_now() + (uint64_t)msec * 1000;
 
 	source = g_timeout_source_new(msec);
 	g_source_set_priority(source, G_PRIORITY_HIGH);
@@ -201,6 +238,8 @@ static gboolean _gio_callback(GIOChannel *channel, GIOCondition cond,
 			      gpointer user_data)
 {
 	struct _watch *watch = user_data;
+	watch_callback func = watch->func;
+	uint64_t start = 0;
 	int fd;
 	int ret;
 	enum watch_io io = 0;
@@ -220,7 +259,15 @@ static gboolean _gio_callback(GIOChannel *channel, GIOCondition cond,
 
 	fd = g_io_channel_unix_get_fd(channel);
 
-	ret = watch->func(fd, io, watch->user_data);
+	if (loop_stats_enabled())
+		start = loop_stats_now();
+
+	ret = func(fd, io, watch->user_data);
+
+	if (start)
+		loop_stats_record(LOOP_SOURCE_WATCH, (loop_callback)func,
+				  start, 0);
+
 	if (ret == 1)
 		return TRUE;
 
@@ -230,9 +277,19 @@ static gboolean _gio_callback(GIOChannel *channel, GIOCondition cond,
 static gboolean _gsignal_callback(gpointer user_data)
 {
 	struct _signal *signal = user_data;
+	signal_callback func = signal->func;
+	uint64_t start = 0;
 	int ret;
 
-	ret = signal->func(signal->user_data);
+	if (loop_stats_enabled())
+		start = loop_stats_now();
+
+	ret = func(signal->user_data);
+
+	if (start)
+		loop_stats_record(LOOP_SOURCE_SIGNAL, (loop_callback)func,
+				  start, 0);
+
 	if (ret == 1)
 		return TRUE;
 
@@ -373,9 +430,19 @@ artik_error os_remove_signal_watch(int signal_id)
 static gboolean _idle_callback(gpointer user_data)
 {
 	struct _idle *idle = user_data;
+	idle_callback func = idle->func;
+	uint64_t start = 0;
 	int ret;
 
-	ret = idle->func(idle->user_data);
+	if (loop_stats_enabled())
+		start = loop_stats_now();
+
+	ret = func(idle->user_data);
+
+	if (start)
+		loop_stats_record(LOOP_SOURCE_IDLE, (loop_callback)func,
+				  start, 0);
+
 	if (ret == 1)
 		return TRUE;
 
@@ -0,0 +1,310 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <dlfcn.h>
+
+#include <artik_log.h>
+#include <artik_loop.h>
+
+#include "os_loop.h"
+#include "loop_stats.h"
+
+/* Must be a power of 2 */
+#define MAX_CALLBACKS		256
+#define MAX_SYMBOL_NAME		64
+
+struct _callback_entry {
+	artik_loop_callback_stats stats;
+	bool used;
+};
+
+static const char * const source_type_name[] = {
+	"timeout",
+	"periodic",
+	"watch",
+	"signal",
+	"idle"
+};
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool stats_enabled;
+static bool stats_override_checked;
+static unsigned int stats_budget_usec;
+static artik_loop_stats global_stats;
+static struct _callback_entry callbacks[MAX_CALLBACKS];
+
+static void _stats_check_override(void)
+{
+	const char *env;
+
+	if (stats_override_checked)
+		return;
+
+	stats_override_checked = true;
+
+	env = getenv("ARTIK_LOOP_STATS");
+	if (!env)
+		return;
+
+	stats_budget_usec = (unsigned int)strtoul(env, NULL, 10);
+	stats_enabled = true;
+}
+
+bool loop_stats_enabled(void)
+{
+	if (!stats_override_checked)
+		_stats_check_override();
+
+	return stats_enabled;
+}
+
+uint64_t loop_stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static unsigned int _histogram_bucket(uint64_t usec)
+{
+	unsigned int bucket;
+
+	if (usec == 0)
+		return 0;
+
+	bucket = 64 - __builtin_clzll(usec);
+
+	return (bucket < ARTIK_LOOP_HISTOGRAM_BUCKETS) ? bucket :
+					ARTIK_LOOP_HISTOGRAM_BUCKETS - 1;
+}
+
+static struct _callback_entry *_lookup_callback(loop_callback func)
+{
+	unsigned int hash = (unsigned int)((uintptr_t)func >> 2) * 2654435761U;
+	unsigned int i;
+
+	for (i = 0; i < MAX_CALLBACKS; i++) {
+		struct _callback_entry *entry =
+			&callbacks[(hash + i) & (MAX_CALLBACKS - 1)];
+
+		if (!entry->used) {
+			entry->used = true;
+			entry->stats.func = func;
+			global_stats.num_callbacks++;
+			return entry;
+		}
+
+		if (entry->stats.func == func)
+			return entry;
+	}
+
+	/* Table is full, only account in the global statistics */
+	return NULL;
+}
+
+static void _callback_name(loop_callback func, char *name, size_t len)
+{
+	union {
+		loop_callback func;
+		void *addr;
+	} symbol = { .func = func };
+	Dl_info info;
+
+	if (dladdr(symbol.addr, &info) && info.dli_sname)
+		snprintf(name, len, "%s", info.dli_sname);
+	else
+		snprintf(name, len, "%p", symbol.addr);
+}
+
+void loop_stats_record(enum loop_source_type type, loop_callback func,
+			uint64_t start, uint64_t deadline)
+{
+	struct _callback_entry *entry;
+	uint64_t elapsed = loop_stats_now() - start;
+	uint64_t lag = 0;
+	bool over_budget;
+
+	if (deadline && (start > deadline))
+		lag = start - deadline;
+
+	over_budget = stats_budget_usec && (elapsed > stats_budget_usec);
+
+	pthread_mutex_lock(&stats_lock);
+
+	global_stats.dispatch_count++;
+	global_stats.total_usec += elapsed;
+	if (elapsed > global_stats.max_usec)
+		global_stats.max_usec = elapsed;
+	global_stats.histogram[_histogram_bucket(elapsed)]++;
+
+	if (deadline) {
+		global_stats.lag_count++;
+		global_stats.total_lag_usec += lag;
+		if (lag > global_stats.max_lag_usec)
+			global_stats.max_lag_usec = lag;
+	}
+
+	if (over_budget)
+		global_stats.over_budget_count++;
+
+	entry = _lookup_callback(func);
+	if (entry) {
+		entry->stats.type = type;
+		entry->stats.dispatch_count++;
+		entry->stats.total_usec += elapsed;
+		if (elapsed > entry->stats.max_usec)
+			entry->stats.max_usec = elapsed;
+		if (lag > entry->stats.max_lag_usec)
+			entry->stats.max_lag_usec = lag;
+		if (over_budget)
+			entry->stats.over_budget_count++;
+	}
+
+	pthread_mutex_unlock(&stats_lock);
+
+	if (over_budget) {
+		char name[MAX_SYMBOL_NAME];
+
+		_callback_name(func, name, sizeof(name));
+		artik_log(LOG_LEVEL_WARNING,
+			"%s callback %s ran for %llu usec (budget %u usec)",
+			source_type_name[type], name,
+			(unsigned long long)elapsed, stats_budget_usec);
+	}
+}
+
+artik_error os_loop_enable_stats(bool enable, unsigned int budget_usec)
+{
+	pthread_mutex_lock(&stats_lock);
+	_stats_check_override();
+	stats_enabled = enable;
+	stats_budget_usec = budget_usec;
+	pthread_mutex_unlock(&stats_lock);
+
+	return S_OK;
+}
+
+artik_error os_loop_get_stats(artik_loop_stats *stats)
+{
+	if (!stats)
+		return E_BAD_ARGS;
+
+	pthread_mutex_lock(&stats_lock);
+	memcpy(stats, &global_stats, sizeof(*stats));
+	pthread_mutex_unlock(&stats_lock);
+
+	return S_OK;
+}
+
+artik_error os_loop_get_callback_stats(artik_loop_callback_stats *stats,
+					int *num)
+{
+	int i, count = 0;
+
+	if (!stats || !num || (*num <= 0))
+		return E_BAD_ARGS;
+
+	pthread_mutex_lock(&stats_lock);
+	for (i = 0; (i < MAX_CALLBACKS) && (count < *num); i++) {
+		if (!callbacks[i].used)
+			continue;
+
+		memcpy(&stats[count++], &callbacks[i].stats, sizeof(*stats));
+	}
+	pthread_mutex_unlock(&stats_lock);
+
+	*num = count;
+
+	return S_OK;
+}
+
+void os_loop_dump_stats(void)
+{
+	char name[MAX_SYMBOL_NAME];
+	unsigned long long avg_lag = 0;
+	int i;
+
+	pthread_mutex_lock(&stats_lock);
+
+	if (global_stats.lag_count)
+		avg_lag = global_stats.total_lag_usec / global_stats.lag_count;
+
+	artik_log(LOG_LEVEL_INFO,
+		"loop: %llu dispatches, %llu usec total, %llu usec max, lag avg %llu usec max %llu usec, %llu over budget",
+		(unsigned long long)global_stats.dispatch_count,
+		(unsigned long long)global_stats.total_usec,
+		(unsigned long long)global_stats.max_usec, avg_lag,
+		(unsigned long long)global_stats.max_lag_usec,
+		(unsigned long long)global_stats.over_budget_count);
+
+	for (i = 0; i < MAX_CALLBACKS; i++) {
+		artik_loop_callback_stats *stats = &callbacks[i].stats;
+
+		if (!callbacks[i].used || !stats->dispatch_count)
+			continue;
+
+		_callback_name(stats->func, name, sizeof(name));
+		artik_log(LOG_LEVEL_INFO,
+			"  %-8s %-32s count %llu total %llu usec avg %llu usec max %llu usec lag %llu usec over %llu",
+			source_type_name[stats->type], name,
+			(unsigned long long)stats->dispatch_count,
+			(unsigned long long)stats->total_usec,
+			(unsigned long long)(stats->total_usec /
+						stats->dispatch_count),
+			(unsigned long long)stats->max_usec,
+			(unsigned long long)stats->max_lag_usec,
+			(unsigned long long)stats->over_budget_count);
+	}
+
+	for (i = 0; i < ARTIK_LOOP_HISTOGRAM_BUCKETS; i++) {
+		if (!global_stats.histogram[i])
+			continue;
+
+		if (i == 0)
+			artik_log(LOG_LEVEL_INFO, "  < 1 usec: %llu",
+				(unsigned long long)global_stats.histogram[i]);
+		else if (i == ARTIK_LOOP_HISTOGRAM_BUCKETS - 1)
+			artik_log(LOG_LEVEL_INFO, "  >= %llu usec: %llu",
+				1ULL << (i - 1),
+				(unsigned long long)global_stats.histogram[i]);
+		else
+			artik_log(LOG_LEVEL_INFO, "  %llu-%llu usec: %llu",
+				1ULL << (i - 1), (1ULL << i) - 1,
+				(unsigned long long)global_stats.histogram[i]);
+	}
+
+	pthread_mutex_unlock(&stats_lock);
+}
+
+void os_loop_reset_stats(void)
+{
+	pthread_mutex_lock(&stats_lock);
+	memset(&global_stats, 0, sizeof(global_stats));
+	memset(callbacks, 0, sizeof(callbacks));
+	pthread_mutex_unlock(&stats_lock);
+}
@@ -0,0 +1,40 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef _LOOP_STATS_H_
+#define _LOOP_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <artik_loop.h>
+
+/*
+ * Dispatch instrumentation shared by the loop backends.
+ *
+ * Backends call loop_stats_now() before invoking a user callback when
+ * loop_stats_enabled() returns true, then loop_stats_record() once the
+ * callback returned. The deadline is the monotonic time (in usec) at which
+ * a timer was expected to fire, or 0 for sources without a deadline.
+ */
+bool loop_stats_enabled(void);
+uint64_t loop_stats_now(void);
+void loop_stats_record(enum loop_source_type type, loop_callback func,
+			uint64_t start, uint64_t deadline);
+
+#endif /* _LOOP_STATS_H_ */
@@ -38,5 +38,11 @@ artik_error os_remove_signal_watch(int signal_id);
 artik_error os_add_idle_callback(int *idle_id, idle_callback func,
 				void *user_data);
 artik_error os_remove_idle_callback(int idle_id);
+artik_error os_loop_enable_stats(bool enable, unsigned int budget_usec);
+artik_error os_loop_get_stats(artik_loop_stats *stats);
+artik_error os_loop_get_callback_stats(artik_loop_callback_stats *stats,
+					int *num);
+void os_loop_dump_stats(void);
+void os_loop_reset_stats(void);
 
 #endif /* _OS_LOOP_H_ */
@@ -579,3 +579,27 @@ artik_error os_remove_idle_callback(int idle_id)
 
 	return S_OK;
 }
+
+artik_error os_loop_enable_stats(bool enable, unsigned int budget_usec)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_loop_get_stats(artik_loop_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_loop_get_callback_stats(artik_loop_callback_stats *stats,
+					int *num)
+{
+	return E_NOT_SUPPORTED;
+}
+
+void os_loop_dump_stats(void)
+{
+}
+
+void os_loop_reset_stats(void)
+{
+}
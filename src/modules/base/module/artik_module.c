@@ -34,6 +34,12 @@ EXPORT_API artik_error artik_release_api_module(const artik_module_ops module)
 	return os_release_api_module(module);
 }
 
+EXPORT_API artik_error artik_preload_modules(const char * const *names,
+			int num, int num_threads, artik_module_load_info *info)
+{
+	return os_preload_modules(names, num, num_threads, info);
+}
+
 EXPORT_API int artik_get_platform(void)
 {
 	return os_get_platform();
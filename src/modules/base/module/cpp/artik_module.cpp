@@ -41,6 +41,11 @@ artik_error artik::Module::get_available_modules(
   return artik_get_available_modules(modules, num_modules);
 }
 
+artik_error artik::Module::preload_modules(const char * const *names,
+  int num, int num_threads, artik_module_load_info *info) {
+  return artik_preload_modules(names, num, num_threads, info);
+}
+
 bool artik::Module::is_module_available(artik_module_id_t id) {
   return artik_is_module_available(id);
 }
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <dlfcn.h>
 #include <pthread.h>
+#include <time.h>
 
 #include <artik_types.h>
 #include <artik_log.h>
@@ -29,20 +30,65 @@
 #include <artik_platform.h>
 
 #include "os_module.h"
+#include "../log/os_log.h"
 
 #define MAX_STR_LEN 1024
 #define PATH_STRING "libartik-sdk-%s.so.%d.%d.%d"
 #define MODULE_STRING "%s_module"
 
-static pthread_mutex_t lock;
-static bool lock_initialized = false;
+/*
+ * Both tables must be a power of 2 and larger than the biggest
+ * platform module table.
+ */
+#define MODULE_TABLE_SIZE	64
+#define SYMBOL_TABLE_SIZE	256
+#define MAX_PRELOAD_THREADS	16
+#define PRELOAD_SEPARATORS	", "
+
+/*
+ * One entry per module exposed by the platform. Entries are created once
+ * from the platform table and never removed, only the library handle and
+ * symbol come and go with the reference count. Once the reference count
+ * is non zero, dl_handle and dl_symbol are stable and can be read without
+ * holding the lock. Loading and unloading are serialized per module so
+ * that different modules can be loaded in parallel.
+ */
+typedef struct artik_module_entry_t {
+	const artik_api_module *api;
+	pthread_mutex_t lock;
+	void *dl_handle;
+	void *dl_symbol;
+	int refcount;
+	bool pinned;
+} artik_module_entry;
+
+typedef struct artik_preload_job_t {
+	const char * const *names;
+	int num;
+	int next;
+	artik_module_load_info *info;
+	artik_error ret;
+} artik_preload_job;
+
+/* Reverse index used by release to find a module from its ops pointer */
+typedef struct artik_symbol_entry_t {
+	void *dl_symbol;
+	artik_module_entry *module;
+} artik_symbol_entry;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t registry_once = PTHREAD_ONCE_INIT;
+
+/* Thread preloading the modules listed in ARTIK_PRELOAD_MODULES */
+static pthread_mutex_t preload_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t preload_thread;
+static bool preload_started;
+
+static artik_module_entry module_table[MODULE_TABLE_SIZE];
+static artik_symbol_entry symbol_table[SYMBOL_TABLE_SIZE];
 
 static void mutex_lock(void)
 {
-	if (!lock_initialized) {
-		pthread_mutex_init(&lock, NULL);
-		lock_initialized = true;
-	}
 	pthread_mutex_lock(&lock);
 }
 
@@ -51,19 +97,6 @@ static void mutex_unlock(void)
 	pthread_mutex_unlock(&lock);
 }
 
-static artik_list *requested_node = NULL;
-
-typedef struct artik_module_info_t {
-	char *module_name;
-	void *dl_handle;
-	void *dl_symbol;
-} artik_module_info;
-
-typedef struct artik_module_handle_t {
-	artik_list node;
-	artik_module_info info;
-} artik_module_node;
-
 static int artik_platform_id = -1;
 
 /*
@@ -95,162 +128,508 @@ artik_error os_get_api_version(artik_api_version *version)
 	return S_OK;
 }
 
-static void *artik_compare_module_name(void *node, void *target)
+static unsigned int artik_hash_name(const char *name)
+{
+	unsigned int hash = 2166136261U;
+	unsigned int i;
+
+	for (i = 0; (i < MAX_MODULE_NAME) && name[i]; i++) {
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static unsigned int artik_hash_symbol(const void *symbol)
+{
+	return (unsigned int)((uintptr_t)symbol >> 3) * 2654435761U;
+}
+
+static void artik_registry_init(void)
+{
+	int platid = os_get_platform();
+	unsigned int i, j;
+
+	if (platid < 0)
+		return;
+
+	for (i = 0; artik_api_modules[platid][i].object != NULL; i++) {
+		const artik_api_module *api = &artik_api_modules[platid][i];
+		unsigned int hash = artik_hash_name(api->name);
+
+		for (j = 0; j < MODULE_TABLE_SIZE; j++) {
+			artik_module_entry *entry = &module_table[(hash + j) &
+						(MODULE_TABLE_SIZE - 1)];
+
+			if (!entry->api) {
+				entry->api = api;
+				pthread_mutex_init(&entry->lock, NULL);
+				break;
+			}
+
+			/* Keep the first declaration of a duplicated name */
+			if (!strncmp(entry->api->name, api->name,
+							MAX_MODULE_NAME))
+				break;
+		}
+
+		if (j == MODULE_TABLE_SIZE)
+			log_err("module table is full, dropping %s", api->name);
+	}
+}
+
+/*
+ * The module table is immutable once initialized, lookups by name do not
+ * need any lock.
+ */
+static artik_module_entry *artik_lookup_name(const char *name)
 {
-	if (strncmp(((artik_module_node *)node)->info.module_name,
-				(char *)target, strlen((char *)target)) == 0) {
-		/* if the modules are same */
-		return node;
+	unsigned int hash = artik_hash_name(name);
+	unsigned int i;
+
+	for (i = 0; i < MODULE_TABLE_SIZE; i++) {
+		artik_module_entry *entry = &module_table[(hash + i) &
+						(MODULE_TABLE_SIZE - 1)];
+
+		if (!entry->api)
+			return NULL;
+
+		if (!strncmp(entry->api->name, name, MAX_MODULE_NAME))
+			return entry;
 	}
-	/* if not */
+
 	return NULL;
 }
 
-static void *artik_compare_module_ops(void *node, artik_module_ops target)
+/*
+ * Symbol slots are only ever added, under the lock. A module reloaded at
+ * a different address gets a new slot, stale slots are filtered out by
+ * checking the symbol currently held by the module entry. A module loaded
+ * at an address used before takes over the slot of the previous one.
+ */
+static void artik_insert_symbol(void *symbol, artik_module_entry *module)
+{
+	unsigned int hash = artik_hash_symbol(symbol);
+	unsigned int i;
+
+	for (i = 0; i < SYMBOL_TABLE_SIZE; i++) {
+		artik_symbol_entry *slot = &symbol_table[(hash + i) &
+						(SYMBOL_TABLE_SIZE - 1)];
+		void *current = __atomic_load_n(&slot->dl_symbol,
+							__ATOMIC_ACQUIRE);
+
+		if (current == symbol) {
+			__atomic_store_n(&slot->module, module,
+							__ATOMIC_RELEASE);
+			return;
+		}
+
+		if (!current) {
+			slot->module = module;
+			__atomic_store_n(&slot->dl_symbol, symbol,
+							__ATOMIC_RELEASE);
+			return;
+		}
+	}
+
+	/* Table full, release will fall back to a scan of the module table */
+}
+
+static artik_module_entry *artik_lookup_symbol(const void *symbol)
 {
-	if (memcmp(((artik_module_node *)node)->info.dl_symbol, target,
-							sizeof(void *)) == 0) {
-		/* if the modules are same */
-		return node;
+	unsigned int hash = artik_hash_symbol(symbol);
+	unsigned int i;
+
+	for (i = 0; i < SYMBOL_TABLE_SIZE; i++) {
+		artik_symbol_entry *slot = &symbol_table[(hash + i) &
+						(SYMBOL_TABLE_SIZE - 1)];
+		void *current = __atomic_load_n(&slot->dl_symbol,
+							__ATOMIC_ACQUIRE);
+
+		if (!current)
+			break;
+
+		if (current == symbol)
+			return __atomic_load_n(&slot->module,
+							__ATOMIC_ACQUIRE);
+	}
+
+	/* Slow path, only reached if the symbol table overflowed */
+	for (i = 0; i < MODULE_TABLE_SIZE; i++) {
+		if (module_table[i].api && (__atomic_load_n(
+				&module_table[i].dl_symbol,
+				__ATOMIC_ACQUIRE) == symbol))
+			return &module_table[i];
 	}
-	/* if not */
+
 	return NULL;
 }
 
-artik_module_ops os_request_api_module(const char *name)
+static uint64_t artik_now_usec(void)
 {
-	artik_list *node = NULL;
-	void *dl_handle = NULL;
-	void *dl_symbol = INVALID_MODULE;
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static artik_module_ops artik_load_module(artik_module_entry *entry)
+{
+#ifdef CONFIG_ARTIK_MONOLITHIC
+	int i;
+#else
 	char str_buf[MAX_STR_LEN] = {0, };
-	char *module_name = NULL;
 	char *error_msg;
-	unsigned int i = 0, len = 0;
-	int platid = os_get_platform();
+#endif
+	void *dl_handle = NULL;
+	void *dl_symbol = NULL;
 
-	if (!name || (platid < 0))
-		return INVALID_MODULE;
+	pthread_mutex_lock(&entry->lock);
 
-	while (artik_api_modules[platid][i].object != NULL) {
-		if (!strncmp(artik_api_modules[platid][i].name, name,
+	/* Another thread may have loaded the module while we waited */
+	if (entry->refcount > 0) {
+		__atomic_add_fetch(&entry->refcount, 1, __ATOMIC_ACQ_REL);
+		dl_symbol = entry->dl_symbol;
+		pthread_mutex_unlock(&entry->lock);
+		return (artik_module_ops)dl_symbol;
+	}
+
+#ifdef CONFIG_ARTIK_MONOLITHIC
+	for (i = 0; artik_static_modules[i].name; i++) {
+		if (!strncmp(artik_static_modules[i].name, entry->api->name,
 							MAX_MODULE_NAME)) {
+			dl_symbol = artik_static_modules[i].ops;
+			break;
+		}
+	}
 
-			mutex_lock();
-
-			node = artik_list_get_by_check(requested_node,
-				artik_compare_module_name, (void *)name);
-			if (node) {
-				module_name = ((artik_module_node *)
-							node)->info.module_name;
-				dl_symbol = ((artik_module_node *)
-							node)->info.dl_symbol;
-				dl_handle = ((artik_module_node *)
-							node)->info.dl_handle;
-			}
+	if (!dl_symbol) {
+		pthread_mutex_unlock(&entry->lock);
+		return INVALID_MODULE;
+	}
+#else
+	snprintf(str_buf, MAX_STR_LEN, PATH_STRING, entry->api->object,
+			LIB_VERSION_MAJOR, LIB_VERSION_MINOR,
+			LIB_VERSION_PATCH);
+	dl_handle = (void *)dlopen(str_buf, RTLD_NOW|RTLD_GLOBAL);
+	if (!dl_handle) {
+		pthread_mutex_unlock(&entry->lock);
+		return INVALID_MODULE;
+	}
 
-			node = artik_list_add(&requested_node, 0,
-						sizeof(artik_module_node));
-			if (node == NULL) {
-				mutex_unlock();
-				return INVALID_MODULE;
-			} else if (dl_handle) {
-				/* don't need to call DL again */
-				goto exit;
-			}
+	memset(str_buf, 0, sizeof(str_buf));
+	snprintf(str_buf, MAX_STR_LEN, MODULE_STRING, entry->api->name);
+	dlerror();
+	dl_symbol = dlsym(dl_handle, str_buf);
+	error_msg = dlerror();
+	if (error_msg != NULL) {
+		dlclose(dl_handle);
+		pthread_mutex_unlock(&entry->lock);
+		return INVALID_MODULE;
+	}
+#endif
 
-			memset(str_buf, 0, sizeof(str_buf));
-			snprintf(str_buf, MAX_STR_LEN, PATH_STRING,
-					artik_api_modules[platid][i].object,
-					LIB_VERSION_MAJOR,
-					LIB_VERSION_MINOR, LIB_VERSION_PATCH);
-			dl_handle = (void *)dlopen(str_buf, RTLD_NOW|RTLD_GLOBAL);
-			if (!dl_handle) {
-				mutex_unlock();
-				return INVALID_MODULE;
-			}
+	entry->dl_handle = dl_handle;
+	__atomic_store_n(&entry->dl_symbol, dl_symbol, __ATOMIC_RELEASE);
 
-			memset(str_buf, 0, sizeof(str_buf));
-			snprintf(str_buf, MAX_STR_LEN, MODULE_STRING, name);
-			dlerror();
-			dl_symbol = dlsym(dl_handle, str_buf);
-			error_msg = dlerror();
-			if (error_msg != NULL) {
-				dlclose(dl_handle);
-				mutex_unlock();
-				return INVALID_MODULE;
-			}
+	mutex_lock();
+	artik_insert_symbol(dl_symbol, entry);
+	mutex_unlock();
 
-exit:
-			if (module_name == NULL) {
-				len = strlen(name) + 1;
-				module_name = malloc(len);
-				if (module_name == NULL) {
-					dlclose(dl_handle);
-					mutex_unlock();
-					return INVALID_MODULE;
-				}
-				memset(module_name, 0, len);
-				strncpy(module_name, name, len);
-			}
+	/* Publish the module to the lock-free path */
+	__atomic_store_n(&entry->refcount, 1, __ATOMIC_RELEASE);
+
+	pthread_mutex_unlock(&entry->lock);
 
-			((artik_module_node *)node)->info.module_name =
-								module_name;
-			((artik_module_node *)node)->info.dl_handle = dl_handle;
-			((artik_module_node *)node)->info.dl_symbol = dl_symbol;
+	return (artik_module_ops)dl_symbol;
+}
 
-			mutex_unlock();
+artik_module_ops os_request_api_module(const char *name)
+{
+	artik_module_entry *entry = NULL;
+	int count;
 
-			break;
-		}
-		i++;
+	if (!name)
+		return INVALID_MODULE;
+
+	pthread_once(&registry_once, artik_registry_init);
+
+	entry = artik_lookup_name(name);
+	if (!entry)
+		return INVALID_MODULE;
+
+	/* Fast path: take a reference on an already loaded module */
+	count = __atomic_load_n(&entry->refcount, __ATOMIC_ACQUIRE);
+	while (count > 0) {
+		if (__atomic_compare_exchange_n(&entry->refcount, &count,
+				count + 1, true, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE))
+			return (artik_module_ops)entry->dl_symbol;
 	}
 
-	return (artik_module_ops)dl_symbol;
+	return artik_load_module(entry);
 }
 
 artik_error os_release_api_module(const artik_module_ops module)
 {
-	artik_list *node = NULL;
+	artik_module_entry *entry = NULL;
 	artik_error ret = S_OK;
-	void *dl_handle = NULL;
-	char *module_name = NULL;
+	int count;
 
-	if (!module)
+	if (!module || (module == INVALID_MODULE))
 		return E_BAD_ARGS;
 
-	mutex_lock();
+	pthread_once(&registry_once, artik_registry_init);
 
-	node = artik_list_get_by_check(requested_node, artik_compare_module_ops,
-									module);
-	if (node == NULL) {
+	entry = artik_lookup_symbol(module);
+	if (!entry || (__atomic_load_n(&entry->dl_symbol,
+					__ATOMIC_ACQUIRE) != module)) {
 		log_err("releasing invalid module");
-		ret = E_BAD_ARGS;
-		goto exit;
+		return E_BAD_ARGS;
+	}
+
+	/* Fast path: drop a reference that is not the last one */
+	count = __atomic_load_n(&entry->refcount, __ATOMIC_ACQUIRE);
+	while (count > 1) {
+		if (__atomic_compare_exchange_n(&entry->refcount, &count,
+				count - 1, true, __ATOMIC_RELEASE,
+				__ATOMIC_ACQUIRE))
+			return S_OK;
 	}
 
-	dl_handle = ((artik_module_node *)node)->info.dl_handle;
-	module_name = ((artik_module_node *)node)->info.module_name;
+	pthread_mutex_lock(&entry->lock);
 
-	ret = artik_list_delete_check(&requested_node, artik_compare_module_ops,
-									module);
-	if (ret != S_OK) {
-		log_err("failed to delete module");
+	if ((entry->refcount == 0) || (entry->dl_symbol != module)) {
+		log_err("releasing invalid module");
+		ret = E_BAD_ARGS;
 		goto exit;
 	}
 
-	node = artik_list_get_by_check(requested_node, artik_compare_module_ops,
-									module);
-	if (node == NULL) {
-		free(module_name);
-		dlclose(dl_handle);
+	/*
+	 * Requesters can only take a reference while the count is non zero,
+	 * once it drops to zero they serialize on the lock behind us.
+	 */
+	if (__atomic_sub_fetch(&entry->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+		/*
+		 * Binary log records point to the format, file and function
+		 * strings of the caller, let the writer thread consume them
+		 * before unmapping the library.
+		 */
+		os_log_flush();
+		if (entry->dl_handle)
+			dlclose(entry->dl_handle);
+		entry->dl_handle = NULL;
+		__atomic_store_n(&entry->dl_symbol, NULL, __ATOMIC_RELEASE);
 	}
 
 exit:
-	mutex_unlock();
+	pthread_mutex_unlock(&entry->lock);
 
 	return ret;
 }
 
+static int artik_count_modules(int platid)
+{
+	int num = 0;
+
+	if (platid < 0)
+		return 0;
+
+	while (artik_api_modules[platid][num].object != NULL)
+		num++;
+
+	return num;
+}
+
+static void artik_preload_one(const char *name, artik_module_load_info *info)
+{
+	artik_module_entry *entry = artik_lookup_name(name);
+	artik_module_ops ops;
+	uint64_t start = artik_now_usec();
+
+	memset(info, 0, sizeof(*info));
+	strncpy(info->name, name, MAX_MODULE_NAME - 1);
+
+	if (!entry) {
+		info->result = E_NOT_SUPPORTED;
+		return;
+	}
+
+	ops = os_request_api_module(name);
+	info->load_usec = artik_now_usec() - start;
+	if (ops == INVALID_MODULE) {
+		info->result = E_NOT_SUPPORTED;
+		return;
+	}
+
+	/* Keep a single reference so the module stays loaded */
+	if (__atomic_exchange_n(&entry->pinned, true, __ATOMIC_ACQ_REL))
+		os_release_api_module(ops);
+
+	info->result = S_OK;
+}
+
+static void *artik_preload_worker(void *user_data)
+{
+	artik_preload_job *job = (artik_preload_job *)user_data;
+	const artik_api_module *modules =
+				artik_api_modules[os_get_platform()];
+	artik_module_load_info local;
+	artik_error ok;
+	int i;
+
+	while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) <
+								job->num) {
+		artik_module_load_info *info = job->info ? &job->info[i] :
+									&local;
+
+		artik_preload_one(job->names ? job->names[i] : modules[i].name,
+									info);
+		/* Report the first error */
+		ok = S_OK;
+		if (info->result != S_OK)
+			__atomic_compare_exchange_n(&job->ret, &ok,
+					info->result, false, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED);
+	}
+
+	return NULL;
+}
+
+artik_error os_preload_modules(const char * const *names, int num,
+			int num_threads, artik_module_load_info *info)
+{
+	pthread_t threads[MAX_PRELOAD_THREADS];
+	artik_preload_job job;
+	int platid = os_get_platform();
+	int i, started = 0;
+
+	if (platid < 0)
+		return E_NOT_SUPPORTED;
+
+	if ((names && (num <= 0)) || (num_threads < 0))
+		return E_BAD_ARGS;
+
+	pthread_once(&registry_once, artik_registry_init);
+
+	memset(&job, 0, sizeof(job));
+	job.names = names;
+	job.info = info;
+	job.ret = S_OK;
+	job.num = names ? num : artik_count_modules(platid);
+
+	if (num_threads > MAX_PRELOAD_THREADS)
+		num_threads = MAX_PRELOAD_THREADS;
+	if (num_threads > job.num)
+		num_threads = job.num;
+
+	/* The calling thread always takes part in the loading */
+	for (i = 0; i < num_threads - 1; i++) {
+		if (pthread_create(&threads[i], NULL, artik_preload_worker,
+								&job))
+			break;
+		started++;
+	}
+
+	artik_preload_worker(&job);
+
+	for (i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	return job.ret;
+}
+
+static void *artik_preload_from_env(void *user_data)
+{
+	const char *names[MODULE_TABLE_SIZE];
+	artik_module_load_info info[MODULE_TABLE_SIZE];
+	char *list = (char *)user_data;
+	char *saveptr = NULL;
+	char *token;
+	const char *threads_env = getenv("ARTIK_PRELOAD_THREADS");
+	int num_threads = threads_env ? atoi(threads_env) : 1;
+	int num = 0, i;
+	artik_error ret;
+
+	if (!strcmp(list, "all")) {
+		num = artik_count_modules(os_get_platform());
+		if ((num <= 0) || (num > MODULE_TABLE_SIZE))
+			goto exit;
+		ret = os_preload_modules(NULL, 0, num_threads, info);
+	} else {
+		for (token = strtok_r(list, PRELOAD_SEPARATORS, &saveptr);
+			token && (num < MODULE_TABLE_SIZE);
+			token = strtok_r(NULL, PRELOAD_SEPARATORS, &saveptr))
+			names[num++] = token;
+
+		if (!num)
+			goto exit;
+
+		ret = os_preload_modules(names, num, num_threads, info);
+	}
+
+	for (i = 0; i < num; i++)
+		artik_log(LOG_LEVEL_INFO, "preload %s: %s in %llu usec",
+			info[i].name, error_msg(info[i].result),
+			(unsigned long long)info[i].load_usec);
+
+	if (ret != S_OK)
+		artik_log(LOG_LEVEL_WARNING, "some modules failed to preload");
+
+exit:
+	free(list);
+
+	return NULL;
+}
+
+/*
+ * Wait for the preload thread to be done with the loader and the module
+ * locks before forking or unloading the library.
+ */
+static void artik_preload_join(void)
+{
+	pthread_mutex_lock(&preload_lock);
+	if (preload_started && !pthread_equal(preload_thread, pthread_self())) {
+		pthread_join(preload_thread, NULL);
+		preload_started = false;
+	}
+	pthread_mutex_unlock(&preload_lock);
+}
+
+/*
+ * Preloading from the environment runs in a background thread: the
+ * library constructor may run while the dynamic loader lock is held, and
+ * the application should not wait for the modules it does not need yet.
+ */
+static void __attribute__((constructor)) artik_preload_init(void)
+{
+	const char *env = getenv("ARTIK_PRELOAD_MODULES");
+	char *list;
+
+	if (!env || !*env)
+		return;
+
+	list = strdup(env);
+	if (!list)
+		return;
+
+	if (pthread_create(&preload_thread, NULL, artik_preload_from_env,
+								list)) {
+		free(list);
+		return;
+	}
+
+	preload_started = true;
+	pthread_atfork(artik_preload_join, NULL, NULL);
+}
+
+static void __attribute__((destructor)) artik_preload_fini(void)
+{
+	artik_preload_join();
+}
+
 int os_get_platform(void)
 {
 	FILE *f = NULL;
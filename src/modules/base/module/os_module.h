@@ -21,9 +21,24 @@
 
 #include "artik_error.h"
 
+#ifdef CONFIG_ARTIK_MONOLITHIC
+/*
+ * In the monolithic build, all the modules are linked in the same library
+ * and this table, generated at build time, replaces dlopen/dlsym.
+ */
+typedef struct {
+	const char *name;
+	artik_module_ops ops;
+} artik_static_module;
+
+extern const artik_static_module artik_static_modules[];
+#endif
+
 artik_error os_get_api_version(artik_api_version *version);
 artik_module_ops os_request_api_module(const char *name);
 artik_error os_release_api_module(const artik_module_ops module);
+artik_error os_preload_modules(const char * const *names, int num,
+			int num_threads, artik_module_load_info *info);
 int os_get_platform(void);
 artik_error os_get_platform_name(char *name);
 artik_error os_get_available_modules(artik_api_module **modules,
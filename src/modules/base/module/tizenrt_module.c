@@ -95,6 +95,42 @@ artik_module_ops os_request_api_module(const char *name)
 	return ops;
 }
 
+artik_error os_preload_modules(const char * const *names, int num,
+			int num_threads, artik_module_load_info *info)
+{
+	artik_api_module *modules = NULL;
+	artik_error ret = S_OK;
+	int i, count = 0;
+
+	/* Modules are linked in the firmware, there is nothing to load */
+	if (!names) {
+		ret = os_get_available_modules(&modules, &count);
+		if (ret != S_OK)
+			return ret;
+	} else if (num <= 0) {
+		return E_BAD_ARGS;
+	} else {
+		count = num;
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *name = names ? names[i] : modules[i].name;
+		artik_error result = (os_request_api_module(name) ==
+				INVALID_MODULE) ? E_NOT_SUPPORTED : S_OK;
+
+		if (info) {
+			memset(&info[i], 0, sizeof(info[i]));
+			strncpy(info[i].name, name, MAX_MODULE_NAME - 1);
+			info[i].result = result;
+		}
+
+		if (result != S_OK)
+			ret = result;
+	}
+
+	return ret;
+}
+
 artik_error os_release_api_module(const artik_module_ops module)
 {
 	int i = 0, plat = 0;
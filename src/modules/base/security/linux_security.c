@@ -29,6 +29,7 @@
 #include <artik_module.h>
 #include <artik_security.h>
 #include <artik_list.h>
+#include <artik_indexed_list.h>
 #include <artik_log.h>
 #include "os_security.h"
 
@@ -84,8 +85,8 @@ typedef struct {
 } verify_node;
 
 static bool openssl_global_init = false;
-static artik_list *requested_node = NULL;
-static artik_list *verify_nodes = NULL;
+static artik_indexed_list requested_node;
+static artik_indexed_list verify_nodes;
 
 static void free_all(EC_KEY *ec_key, BIGNUM *x, BIGNUM *y,
 		     EC_POINT *ec_point, BN_CTX *ctx)
@@ -228,8 +229,9 @@ artik_error os_security_request(artik_security_handle *handle)
 	 * just return a reference to a single instance, and increment
 	 * reference counter to know when to destroy the instance.
 	 */
-	if (artik_list_size(requested_node)) {
-		node = (security_node *)artik_list_get_by_pos(requested_node, 0);
+	if (artik_indexed_list_size(&requested_node)) {
+		node = (security_node *)
+			artik_indexed_list_get_by_pos(&requested_node, 0);
 		if (!node)
 			return E_ACCESS_DENIED;
 		node->refcnt++;
@@ -237,7 +239,7 @@ artik_error os_security_request(artik_security_handle *handle)
 		return S_OK;
 	}
 
-	node = (security_node *) artik_list_add(&requested_node,
+	node = (security_node *) artik_indexed_list_add(&requested_node,
 						0, sizeof(security_node));
 
 	if (!node)
@@ -262,7 +264,7 @@ artik_error os_security_request(artik_security_handle *handle)
 	if (!engine || !ENGINE_init(engine)) {
 		if (engine)
 			ENGINE_free(engine);
-		artik_list_delete_node(&requested_node,
+		artik_indexed_list_delete_node(&requested_node,
 							(artik_list *)node);
 		return E_ACCESS_DENIED;
 	}
@@ -270,7 +272,8 @@ artik_error os_security_request(artik_security_handle *handle)
 					ENGINE_METHOD_ECDSA)) {
 		ENGINE_finish(engine);
 		ENGINE_free(engine);
-		artik_list_delete_node(&requested_node, (artik_list *)node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)node);
 		return E_ACCESS_DENIED;
 	}
 
@@ -285,7 +288,7 @@ artik_error os_security_request(artik_security_handle *handle)
 artik_error os_security_release(artik_security_handle handle)
 {
 	security_node *node = (security_node *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node || strncmp(node->cookie, COOKIE_SECURITY, sizeof(node->cookie)))
@@ -310,7 +313,7 @@ artik_error os_security_release(artik_security_handle handle)
 		ENGINE_free(node->engine);
 	}
 
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 
 	return S_OK;
 }
@@ -319,7 +322,7 @@ artik_error os_security_get_certificate(artik_security_handle handle,
 				artik_security_certificate_id cert_id, char **cert)
 {
 	security_node *node = (security_node *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	struct cert_params params;
 	BIO *b64 = NULL;
@@ -374,7 +377,7 @@ artik_error os_security_get_key_from_cert(artik_security_handle handle,
 					  const char *cert, char **key)
 {
 	security_node *node = (security_node *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 					(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 	X509 *x509_cert = NULL;
@@ -442,7 +445,7 @@ artik_error os_security_get_ca_chain(artik_security_handle handle,
 					artik_security_certificate_id cert_id, char **chain)
 {
 	security_node *node = (security_node *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	struct cert_params params;
 	BIO *b64 = NULL;
@@ -505,7 +508,7 @@ artik_error os_get_random_bytes(artik_security_handle handle,
 				unsigned char *rand, int len)
 {
 	security_node *node = (security_node *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node || !node->engine || !rand ||
@@ -665,7 +668,8 @@ artik_error os_verify_signature_init(artik_security_handle *handle,
 	if (!handle || !signature_pem || !root_ca)
 		return E_BAD_ARGS;
 
-	node = (verify_node *)artik_list_add(&verify_nodes, 0, sizeof(verify_node));
+	node = (verify_node *)
+		artik_indexed_list_add(&verify_nodes, 0, sizeof(verify_node));
 	if (!node)
 		return E_NO_MEM;
 
@@ -838,7 +842,8 @@ exit:
 		X509_free(ca_cert);
 
 	if (ret != S_OK)
-		artik_list_delete_node(&verify_nodes, (artik_list *)node);
+		artik_indexed_list_delete_node(&verify_nodes,
+				(artik_list *)node);
 
 	return ret;
 }
@@ -846,7 +851,8 @@ exit:
 artik_error os_verify_signature_update(artik_security_handle handle,
 		unsigned char *data, unsigned int data_len)
 {
-	verify_node *node = (verify_node *)artik_list_get_by_handle(verify_nodes,
+	verify_node *node =
+		(verify_node *)artik_indexed_list_get_by_handle(&verify_nodes,
 		(ARTIK_LIST_HANDLE)handle);
 
 	if (!node || !data || !data_len ||
@@ -869,7 +875,8 @@ artik_error os_verify_signature_final(artik_security_handle handle)
 	unsigned char md_dat[EVP_MAX_MD_SIZE], *abuf = NULL;
 	unsigned int md_len = 0;
 	int alen = 0;
-	verify_node *node = (verify_node *)artik_list_get_by_handle(verify_nodes,
+	verify_node *node =
+		(verify_node *)artik_indexed_list_get_by_handle(&verify_nodes,
 		(ARTIK_LIST_HANDLE)handle);
 
 	if (!node || strncmp(node->cookie, COOKIE_SIGVERIF, sizeof(node->cookie)))
@@ -944,7 +951,7 @@ exit:
 		EVP_PKEY_free(pkey);
 	PKCS7_free(node->p7);
 	EVP_MD_CTX_destroy(node->md_ctx);
-	artik_list_delete_node(&verify_nodes, (artik_list *)node);
+	artik_indexed_list_delete_node(&verify_nodes, (artik_list *)node);
 
 	return ret;
 }
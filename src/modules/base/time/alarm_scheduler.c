@@ -0,0 +1,694 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+
+#include <artik_module.h>
+#include <artik_log.h>
+#include <artik_loop.h>
+
+#include "alarm_scheduler.h"
+
+#ifndef TFD_TIMER_CANCEL_ON_SET
+#define TFD_TIMER_CANCEL_ON_SET	(1 << 1)
+#endif
+
+#define NSEC_PER_SEC		1000000000ULL
+#define ALARM_NOT_QUEUED	SIZE_MAX
+#define HEAP_MIN_SIZE		64
+/* Longest time between two occurrences of a cron schedule (Feb 29) */
+#define CRON_MAX_YEARS		9
+
+enum alarm_type {
+	ALARM_DELAY,
+	ALARM_DATE,
+	ALARM_CRON
+};
+
+struct alarm {
+	uint64_t		deadline;	/* CLOCK_REALTIME */
+	uint64_t		mono_deadline;	/* Only for ALARM_DELAY */
+	uint64_t		period;
+	size_t			index;		/* Position in the heap */
+	enum alarm_type		type;
+	struct alarm_cron	cron;
+	int			offset;
+	alarm_callback		func;
+	void			*user_data;
+	bool			removed;
+};
+
+struct alarm_scheduler {
+	pthread_mutex_t		lock;
+	struct alarm		**heap;
+	size_t			count;
+	size_t			size;
+	size_t			num_alarms;
+	int			fd;
+	int			watch_id;
+	artik_loop_module	*loop;
+	/* CLOCK_REALTIME - CLOCK_MONOTONIC */
+	uint64_t		offset;
+	/* Deadline the timer is armed on, 0 if disarmed */
+	uint64_t		armed;
+	struct alarm		*firing;
+	bool			dispatching;
+};
+
+static struct alarm_scheduler sched = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1
+};
+
+static const struct {
+	const char *name;
+	const char *schedule;
+} cron_macros[] = {
+	{ "@yearly", "0 0 1 1 *" },
+	{ "@annually", "0 0 1 1 *" },
+	{ "@monthly", "0 0 1 * *" },
+	{ "@weekly", "0 0 * * 0" },
+	{ "@daily", "0 0 * * *" },
+	{ "@midnight", "0 0 * * *" },
+	{ "@hourly", "0 * * * *" }
+};
+
+static const char *_cron_parse_field(const char *p, int min, int max,
+					uint64_t *mask, bool *any)
+{
+	*mask = 0;
+	*any = (*p == '*');
+
+	for (;;) {
+		char *end;
+		long low, high, step = 1, v;
+
+		if (*p == '*') {
+			low = min;
+			high = max;
+			p++;
+		} else {
+			if (!isdigit((unsigned char)*p))
+				return NULL;
+			low = high = strtol(p, &end, 10);
+			p = end;
+			if (*p == '-') {
+				p++;
+				if (!isdigit((unsigned char)*p))
+					return NULL;
+				high = strtol(p, &end, 10);
+				p = end;
+			} else if (*p == '/') {
+				/* "a/n" stands for "a-max/n" */
+				high = max;
+			}
+		}
+
+		if (*p == '/') {
+			p++;
+			if (!isdigit((unsigned char)*p))
+				return NULL;
+			step = strtol(p, &end, 10);
+			p = end;
+		}
+
+		if (low < min || high > max || low > high || step < 1)
+			return NULL;
+
+		for (v = low; v <= high; v += step)
+			*mask |= 1ULL << v;
+
+		if (*p != ',')
+			break;
+		p++;
+	}
+
+	return p;
+}
+
+artik_error alarm_cron_parse(const char *schedule, struct alarm_cron *cron)
+{
+	static const int limits[5][2] = {
+		{ 0, 59 }, { 0, 23 }, { 1, 31 }, { 1, 12 }, { 0, 7 }
+	};
+	uint64_t masks[5];
+	bool any[5];
+	const char *p = schedule;
+	unsigned int i;
+
+	if (!schedule || !cron)
+		return E_BAD_ARGS;
+
+	while (isspace((unsigned char)*p))
+		p++;
+
+	for (i = 0; i < sizeof(cron_macros) / sizeof(cron_macros[0]); i++) {
+		size_t len = strlen(cron_macros[i].name);
+
+		if (!strncmp(p, cron_macros[i].name, len) &&
+			(!p[len] || isspace((unsigned char)p[len])))
+			return alarm_cron_parse(cron_macros[i].schedule, cron);
+	}
+
+	for (i = 0; i < 5; i++) {
+		while (isspace((unsigned char)*p))
+			p++;
+
+		p = _cron_parse_field(p, limits[i][0], limits[i][1], &masks[i],
+					&any[i]);
+		if (!p || (*p && !isspace((unsigned char)*p)))
+			return E_BAD_ARGS;
+	}
+
+	while (isspace((unsigned char)*p))
+		p++;
+	if (*p)
+		return E_BAD_ARGS;
+
+	cron->minutes = masks[0];
+	cron->hours = masks[1];
+	cron->days = masks[2];
+	cron->months = masks[3];
+	/* Both 0 and 7 are Sunday */
+	cron->weekdays = (masks[4] | (masks[4] >> 7)) & 0x7f;
+	cron->any_day = any[2];
+	cron->any_weekday = any[4];
+
+	return S_OK;
+}
+
+static bool _cron_day_match(const struct alarm_cron *cron, const struct tm *tm)
+{
+	bool day = cron->days & (1U << tm->tm_mday);
+	bool weekday = cron->weekdays & (1U << tm->tm_wday);
+
+	/* Like cron, a restricted day matches if either field matches */
+	if (cron->any_day && cron->any_weekday)
+		return true;
+	if (cron->any_day)
+		return weekday;
+	if (cron->any_weekday)
+		return day;
+
+	return day || weekday;
+}
+
+bool alarm_cron_next(const struct alarm_cron *cron, int64_t after,
+			int offset, int64_t *next)
+{
+	int64_t t = after + offset;
+	int64_t limit;
+
+	/* Next whole minute */
+	t = t - ((t % 60) + 60) % 60 + 60;
+	limit = t + CRON_MAX_YEARS * 366LL * 86400;
+
+	while (t < limit) {
+		time_t now = t;
+		struct tm tm;
+		uint64_t bits;
+
+		if (!gmtime_r(&now, &tm))
+			return false;
+
+		if (!(cron->months & (1U << (tm.tm_mon + 1)))) {
+			tm.tm_mon++;
+			tm.tm_mday = 1;
+			tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+			t = timegm(&tm);
+			continue;
+		}
+
+		if (!_cron_day_match(cron, &tm)) {
+			t += 86400 - (tm.tm_hour * 3600 + tm.tm_min * 60);
+			continue;
+		}
+
+		bits = cron->hours >> tm.tm_hour;
+		if (!bits) {
+			t += 86400 - (tm.tm_hour * 3600 + tm.tm_min * 60);
+			continue;
+		}
+		if (!(bits & 1)) {
+			t += __builtin_ctzll(bits) * 3600LL - tm.tm_min * 60;
+			continue;
+		}
+
+		bits = cron->minutes >> tm.tm_min;
+		if (!bits) {
+			t += 3600 - tm.tm_min * 60;
+			continue;
+		}
+
+		*next = t + __builtin_ctzll(bits) * 60LL - offset;
+		return true;
+	}
+
+	return false;
+}
+
+static uint64_t _clock_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void _heap_set(size_t index, struct alarm *alarm)
+{
+	sched.heap[index] = alarm;
+	alarm->index = index;
+}
+
+static void _heap_sift_up(size_t index)
+{
+	struct alarm *alarm = sched.heap[index];
+
+	while (index > 0) {
+		size_t parent = (index - 1) / 2;
+
+		if (sched.heap[parent]->deadline <= alarm->deadline)
+			break;
+		_heap_set(index, sched.heap[parent]);
+		index = parent;
+	}
+
+	_heap_set(index, alarm);
+}
+
+static void _heap_sift_down(size_t index)
+{
+	struct alarm *alarm = sched.heap[index];
+
+	for (;;) {
+		size_t child = 2 * index + 1;
+
+		if (child >= sched.count)
+			break;
+		if (child + 1 < sched.count && sched.heap[child + 1]->deadline <
+						sched.heap[child]->deadline)
+			child++;
+		if (alarm->deadline <= sched.heap[child]->deadline)
+			break;
+		_heap_set(index, sched.heap[child]);
+		index = child;
+	}
+
+	_heap_set(index, alarm);
+}
+
+static artik_error _heap_push(struct alarm *alarm)
+{
+	if (sched.count == sched.size) {
+		size_t size = sched.size ? sched.size * 2 : HEAP_MIN_SIZE;
+		struct alarm **heap;
+
+		heap = realloc(sched.heap, size * sizeof(*heap));
+		if (!heap)
+			return E_NO_MEM;
+		sched.heap = heap;
+		sched.size = size;
+	}
+
+	_heap_set(sched.count++, alarm);
+	_heap_sift_up(alarm->index);
+
+	return S_OK;
+}
+
+static void _heap_remove(struct alarm *alarm)
+{
+	size_t index = alarm->index;
+	struct alarm *last = sched.heap[--sched.count];
+
+	alarm->index = ALARM_NOT_QUEUED;
+	if (last == alarm)
+		return;
+
+	_heap_set(index, last);
+	if (index > 0 && sched.heap[(index - 1) / 2]->deadline > last->deadline)
+		_heap_sift_up(index);
+	else
+		_heap_sift_down(index);
+}
+
+static void _arm(void)
+{
+	struct itimerspec spec;
+	uint64_t deadline;
+
+	memset(&spec, 0, sizeof(spec));
+
+	if (!sched.count) {
+		if (!sched.armed)
+			return;
+		sched.armed = 0;
+		timerfd_settime(sched.fd, 0, &spec, NULL);
+		return;
+	}
+
+	deadline = sched.heap[0]->deadline ? sched.heap[0]->deadline : 1;
+	if (deadline == sched.armed)
+		return;
+
+	spec.it_value.tv_sec = deadline / NSEC_PER_SEC;
+	spec.it_value.tv_nsec = deadline % NSEC_PER_SEC;
+	if (timerfd_settime(sched.fd, TFD_TIMER_ABSTIME |
+				TFD_TIMER_CANCEL_ON_SET, &spec, NULL) < 0) {
+		log_err("Failed to arm alarm timer (%d)", errno);
+		return;
+	}
+
+	sched.armed = deadline;
+}
+
+/* Compute the next deadline of a recurring alarm once it fired */
+static bool _reschedule(struct alarm *alarm, uint64_t now)
+{
+	int64_t next;
+
+	switch (alarm->type) {
+	case ALARM_DELAY: {
+		uint64_t mono = now - sched.offset;
+
+		if (!alarm->period)
+			return false;
+
+		/* Skip the periods missed while the callback was running */
+		alarm->mono_deadline += alarm->period;
+		if (alarm->mono_deadline <= mono)
+			alarm->mono_deadline += ((mono - alarm->mono_deadline) /
+					alarm->period + 1) * alarm->period;
+		alarm->deadline = alarm->mono_deadline + sched.offset;
+		return true;
+	}
+	case ALARM_CRON:
+		if (!alarm_cron_next(&alarm->cron, now / NSEC_PER_SEC,
+					alarm->offset, &next))
+			return false;
+		alarm->deadline = next * NSEC_PER_SEC;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* The system time was changed, move the alarms bound to it */
+static void _rebase(void)
+{
+	uint64_t now = _clock_ns(CLOCK_REALTIME);
+	size_t i;
+
+	sched.offset = now - _clock_ns(CLOCK_MONOTONIC);
+
+	for (i = 0; i < sched.count; i++) {
+		struct alarm *alarm = sched.heap[i];
+		int64_t next;
+
+		if (alarm->type == ALARM_DELAY)
+			alarm->deadline = alarm->mono_deadline + sched.offset;
+		else if (alarm->type == ALARM_CRON &&
+			alarm_cron_next(&alarm->cron, now / NSEC_PER_SEC - 1,
+					alarm->offset, &next))
+			alarm->deadline = next * NSEC_PER_SEC;
+	}
+
+	for (i = sched.count / 2; i-- > 0;)
+		_heap_sift_down(i);
+
+	sched.armed = 0;
+}
+
+static void _stop(void)
+{
+	if (sched.watch_id)
+		sched.loop->remove_fd_watch(sched.watch_id);
+	close(sched.fd);
+	artik_release_api_module(sched.loop);
+
+	free(sched.heap);
+	sched.heap = NULL;
+	sched.count = sched.size = 0;
+	sched.fd = -1;
+	sched.watch_id = 0;
+	sched.loop = NULL;
+	sched.armed = 0;
+}
+
+static int _on_timer(int fd, enum watch_io io, void *user_data)
+{
+	uint64_t expirations;
+	uint64_t now;
+
+	pthread_mutex_lock(&sched.lock);
+
+	if (read(fd, &expirations, sizeof(expirations)) < 0 &&
+							errno == ECANCELED)
+		_rebase();
+
+	sched.armed = 0;
+	sched.dispatching = true;
+	now = _clock_ns(CLOCK_REALTIME);
+
+	while (sched.count && sched.heap[0]->deadline <= now) {
+		struct alarm *alarm = sched.heap[0];
+
+		_heap_remove(alarm);
+		sched.firing = alarm;
+		pthread_mutex_unlock(&sched.lock);
+
+		alarm->func(alarm->user_data);
+
+		pthread_mutex_lock(&sched.lock);
+		sched.firing = NULL;
+
+		if (alarm->removed) {
+			free(alarm);
+			continue;
+		}
+
+		if (_reschedule(alarm, _clock_ns(CLOCK_REALTIME)) &&
+						_heap_push(alarm) != S_OK)
+			log_err("Failed to reschedule alarm");
+	}
+
+	sched.dispatching = false;
+
+	if (!sched.num_alarms) {
+		/* Returning 0 removes the watch */
+		sched.watch_id = 0;
+		_stop();
+		pthread_mutex_unlock(&sched.lock);
+		return 0;
+	}
+
+	_arm();
+	pthread_mutex_unlock(&sched.lock);
+
+	return 1;
+}
+
+static artik_error _start(void)
+{
+	artik_error ret;
+
+	sched.loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!sched.loop)
+		return E_NOT_SUPPORTED;
+
+	sched.fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (sched.fd < 0) {
+		log_err("Failed to create alarm timer (%d)", errno);
+		artik_release_api_module(sched.loop);
+		sched.loop = NULL;
+		return E_NOT_SUPPORTED;
+	}
+
+	ret = sched.loop->add_fd_watch(sched.fd, WATCH_IO_IN, _on_timer, NULL,
+					&sched.watch_id);
+	if (ret != S_OK) {
+		sched.watch_id = 0;
+		_stop();
+		return ret;
+	}
+
+	sched.offset = _clock_ns(CLOCK_REALTIME) - _clock_ns(CLOCK_MONOTONIC);
+
+	return S_OK;
+}
+
+static artik_error _add(struct alarm *alarm, artik_alarm_handle *handle)
+{
+	artik_error ret = S_OK;
+
+	pthread_mutex_lock(&sched.lock);
+
+	if (sched.fd < 0) {
+		ret = _start();
+		if (ret != S_OK)
+			goto exit;
+	}
+
+	if (alarm->type == ALARM_DELAY)
+		alarm->deadline = alarm->mono_deadline + sched.offset;
+
+	ret = _heap_push(alarm);
+	if (ret != S_OK) {
+		if (!sched.num_alarms && !sched.dispatching)
+			_stop();
+		goto exit;
+	}
+
+	sched.num_alarms++;
+	if (alarm->index == 0)
+		_arm();
+
+	*handle = alarm;
+
+exit:
+	pthread_mutex_unlock(&sched.lock);
+
+	if (ret != S_OK)
+		free(alarm);
+
+	return ret;
+}
+
+static struct alarm *_new_alarm(enum alarm_type type, alarm_callback func,
+				void *user_data)
+{
+	struct alarm *alarm = calloc(1, sizeof(*alarm));
+
+	if (!alarm)
+		return NULL;
+
+	alarm->type = type;
+	alarm->func = func;
+	alarm->user_data = user_data;
+	alarm->index = ALARM_NOT_QUEUED;
+
+	return alarm;
+}
+
+artik_error alarm_scheduler_add_delay(uint64_t delay_ns, uint64_t period_ns,
+				alarm_callback func, void *user_data,
+				artik_alarm_handle *handle)
+{
+	struct alarm *alarm = _new_alarm(ALARM_DELAY, func, user_data);
+
+	if (!alarm)
+		return E_NO_MEM;
+
+	alarm->mono_deadline = _clock_ns(CLOCK_MONOTONIC) + delay_ns;
+	alarm->period = period_ns;
+
+	return _add(alarm, handle);
+}
+
+artik_error alarm_scheduler_add_date(int64_t date, alarm_callback func,
+				void *user_data, artik_alarm_handle *handle)
+{
+	struct alarm *alarm;
+
+	if (date < 0)
+		return E_BAD_ARGS;
+
+	alarm = _new_alarm(ALARM_DATE, func, user_data);
+	if (!alarm)
+		return E_NO_MEM;
+
+	alarm->deadline = (uint64_t)date * NSEC_PER_SEC;
+
+	return _add(alarm, handle);
+}
+
+artik_error alarm_scheduler_add_cron(const struct alarm_cron *cron,
+				int offset, alarm_callback func,
+				void *user_data, artik_alarm_handle *handle)
+{
+	struct alarm *alarm;
+	int64_t next;
+
+	if (!alarm_cron_next(cron, _clock_ns(CLOCK_REALTIME) / NSEC_PER_SEC,
+				offset, &next))
+		return E_BAD_ARGS;
+
+	alarm = _new_alarm(ALARM_CRON, func, user_data);
+	if (!alarm)
+		return E_NO_MEM;
+
+	alarm->cron = *cron;
+	alarm->offset = offset;
+	alarm->deadline = next * NSEC_PER_SEC;
+
+	return _add(alarm, handle);
+}
+
+artik_error alarm_scheduler_remove(artik_alarm_handle handle)
+{
+	struct alarm *alarm = handle;
+
+	pthread_mutex_lock(&sched.lock);
+
+	if (alarm->index != ALARM_NOT_QUEUED)
+		_heap_remove(alarm);
+
+	sched.num_alarms--;
+
+	/* Freed once its callback returns */
+	if (alarm == sched.firing)
+		alarm->removed = true;
+	else
+		free(alarm);
+
+	if (!sched.num_alarms && !sched.dispatching)
+		_stop();
+
+	pthread_mutex_unlock(&sched.lock);
+
+	return S_OK;
+}
+
+artik_error alarm_scheduler_get_delay(artik_alarm_handle handle,
+				uint64_t *delay_ns)
+{
+	struct alarm *alarm = handle;
+	uint64_t now = _clock_ns(CLOCK_REALTIME);
+
+	pthread_mutex_lock(&sched.lock);
+
+	if (alarm->index == ALARM_NOT_QUEUED || alarm->deadline <= now)
+		*delay_ns = 0;
+	else
+		*delay_ns = alarm->deadline - now;
+
+	pthread_mutex_unlock(&sched.lock);
+
+	return S_OK;
+}
@@ -0,0 +1,84 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef _ALARM_SCHEDULER_H_
+#define _ALARM_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <artik_error.h>
+#include <artik_time.h>
+
+/*
+ * Alarms of the Time module on Linux.
+ *
+ * All the alarms are kept in a binary min-heap ordered by their
+ * CLOCK_REALTIME deadline and a single timerfd, watched from the loop
+ * module, is armed on the earliest one. The timer is armed with
+ * TFD_TIMER_CANCEL_ON_SET so that the deadlines are recomputed when the
+ * system time is changed: alarms set after a delay keep their delay,
+ * alarms set at a date keep their date and cron alarms move to their next
+ * occurrence.
+ */
+
+/* Matching minutes, hours, days, months and days of the week */
+struct alarm_cron {
+	uint64_t	minutes;
+	uint32_t	hours;
+	uint32_t	days;		/* Bits 1 to 31 */
+	uint16_t	months;		/* Bits 1 to 12 */
+	uint8_t		weekdays;	/* Bit 0 is Sunday */
+	bool		any_day;
+	bool		any_weekday;
+};
+
+/*
+ * Parse a crontab(5) like schedule: "minute hour day month weekday" where
+ * each field is '*', a value, a range "a-b" or a list of them separated by
+ * commas, optionally followed by a step "/n". "@yearly", "@monthly",
+ * "@weekly", "@daily" and "@hourly" are accepted as well.
+ */
+artik_error alarm_cron_parse(const char *schedule, struct alarm_cron *cron);
+
+/*
+ * Find the first time strictly after 'after' (seconds since the Epoch)
+ * matching 'cron' in a time zone 'offset' seconds ahead of UTC. Returns
+ * false if no such time exists within the next years.
+ */
+bool alarm_cron_next(const struct alarm_cron *cron, int64_t after,
+			int offset, int64_t *next);
+
+/* Set off after 'delay_ns', then every 'period_ns' if not 0 */
+artik_error alarm_scheduler_add_delay(uint64_t delay_ns, uint64_t period_ns,
+				alarm_callback func, void *user_data,
+				artik_alarm_handle *handle);
+/* Set off at 'date' seconds since the Epoch */
+artik_error alarm_scheduler_add_date(int64_t date, alarm_callback func,
+				void *user_data, artik_alarm_handle *handle);
+/* Set off at each occurrence of 'cron' */
+artik_error alarm_scheduler_add_cron(const struct alarm_cron *cron,
+				int offset, alarm_callback func,
+				void *user_data, artik_alarm_handle *handle);
+/* Cancel an alarm and free its handle */
+artik_error alarm_scheduler_remove(artik_alarm_handle handle);
+/* Nanoseconds before the alarm is set off, 0 once a one-shot alarm fired */
+artik_error alarm_scheduler_get_delay(artik_alarm_handle handle,
+				uint64_t *delay_ns);
+
+#endif /* _ALARM_SCHEDULER_H_ */
@@ -21,6 +21,7 @@
 
 #include	"artik_time.h"
 #include	"os_time.h"
+#include	"time_histogram.h"
 
 static artik_error artik_time_set_time(artik_time date, artik_time_zone gmt);
 static artik_error artik_time_get_time(artik_time_zone gmt, artik_time *date);
@@ -49,6 +50,34 @@ static artik_error artik_time_convert_timestamp_to_time(const int64_t timestamp,
 static artik_error artik_time_convert_time_to_timestamp(const artik_time
 							*date,
 							int64_t *timestamp);
+static uint64_t artik_time_get_monotonic_ns(void);
+static uint64_t artik_time_get_monotonic_us(void);
+static uint64_t artik_time_get_monotonic_ms(void);
+static uint64_t artik_time_get_elapsed_ns(uint64_t start_ns);
+static artik_error artik_time_create_histogram(artik_time_histogram *hist);
+static artik_error artik_time_destroy_histogram(artik_time_histogram hist);
+static artik_error artik_time_record_histogram(artik_time_histogram hist,
+					       uint64_t duration_ns);
+static artik_error artik_time_get_histogram_stats(artik_time_histogram hist,
+					artik_time_histogram_stats *stats);
+static artik_error artik_time_reset_histogram(artik_time_histogram hist);
+static artik_error artik_time_start_timer(artik_time_histogram hist,
+					  artik_time_timer *timer);
+static artik_error artik_time_stop_timer(artik_time_timer *timer);
+static artik_error artik_time_create_alarm_msecond(artik_msecond msecond,
+						   artik_msecond period,
+						   artik_alarm_handle *handle,
+						   alarm_callback func,
+						   void *user_data);
+static artik_error artik_time_create_alarm_cron(artik_time_zone gmt,
+						const char *schedule,
+						artik_alarm_handle *handle,
+						alarm_callback func,
+						void *user_data);
+static artik_error artik_time_sync_ntp_async(
+					const artik_time_ntp_config *config,
+					ntp_callback func, void *user_data);
+static artik_error artik_time_get_ntp_stats(artik_time_ntp_stats *stats);
 
 
 EXPORT_API artik_time_module time_module = {
@@ -63,7 +92,22 @@ EXPORT_API artik_time_module time_module = {
 	artik_time_sync_ntp,
 	artik_time_compare_dates,
 	artik_time_convert_timestamp_to_time,
-	artik_time_convert_time_to_timestamp
+	artik_time_convert_time_to_timestamp,
+	artik_time_get_monotonic_ns,
+	artik_time_get_monotonic_us,
+	artik_time_get_monotonic_ms,
+	artik_time_get_elapsed_ns,
+	artik_time_create_histogram,
+	artik_time_destroy_histogram,
+	artik_time_record_histogram,
+	artik_time_get_histogram_stats,
+	artik_time_reset_histogram,
+	artik_time_start_timer,
+	artik_time_stop_timer,
+	artik_time_create_alarm_msecond,
+	artik_time_create_alarm_cron,
+	artik_time_sync_ntp_async,
+	artik_time_get_ntp_stats
 };
 
 static artik_error artik_time_set_time(artik_time date, artik_time_zone gmt)
@@ -189,3 +233,118 @@ static artik_error artik_time_convert_time_to_timestamp(const artik_time *date,
 
 	return os_time_convert_time_to_timestamp(date, timestamp);
 }
+
+static uint64_t artik_time_get_monotonic_ns(void)
+{
+	return os_time_get_monotonic_ns();
+}
+
+static uint64_t artik_time_get_monotonic_us(void)
+{
+	return os_time_get_monotonic_ns() / 1000ULL;
+}
+
+static uint64_t artik_time_get_monotonic_ms(void)
+{
+	return os_time_get_monotonic_ns() / 1000000ULL;
+}
+
+static uint64_t artik_time_get_elapsed_ns(uint64_t start_ns)
+{
+	return os_time_get_monotonic_ns() - start_ns;
+}
+
+static artik_error artik_time_create_histogram(artik_time_histogram *hist)
+{
+	return time_histogram_create(hist);
+}
+
+static artik_error artik_time_destroy_histogram(artik_time_histogram hist)
+{
+	return time_histogram_destroy(hist);
+}
+
+static artik_error artik_time_record_histogram(artik_time_histogram hist,
+					       uint64_t duration_ns)
+{
+	if (!hist)
+		return E_BAD_ARGS;
+
+	time_histogram_record(hist, duration_ns);
+
+	return S_OK;
+}
+
+static artik_error artik_time_get_histogram_stats(artik_time_histogram hist,
+					artik_time_histogram_stats *stats)
+{
+	return time_histogram_get_stats(hist, stats);
+}
+
+static artik_error artik_time_reset_histogram(artik_time_histogram hist)
+{
+	return time_histogram_reset(hist);
+}
+
+static artik_error artik_time_start_timer(artik_time_histogram hist,
+					  artik_time_timer *timer)
+{
+	if (!hist || !timer)
+		return E_BAD_ARGS;
+
+	timer->hist = hist;
+	timer->start_ns = os_time_get_monotonic_ns();
+
+	return S_OK;
+}
+
+static artik_error artik_time_stop_timer(artik_time_timer *timer)
+{
+	if (!timer || !timer->hist)
+		return E_BAD_ARGS;
+
+	time_histogram_record(timer->hist,
+			os_time_get_monotonic_ns() - timer->start_ns);
+
+	return S_OK;
+}
+
+static artik_error artik_time_create_alarm_msecond(artik_msecond msecond,
+						   artik_msecond period,
+						   artik_alarm_handle *handle,
+						   alarm_callback func,
+						   void *user_data)
+{
+	if (!handle || *handle)
+		return E_BAD_ARGS;
+	return os_time_create_alarm_msecond(handle, func, user_data, msecond,
+					    period);
+}
+
+static artik_error artik_time_create_alarm_cron(artik_time_zone gmt,
+						const char *schedule,
+						artik_alarm_handle *handle,
+						alarm_callback func,
+						void *user_data)
+{
+	if (!handle || *handle || !schedule)
+		return E_BAD_ARGS;
+	return os_time_create_alarm_cron(gmt, handle, func, user_data,
+					 schedule);
+}
+
+static artik_error artik_time_sync_ntp_async(
+					const artik_time_ntp_config *config,
+					ntp_callback func, void *user_data)
+{
+	if (!config || !func)
+		return E_BAD_ARGS;
+	return os_time_sync_ntp_async(config, func, user_data);
+}
+
+static artik_error artik_time_get_ntp_stats(artik_time_ntp_stats *stats)
+{
+	if (!stats)
+		return E_BAD_ARGS;
+	return os_time_get_ntp_stats(stats);
+}
@@ -54,6 +54,28 @@ artik::Alarm::Alarm(artik_time_zone gmt, artik_msecond second,
       user_data);
 }
 
+artik::Alarm::Alarm(artik_msecond msecond, artik_msecond period,
+    alarm_callback func, void *user_data, artik_time_module *module) {
+  if (!module)
+    module = reinterpret_cast<artik_time_module*>(
+        artik_request_api_module("time"));
+  this->m_handle = NULL;
+  this->m_module = &(*module);
+  this->m_module->create_alarm_msecond(msecond, period, &this->m_handle, func,
+      user_data);
+}
+
+artik::Alarm::Alarm(artik_time_zone gmt, const char *schedule,
+    alarm_callback func, void *user_data, artik_time_module *module) {
+  if (!module)
+    module = reinterpret_cast<artik_time_module*>(
+        artik_request_api_module("time"));
+  this->m_handle = NULL;
+  this->m_module = &(*module);
+  this->m_module->create_alarm_cron(gmt, schedule, &this->m_handle, func,
+      user_data);
+}
+
 artik::Alarm::Alarm() {
   this->m_handle = NULL;
   this->m_module = NULL;
@@ -119,6 +141,15 @@ artik_error artik::Time::sync_ntp(const char* hostname) {
   return this->m_module->sync_ntp(hostname);
 }
 
+artik_error artik::Time::sync_ntp_async(const artik_time_ntp_config *config,
+    ntp_callback func, void *user_data) {
+  return this->m_module->sync_ntp_async(config, func, user_data);
+}
+
+artik_error artik::Time::get_ntp_stats(artik_time_ntp_stats *stats) const {
+  return this->m_module->get_ntp_stats(stats);
+}
+
 artik::Alarm *artik::Time::create_alarm_second(artik_time_zone gmt,
     artik_msecond second, alarm_callback func, void *user_data) {
   return new Alarm(gmt, second, func, user_data, this->m_module);
@@ -129,6 +160,16 @@ artik::Alarm *artik::Time::create_alarm_date(artik_time_zone gmt,
   return new Alarm(gmt, date, func, user_data, this->m_module);
 }
 
+artik::Alarm *artik::Time::create_alarm_msecond(artik_msecond msecond,
+    artik_msecond period, alarm_callback func, void *user_data) {
+  return new Alarm(msecond, period, func, user_data, this->m_module);
+}
+
+artik::Alarm *artik::Time::create_alarm_cron(artik_time_zone gmt,
+    const char *schedule, alarm_callback func, void *user_data) {
+  return new Alarm(gmt, schedule, func, user_data, this->m_module);
+}
+
 int artik::Time::compare_dates(const artik_time *date1,
     const artik_time *date2) {
   return this->m_module->compare_dates(date1, date2);
@@ -143,3 +184,61 @@ artik_error artik::Time::convert_time_to_timestamp(const artik_time *date,
     int64_t *timestamp) {
   return this->m_module->convert_time_to_timestamp(date, timestamp);
 }
+
+uint64_t artik::Time::get_monotonic_ns(void) const {
+  return this->m_module->get_monotonic_ns();
+}
+
+uint64_t artik::Time::get_monotonic_us(void) const {
+  return this->m_module->get_monotonic_us();
+}
+
+uint64_t artik::Time::get_monotonic_ms(void) const {
+  return this->m_module->get_monotonic_ms();
+}
+
+uint64_t artik::Time::get_elapsed_ns(uint64_t start_ns) const {
+  return this->m_module->get_elapsed_ns(start_ns);
+}
+
+artik::Histogram::Histogram() {
+  this->m_handle = NULL;
+  this->m_module = reinterpret_cast<artik_time_module*>(
+      artik_request_api_module("time"));
+  this->m_module->create_histogram(&this->m_handle);
+}
+
+artik::Histogram::~Histogram() {
+  this->m_module->destroy_histogram(this->m_handle);
+  artik_release_api_module(reinterpret_cast<void*>(this->m_module));
+}
+
+artik_time_histogram artik::Histogram::get_handle(void) const {
+  return this->m_handle;
+}
+
+artik_time_module *artik::Histogram::get_module(void) const {
+  return this->m_module;
+}
+
+artik_error artik::Histogram::record(uint64_t duration_ns) {
+  return this->m_module->record_histogram(this->m_handle, duration_ns);
+}
+
+artik_error artik::Histogram::get_stats(
+    artik_time_histogram_stats *stats) const {
+  return this->m_module->get_histogram_stats(this->m_handle, stats);
+}
+
+artik_error artik::Histogram::reset(void) {
+  return this->m_module->reset_histogram(this->m_handle);
+}
+
+artik::ScopedTimer::ScopedTimer(Histogram const &hist) {
+  this->m_module = hist.get_module();
+  this->m_module->start_timer(hist.get_handle(), &this->m_timer);
+}
+
+artik::ScopedTimer::~ScopedTimer() {
+  this->m_module->stop_timer(&this->m_timer);
+}
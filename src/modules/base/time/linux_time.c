@@ -29,17 +29,12 @@
 #include <sys/eventfd.h>
 #include <poll.h>
 
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-
 #include <artik_module.h>
 #include <artik_log.h>
 #include <artik_time.h>
-#include <artik_loop.h>
 #include "os_time.h"
+#include "alarm_scheduler.h"
+#include "ntp_client.h"
 
 #define LEN_PACK 14
 #define LEN_FORM 8
@@ -54,9 +49,8 @@
 
 #define	FORMAT_NULL ((uint64_t)506381209866536711LL)
 
-#define NTP_PORT 123
-#define NTP_TIMEOUT_SEC 10
-#define EPOCH_BALANCE 2208988800U
+#define NSEC_PER_SEC 1000000000ULL
+#define NSEC_PER_MSEC 1000000ULL
 
 #define MAX(a, b)	((a > b) ? a : b)
 
@@ -65,14 +59,6 @@ typedef struct {
 	char *format_mod;
 } artik_time_parser_t;
 
-typedef struct {
-	artik_time_zone gmt;
-	alarm_callback func;
-	artik_msecond date_alarm;
-	artik_loop_module *loop;
-	int alarm_id;
-} artik_time_alarm_t;
-
 static artik_error os_time_struct_empty(void *data, int len)
 {
 	int *addr = data;
@@ -234,30 +220,23 @@ artik_error os_time_get_time_str(char *date_str, int size, char *const format,
 	return S_OK;
 }
 
-artik_msecond os_time_get_tick(void)
+uint64_t os_time_get_monotonic_ns(void)
 {
-	struct tm val_curr;
-	time_t curr_in_sec = 0;
-	time_t ms_current = 0;
-
-	memset(&val_curr, 0, sizeof(val_curr));
+	struct timespec ts;
 
-	os_time_get_sys(&val_curr, ARTIK_TIME_UTC);
+	/*
+	 * CLOCK_MONOTONIC is served by the vDSO on all the supported kernels
+	 * while CLOCK_MONOTONIC_RAW falls back to a system call on most of
+	 * them. It is slewed but never stepped by NTP.
+	 */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
 
-	ms_current = val_curr.tm_yday;
-
-	val_curr.tm_yday = 0;
-	val_curr.tm_year -= EPOCH_DEF;
-	val_curr.tm_mon++;
-
-	curr_in_sec = mktime(&val_curr);
-
-	if (curr_in_sec == -1)
-		return S_OK;
-
-	curr_in_sec = (curr_in_sec * 1000L) + ((time_t) ms_current / 1000L);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-	return curr_in_sec;
+artik_msecond os_time_get_tick(void)
+{
+	return os_time_get_monotonic_ns() / 1000000ULL;
 }
 
 artik_error os_time_create_alarm_second(artik_time_zone gmt,
@@ -275,35 +254,8 @@ artik_error os_time_create_alarm_second(artik_time_zone gmt,
 	if (!func)
 		return E_BAD_ARGS;
 
-	artik_time_alarm_t *alarm_data = NULL;
-	struct tm curr_usr;
-	time_t curr_in_sec;
-
-	memset(&curr_usr, 1, sizeof(curr_usr));
-	os_time_get_sys(&curr_usr, gmt);
-	curr_usr.tm_yday = 0;
-	curr_usr.tm_year -= EPOCH_DEF;
-	curr_in_sec = mktime(&curr_usr);
-	if (curr_in_sec < 0)
-		return E_BAD_ARGS;
-
-	curr_in_sec += (time_t) second;
-
-	*handle = malloc(sizeof(artik_time_alarm_t));
-
-	alarm_data = *handle;
-	alarm_data->loop = (artik_loop_module *)
-					artik_request_api_module("loop");
-	alarm_data->func = func;
-	alarm_data->gmt = gmt;
-	alarm_data->date_alarm = curr_in_sec;
-
-	if (!alarm_data->loop)
-		return E_BUSY;
-
-	return alarm_data->loop->add_timeout_callback(&alarm_data->alarm_id,
-						(unsigned int)second*1000,
-						func, user_data);
+	return alarm_scheduler_add_delay((uint64_t)second * NSEC_PER_SEC, 0,
+					func, user_data, handle);
 }
 
 artik_error os_time_create_alarm_date(artik_time_zone gmt,
@@ -345,166 +297,103 @@ artik_error os_time_create_alarm_date(artik_time_zone gmt,
 	if ((int)date.msecond < 0)
 		return E_BAD_ARGS;
 
-	time_t date_in_sec = 0, curr_in_sec = 0;
-	double diff_t;
-	struct tm date_usr, curr_usr;
+	time_t date_in_sec;
+	struct tm date_usr;
 
-	memset(&curr_usr, 0, sizeof(curr_usr));
-	os_time_get_sys(&curr_usr, gmt);
-
-	curr_usr.tm_yday = 0;
-	curr_usr.tm_year -= EPOCH_DEF;
-	curr_in_sec = mktime(&curr_usr);
-
-	if (curr_in_sec < 0)
+	memset(&date_usr, 0, sizeof(date_usr));
+	date_usr.tm_sec = date.second;
+	date_usr.tm_min = date.minute;
+	date_usr.tm_hour = date.hour;
+	date_usr.tm_mday = date.day;
+	date_usr.tm_mon = date.month - 1;
+	date_usr.tm_year = date.year - EPOCH_DEF;
+
+	/* The date is expressed in the 'gmt' time zone */
+	date_in_sec = timegm(&date_usr);
+	if (date_in_sec == (time_t)-1)
 		return E_INVALID_VALUE;
 
-	memset(&date_usr, 0, sizeof(date_usr));
-	memcpy(&date_usr, &date, sizeof(date));
+	return alarm_scheduler_add_date((int64_t)date_in_sec - gmt * 3600,
+					func, user_data, handle);
+}
 
-	if (date_usr.tm_year > EPOCH_DEF) {
-		date_usr.tm_year -= EPOCH_DEF;
-		date_usr.tm_mon--;
-	}
+artik_error os_time_create_alarm_msecond(artik_alarm_handle *handle,
+					alarm_callback func,
+					void *user_data,
+					artik_msecond msecond,
+					artik_msecond period)
+{
+	if (!func)
+		return E_BAD_ARGS;
 
-	date_usr.tm_yday = 0;
+	return alarm_scheduler_add_delay((uint64_t)msecond * NSEC_PER_MSEC,
+					(uint64_t)period * NSEC_PER_MSEC,
+					func, user_data, handle);
+}
 
-	date_in_sec = mktime(&date_usr);
+artik_error os_time_create_alarm_cron(artik_time_zone gmt,
+				      artik_alarm_handle *handle,
+				      alarm_callback func,
+				      void *user_data,
+				      const char *schedule)
+{
+	struct alarm_cron cron;
+	artik_error ret;
 
-	if (date_in_sec < 0)
-		return E_INVALID_VALUE;
+	if (gmt < ARTIK_TIME_UTC || gmt > ARTIK_TIME_GMT12)
+		return E_BAD_ARGS;
 
-	diff_t = difftime(date_in_sec, curr_in_sec);
+	if (!func)
+		return E_BAD_ARGS;
+
+	ret = alarm_cron_parse(schedule, &cron);
+	if (ret != S_OK)
+		return ret;
 
-	return os_time_create_alarm_second(gmt, handle, func, user_data,
-		diff_t);
+	return alarm_scheduler_add_cron(&cron, gmt * 3600, func, user_data,
+					handle);
 }
 
 artik_error os_time_delete_alarm(artik_alarm_handle handle)
 {
-	artik_time_alarm_t *alarm_data = handle;
-
-	if (alarm_data)
-		free(handle);
-
-	return S_OK;
+	return alarm_scheduler_remove(handle);
 }
 
 artik_error os_time_get_delay_alarm(artik_alarm_handle handle,
 				    artik_msecond *msecond)
 {
-	artik_time_alarm_t *alarm_data = handle;
-	struct tm curr_usr;
-	artik_msecond curr_in_sec = 0;
-	int res = 0;
-
-	if (!alarm_data)
-		return E_BAD_ARGS;
-
-	memset(&curr_usr, 1, sizeof(curr_usr));
-
-	artik_error ret = os_time_get_sys(&curr_usr, alarm_data->gmt);
+	uint64_t delay_ns;
+	artik_error ret;
 
+	ret = alarm_scheduler_get_delay(handle, &delay_ns);
 	if (ret != S_OK) {
 		*msecond = 0;
 		return ret;
 	}
 
-	curr_usr.tm_year -= EPOCH_DEF;
-	curr_usr.tm_yday = 0;
-	res = mktime(&curr_usr);
-
-	if (res == 0)
-		*msecond = 0;
-	else if (res < 0) {
-		*msecond = 0;
-		return E_INVALID_VALUE;
-	}
-
-	curr_in_sec = res;
-	*msecond = alarm_data->date_alarm <= curr_in_sec ?
-		0 : (alarm_data->date_alarm - curr_in_sec);
+	/* In seconds, rounded up so that 0 means the alarm went off */
+	*msecond = (delay_ns + NSEC_PER_SEC - 1) / NSEC_PER_SEC;
 
 	return S_OK;
 }
 
 artik_error os_time_sync_ntp(const char *hostname)
 {
-	artik_error ret = S_OK;
-	unsigned char msg[48] = { 0xe3, 0, 0, 0, 0, 0, 0, 0, 0 };
-	unsigned long buf[1024];
-
-	int sock;
-	int res;
-
-	struct protoent *proto;
-	struct sockaddr_in server_addr;
-	struct sockaddr saddr;
-	socklen_t saddr_l;
-	struct hostent *host_resolv;
-	struct timeval time_struct = { NTP_TIMEOUT_SEC, 0 };
-
-	log_dbg("");
 	if (!hostname)
 		return E_BAD_ARGS;
-	proto = getprotobyname("udp");
-	sock = socket(PF_INET, SOCK_DGRAM, proto->p_proto);
-	if (sock < 0) {
-		log_err("Failed to open socket");
-		return E_BAD_ARGS;
-	}
-
-	if (setsockopt
-	    (sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&time_struct,
-	     sizeof(time_struct)) < 0) {
-		log_err("Failed to set socket options");
-		ret = E_BAD_ARGS;
-		goto exit;
-	}
-
-	memset(&server_addr, 0, sizeof(server_addr));
-	server_addr.sin_family = AF_INET;
-	host_resolv = gethostbyname(hostname);
-	if (!host_resolv) {
-		log_err("Failed to resolve host name");
-		ret = E_HTTP_ERROR;
-		goto exit;
-	}
 
-	server_addr.sin_addr.s_addr =
-	    inet_addr(inet_ntoa
-		      (*(struct in_addr *)host_resolv->h_addr_list[0]));
-	server_addr.sin_port = htons(NTP_PORT);
-
-	res =
-	    sendto(sock, msg, sizeof(msg), 0, (struct sockaddr *)&server_addr,
-		   sizeof(server_addr));
-	if (res != 48) {
-		log_err("Failed to send request to socket");
-		ret = E_BAD_ARGS;
-		goto exit;
-	}
-
-	saddr_l = sizeof(saddr);
-	res = recvfrom(sock, buf, 48, 0, &saddr, &saddr_l);
-	if (res != 48) {
-		log_err("Timeout on receiving response over the socket");
-		ret = E_BAD_ARGS;
-		goto exit;
-	}
-
-	time_struct.tv_sec = ntohl((time_t) buf[4]) - EPOCH_BALANCE;
-	res = settimeofday(&time_struct, NULL);
-	if (res != 0) {
-		log_err("Failed to set new time");
-		ret = E_BAD_ARGS;
-		goto exit;
-	}
+	return ntp_sync(hostname);
+}
 
-exit:
-	close(sock);
+artik_error os_time_sync_ntp_async(const artik_time_ntp_config *config,
+				   ntp_callback func, void *user_data)
+{
+	return ntp_sync_async(config, func, user_data);
+}
 
-	return ret;
+artik_error os_time_get_ntp_stats(artik_time_ntp_stats *stats)
+{
+	return ntp_get_stats(stats);
 }
 
 artik_error os_time_convert_timestamp_to_time(const int64_t timestamp,
@@ -0,0 +1,830 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/timex.h>
+
+#include <artik_module.h>
+#include <artik_log.h>
+#include <artik_loop.h>
+
+#include "ntp_client.h"
+
+#define NTP_PORT		"123"
+#define NTP_PACKET_SIZE		48
+#define NTP_EPOCH_OFFSET	2208988800LL
+#define NTP_DEFAULT_SAMPLES	4
+#define NTP_MAX_SAMPLES		8
+#define NTP_DEFAULT_TIMEOUT_MS	10000
+/* Requests not answered within NTP_RETRY_MS are sent again */
+#define NTP_RETRY_MS		1000
+#define NTP_TICK_MS		250
+/* Lower bound of the round trip in the root distance (RFC 5905 MINDISP) */
+#define NTP_MIN_DELAY_NS	10000000LL
+#define NTP_MAX_HOST		256
+
+#define NSEC_PER_SEC		1000000000LL
+#define NSEC_PER_MSEC		1000000LL
+
+/* Packet fields */
+#define NTP_LI(b)		((b) >> 6)
+#define NTP_MODE(b)		((b) & 0x7)
+#define NTP_LI_ALARM		3
+#define NTP_MODE_CLIENT		3
+#define NTP_MODE_SERVER		4
+#define NTP_VERSION		4
+#define NTP_MAX_STRATUM		15
+#define NTP_ROOT_DELAY		4
+#define NTP_ROOT_DISPERSION	8
+#define NTP_ORIGIN		24
+#define NTP_RECEIVE		32
+#define NTP_TRANSMIT		40
+
+struct ntp_sample {
+	int64_t offset;
+	int64_t delay;
+	/* Distance of the server to its reference clock */
+	int64_t dispersion;
+};
+
+struct ntp_session;
+
+struct ntp_peer {
+	struct ntp_session *session;
+	char *server;
+	int fd;
+	int watch_id;
+	/* Transmit timestamp of the pending request, 0 if none */
+	uint64_t cookie;
+	int64_t sent;
+	int64_t sent_mono;
+	struct ntp_sample samples[NTP_MAX_SAMPLES];
+	unsigned int num_samples;
+	bool done;
+	/* Clock filter output */
+	struct ntp_sample best;
+	int64_t jitter;
+	int64_t distance;
+};
+
+struct ntp_session {
+	struct ntp_peer *peers;
+	unsigned int num_peers;
+	unsigned int samples;
+	unsigned int pending;
+	int64_t deadline;
+	bool dry_run;
+	ntp_callback func;
+	void *user_data;
+	artik_loop_module *loop;
+	pthread_t resolver;
+	int pipe[2];
+	int pipe_watch;
+	int tick_id;
+};
+
+struct ntp_endpoint {
+	int64_t value;
+	int type;	/* -1 low, 0 offset, 1 high */
+};
+
+static pthread_mutex_t ntp_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct ntp_session *ntp_session;
+static artik_time_ntp_stats ntp_last_stats;
+static bool ntp_has_stats;
+
+static int64_t _now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static uint32_t _get_u32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+		((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t _get_u64(const uint8_t *p)
+{
+	return ((uint64_t)_get_u32(p) << 32) | _get_u32(p + 4);
+}
+
+static void _put_u64(uint8_t *p, uint64_t value)
+{
+	int i;
+
+	for (i = 7; i >= 0; i--) {
+		p[i] = value & 0xff;
+		value >>= 8;
+	}
+}
+
+static uint64_t _to_ntp(int64_t ns)
+{
+	uint64_t sec = ns / NSEC_PER_SEC + NTP_EPOCH_OFFSET;
+	uint64_t frac = ((uint64_t)(ns % NSEC_PER_SEC) << 32) / NSEC_PER_SEC;
+
+	return (sec << 32) | frac;
+}
+
+static int64_t _from_ntp(uint64_t ts)
+{
+	int64_t sec = (int64_t)(ts >> 32) - NTP_EPOCH_OFFSET;
+
+	/* Era 1 starts in 2036 */
+	if (sec < 0)
+		sec += 1LL << 32;
+
+	return sec * NSEC_PER_SEC +
+		(int64_t)(((ts & 0xffffffff) * NSEC_PER_SEC) >> 32);
+}
+
+/* 16.16 fixed point seconds */
+static int64_t _from_short(uint32_t value)
+{
+	return (int64_t)(((uint64_t)value * NSEC_PER_SEC) >> 16);
+}
+
+static int _send_request(struct ntp_peer *peer)
+{
+	uint8_t pkt[NTP_PACKET_SIZE];
+
+	memset(pkt, 0, sizeof(pkt));
+	pkt[0] = (NTP_VERSION << 3) | NTP_MODE_CLIENT;
+
+	/* The server echoes the transmit timestamp as origin timestamp */
+	peer->sent = _now(CLOCK_REALTIME);
+	peer->sent_mono = _now(CLOCK_MONOTONIC);
+	peer->cookie = _to_ntp(peer->sent);
+	_put_u64(pkt + NTP_TRANSMIT, peer->cookie);
+
+	if (send(peer->fd, pkt, sizeof(pkt), 0) != sizeof(pkt)) {
+		log_dbg("Failed to send request to %s (%d)", peer->server,
+			errno);
+		return -1;
+	}
+
+	return 0;
+}
+
+static bool _parse_reply(struct ntp_peer *peer, const uint8_t *pkt,
+			ssize_t len, int64_t received)
+{
+	struct ntp_sample *sample = &peer->samples[peer->num_samples];
+	int64_t t1, t2, t3, t4;
+
+	if (len < NTP_PACKET_SIZE || !peer->cookie)
+		return false;
+
+	if (NTP_MODE(pkt[0]) != NTP_MODE_SERVER ||
+			NTP_LI(pkt[0]) == NTP_LI_ALARM ||
+			pkt[1] == 0 || pkt[1] > NTP_MAX_STRATUM)
+		return false;
+
+	/* Reply to another request, or spoofed */
+	if (_get_u64(pkt + NTP_ORIGIN) != peer->cookie ||
+			!_get_u64(pkt + NTP_TRANSMIT))
+		return false;
+
+	t1 = peer->sent;
+	t2 = _from_ntp(_get_u64(pkt + NTP_RECEIVE));
+	t3 = _from_ntp(_get_u64(pkt + NTP_TRANSMIT));
+	t4 = received;
+
+	sample->offset = ((t2 - t1) + (t3 - t4)) / 2;
+	sample->delay = (t4 - t1) - (t3 - t2);
+	if (sample->delay < 0)
+		sample->delay = 0;
+	sample->dispersion =
+		_from_short(_get_u32(pkt + NTP_ROOT_DELAY)) / 2 +
+		_from_short(_get_u32(pkt + NTP_ROOT_DISPERSION));
+
+	peer->cookie = 0;
+	peer->num_samples++;
+
+	return true;
+}
+
+static uint64_t _sqrt(double value)
+{
+	uint64_t v = value > 0 ? (uint64_t)value : 0;
+	uint64_t root = 0, bit = 1ULL << 62;
+
+	while (bit > v)
+		bit >>= 2;
+
+	while (bit) {
+		if (v >= root + bit) {
+			v -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+/* Keep the sample with the shortest round trip, it is the most accurate */
+static void _filter(struct ntp_peer *peer)
+{
+	double sum = 0;
+	unsigned int i;
+
+	peer->best = peer->samples[0];
+	for (i = 1; i < peer->num_samples; i++)
+		if (peer->samples[i].delay < peer->best.delay)
+			peer->best = peer->samples[i];
+
+	for (i = 0; i < peer->num_samples; i++) {
+		double diff = peer->samples[i].offset - peer->best.offset;
+
+		sum += diff * diff;
+	}
+
+	peer->jitter = peer->num_samples > 1 ?
+		_sqrt(sum / (peer->num_samples - 1)) : 0;
+	peer->distance = (peer->best.delay > NTP_MIN_DELAY_NS ?
+		peer->best.delay : NTP_MIN_DELAY_NS) / 2 +
+		peer->best.dispersion + peer->jitter;
+}
+
+static int _compare_endpoints(const void *a, const void *b)
+{
+	const struct ntp_endpoint *ea = a, *eb = b;
+
+	if (ea->value != eb->value)
+		return ea->value < eb->value ? -1 : 1;
+
+	return ea->type - eb->type;
+}
+
+/*
+ * Find the intersection of the correctness intervals [offset - distance,
+ * offset + distance] shared by the largest majority of the servers, the
+ * servers whose offset lies outside of it are falsetickers.
+ */
+static bool _select(struct ntp_peer **peers, unsigned int n, int64_t *low,
+			int64_t *high)
+{
+	struct ntp_endpoint *e;
+	unsigned int allow, i;
+	bool found_interval = false;
+
+	e = malloc(3 * n * sizeof(*e));
+	if (!e)
+		return false;
+
+	for (i = 0; i < n; i++) {
+		e[3 * i].value = peers[i]->best.offset - peers[i]->distance;
+		e[3 * i].type = -1;
+		e[3 * i + 1].value = peers[i]->best.offset;
+		e[3 * i + 1].type = 0;
+		e[3 * i + 2].value = peers[i]->best.offset + peers[i]->distance;
+		e[3 * i + 2].type = 1;
+	}
+	qsort(e, 3 * n, sizeof(*e), _compare_endpoints);
+
+	for (allow = 0; 2 * allow < n && !found_interval; allow++) {
+		unsigned int found = 0;
+		int chime = 0;
+		int j;
+
+		for (j = 0; j < (int)(3 * n); j++) {
+			chime -= e[j].type;
+			if (chime >= (int)(n - allow)) {
+				*low = e[j].value;
+				break;
+			}
+			if (!e[j].type)
+				found++;
+		}
+
+		chime = 0;
+		for (j = 3 * n - 1; j >= 0; j--) {
+			chime += e[j].type;
+			if (chime >= (int)(n - allow)) {
+				*high = e[j].value;
+				break;
+			}
+			if (!e[j].type)
+				found++;
+		}
+
+		found_interval = found <= allow && *low <= *high;
+	}
+
+	free(e);
+
+	return found_interval;
+}
+
+static artik_error _combine(struct ntp_peer *peers, unsigned int num_peers,
+			artik_time_ntp_stats *stats)
+{
+	struct ntp_peer **valid, *sys_peer = NULL;
+	double weights = 0, offset = 0, jitter = 0;
+	int64_t low = 0, high = 0;
+	unsigned int n = 0, i;
+
+	memset(stats, 0, sizeof(*stats));
+
+	valid = malloc(num_peers * sizeof(*valid));
+	if (!valid)
+		return E_NO_MEM;
+
+	for (i = 0; i < num_peers; i++) {
+		if (!peers[i].num_samples)
+			continue;
+		_filter(&peers[i]);
+		stats->samples += peers[i].num_samples;
+		valid[n++] = &peers[i];
+	}
+	stats->servers = n;
+
+	if (!n) {
+		free(valid);
+		return E_TIMEOUT;
+	}
+
+	if (!_select(valid, n, &low, &high)) {
+		log_err("NTP servers do not agree on the time");
+		free(valid);
+		return E_INVALID_VALUE;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ntp_peer *peer = valid[i];
+		double weight;
+
+		if (peer->best.offset < low || peer->best.offset > high)
+			continue;
+
+		weight = 1.0 / peer->distance;
+		weights += weight;
+		offset += weight * peer->best.offset;
+		stats->survivors++;
+		if (!sys_peer || peer->distance < sys_peer->distance)
+			sys_peer = peer;
+	}
+	offset /= weights;
+
+	for (i = 0; i < n; i++) {
+		struct ntp_peer *peer = valid[i];
+		double diff = peer->best.offset - sys_peer->best.offset;
+
+		if (peer->best.offset < low || peer->best.offset > high)
+			continue;
+		jitter += diff * diff / peer->distance;
+	}
+	jitter = jitter / weights + (double)sys_peer->jitter * sys_peer->jitter;
+
+	stats->offset_ns = (int64_t)offset;
+	stats->delay_ns = sys_peer->best.delay;
+	stats->jitter_ns = _sqrt(jitter);
+
+	free(valid);
+
+	return S_OK;
+}
+
+static artik_error _apply(artik_time_ntp_stats *stats)
+{
+	if (llabs(stats->offset_ns) < NTP_STEP_THRESHOLD_NS) {
+		struct timex tx;
+
+		/* Slewed by the kernel, timers are not disturbed */
+		memset(&tx, 0, sizeof(tx));
+		tx.modes = ADJ_OFFSET_SINGLESHOT;
+		tx.offset = stats->offset_ns / 1000;
+		if (adjtimex(&tx) < 0) {
+			log_err("Failed to slew the clock (%d)", errno);
+			return errno == EPERM ? E_ACCESS_DENIED : E_BAD_ARGS;
+		}
+	} else {
+		int64_t now = _now(CLOCK_REALTIME) + stats->offset_ns;
+		struct timespec ts;
+
+		ts.tv_sec = now / NSEC_PER_SEC;
+		ts.tv_nsec = now % NSEC_PER_SEC;
+		if (clock_settime(CLOCK_REALTIME, &ts) < 0) {
+			log_err("Failed to set new time (%d)", errno);
+			return errno == EPERM ? E_ACCESS_DENIED : E_BAD_ARGS;
+		}
+		stats->stepped = true;
+	}
+
+	stats->adjusted = true;
+
+	return S_OK;
+}
+
+static artik_error _conclude(struct ntp_peer *peers, unsigned int num_peers,
+			bool dry_run, artik_time_ntp_stats *stats)
+{
+	artik_error ret;
+
+	ret = _combine(peers, num_peers, stats);
+	if (ret == S_OK && !dry_run)
+		ret = _apply(stats);
+
+	if (ret == S_OK) {
+		pthread_mutex_lock(&ntp_lock);
+		ntp_last_stats = *stats;
+		ntp_has_stats = true;
+		pthread_mutex_unlock(&ntp_lock);
+		log_dbg("NTP offset %lld ns, delay %llu ns, jitter %llu ns",
+			(long long)stats->offset_ns,
+			(unsigned long long)stats->delay_ns,
+			(unsigned long long)stats->jitter_ns);
+	}
+
+	return ret;
+}
+
+/* Accepts "host", "host:port" and "[ipv6]:port" */
+static int _connect(const char *server)
+{
+	char host[NTP_MAX_HOST];
+	const char *port = NTP_PORT;
+	struct addrinfo hints, *res, *ai;
+	char *sep;
+	int fd = -1;
+
+	if (strlen(server) >= sizeof(host))
+		return -1;
+	strcpy(host, server);
+
+	if (host[0] == '[') {
+		sep = strchr(host, ']');
+		if (!sep)
+			return -1;
+		*sep = '\0';
+		if (sep[1] == ':')
+			port = sep + 2;
+		memmove(host, host + 1, strlen(host));
+	} else {
+		sep = strchr(host, ':');
+		if (sep && !strchr(sep + 1, ':')) {
+			*sep = '\0';
+			port = sep + 1;
+		}
+	}
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	if (getaddrinfo(host, port, &hints, &res)) {
+		log_err("Failed to resolve %s", server);
+		return -1;
+	}
+
+	for (ai = res; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK |
+				SOCK_CLOEXEC, ai->ai_protocol);
+		if (fd < 0)
+			continue;
+		/* Only replies from the server are received */
+		if (!connect(fd, ai->ai_addr, ai->ai_addrlen))
+			break;
+		close(fd);
+		fd = -1;
+	}
+
+	freeaddrinfo(res);
+
+	return fd;
+}
+
+artik_error ntp_sync(const char *hostname)
+{
+	artik_time_ntp_stats stats;
+	struct ntp_peer peer;
+	int64_t deadline;
+
+	memset(&peer, 0, sizeof(peer));
+	peer.server = (char *)hostname;
+	peer.fd = _connect(hostname);
+	if (peer.fd < 0)
+		return E_HTTP_ERROR;
+
+	deadline = _now(CLOCK_MONOTONIC) +
+		NTP_DEFAULT_TIMEOUT_MS * NSEC_PER_MSEC;
+
+	while (peer.num_samples < NTP_DEFAULT_SAMPLES) {
+		uint8_t pkt[NTP_PACKET_SIZE * 2];
+		struct pollfd pfd = { peer.fd, POLLIN, 0 };
+		int64_t left = deadline - _now(CLOCK_MONOTONIC);
+		int timeout = NTP_RETRY_MS;
+		ssize_t len;
+
+		if (left <= 0)
+			break;
+		if (left < timeout * NSEC_PER_MSEC)
+			timeout = left / NSEC_PER_MSEC + 1;
+
+		if (!peer.cookie || _now(CLOCK_MONOTONIC) - peer.sent_mono >=
+				NTP_RETRY_MS * NSEC_PER_MSEC)
+			_send_request(&peer);
+
+		if (poll(&pfd, 1, timeout) <= 0)
+			continue;
+
+		len = recv(peer.fd, pkt, sizeof(pkt), 0);
+		_parse_reply(&peer, pkt, len, _now(CLOCK_REALTIME));
+	}
+
+	close(peer.fd);
+
+	if (!peer.num_samples) {
+		log_err("Timeout on receiving response from %s", hostname);
+		return E_TIMEOUT;
+	}
+
+	return _conclude(&peer, 1, false, &stats);
+}
+
+static void _finish(struct ntp_session *s, artik_error ret)
+{
+	artik_time_ntp_stats stats;
+	unsigned int i;
+
+	if (s->tick_id)
+		s->loop->remove_periodic_callback(s->tick_id);
+
+	for (i = 0; i < s->num_peers; i++) {
+		if (s->peers[i].watch_id)
+			s->loop->remove_fd_watch(s->peers[i].watch_id);
+		if (s->peers[i].fd >= 0)
+			close(s->peers[i].fd);
+	}
+
+	if (ret == S_OK)
+		ret = _conclude(s->peers, s->num_peers, s->dry_run, &stats);
+	else
+		memset(&stats, 0, sizeof(stats));
+
+	pthread_mutex_lock(&ntp_lock);
+	ntp_session = NULL;
+	pthread_mutex_unlock(&ntp_lock);
+
+	/* A new synchronization may be started from the callback */
+	s->func(ret, &stats, s->user_data);
+
+	for (i = 0; i < s->num_peers; i++)
+		free(s->peers[i].server);
+	free(s->peers);
+	artik_release_api_module(s->loop);
+	free(s);
+}
+
+static int _on_reply(int fd, enum watch_io io, void *user_data)
+{
+	struct ntp_peer *peer = user_data;
+	struct ntp_session *s = peer->session;
+	uint8_t pkt[NTP_PACKET_SIZE * 2];
+	ssize_t len;
+
+	while (!peer->done && (len = recv(fd, pkt, sizeof(pkt), 0)) >= 0) {
+		if (!_parse_reply(peer, pkt, len, _now(CLOCK_REALTIME)))
+			continue;
+
+		if (peer->num_samples < s->samples)
+			_send_request(peer);
+		else
+			peer->done = true;
+	}
+
+	if (!peer->done)
+		return 1;
+
+	s->loop->remove_fd_watch(peer->watch_id);
+	peer->watch_id = 0;
+
+	if (!--s->pending)
+		_finish(s, S_OK);
+
+	return 0;
+}
+
+static int _on_tick(void *user_data)
+{
+	struct ntp_session *s = user_data;
+	int64_t now = _now(CLOCK_MONOTONIC);
+	unsigned int i;
+
+	if (now >= s->deadline) {
+		/* Conclude with the samples received so far */
+		s->tick_id = 0;
+		_finish(s, S_OK);
+		return 0;
+	}
+
+	for (i = 0; i < s->num_peers; i++) {
+		struct ntp_peer *peer = &s->peers[i];
+
+		if (peer->watch_id && !peer->done &&
+			now - peer->sent_mono >= NTP_RETRY_MS * NSEC_PER_MSEC)
+			_send_request(peer);
+	}
+
+	return 1;
+}
+
+static void *_resolve(void *user_data)
+{
+	struct ntp_session *s = user_data;
+	unsigned int i;
+	char c = 0;
+
+	for (i = 0; i < s->num_peers; i++)
+		s->peers[i].fd = _connect(s->peers[i].server);
+
+	if (write(s->pipe[1], &c, 1) != 1)
+		log_err("Failed to notify the end of name resolution");
+
+	return NULL;
+}
+
+static int _on_resolved(int fd, enum watch_io io, void *user_data)
+{
+	struct ntp_session *s = user_data;
+	unsigned int i;
+
+	pthread_join(s->resolver, NULL);
+	s->loop->remove_fd_watch(s->pipe_watch);
+	close(s->pipe[0]);
+	close(s->pipe[1]);
+
+	for (i = 0; i < s->num_peers; i++) {
+		struct ntp_peer *peer = &s->peers[i];
+
+		if (peer->fd < 0)
+			continue;
+		if (s->loop->add_fd_watch(peer->fd, WATCH_IO_IN, _on_reply,
+					peer, &peer->watch_id) != S_OK) {
+			peer->watch_id = 0;
+			continue;
+		}
+		s->pending++;
+		_send_request(peer);
+	}
+
+	if (!s->pending) {
+		_finish(s, E_HTTP_ERROR);
+		return 0;
+	}
+
+	if (s->loop->add_periodic_callback(&s->tick_id, NTP_TICK_MS, _on_tick,
+					s) != S_OK) {
+		s->tick_id = 0;
+		_finish(s, E_BUSY);
+	}
+
+	return 0;
+}
+
+artik_error ntp_sync_async(const artik_time_ntp_config *config,
+			ntp_callback func, void *user_data)
+{
+	struct ntp_session *s;
+	artik_error ret = E_NO_MEM;
+	unsigned int i;
+
+	if (!config || !config->servers || !config->num_servers || !func ||
+			config->samples > NTP_MAX_SAMPLES)
+		return E_BAD_ARGS;
+
+	for (i = 0; i < config->num_servers; i++)
+		if (!config->servers[i])
+			return E_BAD_ARGS;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return E_NO_MEM;
+
+	s->samples = config->samples ? config->samples : NTP_DEFAULT_SAMPLES;
+	s->deadline = _now(CLOCK_MONOTONIC) + (config->timeout_ms ?
+			config->timeout_ms : NTP_DEFAULT_TIMEOUT_MS) *
+			NSEC_PER_MSEC;
+	s->dry_run = config->dry_run;
+	s->func = func;
+	s->user_data = user_data;
+	s->pipe[0] = s->pipe[1] = -1;
+
+	s->peers = calloc(config->num_servers, sizeof(*s->peers));
+	if (!s->peers)
+		goto error;
+	s->num_peers = config->num_servers;
+
+	for (i = 0; i < s->num_peers; i++) {
+		s->peers[i].session = s;
+		s->peers[i].fd = -1;
+		s->peers[i].server = strdup(config->servers[i]);
+		if (!s->peers[i].server)
+			goto error;
+	}
+
+	s->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!s->loop) {
+		ret = E_NOT_SUPPORTED;
+		goto error;
+	}
+
+	pthread_mutex_lock(&ntp_lock);
+	if (ntp_session) {
+		pthread_mutex_unlock(&ntp_lock);
+		ret = E_BUSY;
+		goto error;
+	}
+	ntp_session = s;
+	pthread_mutex_unlock(&ntp_lock);
+
+	/* Name resolution blocks, it is done from a thread */
+	if (pipe2(s->pipe, O_CLOEXEC) < 0) {
+		ret = E_BUSY;
+		goto error_session;
+	}
+
+	ret = s->loop->add_fd_watch(s->pipe[0], WATCH_IO_IN, _on_resolved, s,
+				&s->pipe_watch);
+	if (ret != S_OK)
+		goto error_session;
+
+	if (pthread_create(&s->resolver, NULL, _resolve, s)) {
+		s->loop->remove_fd_watch(s->pipe_watch);
+		ret = E_BUSY;
+		goto error_session;
+	}
+
+	return S_OK;
+
+error_session:
+	pthread_mutex_lock(&ntp_lock);
+	ntp_session = NULL;
+	pthread_mutex_unlock(&ntp_lock);
+error:
+	if (s->pipe[0] >= 0) {
+		close(s->pipe[0]);
+		close(s->pipe[1]);
+	}
+	if (s->loop)
+		artik_release_api_module(s->loop);
+	if (s->peers) {
+		for (i = 0; i < s->num_peers; i++)
+			free(s->peers[i].server);
+		free(s->peers);
+	}
+	free(s);
+
+	return ret;
+}
+
+artik_error ntp_get_stats(artik_time_ntp_stats *stats)
+{
+	artik_error ret = S_OK;
+
+	pthread_mutex_lock(&ntp_lock);
+	if (ntp_has_stats)
+		*stats = ntp_last_stats;
+	else
+		ret = E_NOT_INITIALIZED;
+	pthread_mutex_unlock(&ntp_lock);
+
+	return ret;
+}
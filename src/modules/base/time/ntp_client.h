@@ -0,0 +1,45 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef _NTP_CLIENT_H_
+#define _NTP_CLIENT_H_
+
+#include <artik_error.h>
+#include <artik_time.h>
+
+/*
+ * SNTP client of the Time module on Linux.
+ *
+ * Each server is sampled several times and its sample with the shortest
+ * round trip is kept, as in the RFC 5905 clock filter. The servers whose
+ * correctness interval does not intersect the one of the majority are
+ * discarded (clock select), and the offsets of the others are averaged,
+ * weighted by their root distance (clock combine). Offsets below
+ * NTP_STEP_THRESHOLD_NS are slewed with adjtimex(), larger ones step the
+ * clock.
+ */
+#define NTP_STEP_THRESHOLD_NS	128000000LL
+
+/* Query 'hostname' and correct the clock, blocking until done */
+artik_error ntp_sync(const char *hostname);
+/* Same from the loop for several servers, 'func' is called once done */
+artik_error ntp_sync_async(const artik_time_ntp_config *config,
+			ntp_callback func, void *user_data);
+artik_error ntp_get_stats(artik_time_ntp_stats *stats);
+
+#endif /* _NTP_CLIENT_H_ */
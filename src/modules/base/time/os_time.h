@@ -29,6 +29,7 @@ artik_error  os_time_get_time(artik_time_zone gmt, artik_time *date);
 artik_error os_time_get_time_str(char *date_str, int size, char *const format,
 				artik_time_zone gmt);
 artik_msecond os_time_get_tick(void);
+uint64_t os_time_get_monotonic_ns(void);
 artik_error os_time_create_alarm_second(artik_time_zone gmt,
 					artik_alarm_handle *handle,
 					alarm_callback func, void *user_data,
@@ -37,10 +38,21 @@ artik_error os_time_create_alarm_date(artik_time_zone gmt,
 				artik_alarm_handle *handle,
 				alarm_callback func, void *user_data,
 				artik_time date);
+artik_error os_time_create_alarm_msecond(artik_alarm_handle *handle,
+					alarm_callback func, void *user_data,
+					artik_msecond msecond,
+					artik_msecond period);
+artik_error os_time_create_alarm_cron(artik_time_zone gmt,
+				artik_alarm_handle *handle,
+				alarm_callback func, void *user_data,
+				const char *schedule);
 artik_error os_time_delete_alarm(artik_alarm_handle handle);
 artik_error os_time_get_delay_alarm(artik_alarm_handle handle,
 				    artik_msecond *msecond);
 artik_error os_time_sync_ntp(const char *hostname);
+artik_error os_time_sync_ntp_async(const artik_time_ntp_config *config,
+				   ntp_callback func, void *user_data);
+artik_error os_time_get_ntp_stats(artik_time_ntp_stats *stats);
 artik_error os_time_convert_timestamp_to_time(const int64_t timestamp,
 					      artik_time *date);
 artik_error os_time_convert_time_to_timestamp(const artik_time *date,
@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "time_histogram.h"
+
+/*
+ * Durations below 8ns have their own bucket, then each power of two is
+ * split in 8 buckets, up to 2^64 - 1.
+ */
+#define SUB_BUCKET_BITS		3
+#define SUB_BUCKETS		(1 << SUB_BUCKET_BITS)
+#define NUM_BUCKETS		((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+struct time_histogram {
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t buckets[NUM_BUCKETS];
+};
+
+static unsigned int _bucket_index(uint64_t value)
+{
+	unsigned int exp;
+
+	if (value < SUB_BUCKETS)
+		return value;
+
+	exp = 63 - __builtin_clzll(value);
+
+	return (exp - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+		((value >> (exp - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/* Middle of the range of durations counted in a bucket */
+static uint64_t _bucket_value(unsigned int index)
+{
+	unsigned int shift;
+	uint64_t low;
+
+	if (index < SUB_BUCKETS)
+		return index;
+
+	shift = index / SUB_BUCKETS - 1;
+	low = (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+
+	return low + ((1ULL << shift) >> 1);
+}
+
+static void _reset(struct time_histogram *h)
+{
+	memset(h, 0, sizeof(*h));
+	h->min = UINT64_MAX;
+}
+
+artik_error time_histogram_create(artik_time_histogram *hist)
+{
+	struct time_histogram *h;
+
+	if (!hist)
+		return E_BAD_ARGS;
+
+	h = malloc(sizeof(*h));
+	if (!h)
+		return E_NO_MEM;
+
+	_reset(h);
+	*hist = h;
+
+	return S_OK;
+}
+
+artik_error time_histogram_destroy(artik_time_histogram hist)
+{
+	if (!hist)
+		return E_BAD_ARGS;
+
+	free(hist);
+
+	return S_OK;
+}
+
+void time_histogram_record(artik_time_histogram hist, uint64_t duration_ns)
+{
+	struct time_histogram *h = hist;
+	uint64_t cur;
+
+	__atomic_fetch_add(&h->buckets[_bucket_index(duration_ns)], 1,
+			__ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->sum, duration_ns, __ATOMIC_RELAXED);
+
+	cur = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+	while (duration_ns < cur &&
+		!__atomic_compare_exchange_n(&h->min, &cur, duration_ns, true,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	cur = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+	while (duration_ns > cur &&
+		!__atomic_compare_exchange_n(&h->max, &cur, duration_ns, true,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+artik_error time_histogram_get_stats(artik_time_histogram hist,
+				artik_time_histogram_stats *stats)
+{
+	struct time_histogram *h = hist;
+	uint64_t p50, p90, p99;
+	uint64_t seen = 0;
+	unsigned int i;
+
+	if (!h || !stats)
+		return E_BAD_ARGS;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (i = 0; i < NUM_BUCKETS; i++)
+		stats->count += __atomic_load_n(&h->buckets[i],
+						__ATOMIC_RELAXED);
+	if (!stats->count)
+		return S_OK;
+
+	stats->min_ns = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+	stats->max_ns = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+	stats->mean_ns = __atomic_load_n(&h->sum, __ATOMIC_RELAXED) /
+		stats->count;
+
+	/* In case durations are recorded while the buckets are read */
+	stats->p50_ns = stats->max_ns;
+	stats->p90_ns = stats->max_ns;
+	stats->p99_ns = stats->max_ns;
+
+	/* Rank of each percentile, rounded up */
+	p50 = (stats->count * 50 + 99) / 100;
+	p90 = (stats->count * 90 + 99) / 100;
+	p99 = (stats->count * 99 + 99) / 100;
+
+	for (i = 0; i < NUM_BUCKETS && seen < p99; i++) {
+		uint64_t n = __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+		uint64_t value;
+
+		if (!n)
+			continue;
+
+		value = _bucket_value(i);
+		if (value < stats->min_ns)
+			value = stats->min_ns;
+		if (value > stats->max_ns)
+			value = stats->max_ns;
+
+		if (seen < p50 && seen + n >= p50)
+			stats->p50_ns = value;
+		if (seen < p90 && seen + n >= p90)
+			stats->p90_ns = value;
+		if (seen < p99 && seen + n >= p99)
+			stats->p99_ns = value;
+		seen += n;
+	}
+
+	return S_OK;
+}
+
+artik_error time_histogram_reset(artik_time_histogram hist)
+{
+	if (!hist)
+		return E_BAD_ARGS;
+
+	_reset(hist);
+
+	return S_OK;
+}
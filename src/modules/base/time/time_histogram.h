@@ -0,0 +1,40 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef _TIME_HISTOGRAM_H_
+#define _TIME_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <artik_error.h>
+#include <artik_time.h>
+
+/*
+ * Lock-free histograms of durations backing the Time API instrumentation.
+ *
+ * Durations are counted in buckets of 1/8 of a power of two, so that any
+ * percentile is known within 12.5% whatever the range of the durations.
+ */
+artik_error time_histogram_create(artik_time_histogram *hist);
+artik_error time_histogram_destroy(artik_time_histogram hist);
+void time_histogram_record(artik_time_histogram hist, uint64_t duration_ns);
+artik_error time_histogram_get_stats(artik_time_histogram hist,
+				artik_time_histogram_stats *stats);
+artik_error time_histogram_reset(artik_time_histogram hist);
+
+#endif /* _TIME_HISTOGRAM_H_ */
@@ -208,22 +208,22 @@ artik_error os_time_get_time_str(char *date_str, int size,
 	return S_OK;
 }
 
-artik_msecond os_time_get_tick(void)
+uint64_t os_time_get_monotonic_ns(void)
 {
-	struct tm val_curr = {0, };
-	unsigned int ms_current;
-
-	time_t curr_in_sec  = 0;
+	struct timespec ts;
 
-	os_time_get_sys(&val_curr, ARTIK_TIME_UTC, &ms_current);
-
-	curr_in_sec = mktime(&val_curr);
+#ifdef CONFIG_CLOCK_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	clock_gettime(CLOCK_REALTIME, &ts);
+#endif
 
-	if (curr_in_sec == -1)
-		return S_OK;
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-	curr_in_sec = (curr_in_sec*1000L)+((time_t)ms_current / 1000L);
-	return curr_in_sec;
+artik_msecond os_time_get_tick(void)
+{
+	return os_time_get_monotonic_ns() / 1000000ULL;
 }
 
 artik_error os_time_create_alarm_second(artik_time_zone gmt,
@@ -245,6 +245,24 @@ artik_error os_time_create_alarm_date(artik_time_zone gmt,
 	return E_NOT_SUPPORTED;
 }
 
+artik_error os_time_create_alarm_msecond(artik_alarm_handle *handle,
+					alarm_callback func,
+					void *user_data,
+					artik_msecond msecond,
+					artik_msecond period)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_time_create_alarm_cron(artik_time_zone gmt,
+				      artik_alarm_handle *handle,
+				      alarm_callback func,
+				      void *user_data,
+				      const char *schedule)
+{
+	return E_NOT_SUPPORTED;
+}
+
 artik_error os_time_delete_alarm(artik_alarm_handle handle)
 {
 	return E_NOT_SUPPORTED;
@@ -260,6 +278,17 @@ artik_error os_time_sync_ntp(const char *hostname)
 	return E_NOT_SUPPORTED;
 }
 
+artik_error os_time_sync_ntp_async(const artik_time_ntp_config *config,
+				   ntp_callback func, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_time_get_ntp_stats(artik_time_ntp_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
+
 artik_error os_time_convert_timestamp_to_time(const int64_t timestamp,
 					  artik_time *date)
 {
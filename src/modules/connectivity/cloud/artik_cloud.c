@@ -27,6 +27,7 @@
 #include <artik_cloud.h>
 #include <artik_log.h>
 #include <artik_list.h>
+#include <artik_indexed_list.h>
 #include <artik_loop.h>
 
 #define ARTIK_CLOUD_URL_MAX			256
@@ -144,7 +145,7 @@ typedef struct {
 	artik_ssl_config *ssl_config;
 } artik_cloud_http_request;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static artik_error send_message(const char *access_token, const char *device_id,
 	const char *message, char **response,
@@ -1961,7 +1962,7 @@ artik_error websocket_open_stream(artik_websocket_handle *handle,
 	if (ret != S_OK)
 		goto exit;
 
-	node = (cloud_node *)artik_list_add(&requested_node,
+	node = (cloud_node *)artik_indexed_list_add(&requested_node,
 				(ARTIK_LIST_HANDLE)*handle, sizeof(cloud_node));
 	if (!node) {
 		ret = E_NO_MEM;
@@ -1980,7 +1981,7 @@ artik_error websocket_open_stream(artik_websocket_handle *handle,
 	ret = websocket->websocket_set_connection_callback(*handle,
 			websocket_connection_callback, (void *)&(node->data));
 	if (ret != S_OK) {
-		artik_list_delete_handle(&requested_node,
+		artik_indexed_list_delete_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)*handle);
 		goto exit;
 	}
@@ -2004,8 +2005,8 @@ artik_error websocket_send_message(artik_websocket_handle handle, char *message)
 	artik_websocket_module *websocket = (artik_websocket_module *)
 					artik_request_api_module("websocket");
 	artik_error ret = S_OK;
-	cloud_node *node = (cloud_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	cloud_node *node = (cloud_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 	char message_buffer[ARTIK_CLOUD_WEBSOCKET_STR_MAX] = {0, };
 
 	log_dbg("");
@@ -2030,8 +2031,8 @@ artik_error websocket_send_message(artik_websocket_handle handle, char *message)
 artik_error websocket_set_connection_callback(artik_websocket_handle handle,
 			artik_websocket_callback callback, void *user_data)
 {
-	cloud_node *node = (cloud_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	cloud_node *node = (cloud_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 
 	log_dbg("");
 
@@ -2069,8 +2070,8 @@ artik_error websocket_close_stream(artik_websocket_handle handle)
 	artik_websocket_module *websocket = (artik_websocket_module *)
 					artik_request_api_module("websocket");
 	artik_error ret = S_OK;
-	cloud_node *node = (cloud_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	cloud_node *node = (cloud_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 
 	log_dbg("");
 
@@ -2086,7 +2087,7 @@ artik_error websocket_close_stream(artik_websocket_handle handle)
 	if (node->data.device_id)
 		free(node->data.device_id);
 
-	ret = artik_list_delete_handle(&requested_node,
+	ret = artik_indexed_list_delete_handle(&requested_node,
 					(ARTIK_LIST_HANDLE)handle);
 	if (ret != S_OK)
 		goto exit;
@@ -21,6 +21,7 @@
 
 #include <artik_log.h>
 #include <artik_list.h>
+#include <artik_indexed_list.h>
 #include <artik_websocket.h>
 #include "os_websocket.h"
 
@@ -54,7 +55,7 @@ typedef struct {
 	artik_websocket_config config;
 } websocket_node;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 artik_error artik_websocket_request(artik_websocket_handle *handle,
 					artik_websocket_config *config)
@@ -64,7 +65,7 @@ artik_error artik_websocket_request(artik_websocket_handle *handle,
 	if (!handle || !config || !config->uri)
 		return E_BAD_ARGS;
 
-	node = (websocket_node *) artik_list_add(
+	node = (websocket_node *) artik_indexed_list_add(
 				&requested_node, 0, sizeof(websocket_node));
 	if (!node)
 		return E_NO_MEM;
@@ -79,8 +80,9 @@ artik_error artik_websocket_request(artik_websocket_handle *handle,
 artik_error artik_websocket_open_stream(artik_websocket_handle handle)
 {
 	artik_error ret = S_OK;
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
 
@@ -98,8 +100,9 @@ artik_error artik_websocket_write_stream(artik_websocket_handle handle,
 							char *message)
 {
 	artik_error ret = S_OK;
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 	int message_len = 0;
 
 	log_dbg("");
@@ -120,8 +123,9 @@ artik_error artik_websocket_set_connection_callback(
 			artik_websocket_callback callback, void *user_data)
 {
 	artik_error ret = S_OK;
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
 
@@ -140,8 +144,9 @@ artik_error artik_websocket_set_receive_callback(artik_websocket_handle handle,
 			  artik_websocket_callback callback, void *user_data)
 {
 	artik_error ret = S_OK;
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
 
@@ -159,8 +164,9 @@ artik_error artik_websocket_set_receive_callback(artik_websocket_handle handle,
 artik_error artik_websocket_close_stream(artik_websocket_handle handle)
 {
 	artik_error ret = S_OK;
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
 
@@ -171,7 +177,7 @@ artik_error artik_websocket_close_stream(artik_websocket_handle handle)
 	if (ret != S_OK)
 		log_err("close stream failed: %d\n", ret);
 
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 
 	return ret;
 }
@@ -30,6 +30,7 @@
 #include <artik_loop.h>
 #include <artik_security.h>
 #include <artik_websocket.h>
+#include <artik_indexed_list.h>
 #include "os_websocket.h"
 
 #define WAIT_CONNECT_POLLING_MS		500
@@ -103,7 +104,7 @@ typedef struct {
 	os_websocket_interface interface;
 } websocket_node;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static const struct lws_extension exts[] = {
 	{
@@ -163,6 +164,13 @@ void lws_cleanup(artik_websocket_config *config)
 	/* Destroy context in libwebsockets API */
 	lws_context_destroy(ARTIK_WEBSOCKET_INTERFACE->context);
 
+	/*
+	 * The wsi may be reused by a later connection, drop its node once
+	 * LWS_CALLBACK_WSI_DESTROY was handled.
+	 */
+	artik_indexed_list_delete_handle(&requested_node,
+			(ARTIK_LIST_HANDLE)ARTIK_WEBSOCKET_INTERFACE->wsi);
+
 	/* Free variables in ARTIK API */
 	close(ARTIK_WEBSOCKET_INTERFACE->container.fds->fdset[FD_CLOSE]);
 	close(ARTIK_WEBSOCKET_INTERFACE->container.fds->fdset[FD_CONNECT]);
@@ -237,8 +245,9 @@ int lws_callback(struct lws *wsi, enum lws_callback_reasons reason,
 
 	case LWS_CALLBACK_WSI_DESTROY:
 		log_dbg("LWS_CALLBACK_WSI_DESTROY");
-		websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)wsi);
+		websocket_node *node =
+			(websocket_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)wsi);
 
 		if (!node) {
 			log_err("Failed to find websocket instance");
@@ -973,7 +982,7 @@ artik_error os_websocket_open_stream(artik_websocket_config *config)
 	interface->sec_data = sec_data;
 	interface->error_connect = false;
 
-	node = (websocket_node *)artik_list_add(&requested_node,
+	node = (websocket_node *)artik_indexed_list_add(&requested_node,
 				(ARTIK_LIST_HANDLE)wsi, sizeof(websocket_node));
 	if (!node)
 		return E_NO_MEM;
@@ -1015,8 +1024,9 @@ artik_error os_websocket_write_stream(artik_websocket_config *config,
 
 	log_dbg("");
 
-	websocket_node *node = (websocket_node *)artik_list_get_by_handle(
-		requested_node, (ARTIK_LIST_HANDLE)
+	websocket_node *node =
+		(websocket_node *)artik_indexed_list_get_by_handle(
+		&requested_node, (ARTIK_LIST_HANDLE)
 		ARTIK_WEBSOCKET_INTERFACE->wsi);
 
 	if (!node) {
@@ -24,6 +24,7 @@
 
 #include <artik_lwm2m.h>
 #include <artik_list.h>
+#include <artik_indexed_list.h>
 #include "os_lwm2m.h"
 #include "lwm2mclient.h"
 
@@ -47,7 +48,7 @@ typedef struct {
 	int id;
 } lwm2m_idle_params;
 
-static artik_list *nodes = NULL;
+static artik_indexed_list nodes;
 
 static int on_lwm2m_service_callback(void *user_data)
 {
@@ -227,19 +228,20 @@ artik_error os_lwm2m_client_request(artik_lwm2m_handle *handle,
 	if (!config->tls_psk_key)
 		return E_BAD_ARGS;
 
-	node = (lwm2m_node *) artik_list_add(&nodes, 0, sizeof(lwm2m_node));
+	node = (lwm2m_node *)
+		artik_indexed_list_add(&nodes, 0, sizeof(lwm2m_node));
 	if (!node)
 		return E_NO_MEM;
 
 	objects = malloc(sizeof(object_container_t));
 	if (!objects) {
-		artik_list_delete_node(&nodes, (artik_list *)node);
+		artik_indexed_list_delete_node(&nodes, (artik_list *)node);
 		return E_NO_MEM;
 	}
 
 	server = malloc(sizeof(object_security_server_t));
 	if (!server) {
-		artik_list_delete_node(&nodes, (artik_list *)node);
+		artik_indexed_list_delete_node(&nodes, (artik_list *)node);
 		free(objects);
 		return E_NO_MEM;
 	}
@@ -391,7 +393,7 @@ artik_error os_lwm2m_client_request(artik_lwm2m_handle *handle,
 	return S_OK;
 
 exit:
-	artik_list_delete_node(&nodes, (artik_list *)node);
+	artik_indexed_list_delete_node(&nodes, (artik_list *)node);
 	if (server) {
 		if (server->serverCertificate)
 			free(server->serverCertificate);
@@ -423,7 +425,8 @@ exit:
 
 artik_error os_lwm2m_client_release(artik_lwm2m_handle handle)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 						(ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
@@ -463,13 +466,15 @@ artik_error os_lwm2m_client_release(artik_lwm2m_handle handle)
 	}
 
 	artik_release_api_module(node->loop_module);
-	artik_list_delete_node(&nodes, (artik_list *)node);
+	artik_indexed_list_delete_node(&nodes, (artik_list *)node);
 	return S_OK;
 }
 
 artik_error os_lwm2m_client_connect(artik_lwm2m_handle handle)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes, (ARTIK_LIST_HANDLE) handle);
+	lwm2m_node *node = (lwm2m_node *)
+		artik_indexed_list_get_by_handle(&nodes,
+				(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
 	log_dbg("");
@@ -505,7 +510,8 @@ artik_error os_lwm2m_client_connect(artik_lwm2m_handle handle)
 
 artik_error os_lwm2m_client_disconnect(artik_lwm2m_handle handle)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 			(ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
@@ -525,7 +531,8 @@ artik_error os_lwm2m_client_disconnect(artik_lwm2m_handle handle)
 artik_error os_lwm2m_client_write_resource(artik_lwm2m_handle handle,
 		const char *uri, unsigned char *buffer, int length)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 				(ARTIK_LIST_HANDLE) handle);
 	lwm2m_resource_t res;
 	artik_error ret = S_OK;
@@ -555,7 +562,8 @@ exit:
 artik_error os_lwm2m_client_read_resource(artik_lwm2m_handle handle,
 		const char *uri, unsigned char *buffer, int *length)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 					(ARTIK_LIST_HANDLE) handle);
 	lwm2m_resource_t res;
 	artik_error ret = S_OK;
@@ -596,7 +604,8 @@ artik_error os_lwm2m_set_callback(artik_lwm2m_handle handle,
 		artik_lwm2m_event_t event,
 		artik_lwm2m_callback user_callback, void *user_data)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 				(ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
@@ -613,7 +622,8 @@ artik_error os_lwm2m_set_callback(artik_lwm2m_handle handle,
 artik_error os_lwm2m_unset_callback(artik_lwm2m_handle handle,
 				artik_lwm2m_event_t event)
 {
-	lwm2m_node *node = (lwm2m_node *)artik_list_get_by_handle(nodes,
+	lwm2m_node *node =
+		(lwm2m_node *)artik_indexed_list_get_by_handle(&nodes,
 			(ARTIK_LIST_HANDLE) handle);
 
 	log_dbg("");
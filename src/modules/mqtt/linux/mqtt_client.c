@@ -26,6 +26,7 @@
 #include <artik_log.h>
 #include <artik_loop.h>
 #include <artik_module.h>
+#include <artik_indexed_list.h>
 #include "../mqtt_client.h"
 
 #define TLS_CA_FILENAME     "/tmp/mqtt-ca.cert"
@@ -59,13 +60,13 @@ typedef struct {
 	message_callback on_message;
 } mqtt_handle_client;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static void on_connect_callback(struct mosquitto *client, void *handle_client,
 				int result)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 		(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -80,7 +81,7 @@ static void on_disconnect_callback(struct mosquitto *client,
 					void *handle_client, int result)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -95,7 +96,7 @@ static void on_subscribe_callback(struct mosquitto *client, void *handle_client,
 		int mid, int qos_count, const int *granted_qos)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -110,7 +111,7 @@ static void on_unsubscribe_callback(struct mosquitto *client,
 					void *handle_client, int mid)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -124,7 +125,7 @@ static void on_publish_callback(struct mosquitto *client, void *handle_client,
 				int mid)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -138,7 +139,7 @@ static void on_message_callback(struct mosquitto *client, void *handle_client,
 				const struct mosquitto_message *msg)
 {
 	mqtt_handle_client *client_data = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	artik_mqtt_msg *received_msg;
 
@@ -259,7 +260,8 @@ artik_mqtt_handle mqtt_create_client(artik_mqtt_config *config)
 
 	log_dbg("");
 
-	mqtt_client = (mqtt_handle_client *)artik_list_add(&requested_node, 0,
+	mqtt_client =
+		(mqtt_handle_client *)artik_indexed_list_add(&requested_node, 0,
 			sizeof(mqtt_handle_client));
 	if (!mqtt_client) {
 		log_err("mqtt_client is null.");
@@ -372,7 +374,7 @@ artik_mqtt_handle mqtt_create_client(artik_mqtt_config *config)
 void mqtt_client_destroy_client(artik_mqtt_handle handle_client)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -393,7 +395,8 @@ void mqtt_client_destroy_client(artik_mqtt_handle handle_client)
 		if (client->loop)
 			artik_release_api_module(client->loop);
 
-		artik_list_delete_node(&requested_node, (artik_list *)client);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)client);
 	}
 }
 
@@ -453,7 +456,7 @@ int mqtt_client_free_willmsg(artik_mqtt_config *config)
 int mqtt_client_clear_willmsg(artik_mqtt_handle handle_client)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	int rc = -1;
@@ -477,7 +480,7 @@ int mqtt_client_set_connect(artik_mqtt_handle handle_client,
 		connect_callback cb, void *user_connect_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -491,7 +494,7 @@ int mqtt_client_set_disconnect(artik_mqtt_handle handle_client,
 		disconnect_callback cb,	void *user_disconnect_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -505,7 +508,7 @@ int mqtt_client_set_subscribe(artik_mqtt_handle handle_client,
 		subscribe_callback cb, void *user_subscribe_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -519,7 +522,7 @@ int mqtt_client_set_unsubscribe(artik_mqtt_handle handle_client,
 		unsubscribe_callback cb, void *user_unsubscribe_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -533,7 +536,7 @@ int mqtt_client_set_publish(artik_mqtt_handle handle_client,
 		publish_callback cb, void *user_publish_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -547,7 +550,7 @@ int mqtt_client_set_message(artik_mqtt_handle handle_client,
 		message_callback cb, void *user_message_data)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	if (!client)
@@ -574,7 +577,7 @@ static void loop_handle_mosquitto_error(mqtt_handle_client *client, int err)
 static int loop_handler(int fd, enum watch_io io, void *handle_client)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc = 0;
 
@@ -613,7 +616,7 @@ static int loop_handler(int fd, enum watch_io io, void *handle_client)
 static int misc_handler(void *handle_client)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc = 0;
 
@@ -637,7 +640,7 @@ int mqtt_client_connect(artik_mqtt_handle handle_client, const char *host,
 		int port)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc;
 	int socket_fd;
@@ -682,7 +685,7 @@ int mqtt_client_connect(artik_mqtt_handle handle_client, const char *host,
 int mqtt_client_disconnect(artik_mqtt_handle handle_client)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 
 	log_dbg("");
@@ -697,7 +700,7 @@ int mqtt_client_subscribe(artik_mqtt_handle handle_client, int qos,
 		const char *msgtopic)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc = MQTT_ERROR_SUCCESS;
 	int err = MOSQ_ERR_SUCCESS;
@@ -725,7 +728,7 @@ int mqtt_client_unsubscribe(artik_mqtt_handle handle_client,
 		const char *msg_topic)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc = MQTT_ERROR_SUCCESS;
 	int err = MOSQ_ERR_SUCCESS;
@@ -748,7 +751,7 @@ int mqtt_client_publish(artik_mqtt_handle handle_client, int qos, bool retain,
 		const char *msg_topic, int payload_len, const char *msg_content)
 {
 	mqtt_handle_client *client = (mqtt_handle_client *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle_client);
 	int rc = MQTT_ERROR_SUCCESS;
 	int err = MOSQ_ERR_SUCCESS;
@@ -41,6 +41,20 @@ static artik_sensor_config *artik_sensor_get_flame_sensor(unsigned int);
 static artik_sensor_config *artik_sensor_get_pressure_sensor(unsigned int);
 static artik_sensor_config *artik_sensor_get_gyro_sensor(unsigned int);
 static artik_sensor_config *artik_sensor_get_hall_sensor(unsigned int);
+static artik_error artik_sensor_start_sampling(artik_sensor_sampling_handle *,
+		artik_sensor_config *, artik_sensor_handle,
+		const artik_sensor_sampling_config *,
+		artik_sensor_samples_callback, void *);
+static artik_error artik_sensor_stop_sampling(artik_sensor_sampling_handle);
+static artik_error artik_sensor_get_sampling_stats(
+		artik_sensor_sampling_handle, artik_sensor_sampling_stats *);
+static artik_error artik_sensor_open_reader(artik_sensor_reader_handle *,
+		artik_sensor_sampling_handle, const artik_sensor_view *);
+static artik_error artik_sensor_read_samples(artik_sensor_reader_handle,
+		artik_sensor_sample *, int, int *);
+static artik_error artik_sensor_close_reader(artik_sensor_reader_handle);
+static artik_error artik_sensor_get_reader_stats(artik_sensor_reader_handle,
+		artik_sensor_reader_stats *);
 
 artik_sensor_module sensor_module = {
 	artik_sensor_request,
@@ -54,7 +68,14 @@ artik_sensor_module sensor_module = {
 	artik_sensor_get_flame_sensor,
 	artik_sensor_get_pressure_sensor,
 	artik_sensor_get_gyro_sensor,
-	artik_sensor_get_hall_sensor
+	artik_sensor_get_hall_sensor,
+	artik_sensor_start_sampling,
+	artik_sensor_stop_sampling,
+	artik_sensor_get_sampling_stats,
+	artik_sensor_open_reader,
+	artik_sensor_read_samples,
+	artik_sensor_close_reader,
+	artik_sensor_get_reader_stats
 };
 
 static artik_error artik_sensor_request(artik_sensor_config *config,
@@ -124,3 +145,74 @@ static artik_sensor_config *artik_sensor_get_hall_sensor(unsigned int nb)
 {
 	return artik_sensor_get_sensor(nb, ARTIK_SENSOR_HALL);
 }
+
+static artik_error artik_sensor_start_sampling(
+		artik_sensor_sampling_handle *sampling,
+		artik_sensor_config *config, artik_sensor_handle handle,
+		const artik_sensor_sampling_config *params,
+		artik_sensor_samples_callback callback, void *user_data)
+{
+	if (!sampling || !config || !handle || !params || !params->rate_hz ||
+	    params->rate_hz > ARTIK_SENSOR_MAX_RATE_HZ ||
+	    (!callback && !params->ring_size))
+		return E_BAD_ARGS;
+
+	return os_sensor_start_sampling(sampling, config, handle, params,
+							callback, user_data);
+}
+
+static artik_error artik_sensor_stop_sampling(
+		artik_sensor_sampling_handle sampling)
+{
+	if (!sampling)
+		return E_BAD_ARGS;
+
+	return os_sensor_stop_sampling(sampling);
+}
+
+static artik_error artik_sensor_get_sampling_stats(
+		artik_sensor_sampling_handle sampling,
+		artik_sensor_sampling_stats *stats)
+{
+	if (!sampling || !stats)
+		return E_BAD_ARGS;
+
+	return os_sensor_get_sampling_stats(sampling, stats);
+}
+
+static artik_error artik_sensor_open_reader(artik_sensor_reader_handle *reader,
+		artik_sensor_sampling_handle sampling,
+		const artik_sensor_view *view)
+{
+	if (!reader || !sampling)
+		return E_BAD_ARGS;
+
+	return os_sensor_open_reader(reader, sampling, view);
+}
+
+static artik_error artik_sensor_read_samples(artik_sensor_reader_handle reader,
+		artik_sensor_sample *samples, int max, int *count)
+{
+	if (!reader || !samples || max <= 0 || !count)
+		return E_BAD_ARGS;
+
+	return os_sensor_read_samples(reader, samples, max, count);
+}
+
+static artik_error artik_sensor_close_reader(artik_sensor_reader_handle reader)
+{
+	if (!reader)
+		return E_BAD_ARGS;
+
+	return os_sensor_close_reader(reader);
+}
+
+static artik_error artik_sensor_get_reader_stats(
+		artik_sensor_reader_handle reader,
+		artik_sensor_reader_stats *stats)
+{
+	if (!reader || !stats)
+		return E_BAD_ARGS;
+
+	return os_sensor_get_reader_stats(reader, stats);
+}
@@ -110,6 +110,33 @@ int artik::AccelerometerSensor::get_speed_z(void) const {
   return data;
 }
 
+artik_sensor_vector artik::AccelerometerSensor::read_vector(void) const {
+  artik_sensor_vector vector;
+  artik_error res;
+
+  if (!this->m_sensor || !this->m_config || !this->m_handle)
+    artik_throw(artik::ArtikInitException());
+  if ((res = this->m_sensor->read_vector(this->m_handle, &vector)) != S_OK)
+    artik_throw(artik::ArtikException(res));
+  return vector;
+}
+
+std::vector<artik_sensor_vector> artik::AccelerometerSensor::read_block(
+    int count) const {
+  std::vector<artik_sensor_vector> vectors;
+  artik_error res;
+
+  if (!this->m_sensor || !this->m_config || !this->m_handle)
+    artik_throw(artik::ArtikInitException());
+  if (count <= 0)
+    artik_throw(artik::ArtikBadArgsException());
+  vectors.resize(count);
+  if ((res = this->m_sensor->read_block(this->m_handle, vectors.data(),
+      count)) != S_OK)
+    artik_throw(artik::ArtikException(res));
+  return vectors;
+}
+
 artik::GyroSensor::GyroSensor(artik_sensor_gyro *sensor,
     artik_sensor_config *config, artik_sensor_handle handle, int index)
   : artik::SensorDevice(),
@@ -197,6 +224,33 @@ int artik::GyroSensor::get_roll(void) const {
   return data;
 }
 
+artik_sensor_vector artik::GyroSensor::read_vector(void) const {
+  artik_sensor_vector vector;
+  artik_error res;
+
+  if (!this->m_sensor || !this->m_config || !this->m_handle)
+    artik_throw(artik::ArtikInitException());
+  if ((res = this->m_sensor->read_vector(this->m_handle, &vector)) != S_OK)
+    artik_throw(artik::ArtikException(res));
+  return vector;
+}
+
+std::vector<artik_sensor_vector> artik::GyroSensor::read_block(
+    int count) const {
+  std::vector<artik_sensor_vector> vectors;
+  artik_error res;
+
+  if (!this->m_sensor || !this->m_config || !this->m_handle)
+    artik_throw(artik::ArtikInitException());
+  if (count <= 0)
+    artik_throw(artik::ArtikBadArgsException());
+  vectors.resize(count);
+  if ((res = this->m_sensor->read_block(this->m_handle, vectors.data(),
+      count)) != S_OK)
+    artik_throw(artik::ArtikException(res));
+  return vectors;
+}
+
 artik::HumiditySensor::HumiditySensor(artik_sensor_humidity*sensor,
     artik_sensor_config *config, artik_sensor_handle handle, int index)
   : artik::SensorDevice(),
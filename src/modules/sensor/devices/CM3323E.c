@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_i2c.h"
 #include "artik_log.h"
 
@@ -51,7 +52,7 @@ artik_sensor_light cm3323e_sensor = {
 	get_intensity
 };
 
-static artik_list *cm3323e_list = NULL;
+static artik_indexed_list cm3323e_list;
 
 static int check_exist(struct cm3323e_config_s *elem, int val_id)
 {
@@ -87,7 +88,8 @@ static artik_error request(artik_sensor_handle *handle,
 	artik_i2c_module *i2c;
 	struct cm3323e_config_s *elem;
 
-	elem = (struct cm3323e_config_s *) artik_list_get_by_check(cm3323e_list,
+	elem = (struct cm3323e_config_s *)
+		artik_indexed_list_get_by_check(&cm3323e_list,
 			(ARTIK_LIST_FUNCB) check_exist,
 			(void *)(intptr_t) ((artik_i2c_config *) config->config)->id);
 	int ret;
@@ -95,7 +97,8 @@ static artik_error request(artik_sensor_handle *handle,
 	if (elem)
 		return E_BUSY;
 
-	elem = (struct cm3323e_config_s *) artik_list_add(&cm3323e_list, 0,
+	elem = (struct cm3323e_config_s *)
+		artik_indexed_list_add(&cm3323e_list, 0,
 			sizeof(struct cm3323e_config_s));
 
 	if (elem) {
@@ -139,12 +142,13 @@ static artik_error release(artik_sensor_handle handle)
 {
 	struct cm3323e_config_s *elem;
 
-	elem = (struct cm3323e_config_s *) artik_list_get_by_handle(
-			cm3323e_list,
+	elem = (struct cm3323e_config_s *) artik_indexed_list_get_by_handle(
+			&cm3323e_list,
 			(ARTIK_LIST_HANDLE) handle);
 
 	if (elem) {
-		artik_list_delete_node(&cm3323e_list, (artik_list *) elem);
+		artik_indexed_list_delete_node(&cm3323e_list,
+				(artik_list *) elem);
 		if (elem->i2c) {
 			(void)elem->i2c->release(elem->hdl);
 			artik_release_api_module(elem->i2c);
@@ -163,8 +167,8 @@ static artik_error get_intensity(artik_sensor_handle handle, int *store)
 	if (!store)
 		return E_BAD_ARGS;
 
-	cm3323e = (struct cm3323e_config_s *) artik_list_get_by_handle(
-			cm3323e_list,
+	cm3323e = (struct cm3323e_config_s *) artik_indexed_list_get_by_handle(
+			&cm3323e_list,
 			(ARTIK_LIST_HANDLE) handle);
 
 	if (!cm3323e)
@@ -22,11 +22,14 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_i2c.h"
 #include "artik_log.h"
 
 #include <devices/HTS221.h>
 
+#include "sensor_device.h"
+
 #define	_AUTO_INC		0x80
 #define	HTS221_DEVICE_ID	0xBC
 
@@ -52,12 +55,30 @@
 #define HTS221_REG_T1_OUT_L     0x3E
 #define HTS221_REG_T1_OUT_H     0x3F
 
+#define HTS221_CALIB_LEN	(HTS221_REG_T1_OUT_H - HTS221_REG_H0_RH_X2 + 1)
+#define HTS221_CALIB(c, reg)	((c)[(reg) - HTS221_REG_H0_RH_X2])
+#define HTS221_CALIB16(c, reg)	((short)(HTS221_CALIB(c, (reg) + 1) << 8 | \
+					HTS221_CALIB(c, reg)))
+
+/* Factory calibration, read once when the device is initialized */
+struct hts221_calib {
+	unsigned short h0_rh;
+	unsigned short h1_rh;
+	short h0_t0_out;
+	short h1_t0_out;
+	unsigned short t0_deg;
+	unsigned short t1_deg;
+	short t0_out;
+	short t1_out;
+};
+
 struct hts221_config_s {
 	artik_list node;
 	artik_i2c_module *i2c;
 	artik_i2c_handle hdl;
 	int id;
 	int number_of_instances;
+	struct hts221_calib calib;
 };
 
 static artik_error request(artik_sensor_handle *handle,
@@ -80,7 +101,20 @@ artik_sensor_temperature hts221_temp_sensor = {
 	get_fahrenheit
 };
 
-static artik_list *hts221_list = NULL;
+static artik_error read_humidity(artik_sensor_handle handle, int *values);
+static artik_error read_temp(artik_sensor_handle handle, int *values);
+
+const struct sensor_device hts221_humidity_device = {
+	&hts221_humidity_sensor,
+	read_humidity
+};
+
+const struct sensor_device hts221_temp_device = {
+	&hts221_temp_sensor,
+	read_temp
+};
+
+static artik_indexed_list hts221_list;
 
 static int check_exist(struct hts221_config_s *elem, int val_id)
 {
@@ -90,25 +124,61 @@ static int check_exist(struct hts221_config_s *elem, int val_id)
 }
 
 static artik_error get_data(artik_sensor_handle handle, int reg, char *data,
-				int len)
+				int len, struct hts221_config_s **elem)
 {
 	struct hts221_config_s *hts221;
 
 	if (!data)
 		return E_BAD_ARGS;
 
-	hts221 = (struct hts221_config_s *) artik_list_get_by_handle(
-				hts221_list, (ARTIK_LIST_HANDLE) handle);
+	hts221 = (struct hts221_config_s *) artik_indexed_list_get_by_handle(
+				&hts221_list, (ARTIK_LIST_HANDLE) handle);
 
 	if (!hts221)
 		return E_INVALID_VALUE;
 
+	*elem = hts221;
 	reg = (len > 1) ? reg | _AUTO_INC : reg;
 
 	return hts221->i2c->read_register(hts221->hdl, reg, data, len);
 }
 
-static artik_error initialize(artik_i2c_module *i2c, artik_i2c_handle handle)
+static artik_error read_calibration(artik_i2c_module *i2c,
+			artik_i2c_handle handle, struct hts221_calib *calib)
+{
+	unsigned char c[HTS221_CALIB_LEN];
+	unsigned char msb;
+	artik_error ret;
+
+	ret = i2c->read_register(handle, HTS221_REG_H0_RH_X2 | _AUTO_INC,
+						(char *)c, HTS221_CALIB_LEN);
+	if (ret != S_OK)
+		return ret;
+
+	calib->h0_rh = HTS221_CALIB(c, HTS221_REG_H0_RH_X2);
+	calib->h1_rh = HTS221_CALIB(c, HTS221_REG_H1_RH_X2);
+	calib->h0_t0_out = HTS221_CALIB16(c, HTS221_REG_H0_T0_OUT_L);
+	calib->h1_t0_out = HTS221_CALIB16(c, HTS221_REG_H1_T0_OUT_L);
+
+	msb = HTS221_CALIB(c, HTS221_REG_T1_T0_MSB);
+	calib->t0_deg = HTS221_CALIB(c, HTS221_REG_T0_DEGC_X8) |
+						((msb & 0x03) << 8);
+	calib->t1_deg = HTS221_CALIB(c, HTS221_REG_T1_DEGC_X8) |
+						(((msb & 0x0C) >> 2) << 8);
+	calib->t0_out = HTS221_CALIB16(c, HTS221_REG_T0_OUT_L);
+	calib->t1_out = HTS221_CALIB16(c, HTS221_REG_T1_OUT_L);
+
+	log_dbg("h0_rh(%d), h1_rh(%d), h0_t0_out(%d), h1_t0_out(%d)\n",
+		calib->h0_rh, calib->h1_rh, calib->h0_t0_out,
+		calib->h1_t0_out);
+	log_dbg("t0_deg(%d), t1_deg(%d), t0_out(%d), t1_out(%d)\n",
+		calib->t0_deg, calib->t1_deg, calib->t0_out, calib->t1_out);
+
+	return S_OK;
+}
+
+static artik_error initialize(artik_i2c_module *i2c, artik_i2c_handle handle,
+				struct hts221_calib *calib)
 {
 	artik_error ret;
 	char buffer[3];
@@ -117,7 +187,7 @@ static artik_error initialize(artik_i2c_module *i2c, artik_i2c_handle handle)
 	if (ret != S_OK)
 		return ret;
 
-	if (buffer[0] != HTS221_DEVICE_ID)
+	if ((unsigned char)buffer[0] != HTS221_DEVICE_ID)
 		return E_NOT_SUPPORTED;
 
 	/* 0xAVGT : 110(NOISE 0.01), AVGH : 100(NOISE 0.1)  */
@@ -138,7 +208,8 @@ static artik_error initialize(artik_i2c_module *i2c, artik_i2c_handle handle)
 	if (ret != S_OK)
 		return ret;
 
-	return S_OK;
+	/* Calibration registers are constant, no need to read them again */
+	return read_calibration(i2c, handle, calib);
 }
 
 static artik_error request(artik_sensor_handle *handle,
@@ -147,7 +218,8 @@ static artik_error request(artik_sensor_handle *handle,
 	artik_i2c_module *i2c;
 	struct hts221_config_s *elem;
 
-	elem = (struct hts221_config_s *) artik_list_get_by_check(hts221_list,
+	elem = (struct hts221_config_s *)
+		artik_indexed_list_get_by_check(&hts221_list,
 			(ARTIK_LIST_FUNCB) check_exist,
 			(void *)(intptr_t) ((artik_i2c_config *) config->config)->id);
 	int ret;
@@ -162,7 +234,8 @@ static artik_error request(artik_sensor_handle *handle,
 		return S_OK;
 	}
 
-	elem = (struct hts221_config_s *) artik_list_add(&hts221_list, 0,
+	elem = (struct hts221_config_s *)
+		artik_indexed_list_add(&hts221_list, 0,
 			sizeof(struct hts221_config_s));
 
 	if (elem) {
@@ -191,7 +264,7 @@ static artik_error request(artik_sensor_handle *handle,
 
 		/* Initalize */
 
-		ret = initialize(i2c, elem->hdl);
+		ret = initialize(i2c, elem->hdl, &elem->calib);
 		if (ret != S_OK) {
 			*handle = NULL;
 			release(elem);
@@ -208,143 +281,122 @@ static artik_error release(artik_sensor_handle handle)
 {
 	struct hts221_config_s *elem;
 
-	elem = (struct hts221_config_s *) artik_list_get_by_handle(hts221_list,
+	elem = (struct hts221_config_s *)
+		artik_indexed_list_get_by_handle(&hts221_list,
 			(ARTIK_LIST_HANDLE) handle);
 
 	if (elem) {
 		if (!(--elem->number_of_instances)) {
-			artik_list_delete_node(&hts221_list,
-							(artik_list *) elem);
 			if (elem->i2c) {
 				(void)elem->i2c->release(elem->hdl);
 				artik_release_api_module(elem->i2c);
 			}
+			artik_indexed_list_delete_node(&hts221_list,
+							(artik_list *) elem);
 		}
 	}
 
 	return S_OK;
 }
 
-static artik_error get_humidity(artik_sensor_handle handle, int *store)
+static int humidity_of(const struct hts221_calib *calib, short h_out)
 {
-	int ret;
-	unsigned short h0_rh = 0, h1_rh = 0;
-	short h_out = 0, h0_t0_out = 0, h1_t0_out = 0;
 	double humidity = 0.0;
 
-	if (!store)
-		return E_BAD_ARGS;
-
-	ret = get_data(handle, HTS221_REG_H_OUT_L, (char *)&h_out, 2);
-	if (ret != S_OK)
-		return ret;
-
 	log_dbg("h_out(%d:%04x)\n", h_out, h_out & 0xffff);
 
-	ret = get_data(handle, HTS221_REG_H0_RH_X2, (char *)&h0_rh, 1);
-	if (ret != S_OK)
-		return ret;
-
-	log_dbg("h0_rh(%d:%04x)\n", h0_rh, h0_rh & 0xffff);
-
-	ret = get_data(handle, HTS221_REG_H1_RH_X2, (char *)&h1_rh, 1);
-	if (ret != S_OK)
-		return ret;
-
-	log_dbg("h1_rh(%d:%04x)\n", h1_rh, h1_rh * 0xffff);
-
-	ret = get_data(handle, HTS221_REG_H0_T0_OUT_L, (char *)&h0_t0_out, 2);
-	if (ret != S_OK)
-		return ret;
-
-	log_dbg("h0_t0_out(%d:%04x)\n", h0_t0_out, h0_t0_out & 0xffff);
-
-	ret = get_data(handle, HTS221_REG_H1_T0_OUT_L, (char *)&h1_t0_out, 2);
-	if (ret != S_OK)
-		return ret;
-
-	log_dbg("h1_t0_out(%d:%04x)\n", h1_t0_out, h1_t0_out & 0xffff);
-
-	if (h1_t0_out - h0_t0_out) {
-		humidity = (double) (h1_rh - h0_rh) / (h1_t0_out - h0_t0_out);
-		humidity *= (h_out - h0_t0_out);
-		humidity += h0_rh;
+	if (calib->h1_t0_out - calib->h0_t0_out) {
+		humidity = (double) (calib->h1_rh - calib->h0_rh) /
+				(calib->h1_t0_out - calib->h0_t0_out);
+		humidity *= (h_out - calib->h0_t0_out);
+		humidity += calib->h0_rh;
 		humidity /= 2;
 	}
 
 	log_dbg("h(%04d.%d)\n", (int) (humidity * 100) / 100,
 			(int) (humidity * 100) % 100);
 
-	*store = (int)humidity;
-
-	return S_OK;
+	return (int)humidity;
 }
 
-static artik_error get_celsius(artik_sensor_handle handle, int *store)
+static int celsius_of(const struct hts221_calib *calib, short t_out)
 {
-	unsigned char mask = 0;
-	unsigned short t0_deg = 0, t1_deg = 0;
-	short t0_out = 0, t1_out = 0, t_out = 0;
-
 	double temperature;
-	int ret;
 
-	if (!store)
-		return E_BAD_ARGS;
+	log_dbg("t_out(%d:%04x)\n", t_out, t_out & 0xffff);
 
-	ret = get_data(handle, HTS221_REG_T_OUT_L, (char *)&t_out, 2);
-	if (ret != S_OK)
-		return ret;
+	if (!(calib->t1_out - calib->t0_out)) {
+		temperature = 0;
+	} else {
+		temperature  = (double)(calib->t1_deg - calib->t0_deg) /
+					(calib->t1_out - calib->t0_out);
+		temperature *= (t_out - calib->t0_out);
+		temperature += calib->t0_deg;
+		temperature /= 8;
+	}
 
-	log_dbg("t_out(%d:%04x)\n", t_out, t_out & 0xffff);
+	log_dbg("t(%04d.%d)\n", (int) (temperature * 100) / 100,
+			(int) (temperature * 100) % 100);
 
-	ret = get_data(handle, HTS221_REG_T0_DEGC_X8, (char *)&t0_deg, 1);
-	if (ret != S_OK)
-		return ret;
+	return (int)temperature;
+}
 
-	log_dbg("t0_deg(%d:%04x)\n", t0_deg, t0_deg & 0xffff);
+static int fahrenheit_of(int celsius)
+{
+	double data = (double)celsius;
 
-	ret = get_data(handle, HTS221_REG_T1_DEGC_X8, (char *)&t1_deg, 1);
-	if (ret != S_OK)
-		return ret;
+	data *= 1.8;
 
-	log_dbg("t1_deg(%d:%04x)\n", t1_deg, t1_deg & 0xffff);
+	return (int)data + 32;
+}
 
-	ret = get_data(handle, HTS221_REG_T1_T0_MSB, (char *)&mask, 1);
+static artik_error read_out(artik_sensor_handle handle, int reg, short *out,
+				struct hts221_config_s **elem)
+{
+	unsigned char data[2];
+	artik_error ret;
+
+	ret = get_data(handle, reg, (char *)data, 2, elem);
 	if (ret != S_OK)
 		return ret;
 
-	t0_deg |= ((mask & 0x03) << 8);
-	t1_deg |= (((mask & 0x0C) >> 2) << 8);
+	*out = data[1] << 8 | data[0];
 
-	log_dbg("t0_deg(%d:%04x), t1_deg(%d:%04x)\n", t0_deg, t0_deg & 0xffff,
-			t1_deg, t1_deg * 0xffff);
+	return S_OK;
+}
 
-	ret = get_data(handle, HTS221_REG_T0_OUT_L, (char *)&t0_out, 2);
-	if (ret != S_OK)
-		return ret;
+static artik_error get_humidity(artik_sensor_handle handle, int *store)
+{
+	struct hts221_config_s *elem;
+	short h_out;
+	int ret;
 
-	log_dbg("t0_out(%d:%04x)\n", t0_out, t0_out & 0xffff);
+	if (!store)
+		return E_BAD_ARGS;
 
-	ret = get_data(handle, HTS221_REG_T1_OUT_L, (char *)&t1_out, 2);
+	ret = read_out(handle, HTS221_REG_H_OUT_L, &h_out, &elem);
 	if (ret != S_OK)
 		return ret;
 
-	log_dbg("t1_out(%d:%04x)\n", t1_out, t1_out & 0xffff);
+	*store = humidity_of(&elem->calib, h_out);
 
-	if (!(t1_out - t0_out)) {
-		temperature = 0;
-	} else {
-		temperature  = (double)(t1_deg - t0_deg) / (t1_out - t0_out);
-		temperature *= (t_out - t0_out);
-		temperature += t0_deg;
-		temperature /= 8;
-	}
+	return S_OK;
+}
 
-	log_dbg("t(%04d.%d)\n", (int) (temperature * 100) / 100,
-			(int) (temperature * 100) % 100);
+static artik_error get_celsius(artik_sensor_handle handle, int *store)
+{
+	struct hts221_config_s *elem;
+	short t_out;
+	int ret;
+
+	if (!store)
+		return E_BAD_ARGS;
+
+	ret = read_out(handle, HTS221_REG_T_OUT_L, &t_out, &elem);
+	if (ret != S_OK)
+		return ret;
 
-	*store = (int)temperature;
+	*store = celsius_of(&elem->calib, t_out);
 
 	return S_OK;
 }
@@ -352,7 +404,6 @@ static artik_error get_celsius(artik_sensor_handle handle, int *store)
 static artik_error get_fahrenheit(artik_sensor_handle handle, int *store)
 {
 	int ret;
-	double data;
 
 	if (!store)
 		return E_BAD_ARGS;
@@ -361,10 +412,25 @@ static artik_error get_fahrenheit(artik_sensor_handle handle, int *store)
 	if (ret < 0)
 		return ret;
 
-	data = (double)(*store);
-	data *= 1.8;
+	*store = fahrenheit_of(*store);
+
+	return S_OK;
+}
+
+static artik_error read_humidity(artik_sensor_handle handle, int *values)
+{
+	return get_humidity(handle, &values[0]);
+}
+
+static artik_error read_temp(artik_sensor_handle handle, int *values)
+{
+	artik_error ret;
+
+	ret = get_celsius(handle, &values[0]);
+	if (ret != S_OK)
+		return ret;
 
-	*store = (int)data + 32;
+	values[1] = fahrenheit_of(values[0]);
 
 	return S_OK;
 }
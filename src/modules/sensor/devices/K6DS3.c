@@ -22,17 +22,22 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_spi.h"
 #include "artik_log.h"
 
 #include <devices/K6DS3.h>
 
+#include "sensor_device.h"
+
 #define K6DS3_FACTORY_ID	0x69
 
 #define K6DS3_REG_FUNC_CFG_ACC	0x01
 #define K6DS3_REG_SYNC_TIME	0x04
 #define K6DS3_REG_SYNC_EN	0x05
 #define K6DS3_REG_FIFO_CTRL	0x06		/* length: 5-bytes */
+#define K6DS3_REG_FIFO_CTRL3	0x08
+#define K6DS3_REG_FIFO_CTRL5	0x0A
 #define K6DS3_REG_ORIENT_CFG_G	0x0B
 #define K6DS3_REG_INT_CTRL	0x0D		/* length: 2-bytes */
 #define K6DS3_REG_WHO_AM_I	0x0F
@@ -70,12 +75,35 @@
 #define K6DS3_REG_FREE_FALL	0x5D
 #define K6DS3_REG_MD_CFG	0x5E		/* length: 2-bytes */
 
+#define K6DS3_READ		0x80
+
+/* Accelerometer enabled at 1.66kHz, +/-2g */
+#define K6DS3_CTRL1_XL_DEFAULT	0x80
+#define K6DS3_CTRL2_G_DEFAULT	0x80
+/* Output data rate of both sensors set by the defaults above */
+#define K6DS3_ODR_DEFAULT_HZ	1660
+
+#define K6DS3_FIFO_XL_NO_DEC	0x01
+#define K6DS3_FIFO_CONTINUOUS	0x06
+#define K6DS3_FIFO_OVER_RUN	0x40
+#define K6DS3_FIFO_DIFF_H	0x0f
+#define K6DS3_FIFO_PATTERN_H	0x03
+/* Words of an accelerometer sample in the FIFO */
+#define K6DS3_FIFO_PATTERN	3
+/* Samples read from the FIFO in one transfer */
+#define K6DS3_FIFO_BURST	32
+#define K6DS3_MAX_BURST		(K6DS3_FIFO_BURST * 6)
+
 struct k6ds3_config_s {
 	artik_list node;
 	artik_spi_module *spi;
 	artik_spi_handle hdl;
 	int bus;
 	int number_of_instances;
+	/* Set between fifo_start and fifo_stop */
+	bool fifo_started;
+	/* Output data rate of the accelerometer */
+	unsigned int xl_rate_hz;
 };
 
 static artik_error request(artik_sensor_handle *handle,
@@ -89,13 +117,43 @@ static artik_error get_gyro_pitch(artik_sensor_handle handle, int *store);
 static artik_error get_gyro_roll(artik_sensor_handle handle, int *store);
 static artik_error get_gyro_yaw(artik_sensor_handle handle, int *store);
 
+static artik_error read_xl_vector(artik_sensor_handle handle,
+		artik_sensor_vector *vector);
+static artik_error read_xl_block(artik_sensor_handle handle,
+		artik_sensor_vector *vectors, int count);
+static artik_error read_gyro_vector(artik_sensor_handle handle,
+		artik_sensor_vector *vector);
+static artik_error read_gyro_block(artik_sensor_handle handle,
+		artik_sensor_vector *vectors, int count);
+
 artik_sensor_accelerometer k6ds3_xl_sensor = { request, release,
-		get_speed_x, get_speed_y, get_speed_z };
+		get_speed_x, get_speed_y, get_speed_z, read_xl_vector,
+		read_xl_block };
 
 artik_sensor_gyro k6ds3_gyro_sensor = { request, release,
-		get_gyro_yaw, get_gyro_roll, get_gyro_pitch };
+		get_gyro_yaw, get_gyro_roll, get_gyro_pitch, read_gyro_vector,
+		read_gyro_block };
+
+static artik_error read_xl(artik_sensor_handle handle, int *values);
+static artik_error read_gyro(artik_sensor_handle handle, int *values);
+static artik_error fifo_start(artik_sensor_handle handle,
+						unsigned int *rate_hz);
+static artik_error fifo_read(artik_sensor_handle handle,
+		artik_sensor_sample *samples, int max,
+		struct sensor_fifo_status *status);
+static void fifo_stop(artik_sensor_handle handle);
+
+const struct sensor_device k6ds3_xl_device = { &k6ds3_xl_sensor, read_xl,
+		fifo_start, fifo_read, fifo_stop };
+
+const struct sensor_device k6ds3_gyro_device = { &k6ds3_gyro_sensor,
+		read_gyro };
 
-static artik_list *k6ds3_list = NULL;
+/* Output data rates of the accelerometer and of the FIFO, by code */
+static const unsigned int odr_hz[] = { 0, 13, 26, 52, 104, 208, 416, 833,
+		1660, 3330, 6660 };
+
+static artik_indexed_list k6ds3_list;
 
 static int check_exist(struct k6ds3_config_s *elem, int bus)
 {
@@ -121,13 +179,13 @@ static artik_error initialize(artik_spi_module *spi, artik_spi_handle handle)
 	}
 
 	buffer[0] = K6DS3_REG_CTRL1_XL;
-	buffer[1] = 0x80;
+	buffer[1] = K6DS3_CTRL1_XL_DEFAULT;
 	ret = spi->write(handle, (char *)buffer, 2);
 	if (ret != S_OK)
 		return ret;
 
 	buffer[0] = K6DS3_REG_CTRL2_G;
-	buffer[1] = 0x80;
+	buffer[1] = K6DS3_CTRL2_G_DEFAULT;
 	ret = spi->write(handle, (char *)buffer, 2);
 	if (ret != S_OK)
 		return ret;
@@ -143,7 +201,8 @@ static artik_error request(artik_sensor_handle *handle,
 
 	if (!config)
 		return E_BAD_ARGS;
-	elem = (struct k6ds3_config_s *) artik_list_get_by_check(k6ds3_list,
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_check(&k6ds3_list,
 			(ARTIK_LIST_FUNCB) check_exist,
 			(void *)(intptr_t) ((artik_spi_config *) config->config)->bus);
 	int ret;
@@ -158,12 +217,14 @@ static artik_error request(artik_sensor_handle *handle,
 		return S_OK;
 	}
 
-	elem = (struct k6ds3_config_s *) artik_list_add(&k6ds3_list, 0,
+	elem = (struct k6ds3_config_s *) artik_indexed_list_add(&k6ds3_list, 0,
 			sizeof(struct k6ds3_config_s));
 
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE) elem;
 		elem->number_of_instances = 1;
+		elem->fifo_started = false;
+		elem->xl_rate_hz = K6DS3_ODR_DEFAULT_HZ;
 		spi = (artik_spi_module *) artik_request_api_module("spi");
 
 		if (!spi) {
@@ -204,17 +265,18 @@ static artik_error release(artik_sensor_handle handle)
 {
 	struct k6ds3_config_s *elem;
 
-	elem = (struct k6ds3_config_s *) artik_list_get_by_handle(k6ds3_list,
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
 			(ARTIK_LIST_HANDLE) handle);
 
 	if (elem) {
 		if (!(--elem->number_of_instances)) {
-			artik_list_delete_node(&k6ds3_list,
-							(artik_list *) elem);
 			if (elem->spi) {
 				(void)elem->spi->release(elem->hdl);
 				artik_release_api_module(elem->spi);
 			}
+			artik_indexed_list_delete_node(&k6ds3_list,
+							(artik_list *) elem);
 		}
 	}
 
@@ -226,12 +288,13 @@ static artik_error get_data(artik_sensor_handle handle, unsigned char reg,
 {
 	struct k6ds3_config_s *elem;
 	unsigned char rxdata[3] = { 0, };
-	unsigned char txdata[2] = { 0, };
+	unsigned char txdata[3] = { 0, };
 	int ret     = S_OK;
 	short value = 0;
 
 
-	elem = (struct k6ds3_config_s *) artik_list_get_by_handle(k6ds3_list,
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
 			(ARTIK_LIST_HANDLE) handle);
 
 	if (!elem)
@@ -280,3 +343,329 @@ static artik_error get_gyro_yaw(artik_sensor_handle handle, int *store)
 {
 	return get_data(handle, K6DS3_REG_OUTZ_G, (int *) store);
 }
+
+/* Registers are read in sequence, the address being auto incremented */
+static artik_error read_burst(struct k6ds3_config_s *elem, unsigned char reg,
+				unsigned char *data, int len)
+{
+	unsigned char txdata[K6DS3_MAX_BURST + 1] = { 0, };
+	unsigned char rxdata[K6DS3_MAX_BURST + 1];
+	artik_error ret;
+
+	if (len > K6DS3_MAX_BURST)
+		return E_BAD_ARGS;
+
+	txdata[0] = reg | K6DS3_READ;
+	ret = elem->spi->read_write(elem->hdl, (char *)txdata, (char *)rxdata,
+								len + 1);
+	if (ret != S_OK)
+		return ret;
+
+	memcpy(data, &rxdata[1], len);
+
+	return S_OK;
+}
+
+static artik_error write_reg(struct k6ds3_config_s *elem, unsigned char reg,
+				unsigned char value)
+{
+	unsigned char buffer[2] = { reg, value };
+
+	return elem->spi->write(elem->hdl, (char *)buffer, 2);
+}
+
+static artik_error read_axes(artik_sensor_handle handle, unsigned char reg,
+				short *axes)
+{
+	struct k6ds3_config_s *elem;
+	unsigned char data[6];
+	artik_error ret;
+	int i;
+
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
+			(ARTIK_LIST_HANDLE) handle);
+
+	if (!elem)
+		return E_NOT_INITIALIZED;
+
+	ret = read_burst(elem, reg, data, 6);
+	if (ret != S_OK)
+		return ret;
+
+	for (i = 0; i < 3; i++)
+		axes[i] = data[2 * i + 1] << 8 | data[2 * i];
+
+	return S_OK;
+}
+
+static artik_error read_xl(artik_sensor_handle handle, int *values)
+{
+	short axes[3];
+	artik_error ret;
+
+	ret = read_axes(handle, K6DS3_REG_OUTX_XL, axes);
+	if (ret != S_OK)
+		return ret;
+
+	values[0] = axes[0];
+	values[1] = axes[1];
+	values[2] = axes[2];
+
+	return S_OK;
+}
+
+static artik_error read_gyro(artik_sensor_handle handle, int *values)
+{
+	short axes[3];
+	artik_error ret;
+
+	ret = read_axes(handle, K6DS3_REG_OUTX_G, axes);
+	if (ret != S_OK)
+		return ret;
+
+	/* Same order as the getters: yaw (Z), roll (Y), pitch (X) */
+	values[0] = axes[2];
+	values[1] = axes[1];
+	values[2] = axes[0];
+
+	return S_OK;
+}
+
+/*
+ * The accelerometer samples are queued in the FIFO in continuous mode,
+ * the gyroscope ones are left out.
+ */
+static artik_error fifo_start(artik_sensor_handle handle,
+						unsigned int *rate_hz)
+{
+	struct k6ds3_config_s *elem;
+	unsigned char odr = 1;
+	artik_error ret;
+
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
+			(ARTIK_LIST_HANDLE) handle);
+
+	if (!elem)
+		return E_NOT_INITIALIZED;
+
+	/* The FIFO and the output data rate are shared by all the users */
+	if (elem->fifo_started)
+		return E_BUSY;
+
+	while (odr < sizeof(odr_hz) / sizeof(odr_hz[0]) - 1 &&
+	       odr_hz[odr] < *rate_hz)
+		odr++;
+
+	/* Going through bypass mode empties the FIFO */
+	ret = write_reg(elem, K6DS3_REG_FIFO_CTRL5, 0);
+	if (ret != S_OK)
+		return ret;
+
+	ret = write_reg(elem, K6DS3_REG_CTRL1_XL, odr << 4);
+	if (ret != S_OK)
+		return ret;
+
+	ret = write_reg(elem, K6DS3_REG_FIFO_CTRL3, K6DS3_FIFO_XL_NO_DEC);
+	if (ret != S_OK)
+		return ret;
+
+	ret = write_reg(elem, K6DS3_REG_FIFO_CTRL5,
+					odr << 3 | K6DS3_FIFO_CONTINUOUS);
+	if (ret != S_OK)
+		return ret;
+
+	*rate_hz = odr_hz[odr];
+	elem->fifo_started = true;
+	elem->xl_rate_hz = odr_hz[odr];
+
+	return S_OK;
+}
+
+static artik_error fifo_read(artik_sensor_handle handle,
+		artik_sensor_sample *samples, int max,
+		struct sensor_fifo_status *status)
+{
+	struct k6ds3_config_s *elem;
+	unsigned char data[K6DS3_MAX_BURST];
+	int words, pattern, count, i;
+	artik_error ret;
+
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
+			(ARTIK_LIST_HANDLE) handle);
+
+	if (!elem)
+		return E_NOT_INITIALIZED;
+
+	ret = read_burst(elem, K6DS3_REG_FIFO_STATUS, data, 4);
+	if (ret != S_OK)
+		return ret;
+
+	words = (data[1] & K6DS3_FIFO_DIFF_H) << 8 | data[0];
+	pattern = (data[3] & K6DS3_FIFO_PATTERN_H) << 8 | data[2];
+	status->overrun = data[1] & K6DS3_FIFO_OVER_RUN;
+
+	/* Drop the end of a sample whose start was lost */
+	if (pattern && words >= K6DS3_FIFO_PATTERN - pattern) {
+		ret = read_burst(elem, K6DS3_REG_FIFO_DATA, data,
+					2 * (K6DS3_FIFO_PATTERN - pattern));
+		if (ret != S_OK)
+			return ret;
+		words -= K6DS3_FIFO_PATTERN - pattern;
+	}
+
+	count = words / K6DS3_FIFO_PATTERN;
+	if (count > max)
+		count = max;
+	if (count > K6DS3_FIFO_BURST)
+		count = K6DS3_FIFO_BURST;
+
+	if (count) {
+		ret = read_burst(elem, K6DS3_REG_FIFO_DATA, data, 6 * count);
+		if (ret != S_OK)
+			return ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		unsigned char *sample = &data[6 * i];
+
+		samples[i].values[0] = (short)(sample[1] << 8 | sample[0]);
+		samples[i].values[1] = (short)(sample[3] << 8 | sample[2]);
+		samples[i].values[2] = (short)(sample[5] << 8 | sample[4]);
+	}
+
+	status->count = count;
+	status->pending = words / K6DS3_FIFO_PATTERN - count;
+
+	return S_OK;
+}
+
+static void fifo_stop(artik_sensor_handle handle)
+{
+	struct k6ds3_config_s *elem;
+
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
+			(ARTIK_LIST_HANDLE) handle);
+
+	if (!elem)
+		return;
+
+	write_reg(elem, K6DS3_REG_FIFO_CTRL5, 0);
+	write_reg(elem, K6DS3_REG_CTRL1_XL, K6DS3_CTRL1_XL_DEFAULT);
+	elem->fifo_started = false;
+	elem->xl_rate_hz = K6DS3_ODR_DEFAULT_HZ;
+}
+
+static artik_error read_vector(artik_sensor_handle handle, unsigned char reg,
+				artik_sensor_vector *vector)
+{
+	short axes[3];
+	artik_error ret;
+
+	if (!vector)
+		return E_BAD_ARGS;
+
+	vector->timestamp_ns = sensor_now_ns();
+	ret = read_axes(handle, reg, axes);
+	if (ret != S_OK)
+		return ret;
+
+	vector->x = axes[0];
+	vector->y = axes[1];
+	vector->z = axes[2];
+
+	return S_OK;
+}
+
+static artik_error read_xl_vector(artik_sensor_handle handle,
+		artik_sensor_vector *vector)
+{
+	return read_vector(handle, K6DS3_REG_OUTX_XL, vector);
+}
+
+static artik_error read_gyro_vector(artik_sensor_handle handle,
+		artik_sensor_vector *vector)
+{
+	return read_vector(handle, K6DS3_REG_OUTX_G, vector);
+}
+
+/*
+ * The accelerometer samples are taken from the FIFO, so that none is
+ * missed or read twice whatever the scheduling of the caller. While the
+ * sampling scheduler drives the FIFO, the output registers are read at
+ * the rate it set instead.
+ */
+static artik_error read_xl_block(artik_sensor_handle handle,
+		artik_sensor_vector *vectors, int count)
+{
+	artik_sensor_sample samples[K6DS3_FIFO_BURST];
+	struct sensor_fifo_status status;
+	unsigned int rate_hz = K6DS3_ODR_DEFAULT_HZ;
+	unsigned long long period_ns, now;
+	struct k6ds3_config_s *elem;
+	artik_error ret;
+	int n = 0, pending = 0, i, wait;
+
+	if (!vectors || count <= 0)
+		return E_BAD_ARGS;
+
+	elem = (struct k6ds3_config_s *)
+		artik_indexed_list_get_by_handle(&k6ds3_list,
+			(ARTIK_LIST_HANDLE) handle);
+
+	if (!elem)
+		return E_NOT_INITIALIZED;
+
+	if (elem->fifo_started)
+		return sensor_read_paced(handle, read_xl_vector,
+					elem->xl_rate_hz, vectors, count);
+
+	ret = fifo_start(handle, &rate_hz);
+	if (ret != S_OK)
+		return ret;
+
+	period_ns = 1000000000ULL / rate_hz;
+
+	while (n < count) {
+		/* Let the FIFO fill up to what is left to read */
+		wait = count - n < K6DS3_FIFO_BURST ? count - n :
+							K6DS3_FIFO_BURST;
+		if (pending < wait)
+			sensor_sleep_until(sensor_now_ns() +
+						(wait - pending) * period_ns);
+
+		ret = fifo_read(handle, samples, count - n, &status);
+		if (ret != S_OK)
+			break;
+
+		if (status.overrun) {
+			ret = E_TRY_AGAIN;
+			break;
+		}
+
+		/* The last sample read is 'pending' periods old */
+		now = sensor_now_ns();
+		for (i = 0; i < status.count; i++, n++) {
+			vectors[n].timestamp_ns = now - (status.count - 1 - i +
+						status.pending) * period_ns;
+			vectors[n].x = samples[i].values[0];
+			vectors[n].y = samples[i].values[1];
+			vectors[n].z = samples[i].values[2];
+		}
+		pending = status.pending;
+	}
+
+	fifo_stop(handle);
+
+	return ret;
+}
+
+static artik_error read_gyro_block(artik_sensor_handle handle,
+		artik_sensor_vector *vectors, int count)
+{
+	return sensor_read_paced(handle, read_gyro_vector,
+				K6DS3_ODR_DEFAULT_HZ, vectors, count);
+}
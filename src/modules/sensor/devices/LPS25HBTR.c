@@ -22,10 +22,13 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_i2c.h"
 #include "artik_sensor.h"
 #include <devices/LPS25HBTR.h>
 
+#include "sensor_device.h"
+
 #define LPS25HBTR_DEVICE_ID		0xBD
 
 #define LPS25HBTR_REG_WHO_AM_I		0x0F
@@ -58,7 +61,16 @@ artik_sensor_pressure lps25hbtr_barometer_sensor = { request,
 artik_sensor_temperature lps25hbtr_temperature_sensor = { request, release,
 		get_celsius, get_fahrenheit };
 
-static artik_list *lps25hbtr_list = NULL;
+static artik_error read_pressure(artik_sensor_handle handle, int *values);
+static artik_error read_temp(artik_sensor_handle handle, int *values);
+
+const struct sensor_device lps25hbtr_barometer_device = {
+		&lps25hbtr_barometer_sensor, read_pressure };
+
+const struct sensor_device lps25hbtr_temperature_device = {
+		&lps25hbtr_temperature_sensor, read_temp };
+
+static artik_indexed_list lps25hbtr_list;
 
 static int check_exist(struct lps25hbtr_handle_s *elem, int id)
 {
@@ -76,7 +88,7 @@ static artik_error initialize(artik_i2c_module *i2c, artik_i2c_handle handle)
 	if (ret != S_OK)
 		return ret;
 
-	if (buffer != LPS25HBTR_DEVICE_ID)
+	if ((unsigned char)buffer != LPS25HBTR_DEVICE_ID)
 		return E_NOT_SUPPORTED;
 
 	/*
@@ -102,15 +114,16 @@ static artik_error request(artik_sensor_handle *handle,
 	artik_i2c_module *i2c;
 	struct lps25hbtr_handle_s *elem;
 
-	elem = (struct lps25hbtr_handle_s *) artik_list_get_by_check(
-			lps25hbtr_list, (ARTIK_LIST_FUNCB) check_exist,
+	elem = (struct lps25hbtr_handle_s *) artik_indexed_list_get_by_check(
+			&lps25hbtr_list, (ARTIK_LIST_FUNCB) check_exist,
 			(void *)(intptr_t) ((artik_i2c_config *) config->config)->id);
 	int ret;
 
 	if (elem)
 		return E_BUSY;
 
-	elem = (struct lps25hbtr_handle_s *) artik_list_add(&lps25hbtr_list, 0,
+	elem = (struct lps25hbtr_handle_s *)
+		artik_indexed_list_add(&lps25hbtr_list, 0,
 			sizeof(struct lps25hbtr_handle_s));
 
 	if (elem) {
@@ -155,15 +168,16 @@ static artik_error release(artik_sensor_handle handle)
 {
 	struct lps25hbtr_handle_s *elem;
 
-	elem = (struct lps25hbtr_handle_s *) artik_list_get_by_handle(
-			lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
+	elem = (struct lps25hbtr_handle_s *) artik_indexed_list_get_by_handle(
+			&lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
 
 	if (elem) {
-		artik_list_delete_node(&lps25hbtr_list, (artik_list *) elem);
 		if (elem->i2c) {
 			(void)elem->i2c->release(elem->hdl);
 			artik_release_api_module(elem->i2c);
 		}
+		artik_indexed_list_delete_node(&lps25hbtr_list,
+				(artik_list *) elem);
 	}
 
 	return S_OK;
@@ -171,7 +185,7 @@ static artik_error release(artik_sensor_handle handle)
 
 static artik_error get_pressure(artik_sensor_handle handle, int *store)
 {
-	char buffer[3];
+	unsigned char buffer[3];
 	struct lps25hbtr_handle_s *lps25hbtr;
 	int ret;
 
@@ -180,24 +194,16 @@ static artik_error get_pressure(artik_sensor_handle handle, int *store)
 
 	*store = -1;
 
-	lps25hbtr = (struct lps25hbtr_handle_s *) artik_list_get_by_handle(
-			lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
+	lps25hbtr =
+		(struct lps25hbtr_handle_s *) artik_indexed_list_get_by_handle(
+			&lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
 
 	if (!lps25hbtr)
 		return E_INVALID_VALUE;
 
 	ret = lps25hbtr->i2c->read_register(lps25hbtr->hdl,
-			LPS25HBTR_REG_PRESS_OUT_XL, &buffer[0], 1);
-	if (ret < 0)
-		return ret;
-
-	ret = lps25hbtr->i2c->read_register(lps25hbtr->hdl,
-			LPS25HBTR_REG_PRESS_OUT_L, &buffer[1], 1);
-	if (ret < 0)
-		return ret;
-
-	ret = lps25hbtr->i2c->read_register(lps25hbtr->hdl,
-			LPS25HBTR_REG_PRESS_OUT_H, &buffer[2], 1);
+			LPS25HBTR_REG_PRESS_OUT_XL | AUTO_INC, (char *)buffer,
+			3);
 	if (ret < 0)
 		return ret;
 
@@ -218,8 +224,9 @@ static artik_error get_celsius(artik_sensor_handle handle, int *store)
 
 	*store = -1;
 
-	lps25hbtr = (struct lps25hbtr_handle_s *) artik_list_get_by_handle(
-			lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
+	lps25hbtr =
+		(struct lps25hbtr_handle_s *) artik_indexed_list_get_by_handle(
+			&lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
 
 	if (!lps25hbtr)
 		return E_INVALID_VALUE;
@@ -245,8 +252,9 @@ static artik_error get_fahrenheit(artik_sensor_handle handle, int *store)
 
 	*store = -1;
 
-	lps25hbtr = (struct lps25hbtr_handle_s *) artik_list_get_by_handle(
-			lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
+	lps25hbtr =
+		(struct lps25hbtr_handle_s *) artik_indexed_list_get_by_handle(
+			&lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
 
 	if (!lps25hbtr)
 		return E_INVALID_VALUE;
@@ -265,3 +273,34 @@ static artik_error get_fahrenheit(artik_sensor_handle handle, int *store)
 
 	return ret;
 }
+
+static artik_error read_pressure(artik_sensor_handle handle, int *values)
+{
+	return get_pressure(handle, &values[0]);
+}
+
+static artik_error read_temp(artik_sensor_handle handle, int *values)
+{
+	double celsius;
+	short data;
+	struct lps25hbtr_handle_s *lps25hbtr;
+	int ret;
+
+	lps25hbtr =
+		(struct lps25hbtr_handle_s *) artik_indexed_list_get_by_handle(
+			&lps25hbtr_list, (ARTIK_LIST_HANDLE) handle);
+
+	if (!lps25hbtr)
+		return E_INVALID_VALUE;
+
+	ret = lps25hbtr->i2c->read_register(lps25hbtr->hdl,
+			LPS25HBTR_REG_TEMP_OUT_L | AUTO_INC, (char *)&data, 2);
+	if (ret < 0)
+		return ret;
+
+	celsius = ((double)data) / 480.0 + 42.5;
+	values[0] = (int)celsius;
+	values[1] = (int)(celsius * 1.8 + 32);
+
+	return S_OK;
+}
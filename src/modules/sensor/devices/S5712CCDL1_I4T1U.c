@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_gpio.h"
 #include "artik_sensor.h"
 
@@ -40,7 +41,7 @@ struct s5712ccdl1_handle_s {
 	int pin_gpio;
 };
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(struct s5712ccdl1_handle_s *elem, int val_pin)
 {
@@ -56,14 +57,15 @@ static artik_error request(artik_sensor_handle *handle, artik_sensor_config
 	struct s5712ccdl1_handle_s *elem;
 	artik_error res = S_OK;
 
-	elem = (struct s5712ccdl1_handle_s *) artik_list_get_by_check(
-			requested_node, (ARTIK_LIST_FUNCB) check_exist,
+	elem = (struct s5712ccdl1_handle_s *) artik_indexed_list_get_by_check(
+			&requested_node, (ARTIK_LIST_FUNCB) check_exist,
 			(void *)(intptr_t) ((artik_gpio_config *) config->config)->id);
 
 	if (elem)
 		return E_BUSY;
 
-	elem = (struct s5712ccdl1_handle_s *) artik_list_add(&requested_node, 0,
+	elem = (struct s5712ccdl1_handle_s *)
+		artik_indexed_list_add(&requested_node, 0,
 			sizeof(struct s5712ccdl1_handle_s));
 
 	if (elem) {
@@ -97,8 +99,9 @@ static artik_error release(artik_sensor_handle handle)
 {
 	struct s5712ccdl1_handle_s *data_user;
 
-	data_user = (struct s5712ccdl1_handle_s *) artik_list_get_by_handle(
-			requested_node, (ARTIK_LIST_HANDLE) handle);
+	data_user =
+		(struct s5712ccdl1_handle_s *) artik_indexed_list_get_by_handle(
+			&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	if (data_user) {
 		if (data_user->module_gpio) {
@@ -107,7 +110,8 @@ static artik_error release(artik_sensor_handle handle)
 			artik_release_api_module(data_user->module_gpio);
 		}
 
-	  artik_list_delete_node(&requested_node, (artik_list *)data_user);
+	  artik_indexed_list_delete_node(&requested_node,
+	  		(artik_list *)data_user);
 	}
 
 	return S_OK;
@@ -117,8 +121,9 @@ static artik_error get_detection(artik_sensor_handle handle, int *store)
 {
 	struct s5712ccdl1_handle_s *data_user;
 
-	data_user = (struct s5712ccdl1_handle_s *) artik_list_get_by_handle(
-			requested_node, (ARTIK_LIST_HANDLE) handle);
+	data_user =
+		(struct s5712ccdl1_handle_s *) artik_indexed_list_get_by_handle(
+			&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	int res = 0;
 
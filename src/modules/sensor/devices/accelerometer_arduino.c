@@ -22,24 +22,38 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_i2c.h"
 #include "artik_sensor.h"
 
 #include <devices/accelerometer_arduino.h>
 
+#include "sensor_device.h"
+
+/* Output data rate set in CTRL_REG1 on request */
+#define ACCELEROMETER_RATE_HZ	50
+/* Set on the register address to read several registers in sequence */
+#define ACCELEROMETER_AUTO_INC	0x80
+
 static artik_error accelerometer_request(artik_sensor_handle *,
 							artik_sensor_config*);
 static artik_error accelerometer_release(artik_sensor_handle);
 static artik_error accelerometer_get_speed_x(artik_sensor_handle, int *);
 static artik_error accelerometer_get_speed_y(artik_sensor_handle, int *);
 static artik_error accelerometer_get_speed_z(artik_sensor_handle, int *);
+static artik_error accelerometer_read_vector(artik_sensor_handle,
+							artik_sensor_vector *);
+static artik_error accelerometer_read_block(artik_sensor_handle,
+						artik_sensor_vector *, int);
 
 artik_sensor_accelerometer accelerometer_arduino_sensor = {
 	accelerometer_request,
 	accelerometer_release,
 	accelerometer_get_speed_x,
 	accelerometer_get_speed_y,
-	accelerometer_get_speed_z
+	accelerometer_get_speed_z,
+	accelerometer_read_vector,
+	accelerometer_read_block
 };
 
 typedef struct {
@@ -52,7 +66,7 @@ typedef struct {
 	int speed_z;
 } sensor_accelerometer;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_accelerometer *elem, int val_id)
 {
@@ -65,7 +79,7 @@ static artik_error accelerometer_request(artik_sensor_handle *handle,
 						artik_sensor_config *config)
 {
 	sensor_accelerometer *elem = (sensor_accelerometer *)
-				artik_list_get_by_check(requested_node,
+				artik_indexed_list_get_by_check(&requested_node,
 					(ARTIK_LIST_FUNCB)&check_exist,
 					(void *)(intptr_t)((artik_i2c_config *)
 						config->config)->id);
@@ -74,7 +88,8 @@ static artik_error accelerometer_request(artik_sensor_handle *handle,
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_accelerometer *) artik_list_add(&requested_node, 0,
+	elem = (sensor_accelerometer *)
+		artik_indexed_list_add(&requested_node, 0,
 						sizeof(sensor_accelerometer));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE) elem;
@@ -111,7 +126,7 @@ static artik_error accelerometer_request(artik_sensor_handle *handle,
 static artik_error accelerometer_release(artik_sensor_handle handle)
 {
 	sensor_accelerometer *data_user = (sensor_accelerometer *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
@@ -125,7 +140,7 @@ static artik_error accelerometer_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_i2c);
 		}
-		artik_list_delete_node(&requested_node, (artik_list *)
+		artik_indexed_list_delete_node(&requested_node, (artik_list *)
 								data_user);
 	}
 	return S_OK;
@@ -135,7 +150,7 @@ static artik_error accelerometer_get_speed_x(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_accelerometer *data_user = (sensor_accelerometer *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	int res = 0;
 	short buffer = 0;
@@ -159,7 +174,7 @@ static artik_error accelerometer_get_speed_y(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_accelerometer *data_user = (sensor_accelerometer *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	int res = 0;
 	short buffer = 0;
@@ -183,7 +198,7 @@ static artik_error accelerometer_get_speed_z(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_accelerometer *data_user = (sensor_accelerometer *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	int res = 0;
 	short buffer = 0;
@@ -202,3 +217,40 @@ static artik_error accelerometer_get_speed_z(artik_sensor_handle handle,
 	*store = -1;
 	return E_INVALID_VALUE;
 }
+
+static artik_error accelerometer_read_vector(artik_sensor_handle handle,
+						artik_sensor_vector *vector)
+{
+	sensor_accelerometer *data_user = (sensor_accelerometer *)
+		artik_indexed_list_get_by_handle(&requested_node,
+						(ARTIK_LIST_HANDLE)handle);
+	unsigned char buffer[6];
+	artik_error res;
+
+	if (!vector)
+		return E_BAD_ARGS;
+	if (!data_user)
+		return E_INVALID_VALUE;
+
+	vector->timestamp_ns = sensor_now_ns();
+	res = data_user->module_i2c->read_register((artik_i2c_handle)
+		data_user->handle_sensor, 0x28 | ACCELEROMETER_AUTO_INC,
+							(char *)buffer, 6);
+	if (res != S_OK)
+		return res;
+
+	data_user->speed_x = (short)(buffer[1] << 8 | buffer[0]);
+	data_user->speed_y = (short)(buffer[3] << 8 | buffer[2]);
+	data_user->speed_z = (short)(buffer[5] << 8 | buffer[4]);
+	vector->x = data_user->speed_x;
+	vector->y = data_user->speed_y;
+	vector->z = data_user->speed_z;
+	return S_OK;
+}
+
+static artik_error accelerometer_read_block(artik_sensor_handle handle,
+					artik_sensor_vector *vectors, int count)
+{
+	return sensor_read_paced(handle, accelerometer_read_vector,
+				ACCELEROMETER_RATE_HZ, vectors, count);
+}
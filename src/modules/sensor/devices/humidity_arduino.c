@@ -21,6 +21,7 @@
 #include <stdint.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_adc.h"
 #include "artik_sensor.h"
 
@@ -45,7 +46,7 @@ typedef struct {
 	int wet;
 } sensor_humidity;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_humidity *elem, int val_pin)
 {
@@ -57,15 +58,15 @@ static int check_exist(sensor_humidity *elem, int val_pin)
 static artik_error humidity_request(artik_sensor_handle *handle,
 						artik_sensor_config *config)
 {
-	sensor_humidity *elem =
-		(sensor_humidity *)artik_list_get_by_check(requested_node,
+	sensor_humidity *elem = (sensor_humidity *)
+		artik_indexed_list_get_by_check(&requested_node,
 			(ARTIK_LIST_FUNCB)&check_exist,
 			(void *)(intptr_t)((artik_adc_config *)config->config)->pin_num);
 	artik_error res = S_OK;
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_humidity *)artik_list_add(&requested_node, 0,
+	elem = (sensor_humidity *)artik_indexed_list_add(&requested_node, 0,
 						sizeof(sensor_humidity));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE)elem;
@@ -89,8 +90,8 @@ static artik_error humidity_request(artik_sensor_handle *handle,
 
 static artik_error humidity_release(artik_sensor_handle handle)
 {
-	sensor_humidity *data_user =
-		(sensor_humidity *)artik_list_get_by_handle(requested_node,
+	sensor_humidity *data_user = (sensor_humidity *)
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
@@ -99,7 +100,7 @@ static artik_error humidity_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_adc);
 		}
-		artik_list_delete_node(&requested_node,
+		artik_indexed_list_delete_node(&requested_node,
 						(artik_list *)data_user);
 	}
 
@@ -108,8 +109,8 @@ static artik_error humidity_release(artik_sensor_handle handle)
 
 static artik_error humidity_get_humidity(artik_sensor_handle handle, int *store)
 {
-	sensor_humidity *data_user =
-		(sensor_humidity *)artik_list_get_by_handle(requested_node,
+	sensor_humidity *data_user = (sensor_humidity *)
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	artik_error ret = S_OK;
 	int res = 0;
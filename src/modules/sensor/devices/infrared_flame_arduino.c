@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_gpio.h"
 #include "artik_sensor.h"
 
@@ -44,7 +45,7 @@ typedef struct {
 	int signals;
 } sensor_flame;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_flame *elem, int val_pin)
 {
@@ -56,14 +57,14 @@ static int check_exist(sensor_flame *elem, int val_pin)
 static artik_error flame_request(artik_sensor_handle *handle,
 				 artik_sensor_config *config)
 {
-	sensor_flame *elem = (sensor_flame *) artik_list_get_by_check(
-		requested_node, (ARTIK_LIST_FUNCB)&check_exist,
+	sensor_flame *elem = (sensor_flame *) artik_indexed_list_get_by_check(
+		&requested_node, (ARTIK_LIST_FUNCB)&check_exist,
 		(void *)(intptr_t)((artik_gpio_config *)config->config)->id);
 	artik_error res = S_OK;
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_flame *)artik_list_add(&requested_node, 0,
+	elem = (sensor_flame *)artik_indexed_list_add(&requested_node, 0,
 							sizeof(sensor_flame));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE)elem;
@@ -87,8 +88,9 @@ static artik_error flame_request(artik_sensor_handle *handle,
 
 static artik_error flame_release(artik_sensor_handle handle)
 {
-	sensor_flame *data_user = (sensor_flame *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	sensor_flame *data_user =
+		(sensor_flame *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
 		if (data_user->module_gpio) {
@@ -96,7 +98,7 @@ static artik_error flame_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_gpio);
 		}
-		artik_list_delete_node(&requested_node,
+		artik_indexed_list_delete_node(&requested_node,
 						(artik_list *)data_user);
 	}
 
@@ -105,8 +107,9 @@ static artik_error flame_release(artik_sensor_handle handle)
 
 static artik_error flame_get_signals(artik_sensor_handle handle, int *store)
 {
-	sensor_flame *data_user = (sensor_flame *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	sensor_flame *data_user =
+		(sensor_flame *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 	int res = 0;
 
 	if (!store)
@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_adc.h"
 #include "artik_sensor.h"
 
@@ -45,7 +46,7 @@ typedef struct {
 	int intensity;
 } sensor_light;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_light *elem, int val_pin)
 {
@@ -57,14 +58,14 @@ static int check_exist(sensor_light *elem, int val_pin)
 static artik_error light_request(artik_sensor_handle *handle,
 						artik_sensor_config *config)
 {
-	sensor_light *elem = (sensor_light *)artik_list_get_by_check(
-		requested_node, (ARTIK_LIST_FUNCB)&check_exist,
+	sensor_light *elem = (sensor_light *)artik_indexed_list_get_by_check(
+		&requested_node, (ARTIK_LIST_FUNCB)&check_exist,
 			(void *)(intptr_t)((artik_adc_config *)config->config)->pin_num);
 	artik_error res = S_OK;
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_light *)artik_list_add(&requested_node, 0,
+	elem = (sensor_light *)artik_indexed_list_add(&requested_node, 0,
 							sizeof(sensor_light));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE)elem;
@@ -88,8 +89,9 @@ static artik_error light_request(artik_sensor_handle *handle,
 
 static artik_error light_release(artik_sensor_handle handle)
 {
-	sensor_light *data_user = (sensor_light *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	sensor_light *data_user =
+		(sensor_light *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
 		if (data_user->module_adc) {
@@ -97,15 +99,17 @@ static artik_error light_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_adc);
 		}
-	  artik_list_delete_node(&requested_node, (artik_list *)data_user);
+	  artik_indexed_list_delete_node(&requested_node,
+	  		(artik_list *)data_user);
 	}
 	return S_OK;
 }
 
 static artik_error light_get_intensity(artik_sensor_handle handle, int *store)
 {
-	sensor_light *data_user = (sensor_light *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE)handle);
+	sensor_light *data_user =
+		(sensor_light *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE)handle);
 	artik_error ret = S_OK;
 	int res = 0;
 
@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_gpio.h"
 #include "artik_sensor.h"
 
@@ -46,7 +47,7 @@ typedef struct {
 	int presence;
 } sensor_proximity;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_proximity *elem, int val_pin)
 {
@@ -58,14 +59,15 @@ static int check_exist(sensor_proximity *elem, int val_pin)
 static artik_error proximity_request(artik_sensor_handle *handle,
 						artik_sensor_config *config)
 {
-	sensor_proximity *elem = (sensor_proximity *)artik_list_get_by_check(
-		requested_node, (ARTIK_LIST_FUNCB)&check_exist,
+	sensor_proximity *elem =
+		(sensor_proximity *)artik_indexed_list_get_by_check(
+		&requested_node, (ARTIK_LIST_FUNCB)&check_exist,
 		(void *)(intptr_t)((artik_gpio_config *)config->config)->id);
 	artik_error res = S_OK;
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_proximity *)artik_list_add(&requested_node, 0,
+	elem = (sensor_proximity *)artik_indexed_list_add(&requested_node, 0,
 		sizeof(sensor_proximity));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE)elem;
@@ -90,7 +92,7 @@ static artik_error proximity_request(artik_sensor_handle *handle,
 static artik_error proximity_release(artik_sensor_handle handle)
 {
 	sensor_proximity *data_user = (sensor_proximity *)
-			artik_list_get_by_handle(requested_node,
+			artik_indexed_list_get_by_handle(&requested_node,
 			(ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
@@ -99,7 +101,8 @@ static artik_error proximity_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_gpio);
 		}
-	  artik_list_delete_node(&requested_node, (artik_list *)data_user);
+	  artik_indexed_list_delete_node(&requested_node,
+	  		(artik_list *)data_user);
 	}
 
 	return S_OK;
@@ -109,7 +112,7 @@ static artik_error proximity_get_presence(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_proximity *data_user = (sensor_proximity *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	int res = 0;
 
@@ -0,0 +1,78 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include "sensor_device.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+unsigned long long sensor_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void sensor_sleep_until(unsigned long long deadline_ns)
+{
+	struct timespec ts;
+
+	ts.tv_sec = deadline_ns / NSEC_PER_SEC;
+	ts.tv_nsec = deadline_ns % NSEC_PER_SEC;
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+									EINTR)
+		;
+}
+
+artik_error sensor_read_paced(artik_sensor_handle handle,
+		artik_error (*read_vector)(artik_sensor_handle handle,
+					artik_sensor_vector *vector),
+		unsigned int rate_hz, artik_sensor_vector *vectors,
+		int count)
+{
+	unsigned long long period_ns, next;
+	artik_error ret;
+	int i;
+
+	if (!vectors || count <= 0 || !rate_hz)
+		return E_BAD_ARGS;
+
+	period_ns = NSEC_PER_SEC / rate_hz;
+	next = sensor_now_ns();
+
+	for (i = 0; i < count; i++) {
+		if (i)
+			sensor_sleep_until(next);
+
+		ret = read_vector(handle, &vectors[i]);
+		if (ret != S_OK)
+			return ret;
+
+		/* Do not read the same sample twice to catch up when late */
+		next += period_ns;
+		if (vectors[i].timestamp_ns > next)
+			next = vectors[i].timestamp_ns + period_ns;
+	}
+
+	return S_OK;
+}
@@ -0,0 +1,80 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef SENSOR_DEVICE_H_
+#define SENSOR_DEVICE_H_
+
+#include "artik_error.h"
+#include "artik_sensor.h"
+
+/*
+ * Optional operations of a sensor driver used by the sampling scheduler,
+ * for reading a whole sample in one bus transaction. Drivers without
+ * them are sampled through their getters.
+ */
+
+struct sensor_fifo_status {
+	/* Samples read */
+	int count;
+	/* Samples left in the FIFO after them */
+	int pending;
+	/* Samples were lost since the previous read */
+	bool overrun;
+};
+
+struct sensor_device {
+	/* Public operations of the sensor, e.g. &k6ds3_xl_sensor */
+	const void *ops;
+	/* Read the values of a sample, as returned by the getters */
+	artik_error (*read)(artik_sensor_handle handle, int *values);
+	/*
+	 * Optional hardware FIFO. fifo_start rounds 'rate_hz' up to a
+	 * rate supported by the device, fifo_read takes up to 'max' of
+	 * the oldest samples without setting their timestamp.
+	 */
+	artik_error (*fifo_start)(artik_sensor_handle handle,
+						unsigned int *rate_hz);
+	artik_error (*fifo_read)(artik_sensor_handle handle,
+			artik_sensor_sample *samples, int max,
+			struct sensor_fifo_status *status);
+	void (*fifo_stop)(artik_sensor_handle handle);
+};
+
+/* Current time in nanoseconds, on the clock of the sample timestamps */
+unsigned long long sensor_now_ns(void);
+void sensor_sleep_until(unsigned long long deadline_ns);
+
+/*
+ * Fill 'vectors' with 'count' calls to 'read_vector', one every period
+ * of 'rate_hz', for devices whose output registers are only refreshed
+ * at that rate.
+ */
+artik_error sensor_read_paced(artik_sensor_handle handle,
+		artik_error (*read_vector)(artik_sensor_handle handle,
+					artik_sensor_vector *vector),
+		unsigned int rate_hz, artik_sensor_vector *vectors,
+		int count);
+
+extern const struct sensor_device k6ds3_xl_device;
+extern const struct sensor_device k6ds3_gyro_device;
+extern const struct sensor_device hts221_humidity_device;
+extern const struct sensor_device hts221_temp_device;
+extern const struct sensor_device lps25hbtr_barometer_device;
+extern const struct sensor_device lps25hbtr_temperature_device;
+
+#endif /* SENSOR_DEVICE_H_ */
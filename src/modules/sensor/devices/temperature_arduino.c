@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "artik_module.h"
+#include "artik_indexed_list.h"
 #include "artik_adc.h"
 #include "artik_sensor.h"
 
@@ -49,7 +50,7 @@ typedef struct {
 	int degreeF;
 } sensor_temperature;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(sensor_temperature *elem, int val_pin)
 {
@@ -61,8 +62,8 @@ static int check_exist(sensor_temperature *elem, int val_pin)
 static artik_error temperature_request(artik_sensor_handle *handle,
 					artik_sensor_config *config)
 {
-	sensor_temperature *elem =
-		(sensor_temperature *)artik_list_get_by_check(requested_node,
+	sensor_temperature *elem = (sensor_temperature *)
+		artik_indexed_list_get_by_check(&requested_node,
 			(ARTIK_LIST_FUNCB)&check_exist,
 			(void *)(intptr_t)((artik_adc_config *)config->config)->pin_num);
 
@@ -70,7 +71,7 @@ static artik_error temperature_request(artik_sensor_handle *handle,
 
 	if (elem)
 		return E_BUSY;
-	elem = (sensor_temperature *)artik_list_add(&requested_node, 0,
+	elem = (sensor_temperature *)artik_indexed_list_add(&requested_node, 0,
 						sizeof(sensor_temperature));
 	if (elem) {
 		elem->node.handle = (ARTIK_LIST_HANDLE)elem;
@@ -95,7 +96,7 @@ static artik_error temperature_request(artik_sensor_handle *handle,
 static artik_error temperature_release(artik_sensor_handle handle)
 {
 	sensor_temperature *data_user = (sensor_temperature *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 
 	if (data_user) {
@@ -104,7 +105,7 @@ static artik_error temperature_release(artik_sensor_handle handle)
 						data_user->handle_sensor);
 			artik_release_api_module(data_user->module_adc);
 		}
-		artik_list_delete_node(&requested_node,
+		artik_indexed_list_delete_node(&requested_node,
 						(artik_list *)data_user);
 	}
 
@@ -115,7 +116,7 @@ static artik_error temperature_get_celsius(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_temperature *data_user = (sensor_temperature *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	artik_error ret = S_OK;
 	int res = 0;
@@ -146,7 +147,7 @@ static artik_error temperature_get_fahrenheit(artik_sensor_handle handle,
 								int *store)
 {
 	sensor_temperature *data_user = (sensor_temperature *)
-		artik_list_get_by_handle(requested_node,
+		artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE)handle);
 	artik_error ret = S_OK;
 	int res = 0;
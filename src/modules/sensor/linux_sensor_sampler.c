@@ -0,0 +1,531 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "artik_log.h"
+#include "artik_loop.h"
+#include "artik_module.h"
+#include "os_sensor.h"
+#include "sensor_ring.h"
+#include "devices/sensor_device.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+/*
+ * All the sensors being sampled are read from a single timerfd watched by
+ * the loop, armed on the earliest deadline. Deadlines are multiples of the
+ * sampling period, so that sensors sampled at related rates are read in
+ * the same wake up.
+ */
+
+struct sensor_sampling {
+	struct sensor_sampling *next;
+	artik_sensor_device_t type;
+	artik_sensor_ops ops;
+	artik_sensor_handle handle;
+	/* NULL when the sensor is read through its getters */
+	const struct sensor_device *device;
+	bool fifo;
+	/* Time between two reads, and between two samples */
+	unsigned long long period_ns;
+	unsigned long long sample_ns;
+	unsigned long long next_ns;
+	artik_sensor_sample *batch;
+	int batch_size;
+	int batch_count;
+	artik_sensor_samples_callback callback;
+	void *user_data;
+	/* Shared with the readers, NULL if there are none */
+	struct sensor_ring *ring;
+	artik_sensor_sampling_stats stats;
+	/* Stopped from a callback, freed at the end of the pass */
+	bool stopped;
+};
+
+struct sensor_sampler {
+	struct sensor_sampling *samplings;
+	artik_loop_module *loop;
+	int timer_fd;
+	int watch_id;
+	bool dispatching;
+};
+
+static struct sensor_sampler sampler = { NULL, NULL, -1, 0, false };
+
+static const struct sensor_device *devices[] = {
+	&k6ds3_xl_device,
+	&k6ds3_gyro_device,
+	&hts221_humidity_device,
+	&hts221_temp_device,
+	&lps25hbtr_barometer_device,
+	&lps25hbtr_temperature_device,
+};
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static const struct sensor_device *find_device(artik_sensor_ops ops)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+		if (devices[i]->ops == ops)
+			return devices[i];
+
+	return NULL;
+}
+
+/* Returns the number of getters called, or an error */
+static int read_getters(struct sensor_sampling *s, int *values)
+{
+	artik_sensor_handle h = s->handle;
+	artik_error ret;
+
+	switch (s->type) {
+	case ARTIK_SENSOR_ACCELEROMETER: {
+		artik_sensor_accelerometer *ops = s->ops;
+
+		ret = ops->get_speed_x(h, &values[0]);
+		if (ret == S_OK)
+			ret = ops->get_speed_y(h, &values[1]);
+		if (ret == S_OK)
+			ret = ops->get_speed_z(h, &values[2]);
+		return ret == S_OK ? 3 : ret;
+	}
+	case ARTIK_SENSOR_GYRO: {
+		artik_sensor_gyro *ops = s->ops;
+
+		ret = ops->get_yaw(h, &values[0]);
+		if (ret == S_OK)
+			ret = ops->get_roll(h, &values[1]);
+		if (ret == S_OK)
+			ret = ops->get_pitch(h, &values[2]);
+		return ret == S_OK ? 3 : ret;
+	}
+	case ARTIK_SENSOR_TEMPERATURE: {
+		artik_sensor_temperature *ops = s->ops;
+
+		ret = ops->get_celsius(h, &values[0]);
+		if (ret == S_OK)
+			ret = ops->get_fahrenheit(h, &values[1]);
+		return ret == S_OK ? 2 : ret;
+	}
+	case ARTIK_SENSOR_HUMIDITY:
+		ret = ((artik_sensor_humidity *)s->ops)->get_humidity(h,
+								&values[0]);
+		break;
+	case ARTIK_SENSOR_LIGHT:
+		ret = ((artik_sensor_light *)s->ops)->get_intensity(h,
+								&values[0]);
+		break;
+	case ARTIK_SENSOR_PROXIMITY:
+		ret = ((artik_sensor_proximity *)s->ops)->get_presence(h,
+								&values[0]);
+		break;
+	case ARTIK_SENSOR_FLAME:
+		ret = ((artik_sensor_flame *)s->ops)->get_signals(h,
+								&values[0]);
+		break;
+	case ARTIK_SENSOR_BAROMETER:
+		ret = ((artik_sensor_pressure *)s->ops)->get_pressure(h,
+								&values[0]);
+		break;
+	case ARTIK_SENSOR_HALL:
+		ret = ((artik_sensor_hall *)s->ops)->get_detection(h,
+								&values[0]);
+		break;
+	default:
+		return E_NOT_SUPPORTED;
+	}
+
+	return ret == S_OK ? 1 : ret;
+}
+
+static void deliver(struct sensor_sampling *s)
+{
+	int count = s->batch_count;
+
+	s->batch_count = 0;
+	s->stats.samples += count;
+	if (s->ring)
+		sensor_ring_push(s->ring, s->batch, count);
+	if (s->callback)
+		s->callback(s->user_data, s->batch, count);
+}
+
+static void read_sample(struct sensor_sampling *s)
+{
+	artik_sensor_sample *sample = &s->batch[s->batch_count];
+	int ret;
+
+	memset(sample, 0, sizeof(*sample));
+	sample->timestamp_ns = now_ns();
+
+	if (s->device) {
+		ret = s->device->read(s->handle, sample->values);
+		s->stats.reads++;
+	} else {
+		ret = read_getters(s, sample->values);
+		s->stats.reads += ret > 0 ? ret : 1;
+	}
+
+	if (ret < 0) {
+		s->stats.errors++;
+		return;
+	}
+
+	if (++s->batch_count == s->batch_size)
+		deliver(s);
+}
+
+/* Samples left in the FIFO are newer, the last one is taken 'now' */
+static void read_fifo(struct sensor_sampling *s, unsigned long long now)
+{
+	struct sensor_fifo_status status;
+	artik_sensor_sample *samples;
+	artik_error ret;
+	int i;
+
+	do {
+		samples = &s->batch[s->batch_count];
+		ret = s->device->fifo_read(s->handle, samples,
+				s->batch_size - s->batch_count, &status);
+		s->stats.reads++;
+		if (ret != S_OK) {
+			s->stats.errors++;
+			return;
+		}
+
+		if (status.overrun)
+			s->stats.missed++;
+
+		for (i = 0; i < status.count; i++)
+			samples[i].timestamp_ns = now - (status.pending +
+				status.count - 1 - i) * s->sample_ns;
+
+		s->batch_count += status.count;
+		if (s->batch_count == s->batch_size) {
+			deliver(s);
+			if (s->stopped)
+				return;
+		}
+	} while (status.count && status.pending);
+}
+
+static void schedule_next(struct sensor_sampling *s, unsigned long long now)
+{
+	unsigned long long late;
+
+	s->next_ns += s->period_ns;
+	if (s->next_ns > now)
+		return;
+
+	/* Skip the periods that were missed instead of catching up */
+	late = (now - s->next_ns) / s->period_ns + 1;
+	s->next_ns += late * s->period_ns;
+	if (!s->fifo)
+		s->stats.missed += late;
+}
+
+static void arm_timer(void)
+{
+	struct itimerspec its;
+	struct sensor_sampling *s;
+	unsigned long long next = 0;
+
+	for (s = sampler.samplings; s; s = s->next)
+		if (!s->stopped && (!next || s->next_ns < next))
+			next = s->next_ns;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = next / NSEC_PER_SEC;
+	its.it_value.tv_nsec = next % NSEC_PER_SEC;
+	timerfd_settime(sampler.timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void free_sampling(struct sensor_sampling *s)
+{
+	if (s->fifo)
+		s->device->fifo_stop(s->handle);
+	if (s->ring)
+		sensor_ring_release(s->ring);
+	free(s->batch);
+	free(s);
+}
+
+static void stop_sampler(void)
+{
+	if (sampler.watch_id)
+		sampler.loop->remove_fd_watch(sampler.watch_id);
+	sampler.watch_id = 0;
+	if (sampler.timer_fd >= 0)
+		close(sampler.timer_fd);
+	sampler.timer_fd = -1;
+	if (sampler.loop)
+		artik_release_api_module(sampler.loop);
+	sampler.loop = NULL;
+}
+
+static void remove_stopped(void)
+{
+	struct sensor_sampling **prev = &sampler.samplings;
+
+	while (*prev) {
+		struct sensor_sampling *s = *prev;
+
+		if (s->stopped) {
+			*prev = s->next;
+			free_sampling(s);
+		} else {
+			prev = &s->next;
+		}
+	}
+}
+
+static int sampler_callback(int fd, enum watch_io io, void *user_data)
+{
+	struct sensor_sampling *s;
+	unsigned long long now;
+	uint64_t expirations;
+
+	if (read(fd, &expirations, sizeof(expirations)) < 0 &&
+	    errno != EAGAIN)
+		log_err("Failed to read sampling timer");
+
+	now = now_ns();
+	sampler.dispatching = true;
+	for (s = sampler.samplings; s; s = s->next) {
+		if (s->stopped || s->next_ns > now)
+			continue;
+
+		if (s->fifo)
+			read_fifo(s, now);
+		else
+			read_sample(s);
+
+		schedule_next(s, now);
+	}
+	sampler.dispatching = false;
+
+	remove_stopped();
+	if (!sampler.samplings) {
+		/* The watch is removed by returning 0 */
+		sampler.watch_id = 0;
+		stop_sampler();
+		return 0;
+	}
+
+	arm_timer();
+
+	return 1;
+}
+
+static artik_error start_sampler(void)
+{
+	artik_error ret;
+
+	sampler.loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!sampler.loop) {
+		log_err("Failed to request loop module");
+		return E_BUSY;
+	}
+
+	sampler.timer_fd = timerfd_create(CLOCK_MONOTONIC,
+						TFD_NONBLOCK | TFD_CLOEXEC);
+	if (sampler.timer_fd < 0) {
+		log_err("Failed to create sampling timer");
+		stop_sampler();
+		return E_ACCESS_DENIED;
+	}
+
+	ret = sampler.loop->add_fd_watch(sampler.timer_fd, WATCH_IO_IN,
+				sampler_callback, NULL, &sampler.watch_id);
+	if (ret != S_OK) {
+		log_err("Failed to watch sampling timer");
+		stop_sampler();
+		return ret;
+	}
+
+	return S_OK;
+}
+
+static struct sensor_sampling *find_sampling(
+				artik_sensor_sampling_handle sampling)
+{
+	struct sensor_sampling *s;
+
+	for (s = sampler.samplings; s; s = s->next)
+		if (s == sampling && !s->stopped)
+			return s;
+
+	return NULL;
+}
+
+artik_error os_sensor_start_sampling(artik_sensor_sampling_handle *sampling,
+		artik_sensor_config *config, artik_sensor_handle handle,
+		const artik_sensor_sampling_config *params,
+		artik_sensor_samples_callback callback, void *user_data)
+{
+	struct sensor_sampling *s, **last;
+	unsigned int rate = params->rate_hz;
+	artik_error ret;
+
+	if (!config->data_user || config->type == ARTIK_SENSOR_NONE)
+		return E_BAD_ARGS;
+
+	s = malloc(sizeof(*s));
+	if (!s)
+		return E_NO_MEM;
+
+	memset(s, 0, sizeof(*s));
+	s->type = config->type;
+	s->ops = (artik_sensor_ops)config->data_user;
+	s->handle = handle;
+	s->device = find_device(s->ops);
+	s->batch_size = params->batch ? params->batch : 1;
+	s->callback = callback;
+	s->user_data = user_data;
+
+	s->batch = malloc(s->batch_size * sizeof(artik_sensor_sample));
+	if (!s->batch) {
+		free(s);
+		return E_NO_MEM;
+	}
+
+	if (params->ring_size) {
+		s->ring = sensor_ring_create(params->ring_size);
+		if (!s->ring) {
+			free_sampling(s);
+			return E_NO_MEM;
+		}
+	}
+
+	if (!sampler.loop) {
+		ret = start_sampler();
+		if (ret != S_OK) {
+			free_sampling(s);
+			return ret;
+		}
+	}
+
+	if (params->use_fifo && s->device && s->device->fifo_start &&
+	    s->device->fifo_start(handle, &rate) == S_OK)
+		s->fifo = true;
+
+	s->sample_ns = NSEC_PER_SEC / rate;
+	s->period_ns = s->fifo ? s->sample_ns * s->batch_size : s->sample_ns;
+	s->next_ns = (now_ns() / s->period_ns + 1) * s->period_ns;
+	s->stats.rate_hz = rate;
+
+	for (last = &sampler.samplings; *last; last = &(*last)->next)
+		;
+	*last = s;
+
+	if (!sampler.dispatching)
+		arm_timer();
+
+	*sampling = (artik_sensor_sampling_handle)s;
+
+	return S_OK;
+}
+
+artik_error os_sensor_stop_sampling(artik_sensor_sampling_handle sampling)
+{
+	struct sensor_sampling *s = find_sampling(sampling);
+
+	if (!s)
+		return E_BAD_ARGS;
+
+	s->stopped = true;
+	if (sampler.dispatching)
+		return S_OK;
+
+	remove_stopped();
+	if (!sampler.samplings)
+		stop_sampler();
+	else
+		arm_timer();
+
+	return S_OK;
+}
+
+artik_error os_sensor_get_sampling_stats(artik_sensor_sampling_handle sampling,
+		artik_sensor_sampling_stats *stats)
+{
+	struct sensor_sampling *s = find_sampling(sampling);
+
+	if (!s)
+		return E_BAD_ARGS;
+
+	*stats = s->stats;
+
+	return S_OK;
+}
+
+artik_error os_sensor_open_reader(artik_sensor_reader_handle *reader,
+		artik_sensor_sampling_handle sampling,
+		const artik_sensor_view *view)
+{
+	struct sensor_sampling *s = find_sampling(sampling);
+
+	if (!s)
+		return E_BAD_ARGS;
+
+	if (!s->ring)
+		return E_NOT_SUPPORTED;
+
+	return sensor_ring_open_reader((struct sensor_ring_reader **)reader,
+							s->ring, view);
+}
+
+artik_error os_sensor_read_samples(artik_sensor_reader_handle reader,
+		artik_sensor_sample *samples, int max, int *count)
+{
+	*count = sensor_ring_read((struct sensor_ring_reader *)reader,
+								samples, max);
+
+	return S_OK;
+}
+
+artik_error os_sensor_close_reader(artik_sensor_reader_handle reader)
+{
+	sensor_ring_close_reader((struct sensor_ring_reader *)reader);
+
+	return S_OK;
+}
+
+artik_error os_sensor_get_reader_stats(artik_sensor_reader_handle reader,
+		artik_sensor_reader_stats *stats)
+{
+	*stats = ((struct sensor_ring_reader *)reader)->stats;
+
+	return S_OK;
+}
@@ -26,6 +26,21 @@ artik_error os_sensor_request(artik_sensor_config * config,
 		artik_sensor_handle * handle, artik_sensor_ops * sensor);
 artik_sensor_config *os_sensor_get(unsigned int nb,
 					artik_sensor_device_t type);
+artik_error os_sensor_start_sampling(artik_sensor_sampling_handle *sampling,
+		artik_sensor_config *config, artik_sensor_handle handle,
+		const artik_sensor_sampling_config *params,
+		artik_sensor_samples_callback callback, void *user_data);
+artik_error os_sensor_stop_sampling(artik_sensor_sampling_handle sampling);
+artik_error os_sensor_get_sampling_stats(artik_sensor_sampling_handle sampling,
+		artik_sensor_sampling_stats *stats);
+artik_error os_sensor_open_reader(artik_sensor_reader_handle *reader,
+		artik_sensor_sampling_handle sampling,
+		const artik_sensor_view *view);
+artik_error os_sensor_read_samples(artik_sensor_reader_handle reader,
+		artik_sensor_sample *samples, int max, int *count);
+artik_error os_sensor_close_reader(artik_sensor_reader_handle reader);
+artik_error os_sensor_get_reader_stats(artik_sensor_reader_handle reader,
+		artik_sensor_reader_stats *stats);
 
 
 #endif /* OS_SENSOR_H_ */
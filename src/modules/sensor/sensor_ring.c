@@ -0,0 +1,211 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensor_ring.h"
+
+/* Larger rings would not fit in memory anyway */
+#define SENSOR_RING_MAX_SIZE	(1U << 24)
+
+/*
+ * Fields are copied one by one with atomic accesses, as a reader may
+ * copy a slot while the sampler writes it. The copy is then discarded.
+ */
+static void store_sample(artik_sensor_sample *dst,
+			const artik_sensor_sample *src)
+{
+	int i;
+
+	__atomic_store_n(&dst->timestamp_ns, src->timestamp_ns,
+							__ATOMIC_RELAXED);
+	for (i = 0; i < ARTIK_SENSOR_MAX_VALUES; i++)
+		__atomic_store_n(&dst->values[i], src->values[i],
+							__ATOMIC_RELAXED);
+}
+
+static void load_sample(artik_sensor_sample *dst,
+			const artik_sensor_sample *src)
+{
+	int i;
+
+	dst->timestamp_ns = __atomic_load_n(&src->timestamp_ns,
+							__ATOMIC_RELAXED);
+	for (i = 0; i < ARTIK_SENSOR_MAX_VALUES; i++)
+		dst->values[i] = __atomic_load_n(&src->values[i],
+							__ATOMIC_RELAXED);
+}
+
+struct sensor_ring *sensor_ring_create(unsigned int size)
+{
+	struct sensor_ring *ring;
+	unsigned int slots = 1;
+
+	if (size > SENSOR_RING_MAX_SIZE)
+		return NULL;
+
+	while (slots < size)
+		slots <<= 1;
+
+	ring = malloc(sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	/* Sequence numbers of 0 match no position */
+	ring->slots = calloc(slots, sizeof(struct sensor_ring_slot));
+	if (!ring->slots) {
+		free(ring);
+		return NULL;
+	}
+
+	ring->head = 0;
+	ring->mask = slots - 1;
+	ring->refs = 1;
+
+	return ring;
+}
+
+void sensor_ring_release(struct sensor_ring *ring)
+{
+	if (__atomic_sub_fetch(&ring->refs, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	free(ring->slots);
+	free(ring);
+}
+
+void sensor_ring_push(struct sensor_ring *ring,
+			const artik_sensor_sample *samples, int count)
+{
+	uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	int i;
+
+	for (i = 0; i < count; i++, head++) {
+		struct sensor_ring_slot *slot = &ring->slots[head & ring->mask];
+
+		__atomic_store_n(&slot->seq, 2 * head + 1, __ATOMIC_RELAXED);
+		/* Readers see the odd number before any change of the sample */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		store_sample(&slot->sample, &samples[i]);
+		__atomic_store_n(&slot->seq, 2 * head + 2, __ATOMIC_RELEASE);
+	}
+
+	__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+}
+
+artik_error sensor_ring_open_reader(struct sensor_ring_reader **reader,
+			struct sensor_ring *ring, const artik_sensor_view *view)
+{
+	struct sensor_ring_reader *r;
+
+	r = malloc(sizeof(*r));
+	if (!r)
+		return E_NO_MEM;
+
+	memset(r, 0, sizeof(*r));
+	r->ring = ring;
+	r->cursor = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	r->decimation = view && view->decimation ? view->decimation : 1;
+	r->average = view && view->average;
+
+	__atomic_add_fetch(&ring->refs, 1, __ATOMIC_RELAXED);
+	*reader = r;
+
+	return S_OK;
+}
+
+void sensor_ring_close_reader(struct sensor_ring_reader *reader)
+{
+	sensor_ring_release(reader->ring);
+	free(reader);
+}
+
+/* Returns false if the sample at 'pos' was overwritten */
+static bool load_slot(struct sensor_ring *ring, uint64_t pos,
+			artik_sensor_sample *sample)
+{
+	struct sensor_ring_slot *slot = &ring->slots[pos & ring->mask];
+	uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+	if (seq != 2 * pos + 2)
+		return false;
+
+	load_sample(sample, &slot->sample);
+	/* The copy is complete before checking it was not overwritten */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
+/* Returns true when 'out' is filled with the next sample of the view */
+static bool view_add(struct sensor_ring_reader *reader,
+			const artik_sensor_sample *in, artik_sensor_sample *out)
+{
+	int i;
+
+	if (reader->average)
+		for (i = 0; i < ARTIK_SENSOR_MAX_VALUES; i++)
+			reader->sums[i] += in->values[i];
+
+	if (++reader->pending < reader->decimation)
+		return false;
+
+	*out = *in;
+	if (reader->average) {
+		for (i = 0; i < ARTIK_SENSOR_MAX_VALUES; i++) {
+			out->values[i] = reader->sums[i] / reader->decimation;
+			reader->sums[i] = 0;
+		}
+	}
+	reader->pending = 0;
+
+	return true;
+}
+
+int sensor_ring_read(struct sensor_ring_reader *reader,
+			artik_sensor_sample *samples, int max)
+{
+	struct sensor_ring *ring = reader->ring;
+	uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	artik_sensor_sample sample;
+	int count = 0;
+
+	while (count < max && reader->cursor < head) {
+		/* Skip the samples overwritten since the last one read */
+		if (head - reader->cursor > ring->mask + 1) {
+			uint64_t lost = head - reader->cursor - ring->mask - 1;
+
+			reader->stats.lost += lost;
+			reader->cursor += lost;
+		}
+
+		if (!load_slot(ring, reader->cursor++, &sample)) {
+			reader->stats.lost++;
+			head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		if (view_add(reader, &sample, &samples[count]))
+			count++;
+	}
+
+	reader->stats.samples += count;
+
+	return count;
+}
@@ -0,0 +1,80 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef SENSOR_RING_H_
+#define SENSOR_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "artik_error.h"
+#include "artik_sensor.h"
+
+/*
+ * Last samples of a sensor, written by the sampler from the loop and
+ * read without locks by any number of readers, each at its own position.
+ *
+ * Positions count the samples since the ring was created. Each slot has
+ * a sequence number, odd while the sampler writes the slot, so that a
+ * reader finds out when the sample it copied was overwritten meanwhile.
+ * The ring is freed once the sampling and all its readers released it.
+ */
+
+struct sensor_ring_slot {
+	/* 2 * position + 1 while written, 2 * position + 2 once written */
+	uint64_t	seq;
+	artik_sensor_sample	sample;
+};
+
+struct sensor_ring {
+	/* Position of the next sample written */
+	uint64_t	head;
+	uint64_t	mask;
+	int	refs;
+	struct sensor_ring_slot	*slots;
+};
+
+struct sensor_ring_reader {
+	struct sensor_ring	*ring;
+	/* Position of the next sample read */
+	uint64_t	cursor;
+	unsigned int	decimation;
+	bool	average;
+	/* Samples taken towards the next one returned */
+	unsigned int	pending;
+	long long	sums[ARTIK_SENSOR_MAX_VALUES];
+	artik_sensor_reader_stats	stats;
+};
+
+/* 'size' is rounded up to a power of two. Returns NULL if out of memory */
+struct sensor_ring *sensor_ring_create(unsigned int size);
+void sensor_ring_release(struct sensor_ring *ring);
+
+/* Only called by the sampler, overwriting the oldest samples */
+void sensor_ring_push(struct sensor_ring *ring,
+			const artik_sensor_sample *samples, int count);
+
+artik_error sensor_ring_open_reader(struct sensor_ring_reader **reader,
+		struct sensor_ring *ring, const artik_sensor_view *view);
+void sensor_ring_close_reader(struct sensor_ring_reader *reader);
+
+/* Returns the number of samples of the view copied to 'samples' */
+int sensor_ring_read(struct sensor_ring_reader *reader,
+			artik_sensor_sample *samples, int max);
+
+#endif /* SENSOR_RING_H_ */
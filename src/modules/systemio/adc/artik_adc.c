@@ -21,17 +21,34 @@
 #include	<stdint.h>
 
 #include	"artik_adc.h"
+#include	"artik_indexed_list.h"
 #include	"os_adc.h"
 
 static artik_error artik_adc_request(artik_adc_handle * handle,
 				     artik_adc_config * config);
 static artik_error artik_adc_release(artik_adc_handle handle);
 static artik_error artik_adc_get_value(artik_adc_handle handle, int *value);
+static artik_error artik_adc_get_values(artik_adc_handle *handles, int count,
+				int *values);
+static artik_error artik_adc_start_stream(artik_adc_stream_handle *handle,
+				const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data);
+static int artik_adc_read_stream(artik_adc_stream_handle handle,
+				int *samples, int max_scans);
+static artik_error artik_adc_get_stream_stats(artik_adc_stream_handle handle,
+				artik_adc_stream_stats *stats);
+static artik_error artik_adc_stop_stream(artik_adc_stream_handle handle);
 
 artik_adc_module adc_module = {
 	artik_adc_request,
 	artik_adc_release,
-	artik_adc_get_value
+	artik_adc_get_value,
+	artik_adc_get_values,
+	artik_adc_start_stream,
+	artik_adc_read_stream,
+	artik_adc_get_stream_stats,
+	artik_adc_stop_stream
 };
 
 typedef struct {
@@ -40,7 +57,16 @@ typedef struct {
 
 } adc_node;
 
-static artik_list *requested_node = NULL;
+typedef struct {
+	artik_list node;
+	void *stream;
+} adc_stream_node;
+
+/* Handles resolved by get_values without allocating */
+#define ADC_MAX_VALUES	16
+
+static artik_indexed_list requested_node;
+static artik_indexed_list requested_stream;
 
 static int check_exist(adc_node *elem, int val_pin)
 {
@@ -53,7 +79,7 @@ static artik_error artik_adc_request(artik_adc_handle *handle,
 				     artik_adc_config *config)
 {
 	adc_node *node =
-	    (adc_node *) artik_list_get_by_check(requested_node,
+	    (adc_node *) artik_indexed_list_get_by_check(&requested_node,
 						 (ARTIK_LIST_FUNCB) &
 						 check_exist,
 						 (void *)((intptr_t)config->pin_num));
@@ -65,7 +91,8 @@ static artik_error artik_adc_request(artik_adc_handle *handle,
 	if (res != S_OK)
 		return res;
 	node =
-	    (adc_node *) artik_list_add(&requested_node, 0, sizeof(adc_node));
+	    (adc_node *) artik_indexed_list_add(&requested_node, 0,
+				sizeof(adc_node));
 	if (!node)
 		return E_NO_MEM;
 
@@ -77,7 +104,8 @@ static artik_error artik_adc_request(artik_adc_handle *handle,
 
 static artik_error artik_adc_release(artik_adc_handle handle)
 {
-	adc_node *node = (adc_node *) artik_list_get_by_handle(requested_node,
+	adc_node *node =
+		(adc_node *) artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
@@ -85,14 +113,114 @@ static artik_error artik_adc_release(artik_adc_handle handle)
 		return E_BAD_ARGS;
 	ret = os_adc_release(&node->config);
 	if (ret == S_OK)
-		artik_list_delete_node(&requested_node, (artik_list *) node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *) node);
 	return ret;
 }
 
 static artik_error artik_adc_get_value(artik_adc_handle handle, int *value)
 {
-	adc_node *node = (adc_node *) artik_list_get_by_handle(requested_node,
+	adc_node *node =
+		(adc_node *) artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	return !node ? E_BAD_ARGS : os_adc_get_value(&node->config, value);
 }
+
+static artik_error artik_adc_get_values(artik_adc_handle *handles, int count,
+				int *values)
+{
+	artik_adc_config *configs[ADC_MAX_VALUES];
+	adc_node *node;
+	int i;
+
+	if (!handles || !values || count <= 0 || count > ADC_MAX_VALUES)
+		return E_BAD_ARGS;
+
+	for (i = 0; i < count; i++) {
+		node = (adc_node *) artik_indexed_list_get_by_handle(
+					&requested_node,
+					(ARTIK_LIST_HANDLE) handles[i]);
+		if (!node)
+			return E_BAD_ARGS;
+		configs[i] = &node->config;
+	}
+
+	return os_adc_get_values(configs, count, values);
+}
+
+static artik_error artik_adc_start_stream(artik_adc_stream_handle *handle,
+				const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data)
+{
+	adc_stream_node *node;
+	artik_error ret;
+	void *stream;
+
+	if (!handle || !config || !config->pins || config->num_pins <= 0 ||
+			!config->block_scans ||
+			(!callback && !config->ring_scans))
+		return E_BAD_ARGS;
+
+	ret = os_adc_start_stream(config, callback, user_data, &stream);
+	if (ret != S_OK)
+		return ret;
+
+	node = (adc_stream_node *) artik_indexed_list_add(&requested_stream,
+					0, sizeof(adc_stream_node));
+	if (!node) {
+		os_adc_stop_stream(stream);
+		return E_NO_MEM;
+	}
+
+	node->node.handle = (ARTIK_LIST_HANDLE) node;
+	node->stream = stream;
+	*handle = (artik_adc_stream_handle) node;
+
+	return S_OK;
+}
+
+static int artik_adc_read_stream(artik_adc_stream_handle handle,
+				int *samples, int max_scans)
+{
+	adc_stream_node *node = (adc_stream_node *)
+		artik_indexed_list_get_by_handle(&requested_stream,
+						(ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !samples || max_scans < 0)
+		return E_BAD_ARGS;
+
+	return os_adc_read_stream(node->stream, samples, max_scans);
+}
+
+static artik_error artik_adc_get_stream_stats(artik_adc_stream_handle handle,
+				artik_adc_stream_stats *stats)
+{
+	adc_stream_node *node = (adc_stream_node *)
+		artik_indexed_list_get_by_handle(&requested_stream,
+						(ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !stats)
+		return E_BAD_ARGS;
+
+	return os_adc_get_stream_stats(node->stream, stats);
+}
+
+static artik_error artik_adc_stop_stream(artik_adc_stream_handle handle)
+{
+	adc_stream_node *node = (adc_stream_node *)
+		artik_indexed_list_get_by_handle(&requested_stream,
+						(ARTIK_LIST_HANDLE) handle);
+	artik_error ret;
+
+	if (!node)
+		return E_BAD_ARGS;
+
+	ret = os_adc_stop_stream(node->stream);
+	if (ret == S_OK)
+		artik_indexed_list_delete_node(&requested_stream,
+				(artik_list *) node);
+
+	return ret;
+}
@@ -16,49 +16,187 @@
  *
  */
 
-
 #include <stdlib.h>
+#include <stdint.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
 #include <limits.h>
-
+#include <errno.h>
+#include <dirent.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/eventfd.h>
+
+#include <artik_module.h>
 #include <artik_log.h>
+#include <artik_loop.h>
 #include <artik_adc.h>
 
 #include "os_adc.h"
+#include "../sim/sim.h"
 
 typedef struct {
 	int fd;
-	char *path;
+	/* Pin declared with artik_sim_add_adc, fd is -1 */
+	bool sim;
+	int pin_num;
 } artik_adc_user_data_t;
 
-#define ADC_SYSFS "/sys/bus/iio/devices/iio:device0/in_voltage%d_raw"
+#define IIO_DEVICES	"/sys/bus/iio/devices"
+#define IIO_HRTIMER	"/sys/kernel/config/iio/triggers/hrtimer"
+#define ADC_SYSFS	IIO_DEVICES "/iio:device%d/in_voltage%d_raw"
 #define MAX_SIZE 128
 
-static artik_error os_adc_open(artik_adc_config *config)
+/* Pins built with ADC_DEVICE_PIN */
+#define ADC_DEVICE_FLAG		0x40000000
+#define ADC_PIN_DEVICE(pin)	(((pin) >> 16) & 0x3fff)
+#define ADC_PIN_CHANNEL(pin)	((pin) & 0xffff)
+
+/* Kernel buffer length, in blocks */
+#define ADC_BUFFER_BLOCKS	4
+/* Reads of the buffer before going back to the loop */
+#define ADC_STREAM_READS	8
+
+/* Position and format of a channel in the scans of the buffer */
+typedef struct {
+	int channel;
+	int index;
+	unsigned int offset;
+	unsigned int bytes;
+	unsigned int bits;
+	unsigned int shift;
+	bool is_signed;
+	bool big_endian;
+} os_adc_channel;
+
+typedef struct os_adc_stream_s {
+	int device;
+	char dir[MAX_SIZE];
+	int fd;
+	int num_pins;
+	unsigned int scan_size;
+	unsigned int block_scans;
+	unsigned char *buf;
+	int *samples;
+	/* Trigger set up for the capture, undone when it stops */
+	bool own_trigger;
+	bool set_trigger;
+	artik_adc_stream_callback callback;
+	void *user_data;
+	artik_loop_module *loop;
+	int watch_id;
+	/* Set when the callback stops the stream while it runs */
+	bool dispatching;
+	bool stopped;
+	/* Ring filled by the capture thread when there is no callback */
+	int *ring;
+	size_t ring_mask;
+	size_t head;
+	size_t tail;
+	pthread_t thread;
+	bool thread_running;
+	int stop_fd;
+	artik_adc_stream_stats stats;
+	/* Next running stream */
+	struct os_adc_stream_s *next;
+	os_adc_channel channels[];
+} os_adc_stream;
+
+/*
+ * Running streams. The buffer, scan elements and trigger belong to the
+ * IIO device, only one stream can use them at a time.
+ */
+static pthread_mutex_t streams_lock = PTHREAD_MUTEX_INITIALIZER;
+static os_adc_stream *streams;
+
+static void pin_channel(int pin, int *device, int *channel)
 {
-	artik_adc_user_data_t *user_data = NULL;
+	if (pin & ADC_DEVICE_FLAG) {
+		*device = ADC_PIN_DEVICE(pin);
+		*channel = ADC_PIN_CHANNEL(pin);
+	} else {
+		*device = 0;
+		*channel = pin;
+	}
+}
 
-	log_dbg("");
+static int write_attr(const char *dir, const char *name, const char *value)
+{
+	char path[PATH_MAX];
+	int fd;
+	int ret = 0;
 
-	if (!config)
-		return E_BAD_ARGS;
+	if (snprintf(path, sizeof(path), "%s/%s", dir, name) >=
+			(int)sizeof(path))
+		return -ENAMETOOLONG;
 
-	user_data = (artik_adc_user_data_t *)config->user_data;
+	fd = open(path, O_WRONLY);
+	if (fd < 0)
+		return -errno;
 
-	log_dbg("Opening %s", user_data->path);
+	if (write(fd, value, strlen(value)) < 0)
+		ret = -errno;
 
-	user_data->fd = open(user_data->path, O_SYNC | O_RDONLY);
+	close(fd);
 
-	return (user_data->fd <= 0) ? E_BUSY : S_OK;
+	return ret;
+}
+
+/* Returns the length of the value without the trailing newline or -errno */
+static int read_attr(const char *dir, const char *name, char *value,
+			size_t size)
+{
+	char path[PATH_MAX];
+	ssize_t len;
+	int fd;
+
+	if (snprintf(path, sizeof(path), "%s/%s", dir, name) >=
+			(int)sizeof(path))
+		return -ENAMETOOLONG;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	len = read(fd, value, size - 1);
+	close(fd);
+	if (len < 0)
+		return -errno;
+
+	value[len] = '\0';
+	value[strcspn(value, "\n")] = '\0';
+
+	return strlen(value);
+}
+
+static artik_error errno_to_error(int err)
+{
+	switch (err) {
+	case -EACCES:
+	case -EPERM:
+		return E_ACCESS_DENIED;
+	case -ENOENT:
+		return E_NOT_SUPPORTED;
+	case -EBUSY:
+		return E_BUSY;
+	case -ENOMEM:
+		return E_NO_MEM;
+	default:
+		return E_BAD_ARGS;
+	}
 }
 
 artik_error os_adc_request(artik_adc_config *config)
 {
 	artik_adc_user_data_t *user_data = NULL;
+	char path[MAX_SIZE];
+	int device, channel;
 	int val = -1;
+	artik_error ret;
 
 	log_dbg("");
 
@@ -69,17 +207,36 @@ artik_error os_adc_request(artik_adc_config *config)
 	if (!user_data)
 		return E_NO_MEM;
 
-	user_data->path = malloc(MAX_SIZE + 1);
-	if (!user_data->path) {
+	user_data->fd = -1;
+	user_data->sim = sim_adc_exists(config->pin_num);
+	user_data->pin_num = config->pin_num;
+
+	pin_channel(config->pin_num, &device, &channel);
+	snprintf(path, MAX_SIZE, ADC_SYSFS, device, channel);
+
+	log_dbg("Opening %s", path);
+
+	/* Kept open, values are read again from the start of the file */
+	if (!user_data->sim)
+		user_data->fd = open(path, O_RDONLY);
+	if (!user_data->sim && user_data->fd < 0) {
 		free(user_data);
-		return E_NO_MEM;
+		return E_BUSY;
 	}
 
-	snprintf(user_data->path, MAX_SIZE, ADC_SYSFS, config->pin_num);
-
 	config->user_data = user_data;
 
-	return os_adc_get_value(config, &val);
+	/* Simulated values are only consumed by the application */
+	if (user_data->sim)
+		return S_OK;
+
+	ret = os_adc_get_value(config, &val);
+	if (ret != S_OK) {
+		os_adc_release(config);
+		config->user_data = NULL;
+	}
+
+	return ret;
 }
 
 artik_error os_adc_release(artik_adc_config *config)
@@ -94,20 +251,41 @@ artik_error os_adc_release(artik_adc_config *config)
 	user_data = (artik_adc_user_data_t *)config->user_data;
 
 	if (user_data) {
-		if (user_data->path)
-			free(user_data->path);
+		if (user_data->fd >= 0)
+			close(user_data->fd);
 		free(user_data);
 	}
 
 	return S_OK;
 }
 
-artik_error os_adc_get_value(artik_adc_config *config, int *value)
+static artik_error read_raw(artik_adc_user_data_t *user_data, int *value)
 {
-	artik_adc_user_data_t *user_data = NULL;
-	unsigned long int result = 0;
 	char value_str[MAX_SIZE];
 	char *endptr = NULL;
+	ssize_t len;
+	long result;
+
+	if (user_data->sim)
+		return sim_adc_read(user_data->pin_num, value);
+
+	len = pread(user_data->fd, value_str, sizeof(value_str) - 1, 0);
+	if (len <= 0)
+		return E_BUSY;
+
+	value_str[len] = '\0';
+	result = strtol(value_str, &endptr, 0);
+	if (value_str == endptr || result == LONG_MAX || result == LONG_MIN)
+		return E_BUSY;
+
+	*value = result;
+
+	return S_OK;
+}
+
+artik_error os_adc_get_value(artik_adc_config *config, int *value)
+{
+	artik_adc_user_data_t *user_data = NULL;
 
 	log_dbg("");
 
@@ -115,20 +293,648 @@ artik_error os_adc_get_value(artik_adc_config *config, int *value)
 		return E_BAD_ARGS;
 
 	user_data = (artik_adc_user_data_t *)config->user_data;
-
-	if (os_adc_open(config) != S_OK)
+	if (!user_data)
 		return E_BAD_ARGS;
 
-	if (read(user_data->fd, value_str, sizeof(value_str)) == -1)
-		return E_BUSY;
+	return read_raw(user_data, value);
+}
+
+artik_error os_adc_get_values(artik_adc_config **configs, int count,
+				int *values)
+{
+	artik_adc_user_data_t *user_data;
+	artik_error ret;
+	int i;
+
+	log_dbg("");
+
+	for (i = 0; i < count; i++) {
+		user_data = (artik_adc_user_data_t *)configs[i]->user_data;
+		if (!user_data)
+			return E_BAD_ARGS;
+
+		ret = read_raw(user_data, &values[i]);
+		if (ret != S_OK)
+			return ret;
+	}
+
+	return S_OK;
+}
+
+/* Type of a scan element, e.g. "le:s12/16>>4" */
+static artik_error parse_type(os_adc_channel *ch, const char *type)
+{
+	unsigned int bits, storage, shift;
+	char endian, sign;
+
+	if (sscanf(type, "%ce:%c%u/%u>>%u", &endian, &sign, &bits, &storage,
+			&shift) != 5 || strchr(type, 'X'))
+		return E_NOT_SUPPORTED;
 
-	close(user_data->fd);
-	result = strtoul(value_str, &endptr, 0);
+	if ((storage != 8 && storage != 16 && storage != 32 &&
+			storage != 64) || !bits || bits > 32 ||
+			bits + shift > storage)
+		return E_NOT_SUPPORTED;
 
-	if (value_str == endptr || result == ULONG_MAX)
+	ch->bytes = storage / 8;
+	ch->bits = bits;
+	ch->shift = shift;
+	ch->is_signed = (sign == 's');
+	ch->big_endian = (endian == 'b');
+
+	return S_OK;
+}
+
+static artik_error setup_channels(os_adc_stream *stream,
+				const artik_adc_stream_config *config)
+{
+	char scan_dir[MAX_SIZE + 16];
+	char name[64];
+	char value[64];
+	struct dirent *entry;
+	unsigned int offset = 0, align = 1;
+	os_adc_channel *next;
+	artik_error ret;
+	DIR *dir;
+	int device;
+	int last = -1;
+	int i, j;
+
+	snprintf(scan_dir, sizeof(scan_dir), "%s/scan_elements", stream->dir);
+
+	/* Only capture the requested channels */
+	dir = opendir(scan_dir);
+	if (!dir)
+		return E_NOT_SUPPORTED;
+	while ((entry = readdir(dir))) {
+		size_t len = strlen(entry->d_name);
+
+		if (len > 3 && !strcmp(entry->d_name + len - 3, "_en"))
+			write_attr(scan_dir, entry->d_name, "0");
+	}
+	closedir(dir);
+
+	for (i = 0; i < stream->num_pins; i++) {
+		os_adc_channel *ch = &stream->channels[i];
+		int err;
+
+		pin_channel(config->pins[i], &device, &ch->channel);
+		if (device != stream->device)
+			return E_BAD_ARGS;
+
+		for (j = 0; j < i; j++)
+			if (stream->channels[j].channel == ch->channel)
+				return E_BAD_ARGS;
+
+		snprintf(name, sizeof(name), "in_voltage%d_en", ch->channel);
+		err = write_attr(scan_dir, name, "1");
+		if (err < 0) {
+			log_err("Failed to enable channel %d", ch->channel);
+			return errno_to_error(err);
+		}
+
+		snprintf(name, sizeof(name), "in_voltage%d_index",
+								ch->channel);
+		if (read_attr(scan_dir, name, value, sizeof(value)) <= 0)
+			return E_NOT_SUPPORTED;
+		ch->index = atoi(value);
+
+		snprintf(name, sizeof(name), "in_voltage%d_type", ch->channel);
+		if (read_attr(scan_dir, name, value, sizeof(value)) <= 0)
+			return E_NOT_SUPPORTED;
+		ret = parse_type(ch, value);
+		if (ret != S_OK) {
+			log_err("Unsupported format %s for channel %d", value,
+								ch->channel);
+			return ret;
+		}
+	}
+
+	/* Channels are stored by index, each aligned on its own size */
+	for (i = 0; i < stream->num_pins; i++) {
+		next = NULL;
+		for (j = 0; j < stream->num_pins; j++) {
+			os_adc_channel *ch = &stream->channels[j];
+
+			if (ch->index > last &&
+					(!next || ch->index < next->index))
+				next = ch;
+		}
+		if (!next)
+			return E_BAD_ARGS;
+
+		offset = (offset + next->bytes - 1) / next->bytes *
+								next->bytes;
+		next->offset = offset;
+		offset += next->bytes;
+		if (next->bytes > align)
+			align = next->bytes;
+		last = next->index;
+	}
+	stream->scan_size = (offset + align - 1) / align * align;
+
+	return S_OK;
+}
+
+/* Returns the sysfs directory of the trigger called 'name' */
+static bool find_trigger(const char *name, char *trigger_dir, size_t size)
+{
+	char dev_dir[MAX_SIZE];
+	char value[64];
+	struct dirent *entry;
+	bool found = false;
+	DIR *dir;
+
+	dir = opendir(IIO_DEVICES);
+	if (!dir)
+		return false;
+
+	while (!found && (entry = readdir(dir))) {
+		if (strncmp(entry->d_name, "trigger", 7))
+			continue;
+		if (snprintf(dev_dir, sizeof(dev_dir), "%s/%s", IIO_DEVICES,
+				entry->d_name) >= (int)sizeof(dev_dir))
+			continue;
+		if (read_attr(dev_dir, "name", value, sizeof(value)) > 0 &&
+				!strcmp(value, name)) {
+			snprintf(trigger_dir, size, "%s", dev_dir);
+			found = true;
+		}
+	}
+	closedir(dir);
+
+	return found;
+}
+
+/*
+ * Set the sampling frequency on the device if it has its own clock,
+ * otherwise on its trigger. Devices without trigger get a hrtimer
+ * trigger created for the capture.
+ */
+static artik_error setup_trigger(os_adc_stream *stream, unsigned int rate)
+{
+	char trigger_dir[MAX_SIZE];
+	char current[64];
+	char freq[16];
+	bool rate_set = false;
+	int err;
+
+	snprintf(freq, sizeof(freq), "%u", rate);
+	if (rate && !write_attr(stream->dir, "sampling_frequency", freq))
+		rate_set = true;
+
+	/* Devices without trigger fill the buffer on their own */
+	if (read_attr(stream->dir, "trigger/current_trigger", current,
+			sizeof(current)) < 0)
+		return (rate && !rate_set) ? E_NOT_SUPPORTED : S_OK;
+
+	if (!current[0]) {
+		char path[MAX_SIZE];
+
+		snprintf(current, sizeof(current), "artik-adc%d",
+								stream->device);
+		snprintf(path, sizeof(path), "%s/%s", IIO_HRTIMER, current);
+		if (!mkdir(path, 0755)) {
+			stream->own_trigger = true;
+		} else if (errno != EEXIST) {
+			log_err("No trigger for iio:device%d and no hrtimer trigger",
+				stream->device);
+			return E_NOT_SUPPORTED;
+		}
+
+		err = write_attr(stream->dir, "trigger/current_trigger",
+								current);
+		if (err < 0)
+			return errno_to_error(err);
+		stream->set_trigger = true;
+	}
+
+	if (rate && !rate_set && find_trigger(current, trigger_dir,
+						sizeof(trigger_dir)) &&
+			!write_attr(trigger_dir, "sampling_frequency", freq))
+		rate_set = true;
+
+	if (rate && !rate_set) {
+		log_err("Failed to set sampling frequency of iio:device%d",
+			stream->device);
+		return E_NOT_SUPPORTED;
+	}
+
+	return S_OK;
+}
+
+static int channel_value(const os_adc_channel *ch, const unsigned char *scan)
+{
+	const unsigned char *p = scan + ch->offset;
+	unsigned long long raw = 0;
+	unsigned long long mask = (1ULL << ch->bits) - 1;
+	unsigned int i;
+
+	if (ch->big_endian)
+		for (i = 0; i < ch->bytes; i++)
+			raw = (raw << 8) | p[i];
+	else
+		for (i = ch->bytes; i > 0; i--)
+			raw = (raw << 8) | p[i - 1];
+
+	raw = (raw >> ch->shift) & mask;
+	if (ch->is_signed && (raw >> (ch->bits - 1)))
+		return (int)(long long)(raw | ~mask);
+
+	return (int)raw;
+}
+
+static void convert_scan(const os_adc_stream *stream,
+			const unsigned char *scan, int *samples)
+{
+	int i;
+
+	for (i = 0; i < stream->num_pins; i++)
+		samples[i] = channel_value(&stream->channels[i], scan);
+}
+
+/* Returns the number of scans read, 0 if none is buffered, -1 on error */
+static int read_scans(os_adc_stream *stream)
+{
+	ssize_t len;
+
+	len = read(stream->fd, stream->buf,
+			stream->block_scans * stream->scan_size);
+	if (len < 0)
+		return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+	return len / stream->scan_size;
+}
+
+static artik_error claim_device(os_adc_stream *stream)
+{
+	os_adc_stream *iter;
+
+	pthread_mutex_lock(&streams_lock);
+	for (iter = streams; iter; iter = iter->next) {
+		if (iter->device == stream->device) {
+			pthread_mutex_unlock(&streams_lock);
+			return E_BUSY;
+		}
+	}
+
+	stream->next = streams;
+	streams = stream;
+	pthread_mutex_unlock(&streams_lock);
+
+	return S_OK;
+}
+
+static void release_device(os_adc_stream *stream)
+{
+	os_adc_stream **iter;
+
+	pthread_mutex_lock(&streams_lock);
+	for (iter = &streams; *iter; iter = &(*iter)->next) {
+		if (*iter == stream) {
+			*iter = stream->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&streams_lock);
+}
+
+static void free_stream(os_adc_stream *stream)
+{
+	free(stream->ring);
+	free(stream->samples);
+	free(stream->buf);
+	free(stream);
+}
+
+static int stream_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_adc_stream *stream = (os_adc_stream *)user_data;
+	int reads;
+	int count;
+	int i;
+
+	for (reads = 0; reads < ADC_STREAM_READS; reads++) {
+		count = read_scans(stream);
+		if (count < 0) {
+			log_err("Failed to read iio:device%d", stream->device);
+			stream->watch_id = 0;
+			return 0;
+		}
+		if (!count)
+			break;
+
+		for (i = 0; i < count; i++)
+			convert_scan(stream, stream->buf +
+					i * stream->scan_size,
+					stream->samples + i * stream->num_pins);
+		stream->stats.scans += count;
+
+		stream->dispatching = true;
+		stream->callback(stream->user_data, stream->samples, count);
+		stream->dispatching = false;
+
+		if (stream->stopped) {
+			free_stream(stream);
+			return 0;
+		}
+
+		if ((unsigned int)count < stream->block_scans)
+			break;
+	}
+
+	return 1;
+}
+
+/* Single producer of the ring, read_stream is the consumer */
+static void *capture_thread(void *arg)
+{
+	os_adc_stream *stream = (os_adc_stream *)arg;
+	size_t ring_size = stream->ring_mask + 1;
+	struct pollfd fds[2];
+	size_t head, tail, space;
+	int count;
+	int i;
+
+	fds[0].fd = stream->fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = stream->stop_fd;
+	fds[1].events = POLLIN;
+
+	while (true) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[1].revents)
+			break;
+
+		count = read_scans(stream);
+		if (count < 0) {
+			log_err("Failed to read iio:device%d", stream->device);
+			break;
+		}
+
+		head = stream->head;
+		tail = __atomic_load_n(&stream->tail, __ATOMIC_ACQUIRE);
+		space = ring_size - (head - tail);
+		if ((size_t)count > space) {
+			__atomic_store_n(&stream->stats.overruns,
+				stream->stats.overruns + count - space,
+				__ATOMIC_RELAXED);
+		}
+
+		for (i = 0; i < count && (size_t)i < space; i++)
+			convert_scan(stream, stream->buf +
+					i * stream->scan_size,
+					stream->ring + ((head + i) &
+					stream->ring_mask) * stream->num_pins);
+
+		__atomic_store_n(&stream->head, head + i, __ATOMIC_RELEASE);
+		__atomic_store_n(&stream->stats.scans,
+				stream->stats.scans + count, __ATOMIC_RELAXED);
+	}
+
+	return NULL;
+}
+
+artik_error os_adc_start_stream(const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data, void **handle)
+{
+	os_adc_stream *stream;
+	char path[MAX_SIZE];
+	char value[16];
+	size_t ring_size;
+	artik_error ret;
+	int channel;
+	int err;
+	int i;
+
+	log_dbg("");
+
+	/* Only single conversions are simulated */
+	for (i = 0; i < config->num_pins; i++)
+		if (sim_adc_exists(config->pins[i]))
+			return E_NOT_SUPPORTED;
+
+	stream = malloc(sizeof(os_adc_stream) +
+			config->num_pins * sizeof(os_adc_channel));
+	if (!stream)
+		return E_NO_MEM;
+
+	memset(stream, 0, sizeof(os_adc_stream) +
+			config->num_pins * sizeof(os_adc_channel));
+	stream->fd = -1;
+	stream->stop_fd = -1;
+	stream->num_pins = config->num_pins;
+	for (i = 0; i < config->num_pins; i++)
+		stream->channels[i].channel = -1;
+	stream->block_scans = config->block_scans;
+	stream->callback = callback;
+	stream->user_data = user_data;
+	pin_channel(config->pins[0], &stream->device, &channel);
+	snprintf(stream->dir, sizeof(stream->dir), "%s/iio:device%d",
+						IIO_DEVICES, stream->device);
+
+	if (claim_device(stream) != S_OK) {
+		free(stream);
 		return E_BUSY;
+	}
 
-	*value = result;
+	/* The buffer can only be set up while it is disabled */
+	write_attr(stream->dir, "buffer/enable", "0");
+
+	ret = setup_channels(stream, config);
+	if (ret != S_OK)
+		goto error;
+
+	ret = setup_trigger(stream, config->sample_rate);
+	if (ret != S_OK)
+		goto error;
+
+	snprintf(value, sizeof(value), "%u",
+				config->block_scans * ADC_BUFFER_BLOCKS);
+	err = write_attr(stream->dir, "buffer/length", value);
+	if (err < 0) {
+		ret = errno_to_error(err);
+		goto error;
+	}
+	/* Wake up once per block, not supported by older kernels */
+	snprintf(value, sizeof(value), "%u", config->block_scans);
+	write_attr(stream->dir, "buffer/watermark", value);
+
+	stream->buf = malloc(config->block_scans * stream->scan_size);
+	stream->samples = malloc(config->block_scans * config->num_pins *
+								sizeof(int));
+	if (!stream->buf || !stream->samples) {
+		ret = E_NO_MEM;
+		goto error;
+	}
+
+	if (!callback) {
+		for (ring_size = 1; ring_size < config->ring_scans;
+				ring_size <<= 1)
+			;
+		stream->ring_mask = ring_size - 1;
+		stream->ring = malloc(ring_size * config->num_pins *
+								sizeof(int));
+		if (!stream->ring) {
+			ret = E_NO_MEM;
+			goto error;
+		}
+	}
+
+	snprintf(path, sizeof(path), "/dev/iio:device%d", stream->device);
+	stream->fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (stream->fd < 0) {
+		ret = errno_to_error(-errno);
+		goto error;
+	}
+
+	err = write_attr(stream->dir, "buffer/enable", "1");
+	if (err < 0) {
+		log_err("Failed to enable the buffer of iio:device%d",
+			stream->device);
+		ret = errno_to_error(err);
+		goto error;
+	}
+
+	if (callback) {
+		stream->loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+		if (!stream->loop) {
+			ret = E_BUSY;
+			goto error;
+		}
+
+		ret = stream->loop->add_fd_watch(stream->fd, WATCH_IO_IN,
+				stream_callback, (void *)stream,
+				&stream->watch_id);
+		if (ret != S_OK)
+			goto error;
+	} else {
+		stream->stop_fd = eventfd(0, 0);
+		if (stream->stop_fd < 0) {
+			ret = E_NO_MEM;
+			goto error;
+		}
+
+		if (pthread_create(&stream->thread, NULL, capture_thread,
+				(void *)stream)) {
+			ret = E_NO_MEM;
+			goto error;
+		}
+		stream->thread_running = true;
+	}
+
+	*handle = stream;
+
+	return S_OK;
+
+error:
+	os_adc_stop_stream(stream);
+
+	return ret;
+}
+
+int os_adc_read_stream(void *handle, int *samples, int max_scans)
+{
+	os_adc_stream *stream = (os_adc_stream *)handle;
+	size_t head, tail, count, i;
+
+	if (!stream->ring)
+		return E_BAD_ARGS;
+
+	tail = stream->tail;
+	head = __atomic_load_n(&stream->head, __ATOMIC_ACQUIRE);
+	count = head - tail;
+	if (count > (size_t)max_scans)
+		count = max_scans;
+
+	for (i = 0; i < count; i++)
+		memcpy(samples + i * stream->num_pins, stream->ring +
+				((tail + i) & stream->ring_mask) *
+				stream->num_pins,
+				stream->num_pins * sizeof(int));
+
+	__atomic_store_n(&stream->tail, tail + count, __ATOMIC_RELEASE);
+
+	return count;
+}
+
+artik_error os_adc_get_stream_stats(void *handle,
+				artik_adc_stream_stats *stats)
+{
+	os_adc_stream *stream = (os_adc_stream *)handle;
+
+	stats->scans = __atomic_load_n(&stream->stats.scans,
+							__ATOMIC_RELAXED);
+	stats->overruns = __atomic_load_n(&stream->stats.overruns,
+							__ATOMIC_RELAXED);
+
+	return S_OK;
+}
+
+artik_error os_adc_stop_stream(void *handle)
+{
+	os_adc_stream *stream = (os_adc_stream *)handle;
+	char scan_dir[MAX_SIZE + 16];
+	char name[64];
+	uint64_t stop = 1;
+	int i;
+
+	log_dbg("");
+
+	if (stream->loop) {
+		if (stream->watch_id)
+			stream->loop->remove_fd_watch(stream->watch_id);
+		artik_release_api_module(stream->loop);
+		stream->loop = NULL;
+	}
+
+	if (stream->thread_running) {
+		if (write(stream->stop_fd, &stop, sizeof(stop)) < 0)
+			log_err("Failed to stop the capture thread");
+		pthread_join(stream->thread, NULL);
+		stream->thread_running = false;
+	}
+
+	write_attr(stream->dir, "buffer/enable", "0");
+
+	snprintf(scan_dir, sizeof(scan_dir), "%s/scan_elements", stream->dir);
+	for (i = 0; i < stream->num_pins; i++) {
+		if (stream->channels[i].channel < 0)
+			continue;
+		snprintf(name, sizeof(name), "in_voltage%d_en",
+						stream->channels[i].channel);
+		write_attr(scan_dir, name, "0");
+	}
+
+	if (stream->set_trigger)
+		write_attr(stream->dir, "trigger/current_trigger", "\n");
+
+	if (stream->own_trigger) {
+		char path[MAX_SIZE];
+
+		snprintf(path, sizeof(path), "%s/artik-adc%d", IIO_HRTIMER,
+								stream->device);
+		rmdir(path);
+	}
+
+	if (stream->fd >= 0)
+		close(stream->fd);
+	if (stream->stop_fd >= 0)
+		close(stream->stop_fd);
+
+	release_device(stream);
+
+	/* Freed by stream_callback once the callback returns */
+	if (stream->dispatching)
+		stream->stopped = true;
+	else
+		free_stream(stream);
 
 	return S_OK;
 }
@@ -24,5 +24,14 @@
 artik_error os_adc_request(artik_adc_config *config);
 artik_error os_adc_release(artik_adc_config *config);
 artik_error os_adc_get_value(artik_adc_config *config, int *value);
+artik_error os_adc_get_values(artik_adc_config **configs, int count,
+				int *values);
+artik_error os_adc_start_stream(const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data, void **stream);
+int os_adc_read_stream(void *stream, int *samples, int max_scans);
+artik_error os_adc_get_stream_stats(void *stream,
+				artik_adc_stream_stats *stats);
+artik_error os_adc_stop_stream(void *stream);
 
 #endif  /* __OS_ADC_H__ */
@@ -121,3 +121,42 @@ artik_error os_adc_get_value(artik_adc_config *config, int *value)
 
 	return S_OK;
 }
+
+artik_error os_adc_get_values(artik_adc_config **configs, int count,
+				int *values)
+{
+	artik_error ret;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		ret = os_adc_get_value(configs[i], &values[i]);
+		if (ret != S_OK)
+			return ret;
+	}
+
+	return S_OK;
+}
+
+/* The ADC driver only converts on demand, there is no buffered capture */
+artik_error os_adc_start_stream(const artik_adc_stream_config *config,
+				artik_adc_stream_callback callback,
+				void *user_data, void **stream)
+{
+	return E_NOT_SUPPORTED;
+}
+
+int os_adc_read_stream(void *stream, int *samples, int max_scans)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_adc_get_stream_stats(void *stream,
+				artik_adc_stream_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_adc_stop_stream(void *stream)
+{
+	return E_NOT_SUPPORTED;
+}
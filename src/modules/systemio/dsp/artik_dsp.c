@@ -0,0 +1,496 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include	<stdlib.h>
+#include	<string.h>
+#include	<math.h>
+
+#include	"artik_dsp.h"
+
+/*
+ * The kernels work on four floats at a time through the few vector
+ * operations below, mapped on NEON or SSE2 depending on the target the
+ * library is built for. Without either of them only the scalar loops,
+ * which also handle the tail of each block, are compiled.
+ */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include	<arm_neon.h>
+
+#define DSP_SIMD
+
+typedef float32x4_t dsp_vec;
+
+static inline dsp_vec dsp_load(const float *p)
+{
+	return vld1q_f32(p);
+}
+
+static inline dsp_vec dsp_load_int(const int *p, int offset)
+{
+	return vcvtq_f32_s32(vsubq_s32(vld1q_s32(p), vdupq_n_s32(offset)));
+}
+
+static inline void dsp_store(float *p, dsp_vec v)
+{
+	vst1q_f32(p, v);
+}
+
+static inline dsp_vec dsp_dup(float f)
+{
+	return vdupq_n_f32(f);
+}
+
+static inline dsp_vec dsp_add(dsp_vec a, dsp_vec b)
+{
+	return vaddq_f32(a, b);
+}
+
+/* acc + a * b */
+static inline dsp_vec dsp_mla(dsp_vec acc, dsp_vec a, dsp_vec b)
+{
+	return vmlaq_f32(acc, a, b);
+}
+
+static inline dsp_vec dsp_min(dsp_vec a, dsp_vec b)
+{
+	return vminq_f32(a, b);
+}
+
+static inline dsp_vec dsp_max(dsp_vec a, dsp_vec b)
+{
+	return vmaxq_f32(a, b);
+}
+
+#elif defined(__SSE2__)
+#include	<emmintrin.h>
+
+#define DSP_SIMD
+
+typedef __m128 dsp_vec;
+
+static inline dsp_vec dsp_load(const float *p)
+{
+	return _mm_loadu_ps(p);
+}
+
+static inline dsp_vec dsp_load_int(const int *p, int offset)
+{
+	__m128i raw = _mm_loadu_si128((const __m128i *)p);
+
+	return _mm_cvtepi32_ps(_mm_sub_epi32(raw, _mm_set1_epi32(offset)));
+}
+
+static inline void dsp_store(float *p, dsp_vec v)
+{
+	_mm_storeu_ps(p, v);
+}
+
+static inline dsp_vec dsp_dup(float f)
+{
+	return _mm_set1_ps(f);
+}
+
+static inline dsp_vec dsp_add(dsp_vec a, dsp_vec b)
+{
+	return _mm_add_ps(a, b);
+}
+
+/* acc + a * b */
+static inline dsp_vec dsp_mla(dsp_vec acc, dsp_vec a, dsp_vec b)
+{
+	return _mm_add_ps(acc, _mm_mul_ps(a, b));
+}
+
+static inline dsp_vec dsp_min(dsp_vec a, dsp_vec b)
+{
+	return _mm_min_ps(a, b);
+}
+
+static inline dsp_vec dsp_max(dsp_vec a, dsp_vec b)
+{
+	return _mm_max_ps(a, b);
+}
+
+#endif
+
+#ifdef DSP_SIMD
+static inline float dsp_sum(dsp_vec v)
+{
+	float lanes[4];
+
+	dsp_store(lanes, v);
+
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+#endif
+
+/* Input samples filtered per pass, the history is kept in front of them */
+#define FIR_BLOCK	256
+/* Samples accumulated in single precision before adding to the total */
+#define STATS_BLOCK	1024
+
+struct artik_dsp_fir {
+	/* Taps in reverse order, applied to the oldest sample first */
+	float *taps;
+	int num_taps;
+	int decimation;
+	/* Input samples to skip before the next output */
+	int skip;
+	/* num_taps - 1 samples of history followed by FIR_BLOCK samples */
+	float *buf;
+};
+
+struct artik_dsp_iir {
+	artik_dsp_biquad *sections;
+	/* Two state variables per section */
+	float *state;
+	int num_sections;
+};
+
+artik_error artik_dsp_scale(const int *in, float *out, int count,
+				const artik_dsp_calibration *cal)
+{
+	int offset, i = 0;
+	float scale, bias;
+#ifdef DSP_SIMD
+	dsp_vec vscale, vbias;
+#endif
+
+	if (!in || !out || count < 0 || !cal)
+		return E_BAD_ARGS;
+
+	/* Stores to 'out' would otherwise reload them on each sample */
+	offset = cal->offset;
+	scale = cal->scale;
+	bias = cal->bias;
+
+#ifdef DSP_SIMD
+	vscale = dsp_dup(scale);
+	vbias = dsp_dup(bias);
+	for (; i + 4 <= count; i += 4)
+		dsp_store(out + i, dsp_mla(vbias,
+				dsp_load_int(in + i, offset), vscale));
+#endif
+
+	for (; i < count; i++)
+		out[i] = (float)(in[i] - offset) * scale + bias;
+
+	return S_OK;
+}
+
+artik_error artik_dsp_deinterleave(const int *in, int num_channels,
+				int channel, int *out, int num_scans)
+{
+	int i;
+
+	if (!in || !out || num_scans < 0 || num_channels <= 0 ||
+	    channel < 0 || channel >= num_channels)
+		return E_BAD_ARGS;
+
+	in += channel;
+	for (i = 0; i < num_scans; i++, in += num_channels)
+		out[i] = *in;
+
+	return S_OK;
+}
+
+artik_error artik_dsp_fir_create(artik_dsp_fir **fir, const float *taps,
+				int num_taps, int decimation)
+{
+	artik_dsp_fir *f;
+	int i;
+
+	if (!fir || !taps || num_taps <= 0 || decimation <= 0)
+		return E_BAD_ARGS;
+
+	f = malloc(sizeof(*f));
+	if (!f)
+		return E_NO_MEM;
+
+	f->taps = malloc(num_taps * sizeof(float));
+	f->buf = malloc((num_taps - 1 + FIR_BLOCK) * sizeof(float));
+	if (!f->taps || !f->buf) {
+		free(f->taps);
+		free(f->buf);
+		free(f);
+		return E_NO_MEM;
+	}
+
+	for (i = 0; i < num_taps; i++)
+		f->taps[i] = taps[num_taps - 1 - i];
+	f->num_taps = num_taps;
+	f->decimation = decimation;
+	artik_dsp_fir_reset(f);
+
+	*fir = f;
+
+	return S_OK;
+}
+
+void artik_dsp_fir_reset(artik_dsp_fir *fir)
+{
+	if (!fir)
+		return;
+
+	memset(fir->buf, 0, (fir->num_taps - 1) * sizeof(float));
+	fir->skip = 0;
+}
+
+void artik_dsp_fir_destroy(artik_dsp_fir *fir)
+{
+	if (!fir)
+		return;
+
+	free(fir->taps);
+	free(fir->buf);
+	free(fir);
+}
+
+/* Output for the window of samples starting at 'x' */
+static float fir_dot(const float *taps, int num_taps, const float *x)
+{
+	float sum = 0;
+	int k = 0;
+#ifdef DSP_SIMD
+	dsp_vec acc = dsp_dup(0);
+
+	for (; k + 4 <= num_taps; k += 4)
+		acc = dsp_mla(acc, dsp_load(taps + k), dsp_load(x + k));
+	sum = dsp_sum(acc);
+#endif
+
+	for (; k < num_taps; k++)
+		sum += taps[k] * x[k];
+
+	return sum;
+}
+
+/* Outputs for the 'count' consecutive windows starting at 'x' */
+static void fir_filter(const float *taps, int num_taps, const float *x,
+			float *out, int count)
+{
+	int n = 0;
+
+#ifdef DSP_SIMD
+	/*
+	 * Four outputs at a time, each tap is multiplied by four
+	 * consecutive samples.
+	 */
+	for (; n + 4 <= count; n += 4) {
+		dsp_vec acc = dsp_dup(0);
+		int k;
+
+		for (k = 0; k < num_taps; k++)
+			acc = dsp_mla(acc, dsp_dup(taps[k]),
+					dsp_load(x + n + k));
+		dsp_store(out + n, acc);
+	}
+#endif
+
+	for (; n < count; n++)
+		out[n] = fir_dot(taps, num_taps, x + n);
+}
+
+int artik_dsp_fir_process(artik_dsp_fir *fir, const float *in, int count,
+				float *out)
+{
+	int history;
+	int written = 0;
+
+	if (!fir || !in || !out || count < 0)
+		return E_BAD_ARGS;
+
+	history = fir->num_taps - 1;
+
+	while (count > 0) {
+		int len = count < FIR_BLOCK ? count : FIR_BLOCK;
+		int n;
+
+		memcpy(fir->buf + history, in, len * sizeof(float));
+
+		if (fir->decimation == 1) {
+			fir_filter(fir->taps, fir->num_taps, fir->buf,
+					out + written, len);
+			written += len;
+		} else {
+			for (n = fir->skip; n < len; n += fir->decimation)
+				out[written++] = fir_dot(fir->taps,
+						fir->num_taps, fir->buf + n);
+			fir->skip = n - len;
+		}
+
+		memmove(fir->buf, fir->buf + len, history * sizeof(float));
+		in += len;
+		count -= len;
+	}
+
+	return written;
+}
+
+artik_error artik_dsp_iir_create(artik_dsp_iir **iir,
+		const artik_dsp_biquad *sections, int num_sections)
+{
+	artik_dsp_iir *f;
+
+	if (!iir || !sections || num_sections <= 0)
+		return E_BAD_ARGS;
+
+	f = malloc(sizeof(*f));
+	if (!f)
+		return E_NO_MEM;
+
+	f->sections = malloc(num_sections * sizeof(artik_dsp_biquad));
+	f->state = malloc(num_sections * 2 * sizeof(float));
+	if (!f->sections || !f->state) {
+		free(f->sections);
+		free(f->state);
+		free(f);
+		return E_NO_MEM;
+	}
+
+	memcpy(f->sections, sections, num_sections * sizeof(artik_dsp_biquad));
+	f->num_sections = num_sections;
+	artik_dsp_iir_reset(f);
+
+	*iir = f;
+
+	return S_OK;
+}
+
+void artik_dsp_iir_reset(artik_dsp_iir *iir)
+{
+	if (!iir)
+		return;
+
+	memset(iir->state, 0, iir->num_sections * 2 * sizeof(float));
+}
+
+void artik_dsp_iir_destroy(artik_dsp_iir *iir)
+{
+	if (!iir)
+		return;
+
+	free(iir->sections);
+	free(iir->state);
+	free(iir);
+}
+
+artik_error artik_dsp_iir_process(artik_dsp_iir *iir, const float *in,
+				float *out, int count)
+{
+	int s, n;
+
+	if (!iir || !in || !out || count < 0)
+		return E_BAD_ARGS;
+
+	/*
+	 * Each output depends on the previous one, so there is nothing to
+	 * vectorize within a channel. Running the whole block through one
+	 * section at a time keeps the coefficients and the state in
+	 * registers instead.
+	 */
+	for (s = 0; s < iir->num_sections; s++) {
+		const artik_dsp_biquad *c = &iir->sections[s];
+		float s1 = iir->state[2 * s];
+		float s2 = iir->state[2 * s + 1];
+		const float *x = s ? out : in;
+
+		/* Transposed direct form II */
+		for (n = 0; n < count; n++) {
+			float xn = x[n];
+			float yn = c->b0 * xn + s1;
+
+			s1 = c->b1 * xn - c->a1 * yn + s2;
+			s2 = c->b2 * xn - c->a2 * yn;
+			out[n] = yn;
+		}
+
+		iir->state[2 * s] = s1;
+		iir->state[2 * s + 1] = s2;
+	}
+
+	return S_OK;
+}
+
+artik_error artik_dsp_get_stats(const float *in, int count,
+				artik_dsp_stats *stats)
+{
+	float min, max;
+	double sum = 0;
+	double sum_sq = 0;
+	int i = 0;
+
+	if (!in || count <= 0 || !stats)
+		return E_BAD_ARGS;
+
+	min = max = in[0];
+
+	while (i < count) {
+		int end = count - i < STATS_BLOCK ? count : i + STATS_BLOCK;
+		float block_sum = 0;
+		float block_sq = 0;
+
+#ifdef DSP_SIMD
+		if (i + 4 <= end) {
+			dsp_vec vmin = dsp_dup(min);
+			dsp_vec vmax = dsp_dup(max);
+			dsp_vec vsum = dsp_dup(0);
+			dsp_vec vsq = dsp_dup(0);
+			float lanes[4];
+			int l;
+
+			for (; i + 4 <= end; i += 4) {
+				dsp_vec v = dsp_load(in + i);
+
+				vmin = dsp_min(vmin, v);
+				vmax = dsp_max(vmax, v);
+				vsum = dsp_add(vsum, v);
+				vsq = dsp_mla(vsq, v, v);
+			}
+
+			block_sum = dsp_sum(vsum);
+			block_sq = dsp_sum(vsq);
+			dsp_store(lanes, vmin);
+			for (l = 0; l < 4; l++)
+				min = lanes[l] < min ? lanes[l] : min;
+			dsp_store(lanes, vmax);
+			for (l = 0; l < 4; l++)
+				max = lanes[l] > max ? lanes[l] : max;
+		}
+#endif
+
+		for (; i < end; i++) {
+			float v = in[i];
+
+			min = v < min ? v : min;
+			max = v > max ? v : max;
+			block_sum += v;
+			block_sq += v * v;
+		}
+
+		sum += block_sum;
+		sum_sq += block_sq;
+	}
+
+	stats->min = min;
+	stats->max = max;
+	stats->mean = sum / count;
+	stats->rms = sqrt(sum_sq / count);
+
+	return S_OK;
+}
@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include <artik_gpio.h>
+#include <artik_indexed_list.h>
 #include "os_gpio.h"
 
 static artik_error artik_gpio_request(artik_gpio_handle * handle,
@@ -35,6 +36,18 @@ static artik_gpio_id artik_gpio_get_id(artik_gpio_handle);
 static artik_error artik_gpio_set_change_callback(artik_gpio_handle handle,
 					artik_gpio_callback callback, void *);
 static void artik_gpio_unset_change_callback(artik_gpio_handle handle);
+static artik_error artik_gpio_request_bulk(artik_gpio_bulk_handle *handle,
+					artik_gpio_config *configs, int count);
+static artik_error artik_gpio_release_bulk(artik_gpio_bulk_handle handle);
+static artik_error artik_gpio_read_bulk(artik_gpio_bulk_handle handle,
+					int *values);
+static artik_error artik_gpio_write_bulk(artik_gpio_bulk_handle handle,
+					const int *values);
+static artik_error artik_gpio_set_events_callback(artik_gpio_handle handle,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data);
+static artik_error artik_gpio_get_event_stats(artik_gpio_handle handle,
+				artik_gpio_event_stats *stats);
 
 const artik_gpio_module gpio_module = {
 		artik_gpio_request,
@@ -45,7 +58,13 @@ const artik_gpio_module gpio_module = {
 		artik_gpio_get_direction,
 		artik_gpio_get_id,
 		artik_gpio_set_change_callback,
-		artik_gpio_unset_change_callback
+		artik_gpio_unset_change_callback,
+		artik_gpio_request_bulk,
+		artik_gpio_release_bulk,
+		artik_gpio_read_bulk,
+		artik_gpio_write_bulk,
+		artik_gpio_set_events_callback,
+		artik_gpio_get_event_stats
 };
 
 typedef struct {
@@ -53,7 +72,13 @@ typedef struct {
 	artik_gpio_config config;
 } gpio_node;
 
-static artik_list *requested_node = NULL;
+typedef struct {
+	artik_list node;
+	void *bulk;
+} gpio_bulk_node;
+
+static artik_indexed_list requested_node;
+static artik_indexed_list requested_bulk;
 
 static int check_exist(gpio_node *elem, unsigned int val_id)
 {
@@ -65,17 +90,19 @@ static int check_exist(gpio_node *elem, unsigned int val_id)
 artik_error artik_gpio_request(artik_gpio_handle *handle,
 			       artik_gpio_config *config)
 {
-	gpio_node *node = (gpio_node *) artik_list_get_by_check(requested_node,
+	gpio_node *node =
+		(gpio_node *) artik_indexed_list_get_by_check(&requested_node,
 			(ARTIK_LIST_FUNCB)&check_exist, (void *)(intptr_t)config->id);
 
 	if (node)
 		return E_BUSY;
-	node = (gpio_node *) artik_list_add(&requested_node, 0,
+	node = (gpio_node *) artik_indexed_list_add(&requested_node, 0,
 						sizeof(gpio_node));
 	if (!node)
 		return E_NO_MEM;
 	if (os_gpio_request(config) != S_OK) {
-		artik_list_delete_node(&requested_node, (artik_list *) node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *) node);
 		return E_BAD_ARGS;
 	}
 	node->node.handle = (ARTIK_LIST_HANDLE) node;
@@ -87,7 +114,7 @@ artik_error artik_gpio_request(artik_gpio_handle *handle,
 artik_error artik_gpio_release(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 	artik_error ret;
 
@@ -96,14 +123,14 @@ artik_error artik_gpio_release(artik_gpio_handle handle)
 	ret = os_gpio_release(&node->config);
 	if (ret != S_OK)
 		return ret;
-	artik_list_delete_node(&requested_node, (artik_list *) node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *) node);
 	return S_OK;
 }
 
 int artik_gpio_read(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -115,7 +142,7 @@ int artik_gpio_read(artik_gpio_handle handle)
 artik_error artik_gpio_write(artik_gpio_handle handle, int value)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -127,7 +154,7 @@ artik_error artik_gpio_write(artik_gpio_handle handle, int value)
 char *artik_gpio_get_name(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -139,7 +166,7 @@ char *artik_gpio_get_name(artik_gpio_handle handle)
 artik_gpio_dir_t artik_gpio_get_direction(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -150,7 +177,7 @@ artik_gpio_dir_t artik_gpio_get_direction(artik_gpio_handle handle)
 artik_gpio_id artik_gpio_get_id(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -162,7 +189,7 @@ artik_error artik_gpio_set_change_callback(artik_gpio_handle handle,
 				artik_gpio_callback callback, void *user_data)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -174,7 +201,7 @@ artik_error artik_gpio_set_change_callback(artik_gpio_handle handle,
 void artik_gpio_unset_change_callback(artik_gpio_handle handle)
 {
 	gpio_node *node =
-	    (gpio_node *) artik_list_get_by_handle(requested_node,
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
 						   (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -182,3 +209,110 @@ void artik_gpio_unset_change_callback(artik_gpio_handle handle)
 
 	os_gpio_unset_change_callback(&node->config);
 }
+
+artik_error artik_gpio_set_events_callback(artik_gpio_handle handle,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data)
+{
+	gpio_node *node =
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
+						   (ARTIK_LIST_HANDLE) handle);
+
+	if (!node)
+		return E_BAD_ARGS;
+
+	return os_gpio_set_events_callback(&node->config, callback,
+						debounce_us, user_data);
+}
+
+artik_error artik_gpio_get_event_stats(artik_gpio_handle handle,
+				artik_gpio_event_stats *stats)
+{
+	gpio_node *node =
+	    (gpio_node *) artik_indexed_list_get_by_handle(&requested_node,
+						   (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !stats)
+		return E_BAD_ARGS;
+
+	return os_gpio_get_event_stats(&node->config, stats);
+}
+
+artik_error artik_gpio_request_bulk(artik_gpio_bulk_handle *handle,
+				    artik_gpio_config *configs, int count)
+{
+	gpio_bulk_node *node;
+	artik_error ret;
+	int i;
+
+	if (!handle || !configs || count <= 0)
+		return E_BAD_ARGS;
+
+	for (i = 0; i < count; i++) {
+		if (configs[i].dir != configs[0].dir ||
+				configs[i].dir >= GPIO_DIR_INVALID)
+			return E_BAD_ARGS;
+		if (artik_indexed_list_get_by_check(&requested_node,
+				(ARTIK_LIST_FUNCB)&check_exist,
+				(void *)(intptr_t)configs[i].id))
+			return E_BUSY;
+	}
+
+	node = (gpio_bulk_node *) artik_indexed_list_add(&requested_bulk, 0,
+						sizeof(gpio_bulk_node));
+	if (!node)
+		return E_NO_MEM;
+
+	ret = os_gpio_request_bulk(configs, count, &node->bulk);
+	if (ret != S_OK) {
+		artik_indexed_list_delete_node(&requested_bulk,
+				(artik_list *) node);
+		return ret;
+	}
+
+	node->node.handle = (ARTIK_LIST_HANDLE) node;
+	*handle = (artik_gpio_bulk_handle) node;
+
+	return S_OK;
+}
+
+artik_error artik_gpio_release_bulk(artik_gpio_bulk_handle handle)
+{
+	gpio_bulk_node *node =
+	    (gpio_bulk_node *) artik_indexed_list_get_by_handle(
+			&requested_bulk, (ARTIK_LIST_HANDLE) handle);
+	artik_error ret;
+
+	if (!node)
+		return E_BAD_ARGS;
+	ret = os_gpio_release_bulk(node->bulk);
+	if (ret != S_OK)
+		return ret;
+	artik_indexed_list_delete_node(&requested_bulk, (artik_list *) node);
+	return S_OK;
+}
+
+artik_error artik_gpio_read_bulk(artik_gpio_bulk_handle handle, int *values)
+{
+	gpio_bulk_node *node =
+	    (gpio_bulk_node *) artik_indexed_list_get_by_handle(
+			&requested_bulk, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !values)
+		return E_BAD_ARGS;
+
+	return os_gpio_read_bulk(node->bulk, values);
+}
+
+artik_error artik_gpio_write_bulk(artik_gpio_bulk_handle handle,
+				  const int *values)
+{
+	gpio_bulk_node *node =
+	    (gpio_bulk_node *) artik_indexed_list_get_by_handle(
+			&requested_bulk, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !values)
+		return E_BAD_ARGS;
+
+	return os_gpio_write_bulk(node->bulk, values);
+}
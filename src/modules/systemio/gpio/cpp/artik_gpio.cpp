@@ -85,3 +85,14 @@ artik_error artik::Gpio::set_change_callback(artik_gpio_callback callback,
 void artik::Gpio::unset_change_callback() {
   return m_module->unset_change_callback(m_handle);
 }
+
+artik_error artik::Gpio::set_events_callback(
+    artik_gpio_events_callback callback, unsigned int debounce_us,
+    void* user_data) {
+  return m_module->set_events_callback(m_handle, callback, debounce_us,
+      user_data);
+}
+
+artik_error artik::Gpio::get_event_stats(artik_gpio_event_stats* stats) {
+  return m_module->get_event_stats(m_handle, stats);
+}
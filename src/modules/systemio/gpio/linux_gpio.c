@@ -19,31 +19,115 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <errno.h>
+#include <dirent.h>
+#include <limits.h>
 #include <sys/select.h>
 #include <sys/eventfd.h>
+#include <time.h>
+#include <linux/gpio.h>
 
 #include <artik_module.h>
 #include <artik_log.h>
 #include <artik_loop.h>
 #include <artik_gpio.h>
 #include "os_gpio.h"
+#include "../sim/sim.h"
 
 #define MAX_VAL_STRING	128
 
+/* IDs built with GPIO_CHIP_LINE */
+#define GPIO_CHIP_FLAG		0x40000000
+#define GPIO_ID_CHIP(id)	(((id) >> 16) & 0x3fff)
+#define GPIO_ID_LINE(id)	((id) & 0xffff)
+
+#define GPIO_SYSFS_CLASS	"/sys/class/gpio"
+#define GPIO_BUS_DEVICES	"/sys/bus/gpio/devices"
+#define GPIO_EVENTS_BATCH	64
+/* Kernel queue asked for lines delivering edge events */
+#define GPIO_EVENTS_QUEUE	1024
+/* Reads of the event queue before going back to the loop */
+#define GPIO_EVENTS_READS	8
+
+/* Edge read from a line event file, whatever the kernel interface */
+typedef struct {
+	unsigned long long timestamp_ns;
+	artik_gpio_edge_t edge;
+	/* Number given by the kernel, 0 if events are not numbered */
+	unsigned int seqno;
+} os_gpio_edge;
+
+/* State of the edge events delivered by set_events_callback */
+typedef struct {
+	artik_gpio_events_callback callback;
+	void *user_data;
+	unsigned long long debounce_ns;
+	bool both_edges;
+	unsigned int sequence;
+	artik_gpio_edge_t last_edge;
+	/* Edge held until the line has been stable for debounce_ns */
+	artik_gpio_event pending;
+	bool has_pending;
+	unsigned long long pending_at;
+	int timeout_id;
+	/* Events accepted and not delivered yet */
+	artik_gpio_event batch[GPIO_EVENTS_BATCH];
+	int count;
+	/* Set when the callback stops the events while it runs */
+	bool dispatching;
+	bool stopped;
+} os_gpio_events;
+
+/*
+ * Lines are requested from the GPIO character device when the kernel
+ * provides it, the deprecated sysfs interface is only used as a fallback.
+ */
 typedef struct {
 	int watch_id;
+	/* sysfs value file watched for changes */
 	int fd;
 	artik_gpio_callback callback;
 	void *user_data;
 	artik_loop_module *loop;
+	/* Line handle or line event file on the GPIO chip, -1 with sysfs */
+	int line_fd;
+	bool line_events;
+	/* Line requested with the v2 interface, events are numbered */
+	bool line_v2;
+	/* sysfs value file used for reads and writes */
+	int value_fd;
+	os_gpio_events *events;
+	artik_gpio_event_stats stats;
+	/* Line declared with artik_sim_add_gpio, accessed by its ID */
+	bool sim;
+	artik_gpio_id id;
 } os_gpio_data;
 
+/* Lines of a bulk request sharing a line handle */
+typedef struct {
+	int chip;
+	/* Line handle, -1 for a single line accessed through sysfs */
+	int fd;
+	unsigned int num_lines;
+	unsigned int offsets[GPIOHANDLES_MAX];
+	/* Position of the lines in the arrays of the caller */
+	unsigned int index[GPIOHANDLES_MAX];
+	artik_gpio_config config;
+} os_gpio_group;
+
+typedef struct {
+	artik_gpio_dir_t dir;
+	unsigned int num_groups;
+	os_gpio_group groups[];
+} os_gpio_bulk;
+
 static int write_sysfs_entry(char *entry, char *value)
 {
 	int fd = open(entry, O_WRONLY);
@@ -83,26 +167,344 @@ static int read_sysfs_entry(char *entry, char *value)
 	return 0;
 }
 
-artik_error os_gpio_request(artik_gpio_config *config)
+
+static int read_sysfs_int(const char *dir, const char *name, int *value)
+{
+	char path[PATH_MAX];
+	char str[MAX_VAL_STRING];
+
+	memset(str, 0, sizeof(str));
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if (read_sysfs_entry(path, str) < 0)
+		return -1;
+
+	*value = atoi(str);
+
+	return 0;
+}
+
+static bool get_chip_info(int chip, struct gpiochip_info *info)
+{
+	char path[MAX_VAL_STRING];
+	int fd;
+	bool ret;
+
+	snprintf(path, sizeof(path), "/dev/gpiochip%d", chip);
+	fd = open(path, O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	ret = ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, info) == 0;
+	close(fd);
+
+	return ret;
+}
+
+/*
+ * The character device has no notion of the global GPIO numbering, find
+ * the sysfs chip covering the ID and the character device with the same
+ * parent device, label and number of lines.
+ */
+static int find_gpio_chip(artik_gpio_id id, unsigned int *line)
+{
+	char class_dir[PATH_MAX], path[PATH_MAX];
+	char parent[PATH_MAX], chip_parent[PATH_MAX];
+	char label[MAX_VAL_STRING];
+	struct dirent *entry;
+	int base = -1, ngpio = 0;
+	int chip = -1;
+	DIR *dir;
+
+	dir = opendir(GPIO_SYSFS_CLASS);
+	if (!dir)
+		return -1;
+
+	while ((entry = readdir(dir))) {
+		if (strncmp(entry->d_name, "gpiochip", 8))
+			continue;
+		snprintf(class_dir, sizeof(class_dir), "%s/%s",
+				GPIO_SYSFS_CLASS, entry->d_name);
+		if (read_sysfs_int(class_dir, "base", &base) < 0 ||
+				read_sysfs_int(class_dir, "ngpio", &ngpio) < 0)
+			continue;
+		if ((int)id >= base && (int)id < base + ngpio)
+			break;
+	}
+	closedir(dir);
+
+	if (!entry)
+		return -1;
+
+	memset(label, 0, sizeof(label));
+	if (snprintf(path, sizeof(path), "%s/label", class_dir) >=
+			(int)sizeof(path) || read_sysfs_entry(path, label) < 0)
+		return -1;
+	label[strcspn(label, "\n")] = '\0';
+
+	if (snprintf(path, sizeof(path), "%s/device", class_dir) >=
+			(int)sizeof(path) || !realpath(path, parent))
+		parent[0] = '\0';
+
+	dir = opendir(GPIO_BUS_DEVICES);
+	if (!dir)
+		return -1;
+
+	while ((entry = readdir(dir))) {
+		struct gpiochip_info info;
+		int n;
+
+		if (sscanf(entry->d_name, "gpiochip%d", &n) != 1)
+			continue;
+		if (!get_chip_info(n, &info) || (int)info.lines != ngpio ||
+				strncmp(info.label, label, sizeof(info.label)))
+			continue;
+
+		snprintf(path, sizeof(path), "%s/%s/..", GPIO_BUS_DEVICES,
+				entry->d_name);
+		if (parent[0] && realpath(path, chip_parent) &&
+				strcmp(parent, chip_parent))
+			continue;
+
+		chip = n;
+		break;
+	}
+	closedir(dir);
+
+	if (chip >= 0)
+		*line = id - base;
+
+	return chip;
+}
+
+static int resolve_gpio(artik_gpio_id id, unsigned int *line)
+{
+	if (id & GPIO_CHIP_FLAG) {
+		*line = GPIO_ID_LINE(id);
+		return GPIO_ID_CHIP(id);
+	}
+
+	return find_gpio_chip(id, line);
+}
+
+static int open_gpio_chip(int chip)
+{
+	char path[MAX_VAL_STRING];
+
+	snprintf(path, sizeof(path), "/dev/gpiochip%d", chip);
+
+	return open(path, O_RDWR | O_CLOEXEC);
+}
+
+/* Returns the line file descriptor or -errno */
+static int request_line(artik_gpio_config *config, int chip,
+			unsigned int line, artik_gpio_edge_t edge)
+{
+	const char *label = config->name ? config->name : "artik";
+	int chip_fd = open_gpio_chip(chip);
+	int ret;
+
+	if (chip_fd < 0)
+		return -errno;
+
+	if (config->dir == GPIO_IN && edge != GPIO_EDGE_NONE) {
+		struct gpioevent_request req;
+
+		memset(&req, 0, sizeof(req));
+		req.lineoffset = line;
+		req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+		if (edge == GPIO_EDGE_RISING)
+			req.eventflags = GPIOEVENT_REQUEST_RISING_EDGE;
+		else if (edge == GPIO_EDGE_FALLING)
+			req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+		else
+			req.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+		strncpy(req.consumer_label, label,
+				sizeof(req.consumer_label) - 1);
+
+		ret = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+		ret = ret < 0 ? -errno : req.fd;
+	} else {
+		struct gpiohandle_request req;
+
+		memset(&req, 0, sizeof(req));
+		req.lineoffsets[0] = line;
+		req.lines = 1;
+		if (config->dir == GPIO_OUT) {
+			req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+			req.default_values[0] = config->initial_value ? 1 : 0;
+		} else {
+			req.flags = GPIOHANDLE_REQUEST_INPUT;
+		}
+		strncpy(req.consumer_label, label,
+				sizeof(req.consumer_label) - 1);
+
+		ret = ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+		ret = ret < 0 ? -errno : req.fd;
+	}
+
+	close(chip_fd);
+
+	return ret;
+}
+
+/*
+ * Request the line for edge events, both edges if the configuration has
+ * none. The v2 interface is preferred as it numbers the events and lets
+ * us ask for a larger queue. Returns the event file descriptor or -errno.
+ */
+static int request_event_line(artik_gpio_config *config, int chip,
+			unsigned int line, bool *v2)
+{
+	artik_gpio_edge_t edge = (config->edge == GPIO_EDGE_NONE) ?
+						GPIO_EDGE_BOTH : config->edge;
+#ifdef GPIO_V2_LINES_MAX
+	struct gpio_v2_line_request req;
+	int chip_fd = open_gpio_chip(chip);
+	int ret;
+
+	if (chip_fd < 0)
+		return -errno;
+
+	memset(&req, 0, sizeof(req));
+	req.offsets[0] = line;
+	req.num_lines = 1;
+	req.event_buffer_size = GPIO_EVENTS_QUEUE;
+	req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+	if (edge != GPIO_EDGE_FALLING)
+		req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+	if (edge != GPIO_EDGE_RISING)
+		req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	strncpy(req.consumer, config->name ? config->name : "artik",
+			sizeof(req.consumer) - 1);
+
+	ret = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+	ret = ret < 0 ? -errno : req.fd;
+	close(chip_fd);
+
+	/* Kernels older than 5.10 only know the v1 interface */
+	if (ret != -ENOTTY && ret != -EINVAL) {
+		*v2 = (ret >= 0);
+		return ret;
+	}
+#endif
+	*v2 = false;
+
+	return request_line(config, chip, line, edge);
+}
+
+static int request_edges(artik_gpio_config *config, int chip,
+			unsigned int line, bool numbered, bool *v2)
+{
+	if (numbered)
+		return request_event_line(config, chip, line, v2);
+
+	*v2 = false;
+
+	return request_line(config, chip, line, GPIO_EDGE_BOTH);
+}
+
+/*
+ * Replace the line handle by a line delivering edge events. The kernel
+ * does not let a line be requested twice, so the handle may have to be
+ * released first, it is requested again if the events cannot be had.
+ */
+static int replace_line(artik_gpio_config *config, os_gpio_data *data,
+			bool numbered)
+{
+	unsigned int line;
+	int chip = resolve_gpio(config->id, &line);
+	bool v2 = false;
+	int fd;
+
+	if (chip < 0)
+		return -ENODEV;
+
+	fd = request_edges(config, chip, line, numbered, &v2);
+	if (fd == -EBUSY && data->line_fd >= 0) {
+		close(data->line_fd);
+		data->line_fd = -1;
+		fd = request_edges(config, chip, line, numbered, &v2);
+		if (fd < 0) {
+			data->line_fd = request_line(config, chip, line,
+							config->edge);
+			data->line_events = config->edge != GPIO_EDGE_NONE;
+			data->line_v2 = false;
+			return fd;
+		}
+	}
+	if (fd < 0)
+		return fd;
+
+	if (data->line_fd >= 0)
+		close(data->line_fd);
+	data->line_fd = fd;
+	data->line_events = true;
+	data->line_v2 = v2;
+
+	return 0;
+}
+
+/* Returns the number of edges read, 0 if none is queued, -1 on error */
+static int read_edges(os_gpio_data *data, os_gpio_edge *edges, int max)
+{
+	ssize_t len;
+	int count;
+	int i;
+
+#ifdef GPIO_V2_LINES_MAX
+	if (data->line_v2) {
+		struct gpio_v2_line_event events[GPIO_EVENTS_BATCH];
+
+		if (max > GPIO_EVENTS_BATCH)
+			max = GPIO_EVENTS_BATCH;
+		len = read(data->line_fd, events, max * sizeof(events[0]));
+		if (len < 0)
+			return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+		count = len / sizeof(events[0]);
+		for (i = 0; i < count; i++) {
+			edges[i].timestamp_ns = events[i].timestamp_ns;
+			edges[i].edge = (events[i].id ==
+					GPIO_V2_LINE_EVENT_RISING_EDGE) ?
+					GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+			edges[i].seqno = events[i].line_seqno;
+		}
+
+		return count;
+	}
+#endif
+	{
+		struct gpioevent_data events[GPIO_EVENTS_BATCH];
+
+		if (max > GPIO_EVENTS_BATCH)
+			max = GPIO_EVENTS_BATCH;
+		len = read(data->line_fd, events, max * sizeof(events[0]));
+		if (len < 0)
+			return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+		count = len / sizeof(events[0]);
+		for (i = 0; i < count; i++) {
+			edges[i].timestamp_ns = events[i].timestamp;
+			edges[i].edge = (events[i].id ==
+					GPIOEVENT_EVENT_RISING_EDGE) ?
+					GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+			edges[i].seqno = 0;
+		}
+
+		return count;
+	}
+}
+
+static int sysfs_request(artik_gpio_config *config)
 {
 	char *export_path = "/sys/class/gpio/export";
-	char *unexport_path = "/sys/class/gpio/unexport";
 	char direction_path[MAX_VAL_STRING];
 	char value_path[MAX_VAL_STRING];
 	char gpio_num[MAX_VAL_STRING];
 	char gpio_dir[MAX_VAL_STRING];
 	char gpio_value[MAX_VAL_STRING];
-	os_gpio_data *data;
 	int ret;
 
-	log_dbg("");
-
-	/* Check input parameters */
-	if (((int)config->id < 0) ||
-			(config->dir >= GPIO_DIR_INVALID) ||
-			(config->edge >= GPIO_EDGE_INVALID))
-		return E_BAD_ARGS;
-
 	snprintf(gpio_num, MAX_VAL_STRING, "%d", config->id);
 	snprintf(gpio_dir, MAX_VAL_STRING, "%s", (config->dir == GPIO_OUT) ?
 								"out" : "in");
@@ -116,19 +518,19 @@ artik_error os_gpio_request(artik_gpio_config *config)
 	/* Export GPIO */
 	ret = write_sysfs_entry(export_path, gpio_num);
 	if (ret < 0) {
-		printf("1. cannot open pin here error while writing to out\n");
-		goto cleanup;
+		log_err("Failed to export GPIO %d", config->id);
+		return ret;
 	}
 	/* Set GPIO direction */
 	ret = write_sysfs_entry(direction_path, gpio_dir);
 	if (ret < 0)
-		goto cleanup;
+		return ret;
 
 	/* Set initial value if output only */
 	if (config->dir == GPIO_OUT) {
 		ret = write_sysfs_entry(value_path, gpio_value);
 		if (ret < 0)
-			goto cleanup;
+			return ret;
 	}
 
 	/* Set edge if input */
@@ -156,92 +558,231 @@ artik_error os_gpio_request(artik_gpio_config *config)
 
 		ret = write_sysfs_entry(edge_path, edge_value);
 		if (ret < 0)
-			goto cleanup;
+			return ret;
 	}
 
+	/* Keep the value file open for reads and writes */
+	ret = open(value_path, (config->dir == GPIO_OUT) ? O_RDWR : O_RDONLY);
+	if (ret < 0)
+		return -errno;
+
+	return ret;
+}
+
+static void sysfs_release(artik_gpio_id id)
+{
+	char *unexport_path = "/sys/class/gpio/unexport";
+	char gpio_num[MAX_VAL_STRING];
+
+	snprintf(gpio_num, MAX_VAL_STRING, "%d", id);
+	write_sysfs_entry(unexport_path, gpio_num);
+}
+
+artik_error os_gpio_request(artik_gpio_config *config)
+{
+	os_gpio_data *data;
+	unsigned int line;
+	int chip;
+	int ret = -ENODEV;
+
+	log_dbg("");
+
+	/* Check input parameters */
+	if (((int)config->id < 0) ||
+			(config->dir >= GPIO_DIR_INVALID) ||
+			(config->edge >= GPIO_EDGE_INVALID))
+		return E_BAD_ARGS;
+
 	data = malloc(sizeof(os_gpio_data));
-	if (!data) {
-		ret = E_NO_MEM;
-		goto cleanup;
-	}
+	if (!data)
+		return E_NO_MEM;
 
 	memset(data, 0, sizeof(*data));
-	config->user_data = (void *)data;
+	data->fd = -1;
+	data->line_fd = -1;
+	data->value_fd = -1;
+
+	if (sim_gpio_exists(config->id)) {
+		if (config->dir == GPIO_OUT)
+			sim_gpio_write(config->id, config->initial_value);
+		data->sim = true;
+		data->id = config->id;
+		config->user_data = (void *)data;
+		return S_OK;
+	}
 
-	return S_OK;
+	chip = resolve_gpio(config->id, &line);
+	if (chip >= 0) {
+		ret = request_line(config, chip, line, config->edge);
+		if (ret >= 0) {
+			data->line_fd = ret;
+			data->line_events = config->dir == GPIO_IN &&
+					config->edge != GPIO_EDGE_NONE;
+			config->user_data = (void *)data;
+			return S_OK;
+		}
+		log_dbg("GPIO %d: chip %d line %u request failed (%d)",
+				config->id, chip, line, ret);
+	}
 
-cleanup:
-	/* Unexport GPIO */
-	write_sysfs_entry(unexport_path, gpio_num);
+	if (!(config->id & GPIO_CHIP_FLAG) && ret != -EBUSY) {
+		ret = sysfs_request(config);
+		if (ret >= 0) {
+			data->value_fd = ret;
+			config->user_data = (void *)data;
+			return S_OK;
+		}
+		sysfs_release(config->id);
+	}
+
+	free(data);
+
+	if (ret == -EACCES)
+		return E_ACCESS_DENIED;
 
-	return (ret == -EACCES) ? E_ACCESS_DENIED : E_BUSY;
+	return (ret == -ENODEV || ret == -EINVAL) ? E_BAD_ARGS : E_BUSY;
 }
 
 artik_error os_gpio_release(artik_gpio_config *config)
 {
-	char *unexport_path = "/sys/class/gpio/unexport";
-	char gpio_num[MAX_VAL_STRING];
+	os_gpio_data *data = (os_gpio_data *)config->user_data;
 
 	log_dbg("");
 
-	snprintf(gpio_num, MAX_VAL_STRING, "%d", config->id);
-	write_sysfs_entry(unexport_path, gpio_num);
+	if (!data)
+		return S_OK;
 
-	write_sysfs_entry(unexport_path, gpio_num);
+	os_gpio_unset_change_callback(config);
 
-	if (config->user_data) {
-		free(config->user_data);
-		config->user_data = NULL;
+	if (data->line_fd >= 0) {
+		close(data->line_fd);
+	} else if (!data->sim) {
+		if (data->value_fd >= 0)
+			close(data->value_fd);
+		sysfs_release(config->id);
 	}
 
+	free(data);
+	config->user_data = NULL;
+
 	return S_OK;
 }
 
+static int read_line(os_gpio_data *data)
+{
+	char gpio_value;
+
+	if (data->sim)
+		return sim_gpio_read(data->id);
+
+#ifdef GPIO_V2_LINES_MAX
+	if (data->line_v2) {
+		struct gpio_v2_line_values values;
+
+		memset(&values, 0, sizeof(values));
+		values.mask = 1;
+		if (ioctl(data->line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL,
+				&values) < 0)
+			return -1;
+
+		return (values.bits & 1) ? 1 : 0;
+	}
+#endif
+	if (data->line_fd >= 0) {
+		struct gpiohandle_data values;
+
+		if (ioctl(data->line_fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL,
+				&values) < 0)
+			return -1;
+
+		return values.values[0] ? 1 : 0;
+	}
+
+	if (pread(data->value_fd, &gpio_value, 1, 0) != 1)
+		return -1;
+
+	if (gpio_value == '0')
+		return 0;
+	else if (gpio_value == '1')
+		return 1;
+
+	return -1;
+}
+
 int os_gpio_read(artik_gpio_config *config)
 {
-	char value_path[MAX_VAL_STRING];
-	char gpio_value[MAX_VAL_STRING];
-	int ret = -1;
+	os_gpio_data *data = (os_gpio_data *)config->user_data;
 
 	log_dbg("");
 
 	if (config->dir != GPIO_IN)
 		return E_ACCESS_DENIED;
 
-	snprintf(value_path, MAX_VAL_STRING,
-				"/sys/class/gpio/gpio%d/value", config->id);
-
-	if (read_sysfs_entry(value_path, gpio_value) < 0)
+	if (!data)
 		return -1;
 
-	if (!strncmp(gpio_value, "0", 1))
-		ret = 0;
-	else if (!strncmp(gpio_value, "1", 1))
-		ret = 1;
-
-	return ret;
+	return read_line(data);
 }
 
 artik_error os_gpio_write(artik_gpio_config *config, int value)
 {
-	char value_path[MAX_VAL_STRING];
-	char gpio_value[MAX_VAL_STRING];
+	os_gpio_data *data = (os_gpio_data *)config->user_data;
 
 	log_dbg("");
 
 	if (config->dir != GPIO_OUT)
 		return E_ACCESS_DENIED;
 
-	snprintf(value_path, MAX_VAL_STRING,
-				"/sys/class/gpio/gpio%d/value", config->id);
-	snprintf(gpio_value, MAX_VAL_STRING, "%s", value ? "1" : "0");
+	if (!data)
+		return E_BAD_ARGS;
+
+	if (data->sim)
+		return sim_gpio_write(data->id, value);
+
+	if (data->line_fd >= 0) {
+		struct gpiohandle_data values;
+
+		memset(&values, 0, sizeof(values));
+		values.values[0] = value ? 1 : 0;
+		if (ioctl(data->line_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL,
+				&values) < 0)
+			return E_BUSY;
 
-	if (write_sysfs_entry(value_path, gpio_value) < 0)
+		return S_OK;
+	}
+
+	if (pwrite(data->value_fd, value ? "1" : "0", 1, 0) != 1)
 		return E_BUSY;
 
 	return S_OK;
 }
 
+/* Each event of the line carries its edge, no need to read the value */
+static int os_gpio_event_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_gpio_data *data = (os_gpio_data *)user_data;
+	os_gpio_edge edges[GPIO_EVENTS_BATCH];
+	int count;
+	int i;
+
+	count = read_edges(data, edges, GPIO_EVENTS_BATCH);
+	if (count < 0) {
+		log_err("Failed to read GPIO events");
+		data->watch_id = 0;
+		return 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		log_dbg("IO: %d, edge=%d", io, edges[i].edge);
+
+		if (data->callback)
+			data->callback(data->user_data,
+					edges[i].edge == GPIO_EDGE_RISING);
+	}
+
+	return 1;
+}
+
 int os_gpio_change_callback(int fd, enum watch_io io, void *user_data)
 {
 	os_gpio_data *data = (os_gpio_data *)user_data;
@@ -279,6 +820,28 @@ int os_gpio_change_callback(int fd, enum watch_io io, void *user_data)
 	return 1;
 }
 
+/* The simulation sends the level of the line after each edge */
+static int os_gpio_sim_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_gpio_data *data = (os_gpio_data *)user_data;
+	unsigned char levels[GPIO_EVENTS_BATCH];
+	ssize_t count;
+	int i;
+
+	count = read(fd, levels, sizeof(levels));
+	if (count < 0)
+		return errno == EAGAIN ? 1 : 0;
+
+	for (i = 0; i < count; i++) {
+		log_dbg("IO: %d, state=%d", io, levels[i]);
+
+		if (data->callback)
+			data->callback(data->user_data, levels[i]);
+	}
+
+	return 1;
+}
+
 artik_error os_gpio_set_change_callback(artik_gpio_config *config,
 				artik_gpio_callback callback, void *user_data)
 {
@@ -289,43 +852,73 @@ artik_error os_gpio_set_change_callback(artik_gpio_config *config,
 
 	log_dbg("");
 
-	if (!callback)
+	if (!callback || !data)
 		return E_BAD_ARGS;
 
 	/* Must be an input */
 	if (config->dir != GPIO_IN)
 		return E_BAD_ARGS;
 
-	snprintf(value_path, MAX_VAL_STRING,
-				"/sys/class/gpio/gpio%d/value", config->id);
-
-	data->fd = open(value_path, O_RDONLY);
-	if (data->fd <= 0)
+	if (data->loop)
 		return E_BUSY;
 
 	data->callback = callback;
 	data->user_data = user_data;
 
-	/* Read value first to clear interrupts */
-	if (lseek(data->fd, 0, SEEK_SET) < 0) {
-		ret = E_ACCESS_DENIED;
-		log_err("Failed to read gpio value");
+	data->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!data->loop) {
+		log_err("Failed to request loop module");
+		return E_BUSY;
+	}
+
+	if (data->sim) {
+		data->fd = sim_gpio_watch(data->id, config->edge);
+		if (data->fd < 0) {
+			ret = E_BUSY;
+			goto exit;
+		}
+
+		ret = data->loop->add_fd_watch(data->fd, WATCH_IO_IN,
+				os_gpio_sim_callback, (void *)data,
+				&data->watch_id);
+		if (ret != S_OK)
+			log_err("Failed to set fd watch callback");
 		goto exit;
 	}
 
-	if (read(data->fd, &gpio_value, sizeof(gpio_value)) < 0) {
-		ret = E_ACCESS_DENIED;
-		log_err("Failed to read gpio value");
+	if (data->line_fd >= 0) {
+		/* Turn the line handle into an event source */
+		if (!data->line_events &&
+				replace_line(config, data, false) < 0) {
+			log_err("Failed to request GPIO events");
+			ret = E_BUSY;
+			goto exit;
+		}
+
+		ret = data->loop->add_fd_watch(data->line_fd, WATCH_IO_IN,
+				os_gpio_event_callback, (void *)data,
+				&data->watch_id);
+		if (ret != S_OK)
+			log_err("Failed to set fd watch callback");
 		goto exit;
 	}
 
-	data->loop = (artik_loop_module *)artik_request_api_module("loop");
-	if (!data->loop) {
-		log_err("Failed to request loop module");
+	snprintf(value_path, MAX_VAL_STRING,
+				"/sys/class/gpio/gpio%d/value", config->id);
+
+	data->fd = open(value_path, O_RDONLY);
+	if (data->fd < 0) {
 		ret = E_BUSY;
 		goto exit;
 	}
 
+	/* Read value first to clear interrupts */
+	if (read(data->fd, &gpio_value, sizeof(gpio_value)) < 0) {
+		ret = E_ACCESS_DENIED;
+		log_err("Failed to read gpio value");
+		goto exit;
+	}
+
 	ret = data->loop->add_fd_watch(data->fd, WATCH_IO_ERR | WATCH_IO_HUP |
 								WATCH_IO_NVAL,
 			os_gpio_change_callback, (void *)data, &data->watch_id);
@@ -336,12 +929,15 @@ artik_error os_gpio_set_change_callback(artik_gpio_config *config,
 
 exit:
 	if (ret != S_OK) {
-		if (data->loop) {
-			artik_release_api_module(data->loop);
-			data->loop = NULL;
-		}
-		close(data->fd);
-		data->fd = 0;
+		artik_release_api_module(data->loop);
+		data->loop = NULL;
+		if (data->sim)
+			sim_gpio_unwatch(data->id);
+		else if (data->fd >= 0)
+			close(data->fd);
+		data->fd = -1;
+		data->callback = NULL;
+		data->user_data = NULL;
 	}
 
 	return ret;
@@ -349,19 +945,493 @@ exit:
 
 void os_gpio_unset_change_callback(artik_gpio_config *config)
 {
-	artik_loop_module *loop = (artik_loop_module *)
-					artik_request_api_module("loop");
 	os_gpio_data *data = (os_gpio_data *)config->user_data;
 
 	log_dbg("");
 
-	if (data->fd) {
+	if (!data || !data->loop)
+		return;
+
+	if (data->watch_id)
+		data->loop->remove_fd_watch(data->watch_id);
+
+	if (data->events) {
+		if (data->events->timeout_id)
+			data->loop->remove_timeout_callback(
+						data->events->timeout_id);
+		/* Freed by deliver_events once the callback returns */
+		if (data->events->dispatching)
+			data->events->stopped = true;
+		else
+			free(data->events);
+		data->events = NULL;
+	}
+
+	artik_release_api_module(data->loop);
+	data->loop = NULL;
+	data->watch_id = 0;
+
+	if (data->sim)
+		sim_gpio_unwatch(data->id);
+	else if (data->fd >= 0)
 		close(data->fd);
+	data->fd = -1;
+
+	data->callback = NULL;
+	data->user_data = NULL;
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void queue_edge(os_gpio_data *data, const os_gpio_edge *edge)
+{
+	os_gpio_events *events = data->events;
+	artik_gpio_event event;
+	unsigned int lost = 0;
+
+	if (edge->seqno) {
+		if (edge->seqno > events->sequence + 1)
+			lost = edge->seqno - events->sequence - 1;
+		events->sequence = edge->seqno;
+	} else {
+		/* Two edges of the same type, at least one was lost */
+		if (events->both_edges && events->sequence &&
+				edge->edge == events->last_edge)
+			lost = 1;
+		events->sequence += lost + 1;
+	}
+	data->stats.overflows += lost;
+	events->last_edge = edge->edge;
+
+	event.timestamp_ns = edge->timestamp_ns;
+	event.edge = edge->edge;
+	event.sequence = events->sequence;
+
+	if (!events->debounce_ns) {
+		events->batch[events->count++] = event;
+		return;
+	}
+
+	if (events->has_pending) {
+		if (event.timestamp_ns - events->pending.timestamp_ns >=
+				events->debounce_ns) {
+			events->batch[events->count++] = events->pending;
+		} else if (event.edge != events->pending.edge) {
+			/* Pulse shorter than the debounce period */
+			data->stats.filtered += 2;
+			events->has_pending = false;
+			return;
+		} else {
+			data->stats.filtered++;
+		}
+	}
+
+	events->pending = event;
+	events->has_pending = true;
+	events->pending_at = now_ns();
+}
+
+/* Returns false if the callback stopped the events */
+static bool deliver_events(os_gpio_data *data)
+{
+	os_gpio_events *events = data->events;
+	int count = events->count;
+
+	if (!count)
+		return true;
+
+	events->count = 0;
+	data->stats.events += count;
+
+	events->dispatching = true;
+	events->callback(events->user_data, events->batch, count);
+	events->dispatching = false;
+
+	if (events->stopped) {
+		free(events);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Read the queued edges and deliver them by batches. Returns 1 on
+ * success, 0 on error and -1 if the callback stopped the events.
+ */
+static int drain_events(os_gpio_data *data)
+{
+	os_gpio_edge edges[GPIO_EVENTS_BATCH];
+	int count = 0;
+	int reads;
+	int i;
+
+	for (reads = 0; reads < GPIO_EVENTS_READS; reads++) {
+		count = read_edges(data, edges, GPIO_EVENTS_BATCH);
+		if (count <= 0)
+			break;
+
+		for (i = 0; i < count; i++)
+			queue_edge(data, &edges[i]);
+
+		if (!deliver_events(data))
+			return -1;
+
+		if (count < GPIO_EVENTS_BATCH)
+			break;
+	}
+
+	return (count < 0) ? 0 : 1;
+}
+
+static void debounce_timeout(void *user_data);
+
+static void arm_debounce(os_gpio_data *data)
+{
+	os_gpio_events *events = data->events;
+	unsigned long long elapsed;
+	unsigned int msec = 0;
+
+	if (!events->has_pending || events->timeout_id)
+		return;
+
+	elapsed = now_ns() - events->pending_at;
+	if (elapsed < events->debounce_ns)
+		msec = (events->debounce_ns - elapsed + 999999) / 1000000;
+
+	if (data->loop->add_timeout_callback(&events->timeout_id, msec,
+			debounce_timeout, (void *)data) != S_OK) {
+		log_err("Failed to set debounce timeout");
+		events->timeout_id = 0;
+	}
+}
+
+static void debounce_timeout(void *user_data)
+{
+	os_gpio_data *data = (os_gpio_data *)user_data;
+	os_gpio_events *events = data->events;
+
+	events->timeout_id = 0;
+
+	/* Edges may be queued by the kernel but not read yet */
+	if (drain_events(data) < 0)
+		return;
+
+	if (events->has_pending &&
+			now_ns() - events->pending_at >= events->debounce_ns) {
+		events->batch[events->count++] = events->pending;
+		events->has_pending = false;
+		if (!deliver_events(data))
+			return;
+	}
+
+	arm_debounce(data);
+}
+
+static int os_gpio_events_callback(int fd, enum watch_io io,
+				void *user_data)
+{
+	os_gpio_data *data = (os_gpio_data *)user_data;
+	int ret = drain_events(data);
+
+	if (ret < 0)
+		return 0;
+
+	if (!ret) {
+		log_err("Failed to read GPIO events");
+		data->watch_id = 0;
+		return 0;
+	}
+
+	arm_debounce(data);
+
+	return 1;
+}
+
+artik_error os_gpio_set_events_callback(artik_gpio_config *config,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data)
+{
+	os_gpio_data *data = (os_gpio_data *)config->user_data;
+	os_gpio_events *events;
+	artik_error ret;
+	int err;
+
+	log_dbg("");
+
+	if (!callback || !data || config->dir != GPIO_IN)
+		return E_BAD_ARGS;
+
+	if (data->loop)
+		return E_BUSY;
+
+	/* Edges are only queued by the GPIO character device */
+	if (data->line_fd < 0)
+		return E_NOT_SUPPORTED;
+
+	events = malloc(sizeof(os_gpio_events));
+	if (!events)
+		return E_NO_MEM;
+
+	memset(events, 0, sizeof(*events));
+	events->callback = callback;
+	events->user_data = user_data;
+	events->debounce_ns = debounce_us * 1000ULL;
+	events->both_edges = config->edge == GPIO_EDGE_NONE ||
+					config->edge == GPIO_EDGE_BOTH;
+
+	/* A new line starts with an empty queue and numbering */
+	err = replace_line(config, data, true);
+	if (err < 0) {
+		log_err("Failed to request GPIO events (%d)", err);
+		free(events);
+		return (err == -EBUSY) ? E_BUSY : E_ACCESS_DENIED;
+	}
+
+	if (fcntl(data->line_fd, F_SETFL,
+			fcntl(data->line_fd, F_GETFL) | O_NONBLOCK) < 0) {
+		free(events);
+		return E_ACCESS_DENIED;
+	}
+
+	data->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!data->loop) {
+		log_err("Failed to request loop module");
+		free(events);
+		return E_BUSY;
+	}
+
+	memset(&data->stats, 0, sizeof(data->stats));
+	data->events = events;
+
+	ret = data->loop->add_fd_watch(data->line_fd, WATCH_IO_IN,
+			os_gpio_events_callback, (void *)data,
+			&data->watch_id);
+	if (ret != S_OK) {
+		log_err("Failed to set fd watch callback");
+		artik_release_api_module(data->loop);
+		data->loop = NULL;
+		data->events = NULL;
+		data->watch_id = 0;
+		free(events);
+	}
+
+	return ret;
+}
+
+artik_error os_gpio_get_event_stats(artik_gpio_config *config,
+				artik_gpio_event_stats *stats)
+{
+	os_gpio_data *data = (os_gpio_data *)config->user_data;
+
+	if (!data)
+		return E_BAD_ARGS;
+
+	*stats = data->stats;
+
+	return S_OK;
+}
 
-		if (data->loop) {
-			data->loop->remove_fd_watch(data->watch_id);
-			artik_release_api_module(loop);
+static void release_group(os_gpio_group *group)
+{
+	if (group->fd >= 0)
+		close(group->fd);
+	else
+		os_gpio_release(&group->config);
+}
+
+static artik_error request_group(os_gpio_group *group, artik_gpio_dir_t dir,
+				 artik_gpio_config *configs)
+{
+	struct gpiohandle_request req;
+	int chip_fd;
+	unsigned int i;
+
+	if (group->chip < 0)
+		return os_gpio_request(&group->config);
+
+	memset(&req, 0, sizeof(req));
+	req.lines = group->num_lines;
+	req.flags = (dir == GPIO_OUT) ? GPIOHANDLE_REQUEST_OUTPUT :
+						GPIOHANDLE_REQUEST_INPUT;
+	for (i = 0; i < group->num_lines; i++) {
+		req.lineoffsets[i] = group->offsets[i];
+		req.default_values[i] =
+			configs[group->index[i]].initial_value ? 1 : 0;
+	}
+	strncpy(req.consumer_label, configs[group->index[0]].name ?
+			configs[group->index[0]].name : "artik",
+			sizeof(req.consumer_label) - 1);
+
+	chip_fd = open_gpio_chip(group->chip);
+	if (chip_fd < 0)
+		return E_ACCESS_DENIED;
+
+	if (ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &req) < 0) {
+		log_err("Failed to request %u lines of GPIO chip %d (%d)",
+				group->num_lines, group->chip, errno);
+		close(chip_fd);
+		return errno == EBUSY ? E_BUSY : E_ACCESS_DENIED;
+	}
+
+	close(chip_fd);
+	group->fd = req.fd;
+
+	return S_OK;
+}
+
+artik_error os_gpio_request_bulk(artik_gpio_config *configs, int count,
+				void **bulk)
+{
+	os_gpio_bulk *data;
+	artik_error ret = S_OK;
+	unsigned int g;
+	int i;
+
+	log_dbg("");
+
+	data = malloc(sizeof(os_gpio_bulk) + count * sizeof(os_gpio_group));
+	if (!data)
+		return E_NO_MEM;
+
+	data->dir = configs[0].dir;
+	data->num_groups = 0;
+
+	/* Gather the lines of each chip into as few handles as possible */
+	for (i = 0; i < count; i++) {
+		os_gpio_group *group = NULL;
+		unsigned int line = 0;
+		int chip = -1;
+
+		/* Simulated lines are requested one by one */
+		if (!sim_gpio_exists(configs[i].id)) {
+			chip = resolve_gpio(configs[i].id, &line);
+			if (chip < 0 && (configs[i].id & GPIO_CHIP_FLAG)) {
+				free(data);
+				return E_BAD_ARGS;
+			}
+		}
+
+		for (g = 0; chip >= 0 && g < data->num_groups; g++) {
+			if (data->groups[g].chip == chip &&
+				data->groups[g].num_lines < GPIOHANDLES_MAX) {
+				group = &data->groups[g];
+				break;
+			}
+		}
+
+		if (!group) {
+			group = &data->groups[data->num_groups++];
+			memset(group, 0, sizeof(*group));
+			group->chip = chip;
+			group->fd = -1;
+			group->config = configs[i];
+			group->config.edge = GPIO_EDGE_NONE;
+			group->config.user_data = NULL;
 		}
-		memset(data, 0, sizeof(*data));
+
+		group->offsets[group->num_lines] = line;
+		group->index[group->num_lines++] = i;
+	}
+
+	for (g = 0; g < data->num_groups; g++) {
+		ret = request_group(&data->groups[g], data->dir, configs);
+		if (ret != S_OK)
+			break;
 	}
+
+	if (ret != S_OK) {
+		while (g--)
+			release_group(&data->groups[g]);
+		free(data);
+		return ret;
+	}
+
+	*bulk = data;
+
+	return S_OK;
+}
+
+artik_error os_gpio_release_bulk(void *bulk)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	unsigned int g;
+
+	log_dbg("");
+
+	for (g = 0; g < data->num_groups; g++)
+		release_group(&data->groups[g]);
+
+	free(data);
+
+	return S_OK;
+}
+
+artik_error os_gpio_read_bulk(void *bulk, int *values)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	unsigned int g, i;
+
+	for (g = 0; g < data->num_groups; g++) {
+		os_gpio_group *group = &data->groups[g];
+		struct gpiohandle_data lines;
+
+		if (group->fd < 0) {
+			int value = read_line(group->config.user_data);
+
+			if (value < 0)
+				return E_ACCESS_DENIED;
+			values[group->index[0]] = value;
+			continue;
+		}
+
+		if (ioctl(group->fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL,
+				&lines) < 0)
+			return E_ACCESS_DENIED;
+
+		for (i = 0; i < group->num_lines; i++)
+			values[group->index[i]] = lines.values[i] ? 1 : 0;
+	}
+
+	return S_OK;
+}
+
+artik_error os_gpio_write_bulk(void *bulk, const int *values)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	unsigned int g, i;
+
+	if (data->dir != GPIO_OUT)
+		return E_ACCESS_DENIED;
+
+	for (g = 0; g < data->num_groups; g++) {
+		os_gpio_group *group = &data->groups[g];
+		struct gpiohandle_data lines;
+
+		if (group->fd < 0) {
+			artik_error ret = os_gpio_write(&group->config,
+						values[group->index[0]]);
+
+			if (ret != S_OK)
+				return ret;
+			continue;
+		}
+
+		memset(&lines, 0, sizeof(lines));
+		for (i = 0; i < group->num_lines; i++)
+			lines.values[i] = values[group->index[i]] ? 1 : 0;
+
+		if (ioctl(group->fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL,
+				&lines) < 0)
+			return E_BUSY;
+	}
+
+	return S_OK;
 }
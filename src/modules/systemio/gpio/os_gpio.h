@@ -28,5 +28,15 @@ artik_error os_gpio_write(artik_gpio_config *config, int value);
 artik_error	os_gpio_set_change_callback(artik_gpio_config *config,
 				artik_gpio_callback callback, void *user_data);
 void	os_gpio_unset_change_callback(artik_gpio_config *config);
+artik_error	os_gpio_request_bulk(artik_gpio_config *configs, int count,
+				void **bulk);
+artik_error	os_gpio_release_bulk(void *bulk);
+artik_error	os_gpio_read_bulk(void *bulk, int *values);
+artik_error	os_gpio_write_bulk(void *bulk, const int *values);
+artik_error	os_gpio_set_events_callback(artik_gpio_config *config,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data);
+artik_error	os_gpio_get_event_stats(artik_gpio_config *config,
+				artik_gpio_event_stats *stats);
 
 #endif /* SRC_GPIO_OS_GPIO_H_ */
@@ -255,3 +255,97 @@ void os_gpio_unset_change_callback(artik_gpio_config *config)
 	pthread_join(data->thread_id, NULL);
 	data->callback = NULL;
 }
+
+/* No grouped access to the GPIO driver, the lines are handled one by one */
+typedef struct {
+	int count;
+	artik_gpio_config configs[];
+} os_gpio_bulk;
+
+artik_error os_gpio_request_bulk(artik_gpio_config *configs, int count,
+				void **bulk)
+{
+	os_gpio_bulk *data;
+	artik_error ret = S_OK;
+	int i;
+
+	data = malloc(sizeof(os_gpio_bulk) + count * sizeof(artik_gpio_config));
+	if (!data)
+		return E_NO_MEM;
+
+	for (i = 0; i < count; i++) {
+		data->configs[i] = configs[i];
+		data->configs[i].user_data = NULL;
+		ret = os_gpio_request(&data->configs[i]);
+		if (ret != S_OK)
+			break;
+	}
+
+	if (ret != S_OK) {
+		while (i--)
+			os_gpio_release(&data->configs[i]);
+		free(data);
+		return ret;
+	}
+
+	data->count = count;
+	*bulk = data;
+
+	return S_OK;
+}
+
+artik_error os_gpio_release_bulk(void *bulk)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	int i;
+
+	for (i = 0; i < data->count; i++)
+		os_gpio_release(&data->configs[i]);
+
+	free(data);
+
+	return S_OK;
+}
+
+artik_error os_gpio_read_bulk(void *bulk, int *values)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	int i;
+
+	for (i = 0; i < data->count; i++) {
+		values[i] = os_gpio_read(&data->configs[i]);
+		if (values[i] < 0)
+			return E_ACCESS_DENIED;
+	}
+
+	return S_OK;
+}
+
+artik_error os_gpio_write_bulk(void *bulk, const int *values)
+{
+	os_gpio_bulk *data = (os_gpio_bulk *)bulk;
+	artik_error ret;
+	int i;
+
+	for (i = 0; i < data->count; i++) {
+		ret = os_gpio_write(&data->configs[i], values[i]);
+		if (ret != S_OK)
+			return ret;
+	}
+
+	return S_OK;
+}
+
+/* The GPIO driver only reports the current value, not queued edges */
+artik_error os_gpio_set_events_callback(artik_gpio_config *config,
+				artik_gpio_events_callback callback,
+				unsigned int debounce_us, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_gpio_get_event_stats(artik_gpio_config *config,
+				artik_gpio_event_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
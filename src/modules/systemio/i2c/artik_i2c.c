@@ -22,6 +22,7 @@
 
 #include "artik_i2c.h"
 #include "artik_list.h"
+#include "artik_indexed_list.h"
 #include "os_i2c.h"
 
 static artik_error artik_i2c_request(artik_i2c_handle * handle,
@@ -35,6 +36,9 @@ static artik_error artik_i2c_read_register(artik_i2c_handle handle,
 static artik_error artik_i2c_write_register(artik_i2c_handle handle,
 					    unsigned int addr, char *buf,
 					    int len);
+static artik_error artik_i2c_transfer(artik_i2c_handle handle,
+				      artik_i2c_msg *msgs,
+				      int count);
 
 const artik_i2c_module i2c_module = {
 	artik_i2c_request,
@@ -42,7 +46,8 @@ const artik_i2c_module i2c_module = {
 	artik_i2c_read,
 	artik_i2c_write,
 	artik_i2c_read_register,
-	artik_i2c_write_register
+	artik_i2c_write_register,
+	artik_i2c_transfer
 };
 
 typedef struct {
@@ -50,7 +55,7 @@ typedef struct {
 	artik_i2c_config config;
 } i2c_node;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(i2c_node *elem, artik_i2c_config *config)
 {
@@ -63,33 +68,37 @@ static int check_exist(i2c_node *elem, artik_i2c_config *config)
 artik_error artik_i2c_request(artik_i2c_handle *handle,
 			      artik_i2c_config *config)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_check(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_check(&requested_node,
 				(ARTIK_LIST_FUNCB)&check_exist, (void *)config);
 	artik_error ret = S_OK;
 
 	if (node)
 		return E_BUSY;
-	node = (i2c_node *) artik_list_add(&requested_node, 0,
+	node = (i2c_node *) artik_indexed_list_add(&requested_node, 0,
 					sizeof(i2c_node));
 	if (!node) {
 		/* node no memory to consume */
 		return E_NO_MEM;
 	}
-	ret = os_i2c_request(config);
+	memcpy(&node->config, config, sizeof(node->config));
+	node->config.user_data = NULL;
+	ret = os_i2c_request(&node->config);
 	if (ret == S_OK) {
 		node->node.handle = (ARTIK_LIST_HANDLE) node;
-		memcpy(&node->config, config, sizeof(node->config));
 		*handle = (artik_i2c_handle)node;
 	} else {
 		/* node request failed */
-		artik_list_delete_node(&requested_node, (artik_list *)node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)node);
 	}
 	return ret;
 }
 
 artik_error artik_i2c_release(artik_i2c_handle handle)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_handle(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
@@ -98,13 +107,14 @@ artik_error artik_i2c_release(artik_i2c_handle handle)
 	ret = os_i2c_release(&node->config);
 	if (ret != S_OK)
 		return ret;
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 	return ret;
 }
 
 artik_error artik_i2c_read(artik_i2c_handle handle, char *buf, int len)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_handle(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -115,7 +125,8 @@ artik_error artik_i2c_read(artik_i2c_handle handle, char *buf, int len)
 
 artik_error artik_i2c_write(artik_i2c_handle handle, char *buf, int len)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_handle(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -127,7 +138,8 @@ artik_error artik_i2c_write(artik_i2c_handle handle, char *buf, int len)
 artik_error artik_i2c_read_register(artik_i2c_handle handle, unsigned int reg,
 				    char *buf, int len)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_handle(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -139,7 +151,8 @@ artik_error artik_i2c_read_register(artik_i2c_handle handle, unsigned int reg,
 artik_error artik_i2c_write_register(artik_i2c_handle handle, unsigned int reg,
 				     char *buf, int len)
 {
-	i2c_node *node = (i2c_node *)artik_list_get_by_handle(requested_node,
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -147,3 +160,22 @@ artik_error artik_i2c_write_register(artik_i2c_handle handle, unsigned int reg,
 
 	return os_i2c_write_register(&node->config, reg, buf, len);
 }
+
+artik_error artik_i2c_transfer(artik_i2c_handle handle,
+			       artik_i2c_msg *msgs, int count)
+{
+	i2c_node *node =
+		(i2c_node *)artik_indexed_list_get_by_handle(&requested_node,
+						(ARTIK_LIST_HANDLE) handle);
+	int i;
+
+	if (!node || !msgs || count <= 0)
+		return E_BAD_ARGS;
+
+	for (i = 0; i < count; i++)
+		if (!msgs[i].buffer || msgs[i].len <= 0 ||
+		    msgs[i].type > I2C_MSG_WRITE_REGISTER)
+			return E_BAD_ARGS;
+
+	return os_i2c_transfer(&node->config, msgs, count);
+}
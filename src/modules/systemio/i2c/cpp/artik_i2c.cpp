@@ -26,6 +26,7 @@ artik::I2c::I2c(artik_i2c_id id, int frequency,
   m_config.frequency = frequency;
   m_config.wordsize = wordsize;
   m_config.address = address;
+  m_config.user_data = NULL;
   m_handle = NULL;
 }
 
@@ -61,3 +62,7 @@ int artik::I2c::read_register(unsigned int addr, char* buf, int len) {
 artik_error artik::I2c::write_register(unsigned int addr, char* buf, int len) {
   return m_module->write_register(m_handle, addr, buf, len);
 }
+
+artik_error artik::I2c::transfer(artik_i2c_msg* msgs, int count) {
+  return m_module->transfer(m_handle, msgs, count);
+}
@@ -16,7 +16,6 @@
  *
  */
 
-
 #include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
@@ -27,245 +26,438 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
 #include <artik_i2c.h>
 #include "os_i2c.h"
+#include "../sim/sim.h"
 
 #define	I2C_DEV_MAX_LEN		64
+/* Length field of struct i2c_msg */
+#define	I2C_MSG_MAX_LEN		0xffff
+
+#ifndef I2C_RDWR_IOCTL_MAX_MSGS
+#define I2C_RDWR_IOCTL_MAX_MSGS	42
+#endif
+
+/*
+ * The device is opened once when the handle is requested. The slave
+ * address selected with I2C_SLAVE is always the one of the handle when
+ * the lock is not held, only the SMBus fallback changes it temporarily.
+ * Chips declared with artik_sim_add_device are accessed without device.
+ */
+typedef struct {
+	int fd;
+	bool sim;
+	unsigned long funcs;
+	pthread_mutex_t lock;
+	/* Register addresses and payloads of batched register writes */
+	unsigned char *scratch;
+	size_t scratch_size;
+	char devname[I2C_DEV_MAX_LEN];
+} os_i2c_data;
+
+static bool check_wordsize(artik_i2c_config *config)
+{
+	return (int)config->wordsize >= I2C_8BIT &&
+		(int)config->wordsize < I2C_WORDSIZE_INVALID;
+}
 
 artik_error os_i2c_request(artik_i2c_config *config)
 {
-	int fd = -1;
-	char devname[I2C_DEV_MAX_LEN];
-	artik_error ret = S_OK;
+	os_i2c_data *data;
+
+	if (!check_wordsize(config))
+		return E_BAD_ARGS;
+
+	data = malloc(sizeof(os_i2c_data));
+	if (!data)
+		return E_NO_MEM;
+
+	memset(data, 0, sizeof(os_i2c_data));
 
 	/* Try to open driver and set slave address */
-	snprintf(devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
+	snprintf(data->devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
+
+	if (sim_i2c_exists(config->id, config->address)) {
+		data->fd = -1;
+		data->sim = true;
+		pthread_mutex_init(&data->lock, NULL);
+		config->user_data = data;
+		return S_OK;
+	}
 
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s (%d)\n", devname, errno);
+	data->fd = open(data->devname, O_RDWR | O_CLOEXEC);
+	if (data->fd < 0) {
+		fprintf(stderr, "Failed to open %s (%d)\n", data->devname,
+			errno);
+		free(data);
 		return E_ACCESS_DENIED;
 	}
 
-	if (ioctl(fd, I2C_SLAVE, config->address) < 0) {
+	if (ioctl(data->fd, I2C_SLAVE, config->address) < 0) {
 		fprintf(stderr, "Failed to set slave address to  %s (%d)\n",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
+			data->devname, errno);
+		close(data->fd);
+		free(data);
+		return E_ACCESS_DENIED;
 	}
 
-	close(fd);
+	/* Assume a plain I2C adapter if the driver does not tell */
+	if (ioctl(data->fd, I2C_FUNCS, &data->funcs) < 0)
+		data->funcs = I2C_FUNC_I2C;
 
-	return ret;
+	pthread_mutex_init(&data->lock, NULL);
+	config->user_data = data;
+
+	return S_OK;
 }
 
 artik_error os_i2c_release(artik_i2c_config *config)
 {
-	/* Nothing to do here */
+	os_i2c_data *data = (os_i2c_data *)config->user_data;
+
+	if (!data)
+		return S_OK;
+
+	if (data->fd >= 0)
+		close(data->fd);
+	pthread_mutex_destroy(&data->lock);
+	free(data->scratch);
+	free(data);
+	config->user_data = NULL;
+
 	return S_OK;
 }
 
+static artik_error sim_plain(artik_i2c_config *config,
+				artik_i2c_msg_type type, char *buf, int len)
+{
+	artik_i2c_msg t;
+
+	t.type = type;
+	t.address = config->address;
+	t.reg = 0;
+	t.buffer = buf;
+	t.len = len;
+
+	return sim_i2c_transfer(config->id, config->wordsize, &t, 1);
+}
+
 artik_error os_i2c_read(artik_i2c_config *config, char *buf, int len)
 {
-	int fd = -1;
-	char devname[I2C_DEV_MAX_LEN];
+	os_i2c_data *data = (os_i2c_data *)config->user_data;
 	artik_error ret = S_OK;
 
-	if (config->wordsize == I2C_WORDSIZE_INVALID ||
-		((int)config->wordsize < I2C_8BIT ||
-		(int)config->wordsize > I2C_WORDSIZE_INVALID))
+	if (!data || !check_wordsize(config) || len < 0 ||
+			len > I2C_MSG_MAX_LEN)
 		return E_BAD_ARGS;
 
-	snprintf(devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
-
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s (%d)\n", devname, errno);
-		return E_ACCESS_DENIED;
-	}
+	if (data->sim)
+		return sim_plain(config, I2C_MSG_READ, buf, len);
 
-	if (ioctl(fd, I2C_SLAVE, config->address) < 0) {
-		fprintf(stderr, "Failed to set slave address to  %s (%d)\n",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
-	}
-
-	if (read(fd, buf, len) != len) {
-		fprintf(stderr, "%s: Failed to read (%d)\n", devname, errno);
+	/* The SMBus fallback may select another slave under the lock */
+	pthread_mutex_lock(&data->lock);
+	if (read(data->fd, buf, len) != len) {
+		fprintf(stderr, "%s: Failed to read (%d)\n", data->devname,
+			errno);
 		ret = E_ACCESS_DENIED;
-		goto exit;
 	}
-
-exit:
-	close(fd);
+	pthread_mutex_unlock(&data->lock);
 
 	return ret;
 }
 
 artik_error os_i2c_write(artik_i2c_config *config, char *buf, int len)
 {
-	int fd = -1;
-	char devname[I2C_DEV_MAX_LEN];
+	os_i2c_data *data = (os_i2c_data *)config->user_data;
 	artik_error ret = S_OK;
 
-	if (config->wordsize == I2C_WORDSIZE_INVALID ||
-		((int)config->wordsize < I2C_8BIT ||
-		(int)config->wordsize > I2C_WORDSIZE_INVALID))
+	if (!data || !check_wordsize(config) || len < 0 ||
+			len > I2C_MSG_MAX_LEN)
 		return E_BAD_ARGS;
 
-	snprintf(devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
+	if (data->sim)
+		return sim_plain(config, I2C_MSG_WRITE, buf, len);
 
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s (%d)\n", devname, errno);
-		return E_ACCESS_DENIED;
+	pthread_mutex_lock(&data->lock);
+	if (write(data->fd, buf, len) != len) {
+		fprintf(stderr, "%s: Failed to write (%d)\n", data->devname,
+			errno);
+		ret = E_ACCESS_DENIED;
 	}
+	pthread_mutex_unlock(&data->lock);
 
-	if (ioctl(fd, I2C_SLAVE, config->address) < 0) {
-		fprintf(stderr, "Failed to set slave address to  %s (%d)\n",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
+	return ret;
+}
+
+static unsigned char *get_scratch(os_i2c_data *data, size_t size)
+{
+	unsigned char *scratch;
+
+	if (size <= data->scratch_size)
+		return data->scratch;
+
+	scratch = realloc(data->scratch, size);
+	if (!scratch)
+		return NULL;
+
+	data->scratch = scratch;
+	data->scratch_size = size;
+
+	return scratch;
+}
+
+static artik_error rdwr_transfer(artik_i2c_config *config, os_i2c_data *data,
+				 artik_i2c_msg *msgs, int count)
+{
+	struct i2c_msg rdwr_msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+	struct i2c_rdwr_ioctl_data rdwr;
+	unsigned char *scratch;
+	size_t size = 0;
+	int nmsgs = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (msgs[i].type == I2C_MSG_READ_REGISTER)
+			size += config->wordsize;
+		else if (msgs[i].type == I2C_MSG_WRITE_REGISTER)
+			size += config->wordsize + msgs[i].len;
 	}
 
-	if (write(fd, buf, len) != len) {
-		fprintf(stderr, "%s: Failed to write (%d)\n", devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
+	scratch = get_scratch(data, size);
+	if (size && !scratch)
+		return E_NO_MEM;
+
+	rdwr.msgs = rdwr_msgs;
+
+	for (i = 0; i < count; i++) {
+		artik_i2c_msg *t = &msgs[i];
+		int needed = t->type == I2C_MSG_READ_REGISTER ? 2 : 1;
+
+		/* Split the batch where the driver limit is reached */
+		if (nmsgs + needed > I2C_RDWR_IOCTL_MAX_MSGS) {
+			rdwr.nmsgs = nmsgs;
+			if (ioctl(data->fd, I2C_RDWR, &rdwr) < 0)
+				goto error;
+			nmsgs = 0;
+		}
+
+		rdwr_msgs[nmsgs].addr = t->address;
+		rdwr_msgs[nmsgs].flags = 0;
+
+		switch (t->type) {
+		case I2C_MSG_READ:
+			rdwr_msgs[nmsgs].flags = I2C_M_RD;
+			/* Fall through */
+		case I2C_MSG_WRITE:
+			rdwr_msgs[nmsgs].len = t->len;
+			rdwr_msgs[nmsgs].buf = (unsigned char *)t->buffer;
+			break;
+		case I2C_MSG_READ_REGISTER:
+			memcpy(scratch, &t->reg, config->wordsize);
+			rdwr_msgs[nmsgs].len = config->wordsize;
+			rdwr_msgs[nmsgs].buf = scratch;
+			scratch += config->wordsize;
+			nmsgs++;
+			rdwr_msgs[nmsgs].addr = t->address;
+			rdwr_msgs[nmsgs].flags = I2C_M_RD;
+			rdwr_msgs[nmsgs].len = t->len;
+			rdwr_msgs[nmsgs].buf = (unsigned char *)t->buffer;
+			break;
+		case I2C_MSG_WRITE_REGISTER:
+			memcpy(scratch, &t->reg, config->wordsize);
+			memcpy(scratch + config->wordsize, t->buffer, t->len);
+			rdwr_msgs[nmsgs].len = config->wordsize + t->len;
+			rdwr_msgs[nmsgs].buf = scratch;
+			scratch += config->wordsize + t->len;
+			break;
+		}
+		nmsgs++;
 	}
 
-exit:
-	close(fd);
+	rdwr.nmsgs = nmsgs;
+	if (ioctl(data->fd, I2C_RDWR, &rdwr) < 0)
+		goto error;
 
-	return ret;
+	return S_OK;
+
+error:
+	fprintf(stderr, "%s: Failed to transfer %d messages (%d)\n",
+		data->devname, (int)rdwr.nmsgs, errno);
+	return E_ACCESS_DENIED;
 }
 
-artik_error os_i2c_read_register(artik_i2c_config *config, unsigned int reg,
-				 char *buf, int len)
+static int smbus_access(int fd, char read_write, unsigned char command,
+			int size, union i2c_smbus_data *smbus)
 {
-	int fd = -1;
-	char devname[I2C_DEV_MAX_LEN];
-	artik_error ret = S_OK;
-	struct i2c_rdwr_ioctl_data data;
+	struct i2c_smbus_ioctl_data args;
 
-	if (config->wordsize == I2C_WORDSIZE_INVALID ||
-		((int)config->wordsize < I2C_8BIT ||
-		(int)config->wordsize > I2C_WORDSIZE_INVALID))
-		return E_BAD_ARGS;
+	args.read_write = read_write;
+	args.command = command;
+	args.size = size;
+	args.data = smbus;
 
-	memset(&data, 0, sizeof(data));
-	snprintf(devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
+	return ioctl(fd, I2C_SMBUS, &args);
+}
 
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s (%d)\n", devname, errno);
-		return E_ACCESS_DENIED;
+static artik_error smbus_register(os_i2c_data *data, artik_i2c_msg *t)
+{
+	bool read = t->type == I2C_MSG_READ_REGISTER;
+	union i2c_smbus_data smbus;
+	int offset = 0;
+
+	if (t->len == 1 && (data->funcs & (read ?
+			I2C_FUNC_SMBUS_READ_BYTE_DATA :
+			I2C_FUNC_SMBUS_WRITE_BYTE_DATA))) {
+		if (!read)
+			smbus.byte = t->buffer[0];
+		if (smbus_access(data->fd, read ? I2C_SMBUS_READ :
+				I2C_SMBUS_WRITE, t->reg,
+				I2C_SMBUS_BYTE_DATA, &smbus) < 0)
+			return E_ACCESS_DENIED;
+		if (read)
+			t->buffer[0] = smbus.byte;
+		return S_OK;
 	}
 
-	if (ioctl(fd, I2C_SLAVE, config->address) < 0) {
-		fprintf(stderr, "Failed to set slave address to  %s (%d)\n",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
+	if (!(data->funcs & (read ? I2C_FUNC_SMBUS_READ_I2C_BLOCK :
+			I2C_FUNC_SMBUS_WRITE_I2C_BLOCK)))
+		return E_NOT_SUPPORTED;
+
+	/* Registers are expected to auto-increment past block boundaries */
+	while (offset < t->len) {
+		int chunk = t->len - offset;
+
+		if (chunk > I2C_SMBUS_BLOCK_MAX)
+			chunk = I2C_SMBUS_BLOCK_MAX;
+
+		smbus.block[0] = chunk;
+		if (!read)
+			memcpy(&smbus.block[1], t->buffer + offset, chunk);
+		if (smbus_access(data->fd, read ? I2C_SMBUS_READ :
+				I2C_SMBUS_WRITE, t->reg + offset,
+				I2C_SMBUS_I2C_BLOCK_DATA, &smbus) < 0)
+			return E_ACCESS_DENIED;
+		if (read)
+			memcpy(t->buffer + offset, &smbus.block[1], chunk);
+		offset += chunk;
 	}
 
-	data.nmsgs = 2;
-	data.msgs = malloc(data.nmsgs * sizeof(struct i2c_msg));
-	if (!data.msgs) {
-		ret = -E_NO_MEM;
-		goto exit;
-	}
+	return S_OK;
+}
 
-	data.msgs[0].addr = config->address;
-	data.msgs[0].flags = 0;
-	data.msgs[0].len = config->wordsize;
-	data.msgs[0].buf = (unsigned char *)&reg;
+/*
+ * Adapters such as i2c-stub only understand SMBus commands, run the
+ * messages one by one and switch the slave address when needed.
+ */
+static artik_error smbus_transfer(artik_i2c_config *config,
+				  os_i2c_data *data,
+				  artik_i2c_msg *msgs, int count)
+{
+	unsigned char address = config->address;
+	artik_error ret = S_OK;
+	int i;
+
+	for (i = 0; i < count && ret == S_OK; i++) {
+		artik_i2c_msg *t = &msgs[i];
+
+		if (t->address != address) {
+			if (ioctl(data->fd, I2C_SLAVE, t->address) < 0) {
+				ret = E_ACCESS_DENIED;
+				break;
+			}
+			address = t->address;
+		}
+
+		switch (t->type) {
+		case I2C_MSG_READ:
+			if (read(data->fd, t->buffer, t->len) != t->len)
+				ret = E_ACCESS_DENIED;
+			break;
+		case I2C_MSG_WRITE:
+			if (write(data->fd, t->buffer, t->len) != t->len)
+				ret = E_ACCESS_DENIED;
+			break;
+		default:
+			if (config->wordsize != I2C_8BIT ||
+					t->reg + t->len > 0x100)
+				ret = E_NOT_SUPPORTED;
+			else
+				ret = smbus_register(data, t);
+			break;
+		}
+	}
 
-	data.msgs[1].addr = config->address;
-	data.msgs[1].flags = I2C_M_RD;
-	data.msgs[1].len = len;
-	data.msgs[1].buf = (unsigned char *)buf;
+	if (ret != S_OK)
+		fprintf(stderr, "%s: Failed to transfer to 0x%02x (%d)\n",
+			data->devname, address, errno);
 
-	if (ioctl(fd, I2C_RDWR, &data) < 0) {
-		fprintf(stderr,
-			"%s: Failed to read register at address 0x%04x (%d)\n",
-			devname, reg, errno);
+	if (address != config->address &&
+			ioctl(data->fd, I2C_SLAVE, config->address) < 0)
 		ret = E_ACCESS_DENIED;
-		goto exit;
-	}
 
-exit:
-	if (data.msgs)
-		free(data.msgs);
-	close(fd);
 	return ret;
 }
 
-artik_error os_i2c_write_register(artik_i2c_config *config, unsigned int reg,
-				  char *buf, int len)
+artik_error os_i2c_transfer(artik_i2c_config *config,
+			    artik_i2c_msg *msgs, int count)
 {
-	int fd = -1;
-	char devname[I2C_DEV_MAX_LEN];
-	artik_error ret = S_OK;
-	struct i2c_rdwr_ioctl_data data;
+	os_i2c_data *data = (os_i2c_data *)config->user_data;
+	artik_error ret;
+	int i;
 
-	if (config->wordsize == I2C_WORDSIZE_INVALID ||
-		((int)config->wordsize < I2C_8BIT ||
-		(int)config->wordsize > I2C_WORDSIZE_INVALID))
+	if (!data || !check_wordsize(config))
 		return E_BAD_ARGS;
 
-	memset(&data, 0, sizeof(data));
-	snprintf(devname, I2C_DEV_MAX_LEN, "/dev/i2c-%d", config->id);
-
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s (%d)\n", devname, errno);
-		return E_ACCESS_DENIED;
+	/* Register writes carry the register address in the same message */
+	for (i = 0; i < count; i++) {
+		if (msgs[i].len < 0 || msgs[i].len > I2C_MSG_MAX_LEN)
+			return E_BAD_ARGS;
+		if (msgs[i].type == I2C_MSG_WRITE_REGISTER && msgs[i].len +
+				(int)config->wordsize > I2C_MSG_MAX_LEN)
+			return E_BAD_ARGS;
 	}
 
-	if (ioctl(fd, I2C_SLAVE, config->address) < 0) {
-		fprintf(stderr, "Failed to set slave address to  %s (%d)\n",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
-	}
+	if (data->sim)
+		return sim_i2c_transfer(config->id, config->wordsize, msgs,
+								count);
 
-	data.nmsgs = 1;
-	data.msgs = malloc(data.nmsgs * sizeof(struct i2c_msg));
-	if (!data.msgs) {
-		ret = -E_NO_MEM;
-		goto exit;
-	}
+	pthread_mutex_lock(&data->lock);
+	if (data->funcs & I2C_FUNC_I2C)
+		ret = rdwr_transfer(config, data, msgs, count);
+	else
+		ret = smbus_transfer(config, data, msgs, count);
+	pthread_mutex_unlock(&data->lock);
 
-	data.msgs[0].addr = config->address;
-	data.msgs[0].flags = 0;
-	data.msgs[0].len = len + config->wordsize;
-	data.msgs[0].buf = malloc(len + config->wordsize);
-	if (!data.msgs[0].buf) {
-		ret = -E_NO_MEM;
-		goto exit;
-	}
-	memcpy(data.msgs[0].buf, &reg, config->wordsize);
-	memcpy(data.msgs[0].buf + config->wordsize, buf,
-	       len);
-
-	if (ioctl(fd, I2C_RDWR, &data) < 0) {
-		fprintf(stderr,
-			"%s: Failed to write register at address 0x%04x (%d)\n",
-			devname, reg, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
-	}
+	return ret;
+}
+
+artik_error os_i2c_read_register(artik_i2c_config *config, unsigned int reg,
+				 char *buf, int len)
+{
+	artik_i2c_msg t;
 
-exit:
-	if (data.msgs && data.msgs[0].buf)
-		free(data.msgs[0].buf);
+	t.type = I2C_MSG_READ_REGISTER;
+	t.address = config->address;
+	t.reg = reg;
+	t.buffer = buf;
+	t.len = len;
 
-	if (data.msgs)
-		free(data.msgs);
+	return os_i2c_transfer(config, &t, 1);
+}
+
+artik_error os_i2c_write_register(artik_i2c_config *config, unsigned int reg,
+				  char *buf, int len)
+{
+	artik_i2c_msg t;
 
-	close(fd);
+	t.type = I2C_MSG_WRITE_REGISTER;
+	t.address = config->address;
+	t.reg = reg;
+	t.buffer = buf;
+	t.len = len;
 
-	return ret;
+	return os_i2c_transfer(config, &t, 1);
 }
@@ -29,5 +29,7 @@ artik_error os_i2c_read_register(artik_i2c_config *config, unsigned int reg,
 				char *buf, int len);
 artik_error os_i2c_write_register(artik_i2c_config *config, unsigned int reg,
 				char *buf, int len);
+artik_error os_i2c_transfer(artik_i2c_config *config,
+				artik_i2c_msg *msgs, int count);
 
 #endif /* SRC_I2C_OS_GPIO_H_ */
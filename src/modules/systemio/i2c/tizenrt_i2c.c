@@ -246,3 +246,40 @@ artik_error os_i2c_write_register(artik_i2c_config *config, unsigned int reg,
 	return E_NOT_SUPPORTED;
 #endif
 }
+
+artik_error os_i2c_transfer(artik_i2c_config *config,
+				artik_i2c_msg *msgs, int count)
+{
+	artik_i2c_config msg_config = *config;
+	artik_error ret = S_OK;
+	int i;
+
+	/* No combined transactions here, run the messages one by one */
+	for (i = 0; i < count && ret == S_OK; i++) {
+		artik_i2c_msg *t = &msgs[i];
+
+		msg_config.address = t->address;
+
+		switch (t->type) {
+		case I2C_MSG_READ:
+			ret = os_i2c_read(&msg_config, t->buffer, t->len);
+			break;
+		case I2C_MSG_WRITE:
+			ret = os_i2c_write(&msg_config, t->buffer, t->len);
+			break;
+		case I2C_MSG_READ_REGISTER:
+			ret = os_i2c_read_register(&msg_config, t->reg,
+						t->buffer, t->len);
+			break;
+		case I2C_MSG_WRITE_REGISTER:
+			ret = os_i2c_write_register(&msg_config, t->reg,
+						t->buffer, t->len);
+			break;
+		default:
+			ret = E_BAD_ARGS;
+			break;
+		}
+	}
+
+	return ret;
+}
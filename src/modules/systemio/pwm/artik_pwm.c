@@ -22,6 +22,7 @@
 
 #include	"artik_pwm.h"
 #include	"artik_list.h"
+#include	"artik_indexed_list.h"
 #include	"os_pwm.h"
 
 static artik_error artik_pwm_request(artik_pwm_handle * handle,
@@ -35,6 +36,14 @@ static artik_error artik_pwm_set_polarity(artik_pwm_handle handle,
 					artik_pwm_polarity_t value);
 static artik_error artik_pwm_set_duty_cycle(artik_pwm_handle handle,
 					unsigned int value);
+static artik_error artik_pwm_apply_states(artik_pwm_handle *handles,
+					const artik_pwm_state *states,
+					int count);
+static artik_error artik_pwm_start_waveform(artik_pwm_handle handle,
+					const artik_pwm_waveform *waveform,
+					artik_pwm_waveform_callback callback,
+					void *user_data);
+static artik_error artik_pwm_stop_waveform(artik_pwm_handle handle);
 
 artik_pwm_module pwm_module = {
 	artik_pwm_request,
@@ -43,7 +52,10 @@ artik_pwm_module pwm_module = {
 	artik_pwm_disable,
 	artik_pwm_set_period,
 	artik_pwm_set_polarity,
-	artik_pwm_set_duty_cycle
+	artik_pwm_set_duty_cycle,
+	artik_pwm_apply_states,
+	artik_pwm_start_waveform,
+	artik_pwm_stop_waveform
 };
 
 typedef struct {
@@ -51,7 +63,7 @@ typedef struct {
 	artik_pwm_config config;
 } pwm_node;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(pwm_node *elem, int val_pin)
 {
@@ -63,14 +75,15 @@ static int check_exist(pwm_node *elem, int val_pin)
 artik_error artik_pwm_request(artik_pwm_handle *handle,
 				artik_pwm_config *config)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_check(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_check(&requested_node,
 		(ARTIK_LIST_FUNCB)&check_exist, (void *)(intptr_t)config->pin_num);
 
 	artik_error ret = S_OK;
 
 	if (node)
 		return E_BUSY;
-	node = (pwm_node *) artik_list_add(&requested_node, 0,
+	node = (pwm_node *) artik_indexed_list_add(&requested_node, 0,
 							sizeof(pwm_node));
 	if (!node) {
 		/* node no memory to consume */
@@ -83,14 +96,16 @@ artik_error artik_pwm_request(artik_pwm_handle *handle,
 		*handle = (artik_pwm_handle)node;
 	} else {
 		/* node request failed */
-		artik_list_delete_node(&requested_node, (artik_list *)node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)node);
 	}
 	return ret;
 }
 
 artik_error artik_pwm_release(artik_pwm_handle handle)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
@@ -99,13 +114,14 @@ artik_error artik_pwm_release(artik_pwm_handle handle)
 	ret = os_pwm_release(&node->config);
 	if (ret != S_OK)
 		return ret;
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 	return ret;
 }
 
 artik_error artik_pwm_enable(artik_pwm_handle handle)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -116,7 +132,8 @@ artik_error artik_pwm_enable(artik_pwm_handle handle)
 
 artik_error artik_pwm_disable(artik_pwm_handle handle)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -127,7 +144,8 @@ artik_error artik_pwm_disable(artik_pwm_handle handle)
 
 artik_error artik_pwm_set_period(artik_pwm_handle handle, unsigned int value)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -139,7 +157,8 @@ artik_error artik_pwm_set_period(artik_pwm_handle handle, unsigned int value)
 artik_error artik_pwm_set_polarity(artik_pwm_handle handle,
 					artik_pwm_polarity_t value)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -151,7 +170,8 @@ artik_error artik_pwm_set_polarity(artik_pwm_handle handle,
 artik_error artik_pwm_set_duty_cycle(artik_pwm_handle handle,
 					unsigned int value)
 {
-	pwm_node *node = (pwm_node *)artik_list_get_by_handle(requested_node,
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -159,3 +179,62 @@ artik_error artik_pwm_set_duty_cycle(artik_pwm_handle handle,
 
 	return os_pwm_set_duty_cycle(&node->config, value);
 }
+
+artik_error artik_pwm_apply_states(artik_pwm_handle *handles,
+					const artik_pwm_state *states,
+					int count)
+{
+	pwm_node *node;
+	artik_error ret = S_OK;
+	int i;
+
+	if (!handles || !states || count <= 0)
+		return E_BAD_ARGS;
+
+	/* Check all the handles before touching any output */
+	for (i = 0; i < count; i++) {
+		if (!artik_indexed_list_get_by_handle(&requested_node,
+				(ARTIK_LIST_HANDLE) handles[i]))
+			return E_BAD_ARGS;
+		if (states[i].duty_cycle > states[i].period)
+			return E_BAD_ARGS;
+	}
+
+	for (i = 0; i < count && ret == S_OK; i++) {
+		node = (pwm_node *)artik_indexed_list_get_by_handle(
+				&requested_node,
+				(ARTIK_LIST_HANDLE) handles[i]);
+		ret = os_pwm_apply_state(&node->config, &states[i]);
+	}
+
+	return ret;
+}
+
+artik_error artik_pwm_start_waveform(artik_pwm_handle handle,
+					const artik_pwm_waveform *waveform,
+					artik_pwm_waveform_callback callback,
+					void *user_data)
+{
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
+						(ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !waveform || !waveform->duty_cycles ||
+	    waveform->num_steps <= 0 || !waveform->step_us)
+		return E_BAD_ARGS;
+
+	return os_pwm_start_waveform(&node->config, waveform, callback,
+					user_data);
+}
+
+artik_error artik_pwm_stop_waveform(artik_pwm_handle handle)
+{
+	pwm_node *node =
+		(pwm_node *)artik_indexed_list_get_by_handle(&requested_node,
+						(ARTIK_LIST_HANDLE) handle);
+
+	if (!node)
+		return E_BAD_ARGS;
+
+	return os_pwm_stop_waveform(&node->config);
+}
@@ -139,6 +139,32 @@ artik_error artik::Pwm::set_duty_cycle(unsigned int val) {
   return ret;
 }
 
+artik_error artik::Pwm::apply_state(const artik_pwm_state &state) {
+  artik_error ret = S_OK;
+
+  if (this->m_handle) {
+    ret = this->m_module->apply_states(&this->m_handle, &state, 1);
+    if (ret != S_OK)
+      return ret;
+  }
+
+  this->m_config.period = state.period;
+  this->m_config.duty_cycle = state.duty_cycle;
+  this->m_config.polarity = state.polarity;
+
+  return ret;
+}
+
+artik_error artik::Pwm::start_waveform(const artik_pwm_waveform &waveform,
+    artik_pwm_waveform_callback callback, void *user_data) {
+  return this->m_module->start_waveform(this->m_handle, &waveform, callback,
+      user_data);
+}
+
+artik_error artik::Pwm::stop_waveform(void) {
+  return this->m_module->stop_waveform(this->m_handle);
+}
+
 unsigned int artik::Pwm::get_pin_num(void) const {
   return this->m_config.pin_num;
 }
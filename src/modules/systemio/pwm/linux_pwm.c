@@ -21,25 +21,55 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/timerfd.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
 #include <artik_log.h>
+#include <artik_module.h>
+#include <artik_loop.h>
 
 #include "artik_pwm.h"
 #include "os_pwm.h"
 
+typedef struct os_pwm_waveform os_pwm_waveform;
+
 typedef struct {
 	int	*fd;
 	int	chip;
 	int	port;
+	/*
+	 * Values of the device, known for the entries whose PWM_KNOWN bit
+	 * is set in 'known', so that writes changing nothing are skipped.
+	 */
+	unsigned int	known;
+	bool	enabled;
+	unsigned int	duty_cycle;
+	unsigned int	period;
+	artik_pwm_polarity_t	polarity;
+	os_pwm_waveform	*waveform;
 
 } artik_pwm_user_data_t;
 
+struct os_pwm_waveform {
+	artik_pwm_user_data_t	*pwm;
+	artik_loop_module	*loop;
+	int	timer_fd;
+	int	watch_id;
+	unsigned int	*duty_cycles;
+	unsigned int	num_steps;
+	/* Steps played since the start, and steps to play or 0 */
+	unsigned long long	step;
+	unsigned long long	total;
+	artik_pwm_waveform_callback	callback;
+	void	*user_data;
+};
+
 typedef enum {
 	ARTIK_PWM_EXP = 0,
 	ARTIK_PWM_UEXP,
@@ -49,6 +79,8 @@ typedef enum {
 	ARTIK_PWM_POLR
 } artik_pwm_path_index_t;
 
+#define PWM_KNOWN(ifd)	(1 << (ifd))
+
 static char *const tab_value_polarity[] = { "normal", "inversed" };
 
 /*
@@ -68,20 +100,32 @@ static char *const tab_value_path[] = {
 
 #define MAX_SIZE	128
 
-static char *itoa(int n, char *s)
+/* Enough for the decimal form of an unsigned int */
+#define UINT_CHARS	16
+
+/* Decimal form of 'n', stored at the end of 'buf' */
+static const char *format_uint(unsigned int n, char *buf, size_t *len)
 {
-	snprintf(s, 17, "%d", n);
-	return s;
+	char *p = buf + UINT_CHARS;
+
+	do {
+		*--p = '0' + n % 10;
+		n /= 10;
+	} while (n);
+
+	*len = buf + UINT_CHARS - p;
+
+	return p;
 }
 
 static artik_error os_pwm_ioctl(artik_pwm_user_data_t *user_data,
-				artik_pwm_path_index_t ifd, char *value)
+				artik_pwm_path_index_t ifd, const char *value,
+				size_t len)
 {
 	artik_error res = S_OK;
 	int ret;
 
-	ret = write(user_data->fd[ifd], value, (ifd == ARTIK_PWM_ENB ?
-						1 : strlen(value)));
+	ret = pwrite(user_data->fd[ifd], value, len, 0);
 
 	if (ret < 0) {
 		log_err("%s write : %s", __func__, strerror(errno));
@@ -126,10 +170,14 @@ static int os_pwm_open(artik_pwm_user_data_t *user_data,
 
 	log_dbg("");
 
-	if (ifd != ARTIK_PWM_UEXP)
+	if (ifd != ARTIK_PWM_UEXP && ifd != ARTIK_PWM_EXP) {
 		snprintf(tmp_str, MAX_SIZE, tab_value_path[ifd],
 				user_data->chip, user_data->port);
-	else
+		/* Readable to learn the initial state of the output */
+		user_data->fd[ifd] = open(tmp_str, O_SYNC | O_RDWR);
+		if (user_data->fd[ifd] >= 0)
+			return user_data->fd[ifd];
+	} else
 		snprintf(tmp_str, MAX_SIZE, tab_value_path[ifd],
 				user_data->chip);
 	user_data->fd[ifd] = open(tmp_str, O_SYNC | O_WRONLY);
@@ -140,14 +188,17 @@ static artik_error os_pwm_uexport(artik_pwm_user_data_t *user_data,
 						artik_pwm_path_index_t ifd)
 {
 	artik_error res = S_OK;
-	char port[17];
+	char port[UINT_CHARS];
+	const char *value;
+	size_t len;
 
 	log_dbg("");
 
 	if (os_pwm_open(user_data, ifd) < 0)
 		return E_BUSY;
 
-	res = os_pwm_ioctl(user_data, ifd, itoa(user_data->port, port));
+	value = format_uint(user_data->port, port, &len);
+	res = os_pwm_ioctl(user_data, ifd, value, len);
 	if (res != S_OK)
 		goto exit;
 
@@ -157,6 +208,154 @@ exit:
 	return res;
 }
 
+/* Refresh the known value of an entry from the device */
+static void read_entry(artik_pwm_user_data_t *user_data,
+			artik_pwm_path_index_t ifd)
+{
+	char buf[UINT_CHARS];
+	ssize_t len;
+
+	user_data->known &= ~PWM_KNOWN(ifd);
+
+	len = pread(user_data->fd[ifd], buf, sizeof(buf) - 1, 0);
+	if (len <= 0)
+		return;
+	buf[len] = '\0';
+
+	switch (ifd) {
+	case ARTIK_PWM_ENB:
+		user_data->enabled = buf[0] == '1';
+		break;
+	case ARTIK_PWM_CYCL:
+		user_data->duty_cycle = strtoul(buf, NULL, 10);
+		break;
+	case ARTIK_PWM_PERD:
+		user_data->period = strtoul(buf, NULL, 10);
+		break;
+	case ARTIK_PWM_POLR:
+		user_data->polarity = strncmp(buf, "inversed", 8) ?
+			ARTIK_PWM_POLR_NORMAL : ARTIK_PWM_POLR_INVERT;
+		break;
+	default:
+		return;
+	}
+
+	user_data->known |= PWM_KNOWN(ifd);
+}
+
+static artik_error write_enable(artik_pwm_user_data_t *user_data, bool state)
+{
+	artik_error res;
+
+	if ((user_data->known & PWM_KNOWN(ARTIK_PWM_ENB)) &&
+	    user_data->enabled == state)
+		return S_OK;
+
+	res = os_pwm_ioctl(user_data, ARTIK_PWM_ENB, state ? "1" : "0", 1);
+	if (res != S_OK) {
+		read_entry(user_data, ARTIK_PWM_ENB);
+		return res;
+	}
+
+	user_data->enabled = state;
+	user_data->known |= PWM_KNOWN(ARTIK_PWM_ENB);
+
+	return S_OK;
+}
+
+/* Write the period or the duty cycle */
+static artik_error write_uint(artik_pwm_user_data_t *user_data,
+				artik_pwm_path_index_t ifd, unsigned int value)
+{
+	unsigned int *cached = ifd == ARTIK_PWM_PERD ? &user_data->period :
+							&user_data->duty_cycle;
+	char buf[UINT_CHARS];
+	const char *str;
+	artik_error res;
+	size_t len;
+
+	if ((user_data->known & PWM_KNOWN(ifd)) && *cached == value)
+		return S_OK;
+
+	str = format_uint(value, buf, &len);
+	res = os_pwm_ioctl(user_data, ifd, str, len);
+	if (res != S_OK) {
+		read_entry(user_data, ifd);
+		return res;
+	}
+
+	*cached = value;
+	user_data->known |= PWM_KNOWN(ifd);
+
+	return S_OK;
+}
+
+static artik_error write_polarity(artik_pwm_user_data_t *user_data,
+				artik_pwm_polarity_t value)
+{
+	const char *str = tab_value_polarity[value];
+	bool enabled;
+	artik_error res;
+
+	if ((user_data->known & PWM_KNOWN(ARTIK_PWM_POLR)) &&
+	    user_data->polarity == value)
+		return S_OK;
+
+	/* Most drivers refuse to change the polarity of a running output */
+	enabled = !(user_data->known & PWM_KNOWN(ARTIK_PWM_ENB)) ||
+							user_data->enabled;
+	res = write_enable(user_data, false);
+	if (res != S_OK)
+		return res;
+
+	res = os_pwm_ioctl(user_data, ARTIK_PWM_POLR, str, strlen(str));
+	if (res != S_OK)
+		read_entry(user_data, ARTIK_PWM_POLR);
+	else {
+		user_data->polarity = value;
+		user_data->known |= PWM_KNOWN(ARTIK_PWM_POLR);
+	}
+
+	if (enabled) {
+		artik_error err = write_enable(user_data, true);
+
+		if (res == S_OK)
+			res = err;
+	}
+
+	return res;
+}
+
+/*
+ * The kernel rejects a duty cycle longer than the period, so the value
+ * written first is the one that fits with the other current value.
+ */
+static artik_error write_period_duty(artik_pwm_user_data_t *user_data,
+				unsigned int period, unsigned int duty_cycle)
+{
+	artik_error res;
+
+	if ((user_data->known & PWM_KNOWN(ARTIK_PWM_PERD)) &&
+	    duty_cycle <= user_data->period) {
+		res = write_uint(user_data, ARTIK_PWM_CYCL, duty_cycle);
+		if (res == S_OK)
+			res = write_uint(user_data, ARTIK_PWM_PERD, period);
+		return res;
+	}
+
+	if (!(user_data->known & PWM_KNOWN(ARTIK_PWM_CYCL)) ||
+	    user_data->duty_cycle > period) {
+		res = write_uint(user_data, ARTIK_PWM_CYCL, 0);
+		if (res != S_OK)
+			return res;
+	}
+
+	res = write_uint(user_data, ARTIK_PWM_PERD, period);
+	if (res == S_OK)
+		res = write_uint(user_data, ARTIK_PWM_CYCL, duty_cycle);
+
+	return res;
+}
 
 static artik_error os_pwm_init(artik_pwm_config *config,
 					artik_pwm_user_data_t *user_data)
@@ -178,6 +377,8 @@ static artik_error os_pwm_init(artik_pwm_config *config,
 	user_data->chip >>= 8;
 	user_data->chip &= 0xff;
 	user_data->port &= 0xff;
+	user_data->known = 0;
+	user_data->waveform = NULL;
 	ret = os_pwm_uexport(user_data, ARTIK_PWM_EXP);
 	if (ret != S_OK)
 		goto exit;
@@ -187,6 +388,7 @@ static artik_error os_pwm_init(artik_pwm_config *config,
 			ret = E_BAD_ARGS;
 			goto exit;
 		}
+		read_entry(user_data, i);
 		++i;
 	}
 
@@ -225,6 +427,7 @@ static artik_error os_pwm_clean(artik_pwm_user_data_t *user_data)
 artik_error os_pwm_request(artik_pwm_config *config)
 {
 	artik_pwm_user_data_t *user_data = NULL;
+	artik_pwm_state state;
 	artik_error res = S_OK;
 
 	log_dbg("");
@@ -239,19 +442,15 @@ artik_error os_pwm_request(artik_pwm_config *config)
 	if (res != S_OK)
 		return res;
 
-	res = os_pwm_enable(config, true);
-	if (res != S_OK)
-		goto exit;
-
-	res = os_pwm_set_polarity(config, config->polarity);
-	if (res != S_OK)
-		goto exit;
-
-	res = os_pwm_set_period(config, config->period);
+	/* Configure the output before starting it */
+	state.period = config->period;
+	state.duty_cycle = config->duty_cycle;
+	state.polarity = config->polarity;
+	res = os_pwm_apply_state(config, &state);
 	if (res != S_OK)
 		goto exit;
 
-	res = os_pwm_set_duty_cycle(config, config->duty_cycle);
+	res = os_pwm_enable(config, true);
 	if (res != S_OK)
 		goto exit;
 
@@ -268,6 +467,8 @@ artik_error os_pwm_release(artik_pwm_config *config)
 
 	log_dbg("");
 
+	os_pwm_stop_waveform(config);
+
 	res = os_pwm_set_duty_cycle(config, 0);
 	if (res != S_OK)
 		goto exit;
@@ -290,84 +491,201 @@ exit:
 
 artik_error os_pwm_enable(artik_pwm_config *config, bool state)
 {
-	char value;
-
 	log_dbg("");
 
-	value = state ? '1' : '0';
-
-	return os_pwm_ioctl(config->user_data, ARTIK_PWM_ENB, &value);
+	return write_enable(config->user_data, state);
 }
 
 artik_error os_pwm_set_period(artik_pwm_config *config, unsigned int value)
 {
-	artik_error res = S_OK;
-	char val[17];
+	log_dbg("");
+
+	return write_uint(config->user_data, ARTIK_PWM_PERD, value);
+}
 
+artik_error os_pwm_set_polarity(artik_pwm_config *config,
+				artik_pwm_polarity_t value)
+{
 	log_dbg("");
 
-	res = os_pwm_enable(config, false);
-	if (res != S_OK)
-		goto exit;
+	if ((value != ARTIK_PWM_POLR_NORMAL) && (value != ARTIK_PWM_POLR_INVERT))
+		return E_BAD_ARGS;
 
-	res = os_pwm_ioctl(config->user_data, ARTIK_PWM_PERD, itoa(value, val));
-	if (res != S_OK)
-		goto exit;
+	return write_polarity(config->user_data, value);
+}
 
-	res = os_pwm_enable(config, true);
-	if (res != S_OK)
-		goto exit;
+artik_error os_pwm_set_duty_cycle(artik_pwm_config *config, unsigned int value)
+{
+	log_dbg("");
 
-exit:
-	return res;
+	return write_uint(config->user_data, ARTIK_PWM_CYCL, value);
 }
 
-artik_error os_pwm_set_polarity(artik_pwm_config *config,
-				artik_pwm_polarity_t value)
+artik_error os_pwm_apply_state(artik_pwm_config *config,
+				const artik_pwm_state *state)
 {
-	artik_error res = S_OK;
+	artik_pwm_user_data_t *user_data = config->user_data;
+	artik_error res;
 
 	log_dbg("");
 
-	if ((value != ARTIK_PWM_POLR_NORMAL) && (value != ARTIK_PWM_POLR_INVERT))
+	if (state->duty_cycle > state->period ||
+	    ((state->polarity != ARTIK_PWM_POLR_NORMAL) &&
+	     (state->polarity != ARTIK_PWM_POLR_INVERT)))
 		return E_BAD_ARGS;
 
-	res = os_pwm_enable(config, false);
+	res = write_polarity(user_data, state->polarity);
 	if (res != S_OK)
-		goto exit;
+		return res;
 
-	res = os_pwm_ioctl(config->user_data, ARTIK_PWM_POLR,
-			tab_value_polarity[value]);
-	if (res != S_OK)
-		goto exit;
+	return write_period_duty(user_data, state->period, state->duty_cycle);
+}
+
+static void free_waveform(os_pwm_waveform *waveform)
+{
+	if (waveform->loop) {
+		if (waveform->watch_id)
+			waveform->loop->remove_fd_watch(waveform->watch_id);
+		artik_release_api_module(waveform->loop);
+	}
+
+	if (waveform->timer_fd >= 0)
+		close(waveform->timer_fd);
+
+	free(waveform->duty_cycles);
+	free(waveform);
+}
+
+static int waveform_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_pwm_waveform *waveform = (os_pwm_waveform *)user_data;
+	artik_pwm_waveform_callback callback;
+	uint64_t expirations;
+	artik_error res;
+
+	if (read(fd, &expirations, sizeof(expirations)) !=
+						sizeof(expirations))
+		return 1;
+
+	/* Steps whose time has passed are skipped */
+	waveform->step += expirations;
+	if (waveform->total && waveform->step >= waveform->total)
+		waveform->step = waveform->total - 1;
+
+	res = write_uint(waveform->pwm, ARTIK_PWM_CYCL,
+		waveform->duty_cycles[waveform->step % waveform->num_steps]);
+	if (res == S_OK && (!waveform->total ||
+			    waveform->step + 1 < waveform->total))
+		return 1;
 
-	res = os_pwm_enable(config, true);
 	if (res != S_OK)
-		goto exit;
+		log_err("Failed to play the waveform of pwm%d",
+						waveform->pwm->port);
 
-exit:
-	return res;
+	/* Returning 0 removes the watch */
+	waveform->watch_id = 0;
+	waveform->pwm->waveform = NULL;
+	callback = waveform->callback;
+	user_data = waveform->user_data;
+	free_waveform(waveform);
+
+	if (callback)
+		callback(user_data, res);
+
+	return 0;
 }
 
-artik_error os_pwm_set_duty_cycle(artik_pwm_config *config, unsigned int value)
+artik_error os_pwm_start_waveform(artik_pwm_config *config,
+				const artik_pwm_waveform *waveform,
+				artik_pwm_waveform_callback callback,
+				void *user_data)
 {
-	artik_error res = S_OK;
-	char val[17];
+	artik_pwm_user_data_t *pwm = config->user_data;
+	os_pwm_waveform *wf;
+	struct itimerspec its;
+	artik_error ret;
+	int i;
 
 	log_dbg("");
 
-	res = os_pwm_enable(config, false);
-	if (res != S_OK)
-		goto exit;
+	if (pwm->waveform)
+		return E_BUSY;
 
-	res = os_pwm_ioctl(config->user_data, ARTIK_PWM_CYCL, itoa(value, val));
-	if (res != S_OK)
-		goto exit;
+	if (pwm->known & PWM_KNOWN(ARTIK_PWM_PERD)) {
+		for (i = 0; i < waveform->num_steps; i++)
+			if (waveform->duty_cycles[i] > pwm->period)
+				return E_BAD_ARGS;
+	}
 
-	res = os_pwm_enable(config, true);
-	if (res != S_OK)
-		goto exit;
+	wf = calloc(1, sizeof(*wf));
+	if (!wf)
+		return E_NO_MEM;
+
+	wf->pwm = pwm;
+	wf->timer_fd = -1;
+	wf->num_steps = waveform->num_steps;
+	wf->total = (unsigned long long)waveform->repeat * wf->num_steps;
+	wf->callback = callback;
+	wf->user_data = user_data;
+
+	wf->duty_cycles = malloc(wf->num_steps * sizeof(unsigned int));
+	if (!wf->duty_cycles) {
+		ret = E_NO_MEM;
+		goto error;
+	}
+	memcpy(wf->duty_cycles, waveform->duty_cycles,
+					wf->num_steps * sizeof(unsigned int));
+
+	wf->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+					TFD_NONBLOCK | TFD_CLOEXEC);
+	if (wf->timer_fd < 0) {
+		ret = E_NO_MEM;
+		goto error;
+	}
 
-exit:
-	return res;
+	wf->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!wf->loop) {
+		ret = E_BUSY;
+		goto error;
+	}
+
+	ret = wf->loop->add_fd_watch(wf->timer_fd, WATCH_IO_IN,
+			waveform_callback, (void *)wf, &wf->watch_id);
+	if (ret != S_OK)
+		goto error;
+
+	ret = write_uint(pwm, ARTIK_PWM_CYCL, wf->duty_cycles[0]);
+	if (ret != S_OK)
+		goto error;
+
+	its.it_interval.tv_sec = waveform->step_us / 1000000;
+	its.it_interval.tv_nsec = (waveform->step_us % 1000000) * 1000;
+	its.it_value = its.it_interval;
+	if (timerfd_settime(wf->timer_fd, 0, &its, NULL) < 0) {
+		ret = E_INVALID_VALUE;
+		goto error;
+	}
+
+	pwm->waveform = wf;
+
+	return S_OK;
+
+error:
+	free_waveform(wf);
+
+	return ret;
+}
+
+artik_error os_pwm_stop_waveform(artik_pwm_config *config)
+{
+	artik_pwm_user_data_t *pwm = config->user_data;
+
+	log_dbg("");
+
+	if (pwm->waveform) {
+		free_waveform(pwm->waveform);
+		pwm->waveform = NULL;
+	}
+
+	return S_OK;
 }
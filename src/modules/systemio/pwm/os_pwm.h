@@ -28,5 +28,12 @@ artik_error os_pwm_set_period(artik_pwm_config *config, unsigned int value);
 artik_error os_pwm_set_polarity(artik_pwm_config *config,
 				artik_pwm_polarity_t value);
 artik_error os_pwm_set_duty_cycle(artik_pwm_config *config, unsigned int value);
+artik_error os_pwm_apply_state(artik_pwm_config *config,
+				const artik_pwm_state *state);
+artik_error os_pwm_start_waveform(artik_pwm_config *config,
+				const artik_pwm_waveform *waveform,
+				artik_pwm_waveform_callback callback,
+				void *user_data);
+artik_error os_pwm_stop_waveform(artik_pwm_config *config);
 
 #endif  /* __OS_PWM_H__ */
@@ -135,3 +135,31 @@ artik_error os_pwm_set_duty_cycle(artik_pwm_config *config, unsigned int value)
 	return E_NOT_SUPPORTED;
 #endif
 }
+
+artik_error os_pwm_apply_state(artik_pwm_config *config,
+				const artik_pwm_state *state)
+{
+	artik_error res;
+
+	if (state->polarity != ARTIK_PWM_POLR_NORMAL)
+		return E_NOT_SUPPORTED;
+
+	res = os_pwm_set_period(config, state->period);
+	if (res != S_OK)
+		return res;
+
+	return os_pwm_set_duty_cycle(config, state->duty_cycle);
+}
+
+artik_error os_pwm_start_waveform(artik_pwm_config *config,
+				const artik_pwm_waveform *waveform,
+				artik_pwm_waveform_callback callback,
+				void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_pwm_stop_waveform(artik_pwm_config *config)
+{
+	return E_NOT_SUPPORTED;
+}
@@ -23,6 +23,7 @@
 
 #include "artik_serial.h"
 #include "artik_list.h"
+#include "artik_indexed_list.h"
 #include "os_serial.h"
 
 static artik_error artik_serial_request(artik_serial_handle*handle,
@@ -38,6 +39,33 @@ static artik_error artik_serial_set_received_callback(
 						void *user_data);
 static artik_error artik_serial_unset_received_callback(
 						artik_serial_handle handle);
+static artik_error artik_serial_set_frame_callback(artik_serial_handle handle,
+					const artik_serial_framing *framing,
+					artik_serial_frame_callback callback,
+					void *user_data);
+static artik_error artik_serial_get_rx_stats(artik_serial_handle handle,
+					artik_serial_rx_stats *stats);
+static artik_error artik_serial_queue_write(artik_serial_handle handle,
+				unsigned char *buf, int len,
+				artik_serial_release_callback release,
+				void *user_data);
+static artik_error artik_serial_set_tx_callback(artik_serial_handle handle,
+				artik_serial_tx_callback callback,
+				void *user_data);
+static artik_error artik_serial_set_tx_limits(artik_serial_handle handle,
+				const artik_serial_tx_limits *limits);
+static artik_error artik_serial_mux_create(artik_serial_mux_handle *mux,
+				const artik_serial_mux_config *config);
+static artik_error artik_serial_mux_destroy(artik_serial_mux_handle mux);
+static artik_error artik_serial_mux_add_port(artik_serial_mux_handle mux,
+				artik_serial_handle handle,
+				const artik_serial_framing *framing,
+				artik_serial_frame_callback callback,
+				void *user_data);
+static artik_error artik_serial_mux_remove_port(artik_serial_mux_handle mux,
+				artik_serial_handle handle);
+static artik_error artik_serial_mux_get_stats(artik_serial_mux_handle mux,
+				artik_serial_mux_stats *stats);
 
 artik_serial_module serial_module = {
 	artik_serial_request,
@@ -45,7 +73,17 @@ artik_serial_module serial_module = {
 	artik_serial_read,
 	artik_serial_write,
 	artik_serial_set_received_callback,
-	artik_serial_unset_received_callback
+	artik_serial_unset_received_callback,
+	artik_serial_set_frame_callback,
+	artik_serial_get_rx_stats,
+	artik_serial_queue_write,
+	artik_serial_set_tx_callback,
+	artik_serial_set_tx_limits,
+	artik_serial_mux_create,
+	artik_serial_mux_destroy,
+	artik_serial_mux_add_port,
+	artik_serial_mux_remove_port,
+	artik_serial_mux_get_stats
 };
 
 typedef struct {
@@ -53,7 +91,13 @@ typedef struct {
 	artik_serial_config config;
 } serial_node;
 
-static artik_list *requested_node = NULL;
+typedef struct {
+	artik_list node;
+	void *mux;
+} serial_mux_node;
+
+static artik_indexed_list requested_node;
+static artik_indexed_list requested_mux;
 
 static int check_exist(serial_node *elem, unsigned int val_id)
 {
@@ -65,14 +109,14 @@ static int check_exist(serial_node *elem, unsigned int val_id)
 artik_error artik_serial_request(artik_serial_handle *handle,
 				 artik_serial_config *config)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_check(
-		requested_node, (ARTIK_LIST_FUNCB)&check_exist,
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_check(
+		&requested_node, (ARTIK_LIST_FUNCB)&check_exist,
 		(void *)(intptr_t)config->port_num);
 	artik_error ret = S_OK;
 
 	if (node)
 		return E_BUSY;
-	node = (serial_node *) artik_list_add(&requested_node, 0,
+	node = (serial_node *) artik_indexed_list_add(&requested_node, 0,
 		sizeof(serial_node));
 	if (!node) {
 		/* node memory to consume */
@@ -85,15 +129,16 @@ artik_error artik_serial_request(artik_serial_handle *handle,
 		*handle = (artik_serial_handle)node;
 	} else {
 		/* node request failed */
-		artik_list_delete_node(&requested_node, (artik_list *)node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)node);
 	}
 	return ret;
 }
 
 artik_error artik_serial_release(artik_serial_handle handle)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
 	if (!node)
@@ -101,15 +146,15 @@ artik_error artik_serial_release(artik_serial_handle handle)
 	ret = os_serial_release(&node->config);
 	if (ret != S_OK)
 		return ret;
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 	return ret;
 }
 
 artik_error artik_serial_read(artik_serial_handle handle, unsigned char *buf,
 				int *len)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
 		return E_BAD_ARGS;
@@ -119,8 +164,8 @@ artik_error artik_serial_read(artik_serial_handle handle, unsigned char *buf,
 artik_error artik_serial_write(artik_serial_handle handle,
 					unsigned char *const buf, int *len)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
 		return E_BAD_ARGS;
@@ -130,8 +175,8 @@ artik_error artik_serial_write(artik_serial_handle handle,
 artik_error artik_serial_set_received_callback(artik_serial_handle handle,
 				artik_serial_callback callback, void *user_data)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
 		return E_BAD_ARGS;
@@ -141,10 +186,159 @@ artik_error artik_serial_set_received_callback(artik_serial_handle handle,
 
 artik_error artik_serial_unset_received_callback(artik_serial_handle handle)
 {
-	serial_node *node = (serial_node *)artik_list_get_by_handle(
-				requested_node, (ARTIK_LIST_HANDLE) handle);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
 		return E_BAD_ARGS;
 	return os_serial_unset_received_callback(&node->config);
 }
+
+artik_error artik_serial_set_frame_callback(artik_serial_handle handle,
+					const artik_serial_framing *framing,
+					artik_serial_frame_callback callback,
+					void *user_data)
+{
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !framing || !callback)
+		return E_BAD_ARGS;
+	return os_serial_set_frame_callback(&node->config, framing, callback,
+						user_data);
+}
+
+artik_error artik_serial_get_rx_stats(artik_serial_handle handle,
+					artik_serial_rx_stats *stats)
+{
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !stats)
+		return E_BAD_ARGS;
+	return os_serial_get_rx_stats(&node->config, stats);
+}
+
+artik_error artik_serial_queue_write(artik_serial_handle handle,
+				unsigned char *buf, int len,
+				artik_serial_release_callback release,
+				void *user_data)
+{
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !buf || len <= 0)
+		return E_BAD_ARGS;
+	return os_serial_queue_write(&node->config, buf, len, release,
+						user_data);
+}
+
+artik_error artik_serial_set_tx_callback(artik_serial_handle handle,
+				artik_serial_tx_callback callback,
+				void *user_data)
+{
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node)
+		return E_BAD_ARGS;
+	return os_serial_set_tx_callback(&node->config, callback, user_data);
+}
+
+artik_error artik_serial_set_tx_limits(artik_serial_handle handle,
+				const artik_serial_tx_limits *limits)
+{
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !limits)
+		return E_BAD_ARGS;
+	return os_serial_set_tx_limits(&node->config, limits);
+}
+
+artik_error artik_serial_mux_create(artik_serial_mux_handle *mux,
+				const artik_serial_mux_config *config)
+{
+	serial_mux_node *node;
+	artik_error ret;
+
+	if (!mux)
+		return E_BAD_ARGS;
+
+	node = (serial_mux_node *)artik_indexed_list_add(&requested_mux, 0,
+						sizeof(serial_mux_node));
+	if (!node)
+		return E_NO_MEM;
+
+	ret = os_serial_mux_create(&node->mux, config);
+	if (ret != S_OK) {
+		artik_indexed_list_delete_node(&requested_mux,
+				(artik_list *)node);
+		return ret;
+	}
+
+	node->node.handle = (ARTIK_LIST_HANDLE) node;
+	*mux = (artik_serial_mux_handle)node;
+
+	return S_OK;
+}
+
+artik_error artik_serial_mux_destroy(artik_serial_mux_handle mux)
+{
+	serial_mux_node *node = (serial_mux_node *)
+		artik_indexed_list_get_by_handle(&requested_mux,
+						(ARTIK_LIST_HANDLE) mux);
+	artik_error ret;
+
+	if (!node)
+		return E_BAD_ARGS;
+	ret = os_serial_mux_destroy(node->mux);
+	if (ret != S_OK)
+		return ret;
+	artik_indexed_list_delete_node(&requested_mux, (artik_list *)node);
+	return S_OK;
+}
+
+artik_error artik_serial_mux_add_port(artik_serial_mux_handle mux,
+				artik_serial_handle handle,
+				const artik_serial_framing *framing,
+				artik_serial_frame_callback callback,
+				void *user_data)
+{
+	serial_mux_node *mux_node = (serial_mux_node *)
+		artik_indexed_list_get_by_handle(&requested_mux,
+						(ARTIK_LIST_HANDLE) mux);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!mux_node || !node || !framing || !callback)
+		return E_BAD_ARGS;
+	return os_serial_mux_add_port(mux_node->mux, &node->config, framing,
+						callback, user_data);
+}
+
+artik_error artik_serial_mux_remove_port(artik_serial_mux_handle mux,
+				artik_serial_handle handle)
+{
+	serial_mux_node *mux_node = (serial_mux_node *)
+		artik_indexed_list_get_by_handle(&requested_mux,
+						(ARTIK_LIST_HANDLE) mux);
+	serial_node *node = (serial_node *)artik_indexed_list_get_by_handle(
+				&requested_node, (ARTIK_LIST_HANDLE) handle);
+
+	if (!mux_node || !node)
+		return E_BAD_ARGS;
+	return os_serial_mux_remove_port(mux_node->mux, &node->config);
+}
+
+artik_error artik_serial_mux_get_stats(artik_serial_mux_handle mux,
+				artik_serial_mux_stats *stats)
+{
+	serial_mux_node *node = (serial_mux_node *)
+		artik_indexed_list_get_by_handle(&requested_mux,
+						(ARTIK_LIST_HANDLE) mux);
+
+	if (!node || !stats)
+		return E_BAD_ARGS;
+	return os_serial_mux_get_stats(node->mux, stats);
+}
@@ -105,6 +105,32 @@ artik_error artik::Serial::unset_received_callback(void) {
   return m_module->unset_received_callback(this->m_handle);
 }
 
+artik_error artik::Serial::set_frame_callback(
+    const artik_serial_framing &framing, artik_serial_frame_callback callback,
+    void *data) {
+  return m_module->set_frame_callback(this->m_handle, &framing, callback,
+      (data ? data : this->m_handle));
+}
+
+artik_error artik::Serial::get_rx_stats(artik_serial_rx_stats *stats) {
+  return m_module->get_rx_stats(this->m_handle, stats);
+}
+
+artik_error artik::Serial::queue_write(unsigned char *buf, int len,
+    artik_serial_release_callback release, void *data) {
+  return m_module->queue_write(this->m_handle, buf, len, release, data);
+}
+
+artik_error artik::Serial::set_tx_callback(artik_serial_tx_callback callback,
+    void *data) {
+  return m_module->set_tx_callback(this->m_handle, callback,
+      (data ? data : this->m_handle));
+}
+
+artik_error artik::Serial::set_tx_limits(const artik_serial_tx_limits &limits) {
+  return m_module->set_tx_limits(this->m_handle, &limits);
+}
+
 unsigned int artik::Serial::get_port_num(void) const {
   return this->m_config.port_num;
 }
@@ -28,22 +28,73 @@
 #include <termios.h>
 #include <sys/eventfd.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "artik_serial.h"
 #include "os_serial.h"
+#include "serial_rx.h"
+#include "serial_tx.h"
+#include "serial_mux.h"
 #include <artik_module.h>
 #include <artik_log.h>
 
 #define MAX_PATH	128
 #define MAX(a, b)	((a > b) ? a : b)
 
+#define SERIAL_PTS_FLAG		0x40000000
+/* Reads done by one wakeup, so that a busy port does not stall the loop */
+#define SERIAL_RX_READS		8
+/* Idle time after which a received callback gets a NULL buffer */
+#define SERIAL_IDLE_NOTIFY_US	1000000
+/* Buffers passed to one writev, and writes done by one wakeup */
+#define SERIAL_TX_IOV		64
+#define SERIAL_TX_WRITES	8
+
+enum serial_rx_source {
+	SERIAL_RX_NONE,
+	SERIAL_RX_DATA,
+	SERIAL_RX_TIMER
+};
+
 typedef struct {
-	int fd;
+	struct serial_rx rx;
+	artik_loop_module *loop;
 	int watch_id;
-	fd_set rdfs;
+	int timer_fd;
+	int timer_watch_id;
+	unsigned int idle_us;
 	artik_serial_callback callback;
+	artik_serial_frame_callback frame_callback;
 	void *user_data;
+	/* Watch calling back the user, removed by returning 0 from it */
+	enum serial_rx_source dispatching;
+	bool stopped;
+} os_serial_receiver;
+
+typedef struct {
+	struct serial_tx tx;
 	artik_loop_module *loop;
+	int fd;
+	int watch_id;
+	int timer_fd;
+	int timer_watch_id;
+	/* Time taken to send one character */
+	unsigned int char_ns;
+	artik_serial_tx_callback callback;
+	void *user_data;
+	/* Watch calling back the user, 0 for none */
+	int dispatching;
+	bool stopped;
+} os_serial_transmitter;
+
+typedef struct {
+	int fd;
+	unsigned int char_ns;
+	os_serial_receiver *receiver;
+	os_serial_transmitter *transmitter;
+	struct serial_mux_port *mux_port;
 } os_serial_data;
 
 /* This table must strictly follow platform IDs order */
@@ -83,31 +134,46 @@ static const unsigned int baudrate_value[] = {
 	0
 };
 
+/* Must strictly follow enum artik_serial_baudrate_t in artik_serial.h */
+static const unsigned int baudrate_bps[] = {
+	4800, 9600, 14400, 19200, 38400, 57600, 115200, 230400, 460800,
+	500000, 576000, 921600, 1000000, 1152000, 1500000, 2000000, 2500000,
+	3000000, 3500000, 4000000
+};
+
+static void stop_transmitter(os_serial_transmitter *trans);
+
 artik_error os_serial_request(artik_serial_config *config)
 {
 	os_serial_data *data_user = NULL;
 	int platid = artik_get_platform();
 	struct termios tty;
 	char entry[MAX_PATH];
+	unsigned int bits;
 
-	if (platid < 0)
+	if (config->port_num & SERIAL_PTS_FLAG)
+		snprintf(entry, MAX_PATH, "/dev/pts/%u",
+					config->port_num & ~SERIAL_PTS_FLAG);
+	else if (platid < 0 || !plat_port[platid])
 		return E_NOT_SUPPORTED;
+	else
+		snprintf(entry, MAX_PATH, plat_port[platid],
+							config->port_num);
 
 	data_user = malloc(sizeof(os_serial_data));
 	if (!data_user)
-		return -E_NO_MEM;
+		return E_NO_MEM;
 
 	config->data_user = data_user;
-
-	snprintf(entry, MAX_PATH, plat_port[platid], config->port_num);
+	data_user->receiver = NULL;
+	data_user->transmitter = NULL;
+	data_user->mux_port = NULL;
 	data_user->fd = open(entry, O_RDWR | O_NOCTTY | O_NONBLOCK);
 
 	if (data_user->fd < 0) {
 		os_serial_release(config);
 		return E_ACCESS_DENIED;
 	}
-	FD_ZERO(&data_user->rdfs);
-	FD_SET(data_user->fd, &data_user->rdfs);
 
 	/* Initialize minimal termios configuration - RAW mode */
 	memset(&tty, 0, sizeof(struct termios));
@@ -163,6 +229,13 @@ artik_error os_serial_request(artik_serial_config *config)
 	default:
 		break;
 	}
+	/* Start, data, parity and stop bits of a character */
+	bits = 1 + (config->data_bits == ARTIK_SERIAL_DATA_7BIT ? 7 : 8) +
+		(config->parity != ARTIK_SERIAL_PARITY_NONE ? 1 : 0) +
+		(config->stop_bits == ARTIK_SERIAL_STOP_2BIT ? 2 : 1);
+	data_user->char_ns = bits * 1000000000ULL /
+					baudrate_bps[config->baudrate];
+
 	/* flush port before applying attributes */
 	tcflush(data_user->fd, TCIFLUSH);
 	/* Apply attributes */
@@ -178,11 +251,15 @@ artik_error os_serial_release(artik_serial_config *config)
 	os_serial_data *data_user = config->data_user;
 
 	if (data_user != NULL) {
-		if (data_user->fd >= 0) {
-			FD_CLR(data_user->fd, &data_user->rdfs);
+		os_serial_unset_received_callback(config);
+		if (data_user->mux_port)
+			serial_mux_detach(data_user->mux_port);
+		if (data_user->transmitter)
+			stop_transmitter(data_user->transmitter);
+		if (data_user->fd >= 0)
 			close(data_user->fd);
-		}
 		free(data_user);
+		config->data_user = NULL;
 	}
 	return S_OK;
 }
@@ -215,6 +292,9 @@ artik_error os_serial_write(artik_serial_config *config,
 
 	if (data_user->fd < 0)
 		return E_ACCESS_DENIED;
+	/* Bytes would be sent before the ones queued */
+	if (data_user->transmitter && data_user->transmitter->tx.count)
+		return E_BUSY;
 	ret = write(data_user->fd, buf, *len);
 	if (ret < 0)
 		return E_ACCESS_DENIED;
@@ -222,94 +302,592 @@ artik_error os_serial_write(artik_serial_config *config,
 	return S_OK;
 }
 
-int os_serial_change_callback(int fd, enum watch_io io, void *user_data)
+static void free_receiver(os_serial_receiver *recv)
 {
-	os_serial_data *data = (os_serial_data *)user_data;
-	static struct timeval tv = {1, 0};
-	unsigned char buff[255] = "";
-	int res = 0;
+	if (recv->watch_id)
+		recv->loop->remove_fd_watch(recv->watch_id);
+	if (recv->timer_watch_id)
+		recv->loop->remove_fd_watch(recv->timer_watch_id);
+	if (recv->timer_fd >= 0)
+		close(recv->timer_fd);
+	artik_release_api_module(recv->loop);
+	serial_rx_cleanup(&recv->rx);
+	free(recv);
+}
 
-	if (!data) {
-		log_err("invalid user_data provided");
-		return 0;
+static void stop_receiver(os_serial_receiver *recv)
+{
+	if (recv->dispatching == SERIAL_RX_NONE) {
+		free_receiver(recv);
+		return;
 	}
-	if (data->fd < 0) {
-		log_err("wrong fd");
-		return 0;
+
+	/* Freed once the callback returns */
+	if (recv->dispatching == SERIAL_RX_DATA)
+		recv->watch_id = 0;
+	else
+		recv->timer_watch_id = 0;
+	recv->stopped = true;
+}
+
+/* Returns -1 if the receiver was stopped by the callback */
+static int dispatch(os_serial_receiver *recv, enum serial_rx_source source,
+			unsigned char *frame, int len)
+{
+	recv->dispatching = source;
+	if (recv->callback)
+		recv->callback(recv->user_data, frame, len);
+	else
+		recv->frame_callback(recv->user_data, frame, len);
+	recv->dispatching = SERIAL_RX_NONE;
+
+	if (recv->stopped) {
+		free_receiver(recv);
+		return -1;
 	}
-	res = select(data->fd+1, &data->rdfs, NULL, NULL, &tv);
-	if (res && FD_ISSET(data->fd, &data->rdfs))
-		res = read(data->fd, buff, 255);
-	else if (res > 0)
-		res = 0;
-	FD_CLR(data->fd, &data->rdfs);
-	FD_SET(data->fd, &data->rdfs);
-	if (res < 0)
-		return 0;
-	if (data->callback) {
-		data->callback(data->user_data, (!res ? NULL : buff), res);
-		res = select(fd+1, &data->rdfs, NULL, NULL, &tv);
-		if (res == 0 || (res > 0 && !FD_ISSET(fd, &data->rdfs)))
-			data->callback(data->user_data, NULL, 0);
+
+	return 0;
+}
+
+static int deliver_frames(os_serial_receiver *recv)
+{
+	unsigned char *frame;
+	int len;
+
+	switch (recv->rx.framing.type) {
+	case ARTIK_SERIAL_FRAME_NONE:
+		len = serial_rx_flush(&recv->rx, &frame);
+		if (len > 0)
+			return dispatch(recv, SERIAL_RX_DATA, frame, len);
+		break;
+	case ARTIK_SERIAL_FRAME_IDLE:
+		break;
+	default:
+		while ((len = serial_rx_next(&recv->rx, &frame)) > 0)
+			if (dispatch(recv, SERIAL_RX_DATA, frame, len) < 0)
+				return -1;
+		break;
+	}
+
+	return 0;
+}
+
+static int serial_idle_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_serial_receiver *recv = (os_serial_receiver *)user_data;
+	uint64_t expirations;
+	unsigned char *frame;
+	int len;
+
+	if (read(fd, &expirations, sizeof(expirations)) < 0)
+		return 1;
+
+	if (recv->rx.framing.type == ARTIK_SERIAL_FRAME_IDLE) {
+		len = serial_rx_flush(&recv->rx, &frame);
+		if (len > 0 && dispatch(recv, SERIAL_RX_TIMER, frame, len) < 0)
+			return 0;
+	} else if (recv->callback) {
+		if (dispatch(recv, SERIAL_RX_TIMER, NULL, 0) < 0)
+			return 0;
 	}
-	FD_CLR(fd, &data->rdfs);
-	if (res)
-		FD_SET(fd, &data->rdfs);
+
 	return 1;
 }
 
-artik_error os_serial_set_received_callback(artik_serial_config *config,
-				artik_serial_callback callback, void *user_data)
+int os_serial_change_callback(int fd, enum watch_io io, void *user_data)
 {
-	os_serial_data *data = (os_serial_data *)config->data_user;
-	artik_error ret = S_OK;
+	os_serial_receiver *recv = (os_serial_receiver *)user_data;
+	struct itimerspec idle;
+	unsigned char *space;
+	bool received = false;
+	int i, len, ret = 1;
+	ssize_t res;
+
+	for (i = 0; i < SERIAL_RX_READS; i++) {
+		space = serial_rx_space(&recv->rx, &len);
+		res = read(fd, space, len);
+		if (res < 0 && (errno == EAGAIN || errno == EINTR))
+			break;
+		if (res <= 0) {
+			log_err("serial port closed");
+			recv->watch_id = 0;
+			ret = 0;
+			break;
+		}
+
+		serial_rx_commit(&recv->rx, res);
+		received = true;
 
-	if (data->fd == -1) {
+		if (deliver_frames(recv) < 0)
+			return 0;
+
+		/* The port is drained */
+		if (res < len)
+			break;
+	}
+
+	if (received && recv->idle_us) {
+		memset(&idle, 0, sizeof(idle));
+		idle.it_value.tv_sec = recv->idle_us / 1000000;
+		idle.it_value.tv_nsec = (recv->idle_us % 1000000) * 1000;
+		timerfd_settime(recv->timer_fd, 0, &idle, NULL);
+	}
+
+	return ret;
+}
+
+static artik_error start_receiver(os_serial_data *data,
+			const artik_serial_framing *framing,
+			artik_serial_callback callback,
+			artik_serial_frame_callback frame_callback,
+			void *user_data)
+{
+	os_serial_receiver *recv;
+	artik_error ret;
+
+	if (data->fd < 0) {
 		log_err("invalid fd provided");
 		return E_BUSY;
 	}
-	data->callback = callback;
-	data->user_data = user_data;
 
-	data->loop = (artik_loop_module *)artik_request_api_module("loop");
-	if (!data->loop) {
+	/* Received through a multiplexer */
+	if (data->mux_port)
+		return E_BUSY;
+
+	recv = malloc(sizeof(os_serial_receiver));
+	if (!recv)
+		return E_NO_MEM;
+
+	ret = serial_rx_init(&recv->rx, framing, user_data);
+	if (ret != S_OK) {
+		free(recv);
+		return ret;
+	}
+
+	recv->watch_id = 0;
+	recv->timer_watch_id = 0;
+	recv->timer_fd = -1;
+	recv->callback = callback;
+	recv->frame_callback = frame_callback;
+	recv->user_data = user_data;
+	recv->dispatching = SERIAL_RX_NONE;
+	recv->stopped = false;
+	if (framing->type == ARTIK_SERIAL_FRAME_IDLE)
+		recv->idle_us = framing->idle_us;
+	else if (callback)
+		recv->idle_us = SERIAL_IDLE_NOTIFY_US;
+	else
+		recv->idle_us = 0;
+
+	recv->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!recv->loop) {
 		log_err("Failed to request loop module");
-		ret = E_BUSY;
-		goto exit;
+		serial_rx_cleanup(&recv->rx);
+		free(recv);
+		return E_BUSY;
 	}
 
-	ret = data->loop->add_fd_watch(data->fd, WATCH_IO_ERR | WATCH_IO_IN |
-			WATCH_IO_HUP | WATCH_IO_NVAL,
-			os_serial_change_callback, (void *)data,
-			&data->watch_id);
-	if (ret != S_OK) {
-		log_err("Failed to set fd watch callback");
-		goto exit;
+	if (recv->idle_us) {
+		recv->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+					TFD_NONBLOCK | TFD_CLOEXEC);
+		if (recv->timer_fd < 0) {
+			ret = E_ACCESS_DENIED;
+			goto exit;
+		}
+
+		ret = recv->loop->add_fd_watch(recv->timer_fd, WATCH_IO_IN,
+				serial_idle_callback, recv,
+				&recv->timer_watch_id);
+		if (ret != S_OK)
+			goto exit;
 	}
 
+	ret = recv->loop->add_fd_watch(data->fd, WATCH_IO_ERR | WATCH_IO_IN |
+			WATCH_IO_HUP | WATCH_IO_NVAL,
+			os_serial_change_callback, recv, &recv->watch_id);
+
 exit:
 	if (ret != S_OK) {
-		log_err("Failed to callback");
-		if (data->loop) {
-			artik_release_api_module(data->loop);
-			data->loop = NULL;
-		}
+		log_err("Failed to set fd watch callback");
+		free_receiver(recv);
+		return ret;
 	}
-	return ret;
+
+	if (data->receiver)
+		stop_receiver(data->receiver);
+	data->receiver = recv;
+
+	return S_OK;
+}
+
+artik_error os_serial_set_received_callback(artik_serial_config *config,
+				artik_serial_callback callback, void *user_data)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+	artik_serial_framing framing;
+
+	memset(&framing, 0, sizeof(framing));
+	framing.type = ARTIK_SERIAL_FRAME_NONE;
+
+	return start_receiver(data, &framing, callback, NULL, user_data);
+}
+
+artik_error os_serial_set_frame_callback(artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+
+	return start_receiver(data, framing, NULL, callback, user_data);
 }
 
 artik_error os_serial_unset_received_callback(artik_serial_config *config)
 {
-	artik_loop_module *loop = (artik_loop_module *)
-					artik_request_api_module("loop");
 	os_serial_data *data = (os_serial_data *)config->data_user;
 
-	if (data->fd) {
-		if (data->loop) {
-			data->loop->remove_fd_watch(data->watch_id);
-			artik_release_api_module(loop);
+	if (data->receiver) {
+		stop_receiver(data->receiver);
+		data->receiver = NULL;
+	}
+	return S_OK;
+}
+
+artik_error os_serial_get_rx_stats(artik_serial_config *config,
+				artik_serial_rx_stats *stats)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+
+	if (data->mux_port)
+		serial_mux_port_stats(data->mux_port, stats);
+	else if (data->receiver)
+		*stats = data->receiver->rx.stats;
+	else
+		memset(stats, 0, sizeof(*stats));
+	return S_OK;
+}
+
+static void free_transmitter(os_serial_transmitter *trans)
+{
+	struct serial_tx_buffer buffer;
+
+	if (trans->watch_id)
+		trans->loop->remove_fd_watch(trans->watch_id);
+	if (trans->timer_watch_id)
+		trans->loop->remove_fd_watch(trans->timer_watch_id);
+	if (trans->timer_fd >= 0)
+		close(trans->timer_fd);
+
+	while (serial_tx_pop(&trans->tx, true, &buffer))
+		if (buffer.release)
+			buffer.release(buffer.user_data, buffer.buf,
+						buffer.len, E_INTERRUPTED);
+
+	artik_release_api_module(trans->loop);
+	serial_tx_cleanup(&trans->tx);
+	free(trans);
+}
+
+static void stop_transmitter(os_serial_transmitter *trans)
+{
+	if (!trans->dispatching) {
+		free_transmitter(trans);
+		return;
+	}
+
+	/* Freed once the callback returns */
+	if (trans->watch_id == trans->dispatching)
+		trans->watch_id = 0;
+	if (trans->timer_watch_id == trans->dispatching)
+		trans->timer_watch_id = 0;
+	trans->stopped = true;
+}
+
+/*
+ * Call back the user from the watch 'id'. Returns -1 if the
+ * transmitter was stopped by the callback.
+ */
+static int release_buffer(os_serial_transmitter *trans, int id,
+			struct serial_tx_buffer *buffer, artik_error result)
+{
+	if (!buffer->release)
+		return 0;
+
+	trans->dispatching = id;
+	buffer->release(buffer->user_data, buffer->buf, buffer->len, result);
+	trans->dispatching = 0;
+
+	if (trans->stopped) {
+		free_transmitter(trans);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int notify_tx(os_serial_transmitter *trans, int id,
+			artik_serial_tx_event_t event)
+{
+	if (!trans->callback)
+		return 0;
+
+	trans->dispatching = id;
+	trans->callback(trans->user_data, event);
+	trans->dispatching = 0;
+
+	if (trans->stopped) {
+		free_transmitter(trans);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Report ARTIK_SERIAL_TX_COMPLETE if the driver has sent all the
+ * bytes, like tcdrain() without blocking. Otherwise check again
+ * when the bytes left should be sent.
+ */
+static int check_drained(os_serial_transmitter *trans, int id)
+{
+	struct itimerspec wait;
+	unsigned long long ns;
+	int queued = 0;
+
+	if (trans->tx.count || !trans->callback)
+		return 0;
+
+	if (ioctl(trans->fd, TIOCOUTQ, &queued) < 0 || queued <= 0)
+		return notify_tx(trans, id, ARTIK_SERIAL_TX_COMPLETE);
+
+	ns = (unsigned long long)queued * trans->char_ns;
+	memset(&wait, 0, sizeof(wait));
+	wait.it_value.tv_sec = ns / 1000000000;
+	wait.it_value.tv_nsec = ns % 1000000000;
+	timerfd_settime(trans->timer_fd, 0, &wait, NULL);
+
+	return 0;
+}
+
+static int serial_drain_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_serial_transmitter *trans = (os_serial_transmitter *)user_data;
+	uint64_t expirations;
+
+	if (read(fd, &expirations, sizeof(expirations)) < 0)
+		return 1;
+
+	if (check_drained(trans, trans->timer_watch_id) < 0)
+		return 0;
+
+	return 1;
+}
+
+static int serial_out_callback(int fd, enum watch_io io, void *user_data)
+{
+	os_serial_transmitter *trans = (os_serial_transmitter *)user_data;
+	struct iovec iov[SERIAL_TX_IOV];
+	struct serial_tx_buffer buffer;
+	artik_error result = S_OK;
+	int id = trans->watch_id;
+	int i, n;
+	ssize_t res;
+
+	for (i = 0; i < SERIAL_TX_WRITES; i++) {
+		n = serial_tx_iov(&trans->tx, iov, SERIAL_TX_IOV);
+		if (!n)
+			break;
+
+		res = writev(fd, iov, n);
+		if (res < 0) {
+			if (errno == EAGAIN || errno == EINTR)
+				break;
+			log_err("serial write failed (%d)", errno);
+			result = E_ACCESS_DENIED;
+			break;
 		}
-		memset(data, 0, sizeof(*data));
+
+		serial_tx_advance(&trans->tx, res);
+	}
+
+	while (serial_tx_pop(&trans->tx, false, &buffer))
+		if (release_buffer(trans, id, &buffer, S_OK) < 0)
+			return 0;
+
+	/* Nothing queued can be written anymore */
+	if (result != S_OK)
+		while (serial_tx_pop(&trans->tx, true, &buffer))
+			if (release_buffer(trans, id, &buffer, result) < 0)
+				return 0;
+
+	if (serial_tx_unblocked(&trans->tx) &&
+	    notify_tx(trans, id, ARTIK_SERIAL_TX_READY) < 0)
+		return 0;
+
+	if (trans->tx.count)
+		return 1;
+
+	trans->watch_id = 0;
+	check_drained(trans, id);
+
+	return 0;
+}
+
+static artik_error get_transmitter(os_serial_data *data,
+			os_serial_transmitter **transmitter)
+{
+	artik_serial_tx_limits limits = { 0, 0 };
+	os_serial_transmitter *trans = data->transmitter;
+	artik_error ret;
+
+	if (trans) {
+		*transmitter = trans;
+		return S_OK;
+	}
+
+	if (data->fd < 0)
+		return E_ACCESS_DENIED;
+
+	trans = malloc(sizeof(os_serial_transmitter));
+	if (!trans)
+		return E_NO_MEM;
+
+	ret = serial_tx_init(&trans->tx, &limits);
+	if (ret != S_OK) {
+		free(trans);
+		return ret;
+	}
+
+	trans->fd = data->fd;
+	trans->char_ns = data->char_ns;
+	trans->watch_id = 0;
+	trans->timer_watch_id = 0;
+	trans->callback = NULL;
+	trans->user_data = NULL;
+	trans->dispatching = 0;
+	trans->stopped = false;
+
+	trans->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!trans->loop) {
+		log_err("Failed to request loop module");
+		serial_tx_cleanup(&trans->tx);
+		free(trans);
+		return E_BUSY;
+	}
+
+	trans->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+					TFD_NONBLOCK | TFD_CLOEXEC);
+	if (trans->timer_fd < 0) {
+		free_transmitter(trans);
+		return E_ACCESS_DENIED;
 	}
+
+	ret = trans->loop->add_fd_watch(trans->timer_fd, WATCH_IO_IN,
+				serial_drain_callback, trans,
+				&trans->timer_watch_id);
+	if (ret != S_OK) {
+		free_transmitter(trans);
+		return ret;
+	}
+
+	data->transmitter = trans;
+	*transmitter = trans;
+
+	return S_OK;
+}
+
+artik_error os_serial_queue_write(artik_serial_config *config,
+			unsigned char *buf, int len,
+			artik_serial_release_callback release, void *user_data)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+	struct serial_tx_buffer buffer;
+	os_serial_transmitter *trans;
+	artik_error ret;
+
+	ret = get_transmitter(data, &trans);
+	if (ret != S_OK)
+		return ret;
+
+	ret = serial_tx_push(&trans->tx, buf, len, release, user_data);
+	if (ret != S_OK || trans->watch_id)
+		return ret;
+
+	ret = trans->loop->add_fd_watch(trans->fd, WATCH_IO_OUT,
+				serial_out_callback, trans, &trans->watch_id);
+	if (ret != S_OK) {
+		/* The queue was empty without a watch */
+		serial_tx_pop(&trans->tx, true, &buffer);
+		log_err("Failed to set fd watch callback");
+	}
+
+	return ret;
+}
+
+artik_error os_serial_set_tx_callback(artik_serial_config *config,
+			artik_serial_tx_callback callback, void *user_data)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+	os_serial_transmitter *trans;
+	artik_error ret;
+
+	ret = get_transmitter(data, &trans);
+	if (ret != S_OK)
+		return ret;
+
+	trans->callback = callback;
+	trans->user_data = user_data;
+
+	return S_OK;
+}
+
+artik_error os_serial_set_tx_limits(artik_serial_config *config,
+			const artik_serial_tx_limits *limits)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+	os_serial_transmitter *trans;
+	struct serial_tx tx;
+	artik_error ret;
+
+	ret = get_transmitter(data, &trans);
+	if (ret != S_OK)
+		return ret;
+
+	if (trans->tx.count)
+		return E_BUSY;
+
+	ret = serial_tx_init(&tx, limits);
+	if (ret != S_OK)
+		return ret;
+
+	serial_tx_cleanup(&trans->tx);
+	trans->tx = tx;
+
+	return S_OK;
+}
+
+artik_error os_serial_mux_add_port(void *mux, artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+
+	if (data->fd < 0)
+		return E_ACCESS_DENIED;
+	if (data->receiver || data->mux_port)
+		return E_BUSY;
+
+	return serial_mux_attach((struct serial_mux *)mux, data->fd, framing,
+				callback, user_data, &data->mux_port);
+}
+
+artik_error os_serial_mux_remove_port(void *mux, artik_serial_config *config)
+{
+	os_serial_data *data = (os_serial_data *)config->data_user;
+
+	if (!data->mux_port || serial_mux_of(data->mux_port) != mux)
+		return E_BAD_ARGS;
+
+	serial_mux_detach(data->mux_port);
+
 	return S_OK;
 }
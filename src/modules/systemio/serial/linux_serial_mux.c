@@ -0,0 +1,666 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+#include <artik_module.h>
+#include <artik_log.h>
+#include <artik_loop.h>
+
+#include "artik_serial.h"
+#include "os_serial.h"
+#include "serial_mux.h"
+#include "serial_rx.h"
+
+/*
+ * Multiplexer receiving from many ports on one thread.
+ *
+ * The I/O thread reads each port into a ring of its own, which the loop
+ * drains. Ports with new data are flagged in a bitmap and the loop is
+ * woken up through an eventfd, once for all the ports flagged since its
+ * last wakeup. Frames are then cut on the loop thread by serial_rx, as
+ * for the ports read directly. The thread only looks at the table of
+ * ports with the lock held, so that the loop can remove ports at any
+ * time.
+ */
+
+#define MUX_DEFAULT_PORTS	64
+#define MUX_DEFAULT_RING	16384
+#define MUX_MAX_EVENTS		64
+#define MUX_STOP		((uint64_t)-1)
+#define MUX_IDLE		(1ULL << 32)
+
+struct serial_mux_port {
+	struct serial_mux *mux;
+	struct serial_mux_port **owner;
+	int slot;
+	int fd;
+	/* Written by the I/O thread from 'head', read by the loop */
+	unsigned char *ring;
+	uint32_t ring_mask;
+	uint32_t head;
+	uint32_t tail;
+	/* MUX_IDLE | head when the line went idle, 0 otherwise */
+	uint64_t idle_mark;
+	int paused;
+	/* Used by the I/O thread only */
+	unsigned int idle_us;
+	unsigned long long last_rx;
+	/* Used by the loop only */
+	struct serial_rx rx;
+	artik_serial_frame_callback callback;
+	void *user_data;
+	bool removed;
+	struct serial_mux_port *next_removed;
+};
+
+struct serial_mux {
+	int epoll_fd;
+	int wake_fd;
+	int stop_fd;
+	pthread_t thread;
+	bool thread_running;
+	pthread_mutex_t lock;
+	struct serial_mux_port **ports;
+	int max_ports;
+	/* One bit per slot of 'ports' with data for the loop */
+	uint64_t *ready;
+	int signaled;
+	uint32_t ring_size;
+	unsigned int batch_us;
+	artik_loop_module *loop;
+	int watch_id;
+	bool dispatching;
+	bool destroyed;
+	/* Ports removed while dispatching, freed afterwards */
+	struct serial_mux_port *removed;
+	artik_serial_mux_stats stats;
+};
+
+static unsigned long long now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void count(unsigned long long *counter, unsigned long long n)
+{
+	__atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static void mark_ready(struct serial_mux *mux, int slot)
+{
+	__atomic_fetch_or(&mux->ready[slot / 64], 1ULL << (slot % 64),
+							__ATOMIC_RELEASE);
+}
+
+static void wake_loop(struct serial_mux *mux)
+{
+	uint64_t one = 1;
+
+	if (!__atomic_exchange_n(&mux->signaled, 1, __ATOMIC_ACQ_REL))
+		if (write(mux->wake_fd, &one, sizeof(one)) < 0)
+			log_err("Failed to wake up the loop");
+}
+
+/* Returns true if the loop has something new to look at */
+static bool read_port(struct serial_mux *mux, struct serial_mux_port *port,
+			unsigned long long now)
+{
+	uint32_t size = port->ring_mask + 1;
+	uint32_t head = port->head;
+	uint32_t tail = __atomic_load_n(&port->tail, __ATOMIC_ACQUIRE);
+	uint32_t space = size - (head - tail);
+	uint32_t offset = head & port->ring_mask;
+	struct epoll_event event;
+	struct iovec iov[2];
+	ssize_t len;
+
+	if (!space) {
+		/* Let the driver buffer until the loop catches up */
+		memset(&event, 0, sizeof(event));
+		event.data.u64 = port->slot;
+		epoll_ctl(mux->epoll_fd, EPOLL_CTL_MOD, port->fd, &event);
+		__atomic_store_n(&port->paused, 1, __ATOMIC_RELEASE);
+		count(&mux->stats.pauses, 1);
+		mark_ready(mux, port->slot);
+		return true;
+	}
+
+	iov[0].iov_base = port->ring + offset;
+	iov[0].iov_len = space < size - offset ? space : size - offset;
+	iov[1].iov_base = port->ring;
+	iov[1].iov_len = space - iov[0].iov_len;
+
+	len = readv(port->fd, iov, iov[1].iov_len ? 2 : 1);
+	count(&mux->stats.reads, 1);
+	if (len < 0 && (errno == EAGAIN || errno == EINTR))
+		return false;
+	if (len <= 0) {
+		log_err("serial port closed");
+		epoll_ctl(mux->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+		return false;
+	}
+
+	__atomic_store_n(&port->head, head + len, __ATOMIC_RELEASE);
+	count(&mux->stats.bytes, len);
+	if (port->idle_us)
+		port->last_rx = now;
+	mark_ready(mux, port->slot);
+
+	return true;
+}
+
+/*
+ * Flag the ports whose line went idle, setting 'ready' if there are
+ * some. Returns the time of the next check, 0 if there is none.
+ */
+static unsigned long long check_idle(struct serial_mux *mux,
+			unsigned long long now, bool *ready)
+{
+	unsigned long long next = 0, deadline;
+	int i;
+
+	for (i = 0; i < mux->max_ports; i++) {
+		struct serial_mux_port *port = mux->ports[i];
+
+		if (!port || !port->last_rx)
+			continue;
+
+		deadline = port->last_rx + port->idle_us;
+		if (deadline <= now) {
+			port->last_rx = 0;
+			__atomic_store_n(&port->idle_mark,
+					MUX_IDLE | port->head,
+					__ATOMIC_RELEASE);
+			mark_ready(mux, i);
+			*ready = true;
+			continue;
+		}
+
+		if (!next || deadline < next)
+			next = deadline;
+	}
+
+	return next;
+}
+
+static void *mux_thread(void *arg)
+{
+	struct serial_mux *mux = (struct serial_mux *)arg;
+	struct epoll_event events[MUX_MAX_EVENTS];
+	unsigned long long now, wake_at = 0, idle_at = 0, next;
+	bool ready;
+	int i, n, timeout;
+
+	for (;;) {
+		next = wake_at;
+		if (idle_at && (!next || idle_at < next))
+			next = idle_at;
+
+		timeout = -1;
+		if (next) {
+			now = now_us();
+			timeout = next > now ? (next - now + 999) / 1000 : 0;
+		}
+
+		n = epoll_wait(mux->epoll_fd, events, MUX_MAX_EVENTS,
+								timeout);
+		if (n < 0 && errno != EINTR) {
+			log_err("Failed to wait for serial ports (%d)", errno);
+			break;
+		}
+
+		now = now_us();
+		ready = false;
+
+		pthread_mutex_lock(&mux->lock);
+		for (i = 0; i < n; i++) {
+			struct serial_mux_port *port;
+
+			if (events[i].data.u64 == MUX_STOP) {
+				pthread_mutex_unlock(&mux->lock);
+				return NULL;
+			}
+
+			port = mux->ports[events[i].data.u64];
+			if (port && read_port(mux, port, now))
+				ready = true;
+		}
+
+		if (idle_at || ready)
+			idle_at = check_idle(mux, now, &ready);
+		pthread_mutex_unlock(&mux->lock);
+
+		if (ready && !wake_at)
+			wake_at = now + mux->batch_us;
+		if (wake_at && wake_at <= now) {
+			wake_loop(mux);
+			wake_at = 0;
+		}
+	}
+
+	return NULL;
+}
+
+static void free_port(struct serial_mux_port *port)
+{
+	if (port->owner)
+		*port->owner = NULL;
+	serial_rx_cleanup(&port->rx);
+	free(port->ring);
+	free(port);
+}
+
+/* Returns -1 if the port or the multiplexer was removed */
+static int dispatch(struct serial_mux_port *port, unsigned char *frame,
+			int len)
+{
+	port->callback(port->user_data, frame, len);
+
+	return port->removed || port->mux->destroyed ? -1 : 0;
+}
+
+static int deliver_frames(struct serial_mux_port *port)
+{
+	unsigned char *frame;
+	int len;
+
+	switch (port->rx.framing.type) {
+	case ARTIK_SERIAL_FRAME_NONE:
+	case ARTIK_SERIAL_FRAME_IDLE:
+		break;
+	default:
+		while ((len = serial_rx_next(&port->rx, &frame)) > 0)
+			if (dispatch(port, frame, len) < 0)
+				return -1;
+		break;
+	}
+
+	return 0;
+}
+
+/* Move the bytes of the ring up to 'limit' to the frame buffer */
+static int drain_ring(struct serial_mux_port *port, uint32_t limit)
+{
+	uint32_t size = port->ring_mask + 1;
+	uint32_t tail = port->tail;
+
+	while (tail != limit) {
+		uint32_t offset = tail & port->ring_mask;
+		uint32_t n = limit - tail;
+		unsigned char *space;
+		int len;
+
+		space = serial_rx_space(&port->rx, &len);
+		if (n > size - offset)
+			n = size - offset;
+		if (n > (uint32_t)len)
+			n = len;
+
+		memcpy(space, port->ring + offset, n);
+		serial_rx_commit(&port->rx, n);
+		tail += n;
+		__atomic_store_n(&port->tail, tail, __ATOMIC_RELEASE);
+
+		if (deliver_frames(port) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int flush_frame(struct serial_mux_port *port)
+{
+	unsigned char *frame;
+	int len = serial_rx_flush(&port->rx, &frame);
+
+	if (len > 0)
+		return dispatch(port, frame, len);
+
+	return 0;
+}
+
+static int deliver_port(struct serial_mux_port *port)
+{
+	struct serial_mux *mux = port->mux;
+	uint32_t head = __atomic_load_n(&port->head, __ATOMIC_ACQUIRE);
+	uint64_t idle = __atomic_exchange_n(&port->idle_mark, 0,
+							__ATOMIC_ACQ_REL);
+	struct epoll_event event;
+
+	if (idle) {
+		if (drain_ring(port, (uint32_t)idle) < 0 ||
+		    flush_frame(port) < 0)
+			return -1;
+		/* Bytes received once the line went idle again */
+		head = __atomic_load_n(&port->head, __ATOMIC_ACQUIRE);
+	}
+
+	if (drain_ring(port, head) < 0)
+		return -1;
+
+	if (port->rx.framing.type == ARTIK_SERIAL_FRAME_NONE &&
+	    flush_frame(port) < 0)
+		return -1;
+
+	if (__atomic_exchange_n(&port->paused, 0, __ATOMIC_ACQ_REL)) {
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.u64 = port->slot;
+		epoll_ctl(mux->epoll_fd, EPOLL_CTL_MOD, port->fd, &event);
+	}
+
+	return 0;
+}
+
+static void free_mux(struct serial_mux *mux)
+{
+	if (mux->watch_id)
+		mux->loop->remove_fd_watch(mux->watch_id);
+	if (mux->loop)
+		artik_release_api_module(mux->loop);
+	if (mux->epoll_fd >= 0)
+		close(mux->epoll_fd);
+	if (mux->wake_fd >= 0)
+		close(mux->wake_fd);
+	if (mux->stop_fd >= 0)
+		close(mux->stop_fd);
+	pthread_mutex_destroy(&mux->lock);
+	free(mux->ready);
+	free(mux->ports);
+	free(mux);
+}
+
+static int mux_callback(int fd, enum watch_io io, void *user_data)
+{
+	struct serial_mux *mux = (struct serial_mux *)user_data;
+	int words = (mux->max_ports + 63) / 64;
+	uint64_t value, bits;
+	int i;
+
+	if (read(fd, &value, sizeof(value)) < 0)
+		return 1;
+
+	/* Ports flagged from now on wake up the loop again */
+	__atomic_store_n(&mux->signaled, 0, __ATOMIC_SEQ_CST);
+	count(&mux->stats.wakeups, 1);
+
+	mux->dispatching = true;
+	for (i = 0; i < words && !mux->destroyed; i++) {
+		bits = __atomic_exchange_n(&mux->ready[i], 0,
+							__ATOMIC_ACQ_REL);
+		while (bits && !mux->destroyed) {
+			struct serial_mux_port *port;
+
+			port = mux->ports[i * 64 + __builtin_ctzll(bits)];
+			bits &= bits - 1;
+			if (port)
+				deliver_port(port);
+		}
+	}
+	mux->dispatching = false;
+
+	while (mux->removed) {
+		struct serial_mux_port *port = mux->removed;
+
+		mux->removed = port->next_removed;
+		free_port(port);
+	}
+
+	if (mux->destroyed) {
+		mux->watch_id = 0;
+		free_mux(mux);
+		return 0;
+	}
+
+	return 1;
+}
+
+artik_error serial_mux_attach(struct serial_mux *mux, int fd,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data,
+			struct serial_mux_port **owner)
+{
+	struct serial_mux_port *port;
+	struct epoll_event event;
+	artik_error ret;
+	int slot;
+
+	for (slot = 0; slot < mux->max_ports; slot++)
+		if (!mux->ports[slot])
+			break;
+	if (slot == mux->max_ports)
+		return E_BUSY;
+
+	port = calloc(1, sizeof(*port));
+	if (!port)
+		return E_NO_MEM;
+
+	ret = serial_rx_init(&port->rx, framing, user_data);
+	if (ret != S_OK) {
+		free(port);
+		return ret;
+	}
+
+	port->ring = malloc(mux->ring_size);
+	if (!port->ring) {
+		serial_rx_cleanup(&port->rx);
+		free(port);
+		return E_NO_MEM;
+	}
+
+	port->mux = mux;
+	port->slot = slot;
+	port->fd = fd;
+	port->ring_mask = mux->ring_size - 1;
+	port->callback = callback;
+	port->user_data = user_data;
+	if (framing->type == ARTIK_SERIAL_FRAME_IDLE)
+		port->idle_us = framing->idle_us;
+
+	pthread_mutex_lock(&mux->lock);
+	mux->ports[slot] = port;
+	pthread_mutex_unlock(&mux->lock);
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.u64 = slot;
+	if (epoll_ctl(mux->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		log_err("Failed to add port to multiplexer (%d)", errno);
+		pthread_mutex_lock(&mux->lock);
+		mux->ports[slot] = NULL;
+		pthread_mutex_unlock(&mux->lock);
+		free_port(port);
+		return E_ACCESS_DENIED;
+	}
+
+	port->owner = owner;
+	*owner = port;
+
+	return S_OK;
+}
+
+void serial_mux_detach(struct serial_mux_port *port)
+{
+	struct serial_mux *mux = port->mux;
+
+	epoll_ctl(mux->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+
+	/* The I/O thread is done with the port once it can take the lock */
+	pthread_mutex_lock(&mux->lock);
+	mux->ports[port->slot] = NULL;
+	pthread_mutex_unlock(&mux->lock);
+
+	if (port->owner)
+		*port->owner = NULL;
+	port->owner = NULL;
+
+	if (mux->dispatching) {
+		port->removed = true;
+		port->next_removed = mux->removed;
+		mux->removed = port;
+	} else {
+		free_port(port);
+	}
+}
+
+struct serial_mux *serial_mux_of(struct serial_mux_port *port)
+{
+	return port->mux;
+}
+
+void serial_mux_port_stats(struct serial_mux_port *port,
+			artik_serial_rx_stats *stats)
+{
+	*stats = port->rx.stats;
+}
+
+artik_error os_serial_mux_create(void **handle,
+			const artik_serial_mux_config *config)
+{
+	artik_serial_mux_config defaults = { 0, 0, 0 };
+	struct serial_mux *mux;
+	struct epoll_event event;
+	artik_error ret = S_OK;
+
+	if (!config)
+		config = &defaults;
+	if (config->max_ports < 0 || config->ring_size < 0)
+		return E_BAD_ARGS;
+
+	mux = calloc(1, sizeof(*mux));
+	if (!mux)
+		return E_NO_MEM;
+
+	mux->epoll_fd = -1;
+	mux->wake_fd = -1;
+	mux->stop_fd = -1;
+	pthread_mutex_init(&mux->lock, NULL);
+	mux->batch_us = config->batch_us;
+	mux->max_ports = config->max_ports ? config->max_ports :
+							MUX_DEFAULT_PORTS;
+	mux->ring_size = 1;
+	while (mux->ring_size < (uint32_t)(config->ring_size ?
+				config->ring_size : MUX_DEFAULT_RING))
+		mux->ring_size <<= 1;
+
+	mux->ports = calloc(mux->max_ports, sizeof(*mux->ports));
+	mux->ready = calloc((mux->max_ports + 63) / 64, sizeof(uint64_t));
+	if (!mux->ports || !mux->ready) {
+		ret = E_NO_MEM;
+		goto error;
+	}
+
+	mux->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	mux->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	mux->stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (mux->epoll_fd < 0 || mux->wake_fd < 0 || mux->stop_fd < 0) {
+		ret = E_ACCESS_DENIED;
+		goto error;
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.u64 = MUX_STOP;
+	if (epoll_ctl(mux->epoll_fd, EPOLL_CTL_ADD, mux->stop_fd, &event)) {
+		ret = E_ACCESS_DENIED;
+		goto error;
+	}
+
+	mux->loop = (artik_loop_module *)artik_request_api_module("loop");
+	if (!mux->loop) {
+		log_err("Failed to request loop module");
+		ret = E_BUSY;
+		goto error;
+	}
+
+	ret = mux->loop->add_fd_watch(mux->wake_fd, WATCH_IO_IN,
+				mux_callback, mux, &mux->watch_id);
+	if (ret != S_OK)
+		goto error;
+
+	if (pthread_create(&mux->thread, NULL, mux_thread, mux)) {
+		ret = E_NO_MEM;
+		goto error;
+	}
+	mux->thread_running = true;
+
+	*handle = mux;
+
+	return S_OK;
+
+error:
+	free_mux(mux);
+	return ret;
+}
+
+artik_error os_serial_mux_destroy(void *handle)
+{
+	struct serial_mux *mux = (struct serial_mux *)handle;
+	uint64_t one = 1;
+	int i;
+
+	if (mux->thread_running) {
+		if (write(mux->stop_fd, &one, sizeof(one)) < 0)
+			return E_ACCESS_DENIED;
+		pthread_join(mux->thread, NULL);
+		mux->thread_running = false;
+	}
+
+	for (i = 0; i < mux->max_ports; i++)
+		if (mux->ports[i])
+			serial_mux_detach(mux->ports[i]);
+
+	if (mux->dispatching) {
+		/* Freed once the callback returns */
+		mux->watch_id = 0;
+		mux->destroyed = true;
+		return S_OK;
+	}
+
+	free_mux(mux);
+
+	return S_OK;
+}
+
+artik_error os_serial_mux_get_stats(void *handle,
+			artik_serial_mux_stats *stats)
+{
+	struct serial_mux *mux = (struct serial_mux *)handle;
+
+	stats->wakeups = __atomic_load_n(&mux->stats.wakeups,
+							__ATOMIC_RELAXED);
+	stats->reads = __atomic_load_n(&mux->stats.reads, __ATOMIC_RELAXED);
+	stats->bytes = __atomic_load_n(&mux->stats.bytes, __ATOMIC_RELAXED);
+	stats->pauses = __atomic_load_n(&mux->stats.pauses,
+							__ATOMIC_RELAXED);
+
+	return S_OK;
+}
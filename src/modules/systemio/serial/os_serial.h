@@ -34,6 +34,26 @@ artik_error os_serial_change_callback(int fd, enum watch_io io,
 artik_error os_serial_set_received_callback(artik_serial_config *config,
 			artik_serial_callback callback, void *user_data);
 artik_error os_serial_unset_received_callback(artik_serial_config *config);
+artik_error os_serial_set_frame_callback(artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data);
+artik_error os_serial_get_rx_stats(artik_serial_config *config,
+				artik_serial_rx_stats *stats);
+artik_error os_serial_queue_write(artik_serial_config *config,
+			unsigned char *buf, int len,
+			artik_serial_release_callback release, void *user_data);
+artik_error os_serial_set_tx_callback(artik_serial_config *config,
+			artik_serial_tx_callback callback, void *user_data);
+artik_error os_serial_set_tx_limits(artik_serial_config *config,
+			const artik_serial_tx_limits *limits);
+artik_error os_serial_mux_create(void **mux,
+			const artik_serial_mux_config *config);
+artik_error os_serial_mux_destroy(void *mux);
+artik_error os_serial_mux_add_port(void *mux, artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data);
+artik_error os_serial_mux_remove_port(void *mux, artik_serial_config *config);
+artik_error os_serial_mux_get_stats(void *mux, artik_serial_mux_stats *stats);
 
 
 #endif  /* __OS_SERIAL_H__ */
@@ -0,0 +1,42 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__SERIAL_MUX_H__
+#define	__SERIAL_MUX_H__
+
+#include "artik_serial.h"
+
+/*
+ * Ports of a multiplexer, used by linux_serial.c to add the fd of a
+ * SERIAL instance. 'owner' is cleared when the port is removed,
+ * including when the multiplexer is destroyed.
+ */
+
+struct serial_mux;
+struct serial_mux_port;
+
+artik_error serial_mux_attach(struct serial_mux *mux, int fd,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data,
+			struct serial_mux_port **owner);
+void serial_mux_detach(struct serial_mux_port *port);
+struct serial_mux *serial_mux_of(struct serial_mux_port *port);
+void serial_mux_port_stats(struct serial_mux_port *port,
+			artik_serial_rx_stats *stats);
+
+#endif	/* __SERIAL_MUX_H__ */
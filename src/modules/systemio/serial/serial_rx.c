@@ -0,0 +1,361 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "serial_rx.h"
+
+#define SLIP_END	0xc0
+#define SLIP_ESC	0xdb
+#define SLIP_ESC_END	0xdc
+#define SLIP_ESC_ESC	0xdd
+
+artik_error serial_rx_init(struct serial_rx *rx,
+			const artik_serial_framing *framing, void *user_data)
+{
+	int size = framing->buffer_size ? framing->buffer_size :
+						SERIAL_RX_DEFAULT_SIZE;
+	int max_frame = size;
+
+	memset(rx, 0, sizeof(*rx));
+
+	switch (framing->type) {
+	case ARTIK_SERIAL_FRAME_DELIMITER:
+		if (!framing->delimiter || framing->delimiter_len <= 0 ||
+		    framing->delimiter_len > ARTIK_SERIAL_MAX_DELIMITER)
+			return E_BAD_ARGS;
+		memcpy(rx->delimiter, framing->delimiter,
+						framing->delimiter_len);
+		break;
+	case ARTIK_SERIAL_FRAME_LENGTH:
+		if (framing->length_size != 1 && framing->length_size != 2 &&
+		    framing->length_size != 4)
+			return E_BAD_ARGS;
+		/* The length field has to fit in the buffer too */
+		max_frame = size - framing->length_size;
+		break;
+	case ARTIK_SERIAL_FRAME_IDLE:
+		if (!framing->idle_us)
+			return E_BAD_ARGS;
+		break;
+	case ARTIK_SERIAL_FRAME_CUSTOM:
+		if (!framing->framer)
+			return E_BAD_ARGS;
+		break;
+	case ARTIK_SERIAL_FRAME_NONE:
+	case ARTIK_SERIAL_FRAME_SLIP:
+	case ARTIK_SERIAL_FRAME_COBS:
+		break;
+	default:
+		return E_BAD_ARGS;
+	}
+
+	if (size <= 0 || framing->max_frame < 0 ||
+	    framing->max_frame > max_frame)
+		return E_BAD_ARGS;
+
+	/* One more byte for the NUL added by serial_rx_flush */
+	rx->buf = malloc(size + 1);
+	if (!rx->buf)
+		return E_NO_MEM;
+
+	rx->framing = *framing;
+	rx->framing.delimiter = rx->delimiter;
+	rx->framing.buffer_size = size;
+	if (framing->max_frame)
+		rx->framing.max_frame = framing->max_frame;
+	else
+		rx->framing.max_frame = max_frame;
+	rx->user_data = user_data;
+	rx->size = size;
+
+	return S_OK;
+}
+
+void serial_rx_cleanup(struct serial_rx *rx)
+{
+	free(rx->buf);
+	rx->buf = NULL;
+}
+
+unsigned char *serial_rx_space(struct serial_rx *rx, int *len)
+{
+	if (rx->end == rx->size && rx->start > 0) {
+		memmove(rx->buf, rx->buf + rx->start, rx->end - rx->start);
+		rx->end -= rx->start;
+		rx->start = 0;
+	}
+
+	if (rx->end == rx->size) {
+		rx->stats.overruns += rx->size;
+		rx->start = 0;
+		rx->end = 0;
+		rx->scan = 0;
+		rx->resync = true;
+	}
+
+	*len = rx->size - rx->end;
+
+	return rx->buf + rx->end;
+}
+
+void serial_rx_commit(struct serial_rx *rx, int len)
+{
+	rx->end += len;
+	rx->stats.bytes += len;
+}
+
+/*
+ * The functions below look for the first frame of 'data'. They return
+ * the number of bytes it uses, or 0 if it is not complete, and set
+ * 'payload' and 'len' to the content of the frame. 'len' is -1 for an
+ * invalid frame.
+ */
+
+static int find_delimiter(struct serial_rx *rx, unsigned char *data,
+			int avail, unsigned char **payload, int *len)
+{
+	int dlen = rx->framing.delimiter_len;
+	int last = avail - dlen;
+	int i = rx->scan;
+
+	while (i <= last) {
+		unsigned char *p = memchr(data + i, rx->delimiter[0],
+								last + 1 - i);
+
+		if (!p)
+			break;
+
+		i = p - data;
+		if (!memcmp(p, rx->delimiter, dlen)) {
+			*payload = data;
+			*len = i;
+			return i + dlen;
+		}
+		i++;
+	}
+
+	rx->scan = last + 1 > 0 ? last + 1 : 0;
+
+	return 0;
+}
+
+static int find_length(struct serial_rx *rx, unsigned char *data, int avail,
+			unsigned char **payload, int *len)
+{
+	int size = rx->framing.length_size;
+	unsigned long n = 0;
+	int i;
+
+	if (avail < size)
+		return 0;
+
+	for (i = 0; i < size; i++) {
+		if (rx->framing.length_big_endian)
+			n = (n << 8) | data[i];
+		else
+			n |= (unsigned long)data[i] << (8 * i);
+	}
+
+	/* There is no way to find the next frame, drop everything */
+	if (n > (unsigned long)rx->framing.max_frame) {
+		*len = -1;
+		return avail;
+	}
+
+	if ((unsigned long)(avail - size) < n)
+		return 0;
+
+	*payload = data + size;
+	*len = n;
+
+	return size + n;
+}
+
+static int slip_decode(unsigned char *data, int len)
+{
+	int i, o = 0;
+
+	for (i = 0; i < len; i++) {
+		unsigned char c = data[i];
+
+		if (c == SLIP_ESC) {
+			if (++i == len)
+				return -1;
+			if (data[i] == SLIP_ESC_END)
+				c = SLIP_END;
+			else if (data[i] == SLIP_ESC_ESC)
+				c = SLIP_ESC;
+			else
+				return -1;
+		}
+		data[o++] = c;
+	}
+
+	return o;
+}
+
+/* Decoding never writes past the byte being read, so it is done in place */
+static int cobs_decode(unsigned char *data, int len)
+{
+	int i = 0, o = 0;
+
+	while (i < len) {
+		int code = data[i++];
+
+		if (!code || i + code - 1 > len)
+			return -1;
+
+		memmove(data + o, data + i, code - 1);
+		o += code - 1;
+		i += code - 1;
+
+		if (code < 0xff && i < len)
+			data[o++] = 0;
+	}
+
+	return o;
+}
+
+static int find_encoded(struct serial_rx *rx, unsigned char *data, int avail,
+			unsigned char **payload, int *len)
+{
+	bool slip = rx->framing.type == ARTIK_SERIAL_FRAME_SLIP;
+	unsigned char *end = memchr(data + rx->scan, slip ? SLIP_END : 0,
+							avail - rx->scan);
+
+	if (!end) {
+		rx->scan = avail;
+		return 0;
+	}
+
+	*payload = data;
+	*len = slip ? slip_decode(data, end - data) :
+					cobs_decode(data, end - data);
+
+	return end - data + 1;
+}
+
+static int find_custom(struct serial_rx *rx, unsigned char *data, int avail,
+			unsigned char **payload, int *len)
+{
+	int ret = rx->framing.framer(rx->user_data, data, avail);
+
+	if (ret < 0) {
+		*len = -1;
+		return -ret < avail ? -ret : avail;
+	}
+
+	if (ret > avail)
+		return 0;
+
+	*payload = data;
+	*len = ret;
+
+	return ret;
+}
+
+int serial_rx_next(struct serial_rx *rx, unsigned char **frame)
+{
+	for (;;) {
+		unsigned char *data = rx->buf + rx->start;
+		int avail = rx->end - rx->start;
+		unsigned char *payload = NULL;
+		int used, len = 0;
+
+		if (!avail) {
+			rx->start = 0;
+			rx->end = 0;
+			rx->scan = 0;
+			return -1;
+		}
+
+		switch (rx->framing.type) {
+		case ARTIK_SERIAL_FRAME_DELIMITER:
+			used = find_delimiter(rx, data, avail, &payload, &len);
+			break;
+		case ARTIK_SERIAL_FRAME_LENGTH:
+			used = find_length(rx, data, avail, &payload, &len);
+			break;
+		case ARTIK_SERIAL_FRAME_SLIP:
+		case ARTIK_SERIAL_FRAME_COBS:
+			used = find_encoded(rx, data, avail, &payload, &len);
+			break;
+		case ARTIK_SERIAL_FRAME_CUSTOM:
+			used = find_custom(rx, data, avail, &payload, &len);
+			break;
+		default:
+			return -1;
+		}
+
+		if (!used)
+			return -1;
+
+		rx->start += used;
+		rx->scan = 0;
+
+		/* End of a frame whose start was dropped */
+		if (rx->resync) {
+			rx->resync = false;
+			continue;
+		}
+
+		if (len < 0 || len > rx->framing.max_frame) {
+			rx->stats.bad_frames++;
+			continue;
+		}
+
+		/* Nothing between two delimiters */
+		if (!len)
+			continue;
+
+		rx->stats.frames++;
+		*frame = payload;
+
+		return len;
+	}
+}
+
+int serial_rx_flush(struct serial_rx *rx, unsigned char **frame)
+{
+	int len = rx->end - rx->start;
+	bool resync = rx->resync;
+
+	if (!len)
+		return -1;
+
+	*frame = rx->buf + rx->start;
+	rx->buf[rx->end] = '\0';
+	rx->start = 0;
+	rx->end = 0;
+	rx->scan = 0;
+	rx->resync = false;
+
+	if (resync)
+		return -1;
+
+	if (len > rx->framing.max_frame) {
+		rx->stats.bad_frames++;
+		return -1;
+	}
+
+	rx->stats.frames++;
+
+	return len;
+}
@@ -0,0 +1,78 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__SERIAL_RX_H__
+#define	__SERIAL_RX_H__
+
+#include <stdbool.h>
+
+#include "artik_serial.h"
+
+/*
+ * Receive buffer of a serial port, cutting the bytes read into frames.
+ *
+ * Bytes are read into the space returned by serial_rx_space and added with
+ * serial_rx_commit, then complete frames are taken with serial_rx_next.
+ * Frames are decoded in place, so they stay contiguous and are only
+ * valid until the next call to serial_rx_space.
+ */
+
+#define SERIAL_RX_DEFAULT_SIZE	4096
+
+struct serial_rx {
+	artik_serial_framing	framing;
+	unsigned char	delimiter[ARTIK_SERIAL_MAX_DELIMITER];
+	void	*user_data;
+	/* Bytes between 'start' and 'end' are not consumed yet */
+	unsigned char	*buf;
+	int	size;
+	int	start;
+	int	end;
+	/* Bytes after 'start' known not to end a frame */
+	int	scan;
+	/* The start of the current frame was dropped */
+	bool	resync;
+	artik_serial_rx_stats	stats;
+};
+
+/* Returns S_OK, or E_BAD_ARGS if the framing is not valid */
+artik_error serial_rx_init(struct serial_rx *rx,
+			const artik_serial_framing *framing, void *user_data);
+void serial_rx_cleanup(struct serial_rx *rx);
+
+/*
+ * Space available for reading, making room if needed. A full buffer
+ * without a complete frame is dropped and counted as overrun.
+ */
+unsigned char *serial_rx_space(struct serial_rx *rx, int *len);
+void serial_rx_commit(struct serial_rx *rx, int len);
+
+/*
+ * Take the next complete frame. Returns its length, or -1 if there is
+ * none. Frames that are too long or malformed are dropped and counted.
+ */
+int serial_rx_next(struct serial_rx *rx, unsigned char **frame);
+
+/*
+ * Take all the bytes buffered as one frame, NUL terminated. Used when
+ * the line goes idle and when no framing is used. Returns -1 if the
+ * buffer is empty.
+ */
+int serial_rx_flush(struct serial_rx *rx, unsigned char **frame);
+
+#endif	/* __SERIAL_RX_H__ */
@@ -0,0 +1,145 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "serial_tx.h"
+
+artik_error serial_tx_init(struct serial_tx *tx,
+			const artik_serial_tx_limits *limits)
+{
+	memset(tx, 0, sizeof(*tx));
+
+	if (limits->max_buffers < 0 || limits->max_bytes < 0)
+		return E_BAD_ARGS;
+
+	tx->max_buffers = limits->max_buffers ? limits->max_buffers :
+						SERIAL_TX_DEFAULT_BUFFERS;
+	tx->max_bytes = limits->max_bytes ? limits->max_bytes :
+						SERIAL_TX_DEFAULT_BYTES;
+	tx->queue = malloc(tx->max_buffers * sizeof(struct serial_tx_buffer));
+	if (!tx->queue)
+		return E_NO_MEM;
+
+	return S_OK;
+}
+
+void serial_tx_cleanup(struct serial_tx *tx)
+{
+	free(tx->queue);
+	tx->queue = NULL;
+}
+
+artik_error serial_tx_push(struct serial_tx *tx, unsigned char *buf, int len,
+			artik_serial_release_callback release, void *user_data)
+{
+	struct serial_tx_buffer *buffer;
+
+	/* A buffer larger than the limit is accepted in an empty queue */
+	if (tx->count == tx->max_buffers ||
+	    (tx->count && len > tx->max_bytes - tx->pending)) {
+		tx->blocked = true;
+		return E_TRY_AGAIN;
+	}
+
+	buffer = &tx->queue[(tx->head + tx->count) % tx->max_buffers];
+	buffer->buf = buf;
+	buffer->len = len;
+	buffer->release = release;
+	buffer->user_data = user_data;
+	tx->count++;
+	tx->pending += len;
+
+	return S_OK;
+}
+
+int serial_tx_iov(struct serial_tx *tx, struct iovec *iov, int max)
+{
+	int i, n = tx->count - tx->written;
+
+	if (n > max)
+		n = max;
+
+	for (i = 0; i < n; i++) {
+		struct serial_tx_buffer *buffer = &tx->queue[
+			(tx->head + tx->written + i) % tx->max_buffers];
+
+		iov[i].iov_base = buffer->buf;
+		iov[i].iov_len = buffer->len;
+	}
+
+	if (n) {
+		iov[0].iov_base = (unsigned char *)iov[0].iov_base +
+								tx->offset;
+		iov[0].iov_len -= tx->offset;
+	}
+
+	return n;
+}
+
+void serial_tx_advance(struct serial_tx *tx, int len)
+{
+	tx->pending -= len;
+
+	while (len > 0) {
+		struct serial_tx_buffer *buffer = &tx->queue[
+			(tx->head + tx->written) % tx->max_buffers];
+		int left = buffer->len - tx->offset;
+
+		if (len < left) {
+			tx->offset += len;
+			break;
+		}
+
+		len -= left;
+		tx->offset = 0;
+		tx->written++;
+	}
+}
+
+bool serial_tx_pop(struct serial_tx *tx, bool all,
+			struct serial_tx_buffer *buffer)
+{
+	if (!tx->count || (!all && !tx->written))
+		return false;
+
+	*buffer = tx->queue[tx->head];
+	tx->head = (tx->head + 1) % tx->max_buffers;
+	tx->count--;
+
+	if (tx->written) {
+		tx->written--;
+	} else {
+		tx->pending -= buffer->len - tx->offset;
+		tx->offset = 0;
+	}
+
+	return true;
+}
+
+bool serial_tx_unblocked(struct serial_tx *tx)
+{
+	if (!tx->blocked || tx->count > tx->max_buffers / 2 ||
+	    tx->pending > tx->max_bytes / 2)
+		return false;
+
+	tx->blocked = false;
+
+	return true;
+}
@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__SERIAL_TX_H__
+#define	__SERIAL_TX_H__
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "artik_serial.h"
+
+/*
+ * Transmit queue of a serial port, holding the buffers of the caller.
+ *
+ * Buffers added with serial_tx_push are described by serial_tx_iov
+ * for writev, and serial_tx_advance accounts for the bytes written.
+ * Buffers fully written are then taken back with serial_tx_pop to
+ * call their release callback.
+ */
+
+#define SERIAL_TX_DEFAULT_BUFFERS	64
+#define SERIAL_TX_DEFAULT_BYTES		65536
+
+struct serial_tx_buffer {
+	unsigned char	*buf;
+	int	len;
+	artik_serial_release_callback	release;
+	void	*user_data;
+};
+
+struct serial_tx {
+	/* Ring of 'max_buffers' entries, 'count' of them from 'head' */
+	struct serial_tx_buffer	*queue;
+	int	max_buffers;
+	int	max_bytes;
+	int	head;
+	int	count;
+	/* Buffers at the head already written */
+	int	written;
+	/* Bytes written of the first buffer not fully written */
+	int	offset;
+	/* Bytes not written yet */
+	int	pending;
+	/* A buffer was refused since the queue was last below the limits */
+	bool	blocked;
+};
+
+artik_error serial_tx_init(struct serial_tx *tx,
+			const artik_serial_tx_limits *limits);
+void serial_tx_cleanup(struct serial_tx *tx);
+
+/* Returns E_TRY_AGAIN and sets 'blocked' if the queue is full */
+artik_error serial_tx_push(struct serial_tx *tx, unsigned char *buf, int len,
+			artik_serial_release_callback release, void *user_data);
+
+/* Fill up to 'max' entries of 'iov' with the bytes not written yet */
+int serial_tx_iov(struct serial_tx *tx, struct iovec *iov, int max);
+void serial_tx_advance(struct serial_tx *tx, int len);
+
+/*
+ * Take the first buffer of the queue, only if fully written unless
+ * 'all' is set. Returns false if there is none.
+ */
+bool serial_tx_pop(struct serial_tx *tx, bool all,
+			struct serial_tx_buffer *buffer);
+
+/*
+ * Whether a refused buffer would now fit with room to spare. Clears
+ * 'blocked' when returning true.
+ */
+bool serial_tx_unblocked(struct serial_tx *tx);
+
+#endif	/* __SERIAL_TX_H__ */
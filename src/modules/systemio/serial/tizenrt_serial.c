@@ -213,3 +213,63 @@ artik_error os_serial_unset_received_callback(artik_serial_config *config)
 {
 	return E_NOT_SUPPORTED;
 }
+
+artik_error os_serial_set_frame_callback(artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_get_rx_stats(artik_serial_config *config,
+				artik_serial_rx_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_queue_write(artik_serial_config *config,
+			unsigned char *buf, int len,
+			artik_serial_release_callback release, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_set_tx_callback(artik_serial_config *config,
+			artik_serial_tx_callback callback, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_set_tx_limits(artik_serial_config *config,
+			const artik_serial_tx_limits *limits)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_mux_create(void **mux,
+			const artik_serial_mux_config *config)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_mux_destroy(void *mux)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_mux_add_port(void *mux, artik_serial_config *config,
+			const artik_serial_framing *framing,
+			artik_serial_frame_callback callback, void *user_data)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_mux_remove_port(void *mux, artik_serial_config *config)
+{
+	return E_NOT_SUPPORTED;
+}
+
+artik_error os_serial_mux_get_stats(void *mux, artik_serial_mux_stats *stats)
+{
+	return E_NOT_SUPPORTED;
+}
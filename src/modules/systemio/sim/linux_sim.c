@@ -0,0 +1,943 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+/* Largest SPI chip select cycle handled without allocating */
+#define SIM_FRAME_MAX	256
+
+struct sim_gpio {
+	struct sim_gpio *next;
+	artik_gpio_id id;
+	int value;
+	artik_gpio_edge_t edge;
+	/* Edges are written to pipe[1] while the GPIO is watched */
+	int pipe[2];
+};
+
+struct sim_adc {
+	struct sim_adc *next;
+	int pin_num;
+	int count;
+	int index;
+	int values[];
+};
+
+/*
+ * Hooks are called with the lock held and may use the functions of
+ * artik_sim.h, hence the recursive mutex.
+ */
+static pthread_mutex_t sim_lock;
+static pthread_once_t sim_once = PTHREAD_ONCE_INIT;
+static struct artik_sim_device *sim_devices;
+static struct sim_gpio *sim_gpios;
+static struct sim_adc *sim_adcs;
+
+static void sim_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&sim_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static void sim_lock_all(void)
+{
+	pthread_once(&sim_once, sim_init);
+	pthread_mutex_lock(&sim_lock);
+}
+
+static void sim_unlock_all(void)
+{
+	pthread_mutex_unlock(&sim_lock);
+}
+
+static const struct sim_model *sim_models[] = {
+	[ARTIK_SIM_REGISTERS] = &sim_registers_model,
+	[ARTIK_SIM_HTS221] = &sim_hts221_model,
+	[ARTIK_SIM_K6DS3] = &sim_k6ds3_model,
+	[ARTIK_SIM_LPS25HBTR] = &sim_lps25hbtr_model,
+};
+
+static struct artik_sim_device *find_device(artik_sim_bus_t bus_type,
+				unsigned int bus, unsigned int address)
+{
+	struct artik_sim_device *dev;
+
+	for (dev = sim_devices; dev; dev = dev->next)
+		if (dev->bus_type == bus_type && dev->bus == bus &&
+		    dev->address == address)
+			return dev;
+
+	return NULL;
+}
+
+static bool valid_device(struct artik_sim_device *device)
+{
+	struct artik_sim_device *dev;
+
+	for (dev = sim_devices; dev; dev = dev->next)
+		if (dev == device)
+			return true;
+
+	return false;
+}
+
+/* Time the bus would have been busy, waited once the lock is released */
+static void add_latency(struct artik_sim_device *dev, int bytes,
+			unsigned long long *delay_ns)
+{
+	*delay_ns += dev->latency.transaction_us * 1000ULL +
+			(unsigned long long)bytes * dev->latency.byte_ns;
+}
+
+static void wait_latency(unsigned long long delay_ns)
+{
+	struct timespec ts;
+
+	if (!delay_ns)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	delay_ns += ts.tv_nsec;
+	ts.tv_sec += delay_ns / 1000000000ULL;
+	ts.tv_nsec = delay_ns % 1000000000ULL;
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+									EINTR)
+		;
+}
+
+/*
+ * Counts a transaction on the device. Returns the error to report if a
+ * fault is injected in it, and sets 'corrupt' to the bits to flip in the
+ * data read.
+ */
+static artik_error start_transaction(struct artik_sim_device *dev,
+				unsigned char *corrupt)
+{
+	artik_sim_faults *faults = &dev->faults;
+	unsigned int n = dev->transactions++;
+
+	*corrupt = 0;
+	dev->stats.transactions++;
+
+	if (!faults->period || n < faults->skip ||
+	    (n - faults->skip) % faults->period ||
+	    (faults->count && dev->injected >= faults->count))
+		return S_OK;
+
+	dev->injected++;
+	dev->stats.faults++;
+
+	if (faults->corrupt_mask) {
+		*corrupt = faults->corrupt_mask;
+		return S_OK;
+	}
+
+	return faults->error != S_OK ? faults->error : E_ACCESS_DENIED;
+}
+
+static unsigned int next_reg(struct artik_sim_device *dev, unsigned int reg)
+{
+	if (dev->model->next)
+		return dev->model->next(dev, reg);
+
+	return (reg + 1) % SIM_NUM_REGS;
+}
+
+static void load_sequences(struct artik_sim_device *dev, unsigned int reg)
+{
+	struct sim_sequence *seq;
+
+	for (seq = dev->sequences; seq; seq = seq->next) {
+		if (seq->reg != reg)
+			continue;
+
+		memcpy(&dev->regs[reg], &seq->values[seq->index * seq->len],
+								seq->len);
+		seq->index = (seq->index + 1) % seq->count;
+	}
+}
+
+/*
+ * Reads 'len' registers into 'rd' or writes them from 'wr', starting at
+ * 'reg' which is stripped from the auto increment flag on I2C.
+ */
+static artik_error access_regs(struct artik_sim_device *dev,
+			unsigned int reg, unsigned char *rd,
+			const unsigned char *wr, int len, unsigned char corrupt)
+{
+	const struct sim_model *model = dev->model;
+	bool inc = true;
+	int i;
+
+	if (dev->bus_type == ARTIK_SIM_I2C && model->auto_inc) {
+		inc = reg & model->auto_inc;
+		reg &= ~model->auto_inc;
+	}
+
+	if (reg >= SIM_NUM_REGS)
+		return E_BAD_ARGS;
+
+	if (rd) {
+		load_sequences(dev, reg);
+		if (dev->hook)
+			dev->hook(dev->hook_data, dev, reg, len, false);
+	}
+
+	dev->pointer = reg;
+	for (i = 0; i < len; i++) {
+		if (rd) {
+			rd[i] = model->read ? model->read(dev, dev->pointer) :
+						dev->regs[dev->pointer];
+			rd[i] ^= corrupt;
+		} else if (model->write) {
+			model->write(dev, dev->pointer, wr[i]);
+		} else {
+			dev->regs[dev->pointer] = wr[i];
+		}
+
+		if (inc)
+			dev->pointer = next_reg(dev, dev->pointer);
+	}
+
+	if (rd) {
+		dev->stats.bytes_read += len;
+	} else {
+		dev->stats.bytes_written += len;
+		if (dev->hook)
+			dev->hook(dev->hook_data, dev, reg, len, true);
+	}
+
+	return S_OK;
+}
+
+static artik_error i2c_message(struct artik_sim_device *dev,
+			artik_i2c_wordsize_t wordsize, artik_i2c_msg *msg)
+{
+	unsigned char *buf = (unsigned char *)msg->buffer;
+	unsigned char corrupt;
+	unsigned int reg = 0;
+	artik_error ret;
+	int i;
+
+	ret = start_transaction(dev, &corrupt);
+	if (ret != S_OK)
+		return ret;
+
+	switch (msg->type) {
+	case I2C_MSG_READ_REGISTER:
+		return access_regs(dev, msg->reg, buf, NULL, msg->len, corrupt);
+	case I2C_MSG_WRITE_REGISTER:
+		return access_regs(dev, msg->reg, NULL, buf, msg->len, 0);
+	case I2C_MSG_READ:
+		return access_regs(dev, dev->pointer, buf, NULL, msg->len,
+								corrupt);
+	case I2C_MSG_WRITE:
+		/* The register address comes first, in host order */
+		if (msg->len < (int)wordsize)
+			return E_BAD_ARGS;
+		for (i = 0; i < (int)wordsize; i++)
+			reg |= (unsigned int)buf[i] << (8 * i);
+		if (msg->len == (int)wordsize) {
+			dev->pointer = reg & ~dev->model->auto_inc;
+			return reg < SIM_NUM_REGS ? S_OK : E_BAD_ARGS;
+		}
+		return access_regs(dev, reg, NULL, buf + wordsize,
+						msg->len - wordsize, 0);
+	default:
+		return E_BAD_ARGS;
+	}
+}
+
+bool sim_i2c_exists(unsigned int bus, unsigned int address)
+{
+	bool exists;
+
+	sim_lock_all();
+	exists = find_device(ARTIK_SIM_I2C, bus, address) != NULL;
+	sim_unlock_all();
+
+	return exists;
+}
+
+artik_error sim_i2c_transfer(unsigned int bus, artik_i2c_wordsize_t wordsize,
+				artik_i2c_msg *msgs, int count)
+{
+	unsigned long long delay_ns = 0;
+	artik_error ret = S_OK;
+	int i;
+
+	sim_lock_all();
+	for (i = 0; i < count && ret == S_OK; i++) {
+		struct artik_sim_device *dev = find_device(ARTIK_SIM_I2C, bus,
+							msgs[i].address);
+
+		/* Nobody acknowledges the address */
+		if (!dev) {
+			ret = E_ACCESS_DENIED;
+			break;
+		}
+
+		ret = i2c_message(dev, wordsize, &msgs[i]);
+		add_latency(dev, msgs[i].len, &delay_ns);
+	}
+	sim_unlock_all();
+
+	wait_latency(delay_ns);
+
+	return ret;
+}
+
+bool sim_spi_exists(unsigned int bus, unsigned int cs)
+{
+	bool exists;
+
+	sim_lock_all();
+	exists = find_device(ARTIK_SIM_SPI, bus, cs) != NULL;
+	sim_unlock_all();
+
+	return exists;
+}
+
+/* One chip select cycle, the first byte is the address and direction */
+static artik_error spi_frame(struct artik_sim_device *dev,
+			const unsigned char *tx, unsigned char *rx, int len)
+{
+	unsigned char corrupt;
+	artik_error ret;
+
+	ret = start_transaction(dev, &corrupt);
+	if (ret != S_OK)
+		return ret;
+
+	rx[0] = 0;
+	if (len == 1)
+		return S_OK;
+
+	if (tx[0] & 0x80)
+		return access_regs(dev, tx[0] & 0x7f, rx + 1, NULL, len - 1,
+								corrupt);
+
+	memset(rx + 1, 0, len - 1);
+
+	return access_regs(dev, tx[0], NULL, tx + 1, len - 1, 0);
+}
+
+artik_error sim_spi_transfer(unsigned int bus, unsigned int cs,
+				const artik_spi_segment *segments, int count)
+{
+	unsigned char tx_frame[SIM_FRAME_MAX], rx_frame[SIM_FRAME_MAX];
+	unsigned char *tx = tx_frame, *rx = rx_frame;
+	struct artik_sim_device *dev;
+	unsigned long long delay_ns = 0;
+	artik_error ret = S_OK;
+	int first = 0, len = 0;
+	int i, j, pos;
+
+	sim_lock_all();
+	dev = find_device(ARTIK_SIM_SPI, bus, cs);
+	if (!dev) {
+		sim_unlock_all();
+		return E_ACCESS_DENIED;
+	}
+
+	for (i = 0; i < count && ret == S_OK; i++) {
+		len += segments[i].len;
+		delay_ns += segments[i].delay_usecs * 1000ULL;
+
+		/* The chip stays selected until the end of the message */
+		if (i < count - 1 && !segments[i].cs_change)
+			continue;
+
+		if (len > SIM_FRAME_MAX) {
+			tx = malloc(2 * len);
+			if (!tx) {
+				ret = E_NO_MEM;
+				break;
+			}
+			rx = tx + len;
+		}
+
+		for (j = first, pos = 0; j <= i; pos += segments[j].len, j++) {
+			if (segments[j].tx_buf)
+				memcpy(tx + pos, segments[j].tx_buf,
+							segments[j].len);
+			else
+				memset(tx + pos, 0, segments[j].len);
+		}
+
+		ret = spi_frame(dev, tx, rx, len);
+		add_latency(dev, len, &delay_ns);
+
+		for (j = first, pos = 0; j <= i; pos += segments[j].len, j++)
+			if (segments[j].rx_buf)
+				memcpy(segments[j].rx_buf, rx + pos,
+							segments[j].len);
+
+		if (tx != tx_frame) {
+			free(tx);
+			tx = tx_frame;
+			rx = rx_frame;
+		}
+
+		first = i + 1;
+		len = 0;
+	}
+	sim_unlock_all();
+
+	wait_latency(delay_ns);
+
+	return ret;
+}
+
+artik_error artik_sim_add_device(artik_sim_device **device,
+		artik_sim_bus_t bus_type, unsigned int bus,
+		unsigned int address, artik_sim_model_t model)
+{
+	struct artik_sim_device *dev;
+	artik_error ret;
+
+	if (!device || (bus_type != ARTIK_SIM_I2C && bus_type != ARTIK_SIM_SPI)
+	    || (int)model < 0 ||
+	    model >= sizeof(sim_models) / sizeof(sim_models[0]))
+		return E_BAD_ARGS;
+
+	dev = malloc(sizeof(*dev));
+	if (!dev)
+		return E_NO_MEM;
+
+	memset(dev, 0, sizeof(*dev));
+	dev->bus_type = bus_type;
+	dev->bus = bus;
+	dev->address = address;
+	dev->model = sim_models[model];
+
+	sim_lock_all();
+	if (find_device(bus_type, bus, address)) {
+		sim_unlock_all();
+		free(dev);
+		return E_BUSY;
+	}
+
+	if (dev->model->init) {
+		ret = dev->model->init(dev);
+		if (ret != S_OK) {
+			sim_unlock_all();
+			free(dev);
+			return ret;
+		}
+	}
+
+	dev->next = sim_devices;
+	sim_devices = dev;
+	sim_unlock_all();
+
+	*device = dev;
+
+	return S_OK;
+}
+
+artik_error artik_sim_remove_device(artik_sim_device *device)
+{
+	struct artik_sim_device **prev;
+
+	sim_lock_all();
+	for (prev = &sim_devices; *prev; prev = &(*prev)->next)
+		if (*prev == device)
+			break;
+
+	if (!*prev) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	*prev = device->next;
+	sim_unlock_all();
+
+	while (device->sequences) {
+		struct sim_sequence *seq = device->sequences;
+
+		device->sequences = seq->next;
+		free(seq);
+	}
+
+	if (device->model->cleanup)
+		device->model->cleanup(device);
+	free(device);
+
+	return S_OK;
+}
+
+artik_error artik_sim_write_registers(artik_sim_device *device,
+		unsigned int reg, const unsigned char *data, int len)
+{
+	if (!data || len < 0 || reg + len > SIM_NUM_REGS)
+		return E_BAD_ARGS;
+
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	memcpy(&device->regs[reg], data, len);
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_read_registers(artik_sim_device *device,
+		unsigned int reg, unsigned char *data, int len)
+{
+	if (!data || len < 0 || reg + len > SIM_NUM_REGS)
+		return E_BAD_ARGS;
+
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	memcpy(data, &device->regs[reg], len);
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_set_sequence(artik_sim_device *device,
+		unsigned int reg, const unsigned char *values, int len,
+		int count)
+{
+	struct sim_sequence *seq = NULL, **prev;
+
+	if (count < 0 || (count && (!values || len <= 0 ||
+	    reg + len > SIM_NUM_REGS)))
+		return E_BAD_ARGS;
+
+	if (count) {
+		seq = malloc(sizeof(*seq) + len * count);
+		if (!seq)
+			return E_NO_MEM;
+
+		seq->reg = reg;
+		seq->len = len;
+		seq->count = count;
+		seq->index = 0;
+		memcpy(seq->values, values, len * count);
+	}
+
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		free(seq);
+		return E_BAD_ARGS;
+	}
+
+	for (prev = &device->sequences; *prev; prev = &(*prev)->next) {
+		if ((*prev)->reg == reg) {
+			struct sim_sequence *old = *prev;
+
+			*prev = old->next;
+			free(old);
+			break;
+		}
+	}
+
+	if (seq) {
+		seq->next = device->sequences;
+		device->sequences = seq;
+	}
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_set_hook(artik_sim_device *device, artik_sim_hook hook,
+		void *user_data)
+{
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	device->hook = hook;
+	device->hook_data = user_data;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_set_values(artik_sim_device *device,
+		const double *values, int count)
+{
+	artik_error ret = S_OK;
+
+	if (!values || count <= 0)
+		return E_BAD_ARGS;
+
+	sim_lock_all();
+	if (!valid_device(device))
+		ret = E_BAD_ARGS;
+	else if (!device->model->set_values)
+		ret = E_NOT_SUPPORTED;
+	else if (count > device->model->num_values)
+		ret = E_BAD_ARGS;
+	else
+		device->model->set_values(device, values, count);
+	sim_unlock_all();
+
+	return ret;
+}
+
+artik_error artik_sim_set_latency(artik_sim_device *device,
+		const artik_sim_latency *latency)
+{
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	if (latency)
+		device->latency = *latency;
+	else
+		memset(&device->latency, 0, sizeof(device->latency));
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_set_faults(artik_sim_device *device,
+		const artik_sim_faults *faults)
+{
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	if (faults)
+		device->faults = *faults;
+	else
+		memset(&device->faults, 0, sizeof(device->faults));
+	device->transactions = 0;
+	device->injected = 0;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_get_stats(artik_sim_device *device,
+		artik_sim_stats *stats)
+{
+	if (!stats)
+		return E_BAD_ARGS;
+
+	sim_lock_all();
+	if (!valid_device(device)) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	*stats = device->stats;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+static struct sim_gpio *find_gpio(artik_gpio_id id)
+{
+	struct sim_gpio *gpio;
+
+	for (gpio = sim_gpios; gpio; gpio = gpio->next)
+		if (gpio->id == id)
+			return gpio;
+
+	return NULL;
+}
+
+static void close_pipe(struct sim_gpio *gpio)
+{
+	if (gpio->pipe[0] >= 0) {
+		close(gpio->pipe[0]);
+		close(gpio->pipe[1]);
+	}
+	gpio->pipe[0] = -1;
+	gpio->pipe[1] = -1;
+}
+
+artik_error artik_sim_add_gpio(artik_gpio_id id, int value)
+{
+	struct sim_gpio *gpio = malloc(sizeof(*gpio));
+
+	if (!gpio)
+		return E_NO_MEM;
+
+	gpio->id = id;
+	gpio->value = value ? 1 : 0;
+	gpio->edge = GPIO_EDGE_NONE;
+	gpio->pipe[0] = -1;
+	gpio->pipe[1] = -1;
+
+	sim_lock_all();
+	if (find_gpio(id)) {
+		sim_unlock_all();
+		free(gpio);
+		return E_BUSY;
+	}
+
+	gpio->next = sim_gpios;
+	sim_gpios = gpio;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_remove_gpio(artik_gpio_id id)
+{
+	struct sim_gpio **prev, *gpio;
+
+	sim_lock_all();
+	for (prev = &sim_gpios; *prev; prev = &(*prev)->next)
+		if ((*prev)->id == id)
+			break;
+
+	gpio = *prev;
+	if (!gpio) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	/* The loop still watches the read end of the edge pipe */
+	if (gpio->pipe[0] >= 0) {
+		sim_unlock_all();
+		return E_BUSY;
+	}
+
+	*prev = gpio->next;
+	sim_unlock_all();
+
+	free(gpio);
+
+	return S_OK;
+}
+
+artik_error artik_sim_set_gpio(artik_gpio_id id, int value)
+{
+	struct sim_gpio *gpio;
+	unsigned char level = value ? 1 : 0;
+
+	sim_lock_all();
+	gpio = find_gpio(id);
+	if (!gpio) {
+		sim_unlock_all();
+		return E_BAD_ARGS;
+	}
+
+	if (gpio->value != level && gpio->pipe[1] >= 0 &&
+	    (gpio->edge == GPIO_EDGE_NONE || gpio->edge == GPIO_EDGE_BOTH ||
+	     (gpio->edge == GPIO_EDGE_RISING) == (level == 1))) {
+		/* Edges are dropped if the loop does not keep up */
+		if (write(gpio->pipe[1], &level, 1) < 0 && errno != EAGAIN) {
+			sim_unlock_all();
+			return E_ACCESS_DENIED;
+		}
+	}
+
+	gpio->value = level;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_get_gpio(artik_gpio_id id, int *value)
+{
+	struct sim_gpio *gpio;
+
+	if (!value)
+		return E_BAD_ARGS;
+
+	sim_lock_all();
+	gpio = find_gpio(id);
+	if (gpio)
+		*value = gpio->value;
+	sim_unlock_all();
+
+	return gpio ? S_OK : E_BAD_ARGS;
+}
+
+bool sim_gpio_exists(artik_gpio_id id)
+{
+	bool exists;
+
+	sim_lock_all();
+	exists = find_gpio(id) != NULL;
+	sim_unlock_all();
+
+	return exists;
+}
+
+int sim_gpio_read(artik_gpio_id id)
+{
+	int value = -1;
+
+	artik_sim_get_gpio(id, &value);
+
+	return value;
+}
+
+artik_error sim_gpio_write(artik_gpio_id id, int value)
+{
+	struct sim_gpio *gpio;
+
+	sim_lock_all();
+	gpio = find_gpio(id);
+	if (gpio)
+		gpio->value = value ? 1 : 0;
+	sim_unlock_all();
+
+	return gpio ? S_OK : E_BUSY;
+}
+
+int sim_gpio_watch(artik_gpio_id id, artik_gpio_edge_t edge)
+{
+	struct sim_gpio *gpio;
+	int fd = -1;
+
+	sim_lock_all();
+	gpio = find_gpio(id);
+	if (gpio && gpio->pipe[0] < 0 && pipe(gpio->pipe) == 0) {
+		fcntl(gpio->pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(gpio->pipe[1], F_SETFL, O_NONBLOCK);
+		gpio->edge = edge;
+		fd = gpio->pipe[0];
+	}
+	sim_unlock_all();
+
+	return fd;
+}
+
+void sim_gpio_unwatch(artik_gpio_id id)
+{
+	struct sim_gpio *gpio;
+
+	sim_lock_all();
+	gpio = find_gpio(id);
+	if (gpio)
+		close_pipe(gpio);
+	sim_unlock_all();
+}
+
+static struct sim_adc *find_adc(int pin_num)
+{
+	struct sim_adc *adc;
+
+	for (adc = sim_adcs; adc; adc = adc->next)
+		if (adc->pin_num == pin_num)
+			return adc;
+
+	return NULL;
+}
+
+artik_error artik_sim_add_adc(int pin_num, const int *values, int count)
+{
+	struct sim_adc *adc;
+
+	if (!values || count <= 0)
+		return E_BAD_ARGS;
+
+	adc = malloc(sizeof(*adc) + count * sizeof(int));
+	if (!adc)
+		return E_NO_MEM;
+
+	adc->pin_num = pin_num;
+	adc->count = count;
+	adc->index = 0;
+	memcpy(adc->values, values, count * sizeof(int));
+
+	sim_lock_all();
+	if (find_adc(pin_num)) {
+		sim_unlock_all();
+		free(adc);
+		return E_BUSY;
+	}
+
+	adc->next = sim_adcs;
+	sim_adcs = adc;
+	sim_unlock_all();
+
+	return S_OK;
+}
+
+artik_error artik_sim_remove_adc(int pin_num)
+{
+	struct sim_adc **prev, *adc;
+
+	sim_lock_all();
+	for (prev = &sim_adcs; *prev; prev = &(*prev)->next)
+		if ((*prev)->pin_num == pin_num)
+			break;
+
+	adc = *prev;
+	if (adc)
+		*prev = adc->next;
+	sim_unlock_all();
+
+	free(adc);
+
+	return adc ? S_OK : E_BAD_ARGS;
+}
+
+bool sim_adc_exists(int pin_num)
+{
+	bool exists;
+
+	sim_lock_all();
+	exists = find_adc(pin_num) != NULL;
+	sim_unlock_all();
+
+	return exists;
+}
+
+artik_error sim_adc_read(int pin_num, int *value)
+{
+	struct sim_adc *adc;
+
+	sim_lock_all();
+	adc = find_adc(pin_num);
+	if (adc) {
+		*value = adc->values[adc->index];
+		adc->index = (adc->index + 1) % adc->count;
+	}
+	sim_unlock_all();
+
+	return adc ? S_OK : E_BUSY;
+}
@@ -0,0 +1,112 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#ifndef	__SIM_H__
+#define	__SIM_H__
+
+#include <stdbool.h>
+
+#include "artik_i2c.h"
+#include "artik_spi.h"
+#include "artik_gpio.h"
+#include "artik_sim.h"
+
+/*
+ * Simulated devices, see artik_sim.h. The Linux backends of the I2C, SPI,
+ * GPIO and ADC modules check at request time whether what is requested
+ * is simulated, and then forward the accesses to the functions below
+ * instead of the kernel.
+ */
+
+#define SIM_NUM_REGS	256
+
+struct sim_sequence {
+	struct sim_sequence *next;
+	unsigned int reg;
+	int len;
+	int count;
+	int index;
+	unsigned char values[];
+};
+
+struct sim_model {
+	/* Bit of the register address asking for auto increment, 0 if any
+	 * access is auto incremented
+	 */
+	unsigned int auto_inc;
+	int num_values;
+	/* Set the registers of the chip after reset, and the model state */
+	artik_error (*init)(struct artik_sim_device *dev);
+	void (*cleanup)(struct artik_sim_device *dev);
+	void (*set_values)(struct artik_sim_device *dev, const double *values,
+				int count);
+	/* Registers with side effects, the register array is used if NULL */
+	unsigned char (*read)(struct artik_sim_device *dev, unsigned int reg);
+	void (*write)(struct artik_sim_device *dev, unsigned int reg,
+				unsigned char value);
+	/* Register following 'reg' when auto incrementing */
+	unsigned int (*next)(struct artik_sim_device *dev, unsigned int reg);
+};
+
+struct artik_sim_device {
+	struct artik_sim_device *next;
+	artik_sim_bus_t bus_type;
+	unsigned int bus;
+	unsigned int address;
+	const struct sim_model *model;
+	void *state;
+	unsigned char regs[SIM_NUM_REGS];
+	/* Register accessed by I2C reads and writes without address */
+	unsigned int pointer;
+	struct sim_sequence *sequences;
+	artik_sim_hook hook;
+	void *hook_data;
+	artik_sim_latency latency;
+	artik_sim_faults faults;
+	unsigned int transactions;
+	unsigned int injected;
+	artik_sim_stats stats;
+};
+
+extern const struct sim_model sim_registers_model;
+extern const struct sim_model sim_hts221_model;
+extern const struct sim_model sim_k6ds3_model;
+extern const struct sim_model sim_lps25hbtr_model;
+
+bool sim_i2c_exists(unsigned int bus, unsigned int address);
+artik_error sim_i2c_transfer(unsigned int bus, artik_i2c_wordsize_t wordsize,
+				artik_i2c_msg *msgs, int count);
+
+bool sim_spi_exists(unsigned int bus, unsigned int cs);
+artik_error sim_spi_transfer(unsigned int bus, unsigned int cs,
+				const artik_spi_segment *segments, int count);
+
+bool sim_gpio_exists(artik_gpio_id id);
+int sim_gpio_read(artik_gpio_id id);
+artik_error sim_gpio_write(artik_gpio_id id, int value);
+/*
+ * Returns a file descriptor delivering one byte, the new level, for each
+ * edge matching 'edge', or -1. Closed by sim_gpio_unwatch.
+ */
+int sim_gpio_watch(artik_gpio_id id, artik_gpio_edge_t edge);
+void sim_gpio_unwatch(artik_gpio_id id);
+
+bool sim_adc_exists(int pin_num);
+artik_error sim_adc_read(int pin_num, int *value);
+
+#endif	/* __SIM_H__ */
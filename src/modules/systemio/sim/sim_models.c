@@ -0,0 +1,338 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+
+/*
+ * Register maps of the chips driven by the sensor module. Only what the
+ * drivers use is modeled: the identification, the calibration and the
+ * output registers, and the FIFO of the K6DS3.
+ */
+
+#define ST_AUTO_INC		0x80
+#define ST_REG_WHO_AM_I		0x0F
+
+static void put16(struct artik_sim_device *dev, unsigned int reg, int value)
+{
+	if (value > 32767)
+		value = 32767;
+	else if (value < -32768)
+		value = -32768;
+
+	dev->regs[reg] = value & 0xff;
+	dev->regs[reg + 1] = (value >> 8) & 0xff;
+}
+
+const struct sim_model sim_registers_model = {
+	.auto_inc = 0,
+};
+
+/*
+ * HTS221: calibrated for 20 %rH and 10 degC at output 0, 80 %rH at
+ * 15360 and 30 degC at 2560, so that the slopes are exact in binary.
+ */
+#define HTS221_DEVICE_ID	0xBC
+#define HTS221_REG_STATUS	0x27
+#define HTS221_REG_H_OUT	0x28
+#define HTS221_REG_T_OUT	0x2A
+#define HTS221_REG_CALIB	0x30
+
+static void hts221_set_values(struct artik_sim_device *dev,
+				const double *values, int count)
+{
+	put16(dev, HTS221_REG_H_OUT, (int)((2 * values[0] - 40) * 128));
+	if (count > 1)
+		put16(dev, HTS221_REG_T_OUT,
+					(int)((8 * values[1] - 80) * 16));
+}
+
+static artik_error hts221_init(struct artik_sim_device *dev)
+{
+	static const unsigned char calib[16] = {
+		40, 160, 80, 240, 0, 0, 0, 0,
+		0, 0, 15360 & 0xff, 15360 >> 8, 0, 0, 2560 & 0xff, 2560 >> 8
+	};
+	const double values[] = { 50.0, 20.0 };
+
+	dev->regs[ST_REG_WHO_AM_I] = HTS221_DEVICE_ID;
+	dev->regs[HTS221_REG_STATUS] = 0x03;
+	memcpy(&dev->regs[HTS221_REG_CALIB], calib, sizeof(calib));
+	hts221_set_values(dev, values, 2);
+
+	return S_OK;
+}
+
+const struct sim_model sim_hts221_model = {
+	.auto_inc = ST_AUTO_INC,
+	.num_values = 2,
+	.init = hts221_init,
+	.set_values = hts221_set_values,
+};
+
+/* LPS25HBTR: pressure in 1/4096 hPa, temperature 42.5 degC + 1/480 */
+#define LPS25HBTR_DEVICE_ID	0xBD
+#define LPS25HBTR_REG_PRESS_OUT	0x28
+#define LPS25HBTR_REG_TEMP_OUT	0x2B
+
+static void lps25hbtr_set_values(struct artik_sim_device *dev,
+				const double *values, int count)
+{
+	long pressure = (long)(values[0] * 4096);
+
+	if (pressure < 0)
+		pressure = 0;
+	else if (pressure > 0xffffff)
+		pressure = 0xffffff;
+
+	dev->regs[LPS25HBTR_REG_PRESS_OUT] = pressure & 0xff;
+	dev->regs[LPS25HBTR_REG_PRESS_OUT + 1] = (pressure >> 8) & 0xff;
+	dev->regs[LPS25HBTR_REG_PRESS_OUT + 2] = (pressure >> 16) & 0xff;
+
+	if (count > 1)
+		put16(dev, LPS25HBTR_REG_TEMP_OUT,
+					(int)((values[1] - 42.5) * 480));
+}
+
+static artik_error lps25hbtr_init(struct artik_sim_device *dev)
+{
+	const double values[] = { 1013.25, 25.0 };
+
+	dev->regs[ST_REG_WHO_AM_I] = LPS25HBTR_DEVICE_ID;
+	lps25hbtr_set_values(dev, values, 2);
+
+	return S_OK;
+}
+
+const struct sim_model sim_lps25hbtr_model = {
+	.auto_inc = ST_AUTO_INC,
+	.num_values = 2,
+	.init = lps25hbtr_init,
+	.set_values = lps25hbtr_set_values,
+};
+
+/*
+ * K6DS3: the FIFO fills with the accelerometer output at the rate set in
+ * FIFO_CTRL5, computed from the time elapsed when its status is read.
+ * Like the chip, the oldest sample is overwritten when it is full.
+ */
+#define K6DS3_DEVICE_ID		0x69
+#define K6DS3_REG_FIFO_CTRL5	0x0A
+#define K6DS3_REG_CTRL3_C	0x12
+#define K6DS3_REG_OUTX_G	0x22
+#define K6DS3_REG_OUTX_XL	0x28
+#define K6DS3_REG_FIFO_STATUS1	0x3A
+#define K6DS3_REG_FIFO_STATUS2	0x3B
+#define K6DS3_REG_FIFO_STATUS3	0x3C
+#define K6DS3_REG_FIFO_STATUS4	0x3D
+#define K6DS3_REG_FIFO_DATA_L	0x3E
+#define K6DS3_REG_FIFO_DATA_H	0x3F
+
+#define K6DS3_FIFO_CONTINUOUS	0x06
+#define K6DS3_FIFO_MODE_MASK	0x07
+#define K6DS3_FIFO_OVER_RUN	0x40
+#define K6DS3_FIFO_EMPTY	0x10
+/* 4095 words of 16 bits, in samples of 3 words */
+#define K6DS3_FIFO_SAMPLES	1365
+
+static const unsigned int k6ds3_odr_hz[] = { 0, 13, 26, 52, 104, 208, 416,
+						833, 1660, 3330, 6660 };
+
+struct k6ds3_state {
+	short samples[K6DS3_FIFO_SAMPLES][3];
+	int head;
+	int count;
+	/* Words of the oldest sample already read */
+	int word;
+	bool overrun;
+	/* Time the last sample was queued */
+	unsigned long long last_ns;
+};
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void k6ds3_fifo_reset(struct k6ds3_state *state)
+{
+	state->head = 0;
+	state->count = 0;
+	state->word = 0;
+	state->overrun = false;
+	state->last_ns = now_ns();
+}
+
+static void k6ds3_fifo_fill(struct artik_sim_device *dev)
+{
+	struct k6ds3_state *state = dev->state;
+	unsigned char ctrl5 = dev->regs[K6DS3_REG_FIFO_CTRL5];
+	unsigned int odr = ctrl5 >> 3;
+	unsigned long long now = now_ns(), period_ns, n;
+	int i;
+
+	if ((ctrl5 & K6DS3_FIFO_MODE_MASK) != K6DS3_FIFO_CONTINUOUS ||
+	    !odr || odr >= sizeof(k6ds3_odr_hz) / sizeof(k6ds3_odr_hz[0]))
+		return;
+
+	period_ns = 1000000000ULL / k6ds3_odr_hz[odr];
+	n = (now - state->last_ns) / period_ns;
+	/* Keep the fraction of period for the next fill */
+	state->last_ns += n * period_ns;
+
+	/* Older samples would be overwritten anyway, skip queueing them */
+	if (n > K6DS3_FIFO_SAMPLES) {
+		n = K6DS3_FIFO_SAMPLES;
+		state->overrun = true;
+	}
+
+	for (; n; n--) {
+		short *sample;
+
+		if (state->count == K6DS3_FIFO_SAMPLES) {
+			state->head = (state->head + 1) % K6DS3_FIFO_SAMPLES;
+			state->count--;
+			state->word = 0;
+			state->overrun = true;
+		}
+
+		sample = state->samples[(state->head + state->count) %
+							K6DS3_FIFO_SAMPLES];
+		for (i = 0; i < 3; i++)
+			sample[i] = dev->regs[K6DS3_REG_OUTX_XL + 2 * i] |
+				dev->regs[K6DS3_REG_OUTX_XL + 2 * i + 1] << 8;
+		state->count++;
+	}
+}
+
+static unsigned char k6ds3_read(struct artik_sim_device *dev,
+				unsigned int reg)
+{
+	struct k6ds3_state *state = dev->state;
+	int words = state->count * 3 - state->word;
+	unsigned char value;
+
+	switch (reg) {
+	case K6DS3_REG_FIFO_STATUS1:
+		k6ds3_fifo_fill(dev);
+		words = state->count * 3 - state->word;
+		return words & 0xff;
+	case K6DS3_REG_FIFO_STATUS2:
+		return (words >> 8) | (state->overrun ? K6DS3_FIFO_OVER_RUN : 0)
+				| (words ? 0 : K6DS3_FIFO_EMPTY);
+	case K6DS3_REG_FIFO_STATUS3:
+		return state->word;
+	case K6DS3_REG_FIFO_STATUS4:
+		return 0;
+	case K6DS3_REG_FIFO_DATA_L:
+	case K6DS3_REG_FIFO_DATA_H:
+		if (!words)
+			return 0;
+		value = state->samples[state->head][state->word] >>
+				(reg == K6DS3_REG_FIFO_DATA_H ? 8 : 0);
+		if (reg == K6DS3_REG_FIFO_DATA_H && ++state->word == 3) {
+			state->word = 0;
+			state->head = (state->head + 1) % K6DS3_FIFO_SAMPLES;
+			state->count--;
+			state->overrun = false;
+		}
+		return value;
+	default:
+		return dev->regs[reg];
+	}
+}
+
+static void k6ds3_write(struct artik_sim_device *dev, unsigned int reg,
+				unsigned char value)
+{
+	struct k6ds3_state *state = dev->state;
+
+	/* Output and status registers are read only */
+	if (reg >= K6DS3_REG_OUTX_G && reg <= K6DS3_REG_FIFO_DATA_H)
+		return;
+
+	if (reg == K6DS3_REG_FIFO_CTRL5 &&
+	    ((value & K6DS3_FIFO_MODE_MASK) !=
+	     (dev->regs[reg] & K6DS3_FIFO_MODE_MASK) ||
+	     !(value & K6DS3_FIFO_MODE_MASK)))
+		k6ds3_fifo_reset(state);
+
+	dev->regs[reg] = value;
+}
+
+/* Burst reads of the FIFO stay on its output register */
+static unsigned int k6ds3_next(struct artik_sim_device *dev,
+				unsigned int reg)
+{
+	if (reg == K6DS3_REG_FIFO_DATA_H)
+		return K6DS3_REG_FIFO_DATA_L;
+
+	return (reg + 1) % SIM_NUM_REGS;
+}
+
+static void k6ds3_set_values(struct artik_sim_device *dev,
+				const double *values, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		unsigned int reg = i < 3 ? K6DS3_REG_OUTX_XL + 2 * i :
+					K6DS3_REG_OUTX_G + 2 * (i - 3);
+
+		put16(dev, reg, (int)values[i]);
+	}
+}
+
+static artik_error k6ds3_init(struct artik_sim_device *dev)
+{
+	/* At rest, 1g on the Z axis at +/-2g full scale */
+	const double values[] = { 0, 0, 16384, 0, 0, 0 };
+
+	dev->state = malloc(sizeof(struct k6ds3_state));
+	if (!dev->state)
+		return E_NO_MEM;
+
+	k6ds3_fifo_reset(dev->state);
+	dev->regs[ST_REG_WHO_AM_I] = K6DS3_DEVICE_ID;
+	dev->regs[K6DS3_REG_CTRL3_C] = 0x04;
+	k6ds3_set_values(dev, values, 6);
+
+	return S_OK;
+}
+
+static void k6ds3_cleanup(struct artik_sim_device *dev)
+{
+	free(dev->state);
+}
+
+const struct sim_model sim_k6ds3_model = {
+	.auto_inc = 0,
+	.num_values = 6,
+	.init = k6ds3_init,
+	.cleanup = k6ds3_cleanup,
+	.set_values = k6ds3_set_values,
+	.read = k6ds3_read,
+	.write = k6ds3_write,
+	.next = k6ds3_next,
+};
@@ -23,6 +23,7 @@
 
 #include "artik_spi.h"
 #include "artik_list.h"
+#include "artik_indexed_list.h"
 #include "os_spi.h"
 
 static artik_error artik_spi_request(artik_spi_handle * handle,
@@ -32,6 +33,9 @@ static artik_error artik_spi_read(artik_spi_handle handle, char *buf, int len);
 static artik_error artik_spi_write(artik_spi_handle handle, char *buf, int len);
 static artik_error artik_spi_read_write(artik_spi_handle handle,
 					   char *tx_buf, char *rx_buf, int len);
+static artik_error artik_spi_transfer(artik_spi_handle handle,
+				      const artik_spi_segment *segments,
+				      int count);
 
 const artik_spi_module spi_module = {
 	artik_spi_request,
@@ -39,6 +43,7 @@ const artik_spi_module spi_module = {
 	artik_spi_read,
 	artik_spi_write,
 	artik_spi_read_write,
+	artik_spi_transfer
 };
 
 typedef struct {
@@ -46,7 +51,7 @@ typedef struct {
 	artik_spi_config config;
 } spi_node;
 
-static artik_list *requested_node = NULL;
+static artik_indexed_list requested_node;
 
 static int check_exist(spi_node *elem, unsigned int val_bus)
 {
@@ -58,33 +63,37 @@ static int check_exist(spi_node *elem, unsigned int val_bus)
 artik_error artik_spi_request(artik_spi_handle *handle,
 			      artik_spi_config *config)
 {
-	spi_node *node = (spi_node *)artik_list_get_by_check(requested_node,
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_check(&requested_node,
 			(ARTIK_LIST_FUNCB)&check_exist, (void *)(intptr_t)config->bus);
 	artik_error ret = S_OK;
 
 	if (node)
 		return E_BUSY;
-	node = (spi_node *) artik_list_add(&requested_node, 0,
+	node = (spi_node *) artik_indexed_list_add(&requested_node, 0,
 							sizeof(spi_node));
 	if (!node) {
 		/* node memory to consume */
 		return E_NO_MEM;
 	}
-	ret = os_spi_request(config);
+	memcpy(&node->config, config, sizeof(node->config));
+	node->config.user_data = NULL;
+	ret = os_spi_request(&node->config);
 	if (ret == S_OK) {
 		node->node.handle = (ARTIK_LIST_HANDLE) node;
-		memcpy(&node->config, config, sizeof(node->config));
 		*handle = (artik_spi_handle)node;
 	} else {
 		/* node request failed */
-		artik_list_delete_node(&requested_node, (artik_list *)node);
+		artik_indexed_list_delete_node(&requested_node,
+				(artik_list *)node);
 	}
 	return ret;
 }
 
 artik_error artik_spi_release(artik_spi_handle handle)
 {
-	spi_node *node = (spi_node *)artik_list_get_by_handle(requested_node,
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 	artik_error ret = S_OK;
 
@@ -93,13 +102,14 @@ artik_error artik_spi_release(artik_spi_handle handle)
 	ret = os_spi_release(&node->config);
 	if (ret != S_OK)
 		return ret;
-	artik_list_delete_node(&requested_node, (artik_list *)node);
+	artik_indexed_list_delete_node(&requested_node, (artik_list *)node);
 	return ret;
 }
 
 artik_error artik_spi_read(artik_spi_handle handle, char *buf, int len)
 {
-	spi_node *node = (spi_node *)artik_list_get_by_handle(requested_node,
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -110,7 +120,8 @@ artik_error artik_spi_read(artik_spi_handle handle, char *buf, int len)
 
 artik_error artik_spi_write(artik_spi_handle handle, char *buf, int len)
 {
-	spi_node *node = (spi_node *)artik_list_get_by_handle(requested_node,
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -122,7 +133,8 @@ artik_error artik_spi_write(artik_spi_handle handle, char *buf, int len)
 artik_error artik_spi_read_write(artik_spi_handle handle, char *tx_buf,
 				    char *rx_buf, int len)
 {
-	spi_node *node = (spi_node *)artik_list_get_by_handle(requested_node,
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_handle(&requested_node,
 						(ARTIK_LIST_HANDLE) handle);
 
 	if (!node)
@@ -131,3 +143,15 @@ artik_error artik_spi_read_write(artik_spi_handle handle, char *tx_buf,
 	return os_spi_read_write(&node->config, tx_buf, rx_buf, len);
 }
 
+artik_error artik_spi_transfer(artik_spi_handle handle,
+			       const artik_spi_segment *segments, int count)
+{
+	spi_node *node =
+		(spi_node *)artik_indexed_list_get_by_handle(&requested_node,
+						(ARTIK_LIST_HANDLE) handle);
+
+	if (!node || !segments || count <= 0)
+		return E_BAD_ARGS;
+
+	return os_spi_transfer(&node->config, segments, count);
+}
@@ -27,6 +27,7 @@ artik::Spi::Spi(unsigned int bus, unsigned int cs, artik_spi_mode mode,
   m_config.mode = mode;
   m_config.bits_per_word = bits_per_word;
   m_config.max_speed = speed;
+  m_config.user_data = NULL;
   m_handle = NULL;
 }
 
@@ -59,3 +60,7 @@ artik_error artik::Spi::read_write(char* tx_buf, char* rx_buf, int len) {
   return m_module->read_write(m_handle, tx_buf, rx_buf, len);
 }
 
+artik_error artik::Spi::transfer(const artik_spi_segment* segments,
+    int count) {
+  return m_module->transfer(m_handle, segments, count);
+}
@@ -28,13 +28,36 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include <artik_log.h>
 #include <artik_spi.h>
 #include "os_spi.h"
+#include "../sim/sim.h"
 
 #define	SPI_DEV_MAX_LEN	64
 
+#define SPI_BUFSIZ_PATH		"/sys/module/spidev/parameters/bufsiz"
+#define SPI_DEFAULT_BUFSIZ	4096
+/* The size of the message is encoded in the ioctl number */
+#define SPI_MAX_SEGMENTS	(((1 << _IOC_SIZEBITS) - 1) / \
+				sizeof(struct spi_ioc_transfer))
+
+/*
+ * The device is opened once when the handle is requested, unless the
+ * chip is declared with artik_sim_add_device.
+ */
+typedef struct {
+	int fd;
+	bool sim;
+	/* Largest amount of data spidev accepts in one message */
+	unsigned int bufsiz;
+	pthread_mutex_t lock;
+	struct spi_ioc_transfer *xfers;
+	int max_xfers;
+	char devname[SPI_DEV_MAX_LEN];
+} os_spi_data;
+
 static int spi_setup(int fd, unsigned char mode, unsigned char bits,
 		unsigned int speed)
 {
@@ -78,11 +101,23 @@ static int spi_setup(int fd, unsigned char mode, unsigned char bits,
 	return 0;
 }
 
+static unsigned int spi_get_bufsiz(void)
+{
+	FILE *f = fopen(SPI_BUFSIZ_PATH, "r");
+	unsigned int bufsiz = SPI_DEFAULT_BUFSIZ;
+
+	if (f) {
+		if (fscanf(f, "%u", &bufsiz) != 1)
+			bufsiz = SPI_DEFAULT_BUFSIZ;
+		fclose(f);
+	}
+
+	return bufsiz;
+}
+
 artik_error os_spi_request(artik_spi_config *config)
 {
-	int fd = -1;
-	char devname[SPI_DEV_MAX_LEN];
-	artik_error ret = S_OK;
+	os_spi_data *data;
 
 	log_dbg("");
 
@@ -91,83 +126,104 @@ artik_error os_spi_request(artik_spi_config *config)
 	else if (config && config->mode == SPI_MODE_INVALID)
 		return E_NOT_INITIALIZED;
 
-	/* Try to open driver and set slave address */
-	snprintf(devname, SPI_DEV_MAX_LEN, "/dev/spidev%d.%d", config->bus,
-		 config->cs);
+	data = malloc(sizeof(os_spi_data));
+	if (!data)
+		return E_NO_MEM;
+
+	memset(data, 0, sizeof(os_spi_data));
+
+	snprintf(data->devname, SPI_DEV_MAX_LEN, "/dev/spidev%d.%d",
+		 config->bus, config->cs);
+
+	if (sim_spi_exists(config->bus, config->cs)) {
+		data->fd = -1;
+		data->sim = true;
+		pthread_mutex_init(&data->lock, NULL);
+		config->user_data = data;
+		return S_OK;
+	}
 
-	fd = open(devname, O_SYNC | O_WRONLY);
-	if (fd < 0) {
-		log_err("Failed to open %s (%d)", devname, errno);
+	data->fd = open(data->devname, O_RDWR | O_CLOEXEC);
+	if (data->fd < 0) {
+		log_err("Failed to open %s (%d)", data->devname, errno);
+		free(data);
 		return E_ACCESS_DENIED;
 	}
 
-	ret = spi_setup(fd, config->mode, config->bits_per_word,
-			config->max_speed);
-	if (ret < 0) {
+	if (spi_setup(data->fd, config->mode, config->bits_per_word,
+			config->max_speed) < 0) {
 		log_err("Failed to write spi setup %s(%d)",
-			devname, errno);
-		ret = E_ACCESS_DENIED;
+			data->devname, errno);
+		close(data->fd);
+		free(data);
+		return E_ACCESS_DENIED;
 	}
 
-	close(fd);
+	data->bufsiz = spi_get_bufsiz();
+	pthread_mutex_init(&data->lock, NULL);
+	config->user_data = data;
 
-	return ret;
-}
-
-artik_error os_spi_release(artik_spi_config *config)
-{
-	log_dbg("");
-
-	/* Nothing to do here */
 	return S_OK;
 }
 
-artik_error os_spi_read(artik_spi_config *config, char *buf, int len)
+artik_error os_spi_release(artik_spi_config *config)
 {
-	int fd = -1;
-	char devname[SPI_DEV_MAX_LEN];
-	artik_error ret = S_OK;
+	os_spi_data *data;
 
 	log_dbg("");
 
 	if (!config)
 		return E_BAD_ARGS;
-	else if (config && config->mode == SPI_MODE_INVALID)
-		return E_NOT_INITIALIZED;
 
-	if (!buf)
-		return E_BAD_ARGS;
+	data = (os_spi_data *)config->user_data;
+	if (!data)
+		return S_OK;
 
-	if (len <= 0)
-		return E_BAD_ARGS;
+	if (data->fd >= 0)
+		close(data->fd);
+	pthread_mutex_destroy(&data->lock);
+	free(data->xfers);
+	free(data);
+	config->user_data = NULL;
 
-	snprintf(devname, SPI_DEV_MAX_LEN, "/dev/spidev%d.%d", config->bus,
-		 config->cs);
+	return S_OK;
+}
 
-	fd = open(devname, O_RDWR);
-	if (fd < 0) {
-		log_err("Failed to open %s (%d)", devname, errno);
-		return E_ACCESS_DENIED;
+static artik_error spi_message(artik_spi_config *config,
+			       struct spi_ioc_transfer *xfers, int count)
+{
+	os_spi_data *data = (os_spi_data *)config->user_data;
+	unsigned int total = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		total += xfers[i].len;
+		if (!xfers[i].speed_hz)
+			xfers[i].speed_hz = config->max_speed;
+		if (!xfers[i].bits_per_word)
+			xfers[i].bits_per_word = config->bits_per_word;
 	}
 
-	if (read(fd, buf, len) != len) {
-		log_err("%s: Failed to read (%d)", devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
+	if (total > data->bufsiz) {
+		log_err("%s: %u bytes exceed the spidev buffer size (%u)",
+			data->devname, total, data->bufsiz);
+		return E_BAD_ARGS;
 	}
 
-exit:
-	close(fd);
+	if (ioctl(data->fd, SPI_IOC_MESSAGE(count), xfers) < 0) {
+		log_err("%s: Failed to transfer %d segments (%d)",
+			data->devname, count, errno);
+		return E_ACCESS_DENIED;
+	}
 
-	return ret;
+	return S_OK;
 }
 
-artik_error os_spi_write(artik_spi_config *config, char *buf, int len)
+static artik_error spi_single(artik_spi_config *config, const char *tx_buf,
+			      char *rx_buf, int len)
 {
-	int fd = -1;
-	char devname[SPI_DEV_MAX_LEN];
-	artik_error ret = S_OK;
-	struct spi_ioc_transfer data;
+	struct spi_ioc_transfer xfer;
+	os_spi_data *data;
 
 	log_dbg("");
 
@@ -176,48 +232,63 @@ artik_error os_spi_write(artik_spi_config *config, char *buf, int len)
 	else if (config && config->mode == SPI_MODE_INVALID)
 		return E_NOT_INITIALIZED;
 
-	if (!buf)
+	data = (os_spi_data *)config->user_data;
+	if (!data)
 		return E_BAD_ARGS;
 
 	if (len <= 0)
 		return E_BAD_ARGS;
 
-	memset(&data, 0, sizeof(data));
+	if (data->sim) {
+		artik_spi_segment segment;
 
-	snprintf(devname, SPI_DEV_MAX_LEN, "/dev/spidev%d.%d", config->bus,
-		 config->cs);
+		memset(&segment, 0, sizeof(segment));
+		segment.tx_buf = tx_buf;
+		segment.rx_buf = rx_buf;
+		segment.len = len;
 
-	fd = open(devname, O_SYNC | O_WRONLY);
-	if (fd < 0) {
-		log_err("Failed to open %s (%d)", devname, errno);
-		return E_ACCESS_DENIED;
+		return sim_spi_transfer(config->bus, config->cs, &segment, 1);
 	}
 
-	data.tx_buf = (unsigned long)buf;
-	data.rx_buf = (unsigned long)NULL;
-	data.len    = len;
-	data.speed_hz = config->max_speed;
-	data.bits_per_word = config->bits_per_word;
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.tx_buf = (unsigned long)tx_buf;
+	xfer.rx_buf = (unsigned long)rx_buf;
+	xfer.len = len;
 
-	if (ioctl(fd, SPI_IOC_MESSAGE(1), &data) < 0) {
-		log_err("%s: Failed to write (%d)", devname, errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
-	}
+	return spi_message(config, &xfer, 1);
+}
 
-exit:
-	close(fd);
+artik_error os_spi_read(artik_spi_config *config, char *buf, int len)
+{
+	if (!buf)
+		return E_BAD_ARGS;
 
-	return ret;
+	return spi_single(config, NULL, buf, len);
+}
+
+artik_error os_spi_write(artik_spi_config *config, char *buf, int len)
+{
+	if (!buf)
+		return E_BAD_ARGS;
+
+	return spi_single(config, buf, NULL, len);
 }
 
 artik_error os_spi_read_write(artik_spi_config *config, char *tx_buf,
 			      char *rx_buf, int len)
 {
-	int fd = -1;
-	char devname[SPI_DEV_MAX_LEN];
-	artik_error ret = S_OK;
-	struct spi_ioc_transfer data;
+	if (!tx_buf || !rx_buf)
+		return E_BAD_ARGS;
+
+	return spi_single(config, tx_buf, rx_buf, len);
+}
+
+artik_error os_spi_transfer(artik_spi_config *config,
+			    const artik_spi_segment *segments, int count)
+{
+	os_spi_data *data;
+	artik_error ret;
+	int i;
 
 	log_dbg("");
 
@@ -226,38 +297,46 @@ artik_error os_spi_read_write(artik_spi_config *config, char *tx_buf,
 	else if (config && config->mode == SPI_MODE_INVALID)
 		return E_NOT_INITIALIZED;
 
-	if (!tx_buf || !rx_buf)
+	data = (os_spi_data *)config->user_data;
+	if (!data || (unsigned int)count > SPI_MAX_SEGMENTS)
 		return E_BAD_ARGS;
 
-	if (len <= 0)
-		return E_BAD_ARGS;
+	for (i = 0; i < count; i++)
+		if (!segments[i].len)
+			return E_BAD_ARGS;
 
-	snprintf(devname, SPI_DEV_MAX_LEN, "/dev/spidev%d.%d", config->bus,
-		 config->cs);
+	if (data->sim)
+		return sim_spi_transfer(config->bus, config->cs, segments,
+									count);
 
-	fd = open(devname, O_SYNC | O_WRONLY);
-	if (fd < 0) {
-		log_err("Failed to open %s (%d)", devname, errno);
-		return E_ACCESS_DENIED;
+	pthread_mutex_lock(&data->lock);
+
+	if (count > data->max_xfers) {
+		struct spi_ioc_transfer *xfers = realloc(data->xfers,
+					count * sizeof(*xfers));
+
+		if (!xfers) {
+			pthread_mutex_unlock(&data->lock);
+			return E_NO_MEM;
+		}
+		data->xfers = xfers;
+		data->max_xfers = count;
 	}
-	memset(&data, 0, sizeof(data));
-
-	data.tx_buf = (unsigned long)tx_buf;
-	data.rx_buf = (unsigned long)rx_buf;
-	data.len    = len;
-	data.speed_hz = config->max_speed;
-	data.bits_per_word = config->bits_per_word;
-
-	if (ioctl(fd, SPI_IOC_MESSAGE(1), &data) < 0) {
-		log_err("%s: Failed to read/write operation at address 0x%04x (%d)",
-			devname, tx_buf[0], errno);
-		ret = E_ACCESS_DENIED;
-		goto exit;
+
+	memset(data->xfers, 0, count * sizeof(*data->xfers));
+	for (i = 0; i < count; i++) {
+		data->xfers[i].tx_buf = (unsigned long)segments[i].tx_buf;
+		data->xfers[i].rx_buf = (unsigned long)segments[i].rx_buf;
+		data->xfers[i].len = segments[i].len;
+		data->xfers[i].speed_hz = segments[i].speed_hz;
+		data->xfers[i].delay_usecs = segments[i].delay_usecs;
+		data->xfers[i].bits_per_word = segments[i].bits_per_word;
+		data->xfers[i].cs_change = segments[i].cs_change;
 	}
 
-exit:
-	close(fd);
+	ret = spi_message(config, data->xfers, count);
+
+	pthread_mutex_unlock(&data->lock);
 
 	return ret;
 }
-
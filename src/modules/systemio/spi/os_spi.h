@@ -27,5 +27,7 @@ artik_error os_spi_read(artik_spi_config *config, char *buf, int len);
 artik_error os_spi_write(artik_spi_config *config, char *buf, int len);
 artik_error os_spi_read_write(artik_spi_config *config, char *tx_buf,
 				char *rx_buf, int len);
+artik_error os_spi_transfer(artik_spi_config *config,
+				const artik_spi_segment *segments, int count);
 
 #endif /* SRC_SPI_OS_GPIO_H_ */
@@ -20,6 +20,7 @@
 #include "os_spi.h"
 
 #include <stdio.h>
+#include <unistd.h>
 #include <errno.h>
 #include <tinyara/spi/spi.h>
 
@@ -155,3 +156,51 @@ artik_error os_spi_read_write(artik_spi_config *config, char *tx_buf,
 
 	return S_OK;
 }
+
+artik_error os_spi_transfer(artik_spi_config *config,
+		const artik_spi_segment *segments, int count)
+{
+	int i;
+
+	if (!config || !segments || (count <= 0))
+		return E_BAD_ARGS;
+
+	if (!sdev)
+		return E_NOT_INITIALIZED;
+
+	SPI_LOCK(sdev, TRUE);
+
+	SPI_SETMODE(sdev, config->mode);
+
+	SPI_SELECT(sdev, config->cs, TRUE);
+
+	for (i = 0; i < count; i++) {
+		const artik_spi_segment *seg = &segments[i];
+
+		SPI_SETFREQUENCY(sdev, seg->speed_hz ? seg->speed_hz :
+				config->max_speed);
+		SPI_SETBITS(sdev, seg->bits_per_word ? seg->bits_per_word :
+				config->bits_per_word);
+
+		if (seg->tx_buf && seg->rx_buf)
+			SPI_EXCHANGE(sdev, seg->tx_buf, seg->rx_buf, seg->len);
+		else if (seg->tx_buf)
+			SPI_SNDBLOCK(sdev, seg->tx_buf, seg->len);
+		else if (seg->rx_buf)
+			SPI_RECVBLOCK(sdev, seg->rx_buf, seg->len);
+
+		if (seg->delay_usecs)
+			usleep(seg->delay_usecs);
+
+		if (seg->cs_change && i < count - 1) {
+			SPI_SELECT(sdev, config->cs, FALSE);
+			SPI_SELECT(sdev, config->cs, TRUE);
+		}
+	}
+
+	SPI_SELECT(sdev, config->cs, FALSE);
+
+	SPI_LOCK(sdev, FALSE);
+
+	return S_OK;
+}
@@ -20,8 +20,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <time.h>
 
 #include <artik_module.h>
+#include <artik_loop.h>
 #include <artik_adc.h>
 
 static artik_adc_config config = { 0, "adc", NULL };
@@ -76,9 +79,244 @@ exit:
 	return S_OK;
 }
 
+/*
+ * Tests on the iio_dummy driver, set up with:
+ *   modprobe iio_dummy; modprobe iio-trig-hrtimer
+ *   mkdir /sys/kernel/config/iio/devices/dummy/artik-dummy
+ * Buffered samples of its in_voltage0 channel are always 7.
+ */
+#define DUMMY_NAME		"artik-dummy"
+#define DUMMY_VOLTAGE0		7
+#define DUMMY_READS		10000
+#define STREAM_RATE		1000
+#define STREAM_BLOCK		64
+#define RING_RATE		10000
+#define RING_SCANS		8192
+
+struct stream_check {
+	artik_loop_module *loop;
+	int scans;
+	int errors;
+};
+
+static int find_dummy_device(void)
+{
+	struct dirent *entry;
+	char path[300];
+	char name[64];
+	int device = -1;
+	DIR *dir;
+
+	dir = opendir("/sys/bus/iio/devices");
+	if (!dir)
+		return -1;
+
+	while (device < 0 && (entry = readdir(dir))) {
+		FILE *f;
+
+		if (strncmp(entry->d_name, "iio:device", 10))
+			continue;
+		snprintf(path, sizeof(path), "/sys/bus/iio/devices/%s/name",
+			entry->d_name);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+		if (fgets(name, sizeof(name), f) &&
+				!strncmp(name, DUMMY_NAME, strlen(DUMMY_NAME)))
+			device = atoi(entry->d_name + 10);
+		fclose(f);
+	}
+	closedir(dir);
+
+	return device;
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static artik_error adc_test_values(int device)
+{
+	artik_adc_module *adc = (artik_adc_module *)
+					artik_request_api_module("adc");
+	artik_adc_config dummy = { ADC_DEVICE_PIN(device, 0), "dummy", NULL };
+	artik_adc_handle handle;
+	unsigned long long start, elapsed;
+	int val = -1, values[1] = { -1 };
+	artik_error ret;
+	int i;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	ret = adc->request(&handle, &dummy);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s - Failed to request adc (err=%d)\n",
+			__func__, ret);
+		goto exit;
+	}
+
+	start = now_ns();
+	for (i = 0; i < DUMMY_READS && ret == S_OK; i++)
+		ret = adc->get_value(handle, &val);
+	elapsed = now_ns() - start;
+	if (ret == S_OK)
+		ret = adc->get_values(&handle, 1, values);
+	adc->release(handle);
+
+	if (ret != S_OK || values[0] != val) {
+		fprintf(stderr, "TEST: %s - Failed to read values (err=%d)\n",
+			__func__, ret);
+		ret = (ret != S_OK) ? ret : E_INVALID_VALUE;
+		goto exit;
+	}
+	fprintf(stdout, "BENCH: %llu reads/s\n",
+		DUMMY_READS * 1000000000ULL / (elapsed ? elapsed : 1));
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	artik_release_api_module(adc);
+
+	return ret;
+}
+
+static void stream_block(void *user_data, const int *samples, int num_scans)
+{
+	struct stream_check *check = (struct stream_check *)user_data;
+	int i;
+
+	for (i = 0; i < num_scans; i++)
+		if (samples[i] != DUMMY_VOLTAGE0)
+			check->errors++;
+
+	check->scans += num_scans;
+	if (check->scans >= STREAM_RATE)
+		check->loop->quit();
+}
+
+static void stream_timeout(void *user_data)
+{
+	struct stream_check *check = (struct stream_check *)user_data;
+
+	check->loop->quit();
+}
+
+static artik_error adc_test_stream(int device)
+{
+	artik_adc_module *adc = (artik_adc_module *)
+					artik_request_api_module("adc");
+	int pins[1] = { ADC_DEVICE_PIN(device, 0) };
+	artik_adc_stream_config config = { pins, 1, STREAM_RATE, STREAM_BLOCK,
+									0 };
+	static int samples[RING_SCANS];
+	struct stream_check check = { NULL, 0, 0 };
+	artik_adc_stream_handle stream, second;
+	artik_adc_stream_stats stats;
+	unsigned long long start, elapsed;
+	artik_error ret;
+	int timeout_id;
+	int count, i;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	/* Blocks delivered from the loop */
+	check.loop = (artik_loop_module *)artik_request_api_module("loop");
+	ret = adc->start_stream(&stream, &config, stream_block, &check);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s - Failed to start stream (err=%d)\n",
+			__func__, ret);
+		goto exit;
+	}
+
+	start = now_ns();
+	check.loop->add_timeout_callback(&timeout_id, 3000, stream_timeout,
+								&check);
+	check.loop->run();
+	elapsed = now_ns() - start;
+	check.loop->remove_timeout_callback(timeout_id);
+	adc->stop_stream(stream);
+
+	fprintf(stdout, "BENCH: callback %d scans in %llu ms\n", check.scans,
+		elapsed / 1000000);
+	if (check.scans < STREAM_RATE || check.errors) {
+		fprintf(stderr, "TEST: %s - %d scans, %d wrong samples\n",
+			__func__, check.scans, check.errors);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	/* Blocks stored in the ring by the capture thread */
+	config.sample_rate = RING_RATE;
+	config.block_scans = 256;
+	config.ring_scans = RING_SCANS;
+	ret = adc->start_stream(&stream, &config, NULL, NULL);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s - Failed to start stream (err=%d)\n",
+			__func__, ret);
+		goto exit;
+	}
+
+	/* The buffer of the device is used by the running stream */
+	ret = adc->start_stream(&second, &config, NULL, NULL);
+	if (ret != E_BUSY) {
+		fprintf(stderr, "TEST: %s - Second stream started (err=%d)\n",
+			__func__, ret);
+		if (ret == S_OK)
+			adc->stop_stream(second);
+		adc->stop_stream(stream);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+	ret = S_OK;
+
+	check.scans = 0;
+	start = now_ns();
+	while (now_ns() - start < 1000000000ULL) {
+		usleep(50000);
+		count = adc->read_stream(stream, samples, RING_SCANS);
+		for (i = 0; i < count; i++)
+			if (samples[i] != DUMMY_VOLTAGE0)
+				check.errors++;
+		check.scans += (count > 0) ? count : 0;
+	}
+	adc->get_stream_stats(stream, &stats);
+	adc->stop_stream(stream);
+
+	fprintf(stdout, "BENCH: ring %d scans/s, %llu overruns\n",
+		check.scans, stats.overruns);
+	if (!check.scans || check.errors ||
+			(unsigned long long)check.scans + stats.overruns >
+								stats.scans) {
+		fprintf(stderr, "TEST: %s - %d scans, %d wrong samples\n",
+			__func__, check.scans, check.errors);
+		ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	artik_release_api_module(check.loop);
+	artik_release_api_module(adc);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = S_OK;
+	int device = find_dummy_device();
+
+	if (device >= 0) {
+		ret = adc_test_values(device);
+		if (ret == S_OK)
+			ret = adc_test_stream(device);
+		return (ret == S_OK) ? 0 : -1;
+	}
 
 	ret = adc_test_value();
 
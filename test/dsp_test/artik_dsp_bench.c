@@ -0,0 +1,474 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <artik_dsp.h>
+
+/*
+ * Checks the DSP helpers against straightforward double precision code,
+ * with block sizes that exercise both the vector loops and their tails,
+ * then compares their throughput with the sample by sample float code
+ * applications would otherwise run on ADC blocks.
+ */
+
+#define NUM_SAMPLES	4096
+#define BENCH_ROUNDS	2000
+#define NUM_TAPS	31
+#define DECIMATION	4
+#define TOLERANCE	1e-4
+
+/* 3.3 V full scale on 12 bits, centered on 0 V */
+static const artik_dsp_calibration calibration = {
+	2048, 0.000805664f, 0.0f
+};
+
+/* Low-pass biquads, 100 Hz at 1 kHz sampling */
+static const artik_dsp_biquad sections[] = {
+	{ 0.067455f, 0.134911f, 0.067455f, -1.142980f, 0.412802f },
+	{ 0.067455f, 0.134911f, 0.067455f, -1.142980f, 0.412802f },
+};
+
+#define NUM_SECTIONS	(int)(sizeof(sections) / sizeof(sections[0]))
+
+static int raw[NUM_SAMPLES];
+static float samples[NUM_SAMPLES];
+static float taps[NUM_TAPS];
+static float out[NUM_SAMPLES + 1];
+static double ref[NUM_SAMPLES + 1];
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void init_samples(void)
+{
+	int i;
+
+	/* 12-bit ADC counts: a sine with some noise */
+	for (i = 0; i < NUM_SAMPLES; i++)
+		raw[i] = 2048 + (int)(1500 * sin(i * 0.05)) + rand() % 64 - 32;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		samples[i] = (raw[i] - calibration.offset) * calibration.scale
+			+ calibration.bias;
+
+	/* Windowed sinc */
+	for (i = 0; i < NUM_TAPS; i++) {
+		double x = i - (NUM_TAPS - 1) / 2.0;
+		double w = 0.54 - 0.46 * cos(2 * M_PI * i / (NUM_TAPS - 1));
+
+		taps[i] = (x == 0 ? 0.25 : sin(0.25 * M_PI * x) / (M_PI * x))
+			* w;
+	}
+}
+
+static int compare(const char *what, const float *values,
+			const double *expected, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (fabs(values[i] - expected[i]) > TOLERANCE *
+		    (1 + fabs(expected[i]))) {
+			fprintf(stdout, "TEST: %s: sample %d is %f instead of %f\n",
+				what, i, values[i], expected[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void ref_fir(const float *in, int count, int decimation, double *res)
+{
+	int n, k, written = 0;
+
+	for (n = 0; n < count; n += decimation) {
+		double sum = 0;
+
+		for (k = 0; k < NUM_TAPS && k <= n; k++)
+			sum += (double)taps[k] * in[n - k];
+		res[written++] = sum;
+	}
+}
+
+static artik_error test_scale(void)
+{
+	artik_error ret = S_OK;
+	int lengths[] = { 0, 1, 3, 4, 7, NUM_SAMPLES };
+	unsigned int l;
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		ref[i] = (raw[i] - calibration.offset) *
+			(double)calibration.scale + calibration.bias;
+
+	for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+		ret = artik_dsp_scale(raw, out, lengths[l], &calibration);
+		if (ret != S_OK || compare("scale", out, ref, lengths[l]) < 0) {
+			ret = E_INVALID_VALUE;
+			goto exit;
+		}
+	}
+
+	/* Interleaved scans of two pins, the second one is raw[i] + 1 */
+	{
+		int scans[2 * 5];
+		int pin[5];
+
+		for (i = 0; i < 5; i++) {
+			scans[2 * i] = raw[i];
+			scans[2 * i + 1] = raw[i] + 1;
+		}
+
+		ret = artik_dsp_deinterleave(scans, 2, 1, pin, 5);
+		for (i = 0; ret == S_OK && i < 5; i++)
+			if (pin[i] != raw[i] + 1)
+				ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+static artik_error test_fir(int decimation)
+{
+	artik_dsp_fir *fir = NULL;
+	artik_error ret;
+	int expected = (NUM_SAMPLES + decimation - 1) / decimation;
+	int block, written, i;
+
+	fprintf(stdout, "TEST: %s decimation %d starting\n", __func__,
+		decimation);
+
+	ref_fir(samples, NUM_SAMPLES, decimation, ref);
+
+	ret = artik_dsp_fir_create(&fir, taps, NUM_TAPS, decimation);
+	if (ret != S_OK)
+		goto exit;
+
+	/* The output must not depend on how the input is cut in blocks */
+	for (block = 1; block <= 1031; block = block * 3 + 2) {
+		artik_dsp_fir_reset(fir);
+
+		for (i = 0, written = 0; i < NUM_SAMPLES; i += block) {
+			int len = NUM_SAMPLES - i < block ? NUM_SAMPLES - i
+				: block;
+			int res = artik_dsp_fir_process(fir, samples + i, len,
+							out + written);
+
+			if (res < 0 || res > len / decimation + 1) {
+				ret = E_INVALID_VALUE;
+				goto exit;
+			}
+			written += res;
+		}
+
+		if (written != expected ||
+		    compare("fir", out, ref, expected) < 0) {
+			fprintf(stdout, "TEST: %d outputs, blocks of %d\n",
+				written, block);
+			ret = E_INVALID_VALUE;
+			goto exit;
+		}
+	}
+
+exit:
+	artik_dsp_fir_destroy(fir);
+	fprintf(stdout, "TEST: %s decimation %d %s\n", __func__, decimation,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+static artik_error test_iir(void)
+{
+	artik_dsp_iir *iir = NULL;
+	double state[NUM_SECTIONS][2];
+	artik_error ret;
+	int s, n, i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	memset(state, 0, sizeof(state));
+	for (n = 0; n < NUM_SAMPLES; n++) {
+		double x = samples[n];
+
+		for (s = 0; s < NUM_SECTIONS; s++) {
+			const artik_dsp_biquad *c = &sections[s];
+			double y = c->b0 * x + state[s][0];
+
+			state[s][0] = c->b1 * x - c->a1 * y + state[s][1];
+			state[s][1] = c->b2 * x - c->a2 * y;
+			x = y;
+		}
+		ref[n] = x;
+	}
+
+	ret = artik_dsp_iir_create(&iir, sections, NUM_SECTIONS);
+	if (ret != S_OK)
+		goto exit;
+
+	/* In place, in uneven blocks */
+	memcpy(out, samples, sizeof(samples));
+	for (i = 0; i < NUM_SAMPLES; i += 100) {
+		int len = NUM_SAMPLES - i < 100 ? NUM_SAMPLES - i : 100;
+
+		ret = artik_dsp_iir_process(iir, out + i, out + i, len);
+		if (ret != S_OK)
+			goto exit;
+	}
+
+	if (compare("iir", out, ref, NUM_SAMPLES) < 0)
+		ret = E_INVALID_VALUE;
+
+exit:
+	artik_dsp_iir_destroy(iir);
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+static artik_error test_stats(void)
+{
+	artik_dsp_stats stats;
+	double min, max, sum, sum_sq;
+	artik_error ret = S_OK;
+	int lengths[] = { 1, 5, 1023, NUM_SAMPLES };
+	unsigned int l;
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+		int count = lengths[l];
+
+		min = max = samples[0];
+		sum = sum_sq = 0;
+		for (i = 0; i < count; i++) {
+			min = samples[i] < min ? samples[i] : min;
+			max = samples[i] > max ? samples[i] : max;
+			sum += samples[i];
+			sum_sq += (double)samples[i] * samples[i];
+		}
+
+		ref[0] = min;
+		ref[1] = max;
+		ref[2] = sum / count;
+		ref[3] = sqrt(sum_sq / count);
+
+		ret = artik_dsp_get_stats(samples, count, &stats);
+		if (ret != S_OK)
+			break;
+
+		out[0] = stats.min;
+		out[1] = stats.max;
+		out[2] = stats.mean;
+		out[3] = stats.rms;
+		if (compare("stats", out, ref, 4) < 0) {
+			ret = E_INVALID_VALUE;
+			break;
+		}
+	}
+
+	if (ret == S_OK && artik_dsp_get_stats(samples, 0, &stats) == S_OK)
+		ret = E_INVALID_VALUE;
+
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+static void print_result(const char *name, uint64_t elapsed, uint64_t base)
+{
+	fprintf(stdout, "BENCH: %-12s %8.2f nsec/sample %8.1f Msamples/s "
+		"(x%.1f)\n", name, (double)elapsed / BENCH_ROUNDS / NUM_SAMPLES,
+		(double)BENCH_ROUNDS * NUM_SAMPLES * 1000 / elapsed,
+		(double)base / elapsed);
+}
+
+/*
+ * The baselines are the usual one sample at a time loops, kept out of
+ * line so that the compiler does not specialize them for the constant
+ * data above.
+ */
+__attribute__((noinline))
+static void base_scale(const int *in, float *res, int count,
+			const artik_dsp_calibration *cal)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		res[i] = (in[i] - cal->offset) * cal->scale + cal->bias;
+}
+
+__attribute__((noinline))
+static void base_fir(const float *in, float *res, int count,
+			float *history)
+{
+	int i, k;
+
+	for (i = 0; i < count; i++) {
+		float sum;
+
+		memmove(history + 1, history, (NUM_TAPS - 1) * sizeof(float));
+		history[0] = in[i];
+
+		sum = 0;
+		for (k = 0; k < NUM_TAPS; k++)
+			sum += taps[k] * history[k];
+		res[i] = sum;
+	}
+}
+
+__attribute__((noinline))
+static void base_stats(const float *in, int count, artik_dsp_stats *stats)
+{
+	float min = in[0], max = in[0], sum = 0, sum_sq = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (in[i] < min)
+			min = in[i];
+		if (in[i] > max)
+			max = in[i];
+		sum += in[i];
+		sum_sq += in[i] * in[i];
+	}
+
+	stats->min = min;
+	stats->max = max;
+	stats->mean = sum / count;
+	stats->rms = sqrtf(sum_sq / count);
+}
+
+static artik_error bench(void)
+{
+	float history[NUM_TAPS] = { 0 };
+	artik_dsp_fir *fir = NULL;
+	artik_dsp_iir *iir = NULL;
+	artik_dsp_stats stats;
+	uint64_t start, base;
+	artik_error ret;
+	int r;
+
+	ret = artik_dsp_fir_create(&fir, taps, NUM_TAPS, 1);
+	if (ret != S_OK)
+		return ret;
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		base_scale(raw, out, NUM_SAMPLES, &calibration);
+	base = now_nsec() - start;
+	print_result("scale base", base, base);
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		artik_dsp_scale(raw, out, NUM_SAMPLES, &calibration);
+	print_result("scale", now_nsec() - start, base);
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		base_fir(samples, out, NUM_SAMPLES, history);
+	base = now_nsec() - start;
+	print_result("fir base", base, base);
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		artik_dsp_fir_process(fir, samples, NUM_SAMPLES, out);
+	print_result("fir", now_nsec() - start, base);
+	artik_dsp_fir_destroy(fir);
+
+	ret = artik_dsp_fir_create(&fir, taps, NUM_TAPS, DECIMATION);
+	if (ret != S_OK)
+		return ret;
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		artik_dsp_fir_process(fir, samples, NUM_SAMPLES, out);
+	print_result("fir decim 4", now_nsec() - start, base);
+	artik_dsp_fir_destroy(fir);
+
+	ret = artik_dsp_iir_create(&iir, sections, NUM_SECTIONS);
+	if (ret != S_OK)
+		return ret;
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		artik_dsp_iir_process(iir, samples, out, NUM_SAMPLES);
+	base = now_nsec() - start;
+	print_result("iir", base, base);
+	artik_dsp_iir_destroy(iir);
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		base_stats(samples, NUM_SAMPLES, &stats);
+	base = now_nsec() - start;
+	print_result("stats base", base, base);
+
+	start = now_nsec();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		artik_dsp_get_stats(samples, NUM_SAMPLES, &stats);
+	print_result("stats", now_nsec() - start, base);
+
+	return S_OK;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_error ret;
+
+	init_samples();
+
+	ret = test_scale();
+	if (ret == S_OK)
+		ret = test_fir(1);
+	if (ret == S_OK)
+		ret = test_fir(DECIMATION);
+	if (ret == S_OK)
+		ret = test_iir();
+	if (ret == S_OK)
+		ret = test_stats();
+	if (ret != S_OK)
+		return -1;
+
+	ret = bench();
+
+	fprintf(stdout, "TEST: benchmark %s\n",
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return (ret == S_OK) ? 0 : -1;
+}
@@ -17,8 +17,13 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
 
 #include <artik_module.h>
 #include <artik_loop.h>
@@ -207,10 +212,366 @@ exit:
 	return ret;
 }
 
+/*
+ * Toggle rate benchmark on the gpio-mockup driver, loaded with:
+ *   modprobe gpio-mockup gpio_mockup_ranges=-1,8
+ */
+#define MOCKUP_LABEL		"gpio-mockup"
+#define MOCKUP_LINES		8
+#define MOCKUP_TOGGLES		100000
+
+static int find_mockup_chip(void)
+{
+	struct gpiochip_info info;
+	char path[32];
+	int chip;
+
+	for (chip = 0; chip < 64; chip++) {
+		int fd;
+
+		snprintf(path, sizeof(path), "/dev/gpiochip%d", chip);
+		fd = open(path, O_RDWR);
+		if (fd < 0)
+			continue;
+		if (!ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) &&
+				info.lines >= MOCKUP_LINES &&
+				!strncmp(info.label, MOCKUP_LABEL,
+					strlen(MOCKUP_LABEL))) {
+			close(fd);
+			return chip;
+		}
+		close(fd);
+	}
+
+	return -1;
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static artik_error test_mockup_toggle(int chip)
+{
+	artik_gpio_module *gpio = (artik_gpio_module *)
+					artik_request_api_module("gpio");
+	artik_gpio_config configs[MOCKUP_LINES];
+	artik_gpio_bulk_handle bulk = NULL;
+	artik_gpio_handle line = NULL;
+	int values[MOCKUP_LINES], read_values[MOCKUP_LINES];
+	unsigned long long start, elapsed;
+	artik_error ret = S_OK;
+	int i, j;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	memset(configs, 0, sizeof(configs));
+	for (i = 0; i < MOCKUP_LINES; i++) {
+		configs[i].id = GPIO_CHIP_LINE(chip, i);
+		configs[i].name = "mockup";
+		configs[i].dir = GPIO_OUT;
+		configs[i].edge = GPIO_EDGE_NONE;
+	}
+
+	ret = gpio->request(&line, &configs[0]);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request line 0 (%d)\n", ret);
+		goto exit;
+	}
+
+	start = now_ns();
+	for (i = 0; i < MOCKUP_TOGGLES && ret == S_OK; i++)
+		ret = gpio->write(line, i & 1);
+	elapsed = now_ns() - start;
+	gpio->release(line);
+
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to toggle line 0 (%d)\n", ret);
+		goto exit;
+	}
+	fprintf(stdout, "BENCH: single line %llu writes/s\n",
+		MOCKUP_TOGGLES * 1000000000ULL / (elapsed ? elapsed : 1));
+
+	ret = gpio->request_bulk(&bulk, configs, MOCKUP_LINES);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request %d lines (%d)\n",
+			MOCKUP_LINES, ret);
+		goto exit;
+	}
+
+	start = now_ns();
+	for (i = 0; i < MOCKUP_TOGGLES && ret == S_OK; i++) {
+		for (j = 0; j < MOCKUP_LINES; j++)
+			values[j] = (i >> (j % 2)) & 1;
+		ret = gpio->write_bulk(bulk, values);
+	}
+	elapsed = now_ns() - start;
+
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to toggle %d lines (%d)\n",
+			MOCKUP_LINES, ret);
+		goto release;
+	}
+	fprintf(stdout, "BENCH: %d lines %llu writes/s\n", MOCKUP_LINES,
+		MOCKUP_TOGGLES * 1000000000ULL / (elapsed ? elapsed : 1));
+
+	for (j = 0; j < MOCKUP_LINES; j++)
+		values[j] = j & 1;
+	ret = gpio->write_bulk(bulk, values);
+	if (ret == S_OK)
+		ret = gpio->read_bulk(bulk, read_values);
+	if (ret != S_OK || memcmp(values, read_values, sizeof(values))) {
+		fprintf(stderr, "Lines read back do not match (%d)\n", ret);
+		ret = (ret != S_OK) ? ret : E_INVALID_VALUE;
+	}
+
+release:
+	gpio->release_bulk(bulk);
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, ret == S_OK ? "succeeded" :
+								"failed");
+
+	artik_release_api_module(gpio);
+
+	return ret;
+}
+
+/*
+ * Edges are generated by changing the pull of the mockup lines through
+ * debugfs, the queue is drained by the loop between bursts of writes.
+ */
+#define MOCKUP_DEBUGFS		"/sys/kernel/debug/gpio-mockup"
+#define MOCKUP_EDGES		65536
+#define MOCKUP_BURST		512
+#define MOCKUP_PRESSES		20
+#define MOCKUP_BOUNCES		5
+#define MOCKUP_PRESS_MS		20
+#define MOCKUP_DEBOUNCE_US	5000
+
+struct mockup_events {
+	artik_loop_module *loop;
+	int pull_fd;
+	int level;
+	int generated;
+	int presses;
+	int received;
+	int batches;
+	unsigned int last_sequence;
+	unsigned long long last_timestamp;
+	artik_gpio_edge_t last_edge;
+	unsigned long long last_ns;
+	bool error;
+};
+
+static void mockup_pull(struct mockup_events *ev)
+{
+	ev->level = !ev->level;
+	if (pwrite(ev->pull_fd, ev->level ? "1" : "0", 1, 0) != 1)
+		ev->error = true;
+	ev->generated++;
+}
+
+static void mockup_quit(void *user_data)
+{
+	struct mockup_events *ev = (struct mockup_events *)user_data;
+
+	ev->loop->quit();
+}
+
+static int mockup_burst(void *user_data)
+{
+	struct mockup_events *ev = (struct mockup_events *)user_data;
+	int timeout_id;
+	int i;
+
+	for (i = 0; i < MOCKUP_BURST && ev->generated < MOCKUP_EDGES; i++)
+		mockup_pull(ev);
+
+	if (ev->generated < MOCKUP_EDGES && !ev->error)
+		return 1;
+
+	ev->loop->add_timeout_callback(&timeout_id, 100, mockup_quit, ev);
+
+	return 0;
+}
+
+/* An odd number of bounces leaves the line in the opposite state */
+static int mockup_press(void *user_data)
+{
+	struct mockup_events *ev = (struct mockup_events *)user_data;
+	int timeout_id;
+	int i;
+
+	for (i = 0; i < MOCKUP_BOUNCES; i++)
+		mockup_pull(ev);
+
+	if (++ev->presses < MOCKUP_PRESSES && !ev->error)
+		return 1;
+
+	ev->loop->add_timeout_callback(&timeout_id,
+			MOCKUP_DEBOUNCE_US / 1000 * 4, mockup_quit, ev);
+
+	return 0;
+}
+
+static void mockup_events(void *user_data, const artik_gpio_event *events,
+				int count)
+{
+	struct mockup_events *ev = (struct mockup_events *)user_data;
+	int i;
+
+	ev->batches++;
+	for (i = 0; i < count; i++) {
+		if (events[i].sequence <= ev->last_sequence ||
+				events[i].timestamp_ns < ev->last_timestamp)
+			ev->error = true;
+		/* Consecutive edges must alternate */
+		if (events[i].sequence == ev->last_sequence + 1 &&
+				events[i].edge == ev->last_edge)
+			ev->error = true;
+		ev->last_sequence = events[i].sequence;
+		ev->last_timestamp = events[i].timestamp_ns;
+		ev->last_edge = events[i].edge;
+		ev->received++;
+	}
+	ev->last_ns = now_ns();
+}
+
+static artik_error mockup_watch(artik_gpio_module *gpio, int chip, int line,
+			unsigned int debounce_us, struct mockup_events *ev,
+			artik_gpio_event_stats *stats)
+{
+	artik_gpio_config config;
+	artik_gpio_handle handle = NULL;
+	char path[64];
+	artik_error ret;
+	int id;
+
+	memset(ev, 0, sizeof(*ev));
+	ev->last_edge = GPIO_EDGE_FALLING;
+	ev->loop = (artik_loop_module *)artik_request_api_module("loop");
+
+	snprintf(path, sizeof(path), MOCKUP_DEBUGFS "/gpiochip%d/%d", chip,
+									line);
+	ev->pull_fd = open(path, O_WRONLY);
+	if (ev->pull_fd < 0) {
+		fprintf(stderr, "Failed to open %s\n", path);
+		artik_release_api_module(ev->loop);
+		return E_ACCESS_DENIED;
+	}
+	/* Start from a low level */
+	if (pwrite(ev->pull_fd, "0", 1, 0) != 1) {
+		ret = E_ACCESS_DENIED;
+		goto exit;
+	}
+
+	memset(&config, 0, sizeof(config));
+	config.id = GPIO_CHIP_LINE(chip, line);
+	config.name = "mockup";
+	config.dir = GPIO_IN;
+	config.edge = GPIO_EDGE_BOTH;
+
+	ret = gpio->request(&handle, &config);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request line %d (%d)\n", line, ret);
+		goto exit;
+	}
+
+	ret = gpio->set_events_callback(handle, mockup_events, debounce_us,
+									ev);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to set events callback (%d)\n", ret);
+		goto release;
+	}
+
+	if (debounce_us)
+		ev->loop->add_periodic_callback(&id, MOCKUP_PRESS_MS,
+							mockup_press, ev);
+	else
+		ev->loop->add_idle_callback(&id, mockup_burst, ev);
+	ev->loop->run();
+
+	gpio->get_event_stats(handle, stats);
+	gpio->unset_change_callback(handle);
+
+release:
+	gpio->release(handle);
+exit:
+	close(ev->pull_fd);
+	artik_release_api_module(ev->loop);
+
+	return ret;
+}
+
+static artik_error test_mockup_events(int chip)
+{
+	artik_gpio_module *gpio = (artik_gpio_module *)
+					artik_request_api_module("gpio");
+	artik_gpio_event_stats stats;
+	struct mockup_events ev;
+	unsigned long long start;
+	artik_error ret;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	start = now_ns();
+	ret = mockup_watch(gpio, chip, 1, 0, &ev, &stats);
+	if (ret != S_OK)
+		goto exit;
+
+	fprintf(stdout, "BENCH: %d edges, %d events in %d batches, %d lost, %llu events/s\n",
+		ev.generated, ev.received, ev.batches,
+		ev.generated - ev.received,
+		ev.received * 1000000000ULL / (ev.last_ns > start ?
+						ev.last_ns - start : 1));
+	/* Losses are only all counted when the kernel numbers the events */
+	if (ev.error || stats.events != (unsigned long long)ev.received ||
+			ev.received + stats.overflows != ev.last_sequence ||
+			ev.last_sequence > (unsigned int)ev.generated) {
+		fprintf(stderr, "Events do not match the %d edges generated\n",
+			ev.generated);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	ret = mockup_watch(gpio, chip, 2, MOCKUP_DEBOUNCE_US, &ev, &stats);
+	if (ret != S_OK)
+		goto exit;
+
+	fprintf(stdout, "Debounce: %d edges, %d events, %llu filtered\n",
+		ev.generated, ev.received, stats.filtered);
+	if (ev.error || ev.received != MOCKUP_PRESSES ||
+			stats.filtered != (MOCKUP_BOUNCES - 1) *
+						MOCKUP_PRESSES) {
+		fprintf(stderr, "Expected one event per press\n");
+		ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, ret == S_OK ? "succeeded" :
+								"failed");
+
+	artik_release_api_module(gpio);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = S_OK;
 	int platid = artik_get_platform();
+	int chip = find_mockup_chip();
+
+	if (chip >= 0) {
+		ret = test_mockup_toggle(chip);
+		if (ret == S_OK)
+			ret = test_mockup_events(chip);
+		goto exit;
+	}
 
 	if ((platid == ARTIK520) || (platid == ARTIK1020) ||
 			(platid == ARTIK710) || (platid == ARTIK530) ||
@@ -19,6 +19,8 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
 
 #include <artik_module.h>
 #include <artik_platform.h>
@@ -271,10 +273,159 @@ exit:
 	return ret;
 }
 
+/*
+ * Register file tests on the i2c-stub driver, loaded with:
+ *   modprobe i2c-stub chip_addr=0x50,0x51
+ */
+#define STUB_ADAPTER_NAME	"SMBus stub driver"
+#define STUB_ADDR_A		0x50
+#define STUB_ADDR_B		0x51
+#define STUB_POLL_COUNT		1000
+
+static int find_stub_adapter(void)
+{
+	char path[64], name[64];
+	int id;
+
+	for (id = 0; id < 256; id++) {
+		FILE *f;
+
+		snprintf(path, sizeof(path),
+			"/sys/class/i2c-adapter/i2c-%d/name", id);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+		if (fgets(name, sizeof(name), f) && !strncmp(name,
+				STUB_ADAPTER_NAME, strlen(STUB_ADAPTER_NAME))) {
+			fclose(f);
+			return id;
+		}
+		fclose(f);
+	}
+
+	return -1;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void set_msg(artik_i2c_msg *msg, artik_i2c_msg_type type,
+		unsigned char address, unsigned int reg, char *buf, int len)
+{
+	msg->type = type;
+	msg->address = address;
+	msg->reg = reg;
+	msg->buffer = buf;
+	msg->len = len;
+}
+
+static artik_error i2c_test_stub(int id)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+						artik_request_api_module("i2c");
+	artik_i2c_config stub_config = { id, 100000, I2C_8BIT, STUB_ADDR_A };
+	artik_i2c_handle stub;
+	artik_i2c_msg msgs[3];
+	char accel[6] = { 1, 2, 3, 4, 5, 6 }, gyro[6] = { 7, 8, 9, 10, 11, 12 };
+	char temp[2] = { 0x55, 0x2a };
+	char rd_accel[6], rd_gyro[6], rd_temp[2];
+	uint64_t start, single_ns, batch_ns;
+	artik_error ret;
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+	ret = i2c->request(&stub, &stub_config);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request I2C %d@0x%02x (%d)\n",
+			stub_config.id, stub_config.address, ret);
+		goto exit;
+	}
+
+	/* Registers of two chips written in one transaction */
+	set_msg(&msgs[0], I2C_MSG_WRITE_REGISTER, STUB_ADDR_A, 0x10, accel, 6);
+	set_msg(&msgs[1], I2C_MSG_WRITE_REGISTER, STUB_ADDR_A, 0x20, gyro, 6);
+	set_msg(&msgs[2], I2C_MSG_WRITE_REGISTER, STUB_ADDR_B, 0x30, temp, 2);
+	ret = i2c->transfer(stub, msgs, 3);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to write registers (%d)\n", ret);
+		goto release;
+	}
+
+	set_msg(&msgs[0], I2C_MSG_READ_REGISTER, STUB_ADDR_A, 0x10, rd_accel,
+		6);
+	set_msg(&msgs[1], I2C_MSG_READ_REGISTER, STUB_ADDR_A, 0x20, rd_gyro, 6);
+	set_msg(&msgs[2], I2C_MSG_READ_REGISTER, STUB_ADDR_B, 0x30, rd_temp, 2);
+	ret = i2c->transfer(stub, msgs, 3);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to read registers (%d)\n", ret);
+		goto release;
+	}
+
+	if (memcmp(accel, rd_accel, 6) || memcmp(gyro, rd_gyro, 6) ||
+	    memcmp(temp, rd_temp, 2)) {
+		fprintf(stderr, "Registers read back do not match\n");
+		ret = E_INVALID_VALUE;
+		goto release;
+	}
+
+	/* Single accesses go through the same file descriptor */
+	ret = i2c->read_register(stub, 0x13, rd_accel, 1);
+	if (ret != S_OK || rd_accel[0] != accel[3]) {
+		fprintf(stderr, "Failed to read single register (%d)\n", ret);
+		ret = ret != S_OK ? ret : E_INVALID_VALUE;
+		goto release;
+	}
+
+	start = now_ns();
+	for (i = 0; i < STUB_POLL_COUNT && ret == S_OK; i++) {
+		ret = i2c->read_register(stub, 0x10, rd_accel, 6);
+		if (ret == S_OK)
+			ret = i2c->read_register(stub, 0x20, rd_gyro, 6);
+	}
+	single_ns = (now_ns() - start) / STUB_POLL_COUNT;
+
+	start = now_ns();
+	for (i = 0; i < STUB_POLL_COUNT && ret == S_OK; i++)
+		ret = i2c->transfer(stub, msgs, 2);
+	batch_ns = (now_ns() - start) / STUB_POLL_COUNT;
+
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to poll registers (%d)\n", ret);
+		goto release;
+	}
+
+	fprintf(stdout, "BENCH: 2 register reads, single %llu ns, "
+		"batched %llu ns\n", (unsigned long long)single_ns,
+		(unsigned long long)batch_ns);
+
+release:
+	if (i2c->release(stub) != S_OK) {
+		fprintf(stderr, "Failed to release I2C %d@0x%02x\n",
+			stub_config.id, stub_config.address);
+	}
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+
+	artik_release_api_module(i2c);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = E_NOT_SUPPORTED;
 	int platid = artik_get_platform();
+	int stub_id = find_stub_adapter();
+
+	if (stub_id >= 0)
+		return (i2c_test_stub(stub_id) == S_OK) ? 0 : -1;
 
 	bind_driver(platid, false);
 
@@ -0,0 +1,256 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <artik_list.h>
+#include <artik_indexed_list.h>
+
+/*
+ * Compares artik_list and artik_indexed_list for the add, get by handle
+ * and delete by handle operations the modules perform on their handles,
+ * at several list sizes. The linear list is skipped at 100k nodes where
+ * a single pass takes minutes.
+ */
+
+#define MAX_LINEAR_NODES	10000
+
+typedef struct {
+	artik_list node;
+	int value;
+} bench_node;
+
+struct bench_result {
+	uint64_t add;
+	uint64_t get;
+	uint64_t del;
+};
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void shuffle(ARTIK_LIST_HANDLE *handles, int num)
+{
+	int i;
+
+	for (i = num - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		ARTIK_LIST_HANDLE tmp = handles[i];
+
+		handles[i] = handles[j];
+		handles[j] = tmp;
+	}
+}
+
+static artik_error bench_linear(ARTIK_LIST_HANDLE *handles, int num,
+				struct bench_result *res)
+{
+	artik_list *list = NULL;
+	uint64_t start;
+	int i;
+
+	start = now_nsec();
+	for (i = 0; i < num; i++) {
+		bench_node *node = (bench_node *)artik_list_add(&list, 0,
+							sizeof(bench_node));
+
+		if (!node)
+			return E_NO_MEM;
+		node->value = i;
+		handles[i] = node->node.handle;
+	}
+	res->add = now_nsec() - start;
+
+	shuffle(handles, num);
+
+	start = now_nsec();
+	for (i = 0; i < num; i++)
+		if (!artik_list_get_by_handle(list, handles[i]))
+			return E_BAD_ARGS;
+	res->get = now_nsec() - start;
+
+	start = now_nsec();
+	for (i = 0; i < num; i++)
+		if (artik_list_delete_handle(&list, handles[i]) != S_OK)
+			return E_BAD_ARGS;
+	res->del = now_nsec() - start;
+
+	return list ? E_BAD_ARGS : S_OK;
+}
+
+static artik_error bench_indexed(ARTIK_LIST_HANDLE *handles, int num,
+				struct bench_result *res)
+{
+	artik_indexed_list list;
+	uint64_t start;
+	int i;
+
+	memset(&list, 0, sizeof(list));
+
+	start = now_nsec();
+	for (i = 0; i < num; i++) {
+		bench_node *node = (bench_node *)artik_indexed_list_add(&list,
+						0, sizeof(bench_node));
+
+		if (!node)
+			return E_NO_MEM;
+		node->value = i;
+		handles[i] = node->node.handle;
+	}
+	res->add = now_nsec() - start;
+
+	shuffle(handles, num);
+
+	start = now_nsec();
+	for (i = 0; i < num; i++) {
+		bench_node *node = (bench_node *)
+			artik_indexed_list_get_by_handle(&list, handles[i]);
+
+		/* Nodes must not have moved while the list grew */
+		if (!node || ((ARTIK_LIST_HANDLE)node != handles[i]))
+			return E_BAD_ARGS;
+	}
+	res->get = now_nsec() - start;
+
+	start = now_nsec();
+	for (i = 0; i < num; i++)
+		if (artik_indexed_list_delete_handle(&list, handles[i]) !=
+									S_OK)
+			return E_BAD_ARGS;
+	res->del = now_nsec() - start;
+
+	return artik_indexed_list_size(&list) ? E_BAD_ARGS : S_OK;
+}
+
+static artik_error test_indexed_list(void)
+{
+	artik_indexed_list list;
+	artik_list *elem;
+	bench_node *nodes[64];
+	int i, expected = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	memset(&list, 0, sizeof(list));
+
+	for (i = 0; i < 64; i++) {
+		nodes[i] = (bench_node *)artik_indexed_list_add(&list,
+				(ARTIK_LIST_HANDLE)(intptr_t)(i + 1),
+				sizeof(bench_node));
+		if (!nodes[i])
+			goto fail;
+		nodes[i]->value = i;
+	}
+
+	/* Handles are unique and the node size is fixed */
+	if (artik_indexed_list_add(&list, (ARTIK_LIST_HANDLE)1,
+					sizeof(bench_node)) ||
+	    artik_indexed_list_add(&list, 0, sizeof(bench_node) + 8))
+		goto fail;
+
+	/* Delete every other node, the others must keep their order */
+	for (i = 0; i < 64; i += 2)
+		if (artik_indexed_list_delete_node(&list,
+					(artik_list *)nodes[i]) != S_OK)
+			goto fail;
+
+	if ((artik_indexed_list_size(&list) != 32) ||
+	    artik_indexed_list_get_by_handle(&list, (ARTIK_LIST_HANDLE)1))
+		goto fail;
+
+	for (elem = artik_indexed_list_first(&list); elem; elem = elem->next) {
+		expected++;
+		if (((bench_node *)elem)->value != expected++)
+			goto fail;
+	}
+
+	for (i = 1; i < 64; i += 2)
+		if (artik_indexed_list_get_by_handle(&list,
+			(ARTIK_LIST_HANDLE)(intptr_t)(i + 1)) !=
+						(artik_list *)nodes[i])
+			goto fail;
+
+	if (artik_indexed_list_delete_all(&list) != S_OK ||
+	    artik_indexed_list_first(&list))
+		goto fail;
+
+	fprintf(stdout, "TEST: %s succeeded\n", __func__);
+	return S_OK;
+
+fail:
+	artik_indexed_list_delete_all(&list);
+	fprintf(stdout, "TEST: %s failed\n", __func__);
+	return E_BAD_ARGS;
+}
+
+static void print_result(const char *name, int num, struct bench_result *res)
+{
+	fprintf(stdout,
+		"BENCH: %-8s %6d nodes: add %8.1f get %8.1f delete %8.1f nsec/op\n",
+		name, num, (double)res->add / num, (double)res->get / num,
+		(double)res->del / num);
+}
+
+int main(int argc, char *argv[])
+{
+	int sizes[] = { 10, 1000, 100000 };
+	ARTIK_LIST_HANDLE *handles;
+	struct bench_result res;
+	artik_error ret;
+	unsigned int i;
+
+	ret = test_indexed_list();
+	if (ret != S_OK)
+		return -1;
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		handles = malloc(sizes[i] * sizeof(ARTIK_LIST_HANDLE));
+		if (!handles)
+			return -1;
+
+		if (sizes[i] <= MAX_LINEAR_NODES) {
+			ret = bench_linear(handles, sizes[i], &res);
+			if (ret != S_OK) {
+				free(handles);
+				break;
+			}
+			print_result("list", sizes[i], &res);
+		}
+
+		ret = bench_indexed(handles, sizes[i], &res);
+		free(handles);
+		if (ret != S_OK)
+			break;
+		print_result("indexed", sizes[i], &res);
+	}
+
+	fprintf(stdout, "TEST: benchmark %s\n",
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return (ret == S_OK) ? 0 : -1;
+}
@@ -0,0 +1,236 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+/* Keep all the log_* macros whatever the build type */
+#undef CONFIG_ARTIK_LOG_MIN_LEVEL
+#define CONFIG_ARTIK_LOG_MIN_LEVEL	3
+
+#include <artik_module.h>
+#include <artik_log.h>
+
+/*
+ * Measures the cost of a log_dbg() call for the caller when the message
+ * is removed at compile time, filtered at runtime, written synchronously,
+ * queued to the asynchronous backend and stored as a binary record. stderr
+ * is redirected to /dev/null unless "-v" is passed so that only the SDK
+ * overhead is measured.
+ */
+
+#define DEFAULT_ITERATIONS	200000
+#define NUM_THREADS		4
+#define BURST_SIZE		256
+
+#define log_dbg_disabled(...)
+
+struct bench_thread {
+	int iterations;
+	uint64_t elapsed;
+};
+
+static void on_binary(const void *data, size_t len, void *user_data)
+{
+	*(uint64_t *)user_data += len;
+}
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t run_disabled(int iterations)
+{
+	uint64_t start = now_nsec();
+	int i;
+
+	for (i = 0; i < iterations; i++) {
+		log_dbg_disabled("message %d value %s", i, "text");
+		__asm__ __volatile__("" ::: "memory");
+	}
+
+	return now_nsec() - start;
+}
+
+static uint64_t run_enabled(int iterations)
+{
+	uint64_t start = now_nsec();
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		log_dbg("message %d value %s", i, "text");
+
+	return now_nsec() - start;
+}
+
+/*
+ * Log bursts smaller than the asynchronous ring and wait for the writer
+ * between them, out of the measurement, so that only the cost of queuing
+ * a message is measured and nothing is dropped.
+ */
+static uint64_t run_bursts(artik_log_module *log, int iterations)
+{
+	uint64_t elapsed = 0;
+	int done;
+
+	for (done = 0; done < iterations; done += BURST_SIZE) {
+		int count = iterations - done;
+
+		if (count > BURST_SIZE)
+			count = BURST_SIZE;
+		elapsed += run_enabled(count);
+		log->flush();
+	}
+
+	return elapsed;
+}
+
+static void *bench_thread_func(void *user_data)
+{
+	struct bench_thread *thread = (struct bench_thread *)user_data;
+
+	thread->elapsed = run_enabled(thread->iterations);
+
+	return NULL;
+}
+
+static uint64_t run_threads(int iterations)
+{
+	struct bench_thread threads[NUM_THREADS];
+	pthread_t ids[NUM_THREADS];
+	uint64_t total = 0;
+	int i;
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		threads[i].iterations = iterations / NUM_THREADS;
+		pthread_create(&ids[i], NULL, bench_thread_func, &threads[i]);
+	}
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		pthread_join(ids[i], NULL);
+		total += threads[i].elapsed;
+	}
+
+	return total;
+}
+
+static void print_result(artik_log_module *log, const char *name,
+			uint64_t elapsed, int iterations)
+{
+	static uint64_t last_dropped;
+	artik_log_stats stats;
+
+	log->get_stats(&stats);
+	fprintf(stdout, "BENCH: %-34s %8.1f nsec/call, %llu dropped\n", name,
+		(double)elapsed / iterations,
+		(unsigned long long)(stats.dropped - last_dropped));
+	last_dropped = stats.dropped;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_log_module *log = (artik_log_module *)
+					artik_request_api_module("log");
+	int iterations = DEFAULT_ITERATIONS;
+	artik_log_stats stats;
+	uint64_t binary_bytes = 0;
+	uint64_t start;
+	int i;
+
+	if (!log) {
+		fprintf(stdout, "TEST: Log module is not available\n");
+		return -1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-v"))
+			continue;
+		iterations = atoi(argv[i]);
+	}
+
+	for (i = 1; i < argc; i++)
+		if (!strcmp(argv[i], "-v"))
+			break;
+	if (i == argc && !freopen("/dev/null", "w", stderr)) {
+		fprintf(stdout, "TEST: failed to redirect stderr\n");
+		return -1;
+	}
+
+	print_result(log, "compiled out", run_disabled(iterations), iterations);
+
+	log->set_level(LOG_LEVEL_ERROR);
+	print_result(log, "filtered by level", run_enabled(iterations),
+		iterations);
+
+	log->set_module_level("websocket", LOG_LEVEL_DEBUG);
+	print_result(log, "filtered by level, module levels set",
+		run_enabled(iterations), iterations);
+	log->set_module_level("log_test", LOG_LEVEL_DEBUG);
+	print_result(log, "enabled by module level, sync",
+		run_enabled(iterations), iterations);
+	log->set_module_level("log_test", -1);
+	log->set_module_level("websocket", -1);
+
+	log->set_level(LOG_LEVEL_DEBUG);
+	print_result(log, "sync", run_enabled(iterations), iterations);
+	print_result(log, "sync, 4 threads", run_threads(iterations),
+		iterations);
+
+	log->set_async(true);
+	print_result(log, "async", run_bursts(log, iterations), iterations);
+	print_result(log, "async, no pause", run_enabled(iterations),
+		iterations);
+	start = now_nsec();
+	log->flush();
+	fprintf(stdout, "BENCH: %-34s %8llu usec\n", "async, flush",
+		(unsigned long long)(now_nsec() - start) / 1000);
+	print_result(log, "async, 4 threads", run_threads(iterations),
+		iterations);
+	log->flush();
+
+	log->set_binary_handler(on_binary, &binary_bytes);
+	print_result(log, "binary", run_bursts(log, iterations), iterations);
+	print_result(log, "binary, no pause", run_enabled(iterations),
+		iterations);
+	print_result(log, "binary, 4 threads", run_threads(iterations),
+		iterations);
+	log->flush();
+	fprintf(stdout, "BENCH: binary stream %llu bytes\n",
+		(unsigned long long)binary_bytes);
+	log->set_system(LOG_SYSTEM_STDERR);
+	log->set_async(false);
+
+	log->get_stats(&stats);
+	fprintf(stdout, "BENCH: logged %llu, dropped %llu, truncated %llu\n",
+		(unsigned long long)stats.logged,
+		(unsigned long long)stats.dropped,
+		(unsigned long long)stats.truncated);
+
+	artik_release_api_module(log);
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <artik_module.h>
+#include <artik_log.h>
+
+/*
+ * Formats a binary log stream, as written by a program running with
+ * ARTIK_LOG=binary (e.g. "ARTIK_LOG=binary ./app 2> app.bin"), to stdout.
+ *
+ * Usage: log-decode [file]   reads stdin when no file is given
+ */
+
+static void on_message(enum artik_log_level level, const char *prefix,
+			const char *msg, void *user_data)
+{
+	if (prefix && *prefix)
+		fprintf(stdout, "%s %s\n", prefix, msg);
+	else
+		fprintf(stdout, "%s\n", msg);
+}
+
+static unsigned char *read_all(FILE *file, size_t *len)
+{
+	unsigned char *data = NULL;
+	size_t size = 0;
+
+	*len = 0;
+	while (!feof(file) && !ferror(file)) {
+		if (*len == size) {
+			unsigned char *tmp;
+
+			size = size ? size * 2 : 65536;
+			tmp = realloc(data, size);
+			if (!tmp) {
+				free(data);
+				return NULL;
+			}
+			data = tmp;
+		}
+		*len += fread(data + *len, 1, size - *len, file);
+	}
+
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_log_module *log = (artik_log_module *)
+					artik_request_api_module("log");
+	FILE *file = stdin;
+	unsigned char *data;
+	artik_error ret;
+	size_t len;
+
+	if (!log) {
+		fprintf(stderr, "Log module is not available\n");
+		return -1;
+	}
+
+	if (argc > 1) {
+		file = fopen(argv[1], "rb");
+		if (!file) {
+			fprintf(stderr, "Cannot open %s\n", argv[1]);
+			return -1;
+		}
+	}
+
+	data = read_all(file, &len);
+	if (file != stdin)
+		fclose(file);
+	if (!data && len) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+
+	ret = log->decode_binary(data ? data : (unsigned char *)"", len,
+				on_message, NULL);
+	if (ret != S_OK)
+		fprintf(stderr, "Malformed log stream (%s)\n",
+			error_msg(ret));
+
+	free(data);
+	artik_release_api_module(log);
+
+	return (ret == S_OK) ? 0 : -1;
+}
@@ -0,0 +1,256 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#undef CONFIG_ARTIK_LOG_MIN_LEVEL
+#define CONFIG_ARTIK_LOG_MIN_LEVEL	3
+
+#include <artik_module.h>
+#include <artik_log.h>
+#include <artik_gpio.h>
+
+#define MAX_MESSAGES	64
+
+struct stream {
+	unsigned char *data;
+	size_t len;
+};
+
+struct decoded {
+	int count;
+	char messages[MAX_MESSAGES][512];
+	enum artik_log_level levels[MAX_MESSAGES];
+};
+
+static char expected[MAX_MESSAGES][512];
+static int num_expected;
+
+static void on_binary(const void *data, size_t len, void *user_data)
+{
+	struct stream *stream = (struct stream *)user_data;
+	unsigned char *tmp = realloc(stream->data, stream->len + len);
+
+	if (!tmp)
+		return;
+
+	memcpy(tmp + stream->len, data, len);
+	stream->data = tmp;
+	stream->len += len;
+}
+
+static void on_message(enum artik_log_level level, const char *prefix,
+			const char *msg, void *user_data)
+{
+	struct decoded *decoded = (struct decoded *)user_data;
+
+	if (decoded->count >= MAX_MESSAGES)
+		return;
+
+	decoded->levels[decoded->count] = level;
+	strncpy(decoded->messages[decoded->count], msg, 511);
+	decoded->count++;
+}
+
+static void expect(const char *format, ...)
+{
+	va_list arg;
+
+	va_start(arg, format);
+	vsnprintf(expected[num_expected++], 512, format, arg);
+	va_end(arg);
+}
+
+#define log_and_expect(...) do { \
+		log_info(__VA_ARGS__); \
+		expect(__VA_ARGS__); \
+	} while (0)
+
+static artik_error test_binary_round_trip(artik_log_module *log)
+{
+	struct stream stream = { NULL, 0 };
+	struct decoded decoded;
+	artik_error ret;
+	long long big = -1234567890123LL;
+	const char *null_str = NULL;
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = log->set_binary_handler(on_binary, &stream);
+	if (ret != S_OK)
+		goto exit;
+
+	log_and_expect("no argument");
+	log_and_expect("int %d unsigned %u hex %#x char %c", -42, 42u, 255,
+			'z');
+	log_and_expect("long %ld long long %lld size %zu", -7L, big,
+			(size_t)123456);
+	log_and_expect("short %hd byte %hhu", (short)-300,
+			(unsigned char)250);
+	log_and_expect("double %f %.3e %g", 3.14159, 0.000123, 1e10);
+	log_and_expect("string '%s' '%10s' '%-6s|' '%.3s'", "abc", "right",
+			"left", "truncate");
+	log_and_expect("star '%*d' '%-*d' '%.*s'", 6, 12, 4, 7, 2, "xyz");
+	log_and_expect("percent 100%% pointer %p", (void *)0x1234);
+	log_and_expect("null string %s", null_str);
+	for (i = 0; i < 8; i++)
+		log_and_expect("loop %d of %d", i, 8);
+	log_dbg("debug %d", 1);
+	expect("debug %d", 1);
+
+	log->flush();
+	log->set_system(LOG_SYSTEM_STDERR);
+
+	memset(&decoded, 0, sizeof(decoded));
+	ret = log->decode_binary(stream.data, stream.len, on_message,
+				&decoded);
+	if (ret != S_OK) {
+		fprintf(stdout, "TEST: failed to decode %zu bytes (%d)\n",
+			stream.len, ret);
+		goto exit;
+	}
+
+	if (decoded.count != num_expected) {
+		fprintf(stdout, "TEST: decoded %d messages, expected %d\n",
+			decoded.count, num_expected);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	for (i = 0; i < num_expected; i++) {
+		if (strcmp(decoded.messages[i], expected[i])) {
+			fprintf(stdout, "TEST: got \"%s\", expected \"%s\"\n",
+				decoded.messages[i], expected[i]);
+			ret = E_INVALID_VALUE;
+			goto exit;
+		}
+	}
+
+	if (decoded.levels[num_expected - 1] != LOG_LEVEL_DEBUG ||
+			decoded.levels[0] != LOG_LEVEL_INFO) {
+		fprintf(stdout, "TEST: wrong levels\n");
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	/* A corrupted stream must be rejected */
+	if (stream.len > 8) {
+		stream.data[0] = 0;
+		stream.data[1] = 0;
+		if (log->decode_binary(stream.data, stream.len, on_message,
+					&decoded) == S_OK) {
+			fprintf(stdout, "TEST: corrupted stream decoded\n");
+			ret = E_INVALID_VALUE;
+		}
+	}
+
+exit:
+	free(stream.data);
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+/*
+ * Records logged by a module hold pointers to its strings, they must be
+ * written before the module is unloaded.
+ */
+static artik_error test_binary_module_release(artik_log_module *log)
+{
+	struct stream stream = { NULL, 0 };
+	struct decoded decoded;
+	artik_gpio_module *gpio;
+	artik_gpio_handle handle;
+	artik_gpio_config config;
+	artik_error ret;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	gpio = (artik_gpio_module *)artik_request_api_module("gpio");
+	if (!gpio) {
+		fprintf(stdout, "TEST: GPIO module is not available\n");
+		ret = S_OK;
+		goto exit;
+	}
+
+	ret = log->set_binary_handler(on_binary, &stream);
+	if (ret != S_OK) {
+		artik_release_api_module(gpio);
+		goto exit;
+	}
+
+	/* Rejected after logging from the module */
+	memset(&config, 0, sizeof(config));
+	config.id = -1;
+	gpio->request(&handle, &config);
+	artik_release_api_module(gpio);
+
+	log->flush();
+	log->set_system(LOG_SYSTEM_STDERR);
+
+	memset(&decoded, 0, sizeof(decoded));
+	ret = log->decode_binary(stream.data, stream.len, on_message,
+				&decoded);
+	if (ret != S_OK) {
+		fprintf(stdout, "TEST: failed to decode %zu bytes (%d)\n",
+			stream.len, ret);
+		goto exit;
+	}
+
+#ifndef CONFIG_RELEASE
+	/* Debug messages are compiled out of release libraries */
+	if (decoded.count < 1 || decoded.levels[0] != LOG_LEVEL_DEBUG) {
+		fprintf(stdout, "TEST: message of the module is missing\n");
+		ret = E_INVALID_VALUE;
+	}
+#endif
+
+exit:
+	free(stream.data);
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return ret;
+}
+
+int main(void)
+{
+	artik_log_module *log = (artik_log_module *)
+					artik_request_api_module("log");
+	artik_error ret;
+
+	if (!log) {
+		fprintf(stdout, "TEST: Log module is not available\n");
+		return -1;
+	}
+
+	ret = test_binary_round_trip(log);
+	if (ret == S_OK)
+		ret = test_binary_module_release(log);
+
+	log->set_async(false);
+	artik_release_api_module(log);
+
+	return (ret == S_OK) ? 0 : -1;
+}
@@ -0,0 +1,242 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+
+#include <artik_module.h>
+#include <artik_platform.h>
+#include <artik_loop.h>
+
+/*
+ * Measures the wake up latency of the loop with a large number of watched
+ * file descriptors. A writer thread signals a random eventfd among the
+ * watched ones and the latency is measured until the matching watch
+ * callback runs. Build the SDK with and without LOOP_BACKEND_EPOLL to
+ * compare the backends.
+ */
+
+#define DEFAULT_ITERATIONS	2000
+
+struct bench_context {
+	artik_loop_module *loop;
+	int *fds;
+	int num_fds;
+	int iterations;
+	int count;
+	uint64_t *latencies;
+	volatile uint64_t sent_at;
+	sem_t done;
+};
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cpu_usec(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+		1000000ULL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static int on_fd_ready(int fd, enum watch_io io, void *user_data)
+{
+	struct bench_context *ctx = (struct bench_context *)user_data;
+	uint64_t value;
+
+	if (read(fd, &value, sizeof(value)) < 0)
+		return 1;
+
+	ctx->latencies[ctx->count++] = now_nsec() - ctx->sent_at;
+	if (ctx->count == ctx->iterations)
+		ctx->loop->quit();
+
+	sem_post(&ctx->done);
+
+	return 1;
+}
+
+static void *writer_thread(void *user_data)
+{
+	struct bench_context *ctx = (struct bench_context *)user_data;
+	uint64_t one = 1;
+	int i;
+
+	for (i = 0; i < ctx->iterations; i++) {
+		int fd = ctx->fds[rand() % ctx->num_fds];
+
+		/* Let the loop go back to sleep before the next wake up */
+		usleep(200);
+		ctx->sent_at = now_nsec();
+		if (write(fd, &one, sizeof(one)) < 0)
+			break;
+		sem_wait(&ctx->done);
+	}
+
+	return NULL;
+}
+
+static artik_error bench_loop(artik_loop_module *loop, int num_fds,
+			int iterations)
+{
+	struct bench_context ctx;
+	struct rlimit limit;
+	pthread_t thread;
+	uint64_t start, cpu_start, wall, cpu, sum = 0;
+	int *ids = NULL;
+	artik_error ret = S_OK;
+	int i;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.loop = loop;
+	ctx.num_fds = num_fds;
+	ctx.iterations = iterations;
+	sem_init(&ctx.done, 0, 0);
+
+	getrlimit(RLIMIT_NOFILE, &limit);
+	if (limit.rlim_cur < (rlim_t)num_fds + 256) {
+		limit.rlim_cur = num_fds + 256;
+		if (limit.rlim_max < limit.rlim_cur)
+			limit.rlim_max = limit.rlim_cur;
+		if (setrlimit(RLIMIT_NOFILE, &limit) < 0)
+			fprintf(stdout, "BENCH: could not raise fd limit (%d)\n",
+				errno);
+	}
+
+	ctx.fds = calloc(num_fds, sizeof(int));
+	ids = calloc(num_fds, sizeof(int));
+	ctx.latencies = calloc(iterations, sizeof(uint64_t));
+	if (!ctx.fds || !ids || !ctx.latencies) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+
+	for (i = 0; i < num_fds; i++)
+		ctx.fds[i] = -1;
+
+	for (i = 0; i < num_fds; i++) {
+		ctx.fds[i] = eventfd(0, EFD_NONBLOCK);
+		if (ctx.fds[i] < 0) {
+			fprintf(stdout, "BENCH: failed to create fd #%d\n", i);
+			ret = E_NO_MEM;
+			goto exit;
+		}
+
+		ret = loop->add_fd_watch(ctx.fds[i], WATCH_IO_IN, on_fd_ready,
+					&ctx, &ids[i]);
+		if (ret != S_OK)
+			goto exit;
+	}
+
+	start = now_nsec();
+	cpu_start = cpu_usec();
+	pthread_create(&thread, NULL, writer_thread, &ctx);
+	loop->run();
+	pthread_join(thread, NULL);
+	wall = (now_nsec() - start) / 1000;
+	cpu = cpu_usec() - cpu_start;
+
+	if (ctx.count == 0) {
+		ret = E_TIMEOUT;
+		goto exit;
+	}
+
+	qsort(ctx.latencies, ctx.count, sizeof(uint64_t), compare_u64);
+	for (i = 0; i < ctx.count; i++)
+		sum += ctx.latencies[i];
+
+	fprintf(stdout,
+		"BENCH: %6d fds, %d wakeups: latency min %llu avg %llu p99 %llu max %llu nsec, cpu %.1f%%\n",
+		num_fds, ctx.count,
+		(unsigned long long)ctx.latencies[0],
+		(unsigned long long)(sum / ctx.count),
+		(unsigned long long)ctx.latencies[(ctx.count * 99) / 100],
+		(unsigned long long)ctx.latencies[ctx.count - 1],
+		wall ? (100.0 * cpu) / wall : 0.0);
+
+exit:
+	for (i = 0; ctx.fds && ids && (i < num_fds); i++) {
+		if (ids[i])
+			loop->remove_fd_watch(ids[i]);
+		if (ctx.fds[i] >= 0)
+			close(ctx.fds[i]);
+	}
+	free(ctx.fds);
+	free(ids);
+	free(ctx.latencies);
+	sem_destroy(&ctx.done);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_loop_module *loop;
+	artik_error ret = S_OK;
+	int iterations = DEFAULT_ITERATIONS;
+	int sizes[] = { 1000, 10000 };
+	unsigned int i;
+
+	if (!artik_is_module_available(ARTIK_MODULE_LOOP)) {
+		fprintf(stdout,
+			"TEST: Loop module is not available,"\
+			" skipping test...\n");
+		return -1;
+	}
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+
+	loop = (artik_loop_module *)artik_request_api_module("loop");
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		ret = bench_loop(loop, sizes[i], iterations);
+		if (ret != S_OK)
+			break;
+	}
+
+	artik_release_api_module(loop);
+
+	return (ret == S_OK) ? 0 : -1;
+}
@@ -17,6 +17,9 @@
  */
 
 #include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include <artik_module.h>
 #include <artik_platform.h>
@@ -90,6 +93,167 @@ exit:
 	return ret;
 }
 
+static void on_slow_callback(void *user_data)
+{
+	artik_loop_module *loop = (artik_loop_module *) user_data;
+
+	/* Simulate a callback blocking the loop beyond its budget */
+	usleep(20000);
+	loop->quit();
+}
+
+artik_error test_loop_stats(void)
+{
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_loop_callback_stats cb_stats[8];
+	artik_loop_stats stats;
+	artik_error ret = S_OK;
+	int num = 8;
+	int id = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	loop->reset_stats();
+	ret = loop->enable_stats(true, 10000);
+	if (ret != S_OK)
+		goto exit;
+
+	ret = loop->add_timeout_callback(&id, 100, on_slow_callback,
+				   (void *)loop);
+	if (ret != S_OK)
+		goto exit;
+
+	loop->run();
+
+	ret = loop->get_stats(&stats);
+	if (ret != S_OK)
+		goto exit;
+
+	if ((stats.dispatch_count < 1) || (stats.over_budget_count < 1) ||
+			(stats.max_usec < 20000) || (stats.lag_count < 1)) {
+		fprintf(stdout, "TEST: %s unexpected statistics\n", __func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	ret = loop->get_callback_stats(cb_stats, &num);
+	if (ret != S_OK)
+		goto exit;
+
+	if ((num != 1) ||
+			(cb_stats[0].func != (loop_callback)on_slow_callback) ||
+			(cb_stats[0].type != LOOP_SOURCE_TIMEOUT)) {
+		fprintf(stdout, "TEST: %s unexpected callback statistics\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	loop->dump_stats();
+
+exit:
+	loop->enable_stats(false, 0);
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ?
+			"succeeded" : "failed");
+	artik_release_api_module(loop);
+	return ret;
+}
+
+static int late_count;
+
+static int on_late_stats_callback(void *user_data)
+{
+	artik_loop_module *loop = (artik_loop_module *) user_data;
+
+	late_count++;
+	if (late_count == 3) {
+		/* Start measuring a periodic that already ran */
+		loop->reset_stats();
+		loop->enable_stats(true, 0);
+	} else if (late_count == 5) {
+		loop->quit();
+		return 0;
+	}
+
+	return 1;
+}
+
+artik_error test_loop_stats_late(void)
+{
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_loop_stats stats;
+	artik_error ret = S_OK;
+	int id = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	loop->enable_stats(false, 0);
+	ret = loop->add_periodic_callback(&id, 100, on_late_stats_callback,
+				   (void *)loop);
+	if (ret != S_OK)
+		goto exit;
+
+	loop->run();
+
+	ret = loop->get_stats(&stats);
+	if (ret != S_OK)
+		goto exit;
+
+	/* The lag must not include the periods run before enabling */
+	if ((stats.lag_count < 1) || (stats.max_lag_usec >= 100000)) {
+		fprintf(stdout, "TEST: %s lag of %llu usec\n", __func__,
+			(unsigned long long)stats.max_lag_usec);
+		ret = E_INVALID_VALUE;
+	}
+
+exit:
+	loop->enable_stats(false, 0);
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ?
+			"succeeded" : "failed");
+	artik_release_api_module(loop);
+	return ret;
+}
+
+static int on_signal_callback(void *user_data)
+{
+	return 1;
+}
+
+artik_error test_loop_signal_mask(void)
+{
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_error ret = S_OK;
+	sigset_t mask;
+	int id = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = loop->add_signal_watch(SIGHUP, on_signal_callback, NULL, &id);
+	if (ret != S_OK)
+		goto exit;
+
+	ret = loop->remove_signal_watch(id);
+	if (ret != S_OK)
+		goto exit;
+
+	/* The signal must not stay blocked once nobody watches it */
+	pthread_sigmask(SIG_BLOCK, NULL, &mask);
+	if (sigismember(&mask, SIGHUP)) {
+		fprintf(stdout, "TEST: %s SIGHUP is still blocked\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ?
+			"succeeded" : "failed");
+	artik_release_api_module(loop);
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = S_OK;
@@ -106,6 +270,18 @@ int main(void)
 		goto exit;
 
 	ret = test_loop_periodic();
+	if (ret != S_OK)
+		goto exit;
+
+	ret = test_loop_stats();
+	if (ret != S_OK)
+		goto exit;
+
+	ret = test_loop_stats_late();
+	if (ret != S_OK)
+		goto exit;
+
+	ret = test_loop_signal_mask();
 
 exit:
 	return ((ret == S_OK) ? 0 : -1);
@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <artik_module.h>
+#include <artik_platform.h>
+
+/*
+ * Measures artik_request_api_module/artik_release_api_module throughput
+ * from several threads. The "hot" pass keeps a reference on the module
+ * during the run so that only the lock-free path is exercised, the "cold"
+ * pass does not and loads/unloads the module on every iteration when a
+ * single thread is running.
+ */
+
+#define DEFAULT_ITERATIONS	200000
+#define MAX_THREADS		8
+
+struct bench_thread {
+	pthread_t thread;
+	const char *name;
+	int iterations;
+	artik_error ret;
+};
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *bench_thread_func(void *user_data)
+{
+	struct bench_thread *ctx = (struct bench_thread *)user_data;
+	int i;
+
+	for (i = 0; i < ctx->iterations; i++) {
+		artik_module_ops module = artik_request_api_module(ctx->name);
+
+		if (module == INVALID_MODULE) {
+			ctx->ret = E_NOT_SUPPORTED;
+			break;
+		}
+
+		ctx->ret = artik_release_api_module(module);
+		if (ctx->ret != S_OK)
+			break;
+	}
+
+	return NULL;
+}
+
+static artik_error bench_module(const char *name, int num_threads,
+				int iterations, bool hot)
+{
+	struct bench_thread threads[MAX_THREADS];
+	artik_module_ops held = NULL;
+	artik_error ret = S_OK;
+	uint64_t start, elapsed;
+	int i;
+
+	if (hot) {
+		held = artik_request_api_module(name);
+		if (held == INVALID_MODULE)
+			return E_NOT_SUPPORTED;
+	}
+
+	start = now_nsec();
+	for (i = 0; i < num_threads; i++) {
+		threads[i].name = name;
+		threads[i].iterations = iterations;
+		threads[i].ret = S_OK;
+		pthread_create(&threads[i].thread, NULL, bench_thread_func,
+				&threads[i]);
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		if (threads[i].ret != S_OK)
+			ret = threads[i].ret;
+	}
+	elapsed = now_nsec() - start;
+
+	if (held)
+		artik_release_api_module(held);
+
+	if (ret != S_OK)
+		return ret;
+
+	fprintf(stdout,
+		"BENCH: %s %-4s %d thread(s): %.0f request/release per sec, %llu nsec per pair\n",
+		name, hot ? "hot" : "cold", num_threads,
+		(double)num_threads * iterations * 1e9 / elapsed,
+		(unsigned long long)(elapsed / iterations));
+
+	return S_OK;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = "loop";
+	int iterations = DEFAULT_ITERATIONS;
+	artik_error ret = S_OK;
+	int threads;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (argc > 2)
+		name = argv[2];
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	for (threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		ret = bench_module(name, threads, iterations, true);
+		if (ret != S_OK)
+			goto exit;
+	}
+
+	/* Keep the cold pass short, it goes through dlopen/dlclose */
+	ret = bench_module(name, 1, iterations / 10 ? iterations / 10 : 1,
+				false);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	return (ret == S_OK) ? 0 : -1;
+}
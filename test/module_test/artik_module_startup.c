@@ -0,0 +1,130 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include <artik_module.h>
+#include <artik_platform.h>
+
+/*
+ * Measures the time to first artik_request_api_module for every module of
+ * the platform. Each measurement runs in a freshly forked process so that
+ * no library is already mapped. The same measurement is then repeated
+ * after preloading all the modules with artik_preload_modules.
+ */
+
+#define DEFAULT_THREADS		4
+
+static uint64_t now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int first_request(const char *name, int preload_threads)
+{
+	artik_module_ops module;
+	uint64_t start, preload = 0;
+
+	if (preload_threads > 0) {
+		start = now_usec();
+		artik_preload_modules(NULL, 0, preload_threads, NULL);
+		preload = now_usec() - start;
+	}
+
+	start = now_usec();
+	module = artik_request_api_module(name);
+	if (module == INVALID_MODULE) {
+		fprintf(stdout, "BENCH: %-12s failed to load\n", name);
+		return -1;
+	}
+
+	if (preload_threads > 0)
+		fprintf(stdout,
+			"BENCH: %-12s first request %6llu usec after %llu usec preload (%d threads)\n",
+			name, (unsigned long long)(now_usec() - start),
+			(unsigned long long)preload, preload_threads);
+	else
+		fprintf(stdout, "BENCH: %-12s first request %6llu usec\n",
+			name, (unsigned long long)(now_usec() - start));
+
+	artik_release_api_module(module);
+
+	return 0;
+}
+
+static int run_isolated(const char *name, int preload_threads)
+{
+	int status = 0;
+	pid_t pid;
+
+	fflush(stdout);
+	pid = fork();
+	if (pid < 0)
+		return -1;
+
+	if (pid == 0) {
+		status = first_request(name, preload_threads);
+		fflush(stdout);
+		_exit(status ? 1 : 0);
+	}
+
+	if (waitpid(pid, &status, 0) < 0)
+		return -1;
+
+	return (WIFEXITED(status) && !WEXITSTATUS(status)) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_api_module *modules = NULL;
+	int num_modules = 0, threads = DEFAULT_THREADS;
+	int i, ret = 0;
+
+	if (argc > 1)
+		threads = atoi(argv[1]);
+
+	if (artik_get_available_modules(&modules, &num_modules) != S_OK) {
+		fprintf(stdout, "TEST: failed to get available modules\n");
+		return -1;
+	}
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	for (i = 0; i < num_modules; i++)
+		if (run_isolated(modules[i].name, 0) < 0)
+			ret = -1;
+
+	for (i = 0; i < num_modules; i++)
+		if (run_isolated(modules[i].name, threads) < 0)
+			ret = -1;
+
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == 0) ? "succeeded" : "failed");
+
+	return ret;
+}
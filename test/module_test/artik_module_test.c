@@ -181,6 +181,42 @@ artik_error test_api_modules(void)
 	return ret;
 }
 
+/*
+ * Unloaded libraries leave room for the next ones, a module can be loaded
+ * at the address another one had. Each release must still find its module.
+ */
+artik_error test_module_reload(void)
+{
+	artik_api_module *modules = NULL;
+	artik_module_ops ops;
+	int num_modules = 0;
+	artik_error ret = S_OK;
+	int pass, i;
+
+	fprintf(stdout, "TEST: %s\n", __func__);
+
+	ret = artik_get_available_modules(&modules, &num_modules);
+	if (ret != S_OK)
+		return ret;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < num_modules; i++) {
+			ops = artik_request_api_module(modules[i].name);
+			if (!ops || (ops == INVALID_MODULE))
+				continue;
+
+			ret = artik_release_api_module(ops);
+			if (ret != S_OK) {
+				fprintf(stdout, "Failed to release %s (%d)\n",
+					modules[i].name, ret);
+				return ret;
+			}
+		}
+	}
+
+	return S_OK;
+}
+
 artik_error test_device_information(void)
 {
 	char *info = NULL;
@@ -239,6 +275,10 @@ int main(void)
 	if (ret != S_OK)
 		goto exit;
 
+	ret = test_module_reload();
+	if (ret != S_OK)
+		goto exit;
+
 exit:
 	return (ret == S_OK) ? 0 : -1;
 }
@@ -20,11 +20,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <time.h>
 
 #include <artik_module.h>
 #include <artik_platform.h>
+#include <artik_loop.h>
 #include <artik_pwm.h>
 
+#define BENCH_UPDATES	10000
+#define WAVEFORM_STEPS	100
+#define WAVEFORM_STEP_US	1000
+#define WAVEFORM_REPEAT	3
+
 static artik_pwm_config config = {
 	1,
 	"pwm",
@@ -34,13 +42,23 @@ static artik_pwm_config config = {
 	NULL
 };
 
-static artik_error pwm_test_frequency(int platid)
+struct waveform_test {
+	artik_loop_module *loop;
+	artik_error result;
+	int done;
+};
+
+static uint64_t now_usec(void)
 {
-	artik_pwm_handle handle;
-	artik_error ret = S_OK;
-	artik_pwm_module *pwm = (artik_pwm_module *)
-						artik_request_api_module("pwm");
+	struct timespec ts;
 
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void set_pin(int platid)
+{
 	if (platid == ARTIK520)
 		config.pin_num = ARTIK_A520_PWM1;
 	else if (platid == ARTIK1020)
@@ -53,6 +71,16 @@ static artik_error pwm_test_frequency(int platid)
 		config.pin_num = ARTIK_A305_PWM0;
 	else if (platid == EAGLEYE530)
 		config.pin_num = ARTIK_EAGLEYE530_PWM0;
+}
+
+static artik_error pwm_test_frequency(int platid)
+{
+	artik_pwm_handle handle;
+	artik_error ret = S_OK;
+	artik_pwm_module *pwm = (artik_pwm_module *)
+						artik_request_api_module("pwm");
+
+	set_pin(platid);
 
 	fprintf(stdout, "TEST: %s\n", __func__);
 
@@ -75,6 +103,157 @@ static artik_error pwm_test_frequency(int platid)
 	return ret;
 }
 
+static void print_rate(const char *name, uint64_t elapsed)
+{
+	fprintf(stdout, "BENCH: %-28s %8.0f updates/s %6.1f usec/update\n",
+		name, BENCH_UPDATES * 1000000.0 / elapsed,
+		(double)elapsed / BENCH_UPDATES);
+}
+
+static artik_error pwm_test_update_rate(int platid)
+{
+	artik_pwm_module *pwm = (artik_pwm_module *)
+						artik_request_api_module("pwm");
+	artik_pwm_state states[2];
+	artik_pwm_handle handle;
+	artik_error ret;
+	uint64_t start;
+	int i;
+
+	set_pin(platid);
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = pwm->request(&handle, &config);
+	if (ret != S_OK)
+		goto exit;
+
+	start = now_usec();
+	for (i = 0; i < BENCH_UPDATES && ret == S_OK; i++)
+		ret = pwm->set_duty_cycle(handle, i & 1 ? config.period / 4 :
+						config.period / 2);
+	print_rate("set_duty_cycle", now_usec() - start);
+
+	/* Period and duty cycle both change, in both directions */
+	states[0].period = config.period;
+	states[0].duty_cycle = config.period / 4;
+	states[0].polarity = config.polarity;
+	states[1].period = config.period / 2;
+	states[1].duty_cycle = config.period / 2;
+	states[1].polarity = config.polarity;
+
+	start = now_usec();
+	for (i = 0; i < BENCH_UPDATES && ret == S_OK; i++)
+		ret = pwm->apply_states(&handle, &states[i & 1], 1);
+	print_rate("apply_states", now_usec() - start);
+
+	start = now_usec();
+	for (i = 0; i < BENCH_UPDATES && ret == S_OK; i++)
+		ret = pwm->apply_states(&handle, &states[0], 1);
+	print_rate("apply_states unchanged", now_usec() - start);
+
+	/* Duty cycle longer than the period */
+	states[1].duty_cycle = config.period;
+	if (ret == S_OK && pwm->apply_states(&handle, &states[1], 1) == S_OK)
+		ret = E_INVALID_VALUE;
+
+	pwm->release(handle);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	artik_release_api_module(pwm);
+
+	return ret;
+}
+
+static void waveform_done(void *user_data, artik_error result)
+{
+	struct waveform_test *test = (struct waveform_test *)user_data;
+
+	test->result = result;
+	test->done++;
+	test->loop->quit();
+}
+
+static artik_error pwm_test_waveform(int platid)
+{
+	artik_pwm_module *pwm = (artik_pwm_module *)
+						artik_request_api_module("pwm");
+	unsigned int duty_cycles[WAVEFORM_STEPS];
+	artik_pwm_waveform waveform;
+	struct waveform_test test;
+	artik_pwm_handle handle;
+	artik_error ret;
+	uint64_t start, elapsed;
+	int i;
+
+	set_pin(platid);
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	test.loop = (artik_loop_module *)artik_request_api_module("loop");
+	test.result = E_TRY_AGAIN;
+	test.done = 0;
+
+	if (!test.loop) {
+		ret = E_NOT_SUPPORTED;
+		goto exit;
+	}
+
+	ret = pwm->request(&handle, &config);
+	if (ret != S_OK)
+		goto exit;
+
+	/* Ramp up, the way a LED is faded in */
+	for (i = 0; i < WAVEFORM_STEPS; i++)
+		duty_cycles[i] = (unsigned long long)config.period * (i + 1) /
+								WAVEFORM_STEPS;
+
+	waveform.duty_cycles = duty_cycles;
+	waveform.num_steps = WAVEFORM_STEPS;
+	waveform.step_us = WAVEFORM_STEP_US;
+	waveform.repeat = WAVEFORM_REPEAT;
+
+	start = now_usec();
+	ret = pwm->start_waveform(handle, &waveform, waveform_done, &test);
+	if (ret == S_OK) {
+		test.loop->run();
+		elapsed = now_usec() - start;
+		ret = test.result;
+		if (test.done != 1)
+			ret = E_INVALID_VALUE;
+
+		fprintf(stdout, "BENCH: waveform of %d steps in %llu usec "
+			"(%d expected)\n", WAVEFORM_STEPS * WAVEFORM_REPEAT,
+			(unsigned long long)elapsed,
+			WAVEFORM_STEPS * WAVEFORM_REPEAT * WAVEFORM_STEP_US);
+	}
+
+	/* Nothing left to stop, and a second waveform starts */
+	if (ret == S_OK)
+		ret = pwm->stop_waveform(handle);
+	if (ret == S_OK)
+		ret = pwm->start_waveform(handle, &waveform, NULL, NULL);
+	if (ret == S_OK && pwm->start_waveform(handle, &waveform, NULL,
+						NULL) != E_BUSY)
+		ret = E_INVALID_VALUE;
+
+	/* Stops the waveform */
+	pwm->release(handle);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__,
+		(ret == S_OK) ? "succeeded" : "failed");
+
+	if (test.loop)
+		artik_release_api_module(test.loop);
+	artik_release_api_module(pwm);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = E_NOT_SUPPORTED;
@@ -82,9 +261,13 @@ int main(void)
 
 	if ((platid == ARTIK520) || (platid == ARTIK1020)  ||
 		(platid == ARTIK710) || (platid == ARTIK530) || (platid == ARTIK305) ||
-		(platid == EAGLEYE530))
+		(platid == EAGLEYE530)) {
 		ret = pwm_test_frequency(platid);
-	else
+		if (ret == S_OK)
+			ret = pwm_test_update_rate(platid);
+		if (ret == S_OK)
+			ret = pwm_test_waveform(platid);
+	} else
 		fprintf(stdout, "Cannot run test - Unsupported platform\n");
 
 	return (ret == S_OK) ? 0 : -1;
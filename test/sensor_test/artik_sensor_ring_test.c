@@ -0,0 +1,343 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <artik_module.h>
+#include <artik_loop.h>
+#include <artik_spi.h>
+#include <artik_sensor.h>
+#include <artik_sim.h>
+#include <devices/K6DS3.h>
+
+/*
+ * Several threads read the samples of one simulated accelerometer while
+ * the loop samples it. They check that every sample they get is whole and
+ * comes after the previous one, and that the samples they skip are all
+ * counted as lost.
+ *
+ * Each read of the simulated device returns the next value of a counter
+ * on X, its opposite on Y and its complement to RING_COUNTER_MAX on Z.
+ */
+
+/* Bus number no board uses */
+#define SIM_BUS			50
+#define K6DS3_REG_OUTX_XL	0x28
+#define RING_COUNTER_MAX	0x7fff
+#define RING_RATE_HZ		20000
+#define RING_BATCH		32
+#define RING_SIZE		256
+#define RING_MSEC		1000
+#define READ_MAX		64
+#define READER_IDLE_USEC	200
+#define SLOW_READER_USEC	20000
+
+struct ring_reader {
+	const char *name;
+	artik_sensor_view view;
+	/* Samples taken at once, and pause after each read */
+	int batch;
+	unsigned int pause_us;
+	artik_sensor_reader_handle handle;
+	pthread_t thread;
+	/* Samples returned, and samples skipped between them */
+	unsigned long long samples;
+	unsigned long long skipped;
+	artik_sensor_reader_stats stats;
+	unsigned long long reads;
+	unsigned long long read_ns;
+	int errors;
+};
+
+struct ring_test {
+	artik_sensor_module *sensor;
+	artik_loop_module *loop;
+	artik_sensor_sampling_handle sampling;
+	artik_sensor_sampling_stats stats;
+	unsigned int counter;
+	int done;
+};
+
+static struct ring_test test;
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void put16(unsigned char *data, int value)
+{
+	data[0] = value & 0xff;
+	data[1] = (value >> 8) & 0xff;
+}
+
+/* Called by the simulation before the output registers are read */
+static void counter_hook(void *user_data, artik_sim_device *device,
+			unsigned int reg, int len, bool write)
+{
+	unsigned char data[6];
+	int x;
+
+	if (write || reg != K6DS3_REG_OUTX_XL)
+		return;
+
+	x = ++test.counter & RING_COUNTER_MAX;
+	put16(&data[0], x);
+	put16(&data[2], -x);
+	put16(&data[4], RING_COUNTER_MAX - x);
+	artik_sim_write_registers(device, K6DS3_REG_OUTX_XL, data, 6);
+}
+
+/*
+ * A sample mixing two writes of the ring breaks the relations between
+ * its values. Averages round X and Z down, so Z is off by one unless
+ * the sum was exact.
+ */
+static bool check_sample(const struct ring_reader *reader,
+			const artik_sensor_sample *sample)
+{
+	int x = sample->values[0];
+	int z = RING_COUNTER_MAX - x;
+
+	if (sample->values[1] != -x)
+		return false;
+
+	return sample->values[2] == z || (reader->view.average &&
+						sample->values[2] == z - 1);
+}
+
+/*
+ * A sample of the view follows the previous one by 'decimation' samples
+ * of the sensor, plus the ones lost in between. Averages only move by
+ * the same amount when no sample was lost.
+ */
+static void check_samples(struct ring_reader *reader,
+		const artik_sensor_sample *samples, int count, int *prev)
+{
+	int step = reader->view.decimation ? reader->view.decimation : 1;
+	int i, diff;
+
+	for (i = 0; i < count; i++) {
+		if (!check_sample(reader, &samples[i]))
+			reader->errors++;
+
+		diff = (samples[i].values[0] - *prev) & RING_COUNTER_MAX;
+		if (*prev < 0) {
+			/* Where the first average starts is not known */
+		} else if (reader->view.average) {
+			if (!diff || (!reader->stats.lost && diff != step))
+				reader->errors++;
+		} else if (diff < step) {
+			reader->errors++;
+		} else {
+			reader->skipped += diff - step;
+		}
+		*prev = samples[i].values[0];
+	}
+
+	reader->samples += count;
+	/* Samples are only skipped once counted as lost */
+	if (reader->skipped > reader->stats.lost)
+		reader->errors++;
+}
+
+static void *reader_thread(void *arg)
+{
+	struct ring_reader *reader = (struct ring_reader *)arg;
+	artik_sensor_sample samples[READ_MAX];
+	/* The counter starts at 1, as if sample 0 was read before */
+	int prev = reader->view.average ? -1 : 0;
+	uint64_t start;
+	int count, done;
+
+	do {
+		done = __atomic_load_n(&test.done, __ATOMIC_ACQUIRE);
+
+		start = now_nsec();
+		if (test.sensor->read_samples(reader->handle, samples,
+					reader->batch, &count) != S_OK) {
+			reader->errors++;
+			break;
+		}
+		reader->read_ns += now_nsec() - start;
+		reader->reads++;
+
+		test.sensor->get_reader_stats(reader->handle, &reader->stats);
+		check_samples(reader, samples, count, &prev);
+
+		if (reader->pause_us)
+			usleep(reader->pause_us);
+		else if (!count)
+			usleep(READER_IDLE_USEC);
+	/* Stop once all the samples written are read */
+	} while (!done || count);
+
+	return NULL;
+}
+
+static void stop_sampling(void *user_data)
+{
+	test.sensor->get_sampling_stats(test.sampling, &test.stats);
+	test.sensor->stop_sampling(test.sampling);
+	test.sampling = NULL;
+	__atomic_store_n(&test.done, 1, __ATOMIC_RELEASE);
+	test.loop->quit();
+}
+
+static artik_error check_reader(struct ring_reader *reader)
+{
+	bool raw = reader->view.decimation <= 1 && !reader->view.average;
+
+	fprintf(stdout, "BENCH: %s reader: %llu samples, %llu lost, %llu reads"
+		" of %llu ns\n", reader->name, reader->stats.samples,
+		reader->stats.lost, reader->reads,
+		reader->reads ? reader->read_ns / reader->reads : 0);
+
+	if (reader->errors || !reader->samples ||
+	    reader->samples != reader->stats.samples) {
+		fprintf(stderr, "%s reader: %d errors\n", reader->name,
+							reader->errors);
+		return E_INVALID_VALUE;
+	}
+
+	/* Every sample written was either read or lost */
+	if (raw && (reader->samples + reader->stats.lost != test.stats.samples
+	    || reader->skipped != reader->stats.lost)) {
+		fprintf(stderr, "%s reader: %llu samples written\n",
+					reader->name, test.stats.samples);
+		return E_INVALID_VALUE;
+	}
+
+	return S_OK;
+}
+
+static artik_error test_sensor_ring(void)
+{
+	artik_spi_config spi_config = { SIM_BUS, 0, SPI_MODE3, 8, 500000 };
+	artik_sensor_config config = { ARTIK_SENSOR_ACCELEROMETER,
+		(char *)"k6ds3_accelerometer", &spi_config, &k6ds3_xl_sensor };
+	artik_sensor_sampling_config params = { RING_RATE_HZ, RING_BATCH,
+							false, RING_SIZE };
+	struct ring_reader readers[] = {
+		{ "raw", { 0, false }, READ_MAX, 0 },
+		{ "one by one", { 0, false }, 1, 0 },
+		{ "decimated", { 4, false }, READ_MAX, 0 },
+		{ "averaged", { 4, true }, READ_MAX, 0 },
+		{ "slow", { 0, false }, 16, SLOW_READER_USEC },
+	};
+	int nb_readers = sizeof(readers) / sizeof(readers[0]);
+	artik_sensor_handle handle = NULL;
+	artik_sim_device *k6ds3 = NULL;
+	artik_sensor_ops ops;
+	artik_error ret;
+	int i, started = 0, timeout_id;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	test.sensor = (artik_sensor_module *)artik_request_api_module("sensor");
+	test.loop = (artik_loop_module *)artik_request_api_module("loop");
+
+	ret = artik_sim_add_device(&k6ds3, ARTIK_SIM_SPI, SIM_BUS, 0,
+							ARTIK_SIM_K6DS3);
+	if (ret == S_OK)
+		ret = test.sensor->request(&config, &handle, &ops);
+	if (ret == S_OK)
+		ret = artik_sim_set_hook(k6ds3, counter_hook, NULL);
+	if (ret == S_OK)
+		ret = test.sensor->start_sampling(&test.sampling, &config,
+						handle, &params, NULL, NULL);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to start sampling (%d)\n", ret);
+		goto exit;
+	}
+
+	for (i = 0; i < nb_readers; i++) {
+		ret = test.sensor->open_reader(&readers[i].handle,
+					test.sampling, &readers[i].view);
+		if (ret != S_OK)
+			goto exit;
+	}
+
+	for (; started < nb_readers; started++) {
+		if (pthread_create(&readers[started].thread, NULL,
+					reader_thread, &readers[started])) {
+			ret = E_NO_MEM;
+			break;
+		}
+	}
+
+	if (ret == S_OK) {
+		test.loop->add_timeout_callback(&timeout_id, RING_MSEC,
+							stop_sampling, NULL);
+		test.loop->run();
+	} else {
+		stop_sampling(NULL);
+	}
+
+	for (i = 0; i < started; i++)
+		pthread_join(readers[i].thread, NULL);
+	if (ret != S_OK)
+		goto exit;
+
+	fprintf(stdout, "BENCH: %llu samples written at %u Hz, %llu missed\n",
+		test.stats.samples, test.stats.rate_hz, test.stats.missed);
+
+	for (i = 0; i < nb_readers && ret == S_OK; i++)
+		ret = check_reader(&readers[i]);
+
+	/* The slow reader cannot keep up with the ring */
+	if (ret == S_OK && !readers[nb_readers - 1].stats.lost)
+		ret = E_INVALID_VALUE;
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (test.sampling)
+		test.sensor->stop_sampling(test.sampling);
+	for (i = 0; i < nb_readers; i++)
+		if (readers[i].handle)
+			test.sensor->close_reader(readers[i].handle);
+	if (handle)
+		k6ds3_xl_sensor.release(handle);
+	if (k6ds3)
+		artik_sim_remove_device(k6ds3);
+	artik_release_api_module(test.loop);
+	artik_release_api_module(test.sensor);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_error ret;
+
+	ret = test_sensor_ring();
+
+	return (ret == S_OK) ? 0 : -1;
+}
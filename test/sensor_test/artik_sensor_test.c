@@ -32,7 +32,11 @@
 #include <unistd.h>
 
 #include <artik_module.h>
+#include <artik_loop.h>
+#include <artik_i2c.h>
 #include <artik_sensor.h>
+#include <devices/HTS221.h>
+#include <devices/LPS25HBTR.h>
 
 static int end = 0;
 
@@ -41,6 +45,278 @@ static void signal_handler(int signum)
 	end = 1;
 }
 
+/*
+ * Sampling tests on the i2c-stub driver standing for an HTS221 and an
+ * LPS25HBTR, loaded with:
+ *   modprobe i2c-stub chip_addr=0x5d,0x5f
+ * i2c-stub has no auto increment flag, so the registers read in bursts
+ * are written at their address with this flag set.
+ */
+#define STUB_ADAPTER_NAME	"SMBus stub driver"
+#define STUB_AUTO_INC		0x80
+#define SAMPLING_MSEC		2000
+
+struct stub_regs {
+	unsigned char address;
+	unsigned char reg;
+	int len;
+	unsigned char data[16];
+};
+
+static const struct stub_regs stub_regs[] = {
+	/* HTS221 WHO_AM_I, calibration, then 50% and 20 degrees C */
+	{ HTS221_ADDR, 0x0f, 1, { 0xbc } },
+	{ HTS221_ADDR, 0x30 | STUB_AUTO_INC, 16, { 40, 160, 80, 240, 0, 0,
+		0, 0, 0, 0, 0xe0, 0x2e, 0, 0, 0xd0, 0x07 } },
+	{ HTS221_ADDR, 0x28 | STUB_AUTO_INC, 4, { 0x70, 0x17, 0xe8, 0x03 } },
+	/* LPS25HBTR WHO_AM_I, then 1013 hPa and 25 degrees C */
+	{ LPS25HBTR_ADDR, 0x0f, 1, { 0xbd } },
+	{ LPS25HBTR_ADDR, 0x28 | STUB_AUTO_INC, 5, { 0x00, 0x50, 0x3f, 0x30,
+		0xdf } },
+};
+
+struct sampling_test {
+	const char *name;
+	artik_sensor_config config;
+	artik_sensor_sampling_config params;
+	int values[ARTIK_SENSOR_MAX_VALUES];
+	int num_values;
+	artik_sensor_handle handle;
+	artik_sensor_sampling_handle sampling;
+	/* Stop sampling after this number of batches, if not 0 */
+	int stop_after;
+	int batches;
+	int errors;
+	unsigned long long last_ns;
+	unsigned long long max_gap_ns;
+};
+
+static artik_sensor_module *sampling_sensor;
+
+static int find_stub_adapter(void)
+{
+	char path[64], name[64];
+	int id;
+
+	for (id = 0; id < 256; id++) {
+		FILE *f;
+
+		snprintf(path, sizeof(path),
+			"/sys/class/i2c-adapter/i2c-%d/name", id);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+		if (fgets(name, sizeof(name), f) && !strncmp(name,
+				STUB_ADAPTER_NAME, strlen(STUB_ADAPTER_NAME))) {
+			fclose(f);
+			return id;
+		}
+		fclose(f);
+	}
+
+	return -1;
+}
+
+static artik_error write_stub_registers(int id)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+						artik_request_api_module("i2c");
+	artik_i2c_config stub_config = { id, 100000, I2C_8BIT, HTS221_ADDR };
+	artik_i2c_msg msgs[sizeof(stub_regs) / sizeof(stub_regs[0])];
+	artik_i2c_handle stub;
+	artik_error ret;
+	unsigned int i;
+
+	ret = i2c->request(&stub, &stub_config);
+	if (ret != S_OK)
+		goto exit;
+
+	for (i = 0; i < sizeof(msgs) / sizeof(msgs[0]); i++) {
+		msgs[i].type = I2C_MSG_WRITE_REGISTER;
+		msgs[i].address = stub_regs[i].address;
+		msgs[i].reg = stub_regs[i].reg;
+		msgs[i].buffer = (char *)stub_regs[i].data;
+		msgs[i].len = stub_regs[i].len;
+	}
+
+	ret = i2c->transfer(stub, msgs, sizeof(msgs) / sizeof(msgs[0]));
+	i2c->release(stub);
+
+exit:
+	artik_release_api_module(i2c);
+	return ret;
+}
+
+static void on_samples(void *user_data, const artik_sensor_sample *samples,
+			int count)
+{
+	struct sampling_test *test = (struct sampling_test *)user_data;
+	int i, j;
+
+	if (count != (int)test->params.batch)
+		test->errors++;
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < test->num_values; j++)
+			if (samples[i].values[j] != test->values[j])
+				test->errors++;
+
+		if (test->last_ns) {
+			if (samples[i].timestamp_ns <= test->last_ns)
+				test->errors++;
+			else if (samples[i].timestamp_ns - test->last_ns >
+							test->max_gap_ns)
+				test->max_gap_ns = samples[i].timestamp_ns -
+								test->last_ns;
+		}
+		test->last_ns = samples[i].timestamp_ns;
+	}
+
+	if (++test->batches == test->stop_after) {
+		sampling_sensor->stop_sampling(test->sampling);
+		test->sampling = NULL;
+	}
+}
+
+static void release_sensor(artik_sensor_config *config,
+				artik_sensor_handle handle)
+{
+	switch (config->type) {
+	case ARTIK_SENSOR_HUMIDITY:
+		((artik_sensor_humidity *)config->data_user)->release(handle);
+		break;
+	case ARTIK_SENSOR_TEMPERATURE:
+		((artik_sensor_temperature *)config->data_user)->release(
+									handle);
+		break;
+	case ARTIK_SENSOR_BAROMETER:
+		((artik_sensor_pressure *)config->data_user)->release(handle);
+		break;
+	default:
+		break;
+	}
+}
+
+static void stop_loop(void *user_data)
+{
+	artik_loop_module *loop = (artik_loop_module *)user_data;
+
+	loop->quit();
+}
+
+static artik_error test_sensor_sampling(int stub_id)
+{
+	artik_sensor_module *sensor = (artik_sensor_module *)
+					artik_request_api_module("sensor");
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_i2c_config hts221_i2c = { stub_id, 100000, I2C_8BIT,
+								HTS221_ADDR };
+	artik_i2c_config lps25hbtr_i2c = { stub_id, 100000, I2C_8BIT,
+							LPS25HBTR_ADDR };
+	struct sampling_test tests[] = {
+		{ "humidity", { ARTIK_SENSOR_HUMIDITY,
+			(char *)"hts221_humidity", &hts221_i2c,
+			&hts221_humidity_sensor }, { 200, 20 }, { 50 }, 1 },
+		{ "temperature", { ARTIK_SENSOR_TEMPERATURE,
+			(char *)"hts221_temp", &hts221_i2c,
+			&hts221_temp_sensor }, { 100, 10 }, { 20, 68 }, 2 },
+		{ "pressure", { ARTIK_SENSOR_BAROMETER,
+			(char *)"lps25hbtr_barometer", &lps25hbtr_i2c,
+			&lps25hbtr_barometer_sensor }, { 50, 5 }, { 1013 }, 1 },
+		/* Stopped from its callback */
+		{ "humidity stop", { ARTIK_SENSOR_HUMIDITY,
+			(char *)"hts221_humidity", &hts221_i2c,
+			&hts221_humidity_sensor }, { 100, 4 }, { 50 }, 1,
+			NULL, NULL, 3 },
+	};
+	int num_tests = sizeof(tests) / sizeof(tests[0]);
+	artik_sensor_sampling_stats stats;
+	artik_sensor_ops ops;
+	artik_error ret;
+	int i, timeout_id;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+	sampling_sensor = sensor;
+
+	ret = write_stub_registers(stub_id);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to write stub registers (%d)\n", ret);
+		goto exit;
+	}
+
+	for (i = 0; i < num_tests; i++) {
+		ret = sensor->request(&tests[i].config, &tests[i].handle, &ops);
+		if (ret != S_OK) {
+			fprintf(stderr, "Failed to request %s (%d)\n",
+				tests[i].name, ret);
+			goto release;
+		}
+
+		ret = sensor->start_sampling(&tests[i].sampling,
+				&tests[i].config, tests[i].handle,
+				&tests[i].params, on_samples, &tests[i]);
+		if (ret != S_OK) {
+			fprintf(stderr, "Failed to sample %s (%d)\n",
+				tests[i].name, ret);
+			goto release;
+		}
+	}
+
+	loop->add_timeout_callback(&timeout_id, SAMPLING_MSEC, stop_loop,
+									loop);
+	loop->run();
+
+	for (i = 0; i < num_tests; i++) {
+		struct sampling_test *test = &tests[i];
+		unsigned long long expected = (unsigned long long)
+				test->params.rate_hz * SAMPLING_MSEC / 1000;
+
+		if (test->stop_after) {
+			if (test->batches != test->stop_after || test->errors) {
+				fprintf(stderr, "%s: %d batches, %d errors\n",
+					test->name, test->batches,
+					test->errors);
+				ret = E_INVALID_VALUE;
+			}
+			continue;
+		}
+
+		sensor->get_sampling_stats(test->sampling, &stats);
+
+		/* Samples of the last incomplete batch are not delivered */
+		if (test->errors || stats.errors ||
+		    stats.samples + test->params.batch < expected * 9 / 10 ||
+		    stats.samples > expected) {
+			fprintf(stderr, "%s: %llu samples, %d errors, %llu read"
+				" errors\n", test->name, stats.samples,
+				test->errors, stats.errors);
+			ret = E_INVALID_VALUE;
+		}
+
+		fprintf(stdout, "BENCH: %s: %llu samples at %u Hz, %llu reads"
+			", %llu missed, max gap %llu us\n", test->name,
+			stats.samples, stats.rate_hz, stats.reads,
+			stats.missed, test->max_gap_ns / 1000);
+	}
+
+release:
+	for (i = 0; i < num_tests; i++) {
+		if (tests[i].sampling)
+			sensor->stop_sampling(tests[i].sampling);
+		if (tests[i].handle)
+			release_sensor(&tests[i].config, tests[i].handle);
+	}
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+
+	artik_release_api_module(loop);
+	artik_release_api_module(sensor);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_sensor_module *sensor              = NULL;
@@ -70,6 +346,10 @@ int main(void)
 	int k = 5;
 	int i   = 0;
 	int res = 0;
+	int stub_id = find_stub_adapter();
+
+	if (stub_id >= 0)
+		return (test_sensor_sampling(stub_id) == S_OK) ? 0 : -1;
 
 	sensor = (artik_sensor_module *)artik_request_api_module("sensor");
 	if (!sensor) {
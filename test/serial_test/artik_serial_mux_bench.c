@@ -0,0 +1,301 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <artik_module.h>
+#include <artik_serial.h>
+#include <artik_loop.h>
+
+/*
+ * Receives lines from many pty pairs, each port with its own receive
+ * callback and then through a multiplexer, and compares the time spent
+ * by the loop thread. A thread writes one line to every port in turn,
+ * the callbacks check their sequence numbers.
+ */
+
+#define DEFAULT_PORTS		32
+#define DEFAULT_FRAMES		2000
+#define LINE_SIZE		32
+
+enum bench_mode {
+	MODE_PER_PORT,
+	MODE_MUX,
+	MODE_MUX_BATCH
+};
+
+static const char *const mode_names[] = {
+	"per-port",
+	"mux",
+	"mux batch 1ms"
+};
+
+struct bench_ctx;
+
+struct bench_port {
+	struct bench_ctx *ctx;
+	artik_serial_handle handle;
+	int master;
+	int next;
+};
+
+struct bench_ctx {
+	artik_loop_module *loop;
+	struct bench_port *ports;
+	int num_ports;
+	int num_frames;
+	int received;
+	int errors;
+};
+
+static unsigned long long clock_us(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void on_timeout(int signum)
+{
+	fprintf(stderr, "TEST: serial mux bench failed, timeout expired\n");
+	exit(-1);
+}
+
+static void on_line(void *user_data, const unsigned char *frame, int len)
+{
+	struct bench_port *port = (struct bench_port *)user_data;
+	struct bench_ctx *ctx = port->ctx;
+	char line[LINE_SIZE];
+	int seq;
+
+	memcpy(line, frame, len < LINE_SIZE ? len : LINE_SIZE - 1);
+	line[len < LINE_SIZE ? len : LINE_SIZE - 1] = '\0';
+	if (len != LINE_SIZE - 1 || sscanf(line, "%d", &seq) != 1 ||
+	    seq != port->next)
+		ctx->errors++;
+	port->next++;
+
+	if (++ctx->received == ctx->num_ports * ctx->num_frames)
+		ctx->loop->quit();
+}
+
+static void *writer(void *arg)
+{
+	struct bench_ctx *ctx = (struct bench_ctx *)arg;
+	char line[LINE_SIZE + 1];
+	int i, p;
+
+	for (i = 0; i < ctx->num_frames; i++) {
+		snprintf(line, sizeof(line), "%-31d\n", i);
+		for (p = 0; p < ctx->num_ports; p++)
+			if (write(ctx->ports[p].master, line, LINE_SIZE) !=
+								LINE_SIZE)
+				return NULL;
+	}
+
+	return NULL;
+}
+
+static int open_pty(unsigned int *port)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	unsigned int num;
+	char *name;
+
+	if (master < 0)
+		return -1;
+
+	name = ptsname(master);
+	if (grantpt(master) || unlockpt(master) || !name ||
+	    sscanf(name, "/dev/pts/%u", &num) != 1) {
+		close(master);
+		return -1;
+	}
+
+	*port = SERIAL_PTS_PORT(num);
+	return master;
+}
+
+static artik_error bench_mux(enum bench_mode mode, int num_ports,
+			int num_frames)
+{
+	artik_serial_module *serial = (artik_serial_module *)
+					artik_request_api_module("serial");
+	static const unsigned char newline[] = "\n";
+	artik_serial_framing framing = {
+		ARTIK_SERIAL_FRAME_DELIMITER, newline, 1
+	};
+	artik_serial_mux_config mux_config = { 0, 0, 0 };
+	artik_serial_config config = {
+		0, "pty",
+		ARTIK_SERIAL_BAUD_4000000,
+		ARTIK_SERIAL_PARITY_NONE,
+		ARTIK_SERIAL_DATA_8BIT,
+		ARTIK_SERIAL_STOP_1BIT,
+		ARTIK_SERIAL_FLOWCTRL_NONE,
+		NULL
+	};
+	artik_serial_mux_handle mux = NULL;
+	artik_serial_mux_stats stats;
+	unsigned long long start, cpu, process;
+	struct bench_ctx ctx;
+	artik_error ret = S_OK;
+	pthread_t thread;
+	int i;
+
+	memset(&ctx, 0, sizeof(ctx));
+	memset(&stats, 0, sizeof(stats));
+	ctx.loop = (artik_loop_module *)artik_request_api_module("loop");
+	ctx.num_ports = num_ports;
+	ctx.num_frames = num_frames;
+	ctx.ports = calloc(num_ports, sizeof(struct bench_port));
+	if (!ctx.ports) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+	for (i = 0; i < num_ports; i++)
+		ctx.ports[i].master = -1;
+
+	if (mode != MODE_PER_PORT) {
+		if (mode == MODE_MUX_BATCH)
+			mux_config.batch_us = 1000;
+		ret = serial->mux_create(&mux, &mux_config);
+		if (ret != S_OK) {
+			fprintf(stdout, "BENCH: failed to create mux (%d)\n",
+									ret);
+			goto exit;
+		}
+	}
+
+	for (i = 0; i < num_ports; i++) {
+		struct bench_port *port = &ctx.ports[i];
+
+		port->ctx = &ctx;
+		port->master = open_pty(&config.port_num);
+		if (port->master < 0) {
+			fprintf(stdout, "BENCH: failed to open pty #%d\n", i);
+			ret = E_ACCESS_DENIED;
+			goto exit;
+		}
+
+		ret = serial->request(&port->handle, &config);
+		if (ret != S_OK)
+			goto exit;
+
+		if (mux)
+			ret = serial->mux_add_port(mux, port->handle,
+						&framing, on_line, port);
+		else
+			ret = serial->set_frame_callback(port->handle,
+						&framing, on_line, port);
+		if (ret != S_OK) {
+			fprintf(stdout, "BENCH: failed to add port #%d (%d)\n",
+								i, ret);
+			goto exit;
+		}
+	}
+
+	alarm(60);
+	start = clock_us(CLOCK_MONOTONIC);
+	cpu = clock_us(CLOCK_THREAD_CPUTIME_ID);
+	process = clock_us(CLOCK_PROCESS_CPUTIME_ID);
+	if (pthread_create(&thread, NULL, writer, &ctx)) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+	ctx.loop->run();
+	cpu = clock_us(CLOCK_THREAD_CPUTIME_ID) - cpu;
+	process = clock_us(CLOCK_PROCESS_CPUTIME_ID) - process;
+	start = clock_us(CLOCK_MONOTONIC) - start;
+	pthread_join(thread, NULL);
+	alarm(0);
+
+	if (mux)
+		serial->mux_get_stats(mux, &stats);
+
+	if (ctx.errors) {
+		fprintf(stdout, "BENCH: %s: %d lines out of order\n",
+			mode_names[mode], ctx.errors);
+		ret = E_BAD_ARGS;
+		goto exit;
+	}
+
+	fprintf(stdout,
+		"BENCH: %-13s %3d ports, %d lines in %4llu ms: loop cpu %4llu ms"
+		" (%.2f us/line), process cpu %4llu ms, %llu wakeups\n",
+		mode_names[mode], num_ports, ctx.received, start / 1000,
+		cpu / 1000, (double)cpu / ctx.received, process / 1000,
+		stats.wakeups);
+
+exit:
+	for (i = 0; ctx.ports && i < num_ports; i++) {
+		if (ctx.ports[i].handle)
+			serial->release(ctx.ports[i].handle);
+		if (ctx.ports[i].master >= 0)
+			close(ctx.ports[i].master);
+	}
+	if (mux)
+		serial->mux_destroy(mux);
+	free(ctx.ports);
+	artik_release_api_module(ctx.loop);
+	artik_release_api_module(serial);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	int sizes[] = { 8, DEFAULT_PORTS, 64 };
+	int frames = DEFAULT_FRAMES;
+	artik_error ret = S_OK;
+	unsigned int i;
+	int mode;
+
+	if (!artik_is_module_available(ARTIK_MODULE_SERIAL)) {
+		fprintf(stdout,
+			"TEST: Serial module is not available,"\
+			" skipping test...\n");
+		return -1;
+	}
+
+	if (argc > 1)
+		frames = atoi(argv[1]);
+
+	signal(SIGALRM, on_timeout);
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		for (mode = MODE_PER_PORT; mode <= MODE_MUX_BATCH; mode++) {
+			ret = bench_mux(mode, sizes[i], frames);
+			if (ret != S_OK)
+				return -1;
+		}
+	}
+
+	return 0;
+}
@@ -16,11 +16,17 @@
  *
  */
 
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 
 
@@ -176,6 +182,519 @@ exit:
 	return ret;
 }
 
+/*
+ * Framing tests run on a pseudo-terminal, so that they do not need
+ * any wiring. A thread writes frames on the master side, with the
+ * time they were sent, and the callback checks them.
+ */
+#define PTY_PAYLOAD	64
+#define PTY_HEADER	24
+
+struct pty_test {
+	const char *name;
+	artik_serial_framing framing;
+	int frames;
+	/* Delay between two frames written */
+	unsigned int gap_us;
+	int master;
+	int received;
+	int errors;
+	unsigned long long latency_sum;
+	unsigned long long latency_max;
+};
+
+static unsigned long long now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void make_payload(struct pty_test *test, unsigned int seq,
+			unsigned char *buf)
+{
+	bool text = test->framing.type == ARTIK_SERIAL_FRAME_DELIMITER;
+	int i;
+
+	snprintf((char *)buf, PTY_HEADER + 1, "%08x%016llx", seq, now_us());
+	/* Binary framings get all byte values, including special ones */
+	for (i = PTY_HEADER; i < PTY_PAYLOAD; i++)
+		buf[i] = text ? 'a' + (seq + i) % 26 : (seq * 7 + i) & 0xff;
+}
+
+static int encode_frame(artik_serial_framing_t type, const unsigned char *in,
+			int len, unsigned char *out)
+{
+	int i, o = 0, code_pos, code;
+
+	switch (type) {
+	case ARTIK_SERIAL_FRAME_DELIMITER:
+		memcpy(out, in, len);
+		memcpy(out + len, "\r\n", 2);
+		return len + 2;
+	case ARTIK_SERIAL_FRAME_LENGTH:
+		out[0] = len >> 8;
+		out[1] = len & 0xff;
+		memcpy(out + 2, in, len);
+		return len + 2;
+	case ARTIK_SERIAL_FRAME_CUSTOM:
+		out[0] = len;
+		memcpy(out + 1, in, len);
+		return len + 1;
+	case ARTIK_SERIAL_FRAME_SLIP:
+		for (i = 0; i < len; i++) {
+			if (in[i] == 0xc0) {
+				out[o++] = 0xdb;
+				out[o++] = 0xdc;
+			} else if (in[i] == 0xdb) {
+				out[o++] = 0xdb;
+				out[o++] = 0xdd;
+			} else {
+				out[o++] = in[i];
+			}
+		}
+		out[o++] = 0xc0;
+		return o;
+	case ARTIK_SERIAL_FRAME_COBS:
+		code_pos = o++;
+		code = 1;
+		for (i = 0; i < len; i++) {
+			if (in[i]) {
+				out[o++] = in[i];
+				code++;
+			}
+			if (!in[i] || code == 0xff) {
+				out[code_pos] = code;
+				code_pos = o++;
+				code = 1;
+			}
+		}
+		out[code_pos] = code;
+		out[o++] = 0;
+		return o;
+	default:
+		memcpy(out, in, len);
+		return len;
+	}
+}
+
+/* Frames made of a length byte followed by the payload */
+static int length_byte_framer(void *user_data, const unsigned char *data,
+			int len)
+{
+	if (len < 1 || len < data[0] + 1)
+		return 0;
+	return data[0] + 1;
+}
+
+static int write_all(int fd, const unsigned char *buf, int len)
+{
+	while (len > 0) {
+		int ret = write(fd, buf, len);
+
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+static void *pty_writer(void *arg)
+{
+	struct pty_test *test = (struct pty_test *)arg;
+	unsigned char payload[PTY_PAYLOAD];
+	unsigned char frame[2 * PTY_PAYLOAD + 4];
+	int i, len, split;
+
+	for (i = 0; i < test->frames; i++) {
+		make_payload(test, i, payload);
+		len = encode_frame(test->framing.type, payload, PTY_PAYLOAD,
+									frame);
+		/* Cut frames in two writes, as they would come from a UART */
+		split = (i * 37) % len;
+		if (write_all(test->master, frame, split) < 0 ||
+		    write_all(test->master, frame + split, len - split) < 0)
+			break;
+		if (test->gap_us)
+			usleep(test->gap_us);
+	}
+
+	return NULL;
+}
+
+static void pty_frame(void *user_data, const unsigned char *frame, int len)
+{
+	struct pty_test *test = (struct pty_test *)user_data;
+	unsigned long long now = now_us(), sent, latency;
+	unsigned char expected[PTY_PAYLOAD];
+	char header[PTY_HEADER + 1];
+	unsigned int seq;
+
+	/* The framer passes the length byte too */
+	if (test->framing.type == ARTIK_SERIAL_FRAME_CUSTOM) {
+		frame++;
+		len--;
+	}
+
+	if (len != PTY_PAYLOAD)
+		goto error;
+
+	memcpy(header, frame, PTY_HEADER);
+	header[PTY_HEADER] = '\0';
+	if (sscanf(header, "%8x%16llx", &seq, &sent) != 2 ||
+	    seq != (unsigned int)test->received)
+		goto error;
+
+	make_payload(test, seq, expected);
+	if (memcmp(frame + PTY_HEADER, expected + PTY_HEADER,
+						PTY_PAYLOAD - PTY_HEADER))
+		goto error;
+
+	latency = now - sent;
+	test->latency_sum += latency;
+	if (latency > test->latency_max)
+		test->latency_max = latency;
+	goto next;
+
+error:
+	test->errors++;
+next:
+	if (++test->received == test->frames) {
+		artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+
+		loop->quit();
+		artik_release_api_module(loop);
+	}
+}
+
+static int open_pty(unsigned int *port)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	unsigned int num;
+	char *name;
+
+	if (master < 0)
+		return -1;
+
+	name = ptsname(master);
+	if (grantpt(master) || unlockpt(master) || !name ||
+	    sscanf(name, "/dev/pts/%u", &num) != 1) {
+		close(master);
+		return -1;
+	}
+
+	*port = SERIAL_PTS_PORT(num);
+	return master;
+}
+
+static artik_error test_serial_pty(struct pty_test *test)
+{
+	artik_serial_module *serial = (artik_serial_module *)
+					artik_request_api_module("serial");
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_serial_config pty_config = config;
+	artik_serial_handle pty_handle = NULL;
+	artik_serial_rx_stats stats;
+	unsigned long long start, elapsed;
+	artik_error ret = S_OK;
+	pthread_t writer;
+
+	fprintf(stdout, "TEST: %s %s starting\n", __func__, test->name);
+
+	test->master = open_pty(&pty_config.port_num);
+	if (test->master < 0) {
+		fprintf(stderr, "TEST: %s %s failed to open a pty\n",
+			__func__, test->name);
+		ret = E_ACCESS_DENIED;
+		goto exit;
+	}
+	pty_config.name = "pty";
+
+	ret = serial->request(&pty_handle, &pty_config);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s %s failed to request pty (%d)\n",
+			__func__, test->name, ret);
+		goto exit;
+	}
+
+	ret = serial->set_frame_callback(pty_handle, &test->framing,
+						pty_frame, test);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s %s failed to set callback (%d)\n",
+			__func__, test->name, ret);
+		goto exit;
+	}
+
+	set_timeout(test->name, 30);
+	start = now_us();
+	if (pthread_create(&writer, NULL, pty_writer, test)) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+	loop->run();
+	elapsed = now_us() - start;
+	pthread_join(writer, NULL);
+	unset_timeout();
+
+	serial->get_rx_stats(pty_handle, &stats);
+	if (test->errors || stats.frames != (unsigned long long)test->frames
+	    || stats.bad_frames || stats.overruns) {
+		fprintf(stderr, "TEST: %s %s failed, %d errors, %llu frames,"
+			" %llu bad frames, %llu bytes overrun\n", __func__,
+			test->name, test->errors, stats.frames,
+			stats.bad_frames, stats.overruns);
+		ret = E_BAD_ARGS;
+		goto exit;
+	}
+
+	fprintf(stdout, "BENCH: %s: %d frames, %llu bytes in %llu ms"
+		" (%.1f KB/s), latency avg %llu us max %llu us\n",
+		test->name, test->frames, stats.bytes, elapsed / 1000,
+		stats.bytes * 1000000.0 / 1024 / elapsed,
+		test->latency_sum / test->frames, test->latency_max);
+	fprintf(stdout, "TEST: %s %s succeeded\n", __func__, test->name);
+
+exit:
+	if (pty_handle)
+		serial->release(pty_handle);
+	if (test->master >= 0)
+		close(test->master);
+	artik_release_api_module(serial);
+	artik_release_api_module(loop);
+	return ret;
+}
+
+static artik_error test_serial_pty_framing(void)
+{
+	static const unsigned char crlf[] = "\r\n";
+	struct pty_test tests[] = {
+		{ "delimiter", { ARTIK_SERIAL_FRAME_DELIMITER, crlf, 2 },
+			5000, 0 },
+		{ "length", { ARTIK_SERIAL_FRAME_LENGTH, NULL, 0, 2, true },
+			5000, 0 },
+		{ "slip", { ARTIK_SERIAL_FRAME_SLIP }, 5000, 0 },
+		{ "cobs", { ARTIK_SERIAL_FRAME_COBS }, 5000, 0 },
+		{ "custom", { ARTIK_SERIAL_FRAME_CUSTOM, NULL, 0, 0, false, 0,
+			length_byte_framer }, 5000, 0 },
+		{ "delimiter paced", { ARTIK_SERIAL_FRAME_DELIMITER, crlf, 2 },
+			200, 1000 },
+		{ "idle", { ARTIK_SERIAL_FRAME_IDLE, NULL, 0, 0, false,
+			10000 }, 40, 50000 },
+	};
+	artik_error ret = S_OK;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		ret = test_serial_pty(&tests[i]);
+		if (ret != S_OK)
+			break;
+	}
+
+	return ret;
+}
+
+/*
+ * Transmit queue test: buffers of a pool are queued until the queue
+ * refuses them, and queued again from their release callback. A
+ * thread reads the master side of the pty and checks the bytes.
+ */
+#define TX_BUFFERS	32
+#define TX_BUFFER_SIZE	1024
+#define TX_TOTAL	(8 * 1024 * 1024)
+
+struct tx_test {
+	artik_serial_module *serial;
+	artik_serial_handle handle;
+	unsigned char pool[TX_BUFFERS][TX_BUFFER_SIZE];
+	int free[TX_BUFFERS];
+	int num_free;
+	int master;
+	int sent;
+	int queued;
+	int released;
+	int refused;
+	int errors;
+	bool complete;
+};
+
+static unsigned char tx_byte(int offset)
+{
+	return offset % 251;
+}
+
+static void tx_fill(struct tx_test *test);
+
+static void tx_release(void *user_data, unsigned char *buf, int len,
+			artik_error result)
+{
+	struct tx_test *test = (struct tx_test *)user_data;
+
+	if (result != S_OK)
+		test->errors++;
+	test->released++;
+	test->free[test->num_free++] = (buf - test->pool[0]) / TX_BUFFER_SIZE;
+	tx_fill(test);
+}
+
+static void tx_fill(struct tx_test *test)
+{
+	while (test->sent < TX_TOTAL && test->num_free) {
+		int index = test->free[test->num_free - 1];
+		unsigned char *buf = test->pool[index];
+		int i;
+
+		for (i = 0; i < TX_BUFFER_SIZE; i++)
+			buf[i] = tx_byte(test->sent + i);
+
+		if (test->serial->queue_write(test->handle, buf,
+				TX_BUFFER_SIZE, tx_release, test) != S_OK) {
+			/* Wait for ARTIK_SERIAL_TX_READY */
+			test->refused++;
+			return;
+		}
+
+		test->num_free--;
+		test->sent += TX_BUFFER_SIZE;
+		test->queued++;
+	}
+}
+
+static void tx_event(void *user_data, artik_serial_tx_event_t event)
+{
+	struct tx_test *test = (struct tx_test *)user_data;
+
+	if (event == ARTIK_SERIAL_TX_READY) {
+		tx_fill(test);
+	} else if (test->sent == TX_TOTAL) {
+		artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+
+		test->complete = true;
+		loop->quit();
+		artik_release_api_module(loop);
+	}
+}
+
+static void *tx_reader(void *arg)
+{
+	struct tx_test *test = (struct tx_test *)arg;
+	unsigned char buf[16384];
+	int offset = 0;
+
+	while (offset < TX_TOTAL) {
+		int i, len = read(test->master, buf, sizeof(buf));
+
+		if (len <= 0)
+			break;
+		for (i = 0; i < len; i++)
+			if (buf[i] != tx_byte(offset + i))
+				test->errors++;
+		offset += len;
+	}
+
+	if (offset != TX_TOTAL)
+		test->errors++;
+
+	return NULL;
+}
+
+static artik_error test_serial_pty_tx(void)
+{
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_serial_config pty_config = config;
+	artik_serial_tx_limits limits = { 16, 8192 };
+	unsigned long long start, elapsed;
+	struct tx_test *test;
+	artik_error ret = S_OK;
+	pthread_t reader;
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	test = calloc(1, sizeof(*test));
+	if (!test) {
+		artik_release_api_module(loop);
+		return E_NO_MEM;
+	}
+	test->serial = (artik_serial_module *)
+				artik_request_api_module("serial");
+	for (i = 0; i < TX_BUFFERS; i++)
+		test->free[i] = i;
+	test->num_free = TX_BUFFERS;
+
+	test->master = open_pty(&pty_config.port_num);
+	if (test->master < 0) {
+		fprintf(stderr, "TEST: %s failed to open a pty\n", __func__);
+		ret = E_ACCESS_DENIED;
+		goto exit;
+	}
+	pty_config.name = "pty";
+	pty_config.baudrate = ARTIK_SERIAL_BAUD_4000000;
+
+	ret = test->serial->request(&test->handle, &pty_config);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s failed to request pty (%d)\n",
+			__func__, ret);
+		goto exit;
+	}
+
+	ret = test->serial->set_tx_limits(test->handle, &limits);
+	if (ret == S_OK)
+		ret = test->serial->set_tx_callback(test->handle, tx_event,
+									test);
+	if (ret != S_OK) {
+		fprintf(stderr, "TEST: %s failed to set up queue (%d)\n",
+			__func__, ret);
+		goto exit;
+	}
+
+	set_timeout(__func__, 30);
+	start = now_us();
+	if (pthread_create(&reader, NULL, tx_reader, test)) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+	tx_fill(test);
+	loop->run();
+	elapsed = now_us() - start;
+	pthread_join(reader, NULL);
+	unset_timeout();
+
+	if (test->errors || !test->complete || !test->refused ||
+	    test->released != test->queued) {
+		fprintf(stderr, "TEST: %s failed, %d errors, %d buffers"
+			" queued, %d released, %d refused\n", __func__,
+			test->errors, test->queued, test->released,
+			test->refused);
+		ret = E_BAD_ARGS;
+		goto exit;
+	}
+
+	fprintf(stdout, "BENCH: tx queue: %d buffers, %d bytes in %llu ms"
+		" (%.1f KB/s), %d refused\n", test->queued, test->sent,
+		elapsed / 1000, test->sent * 1000000.0 / 1024 / elapsed,
+		test->refused);
+	fprintf(stdout, "TEST: %s succeeded\n", __func__);
+
+exit:
+	if (test->handle)
+		test->serial->release(test->handle);
+	if (test->master >= 0)
+		close(test->master);
+	artik_release_api_module(test->serial);
+	artik_release_api_module(loop);
+	free(test);
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = S_OK;
@@ -187,6 +706,12 @@ int main(void)
 		return -1;
 	}
 
+	ret = test_serial_pty_framing();
+	if (ret == S_OK)
+		ret = test_serial_pty_tx();
+	if (ret != S_OK)
+		return -1;
+
 	if ((platid == ARTIK520) || (platid == ARTIK1020) ||
 		(platid == ARTIK710) || (platid == ARTIK530) ||
 		(platid == ARTIK305) || (platid == EAGLEYE530)) {
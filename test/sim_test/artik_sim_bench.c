@@ -0,0 +1,861 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <artik_module.h>
+#include <artik_loop.h>
+#include <artik_i2c.h>
+#include <artik_spi.h>
+#include <artik_gpio.h>
+#include <artik_adc.h>
+#include <artik_sensor.h>
+#include <artik_sim.h>
+#include <devices/HTS221.h>
+#include <devices/LPS25HBTR.h>
+#include <devices/K6DS3.h>
+
+/*
+ * Runs the I2C, SPI, GPIO and ADC modules and the sensor drivers on
+ * simulated devices, checking the register accesses, the fault and
+ * latency injection, the sensor models and the vector reads of the
+ * multi-axis sensors, then measures the time the SDK spends in each
+ * call on top of the simulation itself.
+ */
+
+/* Bus numbers no board uses */
+#define SIM_BUS		50
+#define SIM_REG_ADDR	0x50
+#define SIM_GPIO_IN	9000
+#define SIM_GPIO_OUT	9001
+#define SIM_ADC_PIN	9000
+#define SIM_EDGES	10
+#define BENCH_CALLS	100000
+#define SAMPLING_MSEC	500
+#define FIFO_RATE_HZ	416
+#define VECTOR_BLOCK	100
+#define FIFO_BLOCK	20
+#define K6DS3_REG_FIFO_CTRL5	0x0A
+/* Output data rate of the K6DS3 outside of sampling */
+#define VECTOR_RATE_HZ	1660
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static artik_i2c_config reg_config = { SIM_BUS, 400000, I2C_8BIT,
+							SIM_REG_ADDR };
+
+static artik_error test_sim_registers(void)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+					artik_request_api_module("i2c");
+	const unsigned char data[] = { 0x11, 0x22, 0x33, 0x44 };
+	char buf[4], reg = 0x12;
+	artik_sim_device *dev = NULL;
+	artik_i2c_handle handle = NULL;
+	artik_i2c_msg msgs[2];
+	artik_sim_stats stats;
+	artik_error ret;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&dev, ARTIK_SIM_I2C, SIM_BUS, SIM_REG_ADDR,
+							ARTIK_SIM_REGISTERS);
+	if (ret != S_OK)
+		goto exit;
+
+	ret = i2c->request(&handle, &reg_config);
+	if (ret != S_OK)
+		goto exit;
+
+	ret = i2c->write_register(handle, 0x10, (char *)data, 4);
+	if (ret == S_OK)
+		ret = i2c->read_register(handle, 0x10, buf, 4);
+	if (ret == S_OK && memcmp(buf, data, 4))
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	/* Plain write of the register address, then plain read */
+	ret = i2c->write(handle, &reg, 1);
+	if (ret == S_OK)
+		ret = i2c->read(handle, buf, 2);
+	if (ret == S_OK && memcmp(buf, data + 2, 2))
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	/* Messages are limited to the 16-bit length of the kernel */
+	if (i2c->read(handle, buf, 0x10000) != E_BAD_ARGS ||
+	    i2c->write(handle, buf, 0x10000) != E_BAD_ARGS) {
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	msgs[0].type = I2C_MSG_WRITE_REGISTER;
+	msgs[0].address = SIM_REG_ADDR;
+	msgs[0].reg = 0x80;
+	msgs[0].buffer = (char *)data;
+	msgs[0].len = 4;
+	msgs[1].type = I2C_MSG_READ_REGISTER;
+	msgs[1].address = SIM_REG_ADDR;
+	msgs[1].reg = 0x81;
+	msgs[1].buffer = buf;
+	msgs[1].len = 3;
+	ret = i2c->transfer(handle, msgs, 2);
+	if (ret == S_OK && memcmp(buf, data + 1, 3))
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	/* Nobody answers at the other address */
+	msgs[1].address = SIM_REG_ADDR + 1;
+	if (i2c->transfer(handle, msgs, 2) == S_OK) {
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	artik_sim_get_stats(dev, &stats);
+	if (stats.transactions != 7 || stats.bytes_read != 9 ||
+	    stats.bytes_written != 12)
+		ret = E_INVALID_VALUE;
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (handle)
+		i2c->release(handle);
+	if (dev)
+		artik_sim_remove_device(dev);
+	artik_release_api_module(i2c);
+
+	return ret;
+}
+
+static artik_error test_sim_faults(void)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+					artik_request_api_module("i2c");
+	const artik_sim_faults faults = { 4, 2, 3, E_TIMEOUT, 0 };
+	const artik_sim_faults corrupt = { 1, 0, 0, S_OK, 0x81 };
+	const unsigned char data[] = { 0x5a, 0x0f };
+	const unsigned char seq[] = { 1, 2, 3, 4, 5, 6 };
+	artik_sim_device *dev = NULL;
+	artik_i2c_handle handle = NULL;
+	artik_sim_stats stats;
+	artik_error ret;
+	char buf[2];
+	int i, failed = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&dev, ARTIK_SIM_I2C, SIM_BUS, SIM_REG_ADDR,
+							ARTIK_SIM_REGISTERS);
+	if (ret == S_OK)
+		ret = i2c->request(&handle, &reg_config);
+	if (ret == S_OK)
+		ret = artik_sim_write_registers(dev, 0x20, data, 2);
+	if (ret == S_OK)
+		ret = artik_sim_set_faults(dev, &faults);
+	if (ret != S_OK)
+		goto exit;
+
+	/* Transactions 2, 6 and 10 fail */
+	for (i = 0; i < 20; i++) {
+		artik_error err = i2c->read_register(handle, 0x20, buf, 2);
+
+		if (err != S_OK) {
+			if (err != E_TIMEOUT || (i - 2) % 4 || i > 10)
+				ret = E_INVALID_VALUE;
+			failed++;
+		}
+	}
+
+	artik_sim_get_stats(dev, &stats);
+	if (ret != S_OK || failed != 3 || stats.faults != 3) {
+		fprintf(stderr, "%d transactions failed\n", failed);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	ret = artik_sim_set_faults(dev, &corrupt);
+	if (ret == S_OK)
+		ret = i2c->read_register(handle, 0x20, buf, 2);
+	if (ret == S_OK && ((unsigned char)buf[0] != (0x5a ^ 0x81) ||
+			    (unsigned char)buf[1] != (0x0f ^ 0x81)))
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	/* Each read of the register gets the next pair of values */
+	artik_sim_set_faults(dev, NULL);
+	ret = artik_sim_set_sequence(dev, 0x30, seq, 2, 3);
+	for (i = 0; ret == S_OK && i < 6; i++) {
+		ret = i2c->read_register(handle, 0x30, buf, 2);
+		if (ret == S_OK && (buf[0] != seq[2 * (i % 3)] ||
+				    buf[1] != seq[2 * (i % 3) + 1]))
+			ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (handle)
+		i2c->release(handle);
+	if (dev)
+		artik_sim_remove_device(dev);
+	artik_release_api_module(i2c);
+
+	return ret;
+}
+
+static artik_error test_sim_latency(void)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+					artik_request_api_module("i2c");
+	/* 100 kHz bus: about 90 us per byte with its acknowledge */
+	const artik_sim_latency latency = { 50, 90000 };
+	artik_sim_device *dev = NULL;
+	artik_i2c_handle handle = NULL;
+	uint64_t start, elapsed;
+	artik_error ret;
+	char buf[6];
+	int i;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&dev, ARTIK_SIM_I2C, SIM_BUS, SIM_REG_ADDR,
+							ARTIK_SIM_REGISTERS);
+	if (ret == S_OK)
+		ret = artik_sim_set_latency(dev, &latency);
+	if (ret == S_OK)
+		ret = i2c->request(&handle, &reg_config);
+	if (ret != S_OK)
+		goto exit;
+
+	start = now_nsec();
+	for (i = 0; i < 20 && ret == S_OK; i++)
+		ret = i2c->read_register(handle, 0, buf, 6);
+	elapsed = now_nsec() - start;
+
+	/* 20 * (50 us + 6 * 90 us) */
+	if (ret == S_OK && elapsed < 11800000ULL)
+		ret = E_INVALID_VALUE;
+
+	fprintf(stdout, "BENCH: 20 reads of 6 bytes at 100 kHz in %llu us\n",
+		(unsigned long long)elapsed / 1000);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (handle)
+		i2c->release(handle);
+	if (dev)
+		artik_sim_remove_device(dev);
+	artik_release_api_module(i2c);
+
+	return ret;
+}
+
+struct fifo_test {
+	artik_sensor_module *sensor;
+	artik_sensor_sampling_handle sampling;
+	int batches;
+	int errors;
+};
+
+static void on_fifo_samples(void *user_data, const artik_sensor_sample *samples,
+			int count)
+{
+	struct fifo_test *test = (struct fifo_test *)user_data;
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (samples[i].values[0] != 100 ||
+		    samples[i].values[1] != -200 ||
+		    samples[i].values[2] != 16000)
+			test->errors++;
+
+	test->batches++;
+}
+
+static void stop_loop(void *user_data)
+{
+	artik_loop_module *loop = (artik_loop_module *)user_data;
+
+	loop->quit();
+}
+
+static artik_error test_sim_sensors(void)
+{
+	artik_sensor_module *sensor = (artik_sensor_module *)
+					artik_request_api_module("sensor");
+	artik_loop_module *loop = (artik_loop_module *)
+					artik_request_api_module("loop");
+	artik_i2c_config hts221_i2c = { SIM_BUS, 100000, I2C_8BIT,
+								HTS221_ADDR };
+	artik_i2c_config lps25hbtr_i2c = { SIM_BUS, 100000, I2C_8BIT,
+							LPS25HBTR_ADDR };
+	artik_spi_config k6ds3_spi = { SIM_BUS, 0, SPI_MODE3, 8, 500000 };
+	artik_sensor_config hts221_config = { ARTIK_SENSOR_HUMIDITY,
+		(char *)"hts221_humidity", &hts221_i2c,
+		&hts221_humidity_sensor };
+	artik_sensor_config lps25hbtr_config = { ARTIK_SENSOR_BAROMETER,
+		(char *)"lps25hbtr_barometer", &lps25hbtr_i2c,
+		&lps25hbtr_barometer_sensor };
+	artik_sensor_config k6ds3_config = { ARTIK_SENSOR_ACCELEROMETER,
+		(char *)"k6ds3_accelerometer", &k6ds3_spi, &k6ds3_xl_sensor };
+	artik_sensor_sampling_config params = { FIFO_RATE_HZ, 16, true };
+	const double humidity[] = { 62.0, 24.0 };
+	const double pressure[] = { 987.0, 24.0 };
+	const double xl[] = { 100, -200, 16000 };
+	artik_sim_device *hts221 = NULL, *lps25hbtr = NULL, *k6ds3 = NULL;
+	artik_sensor_handle hts221_handle = NULL, lps25hbtr_handle = NULL;
+	artik_sensor_handle k6ds3_handle = NULL;
+	struct fifo_test fifo = { sensor, NULL, 0, 0 };
+	artik_sensor_sampling_stats stats;
+	unsigned long long expected;
+	artik_sensor_ops ops;
+	artik_error ret;
+	int value, z, timeout_id;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&hts221, ARTIK_SIM_I2C, SIM_BUS,
+					HTS221_ADDR, ARTIK_SIM_HTS221);
+	if (ret == S_OK)
+		ret = artik_sim_add_device(&lps25hbtr, ARTIK_SIM_I2C, SIM_BUS,
+				LPS25HBTR_ADDR, ARTIK_SIM_LPS25HBTR);
+	if (ret == S_OK)
+		ret = artik_sim_add_device(&k6ds3, ARTIK_SIM_SPI, SIM_BUS, 0,
+							ARTIK_SIM_K6DS3);
+	if (ret != S_OK)
+		goto exit;
+
+	ret = sensor->request(&hts221_config, &hts221_handle, &ops);
+	if (ret == S_OK)
+		ret = sensor->request(&lps25hbtr_config, &lps25hbtr_handle,
+									&ops);
+	if (ret == S_OK)
+		ret = sensor->request(&k6ds3_config, &k6ds3_handle, &ops);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request the sensors (%d)\n", ret);
+		goto exit;
+	}
+
+	/* Values at reset */
+	ret = hts221_humidity_sensor.get_humidity(hts221_handle, &value);
+	if (ret == S_OK && value != 50)
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK)
+		ret = k6ds3_xl_sensor.get_speed_z(k6ds3_handle, &z);
+	if (ret == S_OK && z != 16384)
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	artik_sim_set_values(hts221, humidity, 2);
+	artik_sim_set_values(lps25hbtr, pressure, 2);
+	artik_sim_set_values(k6ds3, xl, 3);
+
+	ret = hts221_humidity_sensor.get_humidity(hts221_handle, &value);
+	if (ret == S_OK && value != 62)
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK)
+		ret = lps25hbtr_barometer_sensor.get_pressure(lps25hbtr_handle,
+									&value);
+	if (ret == S_OK && value != 987)
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK)
+		ret = k6ds3_xl_sensor.get_speed_x(k6ds3_handle, &value);
+	if (ret == S_OK && value != 100)
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK) {
+		fprintf(stderr, "Unexpected sensor value %d\n", value);
+		goto exit;
+	}
+
+	/* Rates the loop could not keep up with are rejected */
+	params.rate_hz = ARTIK_SENSOR_MAX_RATE_HZ + 1;
+	ret = sensor->start_sampling(&fifo.sampling, &k6ds3_config,
+			k6ds3_handle, &params, on_fifo_samples, &fifo);
+	params.rate_hz = FIFO_RATE_HZ;
+	if (ret != E_BAD_ARGS) {
+		fprintf(stderr, "Sampling at %u Hz not rejected (%d)\n",
+							params.rate_hz, ret);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	/* Accelerometer samples queued in the simulated FIFO */
+	ret = sensor->start_sampling(&fifo.sampling, &k6ds3_config,
+			k6ds3_handle, &params, on_fifo_samples, &fifo);
+	if (ret != S_OK)
+		goto exit;
+
+	loop->add_timeout_callback(&timeout_id, SAMPLING_MSEC, stop_loop,
+									loop);
+	loop->run();
+
+	sensor->get_sampling_stats(fifo.sampling, &stats);
+	expected = (unsigned long long)stats.rate_hz * SAMPLING_MSEC / 1000;
+	if (fifo.errors || stats.errors || !fifo.batches ||
+	    stats.samples + 2 * params.batch < expected)
+		ret = E_INVALID_VALUE;
+
+	fprintf(stdout, "BENCH: FIFO: %llu samples at %u Hz in %d batches, "
+		"%llu reads, %d errors\n", stats.samples, stats.rate_hz,
+		fifo.batches, stats.reads, fifo.errors);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (fifo.sampling)
+		sensor->stop_sampling(fifo.sampling);
+	if (k6ds3_handle)
+		k6ds3_xl_sensor.release(k6ds3_handle);
+	if (lps25hbtr_handle)
+		lps25hbtr_barometer_sensor.release(lps25hbtr_handle);
+	if (hts221_handle)
+		hts221_humidity_sensor.release(hts221_handle);
+	if (k6ds3)
+		artik_sim_remove_device(k6ds3);
+	if (lps25hbtr)
+		artik_sim_remove_device(lps25hbtr);
+	if (hts221)
+		artik_sim_remove_device(hts221);
+	artik_release_api_module(loop);
+	artik_release_api_module(sensor);
+
+	return ret;
+}
+
+static artik_error check_block(const char *name,
+			const artik_sensor_vector *vectors, int count,
+			const artik_sensor_vector *expected,
+			unsigned int rate_hz, uint64_t elapsed)
+{
+	uint64_t period = 1000000000ULL / rate_hz;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (vectors[i].x != expected->x ||
+		    vectors[i].y != expected->y ||
+		    vectors[i].z != expected->z) {
+			fprintf(stderr, "%s: unexpected sample %d\n", name, i);
+			return E_INVALID_VALUE;
+		}
+		if (i && vectors[i].timestamp_ns <=
+					vectors[i - 1].timestamp_ns) {
+			fprintf(stderr, "%s: sample %d not after the previous"
+				" one\n", name, i);
+			return E_INVALID_VALUE;
+		}
+	}
+
+	/* Samples cannot come faster than the device makes them */
+	if (elapsed < (count - 1) * period) {
+		fprintf(stderr, "%s: %d samples read in %llu us\n", name,
+				count, (unsigned long long)elapsed / 1000);
+		return E_INVALID_VALUE;
+	}
+
+	fprintf(stdout, "BENCH: %s: %d samples in %llu us, %llu us apart\n",
+		name, count, (unsigned long long)elapsed / 1000,
+		(vectors[count - 1].timestamp_ns - vectors[0].timestamp_ns) /
+							(count - 1) / 1000);
+
+	return S_OK;
+}
+
+static artik_error test_sim_vectors(void)
+{
+	artik_sensor_module *sensor = (artik_sensor_module *)
+					artik_request_api_module("sensor");
+	artik_spi_config k6ds3_spi = { SIM_BUS, 0, SPI_MODE3, 8, 500000 };
+	artik_sensor_config xl_config = { ARTIK_SENSOR_ACCELEROMETER,
+		(char *)"k6ds3_accelerometer", &k6ds3_spi, &k6ds3_xl_sensor };
+	artik_sensor_config gyro_config = { ARTIK_SENSOR_GYRO,
+		(char *)"k6ds3_gyro", &k6ds3_spi, &k6ds3_gyro_sensor };
+	const double values[] = { 100, -200, 16000, 10, -20, 30 };
+	const artik_sensor_vector xl = { 0, 100, -200, 16000 };
+	const artik_sensor_vector gyro = { 0, 10, -20, 30 };
+	artik_sensor_sampling_config params = { FIFO_RATE_HZ, 16, true,
+									16 };
+	artik_sensor_sampling_handle sampling = NULL;
+	artik_sensor_vector vectors[VECTOR_BLOCK];
+	artik_sensor_handle xl_handle = NULL, gyro_handle = NULL;
+	unsigned char fifo_mode = 0;
+	artik_sim_device *k6ds3 = NULL;
+	artik_sensor_ops ops;
+	uint64_t start, end;
+	artik_error ret;
+	int pitch = 0;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&k6ds3, ARTIK_SIM_SPI, SIM_BUS, 0,
+							ARTIK_SIM_K6DS3);
+	if (ret == S_OK)
+		ret = artik_sim_set_values(k6ds3, values, 6);
+	if (ret == S_OK)
+		ret = sensor->request(&xl_config, &xl_handle, &ops);
+	if (ret == S_OK)
+		ret = sensor->request(&gyro_config, &gyro_handle, &ops);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request the sensors (%d)\n", ret);
+		goto exit;
+	}
+
+	/* One sample, the three axes read together */
+	start = now_nsec();
+	ret = k6ds3_xl_sensor.read_vector(xl_handle, &vectors[0]);
+	end = now_nsec();
+	if (ret == S_OK && (vectors[0].x != xl.x || vectors[0].y != xl.y ||
+	    vectors[0].z != xl.z || vectors[0].timestamp_ns < start ||
+	    vectors[0].timestamp_ns > end))
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK)
+		ret = k6ds3_gyro_sensor.read_vector(gyro_handle, &vectors[0]);
+	if (ret == S_OK)
+		ret = k6ds3_gyro_sensor.get_pitch(gyro_handle, &pitch);
+	if (ret == S_OK && (vectors[0].x != pitch || vectors[0].x != gyro.x ||
+	    vectors[0].y != gyro.y || vectors[0].z != gyro.z))
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK) {
+		fprintf(stderr, "Unexpected vector (%d)\n", ret);
+		goto exit;
+	}
+
+	/* Accelerometer blocks come from the FIFO, gyro ones are paced */
+	start = now_nsec();
+	ret = k6ds3_xl_sensor.read_block(xl_handle, vectors, VECTOR_BLOCK);
+	end = now_nsec();
+	if (ret == S_OK)
+		ret = check_block("accelerometer block", vectors,
+				VECTOR_BLOCK, &xl, VECTOR_RATE_HZ, end - start);
+	if (ret != S_OK)
+		goto exit;
+
+	start = now_nsec();
+	ret = k6ds3_gyro_sensor.read_block(gyro_handle, vectors, VECTOR_BLOCK);
+	end = now_nsec();
+	if (ret == S_OK)
+		ret = check_block("gyro block", vectors, VECTOR_BLOCK, &gyro,
+					VECTOR_RATE_HZ, end - start);
+	if (ret != S_OK)
+		goto exit;
+
+	/* The FIFO is stopped and the getters work again */
+	ret = k6ds3_xl_sensor.read_vector(xl_handle, &vectors[0]);
+	if (ret == S_OK && vectors[0].z != xl.z)
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK && k6ds3_xl_sensor.read_block(xl_handle, vectors, 0) !=
+								E_BAD_ARGS)
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	/* Blocks are paced at the sampling rate while it uses the FIFO */
+	ret = sensor->start_sampling(&sampling, &xl_config, xl_handle,
+						&params, NULL, NULL);
+	if (ret != S_OK)
+		goto exit;
+
+	start = now_nsec();
+	ret = k6ds3_xl_sensor.read_block(xl_handle, vectors, FIFO_BLOCK);
+	end = now_nsec();
+	if (ret == S_OK)
+		ret = check_block("accelerometer block while sampling",
+				vectors, FIFO_BLOCK, &xl, FIFO_RATE_HZ,
+				end - start);
+	if (ret == S_OK)
+		ret = artik_sim_read_registers(k6ds3, K6DS3_REG_FIFO_CTRL5,
+								&fifo_mode, 1);
+	if (ret == S_OK && !fifo_mode) {
+		fprintf(stderr, "The FIFO of the sampling was stopped\n");
+		ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (sampling)
+		sensor->stop_sampling(sampling);
+	if (gyro_handle)
+		k6ds3_gyro_sensor.release(gyro_handle);
+	if (xl_handle)
+		k6ds3_xl_sensor.release(xl_handle);
+	if (k6ds3)
+		artik_sim_remove_device(k6ds3);
+	artik_release_api_module(sensor);
+
+	return ret;
+}
+
+struct gpio_test {
+	artik_loop_module *loop;
+	int edges;
+	int errors;
+};
+
+static void on_gpio_change(void *user_data, int value)
+{
+	struct gpio_test *test = (struct gpio_test *)user_data;
+
+	/* Starting low, odd edges are rising */
+	if (value != (++test->edges & 1))
+		test->errors++;
+
+	if (test->edges == SIM_EDGES)
+		test->loop->quit();
+}
+
+static artik_error test_sim_gpio_adc(void)
+{
+	artik_gpio_module *gpio = (artik_gpio_module *)
+					artik_request_api_module("gpio");
+	artik_adc_module *adc = (artik_adc_module *)
+					artik_request_api_module("adc");
+	artik_gpio_config in_config = { SIM_GPIO_IN, (char *)"sim in", GPIO_IN,
+							GPIO_EDGE_BOTH, 0 };
+	artik_gpio_config out_config = { SIM_GPIO_OUT, (char *)"sim out",
+						GPIO_OUT, GPIO_EDGE_NONE, 1 };
+	artik_adc_config adc_config = { SIM_ADC_PIN, (char *)"sim adc" };
+	const int levels[] = { 100, 2000, 4095 };
+	struct gpio_test test = { NULL, 0, 0 };
+	artik_gpio_handle in = NULL, out = NULL;
+	artik_adc_handle pin = NULL;
+	artik_error ret;
+	int i, value;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	test.loop = (artik_loop_module *)artik_request_api_module("loop");
+
+	ret = artik_sim_add_gpio(SIM_GPIO_IN, 0);
+	if (ret == S_OK)
+		ret = artik_sim_add_gpio(SIM_GPIO_OUT, 0);
+	if (ret == S_OK)
+		ret = artik_sim_add_adc(SIM_ADC_PIN, levels, 3);
+	if (ret == S_OK)
+		ret = gpio->request(&in, &in_config);
+	if (ret == S_OK)
+		ret = gpio->request(&out, &out_config);
+	if (ret == S_OK)
+		ret = adc->request(&pin, &adc_config);
+	if (ret != S_OK)
+		goto exit;
+
+	/* The output starts at its initial value */
+	artik_sim_get_gpio(SIM_GPIO_OUT, &value);
+	if (value != 1)
+		ret = E_INVALID_VALUE;
+	if (ret == S_OK)
+		ret = gpio->write(out, 0);
+	artik_sim_get_gpio(SIM_GPIO_OUT, &value);
+	if (ret == S_OK && value != 0)
+		ret = E_INVALID_VALUE;
+	if (ret != S_OK)
+		goto exit;
+
+	ret = gpio->set_change_callback(in, on_gpio_change, &test);
+	if (ret != S_OK)
+		goto exit;
+
+	/* Edges are queued until the loop runs, the repeated level is not */
+	for (i = 1; i <= SIM_EDGES; i++) {
+		artik_sim_set_gpio(SIM_GPIO_IN, i & 1);
+		artik_sim_set_gpio(SIM_GPIO_IN, i & 1);
+	}
+	test.loop->run();
+
+	if (test.errors || gpio->read(in) != (SIM_EDGES & 1))
+		ret = E_INVALID_VALUE;
+
+	/* The loop still watches the GPIO */
+	if (ret == S_OK && artik_sim_remove_gpio(SIM_GPIO_IN) != E_BUSY)
+		ret = E_INVALID_VALUE;
+
+	for (i = 0; ret == S_OK && i < 6; i++) {
+		ret = adc->get_value(pin, &value);
+		if (ret == S_OK && value != levels[i % 3])
+			ret = E_INVALID_VALUE;
+	}
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (pin)
+		adc->release(pin);
+	if (out)
+		gpio->release(out);
+	if (in)
+		gpio->release(in);
+	artik_sim_remove_adc(SIM_ADC_PIN);
+	artik_sim_remove_gpio(SIM_GPIO_OUT);
+	artik_sim_remove_gpio(SIM_GPIO_IN);
+	artik_release_api_module(test.loop);
+	artik_release_api_module(adc);
+	artik_release_api_module(gpio);
+
+	return ret;
+}
+
+/* Time spent per call by the SDK, above the simulated register accesses */
+static artik_error bench(void)
+{
+	artik_i2c_module *i2c = (artik_i2c_module *)
+					artik_request_api_module("i2c");
+	artik_spi_module *spi = (artik_spi_module *)
+					artik_request_api_module("spi");
+	artik_gpio_module *gpio = (artik_gpio_module *)
+					artik_request_api_module("gpio");
+	artik_adc_module *adc = (artik_adc_module *)
+					artik_request_api_module("adc");
+	artik_spi_config spi_config = { SIM_BUS, 1, SPI_MODE0, 8, 1000000 };
+	artik_gpio_config gpio_config = { SIM_GPIO_IN, (char *)"sim", GPIO_IN,
+							GPIO_EDGE_NONE, 0 };
+	artik_adc_config adc_config = { SIM_ADC_PIN, (char *)"sim adc" };
+	const int level = 1234;
+	artik_sim_device *i2c_dev = NULL, *spi_dev = NULL;
+	artik_i2c_handle i2c_handle = NULL;
+	artik_spi_handle spi_handle = NULL;
+	artik_gpio_handle gpio_handle = NULL;
+	artik_adc_handle adc_handle = NULL;
+	char tx[3] = { (char)0x80, 0, 0 }, rx[3];
+	unsigned char regs[2];
+	uint64_t start, base, elapsed;
+	artik_error ret;
+	int i, value;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	ret = artik_sim_add_device(&i2c_dev, ARTIK_SIM_I2C, SIM_BUS,
+				SIM_REG_ADDR, ARTIK_SIM_REGISTERS);
+	if (ret == S_OK)
+		ret = artik_sim_add_device(&spi_dev, ARTIK_SIM_SPI, SIM_BUS, 1,
+							ARTIK_SIM_REGISTERS);
+	if (ret == S_OK)
+		ret = artik_sim_add_gpio(SIM_GPIO_IN, 0);
+	if (ret == S_OK)
+		ret = artik_sim_add_adc(SIM_ADC_PIN, &level, 1);
+	if (ret == S_OK)
+		ret = i2c->request(&i2c_handle, &reg_config);
+	if (ret == S_OK)
+		ret = spi->request(&spi_handle, &spi_config);
+	if (ret == S_OK)
+		ret = gpio->request(&gpio_handle, &gpio_config);
+	if (ret == S_OK)
+		ret = adc->request(&adc_handle, &adc_config);
+	if (ret != S_OK)
+		goto exit;
+
+	start = now_nsec();
+	for (i = 0; i < BENCH_CALLS; i++)
+		artik_sim_read_registers(i2c_dev, 0, regs, 2);
+	base = now_nsec() - start;
+	fprintf(stdout, "BENCH: simulated register access: %llu ns\n",
+		(unsigned long long)base / BENCH_CALLS);
+
+	start = now_nsec();
+	for (i = 0; i < BENCH_CALLS && ret == S_OK; i++)
+		ret = i2c->read_register(i2c_handle, 0, rx, 2);
+	elapsed = now_nsec() - start;
+	fprintf(stdout, "BENCH: i2c read_register: %llu ns per call, %lld ns"
+		" in the SDK\n", (unsigned long long)elapsed / BENCH_CALLS,
+		(long long)(elapsed - base) / BENCH_CALLS);
+
+	start = now_nsec();
+	for (i = 0; i < BENCH_CALLS && ret == S_OK; i++)
+		ret = spi->read_write(spi_handle, tx, rx, 3);
+	elapsed = now_nsec() - start;
+	fprintf(stdout, "BENCH: spi read_write: %llu ns per call, %lld ns"
+		" in the SDK\n", (unsigned long long)elapsed / BENCH_CALLS,
+		(long long)(elapsed - base) / BENCH_CALLS);
+
+	start = now_nsec();
+	for (i = 0; i < BENCH_CALLS && ret == S_OK; i++)
+		if (gpio->read(gpio_handle) < 0)
+			ret = E_ACCESS_DENIED;
+	elapsed = now_nsec() - start;
+	fprintf(stdout, "BENCH: gpio read: %llu ns per call\n",
+		(unsigned long long)elapsed / BENCH_CALLS);
+
+	start = now_nsec();
+	for (i = 0; i < BENCH_CALLS && ret == S_OK; i++)
+		ret = adc->get_value(adc_handle, &value);
+	elapsed = now_nsec() - start;
+	fprintf(stdout, "BENCH: adc get_value: %llu ns per call\n",
+		(unsigned long long)elapsed / BENCH_CALLS);
+
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+	if (adc_handle)
+		adc->release(adc_handle);
+	if (gpio_handle)
+		gpio->release(gpio_handle);
+	if (spi_handle)
+		spi->release(spi_handle);
+	if (i2c_handle)
+		i2c->release(i2c_handle);
+	artik_sim_remove_adc(SIM_ADC_PIN);
+	artik_sim_remove_gpio(SIM_GPIO_IN);
+	if (spi_dev)
+		artik_sim_remove_device(spi_dev);
+	if (i2c_dev)
+		artik_sim_remove_device(i2c_dev);
+	artik_release_api_module(adc);
+	artik_release_api_module(gpio);
+	artik_release_api_module(spi);
+	artik_release_api_module(i2c);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	artik_error ret;
+
+	ret = test_sim_registers();
+	if (ret == S_OK)
+		ret = test_sim_faults();
+	if (ret == S_OK)
+		ret = test_sim_latency();
+	if (ret == S_OK)
+		ret = test_sim_sensors();
+	if (ret == S_OK)
+		ret = test_sim_vectors();
+	if (ret == S_OK)
+		ret = test_sim_gpio_adc();
+	if (ret == S_OK)
+		ret = bench();
+
+	return (ret == S_OK) ? 0 : -1;
+}
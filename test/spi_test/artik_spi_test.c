@@ -21,6 +21,9 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #include <artik_module.h>
 #include <artik_platform.h>
@@ -99,12 +102,131 @@ exit:
 	return ret;
 }
 
+#define SEGMENT_LEN		16
+#define SEGMENT_COUNT		16
+#define BENCH_LOOPS		100
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static artik_error spi_test_transfer(int platid)
+{
+	artik_spi_module *spi = (artik_spi_module *)
+						artik_request_api_module("spi");
+	artik_spi_segment segments[SEGMENT_COUNT];
+	artik_spi_handle handle;
+	unsigned long long start, single_ns, list_ns;
+	char *tx = NULL, *rx = NULL;
+	artik_error ret;
+	int i, j;
+
+	fprintf(stdout, "TEST: %s starting\n", __func__);
+
+	if ((platid == ARTIK710) || (platid == ARTIK530) ||
+			(platid == ARTIK305) || (platid == EAGLEYE530))
+		config.bus = 2;
+
+	/* Buffers reused for every transfer, aligned on cache lines */
+	if (posix_memalign((void **)&tx, 64, SEGMENT_LEN * SEGMENT_COUNT) ||
+		posix_memalign((void **)&rx, 64, SEGMENT_LEN * SEGMENT_COUNT)) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+
+	for (i = 0; i < SEGMENT_LEN * SEGMENT_COUNT; i++)
+		tx[i] = (char)(i * 7 + 1);
+
+	ret = spi->request(&handle, &config);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to request SPI %d\n", ret);
+		goto exit;
+	}
+
+	memset(segments, 0, sizeof(segments));
+	for (i = 0; i < SEGMENT_COUNT; i++) {
+		segments[i].tx_buf = tx + i * SEGMENT_LEN;
+		segments[i].rx_buf = rx + i * SEGMENT_LEN;
+		segments[i].len = SEGMENT_LEN;
+	}
+	/* Receive only segment, zeros are sent */
+	segments[1].tx_buf = NULL;
+	segments[2].delay_usecs = 10;
+	segments[3].cs_change = true;
+
+	memset(rx, 0xff, SEGMENT_LEN * SEGMENT_COUNT);
+	ret = spi->transfer(handle, segments, SEGMENT_COUNT);
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to transfer SPI segments %d\n", ret);
+		goto release;
+	}
+
+	for (i = 0; i < SEGMENT_COUNT; i++) {
+		for (j = 0; j < SEGMENT_LEN; j++) {
+			int k = i * SEGMENT_LEN + j;
+			char expected = segments[i].tx_buf ? tx[k] : 0;
+
+			if (rx[k] != expected) {
+				fprintf(stderr, "Segment %d byte %d: %.2X %.2X\n",
+					i, j, expected & 0xff, rx[k] & 0xff);
+				ret = E_TRY_AGAIN;
+				goto release;
+			}
+		}
+	}
+
+	segments[1].tx_buf = tx + SEGMENT_LEN;
+	segments[2].delay_usecs = 0;
+	segments[3].cs_change = false;
+
+	start = now_ns();
+	for (i = 0; i < BENCH_LOOPS && ret == S_OK; i++)
+		for (j = 0; j < SEGMENT_COUNT && ret == S_OK; j++)
+			ret = spi->read_write(handle, tx + j * SEGMENT_LEN,
+					rx + j * SEGMENT_LEN, SEGMENT_LEN);
+	single_ns = (now_ns() - start) / BENCH_LOOPS;
+
+	start = now_ns();
+	for (i = 0; i < BENCH_LOOPS && ret == S_OK; i++)
+		ret = spi->transfer(handle, segments, SEGMENT_COUNT);
+	list_ns = (now_ns() - start) / BENCH_LOOPS;
+
+	if (ret != S_OK) {
+		fprintf(stderr, "Failed to run SPI benchmark %d\n", ret);
+		goto release;
+	}
+
+	fprintf(stdout, "BENCH: %d x %d bytes, single %llu ns, list %llu ns\n",
+		SEGMENT_COUNT, SEGMENT_LEN, single_ns, list_ns);
+
+release:
+	if (spi->release(handle) != S_OK)
+		fprintf(stderr, "Failed to release spidev%d.%d\n",
+			config.bus, config.cs);
+exit:
+	fprintf(stdout, "TEST: %s %s\n", __func__, (ret == S_OK) ? "succeeded" :
+								"failed");
+
+	free(tx);
+	free(rx);
+	artik_release_api_module(spi);
+
+	return ret;
+}
+
 int main(void)
 {
 	artik_error ret = S_OK;
 	int platid = artik_get_platform();
 
 	ret = spi_test(platid);
+	if (ret == S_OK)
+		ret = spi_test_transfer(platid);
 
 	return (ret == S_OK) ? 0 : -1;
 }
@@ -0,0 +1,212 @@
+/*
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <artik_module.h>
+#include <artik_time.h>
+
+/*
+ * Measures the per-call cost of the time sources and of the histogram
+ * instrumentation, so that callers know what wrapping a code path with a
+ * timer adds to it.
+ */
+
+#define DEFAULT_ITERATIONS	1000000
+#define NUM_THREADS		4
+
+struct bench_thread {
+	artik_time_module *time;
+	artik_time_histogram hist;
+	int iterations;
+};
+
+static uint64_t now_nsec(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t run_clock(clockid_t clock, int iterations)
+{
+	uint64_t start = now_nsec(CLOCK_MONOTONIC);
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		now_nsec(clock);
+
+	return now_nsec(CLOCK_MONOTONIC) - start;
+}
+
+static uint64_t run_monotonic(artik_time_module *time, int iterations)
+{
+	uint64_t start = time->get_monotonic_ns();
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		time->get_monotonic_ns();
+
+	return time->get_elapsed_ns(start);
+}
+
+static uint64_t run_tick(artik_time_module *time, int iterations)
+{
+	uint64_t start = time->get_monotonic_ns();
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		time->get_tick();
+
+	return time->get_elapsed_ns(start);
+}
+
+static uint64_t run_record(artik_time_module *time, artik_time_histogram hist,
+			int iterations)
+{
+	uint64_t start = time->get_monotonic_ns();
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		time->record_histogram(hist, i);
+
+	return time->get_elapsed_ns(start);
+}
+
+static uint64_t run_timer(artik_time_module *time, artik_time_histogram hist,
+			int iterations)
+{
+	uint64_t start = time->get_monotonic_ns();
+	artik_time_timer timer;
+	int i;
+
+	for (i = 0; i < iterations; i++) {
+		time->start_timer(hist, &timer);
+		time->stop_timer(&timer);
+	}
+
+	return time->get_elapsed_ns(start);
+}
+
+static void *bench_thread_func(void *user_data)
+{
+	struct bench_thread *thread = (struct bench_thread *)user_data;
+
+	run_timer(thread->time, thread->hist, thread->iterations);
+
+	return NULL;
+}
+
+static uint64_t run_threads(artik_time_module *time, artik_time_histogram hist,
+			int iterations)
+{
+	struct bench_thread threads[NUM_THREADS];
+	pthread_t ids[NUM_THREADS];
+	uint64_t start = time->get_monotonic_ns();
+	int i;
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		threads[i].time = time;
+		threads[i].hist = hist;
+		threads[i].iterations = iterations / NUM_THREADS;
+		pthread_create(&ids[i], NULL, bench_thread_func, &threads[i]);
+	}
+
+	for (i = 0; i < NUM_THREADS; i++)
+		pthread_join(ids[i], NULL);
+
+	return time->get_elapsed_ns(start);
+}
+
+static void print_result(const char *name, uint64_t elapsed, int iterations)
+{
+	fprintf(stdout, "BENCH: %-34s %8.1f nsec/call\n", name,
+		(double)elapsed / iterations);
+}
+
+static void print_stats(artik_time_module *time, const char *name,
+			artik_time_histogram hist)
+{
+	artik_time_histogram_stats stats;
+
+	time->get_histogram_stats(hist, &stats);
+	fprintf(stdout, "BENCH: %-34s count %llu min %llu mean %llu p50 %llu "
+		"p90 %llu p99 %llu max %llu nsec\n", name,
+		(unsigned long long)stats.count,
+		(unsigned long long)stats.min_ns,
+		(unsigned long long)stats.mean_ns,
+		(unsigned long long)stats.p50_ns,
+		(unsigned long long)stats.p90_ns,
+		(unsigned long long)stats.p99_ns,
+		(unsigned long long)stats.max_ns);
+}
+
+int main(int argc, char *argv[])
+{
+	artik_time_module *time = (artik_time_module *)
+					artik_request_api_module("time");
+	int iterations = DEFAULT_ITERATIONS;
+	artik_time_histogram hist;
+
+	if (!time) {
+		fprintf(stdout, "TEST: Time module is not available\n");
+		return -1;
+	}
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+
+	if (iterations <= 0 || time->create_histogram(&hist) != S_OK) {
+		artik_release_api_module(time);
+		return -1;
+	}
+
+	print_result("clock_gettime(CLOCK_MONOTONIC)",
+		run_clock(CLOCK_MONOTONIC, iterations), iterations);
+	print_result("clock_gettime(CLOCK_MONOTONIC_RAW)",
+		run_clock(CLOCK_MONOTONIC_RAW, iterations), iterations);
+	print_result("clock_gettime(CLOCK_REALTIME)",
+		run_clock(CLOCK_REALTIME, iterations), iterations);
+	print_result("get_monotonic_ns", run_monotonic(time, iterations),
+		iterations);
+	print_result("get_tick", run_tick(time, iterations), iterations);
+	print_result("record_histogram", run_record(time, hist, iterations),
+		iterations);
+
+	time->reset_histogram(hist);
+	print_result("start_timer + stop_timer",
+		run_timer(time, hist, iterations), iterations);
+	print_stats(time, "empty timed section", hist);
+
+	time->reset_histogram(hist);
+	print_result("start_timer + stop_timer, 4 threads",
+		run_threads(time, hist, iterations), iterations);
+	print_stats(time, "empty timed section, 4 threads", hist);
+
+	time->destroy_histogram(hist);
+	artik_release_api_module(time);
+
+	return 0;
+}
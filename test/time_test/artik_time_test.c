@@ -32,6 +32,11 @@
 #include <unistd.h>
 #include <time.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 #include <artik_module.h>
 #include <artik_loop.h>
@@ -211,6 +216,398 @@ static artik_error test_time_loopback(void)
 	return ret;
 }
 
+static artik_error test_monotonic_histogram(void)
+{
+	artik_error ret = S_OK;
+	artik_time_histogram hist;
+	artik_time_histogram_stats stats;
+	artik_time_timer timer;
+	uint64_t prev, now;
+	int i;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	prev = time_module_p->get_monotonic_ns();
+	for (i = 0; i < 1000; i++) {
+		now = time_module_p->get_monotonic_ns();
+		if (now < prev) {
+			fprintf(stdout, "TEST: %s failed: clock went back\n",
+				__func__);
+			return E_INVALID_VALUE;
+		}
+		prev = now;
+	}
+
+	ret = time_module_p->create_histogram(&hist);
+	if (ret != S_OK) {
+		fprintf(stdout, "TEST: %s failed: ERROR(%d)\n", __func__,
+			ret);
+		return ret;
+	}
+
+	for (i = 1; i <= 1000; i++)
+		time_module_p->record_histogram(hist, i);
+
+	time_module_p->get_histogram_stats(hist, &stats);
+	if (stats.count != 1000 || stats.min_ns != 1 ||
+			stats.max_ns != 1000 || stats.mean_ns != 500 ||
+			stats.p50_ns < 437 || stats.p50_ns > 563 ||
+			stats.p90_ns < 787 || stats.p90_ns > 1000 ||
+			stats.p99_ns < 866 || stats.p99_ns > 1000) {
+		fprintf(stdout, "TEST: %s failed: wrong statistics\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	time_module_p->reset_histogram(hist);
+	time_module_p->start_timer(hist, &timer);
+	usleep(10000);
+	time_module_p->stop_timer(&timer);
+
+	time_module_p->get_histogram_stats(hist, &stats);
+	if (stats.count != 1 || stats.min_ns < 10000000) {
+		fprintf(stdout, "TEST: %s failed: wrong timer duration\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	fprintf(stdout, "TEST: %s finished\n", __func__);
+
+exit:
+	time_module_p->destroy_histogram(hist);
+
+	return ret;
+}
+
+#define NUM_ALARMS	100000
+#define ALARM_SPREAD_MS	1000
+
+struct alarm_entry {
+	artik_alarm_handle handle;
+	uint64_t deadline_ns;
+	int fired;
+};
+
+static struct alarm_entry *alarms;
+static uint64_t last_deadline_ns;
+static int alarms_fired, alarms_early, alarms_unordered;
+static int periodic_fired;
+
+static void _alarm_scheduler_callback(void *user_data)
+{
+	struct alarm_entry *entry = user_data;
+
+	if (time_module_p->get_monotonic_ns() < entry->deadline_ns)
+		alarms_early++;
+	/* Alarms due in the same millisecond may fire in any order */
+	if (entry->deadline_ns + 1000000 < last_deadline_ns)
+		alarms_unordered++;
+	if (entry->deadline_ns > last_deadline_ns)
+		last_deadline_ns = entry->deadline_ns;
+
+	entry->fired++;
+	alarms_fired++;
+}
+
+static void _alarm_periodic_callback(void *user_data)
+{
+	periodic_fired++;
+}
+
+static void _alarm_quit_callback(void *user_data)
+{
+	loop->quit();
+}
+
+static artik_error test_alarm_scheduler(void)
+{
+	artik_error ret = S_OK;
+	artik_alarm_handle periodic = NULL, quit = NULL, cron = NULL;
+	artik_msecond delay;
+	uint64_t start;
+	int i, expected = 0;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	loop = (artik_loop_module *)artik_request_api_module("loop");
+	alarms = calloc(NUM_ALARMS, sizeof(*alarms));
+	if (!loop || !alarms) {
+		ret = E_NO_MEM;
+		goto exit;
+	}
+
+	/* Malformed or impossible schedules are rejected */
+	if (time_module_p->create_alarm_cron(ARTIK_TIME_UTC, "61 * * * *",
+			&cron, _alarm_periodic_callback, NULL) == S_OK ||
+		time_module_p->create_alarm_cron(ARTIK_TIME_UTC, "0 0 30 2 *",
+			&cron, _alarm_periodic_callback, NULL) == S_OK) {
+		fprintf(stdout, "TEST: %s failed: invalid schedule accepted\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	ret = time_module_p->create_alarm_cron(ARTIK_TIME_GMT2, "*/5 * * * *",
+			&cron, _alarm_periodic_callback, NULL);
+	if (ret != S_OK || time_module_p->get_delay_alarm(cron, &delay) != S_OK
+			|| delay == 0 || delay > 300) {
+		fprintf(stdout, "TEST: %s failed: wrong cron delay\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	start = time_module_p->get_monotonic_ns();
+	for (i = 0; i < NUM_ALARMS; i++) {
+		artik_msecond msecond = (i * 7919) % ALARM_SPREAD_MS;
+
+		alarms[i].deadline_ns = time_module_p->get_monotonic_ns() +
+			msecond * 1000000ULL;
+		ret = time_module_p->create_alarm_msecond(msecond, 0,
+				&alarms[i].handle, _alarm_scheduler_callback,
+				&alarms[i]);
+		if (ret != S_OK) {
+			fprintf(stdout, "TEST: %s failed: ERROR(%d)\n",
+				__func__, ret);
+			goto exit;
+		}
+	}
+	fprintf(stdout, "BENCH: create %d alarms %8.1f nsec/alarm\n",
+		NUM_ALARMS, (double)time_module_p->get_elapsed_ns(start) /
+		NUM_ALARMS);
+
+	/* Cancel one alarm out of three */
+	start = time_module_p->get_monotonic_ns();
+	for (i = 0; i < NUM_ALARMS; i += 3) {
+		time_module_p->delete_alarm(alarms[i].handle);
+		alarms[i].handle = NULL;
+	}
+	fprintf(stdout, "BENCH: cancel %d alarms %8.1f nsec/alarm\n",
+		(NUM_ALARMS + 2) / 3, (double)time_module_p->get_elapsed_ns(
+		start) / ((NUM_ALARMS + 2) / 3));
+
+	time_module_p->create_alarm_msecond(100, 100, &periodic,
+			_alarm_periodic_callback, NULL);
+	time_module_p->create_alarm_msecond(ALARM_SPREAD_MS + 50, 0, &quit,
+			_alarm_quit_callback, NULL);
+
+	start = time_module_p->get_monotonic_ns();
+	loop->run();
+	fprintf(stdout, "Alarms fired in %llu ms\n", (unsigned long long)
+		time_module_p->get_elapsed_ns(start) / 1000000);
+
+	for (i = 0; i < NUM_ALARMS; i++) {
+		if (alarms[i].fired != (alarms[i].handle ? 1 : 0)) {
+			fprintf(stdout, "TEST: %s failed: alarm %d fired %d "
+				"times\n", __func__, i, alarms[i].fired);
+			ret = E_INVALID_VALUE;
+			goto exit;
+		}
+		if (alarms[i].handle)
+			expected++;
+	}
+
+	if (alarms_fired != expected || alarms_early || alarms_unordered ||
+			periodic_fired < 9 || periodic_fired > 11) {
+		fprintf(stdout, "TEST: %s failed: %d/%d fired, %d early, %d "
+			"out of order, %d periodic\n", __func__, alarms_fired,
+			expected, alarms_early, alarms_unordered,
+			periodic_fired);
+		ret = E_INVALID_VALUE;
+		goto exit;
+	}
+
+	fprintf(stdout, "TEST: %s finished\n", __func__);
+
+exit:
+	if (alarms) {
+		for (i = 0; i < NUM_ALARMS; i++)
+			if (alarms[i].handle)
+				time_module_p->delete_alarm(alarms[i].handle);
+		free(alarms);
+	}
+	if (periodic)
+		time_module_p->delete_alarm(periodic);
+	if (quit)
+		time_module_p->delete_alarm(quit);
+	if (cron)
+		time_module_p->delete_alarm(cron);
+	if (loop)
+		artik_release_api_module(loop);
+
+	return ret;
+}
+
+#define NTP_TEST_SERVERS	3
+#define NTP_EPOCH_OFFSET	2208988800ULL
+
+/* The last server is a falseticker */
+static const int64_t ntp_test_offsets[NTP_TEST_SERVERS] = {
+	40000000, 40500000, 10000000000LL
+};
+
+static int ntp_test_fds[NTP_TEST_SERVERS];
+static int ntp_test_stop;
+static artik_error ntp_test_result = E_BUSY;
+static artik_time_ntp_stats ntp_test_stats;
+
+static void _ntp_put_timestamp(unsigned char *p, int64_t ns)
+{
+	uint64_t ts = ((uint64_t)(ns / 1000000000) + NTP_EPOCH_OFFSET) << 32 |
+		(((uint64_t)(ns % 1000000000) << 32) / 1000000000);
+	int i;
+
+	for (i = 7; i >= 0; i--, ts >>= 8)
+		p[i] = ts & 0xff;
+}
+
+/* Minimal NTP server answering with a fixed offset from the local clock */
+static void *_ntp_responder(void *user_data)
+{
+	struct pollfd pfds[NTP_TEST_SERVERS];
+	int i;
+
+	for (i = 0; i < NTP_TEST_SERVERS; i++) {
+		pfds[i].fd = ntp_test_fds[i];
+		pfds[i].events = POLLIN;
+	}
+
+	while (!ntp_test_stop) {
+		if (poll(pfds, NTP_TEST_SERVERS, 100) <= 0)
+			continue;
+
+		for (i = 0; i < NTP_TEST_SERVERS; i++) {
+			unsigned char pkt[48];
+			struct sockaddr_in addr;
+			socklen_t addr_len = sizeof(addr);
+			struct timespec ts;
+			int64_t now;
+
+			if (!(pfds[i].revents & POLLIN))
+				continue;
+			if (recvfrom(pfds[i].fd, pkt, sizeof(pkt), 0,
+				(struct sockaddr *)&addr, &addr_len) != 48)
+				continue;
+
+			clock_gettime(CLOCK_REALTIME, &ts);
+			now = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec +
+				ntp_test_offsets[i];
+
+			/* Origin is the client transmit timestamp */
+			memcpy(pkt + 24, pkt + 40, 8);
+			pkt[0] = (4 << 3) | 4;
+			pkt[1] = 1;
+			memset(pkt + 4, 0, 8);
+			memcpy(pkt + 12, "TEST", 4);
+			_ntp_put_timestamp(pkt + 16, now);
+			_ntp_put_timestamp(pkt + 32, now);
+			_ntp_put_timestamp(pkt + 40, now);
+
+			sendto(pfds[i].fd, pkt, sizeof(pkt), 0,
+				(struct sockaddr *)&addr, addr_len);
+		}
+	}
+
+	return NULL;
+}
+
+static void _ntp_callback(artik_error result,
+			const artik_time_ntp_stats *stats, void *user_data)
+{
+	ntp_test_result = result;
+	ntp_test_stats = *stats;
+	loop->quit();
+}
+
+static artik_error test_time_sync_ntp_async(void)
+{
+	artik_error ret = S_OK;
+	char servers[NTP_TEST_SERVERS][32];
+	const char *server_list[NTP_TEST_SERVERS];
+	artik_time_ntp_config config;
+	pthread_t responder;
+	int64_t expected;
+	int i;
+
+	fprintf(stdout, "TEST: %s started\n", __func__);
+
+	loop = (artik_loop_module *)artik_request_api_module("loop");
+
+	for (i = 0; i < NTP_TEST_SERVERS; i++) {
+		struct sockaddr_in addr;
+		socklen_t addr_len = sizeof(addr);
+
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		ntp_test_fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+		if (ntp_test_fds[i] < 0 || bind(ntp_test_fds[i],
+				(struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			getsockname(ntp_test_fds[i], (struct sockaddr *)&addr,
+				&addr_len) < 0) {
+			fprintf(stdout, "TEST: %s failed: no socket\n",
+				__func__);
+			return E_BUSY;
+		}
+		snprintf(servers[i], sizeof(servers[i]), "127.0.0.1:%d",
+			ntohs(addr.sin_port));
+		server_list[i] = servers[i];
+	}
+
+	pthread_create(&responder, NULL, _ntp_responder, NULL);
+
+	memset(&config, 0, sizeof(config));
+	config.servers = server_list;
+	config.num_servers = NTP_TEST_SERVERS;
+	config.timeout_ms = 3000;
+	/* Measure only, the system clock must not be touched */
+	config.dry_run = true;
+
+	ret = time_module_p->sync_ntp_async(&config, _ntp_callback, NULL);
+	if (ret == S_OK && time_module_p->sync_ntp_async(&config,
+			_ntp_callback, NULL) != E_BUSY) {
+		fprintf(stdout, "TEST: %s failed: concurrent sync accepted\n",
+			__func__);
+		ret = E_INVALID_VALUE;
+	}
+	if (ret == S_OK)
+		loop->run();
+
+	ntp_test_stop = 1;
+	pthread_join(responder, NULL);
+	for (i = 0; i < NTP_TEST_SERVERS; i++)
+		close(ntp_test_fds[i]);
+	artik_release_api_module(loop);
+
+	if (ret != S_OK)
+		return ret;
+
+	fprintf(stdout, "NTP offset %" PRId64 " ns, delay %" PRIu64
+		" ns, jitter %" PRIu64 " ns, %u servers, %u samples,"
+		" %u survivors\n", ntp_test_stats.offset_ns,
+		ntp_test_stats.delay_ns, ntp_test_stats.jitter_ns,
+		ntp_test_stats.servers, ntp_test_stats.samples,
+		ntp_test_stats.survivors);
+
+	expected = (ntp_test_offsets[0] + ntp_test_offsets[1]) / 2;
+	if (ntp_test_result != S_OK || ntp_test_stats.servers != 3 ||
+			ntp_test_stats.samples != 12 ||
+			ntp_test_stats.survivors != 2 ||
+			ntp_test_stats.adjusted ||
+			ntp_test_stats.offset_ns < expected - 5000000 ||
+			ntp_test_stats.offset_ns > expected + 5000000) {
+		fprintf(stdout, "TEST: %s failed: ERROR(%d)\n", __func__,
+			ntp_test_result);
+		return E_INVALID_VALUE;
+	}
+
+	fprintf(stdout, "TEST: %s finished\n", __func__);
+
+	return S_OK;
+}
+
 artik_error test_time_sync_ntp(void)
 {
 	artik_error ret;
@@ -242,6 +639,14 @@ int main(void)
 
 	time_module_p = (artik_time_module *)artik_request_api_module("time");
 
+	ret = test_monotonic_histogram();
+	if (ret != S_OK)
+		goto exit;
+
+	ret = test_alarm_scheduler();
+	if (ret != S_OK)
+		goto exit;
+
 	ret = test_convert_timestamp_to_time();
 	if (ret != S_OK)
 		goto exit;
@@ -254,6 +659,10 @@ int main(void)
 	if (ret != S_OK)
 		goto exit;
 
+	ret = test_time_sync_ntp_async();
+	if (ret != S_OK)
+		goto exit;
+
 	ret = test_time_sync_ntp();
 
 exit: